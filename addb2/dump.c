@@ -97,7 +97,8 @@
 
 enum {
 	BUF_SIZE  = 4096,
-	PLUGINS_MAX = 64
+	PLUGINS_MAX = 64,
+	LOGHIST_SUM_MAX = 256
 };
 
 struct fom {
@@ -126,6 +127,17 @@ struct plugin
 static struct plugin plugins[PLUGINS_MAX];
 static size_t        plugins_nr;
 
+/** Log-linear histogram data accumulated over all dumped records. */
+struct loghist_sum {
+	uint64_t ls_id;
+	uint64_t ls_nr;
+	int64_t  ls_max;
+	uint64_t ls_bucket[M0_ADDB2_LOGHIST_BUCKETS];
+};
+
+static struct loghist_sum loghist_sums[LOGHIST_SUM_MAX];
+static int                loghist_sums_nr;
+
 static struct m0_varr value_id;
 
 static void id_init  (void);
@@ -162,6 +174,8 @@ static void deflate(void);
 static void misc_init(void);
 static void misc_fini(void);
 
+static void loghist_sums_print(void);
+
 #define DOM "./_addb2-dump_%d"
 
 
@@ -169,6 +183,7 @@ extern int  optind;
 static bool flatten = false;
 static bool deflatten = false;
 static bool json_output = false;
+static bool percentiles = false;
 static const char *json_extra_data = NULL;
 static m0_bindex_t offset = 0;
 static int delay = 0;
@@ -232,6 +247,8 @@ int main(int argc, char **argv)
 			M0_FLAGARG('f', "Flatten output", &flatten),
 			M0_FLAGARG('d', "De-flatten input", &deflatten),
 			M0_FLAGARG('j', "JSON output (see jsonlines.org)", &json_output),
+			M0_FLAGARG('P', "Print percentiles of log-linear "
+				   "histograms", &percentiles),
 			M0_STRINGARG('J', "Embed extra JSON data into every record",
 				    LAMBDA(void, (const char *json_text) {
 					    json_extra_data = strdup(json_text);
@@ -275,6 +292,8 @@ int main(int argc, char **argv)
 	id_init();
 	for (i = optind; i < argc; ++i)
 		file_dump(dom, argv[i], start_time, stop_time);
+	if (percentiles)
+		loghist_sums_print();
 
 	plugins_unload();
 
@@ -759,6 +778,80 @@ static void hist(struct m0_addb2__context *ctx, const uint64_t *v, char *buf)
 	}
 }
 
+static struct loghist_sum *loghist_sum_get(uint64_t id)
+{
+	struct loghist_sum *sum;
+	int                 i;
+
+	for (i = 0; i < loghist_sums_nr; ++i) {
+		if (loghist_sums[i].ls_id == id)
+			return &loghist_sums[i];
+	}
+	if (loghist_sums_nr == ARRAY_SIZE(loghist_sums))
+		return NULL;
+	sum = &loghist_sums[loghist_sums_nr++];
+	sum->ls_id  = id;
+	sum->ls_max = INT64_MIN;
+	return sum;
+}
+
+static void loghist(struct m0_addb2__context *ctx, const uint64_t *v,
+		    char *buf)
+{
+	const struct m0_addb2_counter_data *d  = (void *)&v[0];
+	const struct m0_addb2_loghist_data *ld =
+		(void *)&v[M0_ADDB2_COUNTER_VALS];
+	struct loghist_sum                 *sum;
+	uint32_t                            slot;
+	int                                 i;
+
+	counter(ctx, v, buf);
+	if (percentiles && (sum = loghist_sum_get(ctx->c_val->va_id)) != NULL) {
+		m0_addb2_loghist_merge(sum->ls_bucket, ld);
+		if (d->cod_nr > 0) {
+			sum->ls_nr += d->cod_nr;
+			sum->ls_max = max64(sum->ls_max, d->cod_max);
+		}
+	}
+	if (json_output)
+		/* TODO: enable histogram support in JSON format */
+		return;
+	for (i = 0; i < ARRAY_SIZE(ld->ld_slot); ++i) {
+		slot = ld->ld_slot[i];
+		if (slot != 0)
+			sprintf(buf + strlen(buf), " %" PRId64 ": %"PRIu32,
+				m0_addb2_loghist_lo(slot >>
+						    M0_ADDB2_LOGHIST_CNT_BITS),
+				slot & M0_ADDB2_LOGHIST_CNT_MASK);
+	}
+}
+
+static void loghist_sums_print(void)
+{
+	static const uint32_t ppm[] = { 500000, 900000, 990000, 999000 };
+	struct loghist_sum        *sum;
+	struct m0_addb2__id_intrp *intrp;
+	int                        i;
+	int                        j;
+
+	for (i = 0; i < loghist_sums_nr; ++i) {
+		sum = &loghist_sums[i];
+		if (sum->ls_nr == 0)
+			continue;
+		intrp = id_get(sum->ls_id);
+		printf(json_output ? "{\"percentiles\":{\"name\":\"%s\""
+		       ",\"nr\":%"PRIu64 : "%-24s nr: %"PRIu64,
+		       intrp != NULL ? intrp->ii_name : "?", sum->ls_nr);
+		for (j = 0; j < ARRAY_SIZE(ppm); ++j)
+			printf(json_output ? ",\"p%g\":%"PRId64 :
+			       " p%g: %"PRId64, ppm[j] / 10000.0,
+			       m0_addb2_loghist_quantile(sum->ls_bucket,
+							 ppm[j]));
+		printf(json_output ? ",\"max\":%"PRId64"}}\n" :
+		       " max: %"PRId64"\n", sum->ls_max);
+	}
+}
+
 static void sm_trans(const struct m0_sm_conf *conf, const char *name,
 		     struct m0_addb2__context *ctx, char *buf)
 {
@@ -1069,6 +1162,8 @@ static void attr(struct m0_addb2__context *ctx, const uint64_t *v, char *buf)
 #define TIMED &duration, &sym
 #define HIST &hist, &skip, &skip, &skip, &skip, &skip, &skip, &skip, &skip, \
 		&skip, &skip, &skip, &skip, &skip, &skip
+#define LOGHIST &loghist, &skip, &skip, &skip, &skip, &skip, &skip, &skip, \
+		&skip, &skip, &skip, &skip, &skip, &skip, &skip
 #define SKIP2 &skip, &skip
 
 struct m0_addb2__id_intrp ids[] = {
@@ -1101,10 +1196,14 @@ struct m0_addb2__id_intrp ids[] = {
 	{ M0_AVI_AST,             "ast" },
 	{ M0_AVI_LOCALITY_FORQ_DURATION, "loc-forq-duration", { TIMED },
 	  { "duration" } },
-	{ M0_AVI_LOCALITY_FORQ,      "loc-forq-hist",  { HIST } },
-	{ M0_AVI_LOCALITY_CHAN_WAIT, "loc-wait-hist",  { HIST } },
-	{ M0_AVI_LOCALITY_CHAN_CB,   "loc-cb-hist",    { HIST } },
+	{ M0_AVI_LOCALITY_FORQ,      "loc-forq-hist",  { LOGHIST } },
+	{ M0_AVI_LOCALITY_CHAN_WAIT, "loc-wait-hist",  { LOGHIST } },
+	{ M0_AVI_LOCALITY_CHAN_CB,   "loc-cb-hist",    { LOGHIST } },
 	{ M0_AVI_LOCALITY_CHAN_QUEUE,"loc-queue-hist", { HIST } },
+	{ M0_AVI_LOCALITY_STEAL_TRY, "loc-steal-try",  { COUNTER } },
+	{ M0_AVI_LOCALITY_STEAL_GOT, "loc-steal-got",  { COUNTER } },
+	{ M0_AVI_RUNQ_DELAY_FOREGROUND, "runq-delay-fg", { LOGHIST } },
+	{ M0_AVI_RUNQ_DELAY_BACKGROUND, "runq-delay-bg", { LOGHIST } },
 	{ M0_AVI_IOS_IO_DESCR,    "ios-io-descr",    { FID, FID,
 						       &hex, &hex, &dec, &dec,
 						       &dec, &dec, &dec },
@@ -1134,8 +1233,14 @@ struct m0_addb2__id_intrp ids[] = {
 	{ M0_AVI_STOB_IOQ_INFLIGHT, "stob-ioq-inflight", { HIST } },
 	{ M0_AVI_STOB_IOQ_QUEUED, "stob-ioq-queued", { HIST } },
 	{ M0_AVI_STOB_IOQ_GOT,    "stob-ioq-got",    { HIST } },
+	{ M0_AVI_STOB_IOQ_LATENCY, "stob-ioq-latency", { LOGHIST } },
+	{ M0_AVI_STOB_CACHE,      "stob-cache",      { &ptr, &dec, &dec,
+						       &dec, &dec },
+	  { "cache", "busy-hits", "idle-hits", "misses", "evictions" } },
 
 	{ M0_AVI_RPC_LOCK,        "rpc-machine-lock", { &ptr } },
+	{ M0_AVI_RPC_LOCK_WAIT,   "rpc-lock-wait",    { LOGHIST } },
+	{ M0_AVI_RPC_LOCK_HOLD,   "rpc-lock-hold",    { LOGHIST } },
 	{ M0_AVI_RPC_REPLIED,     "rpc-replied",      { &ptr, &rpcop } },
 	{ M0_AVI_RPC_OUT_PHASE,   "rpc-out-phase",    { &rpc_out, SKIP2 } },
 	{ M0_AVI_RPC_IN_PHASE,    "rpc-in-phase",    { &rpc_in, SKIP2 } },
@@ -1161,6 +1266,10 @@ struct m0_addb2__id_intrp ids[] = {
 	{ M0_AVI_NET_BUF,         "net-buf",         { &ptr, &dec, &_clock,
 						       &duration, &dec, &dec },
 	  { "buf", "qtype", "time", "duration", "status", "len" } },
+	{ M0_AVI_NET_SOCK_POLLER, "sock-poller",     { &ptr, &dec },
+	  { "tm", "poller" } },
+	{ M0_AVI_NET_SOCK_EVENTS, "sock-events",     { COUNTER } },
+	{ M0_AVI_NET_SOCK_IO,     "sock-io",         { COUNTER } },
 	{ M0_AVI_FOP_TYPES_RANGE_START,   "",
 	  .ii_repeat = M0_AVI_FOP_TYPES_RANGE_END-M0_AVI_FOP_TYPES_RANGE_START,
 	  .ii_spec   = &fop_counter },
@@ -1385,7 +1494,7 @@ static void val_dump_json(struct m0_addb2__context *ctx,
 		if (val->va_nr == 0)
 			printf("true");
 		else if (intrp->ii_print != NULL &&
-			 intrp->ii_print[0] == &hist)
+			 M0_IN(intrp->ii_print[0], (&hist, &loghist)))
 			printf("true,");
 	}
 	else {
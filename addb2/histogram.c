@@ -121,6 +121,158 @@ static const struct m0_addb2_sensor_ops hist_ops = {
 	.so_fini     = &hist_fini
 };
 
+static const struct m0_addb2_sensor_ops loghist_ops;
+
+void m0_addb2_loghist_add(struct m0_addb2_loghist *hist,
+			  uint64_t label, int idx)
+{
+	struct m0_addb2_counter *c = &hist->lh_counter;
+
+	M0_PRE(M0_IS0(hist));
+
+	m0_addb2__counter_data_init(&c->co_val);
+	m0_addb2_sensor_add(&c->co_sensor, label, VALUE_MAX_NR, idx,
+			    &loghist_ops);
+}
+
+void m0_addb2_loghist_del(struct m0_addb2_loghist *hist)
+{
+	m0_addb2_sensor_del(&hist->lh_counter.co_sensor);
+}
+
+void m0_addb2_loghist_mod(struct m0_addb2_loghist *hist, int64_t val)
+{
+	m0_addb2_loghist_mod_with(hist, val, 0);
+}
+
+void m0_addb2_loghist_mod_with(struct m0_addb2_loghist *hist,
+			       int64_t val, uint64_t datum)
+{
+	int idx = m0_addb2_loghist_bucket(val);
+
+	if (hist->lh_bucket[idx] < UINT32_MAX)
+		hist->lh_bucket[idx]++;
+	hist->lh_used[idx / 64] |= 1ULL << (idx % 64);
+	m0_addb2_counter_mod_with(&hist->lh_counter, val, datum);
+}
+
+int m0_addb2_loghist_bucket(int64_t val)
+{
+	enum { SUB_BITS = M0_ADDB2_LOGHIST_SUB_BITS };
+	uint64_t v = val;
+	int      exp;
+	int      idx;
+
+	if (val < M0_ADDB2_LOGHIST_SUB_NR)
+		idx = max64(val, 0);
+	else if (v >= 1ULL << M0_ADDB2_LOGHIST_EXP_MAX)
+		idx = M0_ADDB2_LOGHIST_BUCKETS - 1;
+	else {
+		exp = 63 - __builtin_clzll(v);
+		idx = ((exp - SUB_BITS + 1) << SUB_BITS) |
+			((v >> (exp - SUB_BITS)) & (M0_ADDB2_LOGHIST_SUB_NR - 1));
+	}
+	M0_POST(0 <= idx && idx < M0_ADDB2_LOGHIST_BUCKETS);
+	return idx;
+}
+
+int64_t m0_addb2_loghist_lo(int idx)
+{
+	enum { SUB_BITS = M0_ADDB2_LOGHIST_SUB_BITS };
+	int exp;
+	int sub;
+
+	M0_PRE(0 <= idx && idx < M0_ADDB2_LOGHIST_BUCKETS);
+	if (idx < M0_ADDB2_LOGHIST_SUB_NR)
+		return idx;
+	exp = (idx >> SUB_BITS) + SUB_BITS - 1;
+	sub = idx & (M0_ADDB2_LOGHIST_SUB_NR - 1);
+	return ((int64_t)(M0_ADDB2_LOGHIST_SUB_NR + sub)) << (exp - SUB_BITS);
+}
+
+/** Returns the width of the bucket. */
+static int64_t loghist_width(int idx)
+{
+	return m0_addb2_loghist_lo(idx + 1) - m0_addb2_loghist_lo(idx);
+}
+
+void m0_addb2_loghist_merge(uint64_t *bucket,
+			    const struct m0_addb2_loghist_data *data)
+{
+	uint32_t slot;
+	int      i;
+
+	for (i = 0; i < ARRAY_SIZE(data->ld_slot); ++i) {
+		slot = data->ld_slot[i];
+		if (slot != 0)
+			bucket[slot >> M0_ADDB2_LOGHIST_CNT_BITS] +=
+				slot & M0_ADDB2_LOGHIST_CNT_MASK;
+	}
+}
+
+int64_t m0_addb2_loghist_quantile(const uint64_t *bucket, uint32_t ppm)
+{
+	uint64_t total = 0;
+	uint64_t rank;
+	uint64_t sum;
+	int      i;
+
+	M0_PRE(ppm <= 1000000);
+	for (i = 0; i < M0_ADDB2_LOGHIST_BUCKETS; ++i)
+		total += bucket[i];
+	if (total == 0)
+		return 0;
+	/* Rank of the quantile element, 1-based, rounded up. */
+	rank = max64u((total * ppm + 999999) / 1000000, 1);
+	for (i = 0, sum = 0; i < M0_ADDB2_LOGHIST_BUCKETS - 1; ++i) {
+		sum += bucket[i];
+		if (sum >= rank)
+			break;
+	}
+	if (i == M0_ADDB2_LOGHIST_BUCKETS - 1)
+		return m0_addb2_loghist_lo(i);
+	/* Middle of the bucket halves the worst relative error. */
+	return m0_addb2_loghist_lo(i) + loghist_width(i) / 2;
+}
+
+static void loghist_snapshot(struct m0_addb2_sensor *s, uint64_t *area)
+{
+	struct m0_addb2_loghist      *hist = M0_AMB(hist, s,
+						    lh_counter.co_sensor);
+	struct m0_addb2_loghist_data *ld;
+	uint32_t                      nr;
+	int                           idx = hist->lh_cursor;
+	int                           i;
+	int                           j;
+
+	m0_addb2__counter_snapshot(s, area);
+	ld = (struct m0_addb2_loghist_data *)(area + M0_ADDB2_COUNTER_VALS);
+	/*
+	 * Deliver up to M0_ADDB2_LOGHIST_SLOTS non-empty buckets, starting
+	 * from the cursor. The rest is delivered by the following snapshots.
+	 */
+	for (i = j = 0; i < M0_ADDB2_LOGHIST_BUCKETS &&
+		     j < M0_ADDB2_LOGHIST_SLOTS; ++i,
+		     idx = (idx + 1) % M0_ADDB2_LOGHIST_BUCKETS) {
+		if (!(hist->lh_used[idx / 64] & (1ULL << (idx % 64))))
+			continue;
+		nr = min32u(hist->lh_bucket[idx],
+			    M0_ADDB2_LOGHIST_CNT_MASK);
+		ld->ld_slot[j++] = (idx << M0_ADDB2_LOGHIST_CNT_BITS) | nr;
+		hist->lh_bucket[idx] -= nr;
+		if (hist->lh_bucket[idx] == 0)
+			hist->lh_used[idx / 64] &= ~(1ULL << (idx % 64));
+	}
+	for (; j < M0_ADDB2_LOGHIST_SLOTS; ++j)
+		ld->ld_slot[j] = 0;
+	hist->lh_cursor = idx;
+}
+
+static const struct m0_addb2_sensor_ops loghist_ops = {
+	.so_snapshot = &loghist_snapshot,
+	.so_fini     = &hist_fini
+};
+
 #undef M0_TRACE_SUBSYSTEM
 
 /** @} end of addb2 group */
@@ -81,6 +81,32 @@
  * point on, buckets are updated. This is suitable for situations where
  * distribution of values is now known in advance, e.g., network latencies.
  *
+ * Linear buckets are a poor fit for latencies: tail values all land in the
+ * last bucket, and histograms auto-tuned in different localities have
+ * different buckets and cannot be merged. A log-linear histogram
+ * (m0_addb2_loghist) has bucket boundaries independent of the histogram:
+ *
+ * @verbatim
+ *
+ *     0   1   ...   SUB-1 | SUB ... 2*SUB-1 | 2*SUB  2*SUB+2 ... | ...
+ *     one bucket per value| exponent e = SUB_BITS, SUB buckets    | e + 1
+ *
+ * @endverbatim
+ *
+ * Where SUB == M0_ADDB2_LOGHIST_SUB_NR. Each range [2^e, 2^(e+1)) is split
+ * into SUB equal buckets, so a bucket is never wider than 1/SUB of its lower
+ * bound, which bounds the relative error of percentiles computed from the
+ * buckets. Negative values are counted in the bucket 0, values greater than
+ * or equal to 2^M0_ADDB2_LOGHIST_EXP_MAX in the last bucket.
+ *
+ * Histograms of different localities or time intervals are merged by adding
+ * their buckets (m0_addb2_loghist_merge()).
+ *
+ * The buckets do not fit in a sensor record. A record carries the counter
+ * data and up to M0_ADDB2_LOGHIST_SLOTS non-empty buckets. Buckets that do
+ * not fit stay in the histogram and are delivered by the following records,
+ * so that the sum of all records of a histogram is exact.
+ *
  * @{
  */
 
@@ -152,6 +178,87 @@ do {									\
 		m0_addb2_hist_mod_with(__hist, __duration, __datum);	\
 } while (0)
 
+enum {
+	/** log2 of the number of buckets per power of 2. */
+	M0_ADDB2_LOGHIST_SUB_BITS = 3,
+	M0_ADDB2_LOGHIST_SUB_NR   = 1 << M0_ADDB2_LOGHIST_SUB_BITS,
+	/** Values at or above 2^M0_ADDB2_LOGHIST_EXP_MAX are not resolved. */
+	M0_ADDB2_LOGHIST_EXP_MAX  = 48,
+	M0_ADDB2_LOGHIST_BUCKETS  = (M0_ADDB2_LOGHIST_EXP_MAX -
+				     M0_ADDB2_LOGHIST_SUB_BITS + 1) *
+				    M0_ADDB2_LOGHIST_SUB_NR,
+	/**
+	 * A record slot is a 32-bit word: bucket index in the upper
+	 * M0_ADDB2_LOGHIST_IDX_BITS bits, bucket count in the rest.
+	 * Zero slot is empty.
+	 */
+	M0_ADDB2_LOGHIST_IDX_BITS = 10,
+	M0_ADDB2_LOGHIST_CNT_BITS = 32 - M0_ADDB2_LOGHIST_IDX_BITS,
+	M0_ADDB2_LOGHIST_CNT_MASK = (1 << M0_ADDB2_LOGHIST_CNT_BITS) - 1,
+	/** Number of slots in a record. */
+	M0_ADDB2_LOGHIST_SLOTS    = 2 * (VALUE_MAX_NR - M0_ADDB2_COUNTER_VALS)
+};
+
+/**
+ * Data (in addition to counter data, m0_addb2_counter_data), produced by the
+ * log-linear histogram.
+ */
+struct m0_addb2_loghist_data {
+	uint32_t ld_slot[M0_ADDB2_LOGHIST_SLOTS];
+};
+
+M0_BASSERT(M0_ADDB2_LOGHIST_BUCKETS <= 1 << M0_ADDB2_LOGHIST_IDX_BITS);
+M0_BASSERT(sizeof(struct m0_addb2_loghist_data) ==
+	   (VALUE_MAX_NR - M0_ADDB2_COUNTER_VALS) * sizeof(uint64_t));
+
+/**
+ * Addb2 log-linear histogram.
+ *
+ * Accumulates the same statistics as addb2 counter (m0_addb2_counter), plus
+ * log-linear buckets.
+ */
+struct m0_addb2_loghist {
+	struct m0_addb2_counter lh_counter;
+	/** Bucket from which the next snapshot starts. */
+	int                     lh_cursor;
+	/** Bitmap of non-empty buckets. */
+	uint64_t                lh_used[(M0_ADDB2_LOGHIST_BUCKETS + 63) / 64];
+	uint32_t                lh_bucket[M0_ADDB2_LOGHIST_BUCKETS];
+};
+
+void m0_addb2_loghist_add(struct m0_addb2_loghist *hist,
+			  uint64_t label, int idx);
+void m0_addb2_loghist_del(struct m0_addb2_loghist *hist);
+void m0_addb2_loghist_mod(struct m0_addb2_loghist *hist, int64_t val);
+void m0_addb2_loghist_mod_with(struct m0_addb2_loghist *hist,
+			       int64_t val, uint64_t datum);
+/** Returns the index of the bucket for the value. */
+int m0_addb2_loghist_bucket(int64_t val);
+/** Returns the smallest non-negative value of the bucket. */
+int64_t m0_addb2_loghist_lo(int idx);
+/**
+ * Adds buckets delivered in a histogram record to "bucket", an array of
+ * M0_ADDB2_LOGHIST_BUCKETS elements. "data" is the part of the record
+ * following counter data.
+ */
+void m0_addb2_loghist_merge(uint64_t *bucket,
+			    const struct m0_addb2_loghist_data *data);
+/**
+ * Returns a value estimating the quantile (in parts per million) of the
+ * distribution in "bucket", an array of M0_ADDB2_LOGHIST_BUCKETS elements.
+ *
+ * Returns 0 if the buckets are empty.
+ */
+int64_t m0_addb2_loghist_quantile(const uint64_t *bucket, uint32_t ppm);
+
+#define M0_ADDB2_LOGHIST(id, hist, datum, ...)				\
+do {									\
+	struct m0_addb2_loghist *__hist = (hist);			\
+	M0_ADDB2_TIMED_0((id), (datum), __VA_ARGS__);			\
+	if (__hist != NULL)						\
+		m0_addb2_loghist_mod_with(__hist, __duration, __datum);	\
+} while (0)
+
 /** @} end of addb2 group */
 #endif /* __MOTR_ADDB2_HISTOGRAM_H__ */
 
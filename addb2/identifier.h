@@ -99,6 +99,14 @@ enum m0_addb2_value_id {
 	M0_AVI_LONG_LOCK,
 	/** Measurement: generic attribute. */
 	M0_AVI_ATTR,
+	/** Counter: work stealing requests posted by a locality. */
+	M0_AVI_LOCALITY_STEAL_TRY,
+	/** Counter: foms stolen by a locality. */
+	M0_AVI_LOCALITY_STEAL_GOT,
+	/** Measurement: run-queue delay of foreground foms. */
+	M0_AVI_RUNQ_DELAY_FOREGROUND,
+	/** Measurement: run-queue delay of background foms. */
+	M0_AVI_RUNQ_DELAY_BACKGROUND,
 
 	M0_AVI_LIB_RANGE_START     = 0x3000,
 	/** Measurement: memory allocation. */
@@ -102,6 +102,99 @@ static void test_bucket(void)
 	}
 }
 
+static void test_loghist_bucket(void)
+{
+	int64_t val;
+	int64_t lo;
+	int     idx;
+	int     i;
+
+	for (i = 0; i < M0_ADDB2_LOGHIST_SUB_NR; ++i) {
+		M0_UT_ASSERT(m0_addb2_loghist_bucket(i) == i);
+		M0_UT_ASSERT(m0_addb2_loghist_lo(i) == i);
+	}
+	M0_UT_ASSERT(m0_addb2_loghist_bucket(-1) == 0);
+	M0_UT_ASSERT(m0_addb2_loghist_bucket(-M0_BITS(58)) == 0);
+	M0_UT_ASSERT(m0_addb2_loghist_bucket(M0_BITS(58)) ==
+		     M0_ADDB2_LOGHIST_BUCKETS - 1);
+	for (i = 1; i < M0_ADDB2_LOGHIST_BUCKETS; ++i)
+		M0_UT_ASSERT(m0_addb2_loghist_lo(i - 1) <
+			     m0_addb2_loghist_lo(i));
+	for (i = 0; i < M0_ADDB2_LOGHIST_BUCKETS; ++i) {
+		lo = m0_addb2_loghist_lo(i);
+		M0_UT_ASSERT(m0_addb2_loghist_bucket(lo) == i);
+		M0_UT_ASSERT(ergo(i > 0, m0_addb2_loghist_bucket(lo - 1) ==
+				  i - 1));
+	}
+	for (i = 0; i < M0_ADDB2_LOGHIST_EXP_MAX; ++i) {
+		val = M0_BITS(i) + random_val[i % ARRAY_SIZE(random_val)] %
+			M0_BITS(i);
+		idx = m0_addb2_loghist_bucket(val);
+		lo  = m0_addb2_loghist_lo(idx);
+		/* Relative error is bounded by the bucket width. */
+		M0_UT_ASSERT(lo <= val);
+		M0_UT_ASSERT((val - lo) * M0_ADDB2_LOGHIST_SUB_NR <= val);
+	}
+}
+
+static void loghist_snapshot(struct m0_addb2_loghist *h, uint64_t *area)
+{
+	struct m0_addb2_sensor *s = &h->lh_counter.co_sensor;
+
+	s->s_ops->so_snapshot(s, area);
+}
+
+static void test_loghist(void)
+{
+	struct m0_addb2_loghist h = {};
+	uint64_t                area[VALUE_MAX_NR];
+	uint64_t                bucket[M0_ADDB2_LOGHIST_BUCKETS] = {};
+	uint64_t                nr = 0;
+	int                     i;
+	int                     j;
+
+	m0_addb2_loghist_add(&h, 6, -1);
+	/* More non-empty buckets than a record carries. */
+	for (i = 0; i < 3 * M0_ADDB2_LOGHIST_SLOTS; ++i) {
+		for (j = 0; j <= i; ++j) {
+			m0_addb2_loghist_mod(&h, M0_BITS(i / 2) + i % 2);
+			++nr;
+		}
+	}
+	for (i = 0; i < 4; ++i) {
+		loghist_snapshot(&h, area);
+		if (i == 0)
+			M0_UT_ASSERT(((struct m0_addb2_counter_data *)area)->
+				     cod_nr == nr);
+		m0_addb2_loghist_merge(bucket, (void *)&area[
+					       M0_ADDB2_COUNTER_VALS]);
+	}
+	/* All buckets are delivered. */
+	M0_UT_ASSERT(m0_forall(i, ARRAY_SIZE(h.lh_bucket),
+			       h.lh_bucket[i] == 0));
+	M0_UT_ASSERT(m0_reduce(i, ARRAY_SIZE(bucket), 0ULL, + bucket[i]) == nr);
+	for (i = 0; i < 3 * M0_ADDB2_LOGHIST_SLOTS; ++i)
+		M0_UT_ASSERT(bucket[m0_addb2_loghist_bucket(M0_BITS(i / 2) +
+							    i % 2)] >= i + 1);
+	M0_UT_ASSERT(m0_addb2_loghist_quantile(bucket, 0) == 1);
+	M0_UT_ASSERT(m0_addb2_loghist_quantile(bucket, 1000000) >=
+		     M0_BITS((3 * M0_ADDB2_LOGHIST_SLOTS - 1) / 2));
+	m0_addb2_loghist_del(&h);
+
+	/* Percentiles of a uniform distribution. */
+	M0_SET0(&bucket);
+	for (i = 1; i <= 100000; ++i)
+		bucket[m0_addb2_loghist_bucket(i)]++;
+	for (i = 1; i < 1000; ++i) {
+		int64_t q = m0_addb2_loghist_quantile(bucket, i * 1000);
+
+		M0_UT_ASSERT(q * M0_ADDB2_LOGHIST_SUB_NR >=
+			     (M0_ADDB2_LOGHIST_SUB_NR - 1) * 100 * i);
+		M0_UT_ASSERT(q * M0_ADDB2_LOGHIST_SUB_NR <=
+			     (M0_ADDB2_LOGHIST_SUB_NR + 1) * 100 * i);
+	}
+}
+
 struct m0_ut_suite addb2_hist_ut = {
 	.ts_name = "addb2-histogram",
 	.ts_init = NULL,
@@ -109,6 +202,8 @@ struct m0_ut_suite addb2_hist_ut = {
 	.ts_tests = {
 		{ "init-fini",      &init_fini },
 		{ "history-bucket", &test_bucket },
+		{ "loghist-bucket", &test_loghist_bucket },
+		{ "loghist",        &test_loghist },
 		{ NULL, NULL }
 	}
 };
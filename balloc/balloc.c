@@ -67,6 +67,7 @@ struct balloc_allocation_context {
 	struct m0_ext                  bac_goal; /*< after normalization */
 	struct m0_ext                  bac_best; /*< best available */
 	struct m0_ext                  bac_final;/*< final results */
+	int                            bac_prealloc;/*< claimed window or -1 */
 };
 
 static inline int btree_lookup_sync(struct m0_be_btree  *tree,
@@ -150,11 +151,21 @@ static void balloc_zone_init(struct m0_balloc_zone_param *zone, uint64_t type,
 			     m0_bcount_t start, m0_bcount_t size,
 			     m0_bcount_t freeblocks, m0_bcount_t fragments,
 			     m0_bcount_t maxchunk);
+static void balloc_zone_fini(struct m0_balloc_zone_param *zone);
 static uint64_t ext_range_locate(struct m0_ext *ip_ext,
 				 struct m0_balloc_group_info *grp);
 static bool is_spare(uint64_t alloc_flags);
 static bool is_normal(uint64_t alloc_flags);
 static bool is_any(uint64_t alloc_flag);
+static m0_bindex_t balloc_prealloc_goal(struct m0_balloc *bal,
+					const struct m0_fid *owner);
+static int balloc_free_internal(struct m0_balloc *ctx,
+				struct m0_be_tx  *tx,
+				struct m0_balloc_free_req *req);
+static void balloc_db_update_credit(const struct m0_balloc *bal, int nr,
+					  struct m0_be_tx_credit *accum);
+static void balloc_sb_sync_credit(const struct m0_balloc *bal,
+					struct m0_be_tx_credit *accum);
 
 
 static void balloc_debug_dump_extent(const char *tag, struct m0_ext *ex)
@@ -268,8 +279,222 @@ static struct m0_mutex *bgi_mutex(struct m0_balloc_group_info *grp)
 	return &grp->bgi_mutex.bm_u.mutex;
 }
 
-static void lext_del(struct m0_lext *le)
+/*
+ * Free extents of a zone are kept in three structures:
+ *
+ * - bzp_extents list sorted by offset, used for neighbour lookups and
+ *   debugging dumps;
+ *
+ * - bzp_root treap keyed by extent start, which finds the extent covering
+ *   or preceding a given block in expected O(log N). Extents of a zone never
+ *   overlap, so in-place updates of e_start and e_end done by alloc and free
+ *   never break the order of the treap;
+ *
+ * - bzp_size[] lists of extents of the same log2 size class, with
+ *   bzp_size_map of non-empty classes. Best fit looks at one class and the
+ *   first extent of the next non-empty one.
+ */
+
+static unsigned zone_size_class(m0_bcount_t len)
+{
+	return min_check(m0_log2(len), (unsigned)M0_BALLOC_SIZE_CLASS_NR - 1);
+}
+
+static void zone_size_add(struct m0_balloc_zone_param *zp, struct m0_lext *le)
+{
+	unsigned c = zone_size_class(m0_ext_length(&le->le_ext));
+
+	m0_list_add(&zp->bzp_size[c], &le->le_size_link);
+	zp->bzp_size_map |= M0_BITS(c);
+}
+
+static void zone_size_del(struct m0_balloc_zone_param *zp, struct m0_lext *le)
+{
+	unsigned c = zone_size_class(m0_ext_length(&le->le_ext));
+
+	m0_list_del(&le->le_size_link);
+	if (m0_list_is_empty(&zp->bzp_size[c]))
+		zp->bzp_size_map &= ~M0_BITS(c);
+}
+
+static void lext_rotate_left(struct m0_lext **t)
+{
+	struct m0_lext *r = (*t)->le_right;
+
+	(*t)->le_right = r->le_left;
+	r->le_left = *t;
+	*t = r;
+}
+
+static void lext_rotate_right(struct m0_lext **t)
+{
+	struct m0_lext *l = (*t)->le_left;
+
+	(*t)->le_left = l->le_right;
+	l->le_right = *t;
+	*t = l;
+}
+
+static void lext_tree_insert(struct m0_lext **t, struct m0_lext *le)
+{
+	if (*t == NULL) {
+		*t = le;
+	} else if (le->le_ext.e_start < (*t)->le_ext.e_start) {
+		lext_tree_insert(&(*t)->le_left, le);
+		if ((*t)->le_left->le_prio > (*t)->le_prio)
+			lext_rotate_right(t);
+	} else {
+		lext_tree_insert(&(*t)->le_right, le);
+		if ((*t)->le_right->le_prio > (*t)->le_prio)
+			lext_rotate_left(t);
+	}
+}
+
+static void lext_tree_del(struct m0_lext **t, struct m0_lext *le)
+{
+	while (*t != le) {
+		M0_ASSERT(*t != NULL);
+		t = le->le_ext.e_start < (*t)->le_ext.e_start ?
+			&(*t)->le_left : &(*t)->le_right;
+	}
+	/* Rotate the extent down to a leaf and cut it off. */
+	while (le->le_left != NULL || le->le_right != NULL) {
+		if (le->le_right == NULL || (le->le_left != NULL &&
+		    le->le_left->le_prio > le->le_right->le_prio)) {
+			lext_rotate_right(t);
+			t = &(*t)->le_right;
+		} else {
+			lext_rotate_left(t);
+			t = &(*t)->le_left;
+		}
+	}
+	*t = NULL;
+}
+
+/**
+ * Adds extent, already linked into bzp_extents, to the zone indices.
+ */
+static void zone_ext_add(struct m0_balloc_zone_param *zp, struct m0_lext *le)
+{
+	le->le_left = le->le_right = NULL;
+	le->le_prio = m0_rnd64(&zp->bzp_seed);
+	lext_tree_insert(&zp->bzp_root, le);
+	zone_size_add(zp, le);
+}
+
+/**
+ * Updates the size index after the length of the extent has changed.
+ * @old is the length the extent was indexed with.
+ */
+static void zone_ext_resize(struct m0_balloc_zone_param *zp,
+			    struct m0_lext *le, m0_bcount_t old)
+{
+	unsigned c = zone_size_class(old);
+
+	if (c != zone_size_class(m0_ext_length(&le->le_ext))) {
+		m0_list_del(&le->le_size_link);
+		if (m0_list_is_empty(&zp->bzp_size[c]))
+			zp->bzp_size_map &= ~M0_BITS(c);
+		zone_size_add(zp, le);
+	}
+}
+
+/** Returns the extent with the largest start not greater than @off. */
+static struct m0_lext *zone_ext_floor(const struct m0_balloc_zone_param *zp,
+				      m0_bindex_t off)
+{
+	struct m0_lext *t = zp->bzp_root;
+	struct m0_lext *le = NULL;
+
+	while (t != NULL) {
+		if (t->le_ext.e_start <= off) {
+			le = t;
+			t = t->le_right;
+		} else
+			t = t->le_left;
+	}
+	return le;
+}
+
+static struct m0_lext *zone_ext_next(struct m0_balloc_zone_param *zp,
+				     struct m0_lext *le)
+{
+	struct m0_list_link *l = le == NULL ? m0_list_first(&zp->bzp_extents) :
+						le->le_link.ll_next;
+
+	return l == NULL || l == (struct m0_list_link *)&zp->bzp_extents ?
+		NULL : m0_list_entry(l, struct m0_lext, le_link);
+}
+
+static struct m0_lext *zone_ext_prev(struct m0_balloc_zone_param *zp,
+				     struct m0_lext *le)
+{
+	struct m0_list_link *l = le->le_link.ll_prev;
+
+	return l == (struct m0_list_link *)&zp->bzp_extents ?
+		NULL : m0_list_entry(l, struct m0_lext, le_link);
+}
+
+/**
+ * Returns a free extent of at least @len blocks: the smallest one of the
+ * size class of @len, or the first one of the next non-empty class.
+ */
+static struct m0_lext *zone_ext_fit(struct m0_balloc_zone_param *zp,
+				    m0_bcount_t len)
+{
+	struct m0_lext *le;
+	struct m0_lext *fit = NULL;
+	unsigned        c = zone_size_class(len);
+	uint64_t        map;
+
+	m0_list_for_each_entry(&zp->bzp_size[c], le, struct m0_lext,
+			       le_size_link) {
+		if (m0_ext_length(&le->le_ext) >= len &&
+		    (fit == NULL ||
+		     m0_ext_length(&le->le_ext) < m0_ext_length(&fit->le_ext))) {
+			fit = le;
+			if (m0_ext_length(&le->le_ext) == len)
+				break;
+		}
+	}
+	/* Classes above c, lowest non-empty first. */
+	map = zp->bzp_size_map & ~(M0_BITS(c + 1) - 1);
+	if (fit == NULL && map != 0) {
+		c = m0_log2(map & -map);
+		fit = m0_list_entry(m0_list_first(&zp->bzp_size[c]),
+				    struct m0_lext, le_size_link);
+	}
+	return fit;
+}
+
+/** Returns the largest free extent of the zone. */
+static struct m0_lext *zone_ext_largest(struct m0_balloc_zone_param *zp)
+{
+	struct m0_lext *le;
+	struct m0_lext *max = NULL;
+
+	if (zp->bzp_size_map == 0)
+		return NULL;
+	m0_list_for_each_entry(&zp->bzp_size[m0_log2(zp->bzp_size_map)],
+			       le, struct m0_lext, le_size_link) {
+		if (max == NULL ||
+		    m0_ext_length(&le->le_ext) > m0_ext_length(&max->le_ext))
+			max = le;
+	}
+	return max;
+}
+
+static m0_bcount_t zone_maxchunk(struct m0_balloc_zone_param *zp)
 {
+	struct m0_lext *le = zone_ext_largest(zp);
+
+	return le == NULL ? 0 : m0_ext_length(&le->le_ext);
+}
+
+static void lext_del(struct m0_balloc_zone_param *zp, struct m0_lext *le)
+{
+	lext_tree_del(&zp->bzp_root, le);
+	zone_size_del(zp, le);
 	m0_list_del(&le->le_link);
 	if (le->le_is_alloc)
 		m0_free(le);
@@ -300,9 +525,10 @@ static void extents_release(struct m0_balloc_group_info *grp,
 	zp = is_spare(zone_type) ? &grp->bgi_spare : &grp->bgi_normal;
 	while ((l = m0_list_first(&zp->bzp_extents)) != NULL) {
 		le = m0_list_entry(l, struct m0_lext, le_link);
-		lext_del(le);
+		lext_del(zp, le);
 		++frags;
 	}
+	M0_ASSERT(zp->bzp_root == NULL && zp->bzp_size_map == 0);
 	M0_LOG(M0_DEBUG, "zone_type = %d, grp=%p grpno=%" PRIu64 " list_frags=%d"
 	       "bzp_frags=%d", (int)zone_type, grp, grp->bgi_groupno,
 	       (int)frags, (int)zp->bzp_fragments);
@@ -402,8 +628,8 @@ static int balloc_group_info_init(struct m0_balloc_group_info *gi,
 static void balloc_group_info_fini(struct m0_balloc_group_info *gi)
 {
 	m0_mutex_fini(bgi_mutex(gi));
-	m0_list_fini(&gi->bgi_normal.bzp_extents);
-	m0_list_fini(&gi->bgi_spare.bzp_extents);
+	balloc_zone_fini(&gi->bgi_normal);
+	balloc_zone_fini(&gi->bgi_spare);
 }
 
 static int balloc_group_info_load(struct m0_balloc *bal)
@@ -428,6 +654,120 @@ static int balloc_group_info_load(struct m0_balloc *bal)
 	return M0_RC(rc);
 }
 
+static bool balloc_loader_stopped(struct m0_balloc *bal)
+{
+	bool stop;
+
+	m0_mutex_lock(&bal->cb_sb_mutex.bm_u.mutex);
+	stop = bal->cb_loader->bl_stop;
+	m0_mutex_unlock(&bal->cb_sb_mutex.bm_u.mutex);
+	return stop;
+}
+
+/**
+ * Returns unused preallocation windows to their groups, in transactions of
+ * at most M0_BALLOC_PREALLOC_TRIM_NR windows.
+ */
+static void balloc_prealloc_trim_all(struct m0_balloc *bal)
+{
+	struct m0_sm_group     *grp = m0_locality0_get()->lo_grp;   /* XXX */
+	struct m0_be_tx         tx;
+	struct m0_be_tx_credit  cred;
+	int                     rc;
+
+	do {
+		M0_SET0(&tx);
+		cred = M0_BE_TX_CREDIT(0, 0);
+		m0_balloc_prealloc_trim_credit(bal, &cred);
+		m0_sm_group_lock(grp);
+		m0_be_tx_init(&tx, 0, bal->cb_be_seg->bs_domain,
+			      grp, NULL, NULL, NULL, NULL);
+		m0_be_tx_prep(&tx, &cred);
+		rc = m0_be_tx_open_sync(&tx);
+		if (rc == 0) {
+			rc = m0_balloc_prealloc_trim(bal, &tx);
+			m0_be_tx_close_sync(&tx);
+		}
+		m0_be_tx_fini(&tx);
+		m0_sm_group_unlock(grp);
+	} while (rc == M0_BALLOC_PREALLOC_TRIM_NR &&
+		 !balloc_loader_stopped(bal));
+	if (rc < 0)
+		M0_LOG(M0_WARN, "rc=%d", rc);
+}
+
+/**
+ * Loads free extents of all groups, so that allocations after mount do not
+ * stall on reading extents of the groups they pick. Groups locked by
+ * allocations are skipped, these load themselves on demand.
+ *
+ * Then returns unused preallocation windows to their groups, when woken up by
+ * balloc_discard_prealloc() and every M0_BALLOC_PREALLOC_IDLE_SEC for windows
+ * whose owners went idle.
+ */
+static void balloc_loader(struct m0_balloc *bal)
+{
+	struct m0_balloc_loader     *ld = bal->cb_loader;
+	struct m0_balloc_group_info *grp;
+	m0_bcount_t                  i;
+	int                          rc;
+
+	for (i = 0; i < bal->cb_sb.bsb_groupcount &&
+		    !balloc_loader_stopped(bal); ++i) {
+		grp = m0_balloc_gn2info(bal, i);
+		if (m0_balloc_trylock_group(grp) != 0)
+			continue;
+		rc = m0_balloc_load_extents(bal, grp);
+		m0_balloc_unlock_group(grp);
+		if (rc != 0) {
+			M0_LOG(M0_WARN, "group=%"PRIu64" rc=%d", i, rc);
+			break;
+		}
+	}
+	while (!balloc_loader_stopped(bal)) {
+		(void)m0_semaphore_timeddown(&ld->bl_wakeup,
+				m0_time_from_now(M0_BALLOC_PREALLOC_IDLE_SEC,
+						 0));
+		if (!balloc_loader_stopped(bal))
+			balloc_prealloc_trim_all(bal);
+	}
+}
+
+static int balloc_loader_start(struct m0_balloc *bal)
+{
+	int rc;
+
+	M0_PRE(bal->cb_loader == NULL);
+
+	if (bal->cb_group_info == NULL)
+		return 0;
+	M0_ALLOC_PTR(bal->cb_loader);
+	if (bal->cb_loader == NULL)
+		return M0_ERR(-ENOMEM);
+	m0_semaphore_init(&bal->cb_loader->bl_wakeup, 0);
+	rc = M0_THREAD_INIT(&bal->cb_loader->bl_thread, struct m0_balloc *,
+			    NULL, &balloc_loader, bal, "m0_balloc_ld");
+	if (rc != 0) {
+		m0_semaphore_fini(&bal->cb_loader->bl_wakeup);
+		m0_free0(&bal->cb_loader);
+	}
+	return M0_RC(rc);
+}
+
+static void balloc_loader_stop(struct m0_balloc *bal)
+{
+	if (bal->cb_loader == NULL)
+		return;
+	m0_mutex_lock(&bal->cb_sb_mutex.bm_u.mutex);
+	bal->cb_loader->bl_stop = true;
+	m0_mutex_unlock(&bal->cb_sb_mutex.bm_u.mutex);
+	m0_semaphore_up(&bal->cb_loader->bl_wakeup);
+	m0_thread_join(&bal->cb_loader->bl_thread);
+	m0_thread_fini(&bal->cb_loader->bl_thread);
+	m0_semaphore_fini(&bal->cb_loader->bl_wakeup);
+	m0_free0(&bal->cb_loader);
+}
+
 /**
    finalization of the balloc environment.
  */
@@ -438,6 +778,7 @@ static void balloc_fini_internal(struct m0_balloc *bal)
 
 	M0_ENTRY();
 
+	balloc_loader_stop(bal);
 	if (bal->cb_group_info != NULL) {
 		for (i = 0 ; i < bal->cb_sb.bsb_groupcount; i++) {
 			gi = &bal->cb_group_info[i];
@@ -448,9 +789,11 @@ static void balloc_fini_internal(struct m0_balloc *bal)
 		}
 		m0_free0(&bal->cb_group_info);
 	}
+	m0_free0(&bal->cb_prealloc_owner);
 
 	m0_be_btree_fini(&bal->cb_db_group_extents);
 	m0_be_btree_fini(&bal->cb_db_group_desc);
+	m0_be_seg_unpin(bal->cb_be_seg, bal, sizeof *bal);
 
 	M0_LEAVE();
 }
@@ -613,6 +956,7 @@ static int balloc_sb_write(struct m0_balloc            *bal,
 	sb->bsb_mnt_count	= 0;
 	sb->bsb_max_mnt_count	= 1024;
 	sb->bsb_stripe_size	= 0;
+	M0_SET_ARR0(bal->cb_prealloc);
 
 	rc = sb_update(bal, grp);
 	if (rc != 0)
@@ -778,6 +1122,8 @@ static void balloc_zone_init(struct m0_balloc_zone_param *zone, uint64_t type,
 			     m0_bcount_t freeblocks, m0_bcount_t fragments,
 			     m0_bcount_t maxchunk)
 {
+	int i;
+
 	zone->bzp_type = type;
 	zone->bzp_range.e_start = start;
 	zone->bzp_range.e_end = start + size;
@@ -785,6 +1131,20 @@ static void balloc_zone_init(struct m0_balloc_zone_param *zone, uint64_t type,
 	zone->bzp_fragments = fragments;
 	zone->bzp_maxchunk = maxchunk;
 	m0_list_init(&zone->bzp_extents);
+	zone->bzp_root = NULL;
+	zone->bzp_seed = start;
+	zone->bzp_size_map = 0;
+	for (i = 0; i < ARRAY_SIZE(zone->bzp_size); ++i)
+		m0_list_init(&zone->bzp_size[i]);
+}
+
+static void balloc_zone_fini(struct m0_balloc_zone_param *zone)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(zone->bzp_size); ++i)
+		m0_list_fini(&zone->bzp_size[i]);
+	m0_list_fini(&zone->bzp_extents);
 }
 
 static int balloc_groups_write(struct m0_balloc *bal)
@@ -957,16 +1317,32 @@ static int balloc_init_internal(struct m0_balloc *bal,
 				m0_bcount_t blocks_per_group,
 				m0_bcount_t spare_blocks_per_group)
 {
-	int rc;
+	struct m0_format_tag tag;
+	int                  rc;
 
 	M0_ENTRY();
 
+	/* cb_group_info and cb_sb_mutex are volatile, see m0_be_btree_init(). */
+	m0_be_seg_pin(seg, bal, sizeof *bal);
 	bal->cb_be_seg = seg;
 	bal->cb_group_info = NULL;
+	bal->cb_loader = NULL;
 	m0_mutex_init(&bal->cb_sb_mutex.bm_u.mutex);
 
 	m0_be_btree_init(&bal->cb_db_group_desc, seg, &gd_btree_ops);
 	m0_be_btree_init(&bal->cb_db_group_extents, seg, &ge_btree_ops);
+	/*
+	 * Keys and values of both trees have fixed size and the comparators
+	 * only compare the key values, see m0_be_btree_optimistic_set().
+	 */
+	m0_be_btree_optimistic_set(&bal->cb_db_group_desc, true);
+	m0_be_btree_optimistic_set(&bal->cb_db_group_extents, true);
+
+	M0_ALLOC_ARR(bal->cb_prealloc_owner, M0_BALLOC_PREALLOC_NR);
+	if (bal->cb_prealloc_owner == NULL) {
+		rc = M0_ERR(-ENOMEM);
+		goto out;
+	}
 
 	if (bal->cb_sb.bsb_magic != M0_BALLOC_SB_MAGIC) {
 		struct m0_balloc_format_req req = { 0 };
@@ -983,6 +1359,14 @@ static int balloc_init_internal(struct m0_balloc *bal,
 		return M0_RC(rc);
 	}
 
+	m0_format_header_unpack(&tag, &bal->cb_header);
+	if (tag.ot_version != M0_BALLOC_FORMAT_VERSION) {
+		rc = M0_ERR_INFO(-EPROTO, "balloc format version mismatch: "
+				 "expected %d, stored %d",
+				 M0_BALLOC_FORMAT_VERSION, (int)tag.ot_version);
+		goto out;
+	}
+
 	if (bal->cb_sb.bsb_blocksize != 1 << bshift) {
 		rc = -EINVAL;
 		goto out;
@@ -1023,9 +1407,10 @@ static int balloc_init_ac(struct balloc_allocation_context *bac,
 	bac->bac_flags	  = req->bar_flags;
 	bac->bac_status	  = M0_BALLOC_AC_CONTINUE;
 	bac->bac_criteria = 0;
+	bac->bac_prealloc = -1;
 
 	if (req->bar_goal == 0)
-		req->bar_goal = motr->cb_last;
+		req->bar_goal = balloc_prealloc_goal(motr, req->bar_owner);
 
 	bac->bac_orig.e_start	= req->bar_goal;
 	bac->bac_orig.e_end	= req->bar_goal + req->bar_len;
@@ -1040,12 +1425,6 @@ static int balloc_init_ac(struct balloc_allocation_context *bac,
 	return M0_RC(0);
 }
 
-
-static int balloc_use_prealloc(struct balloc_allocation_context *bac)
-{
-	return 0;
-}
-
 static bool is_spare(uint64_t alloc_flags)
 {
 	return alloc_flags & M0_BALLOC_SPARE_ZONE;
@@ -1061,6 +1440,281 @@ static bool is_any(uint64_t alloc_flag)
 	return is_spare(alloc_flag) && is_normal(alloc_flag);
 }
 
+static bool balloc_prealloc_is_empty(const struct m0_balloc_prealloc *pa)
+{
+	return pa->bp_start == pa->bp_end;
+}
+
+/* called under cb_sb_mutex */
+static bool balloc_prealloc_is_owned(const struct m0_balloc *bal, int i,
+				     m0_time_t now)
+{
+	const struct m0_balloc_prealloc_owner *o = &bal->cb_prealloc_owner[i];
+
+	return o->bpo_owned &&
+	       m0_time_sub(now, o->bpo_used) <
+	       M0_MKTIME(M0_BALLOC_PREALLOC_IDLE_SEC, 0);
+}
+
+/* called under cb_sb_mutex */
+static int balloc_prealloc_find(const struct m0_balloc *bal,
+				const struct m0_fid *owner)
+{
+	const struct m0_balloc_prealloc_owner *o;
+	int                                    i;
+
+	for (i = 0; owner != NULL && i < M0_BALLOC_PREALLOC_NR; ++i) {
+		o = &bal->cb_prealloc_owner[i];
+		if (o->bpo_owned && m0_fid_eq(&o->bpo_fid, owner))
+			return i;
+	}
+	return -1;
+}
+
+/* called under cb_sb_mutex */
+static void balloc_prealloc_own(struct m0_balloc *bal, int i,
+				const struct m0_fid *owner, m0_time_t now)
+{
+	struct m0_balloc_prealloc_owner *o = &bal->cb_prealloc_owner[i];
+	int                              old = balloc_prealloc_find(bal, owner);
+
+	if (old >= 0 && old != i)
+		bal->cb_prealloc_owner[old].bpo_owned = false;
+	o->bpo_owned = owner != NULL;
+	o->bpo_fid   = owner != NULL ? *owner : M0_FID0;
+	o->bpo_used  = now;
+}
+
+/**
+   Returns the goal of a request that has none: the end of the last
+   allocation of the owner, so that its data stay contiguous, or the end of
+   the last allocation of anybody.
+ */
+static m0_bindex_t balloc_prealloc_goal(struct m0_balloc *bal,
+					const struct m0_fid *owner)
+{
+	m0_bindex_t goal = bal->cb_last;
+	int         i;
+
+	m0_mutex_lock(&bal->cb_sb_mutex.bm_u.mutex);
+	i = balloc_prealloc_find(bal, owner);
+	if (i >= 0 && balloc_prealloc_is_owned(bal, i, m0_time_now()))
+		goal = bal->cb_prealloc_owner[i].bpo_last;
+	m0_mutex_unlock(&bal->cb_sb_mutex.bm_u.mutex);
+	return goal;
+}
+
+/**
+   Remembers where the allocation of the request owner ended. An owner without
+   a window takes an empty slot, if any, see balloc_prealloc_goal() and
+   balloc_owner_is_streaming().
+ */
+static void balloc_prealloc_note(struct m0_balloc *bal,
+				 const struct m0_fid *owner,
+				 const struct m0_ext *ext)
+{
+	m0_time_t now = m0_time_now();
+	int       i;
+
+	if (owner == NULL)
+		return;
+	m0_mutex_lock(&bal->cb_sb_mutex.bm_u.mutex);
+	i = balloc_prealloc_find(bal, owner);
+	if (i < 0) {
+		for (i = 0; i < M0_BALLOC_PREALLOC_NR; ++i) {
+			if (balloc_prealloc_is_empty(&bal->cb_prealloc[i]) &&
+			    !bal->cb_prealloc_owner[i].bpo_busy &&
+			    !balloc_prealloc_is_owned(bal, i, now))
+				break;
+		}
+		if (i < M0_BALLOC_PREALLOC_NR)
+			balloc_prealloc_own(bal, i, owner, now);
+	}
+	if (i < M0_BALLOC_PREALLOC_NR) {
+		bal->cb_prealloc_owner[i].bpo_last = ext->e_end;
+		bal->cb_prealloc_owner[i].bpo_used = now;
+	}
+	m0_mutex_unlock(&bal->cb_sb_mutex.bm_u.mutex);
+}
+
+/**
+   Owner streams, if the request continues its previous allocation. Only then
+   the request is normalised to M0_BALLOC_PREALLOC_FACTOR times its length: a
+   window given to an object written once would only fragment the groups.
+ */
+static bool balloc_owner_is_streaming(struct balloc_allocation_context *bac)
+{
+	struct m0_balloc *bal = bac->bac_ctxt;
+	bool              streaming;
+	int               i;
+
+	m0_mutex_lock(&bal->cb_sb_mutex.bm_u.mutex);
+	i = balloc_prealloc_find(bal, bac->bac_req->bar_owner);
+	streaming = i >= 0 &&
+		    balloc_prealloc_is_owned(bal, i, m0_time_now()) &&
+		    bal->cb_prealloc_owner[i].bpo_last == bac->bac_orig.e_start;
+	m0_mutex_unlock(&bal->cb_sb_mutex.bm_u.mutex);
+	return streaming;
+}
+
+M0_INTERNAL void m0_balloc_prealloc_trim_credit(const struct m0_balloc *bal,
+						struct m0_be_tx_credit *accum)
+{
+	int i;
+
+	balloc_db_update_credit(bal, M0_BALLOC_PREALLOC_TRIM_NR, accum);
+	for (i = 0; i < M0_BALLOC_PREALLOC_TRIM_NR; ++i)
+		balloc_sb_sync_credit(bal, accum);
+}
+
+M0_INTERNAL int m0_balloc_prealloc_trim(struct m0_balloc *bal,
+					struct m0_be_tx  *tx)
+{
+	struct m0_balloc_prealloc *pa;
+	struct m0_balloc_free_req  req;
+	m0_time_t                  now = m0_time_now();
+	m0_bindex_t                start;
+	int                        nr  = 0;
+	int                        i;
+	int                        rc;
+
+	for (i = 0; i < M0_BALLOC_PREALLOC_NR &&
+		    nr < M0_BALLOC_PREALLOC_TRIM_NR; ++i) {
+		pa = &bal->cb_prealloc[i];
+		m0_mutex_lock(&bal->cb_sb_mutex.bm_u.mutex);
+		if (balloc_prealloc_is_empty(pa) ||
+		    bal->cb_prealloc_owner[i].bpo_busy ||
+		    balloc_prealloc_is_owned(bal, i, now)) {
+			m0_mutex_unlock(&bal->cb_sb_mutex.bm_u.mutex);
+			continue;
+		}
+		/* Claim the window, so that allocations leave it alone. */
+		start = pa->bp_start;
+		req.bfr_physical = pa->bp_start;
+		req.bfr_len      = pa->bp_end - pa->bp_start;
+		pa->bp_start = pa->bp_end;
+		bal->cb_prealloc_owner[i].bpo_busy  = true;
+		bal->cb_prealloc_owner[i].bpo_owned = false;
+		bal->cb_sb.bsb_state |= M0_BALLOC_SB_DIRTY;
+		balloc_sb_sync(bal, tx);
+		m0_mutex_unlock(&bal->cb_sb_mutex.bm_u.mutex);
+
+		rc = balloc_free_internal(bal, tx, &req);
+
+		m0_mutex_lock(&bal->cb_sb_mutex.bm_u.mutex);
+		if (rc != 0) {
+			pa->bp_start = start;
+			bal->cb_sb.bsb_state |= M0_BALLOC_SB_DIRTY;
+			balloc_sb_sync(bal, tx);
+		}
+		bal->cb_prealloc_owner[i].bpo_busy = false;
+		m0_mutex_unlock(&bal->cb_sb_mutex.bm_u.mutex);
+		if (rc != 0)
+			return M0_ERR(rc);
+		M0_LOG(M0_DEBUG, "window=%d [%"PRIx64", %"PRIx64") trimmed", i,
+		       req.bfr_physical, req.bfr_physical + req.bfr_len);
+		++nr;
+	}
+	return nr;
+}
+
+/**
+   Allocates from a preallocation window.
+
+   The window of the request owner is used if it is not empty. Otherwise a
+   window without an active owner is adopted. If "steal" is true, any
+   non-empty window is used: this is the last resort when free space is
+   exhausted.
+
+   @return true iff bac->bac_final is allocated from a window.
+ */
+static bool balloc_use_prealloc(struct balloc_allocation_context *bac,
+				bool steal)
+{
+	struct m0_balloc          *bal   = bac->bac_ctxt;
+	const struct m0_fid       *owner = bac->bac_req->bar_owner;
+	struct m0_balloc_prealloc *pa;
+	m0_bcount_t                len;
+	m0_time_t                  now   = m0_time_now();
+	int                        i;
+
+	if (is_spare(bac->bac_flags) || m0_ext_length(&bac->bac_orig) == 0)
+		return false;
+
+	m0_mutex_lock(&bal->cb_sb_mutex.bm_u.mutex);
+	i = balloc_prealloc_find(bal, owner);
+	if (i < 0 || balloc_prealloc_is_empty(&bal->cb_prealloc[i])) {
+		for (i = 0; i < M0_BALLOC_PREALLOC_NR; ++i) {
+			if (!balloc_prealloc_is_empty(&bal->cb_prealloc[i]) &&
+			    !bal->cb_prealloc_owner[i].bpo_busy &&
+			    (steal || !balloc_prealloc_is_owned(bal, i, now)))
+				break;
+		}
+		if (i == M0_BALLOC_PREALLOC_NR)
+			i = -1;
+	}
+	if (i >= 0) {
+		pa  = &bal->cb_prealloc[i];
+		len = min_check(m0_ext_length(&bac->bac_orig),
+				pa->bp_end - pa->bp_start);
+		bac->bac_final.e_start = pa->bp_start;
+		bac->bac_final.e_end   = pa->bp_start + len;
+		m0_ext_init(&bac->bac_final);
+		pa->bp_start += len;
+		bac->bac_status = M0_BALLOC_AC_FOUND;
+		balloc_prealloc_own(bal, i, owner, now);
+
+		bal->cb_sb.bsb_state |= M0_BALLOC_SB_DIRTY;
+		balloc_sb_sync(bal, bac->bac_tx);
+		M0_LOG(M0_DEBUG, "window=%d final="EXT_F, i,
+		       EXT_P(&bac->bac_final));
+	}
+	m0_mutex_unlock(&bal->cb_sb_mutex.bm_u.mutex);
+	return i >= 0;
+}
+
+/**
+   Installs the window claimed by balloc_new_preallocation(): the tail of
+   bac->bac_final beyond the original request, which is already allocated in
+   the group extents tree, becomes the window.
+ */
+static void balloc_prealloc_install(struct balloc_allocation_context *bac)
+{
+	struct m0_balloc          *bal = bac->bac_ctxt;
+	struct m0_balloc_prealloc *pa  = &bal->cb_prealloc[bac->bac_prealloc];
+	m0_bindex_t                end;
+
+	M0_PRE(m0_ext_length(&bac->bac_final) >
+	       m0_ext_length(&bac->bac_orig));
+
+	end = bac->bac_final.e_start + m0_ext_length(&bac->bac_orig);
+	m0_mutex_lock(&bal->cb_sb_mutex.bm_u.mutex);
+	M0_ASSERT(balloc_prealloc_is_empty(pa));
+	pa->bp_start = end;
+	pa->bp_end   = bac->bac_final.e_end;
+	balloc_prealloc_own(bal, bac->bac_prealloc, bac->bac_req->bar_owner,
+			    m0_time_now());
+	bal->cb_prealloc_owner[bac->bac_prealloc].bpo_busy = false;
+	bal->cb_sb.bsb_state |= M0_BALLOC_SB_DIRTY;
+	balloc_sb_sync(bal, bac->bac_tx);
+	m0_mutex_unlock(&bal->cb_sb_mutex.bm_u.mutex);
+	M0_LOG(M0_DEBUG, "window=%d [%"PRIx64", %"PRIx64")", bac->bac_prealloc,
+	       pa->bp_start, pa->bp_end);
+
+	bac->bac_final.e_end = end;
+	bac->bac_prealloc = -1;
+}
+
+static void balloc_prealloc_unclaim(struct balloc_allocation_context *bac)
+{
+	struct m0_balloc *bal = bac->bac_ctxt;
+
+	m0_mutex_lock(&bal->cb_sb_mutex.bm_u.mutex);
+	bal->cb_prealloc_owner[bac->bac_prealloc].bpo_busy = false;
+	m0_mutex_unlock(&bal->cb_sb_mutex.bm_u.mutex);
+	bac->bac_prealloc = -1;
+}
+
 /**
  * Checks if enough free blocks are present in super block.
  *
@@ -1128,7 +1782,11 @@ balloc_normalize_request(struct balloc_allocation_context *bac)
 		goto out;
 	}
 
-	/* @todo : removing normalisation for time. */
+	/* Leave room for the following requests of a streaming owner. */
+	if (balloc_owner_is_streaming(bac))
+		size = max_check(size * M0_BALLOC_PREALLOC_FACTOR,
+				 bac->bac_ctxt->cb_sb.bsb_prealloc_count);
+
 	if (size <= 4 ) {
 		size = 4;
 	} else if (size <= 8) {
@@ -1150,8 +1808,11 @@ balloc_normalize_request(struct balloc_allocation_context *bac)
 	} else if (size <= 2048) {
 		size = 2048;
 	} else {
-		M0_LOG(M0_WARN, "length %llu is too large, truncate to %llu",
-			(unsigned long long) size, MAX_ALLOCATION_CHUNK);
+		if (m0_ext_length(&bac->bac_orig) > MAX_ALLOCATION_CHUNK)
+			M0_LOG(M0_WARN, "length %llu is too large, "
+			       "truncate to %llu",
+			       (unsigned long long)m0_ext_length(&bac->bac_orig),
+			       MAX_ALLOCATION_CHUNK);
 		size = MAX_ALLOCATION_CHUNK;
 	}
 
@@ -1232,11 +1893,13 @@ M0_INTERNAL int m0_balloc_load_extents(struct m0_balloc *cb,
 		ex->le_ext.e_end   = *(m0_bindex_t*)key.b_addr;
 		ex->le_ext.e_start = *(m0_bindex_t*)val.b_addr;
 		m0_ext_init(&ex->le_ext);
-		if (m0_ext_is_partof(&normal_range, &ex->le_ext))
+		if (m0_ext_is_partof(&normal_range, &ex->le_ext)) {
 			m0_list_add_tail(group_normal_ext(grp),
 					 &ex->le_link);
-		else if (m0_ext_is_partof(&spare_range, &ex->le_ext)) {
+			zone_ext_add(&grp->bgi_normal, ex);
+		} else if (m0_ext_is_partof(&spare_range, &ex->le_ext)) {
 			m0_list_add_tail(group_spare_ext(grp), &ex->le_link);
+			zone_ext_add(&grp->bgi_spare, ex);
 		}
 		else {
 			M0_LOG(M0_ERROR, "Invalid extent");
@@ -1334,11 +1997,13 @@ M0_INTERNAL int m0_balloc_load_extents(struct m0_balloc *cb,
 		m0_ext_init(&ex->le_ext);
 		if (m0_ext_is_partof(&normal_range, &ex->le_ext)) {
 			m0_list_add_tail(group_normal_ext(grp), &ex->le_link);
+			zone_ext_add(&grp->bgi_normal, ex);
 			++normal_frags;
 			zone_params_update(grp, &ex->le_ext,
 					   M0_BALLOC_NORMAL_ZONE);
 		} else if (m0_ext_is_partof(&spare_range, &ex->le_ext)) {
 			m0_list_add_tail(group_spare_ext(grp), &ex->le_link);
+			zone_ext_add(&grp->bgi_spare, ex);
 			++spare_frags;
 			zone_params_update(grp, &ex->le_ext,
 					   M0_BALLOC_SPARE_ZONE);
@@ -1405,7 +2070,8 @@ static int balloc_find_extent_buddy(struct balloc_allocation_context *bac,
 {
 	int                          found = 0;
 	m0_bcount_t                  flen;
-	m0_bcount_t start;
+	m0_bcount_t                  start;
+	unsigned                     c;
 	struct m0_ext               *frag;
 	struct m0_lext              *le;
 	struct m0_ext                min = {
@@ -1424,38 +2090,28 @@ static int balloc_find_extent_buddy(struct balloc_allocation_context *bac,
 	       zp->bzp_range.e_start, len);
 
 	start = zp->bzp_range.e_start;
-	m0_list_for_each_entry(&zp->bzp_extents, le, struct m0_lext, le_link) {
-		frag = &le->le_ext;
-		flen = m0_ext_length(frag);
-		M0_LOG(M0_DEBUG, "frag="EXT_F, EXT_P(frag));
-repeat:
-		/*
-		{
-			char msg[128];
-			sprintf(msg, "buddy[s=%llu:0x%08llx, l=%u:0x%08x]",
-			(unsigned long long)start,
-			(unsigned long long)start,
-			(int)len, (int)len);
-			(void)msg;
-			balloc_debug_dump_extent(msg, frag);
-			}
-		*/
-		if (frag->e_start == start && flen >= len) {
+	/*
+	 * Look for the smallest extent starting at a multiple of len from the
+	 * zone start. Size classes are scanned upwards, extents of the next
+	 * class are all larger than the ones already found.
+	 */
+	for (c = zone_size_class(len);
+	     c < M0_BALLOC_SIZE_CLASS_NR && found == 0; ++c) {
+		if (!(zp->bzp_size_map & M0_BITS(c)))
+			continue;
+		m0_list_for_each_entry(&zp->bzp_size[c], le, struct m0_lext,
+				       le_size_link) {
+			frag = &le->le_ext;
+			flen = m0_ext_length(frag);
+			M0_LOG(M0_DEBUG, "frag="EXT_F, EXT_P(frag));
+			if (flen < len || (frag->e_start - start) % len != 0)
+				continue;
 			++found;
 			if (flen < m0_ext_length(&min))
 				min = *frag;
 			if (flen == len || found > M0_BALLOC_BUDDY_LOOKUP_MAX)
 				break;
 		}
-		if (frag->e_start > start) {
-			do {
-				start += len;
-			} while (frag->e_start > start);
-			if (start >= zp->bzp_range.e_end)
-				break;
-			/* we changed the 'start'. let's restart searching. */
-			goto repeat;
-		}
 	}
 
 	if (found > 0)
@@ -1487,13 +2143,48 @@ static int balloc_use_best_found(struct balloc_allocation_context *bac,
 	return 0;
 }
 
+/**
+   Decides what to do with the part of bac->bac_final beyond the original
+   request. It is kept if a free window is claimed for the request owner, see
+   balloc_prealloc_install(). Otherwise, the result is trimmed to the original
+   length.
+
+   Called under the group lock, before the group extents tree is updated.
+ */
 static int balloc_new_preallocation(struct balloc_allocation_context *bac)
 {
-	/* XXX No Preallocation now. So, trim the result to the original length. */
+	struct m0_balloc    *bal   = bac->bac_ctxt;
+	const struct m0_fid *owner = bac->bac_req->bar_owner;
+	m0_time_t            now   = m0_time_now();
+	int                  i;
 
+	M0_PRE(bac->bac_prealloc < 0);
+
+	if (m0_ext_length(&bac->bac_final) <= m0_ext_length(&bac->bac_orig))
+		return 0;
+	if (owner != NULL && !(bac->bac_flags & M0_BALLOC_HINT_NOPREALLOC)) {
+		m0_mutex_lock(&bal->cb_sb_mutex.bm_u.mutex);
+		i = balloc_prealloc_find(bal, owner);
+		if (i < 0 || bal->cb_prealloc_owner[i].bpo_busy ||
+		    !balloc_prealloc_is_empty(&bal->cb_prealloc[i])) {
+			for (i = 0; i < M0_BALLOC_PREALLOC_NR; ++i) {
+				if (balloc_prealloc_is_empty(
+						&bal->cb_prealloc[i]) &&
+				    !bal->cb_prealloc_owner[i].bpo_busy &&
+				    !balloc_prealloc_is_owned(bal, i, now))
+					break;
+			}
+		}
+		if (i < M0_BALLOC_PREALLOC_NR) {
+			bal->cb_prealloc_owner[i].bpo_busy = true;
+			bac->bac_prealloc = i;
+		}
+		m0_mutex_unlock(&bal->cb_sb_mutex.bm_u.mutex);
+		if (bac->bac_prealloc >= 0)
+			return 0;
+	}
 	bac->bac_final.e_end = bac->bac_final.e_start +
-					min_check(m0_ext_length(&bac->bac_orig),
-					          m0_ext_length(&bac->bac_final));
+					m0_ext_length(&bac->bac_orig);
 	return 0;
 }
 
@@ -1540,19 +2231,16 @@ static bool is_extent_free(struct m0_balloc_group_info *grp,
 {
 	struct m0_lext              *le;
 	struct m0_balloc_zone_param *zp;
-	m0_bcount_t                  frags = 0;
 
 	M0_ENTRY();
 
 	zp = is_spare(alloc_type) ? &grp->bgi_spare : &grp->bgi_normal;
 
-	m0_list_for_each_entry(&zp->bzp_extents, le, struct m0_lext, le_link) {
-		*current = &le->le_ext;
-		if (m0_ext_is_partof(*current, tgt))
-			break;
-		++frags;
-	}
-	return frags < zp->bzp_fragments;
+	le = zone_ext_floor(zp, tgt->e_start);
+	if (le == NULL || !m0_ext_is_partof(&le->le_ext, tgt))
+		return false;
+	*current = &le->le_ext;
+	return true;
 }
 
 static int balloc_alloc_db_update(struct m0_balloc *motr, struct m0_be_tx *tx,
@@ -1567,7 +2255,7 @@ static int balloc_alloc_db_update(struct m0_balloc *motr, struct m0_be_tx *tx,
 	struct m0_lext              *lcur;
 	struct m0_balloc_zone_param *zp;
 	int                          rc = 0;
-	m0_bcount_t                  maxchunk;
+	m0_bcount_t                  len;
 
 	M0_ENTRY();
 	M0_PRE(m0_mutex_is_locked(bgi_mutex(grp)));
@@ -1579,25 +2267,11 @@ static int balloc_alloc_db_update(struct m0_balloc *motr, struct m0_be_tx *tx,
 	balloc_debug_dump_extent("target=", tgt);
 
 	zp = is_spare(alloc_type) ? &grp->bgi_spare : &grp->bgi_normal;
-	maxchunk = zp->bzp_maxchunk;
+	lcur = container_of(cur, struct m0_lext, le_ext);
+	len = m0_ext_length(cur);
 
 	balloc_debug_dump_extent("current=", cur);
 
-	if (m0_ext_length(cur) == zp->bzp_maxchunk) {
-		/* find next to max sized chunk */
-		maxchunk = 0;
-		m0_list_for_each_entry(&zp->bzp_extents, le,
-				       struct m0_lext, le_link) {
-			if (&le->le_ext == cur)
-				continue;
-			maxchunk = max_check(maxchunk,
-					     m0_ext_length(&le->le_ext));
-		}
-	}
-
-	M0_LOG(M0_DEBUG, "bzp_maxchunk=0x%" PRIx64 " next_maxchunk=0x%"PRIx64,
-	       zp->bzp_maxchunk, maxchunk);
-
 	if (cur->e_end == tgt->e_end) {
 		key = (struct m0_buf)M0_BUF_INIT_PTR(&cur->e_end);
 
@@ -1611,19 +2285,18 @@ static int balloc_alloc_db_update(struct m0_balloc *motr, struct m0_be_tx *tx,
 			/* |      |  tgt  |                    | */
 			/* +------+-------+--------------------+ */
 			cur->e_end = tgt->e_start;
+			zone_ext_resize(zp, lcur, len);
 			key = (struct m0_buf)M0_BUF_INIT_PTR(&cur->e_end);
 			val = (struct m0_buf)M0_BUF_INIT_PTR(&cur->e_start);
 			rc = btree_insert_sync(db, tx, &key, &val);
 			if (rc != 0)
 				return M0_RC(rc);
-			maxchunk = max_check(maxchunk, m0_ext_length(cur));
 		} else {
 			/* +-------------+---------------------+ */
 			/* |   cur free  |      allocated      | */
 			/* |     tgt     |                     | */
 			/* +-------------+---------------------+ */
-			le = container_of(cur, struct m0_lext, le_ext);
-			lext_del(le);
+			lext_del(zp, lcur);
 			zp->bzp_fragments--;
 		}
 	} else {
@@ -1634,6 +2307,7 @@ static int balloc_alloc_db_update(struct m0_balloc *motr, struct m0_be_tx *tx,
 		/* |     tgt    |                      | */
 		/* +------------+----------------------+ */
 		cur->e_start = tgt->e_end;
+		zone_ext_resize(zp, lcur, len);
 
 		key = (struct m0_buf)M0_BUF_INIT_PTR(&cur->e_end);
 		val = (struct m0_buf)M0_BUF_INIT_PTR(&cur->e_start);
@@ -1641,8 +2315,6 @@ static int balloc_alloc_db_update(struct m0_balloc *motr, struct m0_be_tx *tx,
 		if (rc != 0)
 			return M0_RC(rc);
 
-		maxchunk = max_check(maxchunk, m0_ext_length(cur));
-
 		if (new.e_start < tgt->e_start) {
 			/* +-----------------------------------+ */
 			/* |              cur free             | */
@@ -1659,13 +2331,13 @@ static int balloc_alloc_db_update(struct m0_balloc *motr, struct m0_be_tx *tx,
 				m0_free(le);
 				return M0_RC(rc);
 			}
-			lcur = container_of(cur, struct m0_lext, le_ext);
 			m0_list_add_before(&lcur->le_link, &le->le_link);
+			zone_ext_add(zp, le);
 			zp->bzp_fragments++;
-			maxchunk = max_check(maxchunk, m0_ext_length(&new));
 		}
 	}
-	zp->bzp_maxchunk = maxchunk;
+	zp->bzp_maxchunk = zone_maxchunk(zp);
+	M0_LOG(M0_DEBUG, "bzp_maxchunk=0x%" PRIx64, zp->bzp_maxchunk);
 	zp->bzp_freeblocks -= m0_ext_length(tgt);
 
 	grp->bgi_state |= M0_BALLOC_GROUP_INFO_DIRTY;
@@ -1698,9 +2370,11 @@ static int balloc_free_db_update(struct m0_balloc *motr,
 	struct m0_ext               *pre = NULL;
 	struct m0_lext              *le;
 	struct m0_lext              *lcur;
+	struct m0_lext              *lpre;
 	struct m0_balloc_zone_param *zp;
-	m0_bcount_t                  frags = 0;
 	m0_bcount_t                  maxchunk;
+	m0_bcount_t                  len;
+	m0_bindex_t                  start;
 	int                          rc = 0;
 	int                          found = 0;
 
@@ -1711,16 +2385,24 @@ static int balloc_free_db_update(struct m0_balloc *motr,
 
 	zp = is_spare(alloc_flag) ? &grp->bgi_spare : &grp->bgi_normal;
 	maxchunk = zp->bzp_maxchunk;
-	m0_list_for_each_entry(&zp->bzp_extents, le, struct m0_lext, le_link) {
-		cur = &le->le_ext;
-
-		if (cur->e_start >= tgt->e_start) {
-			found = 1;
-			break;
-		}
-		pre = cur;
-		++frags;
-	}
+	/*
+	 * cur is the first extent starting at or after tgt, pre is the one
+	 * before it. If there is no such cur, both are the last extent.
+	 */
+	le = zone_ext_floor(zp, tgt->e_start);
+	if (le != NULL && le->le_ext.e_start == tgt->e_start) {
+		lcur = le;
+		lpre = zone_ext_prev(zp, le);
+	} else {
+		lpre = le;
+		lcur = zone_ext_next(zp, le);
+	}
+	found = lcur != NULL;
+	if (!found)
+		lcur = lpre;
+	cur = lcur == NULL ? NULL : &lcur->le_ext;
+	pre = lpre == NULL ? NULL : &lpre->le_ext;
+	len = cur == NULL ? 0 : m0_ext_length(cur);
 	balloc_debug_dump_extent("prev=", pre);
 	balloc_debug_dump_extent("current=", cur);
 
@@ -1743,10 +2425,8 @@ static int balloc_free_db_update(struct m0_balloc *motr,
 		return M0_RC(-EINVAL);
 	}
 
-	lcur = container_of(cur, struct m0_lext, le_ext);
-
 	if (!found) {
-		if (frags == 0) {
+		if (cur == NULL) {
 			/*       No free fragments at all:       */
 			/* +-----------------------------------+ */
 			/* |              allocated            | */
@@ -1763,6 +2443,7 @@ static int balloc_free_db_update(struct m0_balloc *motr,
 				return M0_RC(rc);
 			}
 			m0_list_add(&zp->bzp_extents, &le->le_link);
+			zone_ext_add(zp, le);
 			++zp->bzp_fragments;
 			maxchunk = max_check(maxchunk, m0_ext_length(tgt));
 		} else {
@@ -1784,6 +2465,7 @@ static int balloc_free_db_update(struct m0_balloc *motr,
 					return M0_RC(rc);
 				}
 				m0_list_add_after(&lcur->le_link, &le->le_link);
+				zone_ext_add(zp, le);
 				++zp->bzp_fragments;
 				maxchunk = max_check(maxchunk, m0_ext_length(tgt));
 			} else {
@@ -1797,6 +2479,7 @@ static int balloc_free_db_update(struct m0_balloc *motr,
 				if (rc != 0)
 					return M0_RC(rc);
 				cur->e_end = tgt->e_end;
+				zone_ext_resize(zp, lcur, len);
 				val = (struct m0_buf)M0_BUF_INIT_PTR(&cur->e_start);
 				rc = btree_insert_sync(db, tx, &key, &val);
 				if (rc != 0)
@@ -1823,6 +2506,7 @@ static int balloc_free_db_update(struct m0_balloc *motr,
 				return M0_RC(rc);
 			}
 			m0_list_add_before(&lcur->le_link, &le->le_link);
+			zone_ext_add(zp, le);
 			++zp->bzp_fragments;
 			maxchunk = max_check(maxchunk, m0_ext_length(tgt));
 		} else {
@@ -1833,6 +2517,7 @@ static int balloc_free_db_update(struct m0_balloc *motr,
 			/* +-----+---------+-------------------+ */
 			M0_ASSERT(tgt->e_end == cur->e_start);
 			cur->e_start = tgt->e_start;
+			zone_ext_resize(zp, lcur, len);
 			key = (struct m0_buf)M0_BUF_INIT_PTR(&cur->e_end);
 			val = (struct m0_buf)M0_BUF_INIT_PTR(&cur->e_start);
 			rc = btree_update_sync(db, tx, &key, &val);
@@ -1853,15 +2538,17 @@ static int balloc_free_db_update(struct m0_balloc *motr,
 			rc = btree_delete_sync(db, tx, &key);
 			if (rc != 0)
 				return M0_RC(rc);
-			cur->e_start = pre->e_start;
+			/* pre leaves the indices before cur takes its start. */
+			start = pre->e_start;
+			lext_del(zp, lpre);
+			--zp->bzp_fragments;
+			cur->e_start = start;
+			zone_ext_resize(zp, lcur, len);
 			key = (struct m0_buf)M0_BUF_INIT_PTR(&cur->e_end);
 			val = (struct m0_buf)M0_BUF_INIT_PTR(&cur->e_start);
 			rc = btree_update_sync(db, tx, &key, &val);
 			if (rc != 0)
 				return M0_RC(rc);
-			le = container_of(pre, struct m0_lext, le_ext);
-			lext_del(le);
-			--zp->bzp_fragments;
 			maxchunk = max_check(maxchunk, m0_ext_length(cur));
 		} else if (pre->e_end == tgt->e_start) {
 			/*          Joint with prev:             */
@@ -1873,7 +2560,9 @@ static int balloc_free_db_update(struct m0_balloc *motr,
 			rc = btree_delete_sync(db, tx, &key);
 			if (rc != 0)
 				return M0_RC(rc);
+			len = m0_ext_length(pre);
 			pre->e_end = tgt->e_end;
+			zone_ext_resize(zp, lpre, len);
 			val = (struct m0_buf)M0_BUF_INIT_PTR(&pre->e_start);
 			rc = btree_insert_sync(db, tx, &key, &val);
 			if (rc != 0)
@@ -1886,6 +2575,7 @@ static int balloc_free_db_update(struct m0_balloc *motr,
 			/* |          |  tgt  |                | */
 			/* +----------+-------+----------------+ */
 			cur->e_start = tgt->e_start;
+			zone_ext_resize(zp, lcur, len);
 			key = (struct m0_buf)M0_BUF_INIT_PTR(&cur->e_end);
 			val = (struct m0_buf)M0_BUF_INIT_PTR(&cur->e_start);
 			rc = btree_update_sync(db, tx, &key, &val);
@@ -1909,6 +2599,7 @@ static int balloc_free_db_update(struct m0_balloc *motr,
 				return M0_RC(rc);
 			}
 			m0_list_add_before(&lcur->le_link, &le->le_link);
+			zone_ext_add(zp, le);
 			++zp->bzp_fragments;
 			maxchunk = max_check(maxchunk, m0_ext_length(tgt));
 		}
@@ -2235,22 +2926,20 @@ static int balloc_wild_scan_group(struct balloc_allocation_context *bac,
 				  struct m0_balloc_group_info *grp,
 				  enum m0_balloc_allocation_flag alloc_flag)
 {
-	struct m0_list  *list;
-	m0_bcount_t	 free;
-	struct m0_ext	*ex;
-	struct m0_lext	*le;
-	int		 rc;
-	int              end_of_group = 0;
+	struct m0_balloc_zone_param *zp;
+	m0_bcount_t	             free;
+	struct m0_ext	            *ex;
+	struct m0_lext	            *le;
+	int		             rc;
 	M0_ENTRY();
 
 #ifdef __SPARE_SPACE__
 	free = is_spare(bac->bac_flags) ? group_spare_freeblocks_get(grp) :
 		group_freeblocks_get(grp);
-	list = is_spare(alloc_flag) ? &grp->bgi_spare.bzp_extents :
-		 &grp->bgi_normal.bzp_extents;
+	zp = is_spare(alloc_flag) ? &grp->bgi_spare : &grp->bgi_normal;
 #else
 	free = group_freeblocks_get(grp);
-	list = &grp->bgi_normal.bzp_extents;
+	zp = &grp->bgi_normal;
 #endif
 
 	/**
@@ -2263,15 +2952,15 @@ static int balloc_wild_scan_group(struct balloc_allocation_context *bac,
 	 * not part of extent in free extent list because another requests
 	 * may have updated extents in free list.
 	 * Reset best extent by detecting this case so that it
-	 * will find correct best extent, also set end_of_group flag so
-	 * balloc_check_limits() could call balloc_use_best_found() to set
-	 * final extent from best extent.
+	 * will find correct best extent. The group is measured as a whole,
+	 * so balloc_check_limits() is called with end_of_group set and
+	 * could call balloc_use_best_found() to set final extent from best
+	 * extent.
 	 */
 	if (bac->bac_found != 0) {
 		m0_bindex_t group = balloc_bn2gn(bac->bac_best.e_start,
 						 bac->bac_ctxt);
 		if (group == grp->bgi_groupno) {
-			end_of_group = 1;
 			M0_SET0(&bac->bac_best);
 			m0_ext_init(&bac->bac_best);
 		}
@@ -2281,7 +2970,13 @@ static int balloc_wild_scan_group(struct balloc_allocation_context *bac,
 		(unsigned long long)grp->bgi_groupno,
 		(unsigned long long)free);
 
-	m0_list_for_each_entry(list, le, struct m0_lext, le_link) {
+	/*
+	 * The size index gives the best fitting extent of the group right
+	 * away, or the largest one if none fits.
+	 */
+	le = zone_ext_fit(zp, m0_ext_length(&bac->bac_goal)) ?:
+		zone_ext_largest(zp);
+	if (le != NULL) {
 		ex = &le->le_ext;
 		if (m0_ext_length(ex) > free) {
 			M0_LOG(M0_WARN, "corrupt group=%llu "
@@ -2291,10 +2986,8 @@ static int balloc_wild_scan_group(struct balloc_allocation_context *bac,
 				(unsigned long long)ex->e_end);
 			return M0_RC(-EINVAL);
 		}
-		balloc_measure_extent(bac, grp, alloc_flag, ex, end_of_group);
-
-		free -= m0_ext_length(ex);
-		if (free == 0 || bac->bac_status != M0_BALLOC_AC_CONTINUE)
+		balloc_measure_extent(bac, grp, alloc_flag, ex, 1);
+		if (bac->bac_status != M0_BALLOC_AC_CONTINUE)
 			return M0_RC(0);
 	}
 
@@ -2315,10 +3008,8 @@ static int balloc_try_best_found(struct balloc_allocation_context *bac,
 							  bac->bac_ctxt);
 	struct m0_balloc_group_info *grp = m0_balloc_gn2info(bac->bac_ctxt,
 							     group);
-	struct m0_ext		    *ex;
 	struct m0_ext		    *cur = NULL;
 	struct m0_lext		    *le;
-	struct m0_list              *list;
 	int			     rc = -ENOENT;
 
 	M0_ENTRY();
@@ -2337,23 +3028,15 @@ static int balloc_try_best_found(struct balloc_allocation_context *bac,
 		goto out;
 
 	rc = -ENOENT;
-	list = is_spare(alloc_flag) ? group_spare_ext(grp) :
-		 group_normal_ext(grp);
-	m0_list_for_each_entry(list, le, struct m0_lext, le_link) {
-		ex = &le->le_ext;
-		if (m0_ext_equal(ex, best)) {
-			rc = balloc_use_best_found(bac,
-						   zone_start_get(grp,
-								  alloc_flag));
-			break;
-		} else if (ex->e_start > best->e_start)
-			goto out;
-	}
+	le = zone_ext_floor(is_spare(alloc_flag) ? &grp->bgi_spare :
+			    &grp->bgi_normal, best->e_start);
+	if (le == NULL || !m0_ext_equal(&le->le_ext, best))
+		goto out;
+	rc = balloc_use_best_found(bac, zone_start_get(grp, alloc_flag));
 
 	/* update db according to the allocation result */
 	if (rc == 0 && bac->bac_status == M0_BALLOC_AC_FOUND) {
-		if (m0_ext_length(&bac->bac_goal) < m0_ext_length(best))
-			balloc_new_preallocation(bac);
+		balloc_new_preallocation(bac);
 
 		balloc_debug_dump_extent(__func__, &bac->bac_final);
 		M0_ASSERT(is_extent_free(grp, &bac->bac_final, alloc_flag,
@@ -2372,11 +3055,15 @@ balloc_alloc_credit(const struct m0_ad_balloc *balroom, int nr,
 			  struct m0_be_tx_credit *accum)
 {
 	const struct m0_balloc	*bal = b2m0(balroom);
+	struct m0_be_tx_credit   cred = {};
 
 	M0_ENTRY("cred=[%lu:%lu] nr=%d",
 		(unsigned long)accum->tc_reg_nr,
 		(unsigned long)accum->tc_reg_size, nr);
 	balloc_db_update_credit(bal, nr, accum);
+	/* preallocation window update, see balloc_prealloc_install() */
+	balloc_sb_sync_credit(bal, &cred);
+	m0_be_tx_credit_mac(accum, &cred, nr);
 	M0_LEAVE("cred=[%lu:%lu]",
 		(unsigned long)accum->tc_reg_nr,
 		(unsigned long)accum->tc_reg_size);
@@ -2555,8 +3242,7 @@ static int allocate_blocks(int cr, struct balloc_allocation_context *bac,
 
 	/* update db according to the allocation result */
 	if (rc == 0 && bac->bac_status == M0_BALLOC_AC_FOUND) {
-		if (len < m0_ext_length(&bac->bac_best))
-			balloc_new_preallocation(bac);
+		balloc_new_preallocation(bac);
 		M0_ASSERT(is_extent_free(grp, &bac->bac_final, alloc_type,
 					 &cur));
 		rc = balloc_alloc_db_update(bac->bac_ctxt, bac->bac_tx, grp,
@@ -2575,7 +3261,8 @@ static int allocate_blocks(int cr, struct balloc_allocation_context *bac,
    best suitable chunks, which are represented as buddy.
 
    Allocation will first try to use pre-allocation if it exists. Pre-allocation
-   can be per-object, or group based.
+   is per-object, see m0_balloc_prealloc. When free space is exhausted, the
+   windows of other objects are used.
 
    This routine will first check the group description to see if enough free
    space is available, and if largest contiguous chunk satisfy the request. This
@@ -2602,34 +3289,53 @@ int balloc_allocate_internal(struct m0_balloc *ctx,
 			     struct m0_balloc_allocate_req *req)
 {
 	struct balloc_allocation_context bac;
-	int                              rc;
+	m0_bcount_t                      len = req->bar_len;
+	int                              rc  = 0;
 
 	M0_ENTRY();
 
+	/* Step 1. query the pre-allocation */
+	balloc_init_ac(&bac, ctx, tx, req);
+	if (balloc_use_prealloc(&bac, false)) {
+		req->bar_result = bac.bac_final;
+		goto out;
+	}
+	/* we did not find suitable free space in prealloc. */
+
 	while (req->bar_len &&
 	       !balloc_got_freespace(ctx, req->bar_len, req->bar_flags)) {
 		req->bar_len >>= 1;
 	}
 	rc = req->bar_len == 0 ? -ENOSPC : 0;
-	if (rc != 0)
-		goto out;
-
-	balloc_init_ac(&bac, ctx, tx, req);
-
-	/* Step 1. query the pre-allocation */
-	if (!balloc_use_prealloc(&bac)) {
-		/* we did not find suitable free space in prealloc. */
-
+	if (rc == 0) {
+		balloc_init_ac(&bac, ctx, tx, req);
 		balloc_normalize_request(&bac);
 
 		/* Step 2. Iterate over groups */
 		rc = balloc_regular_allocator(&bac);
+		if (bac.bac_prealloc >= 0) {
+			if (rc == 0 && bac.bac_status == M0_BALLOC_AC_FOUND)
+				balloc_prealloc_install(&bac);
+			else
+				balloc_prealloc_unclaim(&bac);
+		}
 		if (rc == 0 && bac.bac_status == M0_BALLOC_AC_FOUND) {
 			/* store the result in req and they will be returned */
 			req->bar_result = bac.bac_final;
 		}
 	}
+	/* Step 3. free space is exhausted, take it from any window */
+	if (rc == -ENOSPC) {
+		req->bar_len = len;
+		balloc_init_ac(&bac, ctx, tx, req);
+		if (balloc_use_prealloc(&bac, true)) {
+			req->bar_result = bac.bac_final;
+			rc = 0;
+		}
+	}
 out:
+	if (rc == 0 && !m0_ext_is_empty(&req->bar_result))
+		balloc_prealloc_note(ctx, req->bar_owner, &req->bar_result);
 	return M0_RC(rc);
 }
 
@@ -2738,14 +3444,26 @@ static uint64_t ext_range_locate(struct m0_ext *ip_ext,
 /**
    Discard the pre-allocation for object.
 
+   The window loses its owner. Its space is returned to the group by the
+   balloc background thread in a transaction of its own, see
+   m0_balloc_prealloc_trim(), because no transaction is available here.
+
    @param ctx balloc operation context environment.
    @param req discard request which includes all parameters.
    @return 0 means success. Upon failure, non-zero error number is returned.
  */
-__attribute__((unused))
 static int balloc_discard_prealloc(struct m0_balloc *ctx,
 				   struct m0_balloc_discard_req *req)
 {
+	int i;
+
+	m0_mutex_lock(&ctx->cb_sb_mutex.bm_u.mutex);
+	i = balloc_prealloc_find(ctx, req->bdr_owner);
+	if (i >= 0)
+		ctx->cb_prealloc_owner[i].bpo_owned = false;
+	m0_mutex_unlock(&ctx->cb_sb_mutex.bm_u.mutex);
+	if (i >= 0 && ctx->cb_loader != NULL)
+		m0_semaphore_up(&ctx->cb_loader->bl_wakeup);
 	return 0;
 }
 
@@ -2865,7 +3583,7 @@ out:
  */
 static int balloc_alloc(struct m0_ad_balloc *ballroom, struct m0_dtx *tx,
 			m0_bcount_t count, struct m0_ext *out,
-			uint64_t alloc_zone)
+			uint64_t alloc_zone, const struct m0_fid *owner)
 {
 	struct m0_balloc              *motr = b2m0(ballroom);
 	struct m0_balloc_allocate_req  req;
@@ -2884,6 +3602,9 @@ static int balloc_alloc(struct m0_ad_balloc *ballroom, struct m0_dtx *tx,
 #else
 	req.bar_flags = M0_BALLOC_NORMAL_ZONE;
 #endif
+	req.bar_owner = owner;
+	if (owner != NULL && !is_spare(req.bar_flags))
+		req.bar_flags |= M0_BALLOC_HINT_DATA;
 
 	M0_SET0(out);
 
@@ -2953,6 +3674,11 @@ static int balloc_init(struct m0_ad_balloc *ballroom, struct m0_be_seg *db,
 	rc = balloc_init_internal(motr, db, grp, bshift, container_size,
 				  blocks_per_group, spare_blocks_per_group);
 	m0_sm_group_unlock(grp);
+	if (rc == 0) {
+		rc = balloc_loader_start(motr);
+		if (rc != 0)
+			balloc_fini_internal(motr);
+	}
 
 	return M0_RC(rc);
 }
@@ -2968,6 +3694,14 @@ static void balloc_fini(struct m0_ad_balloc *ballroom)
 	M0_LEAVE();
 }
 
+static void balloc_prealloc_release(struct m0_ad_balloc *ballroom,
+				    const struct m0_fid *owner)
+{
+	struct m0_balloc_discard_req req = { .bdr_owner = owner };
+
+	(void)balloc_discard_prealloc(b2m0(ballroom), &req);
+}
+
 static const struct m0_ad_balloc_ops balloc_ops = {
 	.bo_init	   = balloc_init,
 	.bo_fini	   = balloc_fini,
@@ -2976,6 +3710,7 @@ static const struct m0_ad_balloc_ops balloc_ops = {
 	.bo_alloc_credit   = balloc_alloc_credit,
 	.bo_free_credit    = balloc_free_credit,
 	.bo_reserve_extent = balloc_reserve_extent,
+	.bo_prealloc_release = balloc_prealloc_release,
 };
 
 static int balloc_trees_create(struct m0_balloc    *bal,
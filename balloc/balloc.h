@@ -29,6 +29,10 @@
 #include "lib/types.h"
 #include "lib/list.h"
 #include "lib/mutex.h"
+#include "lib/time.h"
+#include "lib/thread.h"
+#include "lib/semaphore.h"
+#include "fid/fid.h"
 #include "be/btree.h"
 #include "be/btree_xc.h"
 #include "format/format.h"
@@ -128,13 +132,30 @@ enum m0_balloc_allocation_flag {
 	M0_BALLOC_NORMAL_ZONE             = 1 << 13,
 };
 
+enum {
+	/**
+	 * Number of free extent size classes. Extent of length L belongs to
+	 * class min(log2(L), M0_BALLOC_SIZE_CLASS_NR - 1).
+	 */
+	M0_BALLOC_SIZE_CLASS_NR = 32,
+};
+
 struct m0_balloc_zone_param {
 	enum m0_balloc_allocation_flag  bzp_type;
 	struct m0_ext                   bzp_range;
 	m0_bcount_t                     bzp_freeblocks;
 	m0_bcount_t                     bzp_fragments;
 	m0_bcount_t                     bzp_maxchunk;
+	/** Free extents sorted by offset. */
 	struct m0_list                  bzp_extents;
+	/** Root of the offset index (treap keyed by extent start). */
+	struct m0_lext                 *bzp_root;
+	/** Seed for the treap priorities. */
+	uint64_t                        bzp_seed;
+	/** Bitmap of non-empty bzp_size[] lists. */
+	uint64_t                        bzp_size_map;
+	/** Free extents by size class. */
+	struct m0_list                  bzp_size[M0_BALLOC_SIZE_CLASS_NR];
 };
 
 /** Linked extents */
@@ -143,6 +164,13 @@ struct m0_lext {
 	bool                le_is_alloc;
 	struct m0_list_link le_link;
 	struct m0_ext       le_ext;
+	/** Linkage into m0_balloc_zone_param::bzp_size[]. */
+	struct m0_list_link le_size_link;
+	/** Children in m0_balloc_zone_param::bzp_root treap. */
+	struct m0_lext     *le_left;
+	struct m0_lext     *le_right;
+	/** Treap priority. */
+	uint64_t            le_prio;
 };
 
 /**
@@ -213,6 +241,69 @@ enum {
 	M0_BALLOC_BUDDY_LOOKUP_MAX = 10,
 };
 
+enum {
+	/** Number of preallocation windows, see m0_balloc::cb_prealloc. */
+	M0_BALLOC_PREALLOC_NR       = 32,
+	/**
+	 * Data request of a streaming owner (see balloc_owner_is_streaming())
+	 * is normalised to this many times its length, the excess becomes
+	 * preallocation window of the owner.
+	 */
+	M0_BALLOC_PREALLOC_FACTOR   = 8,
+	/**
+	 * Window not used for this many seconds loses its owner and its
+	 * blocks are returned to the group.
+	 */
+	M0_BALLOC_PREALLOC_IDLE_SEC = 5,
+	/** Maximal number of windows returned to groups in one transaction. */
+	M0_BALLOC_PREALLOC_TRIM_NR  = 4,
+};
+
+/**
+   Preallocation window.
+
+   Blocks of a window are allocated in the group extents tree, but are not
+   handed out yet. They are consumed by the following allocations of the
+   window owner without any group extents tree update, so that the owner gets
+   contiguous extents.
+
+   Owners are volatile (see m0_balloc_prealloc_owner). A window that has no
+   owner, e.g. after restart, after m0_ad_balloc_ops::bo_prealloc_release()
+   or after its owner has been idle for M0_BALLOC_PREALLOC_IDLE_SEC, is
+   returned to its group by the balloc background thread (see
+   m0_balloc_prealloc_trim()). Until then it may be consumed by the first
+   allocation that has no window of its own.
+ */
+struct m0_balloc_prealloc {
+	m0_bindex_t bp_start;
+	m0_bindex_t bp_end;
+} M0_XCA_RECORD M0_XCA_DOMAIN(be);
+
+/** Volatile owner of m0_balloc_prealloc. */
+struct m0_balloc_prealloc_owner {
+	/** Owner identifier, see m0_balloc_allocate_req::bar_owner. */
+	struct m0_fid bpo_fid;
+	/** Time of the last allocation from the window. */
+	m0_time_t     bpo_used;
+	/** End of the last extent allocated to the owner. */
+	m0_bindex_t   bpo_last;
+	bool          bpo_owned;
+	/** Window is being filled by an allocation in progress. */
+	bool          bpo_busy;
+};
+
+/** Background loader of group extents, see m0_balloc_load_extents(). */
+struct m0_balloc_loader {
+	struct m0_thread    bl_thread;
+	/** Set by balloc finalisation to stop the loader. */
+	bool                bl_stop;
+	/**
+	 * Wakes the loader up to return unused preallocation windows, see
+	 * m0_balloc_prealloc_trim().
+	 */
+	struct m0_semaphore bl_wakeup;
+};
+
 /**
    BE-backed in-memory data structure for the balloc environment.
 
@@ -229,6 +320,8 @@ struct m0_balloc {
 	m0_bindex_t                  cb_last;
 
 	struct m0_ad_balloc          cb_ballroom;
+	/** Preallocation windows, protected by cb_sb_mutex. */
+	struct m0_balloc_prealloc    cb_prealloc[M0_BALLOC_PREALLOC_NR];
 	struct m0_format_footer      cb_footer;
 
 	/*
@@ -249,17 +342,22 @@ struct m0_balloc {
 	/** super block lock */
 	struct m0_be_mutex           cb_sb_mutex;
 	struct m0_be_seg            *cb_be_seg;
+	/** Owners of cb_prealloc windows, protected by cb_sb_mutex. */
+	struct m0_balloc_prealloc_owner *cb_prealloc_owner;
+	/** Background extents loader, NULL if not running. */
+	struct m0_balloc_loader     *cb_loader;
 } M0_XCA_RECORD M0_XCA_DOMAIN(be);
 
 enum m0_balloc_format_version {
 	M0_BALLOC_FORMAT_VERSION_1 = 1,
+	/** Persistent preallocation windows (m0_balloc::cb_prealloc). */
+	M0_BALLOC_FORMAT_VERSION_2,
 
 	/* future versions, uncomment and update M0_BALLOC_FORMAT_VERSION */
-	/*M0_BALLOC_FORMAT_VERSION_2,*/
 	/*M0_BALLOC_FORMAT_VERSION_3,*/
 
 	/** Current version, should point to the latest version present */
-	M0_BALLOC_FORMAT_VERSION = M0_BALLOC_FORMAT_VERSION_1
+	M0_BALLOC_FORMAT_VERSION = M0_BALLOC_FORMAT_VERSION_2
 };
 
 static inline struct m0_balloc *b2m0(const struct m0_ad_balloc *ballroom)
@@ -303,7 +401,8 @@ struct m0_balloc_allocate_req {
 				      * m0_balloc_allocation_flag */
         struct m0_ext   bar_result;  /*< [out]physical offset, result */
 
-	void           *bar_prealloc;/*< [in][out]User opaque prealloc result */
+	/** [in] owner of the preallocation window to use, may be NULL */
+	const struct m0_fid *bar_owner;
 };
 
 /**
@@ -317,7 +416,7 @@ struct m0_balloc_free_req {
 };
 
 struct m0_balloc_discard_req {
-	void           *bdr_prealloc; /*< User opaque prealloc result */
+	const struct m0_fid *bdr_owner; /*< owner of the window to release */
 };
 
 /*
@@ -374,6 +473,17 @@ M0_INTERNAL struct m0_balloc_group_info *m0_balloc_gn2info(struct m0_balloc *cb,
 							   m0_bindex_t groupno);
 M0_INTERNAL void m0_balloc_debug_dump_group(const char *tag,
 					    struct m0_balloc_group_info *grp);
+/**
+   Returns to their groups the blocks of at most M0_BALLOC_PREALLOC_TRIM_NR
+   preallocation windows which have no active owner.
+
+   @return number of windows returned.
+ */
+M0_INTERNAL int m0_balloc_prealloc_trim(struct m0_balloc *bal,
+					struct m0_be_tx  *tx);
+M0_INTERNAL void m0_balloc_prealloc_trim_credit(const struct m0_balloc *bal,
+						struct m0_be_tx_credit *accum);
+
 M0_INTERNAL void m0_balloc_lock_group(struct m0_balloc_group_info *grp);
 M0_INTERNAL int m0_balloc_trylock_group(struct m0_balloc_group_info *grp);
 M0_INTERNAL void m0_balloc_unlock_group(struct m0_balloc_group_info *grp);
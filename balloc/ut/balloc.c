@@ -32,6 +32,7 @@
 #include "lib/assert.h"
 #include "lib/memory.h"
 #include "lib/thread.h"
+#include "lib/time.h"     /* m0_nanosleep */
 #include "lib/getopts.h"
 #include "dtm/dtm.h"      /* m0_dtx */
 #include "motr/magic.h"
@@ -152,7 +153,7 @@ int test_balloc_ut_ops(struct m0_be_ut_backend *ut_be, struct m0_be_seg *seg,
 		} else {
 			rc = motr_balloc->cb_ballroom.ab_ops->bo_alloc(
 					&motr_balloc->cb_ballroom, &dtx,
-				        count, &tmp, M0_BALLOC_NORMAL_ZONE);
+				        count, &tmp, M0_BALLOC_NORMAL_ZONE, NULL);
 		}
 
 		M0_UT_ASSERT(rc == 0);
@@ -299,6 +300,240 @@ void test_reserve_extent()
 	m0_be_ut_backend_fini(&ut_be);
 }
 
+static void balloc_ut_prealloc_alloc(struct m0_be_ut_backend *ut_be,
+				     struct m0_balloc *bal,
+				     const struct m0_fid *owner,
+				     m0_bcount_t count, struct m0_ext *ext)
+{
+	struct m0_ad_balloc    *ballroom = &bal->cb_ballroom;
+	struct m0_dtx           dtx = {};
+	struct m0_be_tx_credit  cred = {};
+	int                     rc;
+
+	ballroom->ab_ops->bo_alloc_credit(ballroom, 1, &cred);
+	m0_ut_be_tx_begin(&dtx.tx_betx, ut_be, &cred);
+	M0_SET0(ext);
+	rc = ballroom->ab_ops->bo_alloc(ballroom, &dtx, count, ext,
+					M0_BALLOC_NORMAL_ZONE, owner);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_ext_length(ext) == count);
+	m0_ut_be_tx_end(&dtx.tx_betx);
+}
+
+/*
+ * Interleaved allocations of two streaming objects get contiguous extents
+ * from their preallocation windows, and the tail of a released window is
+ * returned to its group.
+ */
+void test_prealloc()
+{
+	struct m0_be_ut_backend	 ut_be;
+	struct m0_be_ut_seg	 ut_seg;
+	struct m0_sm_group      *grp;
+	struct m0_balloc        *bal;
+	struct m0_fid            f1 = M0_FID_INIT(1, 1);
+	struct m0_fid            f2 = M0_FID_INIT(1, 2);
+	struct m0_ext            a[4];
+	struct m0_ext            b[4];
+	struct m0_ext            c;
+	m0_bcount_t              freeblocks;
+	m0_bcount_t              used;
+	int                      rc;
+	int                      i;
+
+	M0_SET0(&ut_be);
+	m0_be_ut_backend_init(&ut_be);
+	m0_be_ut_seg_init(&ut_seg, &ut_be, 1ULL << 24);
+	grp = m0_be_ut_backend_sm_group_lookup(&ut_be);
+	rc = m0_balloc_create(0, ut_seg.bus_seg, grp, &bal,
+			      &M0_FID_INIT(0, 2));
+	M0_UT_ASSERT(rc == 0);
+	rc = bal->cb_ballroom.ab_ops->bo_init
+		(&bal->cb_ballroom, ut_seg.bus_seg, BALLOC_DEF_BLOCK_SHIFT,
+		 BALLOC_DEF_CONTAINER_SIZE, BALLOC_DEF_BLOCKS_PER_GROUP,
+		 m0_stob_ad_spares_calc(BALLOC_DEF_BLOCKS_PER_GROUP));
+	M0_UT_ASSERT(rc == 0);
+
+	freeblocks = bal->cb_sb.bsb_freeblocks;
+	for (i = 0; i < ARRAY_SIZE(a); ++i) {
+		balloc_ut_prealloc_alloc(&ut_be, bal, &f1, 4, &a[i]);
+		balloc_ut_prealloc_alloc(&ut_be, bal, &f2, 4, &b[i]);
+		/* The first allocation does not stream yet. */
+		if (i > 1) {
+			M0_UT_ASSERT(a[i].e_start == a[i - 1].e_end);
+			M0_UT_ASSERT(b[i].e_start == b[i - 1].e_end);
+		}
+	}
+	/* Only the windows are taken from the groups. */
+	M0_UT_ASSERT(freeblocks - bal->cb_sb.bsb_freeblocks ==
+		     2 * 4 + 2 * 4 * M0_BALLOC_PREALLOC_FACTOR);
+
+	/* The rest of f1 window goes back, f2 window is kept. */
+	bal->cb_ballroom.ab_ops->bo_prealloc_release(&bal->cb_ballroom, &f1);
+	used = ARRAY_SIZE(a) * 4 + 4 + 4 * M0_BALLOC_PREALLOC_FACTOR;
+	for (i = 0; i < 500 && freeblocks - bal->cb_sb.bsb_freeblocks != used;
+	     ++i)
+		m0_nanosleep(m0_time(0, 10000000), NULL);
+	M0_UT_ASSERT(freeblocks - bal->cb_sb.bsb_freeblocks == used);
+
+	balloc_ut_prealloc_alloc(&ut_be, bal, &f2, 4, &c);
+	M0_UT_ASSERT(c.e_start == b[ARRAY_SIZE(b) - 1].e_end);
+
+	bal->cb_ballroom.ab_ops->bo_fini(&bal->cb_ballroom);
+	m0_be_ut_seg_fini(&ut_seg);
+	m0_be_ut_backend_fini(&ut_be);
+}
+
+static struct m0_lext *balloc_ut_tree_check(struct m0_lext *t,
+					    struct m0_lext *le,
+					    struct m0_balloc_zone_param *zp)
+{
+	struct m0_list_link *l;
+
+	if (t == NULL)
+		return le;
+	M0_UT_ASSERT(ergo(t->le_left != NULL,
+			  t->le_left->le_prio <= t->le_prio));
+	M0_UT_ASSERT(ergo(t->le_right != NULL,
+			  t->le_right->le_prio <= t->le_prio));
+	le = balloc_ut_tree_check(t->le_left, le, zp);
+	/* In-order walk of the treap follows the offset sorted list. */
+	l = le == NULL ? m0_list_first(&zp->bzp_extents) : le->le_link.ll_next;
+	M0_UT_ASSERT(l == &t->le_link);
+	return balloc_ut_tree_check(t->le_right, t, zp);
+}
+
+static void balloc_ut_zone_check(struct m0_balloc_zone_param *zp)
+{
+	struct m0_lext *le;
+	struct m0_lext *last;
+	m0_bcount_t     nr = 0;
+	m0_bcount_t     max = 0;
+	m0_bcount_t     len;
+	int             c;
+
+	last = balloc_ut_tree_check(zp->bzp_root, NULL, zp);
+	M0_UT_ASSERT(ergo(last != NULL, m0_list_link_is_last(&last->le_link,
+							     &zp->bzp_extents)));
+	for (c = 0; c < M0_BALLOC_SIZE_CLASS_NR; ++c) {
+		M0_UT_ASSERT(!!(zp->bzp_size_map & M0_BITS(c)) ==
+			     !m0_list_is_empty(&zp->bzp_size[c]));
+		m0_list_for_each_entry(&zp->bzp_size[c], le, struct m0_lext,
+				       le_size_link) {
+			len = m0_ext_length(&le->le_ext);
+			M0_UT_ASSERT(min_check(m0_log2(len),
+				     (unsigned)M0_BALLOC_SIZE_CLASS_NR - 1) == c);
+			max = max_check(max, len);
+			++nr;
+		}
+	}
+	M0_UT_ASSERT(nr == m0_list_length(&zp->bzp_extents));
+	M0_UT_ASSERT(nr == zp->bzp_fragments);
+	M0_UT_ASSERT(max == zp->bzp_maxchunk);
+}
+
+static m0_bcount_t balloc_ut_group_check(struct m0_balloc *bal)
+{
+	struct m0_balloc_group_info *grp = m0_balloc_gn2info(bal, 0);
+	m0_bcount_t                  frags;
+	int                          rc;
+
+	m0_balloc_lock_group(grp);
+	rc = m0_balloc_load_extents(bal, grp);
+	M0_UT_ASSERT(rc == 0);
+	balloc_ut_zone_check(&grp->bgi_normal);
+	balloc_ut_zone_check(&grp->bgi_spare);
+	frags = grp->bgi_normal.bzp_fragments;
+	m0_balloc_unlock_group(grp);
+	return frags;
+}
+
+static void balloc_ut_fragments_free(struct m0_be_ut_backend *ut_be,
+				     struct m0_ad_balloc *ballroom,
+				     struct m0_ext *ext)
+{
+	struct m0_dtx          dtx = {};
+	struct m0_be_tx_credit cred = {};
+	int                    rc;
+
+	ballroom->ab_ops->bo_free_credit(ballroom, 1, &cred);
+	m0_ut_be_tx_begin(&dtx.tx_betx, ut_be, &cred);
+	rc = ballroom->ab_ops->bo_free(ballroom, &dtx, ext);
+	M0_UT_ASSERT(rc == 0);
+	m0_ut_be_tx_end(&dtx.tx_betx);
+}
+
+/*
+ * Offset and size indices of the free extents stay consistent with the
+ * extents list as a group gets fragmented and defragmented.
+ */
+void test_fragments()
+{
+	struct m0_be_ut_backend	 ut_be;
+	struct m0_be_ut_seg	 ut_seg;
+	struct m0_sm_group      *grp;
+	struct m0_balloc        *bal;
+	struct m0_ad_balloc     *ballroom;
+	struct m0_dtx            dtx = {};
+	struct m0_be_tx_credit   cred;
+	struct m0_ext            ext[32];
+	struct m0_ext            tmp;
+	m0_bcount_t              frags;
+	int                      rc;
+	int                      i;
+
+	M0_SET0(&ut_be);
+	m0_be_ut_backend_init(&ut_be);
+	m0_be_ut_seg_init(&ut_seg, &ut_be, 1ULL << 24);
+	grp = m0_be_ut_backend_sm_group_lookup(&ut_be);
+	rc = m0_balloc_create(0, ut_seg.bus_seg, grp, &bal,
+			      &M0_FID_INIT(0, 3));
+	M0_UT_ASSERT(rc == 0);
+	ballroom = &bal->cb_ballroom;
+	rc = ballroom->ab_ops->bo_init
+		(ballroom, ut_seg.bus_seg, BALLOC_DEF_BLOCK_SHIFT,
+		 BALLOC_DEF_CONTAINER_SIZE, BALLOC_DEF_BLOCKS_PER_GROUP,
+		 m0_stob_ad_spares_calc(BALLOC_DEF_BLOCKS_PER_GROUP));
+	M0_UT_ASSERT(rc == 0);
+	balloc_ut_group_check(bal);
+
+	for (i = 0; i < ARRAY_SIZE(ext); ++i) {
+		cred = M0_BE_TX_CREDIT(0, 0);
+		ballroom->ab_ops->bo_alloc_credit(ballroom, 1, &cred);
+		m0_ut_be_tx_begin(&dtx.tx_betx, &ut_be, &cred);
+		M0_SET0(&ext[i]);
+		rc = ballroom->ab_ops->bo_alloc(ballroom, &dtx, 4, &ext[i],
+						M0_BALLOC_NORMAL_ZONE, NULL);
+		M0_UT_ASSERT(rc == 0);
+		m0_ut_be_tx_end(&dtx.tx_betx);
+	}
+	/* Punch holes. */
+	for (i = 0; i < ARRAY_SIZE(ext); i += 2)
+		balloc_ut_fragments_free(&ut_be, ballroom, &ext[i]);
+	frags = balloc_ut_group_check(bal);
+
+	/* Best fit does not split a larger extent for an exact one. */
+	cred = M0_BE_TX_CREDIT(0, 0);
+	ballroom->ab_ops->bo_alloc_credit(ballroom, 1, &cred);
+	m0_ut_be_tx_begin(&dtx.tx_betx, &ut_be, &cred);
+	M0_SET0(&tmp);
+	rc = ballroom->ab_ops->bo_alloc(ballroom, &dtx, 4, &tmp,
+					M0_BALLOC_NORMAL_ZONE, NULL);
+	M0_UT_ASSERT(rc == 0);
+	m0_ut_be_tx_end(&dtx.tx_betx);
+	M0_UT_ASSERT(balloc_ut_group_check(bal) <= frags);
+
+	/* Merge everything back. */
+	balloc_ut_fragments_free(&ut_be, ballroom, &tmp);
+	for (i = 1; i < ARRAY_SIZE(ext); i += 2)
+		balloc_ut_fragments_free(&ut_be, ballroom, &ext[i]);
+	balloc_ut_group_check(bal);
+
+	ballroom->ab_ops->bo_fini(ballroom);
+	m0_be_ut_seg_fini(&ut_seg);
+	m0_be_ut_backend_fini(&ut_be);
+}
+
 struct m0_ut_suite balloc_ut = {
         .ts_name  = "balloc-ut",
 	.ts_init = NULL,
@@ -306,6 +541,8 @@ struct m0_ut_suite balloc_ut = {
         .ts_tests = {
 		{ "balloc", test_balloc},
 		{ "reserve blocks for extmap", test_reserve_extent},
+		{ "prealloc", test_prealloc},
+		{ "fragments", test_fragments},
 		{ NULL, NULL }
         }
 };
@@ -31,6 +31,7 @@
 #include "lib/memory.h"         /* m0_addr_is_aligned */
 #include "lib/errno.h"          /* ENOSPC */
 #include "lib/misc.h"           /* memset, M0_BITS, m0_forall */
+#include "lib/processor.h"      /* m0_processor_id_get */
 #include "motr/magic.h"
 #include "be/domain.h"          /* m0_be_domain */
 
@@ -167,10 +168,47 @@
  * - allocator credit includes 2 * size requested for alignment shift greater
  *   than M0_BE_ALLOC_SHIFT_MIN;
  * - it is not truly O(1) allocator; see m0_be_fl documentation for explanation;
- * - there is one big allocator lock that protects all allocations/deallocation.
+ * - allocations which are not served by arenas (see below) are serialised
+ *   on one allocator lock.
  *
  * Locks
- * Allocator lock (m0_mutex) is used to protect all allocator data.
+ * Allocator lock (m0_be_allocator::ba_lock) is used to protect data of zones.
+ * Each arena has its own lock (m0_be_allocator::ba_arena_lock[]) which
+ * protects data of the arena. If both are needed, ba_lock is taken first.
+ * Allocated memory is zeroed and captured without any allocator lock held.
+ *
+ * Arenas
+ * ------
+ *
+ * Metadata-heavy workloads (cob, catalogues) make a lot of small allocations
+ * from many localities at once. To avoid contention on ba_lock, there are
+ * M0_BE_ALLOC_ARENA_NR arenas. Arena has the same structure as a zone:
+ * m0_be_allocator_header (m0_be_seg_hdr::bh_arena[]) and chunks. Chunks in
+ * arenas are ordinary chunks of M0_BAP_NORMAL zone, so chunk invariants are
+ * the same for zones and arenas.
+ *
+ * Arenas are empty (bah_size == 0) after m0_be_allocator_create(). Space is
+ * given to an arena on its first allocation: M0_BE_ALLOC_ARENA_PERCENT /
+ * M0_BE_ALLOC_ARENA_NR of the zone is cut from the free chunk at the end of
+ * M0_BAP_NORMAL zone (be_alloc_arena_carve()). It is not done if the chunk
+ * would be left smaller than the arena, so arenas never take the last free
+ * space of the zone. Arenas used on a node hold space, unused ones hold none.
+ *
+ * An allocation of at most M0_BE_ALLOC_ARENA_SIZE_MAX bytes from
+ * M0_BAP_NORMAL zone goes to the arena of the current CPU. If the arena has
+ * no space, the allocation is done from the zone itself. If the zone has no
+ * space either:
+ * - an arena which is adjacent to the end of the zone and has no allocated
+ *   chunks gives its space back to the zone (be_alloc_arena_reclaim()).
+ *   Arenas are carved from the end of the zone, so they are reclaimed in
+ *   reverse order of carving. At most one arena is reclaimed per allocation
+ *   to bound the allocation credit;
+ * - allocation of any size is tried in every arena.
+ * -ENOSPC is returned only if all of them fail. m0_be_free_aligned() finds
+ * zone or arena of the chunk by its address.
+ *
+ * Arenas are not given space in small segments, see
+ * M0_BE_ALLOC_ARENA_SIZE_MIN.
  *
  * Space reservation for DIX recovery
  * ----------------------------------
@@ -340,11 +378,9 @@ static void be_allocator_stats_update(struct m0_be_allocator_stats *stats,
 }
 
 static void be_allocator_stats_capture(struct m0_be_allocator *a,
-				       enum m0_be_alloc_zone_type ztype,
+				       struct m0_be_allocator_header *h,
 				       struct m0_be_tx *tx)
 {
-	struct m0_be_allocator_header *h = a->ba_h[ztype];
-
 	if (tx != NULL)
 		M0_BE_TX_CAPTURE_PTR(a->ba_seg, tx, &h->bah_stats);
 }
@@ -374,20 +410,78 @@ static void be_alloc_size_capture(const struct m0_be_allocator *a,
 }
 
 static bool be_alloc_mem_is_in(const struct m0_be_allocator *a,
-			       enum m0_be_alloc_zone_type ztype,
+			       const struct m0_be_allocator_header *h,
 			       const void *ptr, m0_bcount_t size)
 {
-	struct m0_be_allocator_header *h = a->ba_h[ztype];
-
 	return ptr >= h->bah_addr &&
 	       ptr + size <= h->bah_addr + h->bah_size;
 }
 
 static bool be_alloc_chunk_is_in(const struct m0_be_allocator *a,
-				 enum m0_be_alloc_zone_type ztype,
+				 const struct m0_be_allocator_header *h,
 				 const struct be_alloc_chunk *c)
 {
-	return be_alloc_mem_is_in(a, ztype, c, sizeof *c + c->bac_size);
+	return be_alloc_mem_is_in(a, h, c, sizeof *c + c->bac_size);
+}
+
+static struct m0_be_allocator_header *
+be_alloc_arena_header(const struct m0_be_allocator *a, int i)
+{
+	struct m0_be_seg_hdr *seg_hdr = a->ba_seg->bs_addr;
+
+	M0_PRE(i < M0_BE_ALLOC_ARENA_NR);
+	return &seg_hdr->bh_arena[i];
+}
+
+/** Finds allocator header of zone or arena where the memory is located. */
+static struct m0_be_allocator_header *
+be_alloc_header_find(const struct m0_be_allocator *a, const void *ptr)
+{
+	struct m0_be_allocator_header *h;
+	int                            i;
+
+	/*
+	 * Arena without space contains nothing. Arena bounds change only
+	 * over free space (see be_alloc_arena_carve() and
+	 * be_alloc_arena_reclaim()), so they may be read without locks here.
+	 */
+	for (i = 0; i < M0_BE_ALLOC_ARENA_NR; ++i) {
+		h = be_alloc_arena_header(a, i);
+		if (be_alloc_mem_is_in(a, h, ptr, 1))
+			return h;
+	}
+	for (i = 0; i < M0_BAP_NR; ++i) {
+		if (be_alloc_mem_is_in(a, a->ba_h[i], ptr, 1))
+			return a->ba_h[i];
+	}
+	return NULL;
+}
+
+static enum m0_be_alloc_zone_type
+be_alloc_header_zone(const struct m0_be_allocator        *a,
+		     const struct m0_be_allocator_header *h)
+{
+	int z;
+
+	for (z = 0; z < M0_BAP_NR; ++z) {
+		if (a->ba_h[z] == h)
+			return z;
+	}
+	/* arenas are parts of the normal zone */
+	return M0_BAP_NORMAL;
+}
+
+static struct m0_mutex *
+be_alloc_header_lock(struct m0_be_allocator              *a,
+		     const struct m0_be_allocator_header *h)
+{
+	int i;
+
+	for (i = 0; i < M0_BE_ALLOC_ARENA_NR; ++i) {
+		if (be_alloc_arena_header(a, i) == h)
+			return &a->ba_arena_lock[i];
+	}
+	return &a->ba_lock;
 }
 
 static bool be_alloc_chunk_is_not_overlapping(const struct be_alloc_chunk *a,
@@ -406,24 +500,23 @@ static bool be_alloc_chunk_is_not_overlapping(const struct be_alloc_chunk *a,
 static bool be_alloc_chunk_invariant(struct m0_be_allocator *a,
 				     const struct be_alloc_chunk *c)
 {
-	enum m0_be_alloc_zone_type     ztype = c->bac_zone;
-	struct m0_be_allocator_header *h;
+	struct m0_be_allocator_header *h = be_alloc_header_find(a, c);
 	struct be_alloc_chunk         *cprev;
 	struct be_alloc_chunk         *cnext;
 
-	M0_PRE(ztype < M0_BAP_NR);
+	M0_PRE(h != NULL);
 
-	h = a->ba_h[ztype];
 	cprev = chunks_all_be_list_prev(&h->bah_chunks, c);
 	cnext = chunks_all_be_list_next(&h->bah_chunks, c);
 
 	return _0C(c != NULL) &&
-	       _0C(be_alloc_chunk_is_in(a, ztype, c)) &&
+	       _0C(c->bac_zone == be_alloc_header_zone(a, h)) &&
+	       _0C(be_alloc_chunk_is_in(a, h, c)) &&
 	       _0C(m0_addr_is_aligned(&c->bac_mem, M0_BE_ALLOC_SHIFT_MIN)) &&
 	       _0C(ergo(cnext != NULL,
-			be_alloc_chunk_is_in(a, ztype, cnext))) &&
+			be_alloc_chunk_is_in(a, h, cnext))) &&
 	       _0C(ergo(cprev != NULL,
-			be_alloc_chunk_is_in(a, ztype, cprev))) &&
+			be_alloc_chunk_is_in(a, h, cprev))) &&
 	       _0C(c->bac_magic0 == M0_BE_ALLOC_MAGIC0) &&
 	       _0C(c->bac_magic1 == M0_BE_ALLOC_MAGIC1) &&
 	       _0C(be_alloc_chunk_is_not_overlapping(cprev, c)) &&
@@ -431,7 +524,7 @@ static bool be_alloc_chunk_invariant(struct m0_be_allocator *a,
 }
 
 static void be_alloc_chunk_init(struct m0_be_allocator *a,
-				enum m0_be_alloc_zone_type ztype,
+				struct m0_be_allocator_header *h,
 				struct m0_be_tx *tx,
 				struct be_alloc_chunk *c,
 				m0_bcount_t size, bool free)
@@ -440,7 +533,7 @@ static void be_alloc_chunk_init(struct m0_be_allocator *a,
 		.bac_magic0 = M0_BE_ALLOC_MAGIC0,
 		.bac_size   = size,
 		.bac_free   = free,
-		.bac_zone   = ztype,
+		.bac_zone   = be_alloc_header_zone(a, h),
 		.bac_magic1 = M0_BE_ALLOC_MAGIC1,
 	};
 	chunks_all_be_tlink_create(c, tx);
@@ -454,14 +547,12 @@ static void be_alloc_chunk_init(struct m0_be_allocator *a,
 }
 
 static void be_alloc_chunk_del_fini(struct m0_be_allocator *a,
-				    enum m0_be_alloc_zone_type ztype,
+				    struct m0_be_allocator_header *h,
 				    struct m0_be_tx *tx,
 				    struct be_alloc_chunk *c)
 {
-	struct m0_be_allocator_header *h = a->ba_h[ztype];
-
 	M0_PRE(be_alloc_chunk_invariant(a, c));
-	M0_PRE(c->bac_zone == ztype);
+	M0_PRE(be_alloc_chunk_is_in(a, h, c));
 
 	m0_be_fl_del(&h->bah_fl, tx, c);
 
@@ -476,13 +567,12 @@ static struct be_alloc_chunk *be_alloc_chunk_addr(void *ptr)
 
 static struct be_alloc_chunk *
 be_alloc_chunk_prev(struct m0_be_allocator *a,
-		    enum m0_be_alloc_zone_type ztype,
+		    struct m0_be_allocator_header *h,
 		    struct be_alloc_chunk *c)
 {
-	struct m0_be_allocator_header *h = a->ba_h[ztype];
 	struct be_alloc_chunk         *r;
 
-	M0_PRE(c->bac_zone == ztype);
+	M0_PRE(be_alloc_chunk_is_in(a, h, c));
 
 	r = chunks_all_be_list_prev(&h->bah_chunks, c);
 	M0_ASSERT(ergo(r != NULL, be_alloc_chunk_invariant(a, r)));
@@ -491,13 +581,12 @@ be_alloc_chunk_prev(struct m0_be_allocator *a,
 
 static struct be_alloc_chunk *
 be_alloc_chunk_next(struct m0_be_allocator *a,
-		    enum m0_be_alloc_zone_type ztype,
+		    struct m0_be_allocator_header *h,
 		    struct be_alloc_chunk *c)
 {
-	struct m0_be_allocator_header *h = a->ba_h[ztype];
 	struct be_alloc_chunk         *r;
 
-	M0_PRE(c->bac_zone == ztype);
+	M0_PRE(be_alloc_chunk_is_in(a, h, c));
 
 	r = chunks_all_be_list_next(&h->bah_chunks, c);
 	M0_ASSERT_EX(ergo(r != NULL, be_alloc_chunk_invariant(a, r)));
@@ -505,15 +594,13 @@ be_alloc_chunk_next(struct m0_be_allocator *a,
 }
 
 static void be_alloc_chunk_mark_free(struct m0_be_allocator *a,
-				     enum m0_be_alloc_zone_type ztype,
+				     struct m0_be_allocator_header *h,
 				     struct m0_be_tx *tx,
 				     struct be_alloc_chunk *c)
 {
-	struct m0_be_allocator_header *h = a->ba_h[ztype];
-
 	M0_PRE(be_alloc_chunk_invariant(a, c));
 	M0_PRE(!c->bac_free);
-	M0_PRE(c->bac_zone == ztype);
+	M0_PRE(be_alloc_chunk_is_in(a, h, c));
 
 	m0_be_fl_add(&h->bah_fl, tx, c);
 	c->bac_free = true;
@@ -524,12 +611,10 @@ static void be_alloc_chunk_mark_free(struct m0_be_allocator *a,
 }
 
 static uintptr_t be_alloc_chunk_after(struct m0_be_allocator *a,
-				      enum m0_be_alloc_zone_type ztype,
+				      struct m0_be_allocator_header *h,
 				      struct be_alloc_chunk *c)
 {
-	struct m0_be_allocator_header *h = a->ba_h[ztype];
-
-	M0_PRE(ergo(c != NULL, c->bac_zone == ztype));
+	M0_PRE(ergo(c != NULL, be_alloc_chunk_is_in(a, h, c)));
 
 	return c == NULL ? (uintptr_t) h->bah_addr :
 			   (uintptr_t) &c->bac_mem[c->bac_size];
@@ -538,25 +623,24 @@ static uintptr_t be_alloc_chunk_after(struct m0_be_allocator *a,
 /** try to add a chunk after the c */
 static struct be_alloc_chunk *
 be_alloc_chunk_add_after(struct m0_be_allocator *a,
-			 enum m0_be_alloc_zone_type ztype,
+			 struct m0_be_allocator_header *h,
 			 struct m0_be_tx *tx,
 			 struct be_alloc_chunk *c,
 			 uintptr_t offset,
 			 m0_bcount_t size_total,
 			 bool free)
 {
-	struct m0_be_allocator_header *h = a->ba_h[ztype];
 	struct be_alloc_chunk         *new;
 
 	M0_PRE(ergo(c != NULL, be_alloc_chunk_invariant(a, c)));
 	M0_PRE(size_total > sizeof *new);
-	M0_PRE(ergo(c != NULL, c->bac_zone == ztype));
+	M0_PRE(ergo(c != NULL, be_alloc_chunk_is_in(a, h, c)));
 
 	new = c == NULL ? (struct be_alloc_chunk *)
 			  ((uintptr_t) h->bah_addr + offset) :
 			  (struct be_alloc_chunk *)
-			  be_alloc_chunk_after(a, ztype, c);
-	be_alloc_chunk_init(a, ztype, tx, new, size_total - sizeof *new, free);
+			  be_alloc_chunk_after(a, h, c);
+	be_alloc_chunk_init(a, h, tx, new, size_total - sizeof *new, free);
 
 	if (c != NULL)
 		chunks_all_be_list_add_after(&h->bah_chunks, tx, c, new);
@@ -572,14 +656,12 @@ be_alloc_chunk_add_after(struct m0_be_allocator *a,
 }
 
 static void be_alloc_chunk_resize(struct m0_be_allocator *a,
-				  enum m0_be_alloc_zone_type ztype,
+				  struct m0_be_allocator_header *h,
 				  struct m0_be_tx *tx,
 				  struct be_alloc_chunk *c,
 				  m0_bcount_t new_size)
 {
-	struct m0_be_allocator_header *h = a->ba_h[ztype];
-
-	M0_PRE(c->bac_zone == ztype);
+	M0_PRE(be_alloc_chunk_is_in(a, h, c));
 
 	if (c->bac_free)
 		m0_be_fl_del(&h->bah_fl, tx, c);
@@ -591,7 +673,7 @@ static void be_alloc_chunk_resize(struct m0_be_allocator *a,
 
 static struct be_alloc_chunk *
 be_alloc_chunk_tryadd_free_after(struct m0_be_allocator *a,
-				 enum m0_be_alloc_zone_type ztype,
+				 struct m0_be_allocator_header *h,
 				 struct m0_be_tx *tx,
 				 struct be_alloc_chunk *c,
 				 uintptr_t offset,
@@ -599,12 +681,12 @@ be_alloc_chunk_tryadd_free_after(struct m0_be_allocator *a,
 {
 	if (size_total <= sizeof *c) {
 		if (c != NULL) {
-			be_alloc_chunk_resize(a, ztype, tx, c,
+			be_alloc_chunk_resize(a, h, tx, c,
 					      c->bac_size + size_total);
 		} else
 			; /* space before the first chunk is temporary lost */
 	} else {
-		c = be_alloc_chunk_add_after(a, ztype, tx, c,
+		c = be_alloc_chunk_add_after(a, h, tx, c,
 					     offset, size_total, true);
 	}
 	return c;
@@ -612,7 +694,7 @@ be_alloc_chunk_tryadd_free_after(struct m0_be_allocator *a,
 
 static struct be_alloc_chunk *
 be_alloc_chunk_split(struct m0_be_allocator *a,
-		     enum m0_be_alloc_zone_type ztype,
+		     struct m0_be_allocator_header *h,
 		     struct m0_be_tx *tx,
 		     struct be_alloc_chunk *c,
 		     uintptr_t start_new,
@@ -632,27 +714,27 @@ be_alloc_chunk_split(struct m0_be_allocator *a,
 
 	size_min_aligned = m0_align(size, 1UL << M0_BE_ALLOC_SHIFT_MIN);
 
-	prev	    = be_alloc_chunk_prev(a, ztype, c);
+	prev	    = be_alloc_chunk_prev(a, h, c);
 
-	start0	    = be_alloc_chunk_after(a, ztype, prev);
+	start0	    = be_alloc_chunk_after(a, h, prev);
 	start1	    = start_new + sizeof *new + size_min_aligned;
-	start_next  = be_alloc_chunk_after(a, ztype, c);
+	start_next  = be_alloc_chunk_after(a, h, c);
 	chunk0_size = start_new - start0;
 	chunk1_size = start_next - start1;
 	M0_ASSERT(start0    <= start_new);
 	M0_ASSERT(start_new <= start1);
 	M0_ASSERT(start1    <= start_next);
 
-	be_alloc_chunk_del_fini(a, ztype, tx, c);
+	be_alloc_chunk_del_fini(a, h, tx, c);
 	/* c is not a valid chunk now */
 
-	prev = be_alloc_chunk_tryadd_free_after(a, ztype, tx, prev, 0,
+	prev = be_alloc_chunk_tryadd_free_after(a, h, tx, prev, 0,
 						chunk0_size);
-	new = be_alloc_chunk_add_after(a, ztype, tx, prev,
+	new = be_alloc_chunk_add_after(a, h, tx, prev,
 				       prev == NULL ? chunk0_size : 0,
 				       sizeof *new + size_min_aligned, false);
 	M0_ASSERT(new != NULL);
-	be_alloc_chunk_tryadd_free_after(a, ztype, tx, new, 0, chunk1_size);
+	be_alloc_chunk_tryadd_free_after(a, h, tx, new, 0, chunk1_size);
 
 	M0_POST(!new->bac_free);
 	M0_POST(new->bac_size >= size);
@@ -662,7 +744,7 @@ be_alloc_chunk_split(struct m0_be_allocator *a,
 
 static struct be_alloc_chunk *
 be_alloc_chunk_trysplit(struct m0_be_allocator *a,
-			enum m0_be_alloc_zone_type ztype,
+			struct m0_be_allocator_header *h,
 			struct m0_be_tx *tx,
 			struct be_alloc_chunk *c,
 			m0_bcount_t size, unsigned shift)
@@ -683,7 +765,7 @@ be_alloc_chunk_trysplit(struct m0_be_allocator *a,
 		addr_mem  &= ~(alignment - 1);
 		/* if block fits inside free chunk */
 		result = addr_mem + size <= addr_end ?
-			 be_alloc_chunk_split(a, ztype, tx, c,
+			 be_alloc_chunk_split(a, h, tx, c,
 					     addr_mem - sizeof *c, size) : NULL;
 	}
 	M0_POST(ergo(result != NULL, be_alloc_chunk_invariant(a, result)));
@@ -691,7 +773,7 @@ be_alloc_chunk_trysplit(struct m0_be_allocator *a,
 }
 
 static bool be_alloc_chunk_trymerge(struct m0_be_allocator *a,
-				    enum m0_be_alloc_zone_type ztype,
+				    struct m0_be_allocator_header *h,
 				    struct m0_be_tx *tx,
 				    struct be_alloc_chunk *x,
 				    struct be_alloc_chunk *y)
@@ -705,8 +787,8 @@ static bool be_alloc_chunk_trymerge(struct m0_be_allocator *a,
 	M0_PRE(ergo(x != NULL, x->bac_free) || ergo(y != NULL, y->bac_free));
 	if (x != NULL && y != NULL && x->bac_free && y->bac_free) {
 		y_size_total = sizeof *y + y->bac_size;
-		be_alloc_chunk_del_fini(a, ztype, tx, y);
-		be_alloc_chunk_resize(a, ztype, tx, x,
+		be_alloc_chunk_del_fini(a, h, tx, y);
+		be_alloc_chunk_resize(a, h, tx, x,
 				      x->bac_size + y_size_total);
 		chunks_were_merged = true;
 	}
@@ -738,6 +820,12 @@ M0_INTERNAL int m0_be_allocator_init(struct m0_be_allocator *a,
 		M0_ASSERT(m0_addr_is_aligned(a->ba_h[i],
 					     BE_ALLOC_HEADER_SHIFT));
 	}
+	for (i = 0; i < M0_BE_ALLOC_ARENA_NR; ++i) {
+		M0_ASSERT(m0_addr_is_aligned(&seg_hdr->bh_arena[i],
+					     BE_ALLOC_HEADER_SHIFT));
+		M0_SET0(&a->ba_arena_lock[i]);
+		m0_mutex_init(&a->ba_arena_lock[i]);
+	}
 
 	return 0;
 }
@@ -750,6 +838,10 @@ M0_INTERNAL void m0_be_allocator_fini(struct m0_be_allocator *a)
 
 	for (i = 0; i < M0_BAP_NR; ++i)
 		be_allocator_stats_print(&a->ba_h[i]->bah_stats);
+	for (i = 0; i < M0_BE_ALLOC_ARENA_NR; ++i) {
+		be_allocator_stats_print(&be_alloc_arena_header(a, i)->bah_stats);
+		m0_mutex_fini(&a->ba_arena_lock[i]);
+	}
 	m0_mutex_fini(&a->ba_lock);
 
 	M0_LEAVE();
@@ -765,16 +857,13 @@ M0_INTERNAL bool m0_be_allocator__invariant(struct m0_be_allocator *a)
 					   be_alloc_chunk_invariant(a, iter))));
 }
 
-static int be_allocator_header_create(struct m0_be_allocator     *a,
-				      enum m0_be_alloc_zone_type  ztype,
-				      struct m0_be_tx            *tx,
-				      uintptr_t                   offset,
-				      m0_bcount_t                 size)
+static int be_allocator_header_create(struct m0_be_allocator        *a,
+				      struct m0_be_allocator_header *h,
+				      struct m0_be_tx               *tx,
+				      uintptr_t                      offset,
+				      m0_bcount_t                    size)
 {
-	struct m0_be_allocator_header *h = a->ba_h[ztype];
-	struct be_alloc_chunk         *c;
-
-	M0_PRE(ztype < M0_BAP_NR);
+	struct be_alloc_chunk *c;
 
 	if (size != 0 && size < sizeof *c + 1)
 		return M0_ERR(-ENOSPC);
@@ -787,22 +876,21 @@ static int be_allocator_header_create(struct m0_be_allocator     *a,
 	chunks_all_be_list_create(&h->bah_chunks, tx);
 	m0_be_fl_create(&h->bah_fl, tx, a->ba_seg);
 	be_allocator_stats_init(&h->bah_stats, h);
-	be_allocator_stats_capture(a, ztype, tx);
+	be_allocator_stats_capture(a, h, tx);
 
 	/* init main chunk */
 	if (size != 0) {
-		c = be_alloc_chunk_add_after(a, ztype, tx, NULL, 0, size, true);
+		c = be_alloc_chunk_add_after(a, h, tx, NULL, 0, size, true);
 		M0_ASSERT(c != NULL);
 	}
 	return 0;
 }
 
-static void be_allocator_header_destroy(struct m0_be_allocator     *a,
-					enum m0_be_alloc_zone_type  ztype,
-					struct m0_be_tx            *tx)
+static void be_allocator_header_destroy(struct m0_be_allocator        *a,
+					struct m0_be_allocator_header *h,
+					struct m0_be_tx               *tx)
 {
-	struct m0_be_allocator_header *h = a->ba_h[ztype];
-	struct be_alloc_chunk         *c;
+	struct be_alloc_chunk *c;
 
 	/*
 	 * We destroy allocator when all objects are de-allocated. Therefore,
@@ -812,25 +900,181 @@ static void be_allocator_header_destroy(struct m0_be_allocator     *a,
 	c = chunks_all_be_list_head(&h->bah_chunks);
 	M0_ASSERT(equi(c == NULL, h->bah_size == 0));
 	if (c != NULL)
-		be_alloc_chunk_del_fini(a, ztype, tx, c);
+		be_alloc_chunk_del_fini(a, h, tx, c);
 
 	m0_be_fl_destroy(&h->bah_fl, tx);
 	chunks_all_be_list_destroy(&h->bah_chunks, tx);
 }
 
+/**
+ * Returns size of an arena carved out of the normal zone of the given size,
+ * or 0 if the zone is too small for arenas.
+ */
+static m0_bcount_t be_allocator_arena_size(m0_bcount_t zone_size)
+{
+	m0_bcount_t size;
+
+	size = zone_size * M0_BE_ALLOC_ARENA_PERCENT / 100 /
+	       M0_BE_ALLOC_ARENA_NR;
+	size &= ~((1UL << BE_ALLOC_ZONE_SIZE_SHIFT) - 1);
+	return size >= M0_BE_ALLOC_ARENA_SIZE_MIN ? size : 0;
+}
+
+static void be_allocator_arenas_destroy(struct m0_be_allocator *a,
+					struct m0_be_tx        *tx)
+{
+	int i;
+
+	for (i = 0; i < M0_BE_ALLOC_ARENA_NR; ++i)
+		be_allocator_header_destroy(a, be_alloc_arena_header(a, i), tx);
+}
+
+/** Moves "size" bytes of space from one header to the other in statistics. */
+static void be_allocator_stats_move(struct m0_be_allocator        *a,
+				    struct m0_be_tx               *tx,
+				    struct m0_be_allocator_header *from,
+				    struct m0_be_allocator_header *to,
+				    m0_bcount_t                    size)
+{
+	from->bah_stats.bas_space_total -= size;
+	from->bah_stats.bas_space_free  -= size;
+	to->bah_stats.bas_space_total   += size;
+	to->bah_stats.bas_space_free    += size;
+	be_allocator_stats_capture(a, from, tx);
+	be_allocator_stats_capture(a, to, tx);
+}
+
+static void be_allocator_header_resize(struct m0_be_allocator        *a,
+				       struct m0_be_allocator_header *h,
+				       struct m0_be_tx               *tx,
+				       void                          *addr,
+				       m0_bcount_t                    size)
+{
+	h->bah_addr = addr;
+	h->bah_size = size;
+	if (tx != NULL) {
+		M0_BE_TX_CAPTURE_PTR(a->ba_seg, tx, &h->bah_addr);
+		M0_BE_TX_CAPTURE_PTR(a->ba_seg, tx, &h->bah_size);
+	}
+}
+
+/**
+ * Gives space to the empty arena h. The space is cut from the free chunk at
+ * the end of M0_BAP_NORMAL zone.
+ *
+ * Returns false if the chunk is too small.
+ */
+static bool be_alloc_arena_carve(struct m0_be_allocator        *a,
+				 struct m0_be_allocator_header *h,
+				 struct m0_be_tx               *tx)
+{
+	struct m0_be_allocator_header *zh = a->ba_h[M0_BAP_NORMAL];
+	struct be_alloc_chunk         *tail;
+	struct be_alloc_chunk         *c;
+	uintptr_t                      end;
+	uintptr_t                      start;
+	m0_bcount_t                    size;
+	int                            i;
+
+	M0_PRE(m0_mutex_is_locked(&a->ba_lock));
+	M0_PRE(m0_mutex_is_locked(be_alloc_header_lock(a, h)));
+	M0_PRE(h->bah_size == 0);
+
+	/* Arena size depends on the zone size before any arena was carved. */
+	size = zh->bah_size;
+	for (i = 0; i < M0_BE_ALLOC_ARENA_NR; ++i)
+		size += be_alloc_arena_header(a, i)->bah_size;
+	size = be_allocator_arena_size(size);
+	tail = chunks_all_be_list_tail(&zh->bah_chunks);
+	end  = (uintptr_t)zh->bah_addr + zh->bah_size;
+	if (size == 0 || tail == NULL || !tail->bac_free ||
+	    be_alloc_chunk_after(a, zh, tail) != end ||
+	    tail->bac_size < 2 * size)
+		return false;
+	start = m0_align(end - size, 1UL << M0_BE_ALLOC_SHIFT_MIN);
+	size  = end - start;
+
+	be_alloc_chunk_resize(a, zh, tx, tail, tail->bac_size - size);
+	be_allocator_header_resize(a, zh, tx, zh->bah_addr,
+				   zh->bah_size - size);
+	be_allocator_header_resize(a, h, tx, (void *)start, size);
+	c = be_alloc_chunk_add_after(a, h, tx, NULL, 0, size, true);
+	M0_ASSERT(c != NULL);
+	be_allocator_stats_move(a, tx, zh, h, size);
+	M0_LOG(M0_DEBUG, "arena=%p addr=%p size=%"PRIu64,
+	       h, h->bah_addr, h->bah_size);
+	return true;
+}
+
+/**
+ * Gives space of an arena back to M0_BAP_NORMAL zone.
+ *
+ * Only an arena which has no allocated chunks and is adjacent to the end of
+ * the zone can be reclaimed. Returns false if there is no such arena.
+ */
+static bool be_alloc_arena_reclaim(struct m0_be_allocator *a,
+				   struct m0_be_tx        *tx)
+{
+	struct m0_be_allocator_header *zh = a->ba_h[M0_BAP_NORMAL];
+	struct m0_be_allocator_header *h = NULL;
+	struct be_alloc_chunk         *tail;
+	struct be_alloc_chunk         *c;
+	struct m0_mutex               *lock;
+	void                          *end;
+	m0_bcount_t                    size;
+	int                            i;
+
+	M0_PRE(m0_mutex_is_locked(&a->ba_lock));
+
+	end = zh->bah_addr + zh->bah_size;
+	for (i = 0; i < M0_BE_ALLOC_ARENA_NR; ++i) {
+		h = be_alloc_arena_header(a, i);
+		if (h->bah_size != 0 && h->bah_addr == end)
+			break;
+	}
+	if (i == M0_BE_ALLOC_ARENA_NR)
+		return false;
+
+	lock = &a->ba_arena_lock[i];
+	m0_mutex_lock(lock);
+	c = chunks_all_be_list_head(&h->bah_chunks);
+	if (c == NULL || !c->bac_free ||
+	    c != chunks_all_be_list_tail(&h->bah_chunks)) {
+		m0_mutex_unlock(lock);
+		return false;
+	}
+	size = h->bah_size;
+	be_alloc_chunk_del_fini(a, h, tx, c);
+	be_allocator_header_resize(a, h, tx, NULL, 0);
+	be_allocator_stats_move(a, tx, h, zh, size);
+	m0_mutex_unlock(lock);
+
+	tail = chunks_all_be_list_tail(&zh->bah_chunks);
+	be_allocator_header_resize(a, zh, tx, zh->bah_addr,
+				   zh->bah_size + size);
+	c = be_alloc_chunk_add_after(a, zh, tx, tail,
+				     tail == NULL ? end - zh->bah_addr : 0,
+				     size, true);
+	if (tail != NULL && tail->bac_free)
+		be_alloc_chunk_trymerge(a, zh, tx, tail, c);
+	M0_LOG(M0_DEBUG, "arena=%p reclaimed size=%"PRIu64, h, size);
+	return true;
+}
+
 M0_INTERNAL int m0_be_allocator_create(struct m0_be_allocator *a,
 				       struct m0_be_tx        *tx,
 				       uint32_t               *zone_percent,
 				       uint32_t                zones_nr)
 {
-	m0_bcount_t reserved;
-	m0_bcount_t free_space;
-	m0_bcount_t remain;
-	m0_bcount_t size;
-	uintptr_t   offset;
-	int         i;
-	int         z;
-	int         rc;
+	struct m0_be_seg_hdr *seg_hdr = a->ba_seg->bs_addr;
+	m0_bcount_t           reserved;
+	m0_bcount_t           free_space;
+	m0_bcount_t           remain;
+	m0_bcount_t           size;
+	uintptr_t             offset;
+	int                   i;
+	int                   z;
+	int                   rc;
 
 	M0_ENTRY("a=%p tx=%p", a, tx);
 	M0_PRE(zones_nr <= M0_BAP_NR);
@@ -842,6 +1086,12 @@ M0_INTERNAL int m0_be_allocator_create(struct m0_be_allocator *a,
 
 	m0_mutex_lock(&a->ba_lock);
 
+	/* Arenas get space on demand, see be_alloc_arena_carve(). */
+	for (i = 0; i < M0_BE_ALLOC_ARENA_NR; ++i) {
+		rc = be_allocator_header_create(a, &seg_hdr->bh_arena[i],
+						tx, 0, 0);
+		M0_ASSERT(rc == 0);
+	}
 	remain = free_space;
 	for (i = 0; i < zones_nr; ++i) {
 		if (i < zones_nr - 1) {
@@ -850,10 +1100,12 @@ M0_INTERNAL int m0_be_allocator_create(struct m0_be_allocator *a,
 		} else
 			size = remain;
 		M0_ASSERT(size <= remain);
-		rc = be_allocator_header_create(a, i, tx, offset, size);
+		rc = be_allocator_header_create(a, a->ba_h[i], tx, offset,
+						size);
 		if (rc != 0) {
 			for (z = 0; z < i; ++z)
-				be_allocator_header_destroy(a, z, tx);
+				be_allocator_header_destroy(a, a->ba_h[z], tx);
+			be_allocator_arenas_destroy(a, tx);
 			m0_mutex_unlock(&a->ba_lock);
 			return M0_RC(rc);
 		}
@@ -864,7 +1116,7 @@ M0_INTERNAL int m0_be_allocator_create(struct m0_be_allocator *a,
 
 	/* Create the rest of zones as empty/unused. */
 	for (i = zones_nr; i < M0_BAP_NR; ++i) {
-		rc = be_allocator_header_create(a, i, tx, 0, 0);
+		rc = be_allocator_header_create(a, a->ba_h[i], tx, 0, 0);
 		M0_ASSERT(rc == 0);
 	}
 
@@ -872,6 +1124,8 @@ M0_INTERNAL int m0_be_allocator_create(struct m0_be_allocator *a,
 	for (i = 0; i < zones_nr; ++i)
 		M0_LOG(M0_DEBUG, "%s zone size=%"PRIu64,
 		       be_alloc_zone_name(i), a->ba_h[i]->bah_size);
+	M0_LOG(M0_DEBUG, "arenas nr=%d size=%"PRIu64, M0_BE_ALLOC_ARENA_NR,
+	       be_allocator_arena_size(a->ba_h[M0_BAP_NORMAL]->bah_size));
 
 	M0_POST(m0_be_allocator__invariant(a));
 	m0_mutex_unlock(&a->ba_lock);
@@ -890,8 +1144,9 @@ M0_INTERNAL void m0_be_allocator_destroy(struct m0_be_allocator *a,
 	m0_mutex_lock(&a->ba_lock);
 	M0_PRE_EX(m0_be_allocator__invariant(a));
 
+	be_allocator_arenas_destroy(a, tx);
 	for (z = 0; z < M0_BAP_NR; ++z)
-		be_allocator_header_destroy(a, z, tx);
+		be_allocator_header_destroy(a, a->ba_h[z], tx);
 
 	m0_mutex_unlock(&a->ba_lock);
 	M0_LEAVE();
@@ -924,6 +1179,8 @@ M0_INTERNAL void m0_be_allocator_credit(struct m0_be_allocator *a,
 	struct m0_be_tx_credit         cred_free_flag;
 	struct m0_be_tx_credit         cred_chunk_size;
 	struct m0_be_tx_credit         stats_credit;
+	struct m0_be_tx_credit         cred_arena_carve = {};
+	struct m0_be_tx_credit         cred_arena_reclaim = {};
 	struct m0_be_tx_credit         tmp;
 	struct be_alloc_chunk          chunk;
 
@@ -974,6 +1231,18 @@ M0_INTERNAL void m0_be_allocator_credit(struct m0_be_allocator *a,
 	m0_be_tx_credit_add(&cred_mark_free, &cred_free_flag);
 	m0_be_fl_credit(&h->bah_fl, M0_BFL_ADD, &cred_mark_free);
 
+	/* be_alloc_arena_carve() */
+	m0_be_tx_credit_add(&cred_arena_carve, &chunk_resize_credit);
+	m0_be_tx_credit_mac(&cred_arena_carve, &cred_allocator, 2);
+	m0_be_tx_credit_add(&cred_arena_carve, &chunk_add_after_credit);
+	m0_be_tx_credit_mac(&cred_arena_carve, &stats_credit, 2);
+	/* be_alloc_arena_reclaim() */
+	m0_be_tx_credit_add(&cred_arena_reclaim, &chunk_del_fini_credit);
+	m0_be_tx_credit_mac(&cred_arena_reclaim, &cred_allocator, 2);
+	m0_be_tx_credit_mac(&cred_arena_reclaim, &stats_credit, 2);
+	m0_be_tx_credit_add(&cred_arena_reclaim, &chunk_add_after_credit);
+	m0_be_tx_credit_add(&cred_arena_reclaim, &chunk_trymerge_credit);
+
 	switch (optype) {
 		case M0_BAO_CREATE:
 			tmp = M0_BE_TX_CREDIT(0, 0);
@@ -982,19 +1251,24 @@ M0_INTERNAL void m0_be_allocator_credit(struct m0_be_allocator *a,
 			m0_be_tx_credit_add(&tmp, &chunk_add_after_credit);
 			m0_be_tx_credit_add(&tmp, &cred_allocator);
 			m0_be_tx_credit_add(&tmp, &stats_credit);
-			m0_be_tx_credit_mac(accum, &tmp, M0_BAP_NR);
+			m0_be_tx_credit_mac(accum, &tmp,
+					    M0_BAP_NR + M0_BE_ALLOC_ARENA_NR);
 			break;
 		case M0_BAO_DESTROY:
 			tmp = M0_BE_TX_CREDIT(0, 0);
 			m0_be_fl_credit(&h->bah_fl, M0_BFL_DESTROY, &tmp);
 			m0_be_tx_credit_add(&tmp, &chunk_del_fini_credit);
 			m0_be_tx_credit_mac(&tmp, &cred_list_destroy, 2);
-			m0_be_tx_credit_mac(accum, &tmp, M0_BAP_NR);
+			m0_be_tx_credit_mac(accum, &tmp,
+					    M0_BAP_NR + M0_BE_ALLOC_ARENA_NR);
 			break;
 		case M0_BAO_ALLOC_ALIGNED:
 			m0_be_tx_credit_add(accum, &cred_split);
 			m0_be_tx_credit_add(accum, &mem_zero_credit);
 			m0_be_tx_credit_add(accum, &stats_credit);
+			/* first use of an arena, then full normal zone */
+			m0_be_tx_credit_add(accum, &cred_arena_carve);
+			m0_be_tx_credit_add(accum, &cred_arena_reclaim);
 			break;
 		case M0_BAO_ALLOC:
 			m0_be_allocator_credit(a, M0_BAO_ALLOC_ALIGNED, size,
@@ -1017,6 +1291,97 @@ M0_INTERNAL void m0_be_allocator_credit(struct m0_be_allocator *a,
 	m0_be_tx_credit_add(accum, &M0_BE_TX_CREDIT(40, 640));
 }
 
+/**
+ * Picks a free chunk in the zone or arena and splits it to get allocated chunk.
+ */
+static struct be_alloc_chunk *
+be_alloc_chunk_get(struct m0_be_allocator        *a,
+		   struct m0_be_allocator_header *h,
+		   struct m0_be_tx               *tx,
+		   m0_bcount_t                    size,
+		   unsigned                       shift)
+{
+	struct be_alloc_chunk *c;
+	m0_bcount_t            size_to_pick;
+
+	M0_PRE(m0_mutex_is_locked(be_alloc_header_lock(a, h)));
+
+	size_to_pick = (1UL << shift) - (1UL << M0_BE_ALLOC_SHIFT_MIN) +
+		       m0_align(size, 1UL << M0_BE_ALLOC_SHIFT_MIN);
+	c = m0_be_fl_pick(&h->bah_fl, size_to_pick);
+	if (c != NULL) {
+		c = be_alloc_chunk_trysplit(a, h, tx, c, size, shift);
+		M0_ASSERT(c != NULL);
+		M0_ASSERT(be_alloc_chunk_is_in(a, h, c));
+		M0_POST(!c->bac_free);
+		M0_POST(c->bac_size >= size);
+		M0_POST(m0_addr_is_aligned(&c->bac_mem, shift));
+	}
+	return c;
+}
+
+/** Allocates memory from the arena i. Returns NULL if it has no space. */
+static struct be_alloc_chunk *be_alloc_arena_get(struct m0_be_allocator *a,
+						 struct m0_be_tx        *tx,
+						 int                     i,
+						 m0_bcount_t             size,
+						 unsigned                shift)
+{
+	struct m0_be_allocator_header *h = be_alloc_arena_header(a, i);
+	struct be_alloc_chunk         *c;
+
+	m0_mutex_lock(&a->ba_arena_lock[i]);
+	c = be_alloc_chunk_get(a, h, tx, size, shift);
+	if (c != NULL) {
+		be_allocator_stats_update(&h->bah_stats, c->bac_size,
+					  true, false);
+		be_allocator_stats_capture(a, h, tx);
+	}
+	m0_mutex_unlock(&a->ba_arena_lock[i]);
+	return c;
+}
+
+/**
+ * Tries to allocate memory from the arena of the current CPU.
+ *
+ * Only small allocations from the normal zone are served by arenas. Arena is
+ * given space on its first use. If the arena has no space, NULL is returned
+ * and the memory is allocated from the zone itself.
+ */
+static struct be_alloc_chunk *be_alloc_arena(struct m0_be_allocator *a,
+					     struct m0_be_tx        *tx,
+					     m0_bcount_t             size,
+					     unsigned                shift,
+					     uint64_t                zonemask)
+{
+	struct m0_be_allocator_header *h;
+	struct m0_mutex               *lock;
+	int                            i;
+
+	if (zonemask != M0_BITS(M0_BAP_NORMAL) ||
+	    size > M0_BE_ALLOC_ARENA_SIZE_MAX)
+		return NULL;
+	i    = m0_processor_id_get() % M0_BE_ALLOC_ARENA_NR;
+	h    = be_alloc_arena_header(a, i);
+	lock = &a->ba_arena_lock[i];
+
+	m0_mutex_lock(lock);
+	if (h->bah_size == 0) {
+		/* ba_lock is taken before arena lock. */
+		m0_mutex_unlock(lock);
+		m0_mutex_lock(&a->ba_lock);
+		m0_mutex_lock(lock);
+		if (h->bah_size == 0 && !be_alloc_arena_carve(a, h, tx)) {
+			m0_mutex_unlock(lock);
+			m0_mutex_unlock(&a->ba_lock);
+			return NULL;
+		}
+		m0_mutex_unlock(&a->ba_lock);
+	}
+	m0_mutex_unlock(lock);
+	return be_alloc_arena_get(a, tx, i, size, shift);
+}
+
 M0_INTERNAL void m0_be_alloc_aligned(struct m0_be_allocator *a,
 				     struct m0_be_tx *tx,
 				     struct m0_be_op *op,
@@ -1025,10 +1390,11 @@ M0_INTERNAL void m0_be_alloc_aligned(struct m0_be_allocator *a,
 				     unsigned shift,
 				     uint64_t zonemask)
 {
-	enum  m0_be_alloc_zone_type  ztype;
-	struct be_alloc_chunk       *c = NULL;
-	m0_bcount_t                  size_to_pick;
-	int                          z;
+	struct m0_be_allocator_header *h;
+	struct be_alloc_chunk         *c = NULL;
+	bool                           in_arena = false;
+	int                            z;
+	int                            i;
 
 	shift = max_check(shift, (unsigned) M0_BE_ALLOC_SHIFT_MIN);
 	M0_ASSERT_INFO(size <= (M0_BCOUNT_MAX - (1UL << shift)) / 2,
@@ -1036,53 +1402,73 @@ M0_INTERNAL void m0_be_alloc_aligned(struct m0_be_allocator *a,
 
 	m0_be_op_active(op);
 
-	m0_mutex_lock(&a->ba_lock);
-	M0_PRE_EX(m0_be_allocator__invariant(a));
+	c = be_alloc_arena(a, tx, size, shift, zonemask);
+	if (c == NULL) {
+		m0_mutex_lock(&a->ba_lock);
+		M0_PRE_EX(m0_be_allocator__invariant(a));
+
+		/* algorithm starts here */
+		for (z = 0; z < M0_BAP_NR; ++z) {
+			if ((zonemask & M0_BITS(z)) != 0)
+				c = be_alloc_chunk_get(a, a->ba_h[z], tx,
+						       size, shift);
+			if (c != NULL)
+				break;
+		}
+		/*
+		 * Normal zone is full: get the space back from an unused arena
+		 * or use any arena which has it.
+		 */
+		if (c == NULL && (zonemask & M0_BITS(M0_BAP_NORMAL)) != 0) {
+			z = M0_BAP_NORMAL;
+			if (be_alloc_arena_reclaim(a, tx))
+				c = be_alloc_chunk_get(a, a->ba_h[z], tx,
+						       size, shift);
+			if (c == NULL) {
+				for (i = 0; i < M0_BE_ALLOC_ARENA_NR &&
+					    c == NULL; ++i)
+					c = be_alloc_arena_get(a, tx, i,
+							       size, shift);
+				in_arena = c != NULL;
+			}
+		}
+		/*
+		 * XXX If allocation fails then stats are updated for normal
+		 * zone.
+		 */
+		h = a->ba_h[c != NULL ? z : M0_BAP_NORMAL];
+		if (!in_arena) {
+			be_allocator_stats_update(&h->bah_stats,
+						  c == NULL ? size :
+							      c->bac_size,
+						  true, c == NULL);
+			be_allocator_stats_capture(a, h, tx);
+		}
+		/* and ends here */
 
-	/* algorithm starts here */
-	size_to_pick = (1UL << shift) - (1UL << M0_BE_ALLOC_SHIFT_MIN) +
-		       m0_align(size, 1UL << M0_BE_ALLOC_SHIFT_MIN);
-	for (z = 0; z < M0_BAP_NR; ++z) {
-		if ((zonemask & M0_BITS(z)) != 0)
-			c = m0_be_fl_pick(&a->ba_h[z]->bah_fl, size_to_pick);
-		if (c != NULL)
-			break;
+		if (c == NULL) {
+			be_allocator_stats_print(&h->bah_stats);
+			M0_ASSERT(m0_be_allocator__invariant(a));
+		}
+		/*
+		 * unlock mutex after post-conditions which are using
+		 * allocator internals
+		 */
+		M0_POST_EX(m0_be_allocator__invariant(a));
+		m0_mutex_unlock(&a->ba_lock);
 	}
-	/* XXX If allocation fails then stats are updated for normal zone. */
-	ztype = c != NULL ? z : M0_BAP_NORMAL;
+	/*
+	 * The chunk is not free, so nobody else touches its memory. Zero it
+	 * outside of the allocator lock.
+	 */
 	if (c != NULL) {
-		c = be_alloc_chunk_trysplit(a, ztype, tx, c, size, shift);
-		M0_ASSERT(c != NULL);
-		M0_ASSERT(c->bac_zone == ztype);
 		memset(&c->bac_mem, 0, size);
 		m0_be_tx_capture(tx, &M0_BE_REG(a->ba_seg, size, &c->bac_mem));
 	}
 	*ptr = c == NULL ? NULL : &c->bac_mem;
-	be_allocator_stats_update(&a->ba_h[ztype]->bah_stats,
-				  c == NULL ? size : c->bac_size, true, c == 0);
-	be_allocator_stats_capture(a, ztype, tx);
-	/* and ends here */
 
 	M0_LOG(M0_DEBUG, "allocator=%p size=%" PRIu64 " shift=%u "
-	       "c=%p c->bac_size=%" PRIu64 " ptr=%p", a, size, shift, c,
-	       c == NULL ? 0 : c->bac_size, *ptr);
-	if (*ptr == NULL) {
-		be_allocator_stats_print(&a->ba_h[ztype]->bah_stats);
-		M0_ASSERT(m0_be_allocator__invariant(a));
-	}
-
-	if (c != NULL) {
-		M0_POST(!c->bac_free);
-		M0_POST(c->bac_size >= size);
-		M0_POST(m0_addr_is_aligned(&c->bac_mem, shift));
-		M0_POST(be_alloc_chunk_is_in(a, ztype, c));
-	}
-	/*
-	 * unlock mutex after post-conditions which are using allocator
-	 * internals
-	 */
-	M0_POST_EX(m0_be_allocator__invariant(a));
-	m0_mutex_unlock(&a->ba_lock);
+	       "c=%p ptr=%p", a, size, shift, c, *ptr);
 
 	/* set op state after post-conditions because they are using op */
 	m0_be_op_done(op);
@@ -1103,47 +1489,47 @@ M0_INTERNAL void m0_be_free_aligned(struct m0_be_allocator *a,
 				    struct m0_be_op *op,
 				    void *ptr)
 {
-	enum m0_be_alloc_zone_type  ztype;
-	struct be_alloc_chunk      *c;
-	struct be_alloc_chunk      *prev;
-	struct be_alloc_chunk      *next;
-	bool		            chunks_were_merged;
+	struct m0_be_allocator_header *h;
+	struct m0_mutex               *lock;
+	struct be_alloc_chunk         *c;
+	struct be_alloc_chunk         *prev;
+	struct be_alloc_chunk         *next;
+	bool		               chunks_were_merged;
 
 	M0_PRE(ptr != NULL);
-	M0_PRE(m0_reduce(z, M0_BAP_NR, 0,
-			 +(int)be_alloc_mem_is_in(a, z, ptr, 1)) == 1);
+
+	h = be_alloc_header_find(a, ptr);
+	M0_PRE(h != NULL);
+	lock = be_alloc_header_lock(a, h);
 
 	m0_be_op_active(op);
 
-	m0_mutex_lock(&a->ba_lock);
-	M0_PRE_EX(m0_be_allocator__invariant(a));
+	m0_mutex_lock(lock);
+	M0_PRE_EX(ergo(lock == &a->ba_lock, m0_be_allocator__invariant(a)));
 
 	c = be_alloc_chunk_addr(ptr);
 	M0_PRE(be_alloc_chunk_invariant(a, c));
 	M0_PRE(!c->bac_free);
-	ztype = c->bac_zone;
 	M0_LOG(M0_DEBUG, "allocator=%p c=%p c->bac_size=%" PRIu64 " zone=%d "
 			"data=%p", a, c, c->bac_size, c->bac_zone, &c->bac_mem);
 	/* algorithm starts here */
-	be_alloc_chunk_mark_free(a, ztype, tx, c);
+	be_alloc_chunk_mark_free(a, h, tx, c);
 	/* update stats before c->bac_size gets modified due to merge */
-	be_allocator_stats_update(&a->ba_h[ztype]->bah_stats,
-			c->bac_size, false, false);
-	prev = be_alloc_chunk_prev(a, ztype, c);
-	next = be_alloc_chunk_next(a, ztype, c);
-	chunks_were_merged = be_alloc_chunk_trymerge(a, ztype, tx,
-			prev, c);
+	be_allocator_stats_update(&h->bah_stats, c->bac_size, false, false);
+	prev = be_alloc_chunk_prev(a, h, c);
+	next = be_alloc_chunk_next(a, h, c);
+	chunks_were_merged = be_alloc_chunk_trymerge(a, h, tx, prev, c);
 	if (chunks_were_merged)
 		c = prev;
-	be_alloc_chunk_trymerge(a, ztype, tx, c, next);
-	be_allocator_stats_capture(a, ztype, tx);
+	be_alloc_chunk_trymerge(a, h, tx, c, next);
+	be_allocator_stats_capture(a, h, tx);
 	/* and ends here */
 	M0_POST(c->bac_free);
 	M0_POST(c->bac_size > 0);
 	M0_POST(be_alloc_chunk_invariant(a, c));
 
-	M0_POST_EX(m0_be_allocator__invariant(a));
-	m0_mutex_unlock(&a->ba_lock);
+	M0_POST_EX(ergo(lock == &a->ba_lock, m0_be_allocator__invariant(a)));
+	m0_mutex_unlock(lock);
 
 	m0_be_op_done(op);
 }
@@ -1156,12 +1542,50 @@ M0_INTERNAL void m0_be_free(struct m0_be_allocator *a,
 	m0_be_free_aligned(a, tx, op, ptr);
 }
 
+static void
+be_allocator_call_stats_add(struct m0_be_allocator_call_stats       *sum,
+			    const struct m0_be_allocator_call_stats *cs)
+{
+	be_allocator_call_stat_update(&sum->bacs_alloc_success,
+				      cs->bacs_alloc_success.bcs_nr,
+				      cs->bacs_alloc_success.bcs_size);
+	be_allocator_call_stat_update(&sum->bacs_alloc_failure,
+				      cs->bacs_alloc_failure.bcs_nr,
+				      cs->bacs_alloc_failure.bcs_size);
+	be_allocator_call_stat_update(&sum->bacs_free,
+				      cs->bacs_free.bcs_nr,
+				      cs->bacs_free.bcs_size);
+}
+
+static void be_allocator_stats_add(struct m0_be_allocator_stats       *sum,
+				   const struct m0_be_allocator_stats *stats)
+{
+	sum->bas_space_total    += stats->bas_space_total;
+	sum->bas_space_used     += stats->bas_space_used;
+	sum->bas_space_free     += stats->bas_space_free;
+	sum->bas_chunks_nr      += stats->bas_chunks_nr;
+	sum->bas_free_chunks_nr += stats->bas_free_chunks_nr;
+	be_allocator_call_stats_add(&sum->bas_total, &stats->bas_total);
+	be_allocator_call_stats_add(&sum->bas_stat0, &stats->bas_stat0);
+	be_allocator_call_stats_add(&sum->bas_stat1, &stats->bas_stat1);
+}
+
 M0_INTERNAL void m0_be_alloc_stats(struct m0_be_allocator *a,
 				   struct m0_be_allocator_stats *out)
 {
+	struct m0_be_allocator_header *h;
+	int                            i;
+
+	/* ba_lock is held so that no space moves between zone and arenas */
 	m0_mutex_lock(&a->ba_lock);
 	M0_PRE_EX(m0_be_allocator__invariant(a));
 	*out = a->ba_h[M0_BAP_NORMAL]->bah_stats;
+	for (i = 0; i < M0_BE_ALLOC_ARENA_NR; ++i) {
+		h = be_alloc_arena_header(a, i);
+		m0_mutex_lock(&a->ba_arena_lock[i]);
+		be_allocator_stats_add(out, &h->bah_stats);
+		m0_mutex_unlock(&a->ba_arena_lock[i]);
+	}
 	m0_mutex_unlock(&a->ba_lock);
 }
 
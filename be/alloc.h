@@ -126,6 +126,23 @@ struct m0_be_allocator_stats {
 	unsigned long                     bas_print_index;
 } M0_XCA_RECORD M0_XCA_DOMAIN(be);
 
+enum {
+	/** Number of per-CPU arenas carved out of M0_BAP_NORMAL zone. */
+	M0_BE_ALLOC_ARENA_NR       = 8,
+	/**
+	 * Largest allocation served by an arena. Covers btree nodes and
+	 * records of cob and catalogue trees.
+	 */
+	M0_BE_ALLOC_ARENA_SIZE_MAX = 0x2000,
+	/**
+	 * Share of M0_BAP_NORMAL zone (in percents) given to the arenas if all
+	 * of them are used. Arena gets its part on the first allocation.
+	 */
+	M0_BE_ALLOC_ARENA_PERCENT  = 25,
+	/** Arenas are not given space if each of them is smaller than this. */
+	M0_BE_ALLOC_ARENA_SIZE_MIN = 1 << 20,
+};
+
 struct m0_be_allocator_header;
 
 /** @brief Allocator */
@@ -143,6 +160,16 @@ struct m0_be_allocator {
 	struct m0_mutex		       ba_lock;
 	/** Internal allocator data. It is stored inside the segment. */
 	struct m0_be_allocator_header *ba_h[M0_BAP_NR];
+	/**
+	 * Locks of per-CPU arenas.
+	 *
+	 * Arena is a part of M0_BAP_NORMAL zone with its own chunk list and
+	 * free lists (m0_be_allocator_header, see m0_be_seg_hdr::bh_arena).
+	 * Small allocations made on different CPUs go to different arenas, so
+	 * they don't contend on ba_lock. i-th lock protects i-th arena chunks,
+	 * lists and statistics. If ba_lock is needed too, it is taken first.
+	 */
+	struct m0_mutex                ba_arena_lock[M0_BE_ALLOC_ARENA_NR];
 };
 
 /**
@@ -301,7 +328,9 @@ M0_INTERNAL void m0_be_free(struct m0_be_allocator *a,
 /**
  * Return allocator statistics.
  *
- * @note Not implemented yet.
+ * Statistics of M0_BAP_NORMAL zone are returned. They are summed up with
+ * statistics of the arenas, which are parts of the zone.
+ *
  * @see m0_be_allocator_stats.
  */
 M0_INTERNAL void m0_be_alloc_stats(struct m0_be_allocator *a,
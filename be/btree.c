@@ -30,6 +30,7 @@
 #include "lib/trace.h"
 
 #include "lib/errno.h"
+#include "lib/atomic.h"        /* m0_atomic64 */
 #include "lib/finject.h"       /* M0_FI_ENABLED() */
 #include "lib/misc.h"          /* offsetof */
 #include "be/alloc.h"
@@ -41,7 +42,33 @@
 /* btree constants */
 enum {
 	BTREE_ALLOC_SHIFT = 0,
+	/**
+	 * Number of optimistic attempts a lookup makes before falling back
+	 * to the read lock.
+	 */
+	BTREE_OPTIMISTIC_ATTEMPTS = 4,
+};
+
+/**
+ * Volatile lock state of a tree.
+ *
+ * It is placed in the padding of m0_be_btree::bb_lock, so the layout of
+ * struct m0_be_btree in the segment is not changed.
+ */
+struct btree_lock {
+	/** Has to be the first field, see btree_rwlock(). */
+	struct m0_rwlock   bl_rwlock;
+	/**
+	 * Sequence counter. It is odd while a writer holds bl_rwlock.
+	 * Optimistic readers use it to detect concurrent modifications.
+	 */
+	struct m0_atomic64 bl_seq;
+	/** Optimistic lookups are enabled, m0_be_btree_optimistic_set(). */
+	bool               bl_optimistic;
 };
+M0_BASSERT(sizeof(struct btree_lock) <=
+	   sizeof(M0_FIELD_VALUE(struct m0_be_rwlock, bl_u.pad)));
+M0_BASSERT(offsetof(struct btree_lock, bl_rwlock) == 0);
 
 enum btree_save_optype {
 	BTREE_SAVE_INSERT,
@@ -60,7 +87,16 @@ M0_INTERNAL const struct m0_fid_type m0_btree_fid_type = {
 };
 
 static struct m0_be_op__btree *op_tree(struct m0_be_op *op);
+static struct btree_lock *btree_lock(struct m0_be_btree *tree);
 static struct m0_rwlock *btree_rwlock(struct m0_be_btree *tree);
+static void btree_write_lock(struct m0_be_btree *tree);
+static void btree_write_unlock(struct m0_be_btree *tree);
+static bool btree_seq_read_begin(struct m0_be_btree *tree, int64_t *seq);
+static bool btree_seq_read_valid(struct m0_be_btree *tree, int64_t seq);
+static bool btree_write_lock_descend(struct m0_be_btree    *tree,
+				     const void            *key,
+				     struct btree_node_pos *pos,
+				     bool                  *found);
 
 static struct be_btree_key_val *be_btree_search(struct m0_be_btree *btree,
 						void *key);
@@ -178,10 +214,42 @@ static inline int key_gt(const struct m0_be_btree *btree,
 	return be_btree_compare(btree, key0, key1)  >  0;
 }
 
-static inline int key_eq(const struct m0_be_btree *btree,
-			 const void *key0, const void *key1)
-{
-	return be_btree_compare(btree, key0, key1) ==  0;
+/**
+ * Searches @node for @key using binary search.
+ *
+ * Keys in a node are kept sorted (see btree_node_invariant()), so the search
+ * takes O(log(bt_num_active_key)) key comparisons instead of a linear scan.
+ * Each probe makes a single call to ->ko_compare().
+ *
+ * @param found set to true iff the key at the returned index is equal to @key.
+ * @return index of the first key in @node which is greater than or equal to
+ *         @key, or bt_num_active_key if there is no such key.
+ */
+static unsigned int be_btree_node_search(const struct m0_be_btree *btree,
+					 const struct m0_be_bnode *node,
+					 const void               *key,
+					 bool                     *found)
+{
+	unsigned int lo = 0;
+	unsigned int hi = node->bt_num_active_key;
+	unsigned int mid;
+	int          diff;
+
+	*found = false;
+	while (lo < hi) {
+		mid  = lo + (hi - lo) / 2;
+		diff = be_btree_compare(btree, key,
+					node->bt_kv_arr[mid].btree_key);
+		if (diff > 0) {
+			lo = mid + 1;
+		} else if (diff < 0) {
+			hi = mid;
+		} else {
+			*found = true;
+			return mid;
+		}
+	}
+	return lo;
 }
 
 /* ------------------------------------------------------------------
@@ -531,15 +599,13 @@ static void be_btree_insert_into_nonfull(struct m0_be_btree      *btree,
 					 struct m0_be_bnode      *node,
 					 struct be_btree_key_val *kv)
 {
-	void *key = kv->btree_key;
-	int i = node->bt_num_active_key - 1;
+	void        *key = kv->btree_key;
+	unsigned int i;
+	bool         found;
 
 	while (!node->bt_isleaf)
 	{
-		while (i >= 0 &&
-		       key_lt(btree, key, node->bt_kv_arr[i].btree_key))
-			i--;
-		i++;
+		i = be_btree_node_search(btree, node, key, &found);
 
 		if (node->bt_child_arr[i]->bt_num_active_key == KV_NR) {
 			be_btree_split_child(btree, tx, node, i);
@@ -547,15 +613,12 @@ static void be_btree_insert_into_nonfull(struct m0_be_btree      *btree,
 				i++;
 		}
 		node = node->bt_child_arr[i];
-		i = node->bt_num_active_key - 1;
 	}
 
-	while (i >= 0 &&
-	       key_lt(btree, key, node->bt_kv_arr[i].btree_key)) {
-		node->bt_kv_arr[i + 1] = node->bt_kv_arr[i];
-		i--;
-	}
-	node->bt_kv_arr[i + 1] = *kv;
+	i = be_btree_node_search(btree, node, key, &found);
+	memmove(&node->bt_kv_arr[i + 1], &node->bt_kv_arr[i],
+		sizeof node->bt_kv_arr[0] * (node->bt_num_active_key - i));
+	node->bt_kv_arr[i] = *kv;
 	node->bt_num_active_key++;
 
 	m0_format_footer_update(node);
@@ -914,6 +977,7 @@ static int be_btree_delete_key(struct m0_be_btree *tree,
 			       void               *key)
 {
 	bool			outerloop = true;
+	bool			found;
 	struct m0_be_bnode     *righsib;
 	struct m0_be_bnode     *leftsib;
 	struct m0_be_bnode     *p_node = NULL;
@@ -939,17 +1003,11 @@ static int be_btree_delete_key(struct m0_be_btree *tree,
 
 			/*  Retrieve index of the key equal to or greater than*/
 			/*  key being searched */
-			iter = 0;
-			while (iter < bnode->bt_num_active_key &&
-			       key_gt(tree, key,
-				      bnode->bt_kv_arr[iter].btree_key))
-				iter++;
-
+			iter = be_btree_node_search(tree, bnode, key, &found);
 			idx = iter;
 
 			/* check if key is found */
-			if (iter < bnode->bt_num_active_key &&
-			    key_eq(tree, key, bnode->bt_kv_arr[iter].btree_key))
+			if (found)
 				break;
 
 			/* Reached leaf node, nothing left to search */
@@ -1102,6 +1160,7 @@ struct btree_node_pos
 be_btree_get_btree_node(struct m0_be_btree_cursor *it, const void *key, bool slant)
 {
 	int 			 idx;
+	bool			 found;
 	struct m0_be_btree 	*tree = it->bc_tree;
 	struct m0_be_bnode 	*bnode = tree->bb_root;
 	struct btree_node_pos    bnode_pos = { .bnp_node = NULL };
@@ -1111,15 +1170,10 @@ be_btree_get_btree_node(struct m0_be_btree_cursor *it, const void *key, bool sla
 	while (true) {
 		/*  Retrieve index of the key equal to or greater than */
 		/*  the key being searched */
-		idx = 0;
-		while (idx < bnode->bt_num_active_key &&
-		       key_gt(tree, key, bnode->bt_kv_arr[idx].btree_key)) {
-			idx++;
-		}
+		idx = be_btree_node_search(tree, bnode, key, &found);
 
 		/*  If key is found, copy key-value pair */
-		if (idx < bnode->bt_num_active_key &&
-		    key_eq(tree, key, bnode->bt_kv_arr[idx].btree_key)) {
+		if (found) {
 			bnode_pos.bnp_node = bnode;
 			bnode_pos.bnp_index = idx;
 			break;
@@ -1375,6 +1429,9 @@ static void btree_save(struct m0_be_btree        *tree,
 	m0_bcount_t        vsz;
 	struct be_btree_key_val   new_kv;
 	struct be_btree_key_val  *cur_kv;
+	struct btree_node_pos     pos;
+	bool               found;
+	bool               descended;
 	bool               val_overflow = false;
 
 	M0_ENTRY("tree=%p", tree);
@@ -1398,7 +1455,7 @@ static void btree_save(struct m0_be_btree        *tree,
 		      M0_BBO_UPDATE : M0_BBO_INSERT, NULL);
 
 	m0_be_op_active(op);
-	m0_rwlock_write_lock(btree_rwlock(tree));
+	descended = btree_write_lock_descend(tree, key->b_addr, &pos, &found);
 	if (anchor != NULL) {
 		anchor->ba_tree = tree;
 		anchor->ba_write = true;
@@ -1411,7 +1468,10 @@ static void btree_save(struct m0_be_btree        *tree,
 		goto fi_exist;
 
 	op_tree(op)->t_rc = 0;
-	cur_kv = be_btree_search(tree, key->b_addr);
+	if (descended)
+		cur_kv = found ? &pos.bnp_node->bt_kv_arr[pos.bnp_index] : NULL;
+	else
+		cur_kv = be_btree_search(tree, key->b_addr);
 	if ((cur_kv == NULL && optype != BTREE_SAVE_UPDATE) ||
 	    (cur_kv != NULL && optype == BTREE_SAVE_UPDATE) ||
 	    optype == BTREE_SAVE_OVERWRITE) {
@@ -1464,7 +1524,20 @@ static void btree_save(struct m0_be_btree        *tree,
 				anchor->ba_value.b_addr = new_kv.btree_val;
 			}
 
-			be_btree_insert_newkey(tree, tx, &new_kv);
+			/*
+			 * The leaf found by the optimistic descent has room
+			 * for the key: no split is needed, modify the leaf
+			 * only. val_overflow means the tree has been changed
+			 * by the delete above and the position is stale.
+			 */
+			if (descended && !val_overflow &&
+			    pos.bnp_node->bt_isleaf &&
+			    pos.bnp_node->bt_num_active_key < KV_NR)
+				be_btree_insert_into_nonfull(tree, tx,
+							     pos.bnp_node,
+							     &new_kv);
+			else
+				be_btree_insert_newkey(tree, tx, &new_kv);
 		}
 	} else {
 fi_exist:
@@ -1474,7 +1547,7 @@ fi_exist:
 	}
 
 	if (anchor == NULL)
-		m0_rwlock_write_unlock(btree_rwlock(tree));
+		btree_write_unlock(tree);
 	m0_be_op_done(op);
 	M0_LEAVE("tree=%p", tree);
 }
@@ -1491,7 +1564,14 @@ M0_INTERNAL void m0_be_btree_init(struct m0_be_btree *tree,
 	M0_ENTRY("tree=%p seg=%p", tree, seg);
 	M0_PRE(ops != NULL);
 
+	/*
+	 * The tree keeps volatile fields in segment memory. They are not
+	 * captured, so the page can't be evicted until m0_be_btree_fini().
+	 */
+	m0_be_seg_pin(seg, tree, sizeof *tree);
 	m0_rwlock_init(btree_rwlock(tree));
+	m0_atomic64_set(&btree_lock(tree)->bl_seq, 0);
+	btree_lock(tree)->bl_optimistic = false;
 	tree->bb_ops = ops;
 	tree->bb_seg = seg;
 
@@ -1500,12 +1580,19 @@ M0_INTERNAL void m0_be_btree_init(struct m0_be_btree *tree,
 	M0_LEAVE();
 }
 
+M0_INTERNAL void m0_be_btree_optimistic_set(struct m0_be_btree *tree,
+					    bool                enable)
+{
+	btree_lock(tree)->bl_optimistic = enable;
+}
+
 M0_INTERNAL void m0_be_btree_fini(struct m0_be_btree *tree)
 {
 	M0_ENTRY("tree=%p", tree);
 	M0_PRE(ergo(tree->bb_root != NULL && tree->bb_header.hd_magic != 0,
 		    btree_invariant(tree)));
 	m0_rwlock_fini(btree_rwlock(tree));
+	m0_be_seg_unpin(tree->bb_seg, tree, sizeof *tree);
 	M0_LEAVE();
 }
 
@@ -1522,11 +1609,11 @@ M0_INTERNAL void m0_be_btree_create(struct m0_be_btree  *tree,
 	btree_op_fill(op, tree, tx, M0_BBO_CREATE, NULL);
 
 	m0_be_op_active(op);
-	m0_rwlock_write_lock(btree_rwlock(tree));
+	btree_write_lock(tree);
 
 	btree_create(tree, tx, btree_fid);
 
-	m0_rwlock_write_unlock(btree_rwlock(tree));
+	btree_write_unlock(tree);
 	op_tree(op)->t_rc = 0;
 	m0_be_op_done(op);
 	M0_POST(btree_invariant(tree));
@@ -1551,11 +1638,11 @@ M0_INTERNAL void m0_be_btree_destroy(struct m0_be_btree *tree,
 	btree_op_fill(op, tree, tx, M0_BBO_DESTROY, NULL);
 
 	m0_be_op_active(op);
-	m0_rwlock_write_lock(btree_rwlock(tree));
+	btree_write_lock(tree);
 
 	be_btree_destroy(tree, tx);
 
-	m0_rwlock_write_unlock(btree_rwlock(tree));
+	btree_write_unlock(tree);
 	op_tree(op)->t_rc = 0;
 	m0_be_op_done(op);
 	M0_LEAVE();
@@ -1577,11 +1664,11 @@ M0_INTERNAL void m0_be_btree_truncate(struct m0_be_btree *tree,
 	btree_op_fill(op, tree, tx, M0_BBO_DESTROY, NULL);
 
 	m0_be_op_active(op);
-	m0_rwlock_write_lock(btree_rwlock(tree));
+	btree_write_lock(tree);
 
 	btree_truncate(tree, tx, limit);
 
-	m0_rwlock_write_unlock(btree_rwlock(tree));
+	btree_write_unlock(tree);
 	op_tree(op)->t_rc = 0;
 	m0_be_op_done(op);
 	M0_LEAVE();
@@ -1960,7 +2047,9 @@ M0_INTERNAL void m0_be_btree_delete(struct m0_be_btree *tree,
 				    struct m0_be_op *op,
 				    const struct m0_buf *key)
 {
-	int rc;
+	struct btree_node_pos pos;
+	bool                  found;
+	int                   rc;
 
 	M0_ENTRY("tree=%p", tree);
 	M0_PRE(tree->bb_root != NULL && tree->bb_ops != NULL);
@@ -1970,18 +2059,263 @@ M0_INTERNAL void m0_be_btree_delete(struct m0_be_btree *tree,
 	btree_op_fill(op, tree, tx, M0_BBO_DELETE, NULL);
 
 	m0_be_op_active(op);
-	m0_rwlock_write_lock(btree_rwlock(tree));
-
-	op_tree(op)->t_rc = rc = be_btree_delete_key(tree, tx, tree->bb_root,
-						     key->b_addr);
-	if (rc != 0)
-		op_tree(op)->t_rc = -ENOENT;
+	if (btree_write_lock_descend(tree, key->b_addr, &pos, &found) &&
+	    (!found ||
+	     (pos.bnp_node->bt_isleaf &&
+	      (pos.bnp_node->bt_num_active_key > BTREE_FAN_OUT - 1 ||
+	       pos.bnp_node == tree->bb_root)))) {
+		/*
+		 * The key is missing or sits in a leaf that doesn't
+		 * underflow, the "case1" of be_btree_delete_key().
+		 */
+		if (found)
+			be_btree_delete_key_from_node(tree, tx, &pos);
+		op_tree(op)->t_rc = found ? 0 : -ENOENT;
+	} else {
+		op_tree(op)->t_rc = rc = be_btree_delete_key(tree, tx,
+							     tree->bb_root,
+							     key->b_addr);
+		if (rc != 0)
+			op_tree(op)->t_rc = -ENOENT;
+	}
 
-	m0_rwlock_write_unlock(btree_rwlock(tree));
+	btree_write_unlock(tree);
 	m0_be_op_done(op);
 	M0_LEAVE("tree=%p", tree);
 }
 
+static bool btree_seg_contains(const struct m0_be_seg *seg,
+			       const void *addr, m0_bcount_t size)
+{
+	return m0_be_seg_contains(seg, addr) &&
+	       m0_be_seg_contains(seg, (const char *)addr + size - 1);
+}
+
+/**
+ * Single attempt of an optimistic lookup, see m0_be_btree_optimistic_set().
+ *
+ * Mirrors be_btree_get_btree_node() and the copying part of
+ * be_btree_lookup(), but doesn't take the tree lock. Instead, every
+ * pointer is checked to be inside the segment before it is dereferenced and
+ * the sequence counter is re-validated at each level of the tree.
+ *
+ * @return false if the attempt has to be retried.
+ */
+static bool be_btree_lookup_try(struct m0_be_btree  *tree,
+				int64_t              seq,
+				const void          *key,
+				struct m0_buf       *key_out,
+				struct m0_buf       *value,
+				int                 *rc)
+{
+	const struct m0_be_seg  *seg  = tree->bb_seg;
+	struct m0_be_bnode      *node = tree->bb_root;
+	struct be_btree_key_val  kv   = {};
+	struct be_btree_key_val  succ = {};
+	unsigned int             depth;
+	unsigned int             lo;
+	unsigned int             hi;
+	unsigned int             mid = 0;
+	unsigned int             nr;
+	m0_bcount_t              ksize;
+	m0_bcount_t              vsize;
+	void                    *k;
+	int                      diff;
+
+	for (depth = 0; kv.btree_key == NULL; ++depth) {
+		if (depth > BTREE_HEIGHT_MAX ||
+		    !btree_seg_contains(seg, node, sizeof *node))
+			return false;
+		nr = node->bt_num_active_key;
+		if (nr > KV_NR || !btree_seq_read_valid(tree, seq))
+			return false;
+		lo = 0;
+		hi = nr;
+		while (lo < hi) {
+			mid = lo + (hi - lo) / 2;
+			k = node->bt_kv_arr[mid].btree_key;
+			if (!m0_be_seg_contains(seg, k) ||
+			    !btree_seg_contains(seg, k,
+						be_btree_ksize(tree, k)))
+				return false;
+			diff = be_btree_compare(tree, key, k);
+			if (diff > 0)
+				lo = mid + 1;
+			else if (diff < 0)
+				hi = mid;
+			else
+				break;
+		}
+		if (lo < hi) {
+			kv = node->bt_kv_arr[mid];
+		} else if (node->bt_isleaf) {
+			/*
+			 * Slant lookup returns the least key greater than
+			 * @key: either in this leaf or in the nearest
+			 * ancestor, see be_btree_get_btree_node().
+			 */
+			if (key_out == NULL)
+				break;
+			kv = lo < nr ? node->bt_kv_arr[lo] : succ;
+			break;
+		} else {
+			if (lo < nr)
+				succ = node->bt_kv_arr[lo];
+			node = node->bt_child_arr[lo];
+		}
+	}
+
+	if (kv.btree_key == NULL) {
+		*rc = -ENOENT;
+		return btree_seq_read_valid(tree, seq);
+	}
+	if (!m0_be_seg_contains(seg, kv.btree_key) ||
+	    !m0_be_seg_contains(seg, kv.btree_val))
+		return false;
+
+	vsize = be_btree_vsize(tree, kv.btree_val);
+	if (vsize < value->b_nob)
+		value->b_nob = vsize;
+	if (!btree_seg_contains(seg, kv.btree_val, value->b_nob))
+		return false;
+	memcpy(value->b_addr, kv.btree_val, value->b_nob);
+
+	if (key_out != NULL) {
+		ksize = be_btree_ksize(tree, kv.btree_key);
+		if (ksize < key_out->b_nob)
+			key_out->b_nob = ksize;
+		if (!btree_seg_contains(seg, kv.btree_key, key_out->b_nob))
+			return false;
+		memcpy(key_out->b_addr, kv.btree_key, key_out->b_nob);
+	}
+	*rc = 0;
+	return btree_seq_read_valid(tree, seq);
+}
+
+/**
+ * Performs lookup without taking the tree lock.
+ *
+ * @return false if all BTREE_OPTIMISTIC_ATTEMPTS attempts ran concurrently
+ *         with writers, in which case the caller has to take the lock.
+ */
+static bool be_btree_lookup_optimistic(struct m0_be_btree  *tree,
+				       const struct m0_buf *key_in,
+				       struct m0_buf       *key_out,
+				       struct m0_buf       *value,
+				       int                 *rc)
+{
+	m0_bcount_t knob = key_out != NULL ? key_out->b_nob : 0;
+	m0_bcount_t vnob = value->b_nob;
+	int64_t     seq;
+	int         i;
+
+	for (i = 0; i < BTREE_OPTIMISTIC_ATTEMPTS; ++i) {
+		if (!btree_seq_read_begin(tree, &seq))
+			continue;
+		if (be_btree_lookup_try(tree, seq, key_in->b_addr,
+					key_out, value, rc))
+			return true;
+		/* Restore buffer sizes trimmed by the failed attempt. */
+		value->b_nob = vnob;
+		if (key_out != NULL)
+			key_out->b_nob = knob;
+	}
+	return false;
+}
+
+/**
+ * Single attempt of an optimistic descent to the node holding @key or, if
+ * @key is not in the tree, to the leaf where it would be inserted.
+ *
+ * Checks pointers and the sequence counter the same way as
+ * be_btree_lookup_try(). On success @pos is set to the matching key or to the
+ * least key greater than @key in the leaf.
+ *
+ * @return false if the attempt has to be retried.
+ */
+static bool be_btree_descend_try(struct m0_be_btree    *tree,
+				 int64_t                seq,
+				 const void            *key,
+				 struct btree_node_pos *pos,
+				 bool                  *found)
+{
+	const struct m0_be_seg *seg  = tree->bb_seg;
+	struct m0_be_bnode     *node = tree->bb_root;
+	unsigned int            depth;
+	unsigned int            lo;
+	unsigned int            hi;
+	unsigned int            mid = 0;
+	unsigned int            nr;
+	void                   *k;
+	int                     diff;
+
+	for (depth = 0; depth <= BTREE_HEIGHT_MAX; ++depth) {
+		if (!btree_seg_contains(seg, node, sizeof *node))
+			return false;
+		nr = node->bt_num_active_key;
+		if (nr > KV_NR || !btree_seq_read_valid(tree, seq))
+			return false;
+		lo = 0;
+		hi = nr;
+		while (lo < hi) {
+			mid = lo + (hi - lo) / 2;
+			k = node->bt_kv_arr[mid].btree_key;
+			if (!m0_be_seg_contains(seg, k) ||
+			    !btree_seg_contains(seg, k,
+						be_btree_ksize(tree, k)))
+				return false;
+			diff = be_btree_compare(tree, key, k);
+			if (diff > 0)
+				lo = mid + 1;
+			else if (diff < 0)
+				hi = mid;
+			else
+				break;
+		}
+		if (lo < hi || node->bt_isleaf) {
+			*found = lo < hi;
+			pos->bnp_node  = node;
+			pos->bnp_index = *found ? mid : lo;
+			return btree_seq_read_valid(tree, seq);
+		}
+		node = node->bt_child_arr[lo];
+	}
+	return false;
+}
+
+/**
+ * Takes the tree write lock before a modification of @key.
+ *
+ * In optimistic mode the tree is descended without the lock, so that
+ * writers only serialise on the modification itself. The lock is then
+ * taken and the descent is valid iff no other writer took it in between,
+ * i.e. the sequence counter advanced exactly by our own increment. On a
+ * mismatch the lock is kept and the caller redoes the descent under it.
+ *
+ * @return true iff @pos and @found are valid under the lock.
+ */
+static bool btree_write_lock_descend(struct m0_be_btree    *tree,
+				     const void            *key,
+				     struct btree_node_pos *pos,
+				     bool                  *found)
+{
+	int64_t seq;
+	int     i;
+
+	if (btree_lock(tree)->bl_optimistic) {
+		for (i = 0; i < BTREE_OPTIMISTIC_ATTEMPTS; ++i) {
+			if (!btree_seq_read_begin(tree, &seq) ||
+			    !be_btree_descend_try(tree, seq, key, pos, found))
+				continue;
+			btree_write_lock(tree);
+			return m0_atomic64_get(&btree_lock(tree)->bl_seq) ==
+				seq + 1;
+		}
+	}
+	btree_write_lock(tree);
+	return false;
+}
+
 static void be_btree_lookup(struct m0_be_btree *tree,
 			    struct m0_be_op *op,
 			    const struct m0_buf *key_in,
@@ -2001,6 +2335,13 @@ static void be_btree_lookup(struct m0_be_btree *tree,
 	btree_op_fill(op, tree, NULL, M0_BBO_LOOKUP, NULL);
 
 	m0_be_op_active(op);
+	if (btree_lock(tree)->bl_optimistic &&
+	    be_btree_lookup_optimistic(tree, key_in, key_out, value,
+				       &op_tree(op)->t_rc)) {
+		m0_be_op_done(op);
+		M0_LEAVE("rc=%d", op_tree(op)->t_rc);
+		return;
+	}
 	m0_rwlock_read_lock(btree_rwlock(tree));
 
 	it.bc_tree = tree;
@@ -2099,6 +2440,8 @@ M0_INTERNAL void m0_be_btree_update_inplace(struct m0_be_btree        *tree,
 					    struct m0_be_btree_anchor *anchor)
 {
 	struct be_btree_key_val  *kv;
+	struct btree_node_pos     pos;
+	bool                      found;
 
 	M0_ENTRY("tree=%p", tree);
 	M0_PRE(tree->bb_root != NULL && tree->bb_ops != NULL);
@@ -2107,11 +2450,13 @@ M0_INTERNAL void m0_be_btree_update_inplace(struct m0_be_btree        *tree,
 	btree_op_fill(op, tree, tx, M0_BBO_UPDATE, NULL);
 
 	m0_be_op_active(op);
-	m0_rwlock_write_lock(btree_rwlock(tree));
+	if (btree_write_lock_descend(tree, key->b_addr, &pos, &found))
+		kv = found ? &pos.bnp_node->bt_kv_arr[pos.bnp_index] : NULL;
+	else
+		kv = be_btree_search(tree, key->b_addr);
 
 	anchor->ba_write = true;
 	anchor->ba_tree  = tree;
-	kv = be_btree_search(tree, key->b_addr);
 	if (kv != NULL) {
 		M0_ASSERT(anchor->ba_value.b_nob <=
 			  be_btree_vsize(tree, kv->btree_val));
@@ -2192,7 +2537,7 @@ M0_INTERNAL void m0_be_btree_release(struct m0_be_tx           *tx,
 					   anchor->ba_value.b_nob);
 				anchor->ba_value.b_addr = NULL;
 			}
-			m0_rwlock_write_unlock(btree_rwlock(tree));
+			btree_write_unlock(tree);
 		} else
 			m0_rwlock_read_unlock(btree_rwlock(tree));
 		anchor->ba_tree = NULL;
@@ -2513,9 +2858,48 @@ static struct m0_be_op__btree *op_tree(struct m0_be_op *op)
 	return &op->bo_u.u_btree;
 }
 
+static struct btree_lock *btree_lock(struct m0_be_btree *tree)
+{
+	return (struct btree_lock *)&tree->bb_lock.bl_u.pad;
+}
+
 static struct m0_rwlock *btree_rwlock(struct m0_be_btree *tree)
 {
-	return &tree->bb_lock.bl_u.rwlock;
+	return &btree_lock(tree)->bl_rwlock;
+}
+
+static void btree_write_lock(struct m0_be_btree *tree)
+{
+	m0_rwlock_write_lock(btree_rwlock(tree));
+	m0_atomic64_inc(&btree_lock(tree)->bl_seq);
+}
+
+static void btree_write_unlock(struct m0_be_btree *tree)
+{
+	m0_atomic64_inc(&btree_lock(tree)->bl_seq);
+	m0_rwlock_write_unlock(btree_rwlock(tree));
+}
+
+/**
+ * Starts an optimistic read of the tree.
+ *
+ * @return false if a writer currently holds the tree lock.
+ */
+static bool btree_seq_read_begin(struct m0_be_btree *tree, int64_t *seq)
+{
+	*seq = m0_atomic64_get(&btree_lock(tree)->bl_seq);
+	m0_mb();
+	return (*seq & 1) == 0;
+}
+
+/**
+ * Returns true iff the tree was not modified since btree_seq_read_begin()
+ * returned @seq.
+ */
+static bool btree_seq_read_valid(struct m0_be_btree *tree, int64_t seq)
+{
+	m0_mb();
+	return m0_atomic64_get(&btree_lock(tree)->bl_seq) == seq;
 }
 
 /** @} end of be group */
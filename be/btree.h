@@ -167,6 +167,37 @@ M0_INTERNAL void m0_be_btree_init(struct m0_be_btree *tree,
 				  struct m0_be_seg *seg,
 				  const struct m0_be_btree_kv_ops *ops);
 
+/**
+ * Enables or disables optimistic traversal for the @tree.
+ *
+ * In optimistic mode m0_be_btree_lookup() and m0_be_btree_lookup_slant()
+ * traverse the tree without taking m0_be_btree::bb_lock. Writers bump a
+ * sequence counter when they take and release the lock, and the lookup is
+ * validated against this counter. If a concurrent modification is detected,
+ * the lookup is retried and eventually falls back to the read lock. Readers
+ * thus never block each other and never write to shared cache lines.
+ *
+ * Writers (insert, update, delete and their inplace variants) descend to the
+ * target node the same way and take the lock only to modify it. The descent
+ * is valid if no other writer took the lock in between, otherwise it is
+ * redone under the lock. Modifications that split or merge nodes always take
+ * the full locked path, so writers still serialise on the modification, but
+ * not on the traversal.
+ *
+ * An optimistic traversal may observe a node while it is modified, so
+ * ->ko_ksize(), ->ko_compare() and ->ko_vsize() of the tree must tolerate keys
+ * and values with arbitrary contents located in the segment. Trees with
+ * fixed-size keys and values compared by value (balloc group extents and
+ * group descriptors) satisfy this requirement and enable the mode. Trees
+ * with length-prefixed keys, e.g. CAS catalogues, don't: a torn length makes
+ * the comparator read past the key.
+ *
+ * Must be called after m0_be_btree_init() and before the tree is used
+ * concurrently. Optimistic mode is disabled by default.
+ */
+M0_INTERNAL void m0_be_btree_optimistic_set(struct m0_be_btree *tree,
+					    bool                enable);
+
 /**
  * Finalises in-memory structures of btree.
  *
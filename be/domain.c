@@ -238,6 +238,12 @@ static int be_domain_seg_open(struct m0_be_domain *dom,
 		m0_be_seg_init(seg, stob, dom, M0_BE_SEG_FAKE_ID);
 		m0_stob_put(stob);
 		rc = m0_be_seg_open(seg);
+		if (rc == 0) {
+			rc = m0_be_seg_paging_enable(seg,
+					&dom->bd_cfg.bc_seg_paging);
+			if (rc != 0)
+				m0_be_seg_close(seg);
+		}
 		if (rc == 0) {
 			(void)m0_be_allocator_init(m0_be_seg_allocator(seg),
 						   seg);
@@ -972,6 +978,17 @@ M0_INTERNAL void m0_be_domain__group_limits(struct m0_be_domain *dom,
 	m0_be_engine__group_limits(&dom->bd_engine, group_nr, tx_per_group);
 }
 
+M0_INTERNAL void m0_be_domain__seg_evict(struct m0_be_domain *dom)
+{
+	struct m0_be_seg *seg;
+
+	be_domain_lock(dom);
+	m0_tl_for(seg, &dom->bd_segs, seg) {
+		(void)m0_be_seg_evict(seg);
+	} m0_tl_endfor;
+	be_domain_unlock(dom);
+}
+
 M0_INTERNAL bool m0_be_domain_is_stob_log(struct m0_be_domain     *dom,
                                           const struct m0_stob_id *stob_id)
 {
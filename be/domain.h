@@ -101,6 +101,8 @@ struct m0_be_domain_cfg {
 	 * The sum of all array elements should be 100.
 	 */
 	uint32_t                     bc_zone_pcnt[M0_BAP_NR];
+	/** Demand paging of the segments. Disabled by default. */
+	struct m0_be_seg_paging_cfg  bc_seg_paging;
 
 	/*
 	 * Next fields are for mkfs mode only.
@@ -266,6 +268,14 @@ M0_INTERNAL void m0_be_domain__group_limits(struct m0_be_domain *dom,
                                             uint32_t            *group_nr,
                                             uint32_t            *tx_per_group);
 
+/**
+ * Evicts pages of the paged segments of the domain.
+ *
+ * Should be called only when there are no active transactions.
+ * @see m0_be_seg_evict()
+ */
+M0_INTERNAL void m0_be_domain__seg_evict(struct m0_be_domain *dom);
+
 /**
  * Check if the stob with the stob_id is used as a log stob
  * for the given domain.
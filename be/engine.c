@@ -157,6 +157,12 @@ M0_INTERNAL int m0_be_engine_init(struct m0_be_engine     *en,
 
 	m0_semaphore_init(&en->eng_recovery_wait_sem, 0);
 	en->eng_recovery_finished = false;
+	en->eng_evict_ast    = (struct m0_sm_ast){};
+	en->eng_evict_posted = false;
+	en->eng_evicting     = false;
+	en->eng_evict_gated  = 0;
+	en->eng_evict_next   = 0;
+	m0_sm_timer_init(&en->eng_evict_timer);
 
 	M0_POST(m0_be_engine__invariant(en));
 	return M0_RC(0);
@@ -186,6 +192,7 @@ M0_INTERNAL void m0_be_engine_fini(struct m0_be_engine *en)
 		       log_size, log_free);
 
 	m0_semaphore_fini(&en->eng_recovery_wait_sem);
+	m0_sm_timer_fini(&en->eng_evict_timer);
 
 	m0_forall(i, ARRAY_SIZE(en->eng_txs),
 		  (etx_tlist_fini(&en->eng_txs[i]), true));
@@ -555,6 +562,9 @@ static void be_engine_got_tx_grouping(struct m0_be_engine *en)
 
 	M0_PRE(be_engine_is_locked(en));
 
+	/* Transactions are grouped again after be_engine_seg_evict_ast(). */
+	if (en->eng_evicting)
+		return;
 	/* Close recovering transactions */
 	while ((tx = be_engine_recovery_tx_find(en, M0_BTS_GROUPING)) != NULL) {
 		/*
@@ -609,6 +619,144 @@ static void be_engine_got_tx_done(struct m0_be_engine *en, struct m0_be_tx *tx)
 	}
 }
 
+enum {
+	/** Minimal interval between evictions of the paged segments. */
+	BE_ENGINE_SEG_EVICT_INTERVAL = 10 * M0_TIME_ONE_MSEC,
+	/** Interval between checks for active transactions to be closed. */
+	BE_ENGINE_SEG_EVICT_RETRY    = M0_TIME_ONE_MSEC,
+	/**
+	 * Maximal time new transactions are kept from becoming ACTIVE while
+	 * eviction waits for the active ones. Eviction is retried after
+	 * BE_ENGINE_SEG_EVICT_INTERVAL if they are not closed in time.
+	 */
+	BE_ENGINE_SEG_EVICT_DRAIN    = 5 * M0_TIME_ONE_MSEC,
+};
+
+/**
+ * Segment memory is modified before it is captured, so a page without pins
+ * may still have modifications of an ACTIVE transaction which are not captured
+ * yet. Pages of paged segments can be evicted only when no transaction is
+ * ACTIVE. Transactions in the other states don't prevent eviction: their
+ * captured pages are pinned since m0_be_tx_capture() until they are placed.
+ *
+ * m0_sm_move() for a transaction is done before m0_be_engine__tx_state_set(),
+ * so a transaction which is already ACTIVE for its user may be still posted to
+ * ACTIVE (M0_BTS_NR list). Transactions in the GROUPING list are not posted to
+ * ACTIVE while eng_evicting is set, see be_engine_got_tx_grouping().
+ */
+static bool be_engine_seg_is_quiescent(struct m0_be_engine *en)
+{
+	M0_PRE(be_engine_is_locked(en));
+
+	return etx_tlist_is_empty(&en->eng_txs[M0_BTS_ACTIVE]) &&
+		!m0_tl_exists(etx, tx, &en->eng_txs[M0_BTS_NR],
+			      M0_BTS_OPENING <= m0_be_tx_state(tx) &&
+			      m0_be_tx_state(tx) <= M0_BTS_ACTIVE);
+}
+
+static void be_engine_seg_evict_timer_cb(struct m0_sm_timer *timer);
+
+static void be_engine_seg_evict_timer_arm(struct m0_be_engine *en,
+					  m0_time_t            deadline)
+{
+	struct m0_sm_timer *timer = &en->eng_evict_timer;
+	int                 rc;
+
+	m0_sm_timer_fini(timer);
+	m0_sm_timer_init(timer);
+	rc = m0_sm_timer_start(timer,
+			       m0_be_tx_group__sm_group(&en->eng_group[0]),
+			       &be_engine_seg_evict_timer_cb, deadline);
+	M0_ASSERT_INFO(rc == 0, "rc = %d", rc);
+}
+
+/**
+ * Evicts pages of the paged segments.
+ *
+ * Runs in the sm group of the first tx group (eng_evict_ast or
+ * eng_evict_timer), so madvise() calls are not made in the context of the
+ * transaction which is closed or placed.
+ *
+ * eng_evicting is set first: new transactions stay in the GROUPING state and
+ * the active ones are given BE_ENGINE_SEG_EVICT_DRAIN to close. The check is
+ * repeated by eng_evict_timer. If the transactions are not closed in time,
+ * they are let go and the eviction is retried later, so a busy engine is not
+ * stalled. The engine lock is not held during eviction.
+ */
+static void be_engine_seg_evict_try(struct m0_be_engine *en)
+{
+	m0_time_t now = m0_time_now();
+
+	be_engine_lock(en);
+	M0_ASSERT(en->eng_evict_posted);
+	if (!en->eng_evicting) {
+		en->eng_evicting    = true;
+		en->eng_evict_gated = now;
+	}
+	if (!be_engine_seg_is_quiescent(en)) {
+		if (now < en->eng_evict_gated + BE_ENGINE_SEG_EVICT_DRAIN) {
+			be_engine_seg_evict_timer_arm(en,
+					now + BE_ENGINE_SEG_EVICT_RETRY);
+		} else {
+			en->eng_evicting = false;
+			be_engine_got_tx_grouping(en);
+			be_engine_seg_evict_timer_arm(en,
+					now + BE_ENGINE_SEG_EVICT_INTERVAL);
+		}
+		be_engine_unlock(en);
+		M0_LOG(M0_DEBUG, "en=%p not quiescent", en);
+		return;
+	}
+	be_engine_unlock(en);
+
+	m0_be_domain__seg_evict(en->eng_domain);
+
+	be_engine_lock(en);
+	en->eng_evicting = false;
+	en->eng_evict_posted = false;
+	en->eng_evict_next = m0_time_now() + BE_ENGINE_SEG_EVICT_INTERVAL;
+	be_engine_got_tx_grouping(en);
+	be_engine_unlock(en);
+}
+
+static void be_engine_seg_evict_ast(struct m0_sm_group *sm_grp,
+				    struct m0_sm_ast   *ast)
+{
+	struct m0_be_engine *en = M0_AMB(en, ast, eng_evict_ast);
+
+	M0_ENTRY("en=%p sm_grp=%p", en, sm_grp);
+	be_engine_seg_evict_try(en);
+	M0_LEAVE();
+}
+
+static void be_engine_seg_evict_timer_cb(struct m0_sm_timer *timer)
+{
+	struct m0_be_engine *en = M0_AMB(en, timer, eng_evict_timer);
+
+	M0_ENTRY("en=%p", en);
+	be_engine_seg_evict_try(en);
+	M0_LEAVE();
+}
+
+/**
+ * Schedules eviction of the paged segments. At most one eviction is pending
+ * and evictions are made not more often than BE_ENGINE_SEG_EVICT_INTERVAL.
+ */
+static void be_engine_seg_evict_post(struct m0_be_engine *en)
+{
+	M0_PRE(be_engine_is_locked(en));
+
+	if (en->eng_domain != NULL &&
+	    en->eng_domain->bd_cfg.bc_seg_paging.bspc_budget != 0 &&
+	    !en->eng_evict_posted &&
+	    m0_time_now() >= en->eng_evict_next) {
+		en->eng_evict_posted = true;
+		en->eng_evict_ast.sa_cb = &be_engine_seg_evict_ast;
+		m0_sm_ast_post(m0_be_tx_group__sm_group(&en->eng_group[0]),
+			       &en->eng_evict_ast);
+	}
+}
+
 M0_INTERNAL bool m0_be_engine__invariant(struct m0_be_engine *en)
 {
 	bool rc_bool;
@@ -676,6 +824,8 @@ M0_INTERNAL void m0_be_engine__tx_state_set(struct m0_be_engine *en,
 	default:
 		break;
 	}
+	if (M0_IN(state, (M0_BTS_CLOSED, M0_BTS_PLACED)))
+		be_engine_seg_evict_post(en);
 
 	M0_POST(be_engine_invariant(en));
 	be_engine_unlock(en);
@@ -846,7 +996,19 @@ M0_INTERNAL int m0_be_engine_start(struct m0_be_engine *en)
 
 M0_INTERNAL void m0_be_engine_stop(struct m0_be_engine *en)
 {
+	struct m0_sm_group *sm_grp = m0_be_tx_group__sm_group(&en->eng_group[0]);
+
 	M0_ENTRY();
+	/*
+	 * There are no transactions, so eng_evict_ast can't be posted again.
+	 * The ast and the timer are executed under the sm group lock, which is
+	 * taken before the engine lock.
+	 */
+	m0_sm_group_lock(sm_grp);
+	m0_sm_ast_cancel(sm_grp, &en->eng_evict_ast);
+	if (m0_sm_timer_is_armed(&en->eng_evict_timer))
+		m0_sm_timer_cancel(&en->eng_evict_timer);
+	m0_sm_group_unlock(sm_grp);
 	be_engine_lock(en);
 	M0_PRE(be_engine_invariant(en));
 
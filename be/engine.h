@@ -30,6 +30,7 @@
 #include "lib/mutex.h"          /* m0_mutex */
 #include "lib/tlist.h"          /* m0_tl */
 #include "lib/semaphore.h"      /* m0_semaphore */
+#include "lib/time.h"           /* m0_time_t */
 
 #include "be/log.h"             /* m0_be_log */
 #include "be/tx.h"              /* m0_be_tx */
@@ -118,6 +119,27 @@ struct m0_be_engine {
 	struct m0_be_domain       *eng_domain;
 	struct m0_semaphore        eng_recovery_wait_sem;
 	bool                       eng_recovery_finished;
+	/**
+	 * Eviction of the paged segments, see be_engine_seg_evict_post().
+	 * eng_evict_ast is posted to the sm group of the first tx group.
+	 */
+	struct m0_sm_ast           eng_evict_ast;
+	/**
+	 * Eviction is pending: eng_evict_ast is posted or eng_evict_timer is
+	 * armed to run it again.
+	 */
+	bool                       eng_evict_posted;
+	/** Re-runs the eviction, see be_engine_seg_evict_try(). */
+	struct m0_sm_timer         eng_evict_timer;
+	/**
+	 * Eviction waits for active transactions to close or runs, new
+	 * transactions are not moved to ACTIVE.
+	 */
+	bool                       eng_evicting;
+	/** When eng_evicting was set. */
+	m0_time_t                  eng_evict_gated;
+	/** The next eviction is not started before this time. */
+	m0_time_t                  eng_evict_next;
 };
 
 M0_INTERNAL bool m0_be_engine__invariant(struct m0_be_engine *en);
@@ -257,6 +257,8 @@ static void delete_wrapper(struct m0_be_btree *btree, struct m0_be_tx *tx,
 M0_INTERNAL void
 m0_be_emap_init(struct m0_be_emap *map, struct m0_be_seg *db)
 {
+	/* Lock and cursor buffers are volatile, see m0_be_btree_init(). */
+	m0_be_seg_pin(db, map, sizeof *map);
 	m0_format_header_pack(&map->em_header, &(struct m0_format_tag){
 		.ot_version = M0_BE_EMAP_FORMAT_VERSION,
 		.ot_type    = M0_FORMAT_TYPE_BE_EMAP,
@@ -278,6 +280,7 @@ M0_INTERNAL void m0_be_emap_fini(struct m0_be_emap *map)
 	map->em_version = 0;
 	m0_be_btree_fini(&map->em_mapping);
 	m0_rwlock_fini(emap_rwlock(map));
+	m0_be_seg_unpin(map->em_seg, map, sizeof *map);
 }
 
 M0_INTERNAL void m0_be_emap_create(struct m0_be_emap   *map,
@@ -45,13 +45,18 @@
  *   at least as requested.
  *
  * Algorithm.
- * - size range [0, M0_BCOUNT_MAX] is divided into subranges;
+ * - size range [0, M0_BCOUNT_MAX] is divided into subranges: M0_BE_FL_NR
+ *   subranges of M0_BE_FL_STEP bytes each, followed by M0_BE_FL_LOG_NR
+ *   subranges [2^n, 2^(n+1)) * M0_BE_FL_NR * M0_BE_FL_STEP;
  * - for each subrange doubly-linked LRU list is maintained;
  * - pick() implementation
  *   - find what range the requested size is in, select corresponding list;
  *   - if size is in [0, M0_BE_FL_NR * M0_BE_FL_STEP) then select first chunk
  *     from the list;
- *   - otherwise scan the list to find first suitable chunk.
+ *   - otherwise scan the list to find the best fit among first
+ *     M0_BE_FL_PICK_SCAN_LIMIT chunks;
+ *   - if there is no suitable chunk in the list then select first chunk
+ *     from the next non-empty list. Any chunk from it is large enough.
  *
  * Time and I/O complexity.
  * - m0_be_fl_add() and m0_be_fl_del() have O(1) time and I/O complexity;
@@ -59,8 +64,10 @@
  *   - for size requested < (M0_BE_FL_NR * M0_BE_FL_STEP) time and I/O
  *     complexity is O(1);
  *   - for size requested >= (M0_BE_FL_NR * M0_BE_FL_STEP) time and I/O
- *     complexity is O(N), where N is total number of free chunks with
- *     size from this range.
+ *     complexity is O(M0_BE_FL_PICK_SCAN_LIMIT) in the common case. It is
+ *     O(N) only when the list of the requested size range has no suitable
+ *     chunks among first M0_BE_FL_PICK_SCAN_LIMIT ones and all lists of
+ *     larger sizes are empty, where N is the number of chunks in the list.
  *
  * Locks
  * m0_be_fl doesn't have any locks. User has to provide concurrency protection.
@@ -73,13 +80,9 @@
  *
  * Known issues.
  * - m0_be_fl doesn't have true O(1) time and I/O complexity for size range
- *   [0, M0_BCOUNT_MAX].
+ *   [0, M0_BCOUNT_MAX], see above.
  *
  * Future improvement directions.
- * - It is possible to get O(1) time complexity for any size. To do this
- *   m0_be_fl needs to have m0_be_fl_size for size range [2^n, 2^(n+1) - 1] for
- *   sizes >= (M0_BE_FL_NR * M0_BE_FL_STEP).
- *   the future.
  * - It is possible to use memory-only LRU cache for chunks. It can help with
  *   large amount of alocations/deallocations.
  * - The current implementation of m0_be_fl_pick() doesn't take allocation
@@ -125,19 +128,27 @@ M0_INTERNAL void m0_be_fl_destroy(struct m0_be_fl *fl, struct m0_be_tx *tx)
 		fl_be_list_destroy(be_fl_list(fl, i), tx);
 }
 
+static unsigned long be_fl_index_round_down(struct m0_be_fl *fl,
+                                            m0_bcount_t      size)
+{
+	if (size < M0_BE_FL_NR * M0_BE_FL_STEP)
+		return size / M0_BE_FL_STEP;
+	return M0_BE_FL_NR +
+	       min_type(unsigned long, M0_BE_FL_LOG_NR - 1,
+			m0_log2(size / (M0_BE_FL_NR * M0_BE_FL_STEP)));
+}
+
 static unsigned long be_fl_index_round_up(struct m0_be_fl *fl,
                                           m0_bcount_t      size)
 {
-	return min_type(unsigned long, M0_BE_FL_NR,
-			m0_align(size, M0_BE_FL_STEP) / M0_BE_FL_STEP);
+	return be_fl_index_round_down(fl, m0_align(size, M0_BE_FL_STEP));
 }
 
 static unsigned long
 be_fl_index_round_down_chunk(struct m0_be_fl             *fl,
                              const struct be_alloc_chunk *chunk)
 {
-	return min_type(unsigned long, M0_BE_FL_NR,
-			chunk->bac_size / M0_BE_FL_STEP);
+	return be_fl_index_round_down(fl, chunk->bac_size);
 }
 
 M0_INTERNAL bool m0_be_fl__invariant(struct m0_be_fl *fl)
@@ -178,26 +189,18 @@ M0_INTERNAL void m0_be_fl_del(struct m0_be_fl       *fl,
 M0_INTERNAL struct be_alloc_chunk *m0_be_fl_pick(struct m0_be_fl *fl,
 						 m0_bcount_t      size)
 {
-	struct be_alloc_chunk *chunk;
+	struct be_alloc_chunk *chunk = NULL;
 	struct be_alloc_chunk *iter;
 	unsigned long          index;
-	struct m0_be_list     *flist;
 	int                    i = 0;
 
 	M0_PRE_EX(m0_be_fl__invariant(fl));
 
-	for (index = be_fl_index_round_up(fl, size);
-	     index < ARRAY_SIZE(fl->bfl_free); ++index) {
-		if (!be_fl_list_is_empty(fl, index))
-			break;
-	}
-
-	flist = index < ARRAY_SIZE(fl->bfl_free) ? be_fl_list(fl, index) : NULL;
-	chunk = flist == NULL ? NULL : fl_be_list_head(flist);
-	if (index == M0_BE_FL_NR && chunk != NULL) {
-		chunk = NULL;
-		m0_be_list_for(fl, flist, iter) {
-			if (iter->bac_size > size &&
+	index = be_fl_index_round_up(fl, size);
+	if (index >= M0_BE_FL_NR) {
+		/* chunks in this list may be smaller than requested */
+		m0_be_list_for(fl, be_fl_list(fl, index), iter) {
+			if (iter->bac_size >= size &&
 			    ergo(chunk != NULL,
 				 chunk->bac_size > iter->bac_size)) {
 				chunk = iter;
@@ -206,6 +209,12 @@ M0_INTERNAL struct be_alloc_chunk *m0_be_fl_pick(struct m0_be_fl *fl,
 			if (i >= M0_BE_FL_PICK_SCAN_LIMIT && chunk != NULL)
 				break;
 		} m0_be_list_endfor;
+		++index;
+	}
+	/* any chunk from the rest of the lists is large enough */
+	for (; chunk == NULL && index < ARRAY_SIZE(fl->bfl_free); ++index) {
+		if (!be_fl_list_is_empty(fl, index))
+			chunk = fl_be_list_head(be_fl_list(fl, index));
 	}
 
 	M0_LOG(M0_DEBUG, "chunk=%p size=%" PRIu64 " bac_size=%" PRIu64 " "
@@ -39,6 +39,13 @@ struct be_alloc_chunk;
 enum {
 	M0_BE_FL_STEP = 8,      /**< each size is aligned on this boundary */
 	M0_BE_FL_NR = 128,      /**< number of free lists */
+	/**
+	 * Number of free lists for chunks with size >=
+	 * M0_BE_FL_NR * M0_BE_FL_STEP. i-th of them contains chunks with size
+	 * in range [2^i, 2^(i+1)) * M0_BE_FL_NR * M0_BE_FL_STEP, the last one
+	 * contains all larger chunks.
+	 */
+	M0_BE_FL_LOG_NR = 40,
 	M0_BE_FL_PICK_SCAN_LIMIT = 0x10, /**< scan limit for best-fit search
 					      for chunks with size >=
 					      M0_BE_FL_NR * M0_BE_FL_STEP */
@@ -69,11 +76,12 @@ struct m0_be_fl {
 	 * If i is from range [0,  M0_BE_FL_NR) then i-th element of array
 	 * contains free list with chunk sizes in range
 	 * [i * M0_BE_FL_STEP, (i + 1) * M0_BE_FL_STEP).
-	 * M0_BE_FL_NR-th element contains list of chunks
-	 * with size >= (M0_BE_FL_NR * M0_BE_FL_STEP).
+	 * (M0_BE_FL_NR + j)-th element contains list of chunks with size in
+	 * range [2^j, 2^(j+1)) * (M0_BE_FL_NR * M0_BE_FL_STEP), except the
+	 * last one, which contains all chunks that don't fit in other lists.
 	 * @see m0_be_fl_add(), m0_be_fl_pick().
 	 */
-	struct m0_be_fl_size bfl_free[M0_BE_FL_NR + 1];
+	struct m0_be_fl_size bfl_free[M0_BE_FL_NR + M0_BE_FL_LOG_NR];
 } M0_XCA_RECORD M0_XCA_DOMAIN(be);
 
 M0_INTERNAL bool m0_be_fl__invariant(struct m0_be_fl *fl);
@@ -147,6 +147,18 @@ M0_INTERNAL bool m0_be_seg_contains(const struct m0_be_seg *seg,
 	return true;
 }
 
+M0_INTERNAL void m0_be_seg_pin(struct m0_be_seg *seg,
+			       const void       *addr,
+			       m0_bcount_t       size)
+{
+}
+
+M0_INTERNAL void m0_be_seg_unpin(struct m0_be_seg *seg,
+				 const void       *addr,
+				 m0_bcount_t       size)
+{
+}
+
 M0_INTERNAL void m0_be_tx_init(struct m0_be_tx     *tx,
 			       uint64_t             tid,
 			       struct m0_be_domain *dom,
@@ -30,6 +30,7 @@
 #include "lib/errno.h"        /* ENOMEM */
 #include "lib/time.h"         /* m0_time_now */
 #include "lib/atomic.h"       /* m0_atomic64 */
+#include "lib/arith.h"        /* min64u */
 
 #include "motr/version.h"     /* m0_build_info_get */
 
@@ -326,6 +327,7 @@ M0_INTERNAL int m0_be_seg_open(struct m0_be_seg *seg)
 	const struct m0_be_seg_geom *g;
 	struct m0_be_seg_hdr        *hdr;
 	const char                  *runtime_be_version;
+	struct m0_format_tag         tag;
 	void                        *p;
 	int                          fd;
 	int                          rc;
@@ -355,6 +357,16 @@ M0_INTERNAL int m0_be_seg_open(struct m0_be_seg *seg)
 		return rc;
 	}
 
+	m0_format_header_unpack(&tag, &hdr->bh_header);
+	if (tag.ot_version != M0_BE_SEG_HDR_FORMAT_VERSION) {
+		rc = M0_ERR_INFO(-EPROTO, "Segment header format version "
+				 "mismatch: expected %d, stored on disk %d",
+				 M0_BE_SEG_HDR_FORMAT_VERSION,
+				 (int)tag.ot_version);
+		m0_free(hdr);
+		return rc;
+	}
+
 	g = be_seg_geom_find_by_id(hdr, seg->bs_id);
 	if (g == NULL) {
 		m0_free(hdr);
@@ -396,6 +408,8 @@ M0_INTERNAL void m0_be_seg_close(struct m0_be_seg *seg)
 	M0_ENTRY("seg=%p", seg);
 	M0_PRE(seg->bs_state == M0_BSS_OPENED);
 
+	if (m0_be_seg_is_paged(seg))
+		m0_be_seg_paging_disable(seg);
 	munmap(seg->bs_addr, seg->bs_size);
 	seg->bs_state = M0_BSS_CLOSED;
 	M0_LEAVE();
@@ -487,6 +501,169 @@ M0_INTERNAL bool m0_be_seg_contains_stob(struct m0_be_seg        *seg,
 	return m0_stob_id_eq(m0_stob_id_get(seg->bs_stob), stob_id);
 }
 
+M0_INTERNAL int m0_be_seg_paging_enable(struct m0_be_seg                  *seg,
+					const struct m0_be_seg_paging_cfg *cfg)
+{
+	unsigned shift = cfg->bspc_shift ?: M0_BE_SEG_PG_SHIFT_DEFAULT;
+
+	M0_ENTRY("seg=%p budget=%"PRIu64" shift=%u",
+		 seg, cfg->bspc_budget, shift);
+	M0_PRE(seg->bs_state == M0_BSS_OPENED);
+	M0_PRE(!m0_be_seg_is_paged(seg));
+	M0_PRE(M0_BE_SEG_PAGE_SIZE <= 1ULL << shift && shift < 64);
+
+	if (cfg->bspc_budget == 0)
+		return M0_RC(0);
+
+	seg->bs_pg_shift  = shift;
+	seg->bs_pg_nr     = (seg->bs_size + (1ULL << shift) - 1) >> shift;
+	seg->bs_pg_budget = max64u(cfg->bspc_budget >> shift, 1);
+	seg->bs_pg_hand   = 0;
+	seg->bs_pg_evicted = 0;
+	m0_atomic64_set(&seg->bs_pg_resident, 0);
+	M0_ALLOC_ARR(seg->bs_pg_map, seg->bs_pg_nr);
+	return seg->bs_pg_map == NULL ? M0_ERR(-ENOMEM) : M0_RC(0);
+}
+
+M0_INTERNAL void m0_be_seg_paging_disable(struct m0_be_seg *seg)
+{
+	M0_ENTRY("seg=%p evicted=%"PRIu64, seg, seg->bs_pg_evicted);
+	M0_PRE(m0_be_seg_is_paged(seg));
+	m0_free0(&seg->bs_pg_map);
+	seg->bs_pg_nr = 0;
+	M0_LEAVE();
+}
+
+M0_INTERNAL bool m0_be_seg_is_paged(const struct m0_be_seg *seg)
+{
+	return seg->bs_pg_map != NULL;
+}
+
+static uint64_t be_seg_pg(const struct m0_be_seg *seg, const void *addr)
+{
+	return (addr - seg->bs_addr) >> seg->bs_pg_shift;
+}
+
+static void be_seg_pg_pin(struct m0_be_seg *seg, uint64_t pg)
+{
+	struct m0_atomic64 *state = &seg->bs_pg_map[pg];
+	int64_t             old;
+	int64_t             new;
+
+	while (true) {
+		old = m0_atomic64_get(state);
+		/* Wait until the page is dropped by m0_be_seg_evict(). */
+		if ((old & M0_BE_SEG_PG_EVICTING) != 0) {
+			m0_mb();
+			continue;
+		}
+		M0_ASSERT((old & M0_BE_SEG_PG_PIN_CNT_MASK) !=
+			  M0_BE_SEG_PG_PIN_CNT_MASK);
+		new = (old | M0_BE_SEG_PG_PRESENT | M0_BE_SEG_PG_REFERENCED) + 1;
+		if (m0_atomic64_cas(&state->a_value, old, new))
+			break;
+	}
+	if ((old & M0_BE_SEG_PG_PRESENT) == 0)
+		m0_atomic64_inc(&seg->bs_pg_resident);
+}
+
+static void be_seg_pg_unpin(struct m0_be_seg *seg, uint64_t pg)
+{
+	M0_ASSERT((m0_atomic64_get(&seg->bs_pg_map[pg]) &
+		   M0_BE_SEG_PG_PIN_CNT_MASK) > 0);
+	m0_atomic64_dec(&seg->bs_pg_map[pg]);
+}
+
+M0_INTERNAL void m0_be_seg_pin(struct m0_be_seg *seg,
+			       const void       *addr,
+			       m0_bcount_t       size)
+{
+	uint64_t pg;
+
+	if (!m0_be_seg_is_paged(seg) || size == 0 ||
+	    !m0_be_seg_contains(seg, addr))
+		return;
+	M0_PRE(m0_be_seg_contains(seg, addr + size - 1));
+
+	for (pg = be_seg_pg(seg, addr);
+	     pg <= be_seg_pg(seg, addr + size - 1); ++pg)
+		be_seg_pg_pin(seg, pg);
+}
+
+M0_INTERNAL void m0_be_seg_unpin(struct m0_be_seg *seg,
+				 const void       *addr,
+				 m0_bcount_t       size)
+{
+	uint64_t pg;
+
+	if (!m0_be_seg_is_paged(seg) || size == 0 ||
+	    !m0_be_seg_contains(seg, addr))
+		return;
+	M0_PRE(m0_be_seg_contains(seg, addr + size - 1));
+
+	for (pg = be_seg_pg(seg, addr);
+	     pg <= be_seg_pg(seg, addr + size - 1); ++pg)
+		be_seg_pg_unpin(seg, pg);
+}
+
+/**
+ * Drops private copy of the page. The page is re-read from the segment stob
+ * on the next access, because the segment is mapped MAP_PRIVATE.
+ */
+static bool be_seg_pg_evict(struct m0_be_seg *seg, uint64_t pg)
+{
+	struct m0_atomic64 *state = &seg->bs_pg_map[pg];
+	void               *addr;
+	m0_bcount_t         size;
+	int                 rc;
+
+	if (!m0_atomic64_cas(&state->a_value, M0_BE_SEG_PG_PRESENT,
+			     M0_BE_SEG_PG_PRESENT | M0_BE_SEG_PG_EVICTING))
+		return false;
+	addr = seg->bs_addr + (pg << seg->bs_pg_shift);
+	size = min64u(1ULL << seg->bs_pg_shift,
+		      seg->bs_addr + seg->bs_size - addr);
+	rc = madvise(addr, size, MADV_DONTNEED);
+	if (rc != 0) {
+		M0_LOG(M0_ERROR, "madvise(%p, %"PRIu64", MADV_DONTNEED) "
+		       "errno=%d", addr, size, errno);
+		m0_atomic64_set(state, M0_BE_SEG_PG_PRESENT);
+		return false;
+	}
+	m0_atomic64_set(state, 0);
+	m0_atomic64_dec(&seg->bs_pg_resident);
+	return true;
+}
+
+M0_INTERNAL uint64_t m0_be_seg_evict(struct m0_be_seg *seg)
+{
+	struct m0_atomic64 *state;
+	uint64_t            evicted = 0;
+	uint64_t            i;
+	int64_t             old;
+
+	if (!m0_be_seg_is_paged(seg))
+		return 0;
+
+	for (i = 0; i < M0_BE_SEG_PG_EVICT_SCAN &&
+	     m0_atomic64_get(&seg->bs_pg_resident) > seg->bs_pg_budget; ++i) {
+		state = &seg->bs_pg_map[seg->bs_pg_hand];
+		old   = m0_atomic64_get(state);
+		/* Second chance for recently pinned pages. */
+		if ((old & M0_BE_SEG_PG_REFERENCED) != 0)
+			m0_atomic64_cas(&state->a_value, old,
+					old & ~M0_BE_SEG_PG_REFERENCED);
+		else if (old == M0_BE_SEG_PG_PRESENT)
+			evicted += be_seg_pg_evict(seg, seg->bs_pg_hand);
+		seg->bs_pg_hand = (seg->bs_pg_hand + 1) % seg->bs_pg_nr;
+	}
+	seg->bs_pg_evicted += evicted;
+	if (evicted > 0)
+		M0_LOG(M0_DEBUG, "seg=%p evicted=%"PRIu64" resident=%"PRIu64,
+		       seg, evicted, m0_atomic64_get(&seg->bs_pg_resident));
+	return evicted;
+}
+
 /** @} end of be group */
 #undef M0_TRACE_SUBSYSTEM
 
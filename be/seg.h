@@ -29,6 +29,7 @@
 
 #include "lib/tlist.h"          /* m0_tlink */
 #include "lib/types.h"          /* m0_bcount_t */
+#include "lib/atomic.h"         /* m0_atomic64 */
 
 struct m0_be_op;
 struct m0_be_reg_d;
@@ -58,10 +59,45 @@ enum {
 	M0_BE_SEG_FAKE_ID = ~0,
 	/** Segments' addr, size, offset has to be aligned by this boundary */
 	M0_BE_SEG_PAGE_SIZE = 1ULL << 12,
+	/** Default paging unit of a paged segment, log2 of bytes. */
+	M0_BE_SEG_PG_SHIFT_DEFAULT = 21,
+	/** Maximum number of pages examined by m0_be_seg_evict() at once. */
+	M0_BE_SEG_PG_EVICT_SCAN = 1024,
 };
 
+/*
+ * State of a page of a paged segment, see m0_be_seg::bs_pg_map.
+ *
+ * PRESENT: the page has a private in-memory copy, which was made by
+ *          modifications of the segment memory.
+ * REFERENCED: the page was pinned since the last pass of the eviction clock.
+ * EVICTING: in-memory copy of the page is being dropped, pins wait for it.
+ * PIN_CNT: number of pins, the page can't be evicted while it is pinned.
+ */
 #define M0_BE_SEG_PG_PRESENT       0x8000000000000000ULL
-#define M0_BE_SEG_PG_PIN_CNT_MASK  (~M0_BE_SEG_PG_PRESENT)
+#define M0_BE_SEG_PG_REFERENCED    0x4000000000000000ULL
+#define M0_BE_SEG_PG_EVICTING      0x2000000000000000ULL
+#define M0_BE_SEG_PG_PIN_CNT_MASK  (~(M0_BE_SEG_PG_PRESENT    | \
+				      M0_BE_SEG_PG_REFERENCED | \
+				      M0_BE_SEG_PG_EVICTING))
+
+/**
+ * Demand paging configuration of a segment.
+ *
+ * @see m0_be_seg_paging_enable()
+ */
+struct m0_be_seg_paging_cfg {
+	/**
+	 * Maximum size of the private (modified) pages of the segment which
+	 * are kept in memory. 0 disables paging.
+	 */
+	m0_bcount_t bspc_budget;
+	/**
+	 * log2 of the paging unit. It should be at least log2 of
+	 * M0_BE_SEG_PAGE_SIZE. 0 means M0_BE_SEG_PG_SHIFT_DEFAULT.
+	 */
+	unsigned    bspc_shift;
+};
 
 struct m0_be_seg {
 	uint64_t               bs_id;
@@ -83,6 +119,21 @@ struct m0_be_seg {
 	int                    bs_state;
 	uint64_t               bs_magic;
 	struct m0_tlink        bs_linkage;
+	/**
+	 * Page map of a paged segment: one M0_BE_SEG_PG_* state word for each
+	 * 1 << bs_pg_shift bytes of the segment. NULL if paging is disabled.
+	 */
+	struct m0_atomic64    *bs_pg_map;
+	uint64_t               bs_pg_nr;
+	unsigned               bs_pg_shift;
+	/** Maximum number of pages with M0_BE_SEG_PG_PRESENT set. */
+	uint64_t               bs_pg_budget;
+	/** Number of pages with M0_BE_SEG_PG_PRESENT set. */
+	struct m0_atomic64     bs_pg_resident;
+	/** Clock hand of the eviction, protected by the caller. */
+	uint64_t               bs_pg_hand;
+	/** Number of pages evicted since paging was enabled. */
+	uint64_t               bs_pg_evicted;
 };
 
 /* helper for m0_be_seg__create_multiple() */
@@ -187,6 +238,73 @@ M0_INTERNAL unsigned long m0_be_reg_gen_idx(const struct m0_be_reg *reg);
 M0_INTERNAL bool m0_be_seg_contains_stob(struct m0_be_seg        *seg,
                                          const struct m0_stob_id *stob_id);
 
+/**
+ * @defgroup be-seg-paging Demand paged segments
+ *
+ * The segment is always mapped MAP_PRIVATE from its stob, so the kernel reads
+ * pages in on the first access and can reclaim pages which were only read.
+ * Pages which were modified become private anonymous copies and stay in
+ * memory forever, which limits the amount of meta-data by the size of RAM.
+ *
+ * Paging tracks modified pages with page granularity (1 << bs_pg_shift bytes)
+ * and drops the private copies of the pages, whose modifications are already
+ * placed to the segment stob, when their number exceeds the budget. The next
+ * access reads the page from the stob again.
+ *
+ * A page is pinned while it has modifications which are not placed yet:
+ * - m0_be_tx pins each region in m0_be_tx_capture() and unpins it when the
+ *   transaction is placed;
+ * - recovering tx group pins the regions it re-applies until it is reset;
+ * - objects which keep volatile (not captured) state inside the segment
+ *   (locks, pointers to volatile objects, etc.) pin themselves for their
+ *   lifetime, see m0_be_btree_init() for example.
+ *
+ * Modifications are made before the capture, so m0_be_seg_evict() should be
+ * called only when no transaction is ACTIVE. Transactions in the other states
+ * may be in flight. BE engine schedules an eviction ast when a transaction is
+ * closed or placed. The ast keeps new transactions from becoming active, waits
+ * a bit for the active ones to close and re-arms itself on a timer if they
+ * don't.
+ *
+ * @{
+ */
+
+/**
+ * Enables demand paging of an open segment.
+ *
+ * Does nothing if cfg->bspc_budget is 0.
+ */
+M0_INTERNAL int m0_be_seg_paging_enable(struct m0_be_seg                  *seg,
+					const struct m0_be_seg_paging_cfg *cfg);
+/** Disables demand paging. Segment memory stays as it is. */
+M0_INTERNAL void m0_be_seg_paging_disable(struct m0_be_seg *seg);
+M0_INTERNAL bool m0_be_seg_is_paged(const struct m0_be_seg *seg);
+
+/**
+ * Pins pages of the segment which intersect with [addr, addr + size).
+ *
+ * Does nothing if the segment is not paged or @addr is not in the segment.
+ */
+M0_INTERNAL void m0_be_seg_pin(struct m0_be_seg *seg,
+			       const void       *addr,
+			       m0_bcount_t       size);
+/** Reverts m0_be_seg_pin() with the same arguments. */
+M0_INTERNAL void m0_be_seg_unpin(struct m0_be_seg *seg,
+				 const void       *addr,
+				 m0_bcount_t       size);
+
+/**
+ * Drops in-memory copies of unpinned pages while the number of resident pages
+ * exceeds the budget. At most M0_BE_SEG_PG_EVICT_SCAN pages are examined.
+ *
+ * Calls of this function for the same segment should be serialised.
+ *
+ * @return number of evicted pages.
+ */
+M0_INTERNAL uint64_t m0_be_seg_evict(struct m0_be_seg *seg);
+
+/** @} end of be-seg-paging group */
+
 /** @} end of be group */
 #endif /* __MOTR_BE_SEG_H__ */
 
@@ -55,17 +55,24 @@ struct m0_be_seg_hdr {
 	struct m0_format_footer       bh_footer;
 	struct m0_be_allocator_header bh_alloc[M0_BAP_NR];
 	struct m0_be_list             bh_dict;
+	/**
+	 * Allocator arena headers. Arena space is a part of M0_BAP_NORMAL
+	 * zone, bah_size is 0 for an arena without space.
+	 * @see m0_be_allocator::ba_arena_lock.
+	 */
+	struct m0_be_allocator_header bh_arena[M0_BE_ALLOC_ARENA_NR];
 } M0_XCA_RECORD M0_XCA_DOMAIN(be);
 
 enum m0_be_seg_hdr_format_version {
 	M0_BE_SEG_HDR_FORMAT_VERSION_1 = 1,
+	/** Allocator arenas (bh_arena) and log2 free lists. */
+	M0_BE_SEG_HDR_FORMAT_VERSION_2,
 
 	/* future versions, uncomment and update M0_BE_SEG_HDR_FORMAT_VERSION */
-	/*M0_BE_SEG_HDR_FORMAT_VERSION_2,*/
 	/*M0_BE_SEG_HDR_FORMAT_VERSION_3,*/
 
 	/** Current version, should point to the latest version present */
-	M0_BE_SEG_HDR_FORMAT_VERSION = M0_BE_SEG_HDR_FORMAT_VERSION_1
+	M0_BE_SEG_HDR_FORMAT_VERSION = M0_BE_SEG_HDR_FORMAT_VERSION_2
 };
 
 /** @} end of be group */
@@ -40,6 +40,7 @@
 #include "be/engine.h"          /* m0_be_engine__tx_state_set */
 #include "be/addb2.h"           /* M0_AVI_BE_TX_STATE, M0_AVI_BE_TX_COUNTER */
 #include "be/fmt.h"             /* m0_be_fmt_tx */
+#include "be/seg.h"             /* m0_be_seg_pin */
 
 /**
  * @addtogroup be
@@ -255,6 +256,8 @@ M0_INTERNAL void m0_be_tx_fini(struct m0_be_tx *tx)
 	m0_sm_fini(&tx->t_sm);
 	m0_be_reg_area_fini(&tx->t_reg_area);
 	m0_free(tx->t_payload.b_addr);
+	M0_ASSERT(tx->t_pinned_nr == 0);
+	m0_free(tx->t_pinned);
 }
 
 M0_INTERNAL void m0_be_tx_prep(struct m0_be_tx              *tx,
@@ -318,6 +321,15 @@ M0_INTERNAL void m0_be_tx_capture(struct m0_be_tx        *tx,
 
 	be_tx_make_reg_d(tx, &rd, reg);
 	rd.rd_gen_idx = m0_be_reg_gen_idx(reg);
+	/*
+	 * The region can't be evicted from now on: its modifications are in
+	 * the reg area, but not in the segment stob yet.
+	 */
+	if (tx->t_pinned != NULL && m0_be_seg_is_paged(reg->br_seg)) {
+		M0_ASSERT(tx->t_pinned_nr < tx->t_prepared.tc_reg_nr);
+		m0_be_seg_pin(reg->br_seg, reg->br_addr, reg->br_size);
+		tx->t_pinned[tx->t_pinned_nr++] = *reg;
+	}
 	m0_be_reg_area_capture(&tx->t_reg_area, &rd);
 }
 
@@ -439,15 +451,33 @@ static void be_tx_state_move_ast(struct m0_be_tx *tx, enum m0_be_tx_state state)
 	}
 }
 
+static void be_tx_unpin(struct m0_be_tx *tx)
+{
+	struct m0_be_reg *reg;
+
+	for (; tx->t_pinned_nr > 0; --tx->t_pinned_nr) {
+		reg = &tx->t_pinned[tx->t_pinned_nr - 1];
+		m0_be_seg_unpin(reg->br_seg, reg->br_addr, reg->br_size);
+	}
+}
+
 static int be_tx_memory_allocate(struct m0_be_tx *tx)
 {
-	int rc;
+	struct m0_be_domain *dom = tx->t_engine->eng_domain;
+	int                  rc;
 
+	if (dom != NULL && dom->bd_cfg.bc_seg_paging.bspc_budget != 0 &&
+	    tx->t_prepared.tc_reg_nr != 0) {
+		M0_ALLOC_ARR(tx->t_pinned, tx->t_prepared.tc_reg_nr);
+		if (tx->t_pinned == NULL)
+			return M0_ERR(-ENOMEM);
+	}
 	tx->t_payload.b_nob = tx->t_payload_prepared;
 	if (tx->t_payload_prepared > 0)
 		tx->t_payload.b_addr = m0_alloc_nz(tx->t_payload.b_nob);
 	if (tx->t_payload.b_addr == NULL && tx->t_payload.b_nob != 0) {
 		rc = -ENOMEM;
+		m0_free0(&tx->t_pinned);
 		M0_LOG(M0_ERROR, "tx=%p t_payload_prepared=%" PRIu64 " rc=%d",
 		       tx, tx->t_payload_prepared, rc);
 	} else {
@@ -455,6 +485,7 @@ static int be_tx_memory_allocate(struct m0_be_tx *tx)
 					 M0_BE_REG_AREA_DATA_COPY);
 		if (rc != 0) {
 			m0_free0(&tx->t_payload.b_addr);
+			m0_free0(&tx->t_pinned);
 			M0_LOG(M0_ERROR, "tx=%p t_prepared="BETXCR_F" rc=%d",
 			       tx, BETXCR_P(&tx->t_prepared), rc);
 		}
@@ -506,6 +537,10 @@ static void be_tx_state_move(struct m0_be_tx     *tx,
 	if (state == M0_BTS_DONE && tx->t_discarded != NULL)
 		tx->t_discarded(tx);
 
+	/* Captured pages are pinned since m0_be_tx_capture(). */
+	if (state == M0_BTS_PLACED)
+		be_tx_unpin(tx);
+
 	m0_sm_move(&tx->t_sm, rc, state);
 	m0_be_engine__tx_state_set(tx->t_engine, tx, state);
 
@@ -363,6 +363,16 @@ struct m0_be_tx {
 	 */
 	struct m0_buf          t_payload;
 	m0_bcount_t            t_payload_prepared;
+	/**
+	 * Regions captured by the transaction, pinned by m0_be_tx_capture()
+	 * and unpinned when the transaction is placed. Allocated with
+	 * t_prepared.tc_reg_nr elements if segment paging is enabled in the
+	 * domain, NULL otherwise.
+	 *
+	 * @see m0_be_seg_pin()
+	 */
+	struct m0_be_reg      *t_pinned;
+	m0_bcount_t            t_pinned_nr;
 	struct m0_sm_ast       t_ast_grouping;
 	struct m0_sm_ast       t_ast_active;
 	struct m0_sm_ast       t_ast_failed;
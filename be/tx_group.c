@@ -182,6 +182,8 @@ M0_INTERNAL void m0_be_tx_group_reset(struct m0_be_tx_group *gr)
 	M0_PRE(gr->tg_nr_unclosed == 0);
 	M0_PRE(gr->tg_nr_unstable == 0);
 
+	if (gr->tg_recovering)
+		m0_be_reg_area_unpin(&gr->tg_reg_area);
 	M0_SET0(&gr->tg_used);
 	M0_SET0(&gr->tg_log_reserved);
 	gr->tg_payload_prepared = 0;
@@ -497,11 +499,13 @@ static void be_tx_group_reconstruct_reg_area(struct m0_be_tx_group *gr)
 		 * is added at the same address as previous is removed).
 		 */
 		if (seg != NULL) {
-			m0_be_reg_area_capture(&gr->tg_reg_area, &rd);
 			rd.rd_reg.br_seg = seg;
+			m0_be_reg_area_capture(&gr->tg_reg_area, &rd);
 			m0_be_group_format_reg_seg_add(&gr->tg_od, &rd);
 		}
 	}
+	/* Re-applied pages are unpinned in m0_be_tx_group_reset(). */
+	m0_be_reg_area_pin(&gr->tg_reg_area);
 }
 
 static struct be_recovering_tx *
@@ -810,6 +810,26 @@ M0_INTERNAL void m0_be_reg_area_optimize(struct m0_be_reg_area *ra)
 	/* to be implemented. */
 }
 
+M0_INTERNAL void m0_be_reg_area_pin(struct m0_be_reg_area *ra)
+{
+	struct m0_be_reg_d *rd;
+
+	M0_BE_REG_AREA_FORALL(ra, rd) {
+		m0_be_seg_pin(rd->rd_reg.br_seg,
+			      rd->rd_reg.br_addr, rd->rd_reg.br_size);
+	}
+}
+
+M0_INTERNAL void m0_be_reg_area_unpin(struct m0_be_reg_area *ra)
+{
+	struct m0_be_reg_d *rd;
+
+	M0_BE_REG_AREA_FORALL(ra, rd) {
+		m0_be_seg_unpin(rd->rd_reg.br_seg,
+				rd->rd_reg.br_addr, rd->rd_reg.br_size);
+	}
+}
+
 M0_INTERNAL struct m0_be_reg_d *
 m0_be_reg_area_first(struct m0_be_reg_area *ra)
 {
@@ -292,6 +292,15 @@ M0_INTERNAL void m0_be_reg_area_reset(struct m0_be_reg_area *ra);
  */
 M0_INTERNAL void m0_be_reg_area_optimize(struct m0_be_reg_area *ra);
 
+/**
+ * Pins segment pages of all regions in reg_area.
+ *
+ * reg_area shouldn't be changed until m0_be_reg_area_unpin().
+ * @see m0_be_seg_pin()
+ */
+M0_INTERNAL void m0_be_reg_area_pin(struct m0_be_reg_area *ra);
+M0_INTERNAL void m0_be_reg_area_unpin(struct m0_be_reg_area *ra);
+
 M0_INTERNAL struct m0_be_reg_d *m0_be_reg_area_first(struct m0_be_reg_area *ra);
 M0_INTERNAL struct m0_be_reg_d *
 m0_be_reg_area_next(struct m0_be_reg_area *ra, struct m0_be_reg_d *prev);
@@ -36,6 +36,7 @@
 #include "be/ut/helper.h"       /* m0_be_ut_backend */
 #include "be/op.h"              /* m0_be_op */
 #include "be/alloc_internal.h"  /* be_alloc_chunk */
+#include "be/seg_internal.h"    /* m0_be_seg_hdr */
 
 enum {
 	BE_UT_ALLOC_SEG_SIZE = 0x40000,
@@ -45,6 +46,12 @@ enum {
 	BE_UT_ALLOC_NR       = 0x800,
 	BE_UT_ALLOC_MT_NR    = 0x100,
 	BE_UT_ALLOC_THR_NR   = 0x4,
+	/* large enough to have allocator arenas */
+	BE_UT_ALLOC_ARENA_SEG_SIZE = 1UL << 26,
+	/* too large for arenas, fills the segment in BE_UT_ALLOC_FILL_NR */
+	BE_UT_ALLOC_FILL_SIZE      = 1UL << 18,
+	BE_UT_ALLOC_FILL_NR        = BE_UT_ALLOC_ARENA_SEG_SIZE /
+				     BE_UT_ALLOC_FILL_SIZE,
 };
 
 struct be_ut_alloc_thread_state {
@@ -149,7 +156,7 @@ static void be_ut_alloc_thread(int index)
 	m0_be_ut_backend_thread_exit(&be_ut_alloc_backend);
 }
 
-static void be_ut_alloc_mt(int nr)
+static void be_ut_alloc_mt(int nr, m0_bcount_t seg_size)
 {
 	struct m0_be_ut_backend *ut_be  = &be_ut_alloc_backend;
 	struct m0_be_ut_seg     *ut_seg = &be_ut_alloc_seg;
@@ -163,7 +170,7 @@ static void be_ut_alloc_mt(int nr)
 	}
 
 	m0_be_ut_backend_init(ut_be);
-	m0_be_ut_seg_init(ut_seg, ut_be, BE_UT_ALLOC_SEG_SIZE);
+	m0_be_ut_seg_init(ut_seg, ut_be, seg_size);
 	m0_be_ut_seg_allocator_init(ut_seg, ut_be);
 	for (i = 0; i < nr; ++i) {
 		rc = M0_THREAD_INIT(&be_ut_ts[i].ats_thread, int, NULL,
@@ -183,12 +190,170 @@ static void be_ut_alloc_mt(int nr)
 
 M0_INTERNAL void m0_be_ut_alloc_multiple(void)
 {
-	be_ut_alloc_mt(1);
+	be_ut_alloc_mt(1, BE_UT_ALLOC_SEG_SIZE);
 }
 
 M0_INTERNAL void m0_be_ut_alloc_concurrent(void)
 {
-	be_ut_alloc_mt(BE_UT_ALLOC_THR_NR);
+	be_ut_alloc_mt(BE_UT_ALLOC_THR_NR, BE_UT_ALLOC_SEG_SIZE);
+}
+
+static bool be_ut_alloc_is_in_arena(const struct m0_be_seg_hdr *seg_hdr,
+				    const void                 *ptr)
+{
+	return m0_exists(i, M0_BE_ALLOC_ARENA_NR,
+			 ptr >= seg_hdr->bh_arena[i].bah_addr &&
+			 ptr < seg_hdr->bh_arena[i].bah_addr +
+			       seg_hdr->bh_arena[i].bah_size);
+}
+
+M0_INTERNAL void m0_be_ut_alloc_arena(void)
+{
+	struct m0_be_ut_backend      *ut_be = &be_ut_alloc_backend;
+	struct m0_be_ut_seg           ut_seg;
+	struct m0_be_allocator       *a;
+	struct m0_be_seg_hdr         *seg_hdr;
+	struct m0_be_allocator_stats  before;
+	struct m0_be_allocator_stats  after;
+	void                         *ptrs[BE_UT_ALLOC_PTR_NR];
+	m0_bcount_t                   size;
+	int                           i;
+
+	m0_be_ut_backend_init(ut_be);
+	m0_be_ut_seg_init(&ut_seg, ut_be, BE_UT_ALLOC_ARENA_SEG_SIZE);
+	m0_be_ut_seg_allocator_init(&ut_seg, ut_be);
+	a = m0_be_seg_allocator(ut_seg.bus_seg);
+	seg_hdr = ut_seg.bus_seg->bs_addr;
+	/* arenas get space on the first allocation */
+	M0_UT_ASSERT(m0_forall(j, M0_BE_ALLOC_ARENA_NR,
+			       seg_hdr->bh_arena[j].bah_size == 0));
+
+	m0_be_alloc_stats(a, &before);
+	for (i = 0; i < ARRAY_SIZE(ptrs); ++i) {
+		/* the last allocation is too large for arenas */
+		size = i == ARRAY_SIZE(ptrs) - 1 ?
+		       M0_BE_ALLOC_ARENA_SIZE_MAX + 1 :
+		       (i + 1) * BE_UT_ALLOC_SIZE;
+		M0_BE_UT_TRANSACT(ut_be, tx, cred,
+			m0_be_allocator_credit(a, M0_BAO_ALLOC, size, 0, &cred),
+			M0_BE_OP_SYNC(op, m0_be_alloc(a, tx, &op,
+						      &ptrs[i], size)));
+		M0_UT_ASSERT(ptrs[i] != NULL);
+		M0_UT_ASSERT(be_ut_alloc_is_in_arena(seg_hdr, ptrs[i]) ==
+			     (size <= M0_BE_ALLOC_ARENA_SIZE_MAX));
+	}
+	m0_be_alloc_stats(a, &after);
+	M0_UT_ASSERT(after.bas_space_total == before.bas_space_total);
+	M0_UT_ASSERT(after.bas_space_used > before.bas_space_used);
+	for (i = 0; i < ARRAY_SIZE(ptrs); ++i) {
+		M0_BE_UT_TRANSACT(ut_be, tx, cred,
+			  m0_be_allocator_credit(a, M0_BAO_FREE, 0, 0, &cred),
+			  M0_BE_OP_SYNC(op, m0_be_free(a, tx, &op, ptrs[i])));
+	}
+	m0_be_alloc_stats(a, &after);
+	M0_UT_ASSERT(after.bas_space_used == before.bas_space_used);
+	M0_UT_ASSERT(after.bas_space_free == before.bas_space_free);
+
+	m0_be_ut_seg_allocator_fini(&ut_seg, ut_be);
+	m0_be_ut_seg_fini(&ut_seg);
+	m0_be_ut_backend_fini(ut_be);
+	M0_SET0(ut_be);
+
+	/* all threads allocate from their arenas simultaneously */
+	be_ut_alloc_mt(BE_UT_ALLOC_THR_NR, BE_UT_ALLOC_ARENA_SEG_SIZE);
+}
+
+/**
+ * Allocates BE_UT_ALLOC_FILL_SIZE blocks until the segment is full.
+ * Returns the number of blocks allocated.
+ */
+static int be_ut_alloc_fill(struct m0_be_allocator  *a,
+			    struct m0_be_ut_backend *ut_be,
+			    void                   **ptrs)
+{
+	int i;
+
+	for (i = 0; i < BE_UT_ALLOC_FILL_NR; ++i) {
+		M0_BE_UT_TRANSACT(ut_be, tx, cred,
+			m0_be_allocator_credit(a, M0_BAO_ALLOC,
+					       BE_UT_ALLOC_FILL_SIZE, 0, &cred),
+			M0_BE_OP_SYNC(op, m0_be_alloc(a, tx, &op, &ptrs[i],
+						BE_UT_ALLOC_FILL_SIZE)));
+		if (ptrs[i] == NULL)
+			break;
+	}
+	M0_UT_ASSERT(i < BE_UT_ALLOC_FILL_NR);
+	return i;
+}
+
+static void be_ut_alloc_free_all(struct m0_be_allocator  *a,
+				 struct m0_be_ut_backend *ut_be,
+				 void                   **ptrs,
+				 int                      nr)
+{
+	int i;
+
+	for (i = 0; i < nr; ++i) {
+		M0_BE_UT_TRANSACT(ut_be, tx, cred,
+			  m0_be_allocator_credit(a, M0_BAO_FREE, 0, 0, &cred),
+			  M0_BE_OP_SYNC(op, m0_be_free(a, tx, &op, ptrs[i])));
+	}
+}
+
+/*
+ * Normal zone is full: the allocation goes to an arena which has space, and
+ * space of unused arenas goes back to the zone.
+ */
+M0_INTERNAL void m0_be_ut_alloc_arena_full(void)
+{
+	static void                  *ptrs[BE_UT_ALLOC_FILL_NR];
+	struct m0_be_ut_backend      *ut_be = &be_ut_alloc_backend;
+	struct m0_be_ut_seg           ut_seg;
+	struct m0_be_allocator       *a;
+	struct m0_be_seg_hdr         *seg_hdr;
+	struct m0_be_allocator_stats  before;
+	struct m0_be_allocator_stats  after;
+	void                         *small;
+	int                           nr;
+	int                           nr_reclaimed;
+
+	m0_be_ut_backend_init(ut_be);
+	m0_be_ut_seg_init(&ut_seg, ut_be, BE_UT_ALLOC_ARENA_SEG_SIZE);
+	m0_be_ut_seg_allocator_init(&ut_seg, ut_be);
+	a = m0_be_seg_allocator(ut_seg.bus_seg);
+	seg_hdr = ut_seg.bus_seg->bs_addr;
+	m0_be_alloc_stats(a, &before);
+
+	/* the arena gets space and keeps it while "small" is allocated */
+	M0_BE_UT_TRANSACT(ut_be, tx, cred,
+		m0_be_allocator_credit(a, M0_BAO_ALLOC, BE_UT_ALLOC_SIZE, 0,
+				       &cred),
+		M0_BE_OP_SYNC(op, m0_be_alloc(a, tx, &op, &small,
+					      BE_UT_ALLOC_SIZE)));
+	M0_UT_ASSERT(small != NULL);
+	M0_UT_ASSERT(be_ut_alloc_is_in_arena(seg_hdr, small));
+
+	nr = be_ut_alloc_fill(a, ut_be, ptrs);
+	M0_UT_ASSERT(m0_exists(i, nr, be_ut_alloc_is_in_arena(seg_hdr,
+							       ptrs[i])));
+	be_ut_alloc_free_all(a, ut_be, ptrs, nr);
+	be_ut_alloc_free_all(a, ut_be, &small, 1);
+
+	/* all arenas are unused now and their space goes back to the zone */
+	nr_reclaimed = be_ut_alloc_fill(a, ut_be, ptrs);
+	M0_UT_ASSERT(nr_reclaimed >= nr);
+	M0_UT_ASSERT(m0_forall(j, M0_BE_ALLOC_ARENA_NR,
+			       seg_hdr->bh_arena[j].bah_size == 0));
+	be_ut_alloc_free_all(a, ut_be, ptrs, nr_reclaimed);
+
+	m0_be_alloc_stats(a, &after);
+	M0_UT_ASSERT(after.bas_space_total == before.bas_space_total);
+	M0_UT_ASSERT(after.bas_space_used == before.bas_space_used);
+
+	m0_be_ut_seg_allocator_fini(&ut_seg, ut_be);
+	m0_be_ut_seg_fini(&ut_seg);
+	m0_be_ut_backend_fini(ut_be);
+	M0_SET0(ut_be);
 }
 
 static void be_ut_alloc_credit_log(struct m0_be_allocator  *a,
@@ -546,6 +546,8 @@ static struct m0_be_btree *create_tree(void)
 	}
 	M0_UT_ASSERT(!m0_be_btree_is_empty(tree));
 
+	/* Run the rest of modifications with optimistic descent. */
+	m0_be_btree_optimistic_set(tree, true);
 	M0_LOG(M0_INFO, "Inserting inplace...");
 	/* insert inplace */
 	for (i = INSERT_COUNT/2; i < INSERT_COUNT; ++i) {
@@ -556,6 +558,7 @@ static struct m0_be_btree *create_tree(void)
 
 	btree_delete_test(tree, tx);
 	btree_save_test(tree);
+	m0_be_btree_optimistic_set(tree, false);
 	M0_LOG(M0_INFO, "Updating...");
 	m0_be_ut_tx_init(tx, ut_be);
 	*cred = M0_BE_TX_CREDIT(0, 0);
@@ -790,6 +793,7 @@ static void check(struct m0_be_btree *tree)
 	char             v2[INSERT_VSIZE * 3];
 	char             s[INSERT_VSIZE * 2];
 	int              i;
+	int              j;
 	int              rc;
 
 	M0_ALLOC_PTR(op);
@@ -799,12 +803,14 @@ static void check(struct m0_be_btree *tree)
 
 	m0_buf_init(&key, k, INSERT_KSIZE);
 
-	/* lookup */
-	for (i = 0; i < INSERT_COUNT; ++i) {
-		sprintf(k, "%0*d", INSERT_KSIZE-1, i);
+	/* lookup, with the tree lock and optimistic */
+	for (i = 0; i < INSERT_COUNT * 2; ++i) {
+		if (i == INSERT_COUNT)
+			m0_be_btree_optimistic_set(tree, true);
+		sprintf(k, "%0*d", INSERT_KSIZE-1, i % INSERT_COUNT);
 		M0_SET0(op);
 
-		if (i == INSERT_COUNT - 2)
+		if (i % INSERT_COUNT == INSERT_COUNT - 2)
 			m0_buf_init(&val, v2, ARRAY_SIZE(v2));
 		else
 			m0_buf_init(&val, v, INSERT_VSIZE*2);
@@ -813,22 +819,24 @@ static void check(struct m0_be_btree *tree)
 			op, m0_be_btree_lookup(tree, op, &key, &val),
 			bo_u.u_btree.t_rc);
 
-		if (INSERT_COUNT/4 <= i && i < INSERT_COUNT*3/4)
+		j = i % INSERT_COUNT;
+		if (INSERT_COUNT/4 <= j && j < INSERT_COUNT*3/4)
 			M0_UT_ASSERT(rc == -ENOENT);
-		else if (i == INSERT_COUNT - 1)
+		else if (j == INSERT_COUNT - 1)
 			M0_UT_ASSERT(strcmp(v, "XYZ") == 0);
-		else if (i == INSERT_COUNT - 2)
+		else if (j == INSERT_COUNT - 2)
 			M0_UT_ASSERT(strcmp(v2, "ABCDEFGHI") == 0);
 		else {
-			if ((i & 1) == 0) {
-				sprintf(s, "%0*d", INSERT_VSIZE-1, i);
+			if ((j & 1) == 0) {
+				sprintf(s, "%0*d", INSERT_VSIZE-1, j);
 				M0_UT_ASSERT(strcmp(v, s) == 0);
 			} else {
-				sprintf(s, "%0*d", INSERT_VSIZE*2 - 1, i);
+				sprintf(s, "%0*d", INSERT_VSIZE*2 - 1, j);
 				M0_UT_ASSERT(strcmp(v, s) == 0);
 			}
 		}
 	}
+	m0_be_btree_optimistic_set(tree, false);
 
 	/* lookup inplace */
 	for (i = 0; i < INSERT_COUNT; ++i) {
@@ -881,6 +889,380 @@ static void check(struct m0_be_btree *tree)
 	m0_free(op);
 }
 
+#ifndef __KERNEL__
+/* ------------------------------------------------------------------
+ * Benchmarks
+ * ------------------------------------------------------------------ */
+
+#include "lib/ub.h"
+#include "lib/thread.h"    /* M0_THREAD_INIT */
+
+enum {
+	/* Number of keys in the benchmarked tree. */
+	UB_KEYS_NR = BTREE_FAN_OUT * 400,
+	/* Prime used to scatter keys over the key space. */
+	UB_KEYS_STEP = 7919,
+};
+
+static struct m0_be_btree *ub_tree;
+
+static void ub_key(char *k, int i)
+{
+	sprintf(k, "%0*d", INSERT_KSIZE-1, (int)((uint64_t)i * UB_KEYS_STEP %
+						  UB_KEYS_NR));
+}
+
+static int ub_init(const char *opts M0_UNUSED)
+{
+	struct m0_be_tx_credit  cred = {};
+	struct m0_be_tx         tx = {};
+	int                     rc;
+
+	M0_ALLOC_PTR(ut_be);
+	M0_ALLOC_PTR(ut_seg);
+	M0_UB_ASSERT(ut_be != NULL && ut_seg != NULL);
+	m0_be_ut_backend_init(ut_be);
+	m0_be_ut_seg_init(ut_seg, ut_be, 1ULL << 26);
+	seg = ut_seg->bus_seg;
+
+	M0_ALLOC_PTR(ub_tree);
+	M0_UB_ASSERT(ub_tree != NULL);
+	*ub_tree = (struct m0_be_btree) { .bb_seg = seg };
+	m0_be_btree_create_credit(ub_tree, 1, &cred);
+	M0_BE_ALLOC_CREDIT_PTR(ub_tree, seg, &cred);
+	m0_free(ub_tree);
+
+	m0_be_ut_tx_init(&tx, ut_be);
+	m0_be_tx_prep(&tx, &cred);
+	rc = m0_be_tx_open_sync(&tx);
+	M0_UB_ASSERT(rc == 0);
+	M0_BE_ALLOC_PTR_SYNC(ub_tree, seg, &tx);
+	m0_be_btree_init(ub_tree, seg, &kv_ops);
+	M0_BE_OP_SYNC(op, m0_be_btree_create(ub_tree, &tx, &op,
+					     &M0_FID_TINIT('b', 0, 2)));
+	m0_be_tx_close_sync(&tx);
+	m0_be_tx_fini(&tx);
+	return 0;
+}
+
+static void ub_fini(void)
+{
+	m0_be_btree_fini(ub_tree);
+	m0_be_ut_seg_fini(ut_seg);
+	m0_be_ut_backend_fini(ut_be);
+	m0_free(ut_seg);
+	m0_free(ut_be);
+}
+
+static void ub_insert(int i)
+{
+	struct m0_buf key;
+	struct m0_buf val;
+	char          k[INSERT_KSIZE];
+	char          v[INSERT_VSIZE];
+	int           rc;
+
+	ub_key(k, i);
+	sprintf(v, "%0*d", INSERT_VSIZE-1, i);
+	m0_buf_init(&key, k, INSERT_KSIZE);
+	m0_buf_init(&val, v, INSERT_VSIZE);
+	rc = btree_insert(ub_tree, &key, &val, UB_KEYS_NR - i - 1);
+	M0_UB_ASSERT(rc == 0);
+}
+
+static void ub_lookup(int i)
+{
+	struct m0_buf key;
+	struct m0_buf val;
+	char          k[INSERT_KSIZE];
+	char          v[INSERT_VSIZE];
+	int           rc;
+
+	ub_key(k, i);
+	m0_buf_init(&key, k, INSERT_KSIZE);
+	m0_buf_init(&val, v, INSERT_VSIZE);
+	rc = M0_BE_OP_SYNC_RET(op, m0_be_btree_lookup(ub_tree, &op, &key, &val),
+			       bo_u.u_btree.t_rc);
+	M0_UB_ASSERT(rc == 0);
+}
+
+static void ub_lookup_miss(int i)
+{
+	struct m0_buf key;
+	struct m0_buf val;
+	char          k[INSERT_KSIZE + 1];
+	char          v[INSERT_VSIZE];
+	int           rc;
+
+	/* Keys longer than INSERT_KSIZE-1 digits are never inserted. */
+	sprintf(k, "%0*d", INSERT_KSIZE, i);
+	m0_buf_init(&key, k, sizeof k);
+	m0_buf_init(&val, v, INSERT_VSIZE);
+	rc = M0_BE_OP_SYNC_RET(op, m0_be_btree_lookup(ub_tree, &op, &key, &val),
+			       bo_u.u_btree.t_rc);
+	M0_UB_ASSERT(rc == -ENOENT);
+}
+
+static void ub_lookup_opt(int i)
+{
+	m0_be_btree_optimistic_set(ub_tree, true);
+	ub_lookup(i);
+	m0_be_btree_optimistic_set(ub_tree, false);
+}
+
+/* Number of threads started by ub_mt(). */
+static int ub_threads_nr;
+
+static void ub_lookup_thread(int idx M0_UNUSED)
+{
+	int i;
+
+	for (i = 0; i < UB_KEYS_NR; ++i)
+		ub_lookup(i);
+}
+
+/*
+ * Overwrites the values of the keys i with i % ub_threads_nr == @idx, so that
+ * threads update disjoint keys. Values keep their size, so every update only
+ * rewrites a value in place and never changes the tree structure.
+ */
+static void ub_update_thread(int idx)
+{
+	struct m0_be_tx_credit cred;
+	struct m0_be_tx        tx;
+	struct m0_buf          key;
+	struct m0_buf          val;
+	char                   k[INSERT_KSIZE];
+	char                   v[INSERT_VSIZE];
+	int                    nr = 0;
+	int                    rc;
+	int                    i;
+
+	for (i = idx; i < UB_KEYS_NR; i += ub_threads_nr) {
+		if (nr == 0) {
+			cred = M0_BE_TX_CREDIT(0, 0);
+			m0_be_btree_update_credit(ub_tree, TXN_OPS_NR,
+						  INSERT_VSIZE, &cred);
+			m0_be_ut_tx_init(&tx, ut_be);
+			m0_be_tx_prep(&tx, &cred);
+			rc = m0_be_tx_open_sync(&tx);
+			M0_UB_ASSERT(rc == 0);
+		}
+		ub_key(k, i);
+		sprintf(v, "%0*d", INSERT_VSIZE-1, i + idx);
+		m0_buf_init(&key, k, INSERT_KSIZE);
+		m0_buf_init(&val, v, INSERT_VSIZE);
+		rc = M0_BE_OP_SYNC_RET(op, m0_be_btree_update(ub_tree, &tx, &op,
+							      &key, &val),
+				       bo_u.u_btree.t_rc);
+		M0_UB_ASSERT(rc == 0);
+		if (++nr == TXN_OPS_NR || i + ub_threads_nr >= UB_KEYS_NR) {
+			m0_be_tx_close_sync(&tx);
+			m0_be_tx_fini(&tx);
+			nr = 0;
+		}
+	}
+}
+
+/*
+ * Runs @nr threads executing @func on the same tree. Comparing results for
+ * different @nr shows how the operation scales with the number of localities
+ * accessing the tree.
+ */
+static void ub_mt(void (*func)(int), int nr, bool optimistic)
+{
+	struct m0_thread *threads;
+	int               rc;
+	int               i;
+
+	M0_ALLOC_ARR(threads, nr);
+	M0_UB_ASSERT(threads != NULL);
+	ub_threads_nr = nr;
+	m0_be_btree_optimistic_set(ub_tree, optimistic);
+	for (i = 0; i < nr; ++i) {
+		rc = M0_THREAD_INIT(&threads[i], int, NULL, func,
+				    i, "ub_btree%d", i);
+		M0_UB_ASSERT(rc == 0);
+	}
+	for (i = 0; i < nr; ++i) {
+		rc = m0_thread_join(&threads[i]);
+		M0_UB_ASSERT(rc == 0);
+		m0_thread_fini(&threads[i]);
+	}
+	m0_be_btree_optimistic_set(ub_tree, false);
+	m0_free(threads);
+}
+
+static void ub_lookup_mt_1(int i)
+{
+	ub_mt(&ub_lookup_thread, 1, false);
+}
+
+static void ub_lookup_mt_2(int i)
+{
+	ub_mt(&ub_lookup_thread, 2, false);
+}
+
+static void ub_lookup_mt_4(int i)
+{
+	ub_mt(&ub_lookup_thread, 4, false);
+}
+
+static void ub_lookup_mt_8(int i)
+{
+	ub_mt(&ub_lookup_thread, 8, false);
+}
+
+static void ub_lookup_opt_mt_1(int i)
+{
+	ub_mt(&ub_lookup_thread, 1, true);
+}
+
+static void ub_lookup_opt_mt_2(int i)
+{
+	ub_mt(&ub_lookup_thread, 2, true);
+}
+
+static void ub_lookup_opt_mt_4(int i)
+{
+	ub_mt(&ub_lookup_thread, 4, true);
+}
+
+static void ub_lookup_opt_mt_8(int i)
+{
+	ub_mt(&ub_lookup_thread, 8, true);
+}
+
+static void ub_update_mt_1(int i)
+{
+	ub_mt(&ub_update_thread, 1, false);
+}
+
+static void ub_update_mt_2(int i)
+{
+	ub_mt(&ub_update_thread, 2, false);
+}
+
+static void ub_update_mt_4(int i)
+{
+	ub_mt(&ub_update_thread, 4, false);
+}
+
+static void ub_update_mt_8(int i)
+{
+	ub_mt(&ub_update_thread, 8, false);
+}
+
+static void ub_update_opt_mt_1(int i)
+{
+	ub_mt(&ub_update_thread, 1, true);
+}
+
+static void ub_update_opt_mt_2(int i)
+{
+	ub_mt(&ub_update_thread, 2, true);
+}
+
+static void ub_update_opt_mt_4(int i)
+{
+	ub_mt(&ub_update_thread, 4, true);
+}
+
+static void ub_update_opt_mt_8(int i)
+{
+	ub_mt(&ub_update_thread, 8, true);
+}
+
+struct m0_ub_set m0_be_btree_ub = {
+	.us_name = "be-btree-ub",
+	.us_init = ub_init,
+	.us_fini = ub_fini,
+	.us_run  = {
+		{ .ub_name  = "insert",
+		  .ub_iter  = UB_KEYS_NR,
+		  .ub_round = ub_insert },
+
+		{ .ub_name  = "lookup",
+		  .ub_iter  = UB_KEYS_NR,
+		  .ub_round = ub_lookup },
+
+		{ .ub_name  = "lookup-miss",
+		  .ub_iter  = UB_KEYS_NR,
+		  .ub_round = ub_lookup_miss },
+
+		{ .ub_name  = "lookup-opt",
+		  .ub_iter  = UB_KEYS_NR,
+		  .ub_round = ub_lookup_opt },
+
+		{ .ub_name  = "lookup-mt-1",
+		  .ub_iter  = 1,
+		  .ub_round = ub_lookup_mt_1 },
+
+		{ .ub_name  = "lookup-mt-2",
+		  .ub_iter  = 1,
+		  .ub_round = ub_lookup_mt_2 },
+
+		{ .ub_name  = "lookup-mt-4",
+		  .ub_iter  = 1,
+		  .ub_round = ub_lookup_mt_4 },
+
+		{ .ub_name  = "lookup-mt-8",
+		  .ub_iter  = 1,
+		  .ub_round = ub_lookup_mt_8 },
+
+		{ .ub_name  = "lookup-opt-mt-1",
+		  .ub_iter  = 1,
+		  .ub_round = ub_lookup_opt_mt_1 },
+
+		{ .ub_name  = "lookup-opt-mt-2",
+		  .ub_iter  = 1,
+		  .ub_round = ub_lookup_opt_mt_2 },
+
+		{ .ub_name  = "lookup-opt-mt-4",
+		  .ub_iter  = 1,
+		  .ub_round = ub_lookup_opt_mt_4 },
+
+		{ .ub_name  = "lookup-opt-mt-8",
+		  .ub_iter  = 1,
+		  .ub_round = ub_lookup_opt_mt_8 },
+
+		{ .ub_name  = "update-mt-1",
+		  .ub_iter  = 1,
+		  .ub_round = ub_update_mt_1 },
+
+		{ .ub_name  = "update-mt-2",
+		  .ub_iter  = 1,
+		  .ub_round = ub_update_mt_2 },
+
+		{ .ub_name  = "update-mt-4",
+		  .ub_iter  = 1,
+		  .ub_round = ub_update_mt_4 },
+
+		{ .ub_name  = "update-mt-8",
+		  .ub_iter  = 1,
+		  .ub_round = ub_update_mt_8 },
+
+		{ .ub_name  = "update-opt-mt-1",
+		  .ub_iter  = 1,
+		  .ub_round = ub_update_opt_mt_1 },
+
+		{ .ub_name  = "update-opt-mt-2",
+		  .ub_iter  = 1,
+		  .ub_round = ub_update_opt_mt_2 },
+
+		{ .ub_name  = "update-opt-mt-4",
+		  .ub_iter  = 1,
+		  .ub_round = ub_update_opt_mt_4 },
+
+		{ .ub_name  = "update-opt-mt-8",
+		  .ub_iter  = 1,
+		  .ub_round = ub_update_opt_mt_8 },
+
+		{ .ub_name = NULL }
+	}
+};
+#endif /* __KERNEL__ */
+
 #undef M0_TRACE_SUBSYSTEM
 
 /*
@@ -94,6 +94,7 @@ extern void m0_be_ut_seg_io(void);
 extern void m0_be_ut_seg_multiple(void);
 extern void m0_be_ut_seg_large(void);
 extern void m0_be_ut_seg_large_multiple(void);
+extern void m0_be_ut_seg_paged(void);
 
 extern void m0_be_ut_group_format(void);
 
@@ -137,6 +138,8 @@ extern void m0_be_ut_alloc_init_fini(void);
 extern void m0_be_ut_alloc_create_destroy(void);
 extern void m0_be_ut_alloc_multiple(void);
 extern void m0_be_ut_alloc_concurrent(void);
+extern void m0_be_ut_alloc_arena(void);
+extern void m0_be_ut_alloc_arena_full(void);
 extern void m0_be_ut_alloc_oom(void);
 extern void m0_be_ut_alloc_info(void);
 extern void m0_be_ut_alloc_spare(void);
@@ -220,6 +223,7 @@ struct m0_ut_suite be_ut = {
 		{ "seg-multiple",            m0_be_ut_seg_multiple            },
 		{ "seg-large",               m0_be_ut_seg_large               },
 		{ "seg-large-multiple",      m0_be_ut_seg_large_multiple      },
+		{ "seg-paged",               m0_be_ut_seg_paged               },
 		{ "group_format",            m0_be_ut_group_format            },
 		{ "mkfs",                    m0_be_ut_mkfs                    },
 		{ "mkfs-multiseg",           m0_be_ut_mkfs_multiseg           },
@@ -257,6 +261,8 @@ struct m0_ut_suite be_ut = {
 		{ "alloc-create",            m0_be_ut_alloc_create_destroy    },
 		{ "alloc-multiple",          m0_be_ut_alloc_multiple          },
 		{ "alloc-concurrent",        m0_be_ut_alloc_concurrent        },
+		{ "alloc-arena",             m0_be_ut_alloc_arena             },
+		{ "alloc-arena-full",        m0_be_ut_alloc_arena_full        },
 		{ "alloc-oom",               m0_be_ut_alloc_oom               },
 		{ "alloc-info",              m0_be_ut_alloc_info              },
 		{ "alloc-spare",             m0_be_ut_alloc_spare             },
@@ -422,6 +422,81 @@ void m0_be_ut_seg_large_multiple(void)
 	m0_ut_stob_put(stob, true);
 }
 
+enum {
+	BE_UT_SEG_PG_SHIFT  = 12,
+	BE_UT_SEG_PG_NR     = 8,
+	BE_UT_SEG_PG_BUDGET = 2,
+};
+M0_BASSERT(BE_UT_SEG_IO_OFFS + (BE_UT_SEG_PG_NR << BE_UT_SEG_PG_SHIFT) <=
+	   BE_UT_SEG_SIZE);
+
+void m0_be_ut_seg_paged(void)
+{
+	struct m0_be_seg_paging_cfg cfg = {
+		.bspc_budget = BE_UT_SEG_PG_BUDGET << BE_UT_SEG_PG_SHIFT,
+		.bspc_shift  = BE_UT_SEG_PG_SHIFT,
+	};
+	struct m0_be_ut_seg ut_seg;
+	struct m0_be_seg   *seg;
+	struct m0_be_reg    reg;
+	m0_bcount_t         pg_size = 1ULL << BE_UT_SEG_PG_SHIFT;
+	char               *addr;
+	int                 rc;
+	int                 i;
+
+	m0_be_ut_seg_init(&ut_seg, NULL, BE_UT_SEG_SIZE);
+	seg = ut_seg.bus_seg;
+	rc = m0_be_seg_paging_enable(seg, &cfg);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_be_seg_is_paged(seg));
+
+	/* modify pages, pin them and place the modifications */
+	addr = seg->bs_addr + BE_UT_SEG_IO_OFFS;
+	reg  = M0_BE_REG(seg, BE_UT_SEG_PG_NR * pg_size, addr);
+	for (i = 0; i < BE_UT_SEG_PG_NR; ++i)
+		memset(addr + i * pg_size, i + 1, pg_size);
+	m0_be_seg_pin(seg, reg.br_addr, reg.br_size);
+	rc = m0_be_reg__write(&reg);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(m0_atomic64_get(&seg->bs_pg_resident) == BE_UT_SEG_PG_NR);
+	/* pinned pages are not evicted */
+	M0_UT_ASSERT(m0_be_seg_evict(seg) == 0);
+
+	/*
+	 * Make modifications which are never placed. They disappear from the
+	 * evicted pages, so it's possible to check which pages are evicted.
+	 */
+	memset(addr, 0xff, reg.br_size);
+	m0_be_seg_unpin(seg, reg.br_addr, reg.br_size);
+	M0_UT_ASSERT(m0_be_seg_evict(seg) ==
+		     BE_UT_SEG_PG_NR - BE_UT_SEG_PG_BUDGET);
+	M0_UT_ASSERT(m0_atomic64_get(&seg->bs_pg_resident) ==
+		     BE_UT_SEG_PG_BUDGET);
+	M0_UT_ASSERT(m0_be_seg_evict(seg) == 0);
+	for (i = 0; i < BE_UT_SEG_PG_NR; ++i) {
+		char c = i < BE_UT_SEG_PG_NR - BE_UT_SEG_PG_BUDGET ?
+			 i + 1 : 0xff;
+
+		M0_UT_ASSERT(m0_forall(j, pg_size, addr[i * pg_size + j] == c));
+	}
+
+	/* the same page pinned twice stays resident until the last unpin */
+	m0_be_seg_pin(seg, addr, 1);
+	m0_be_seg_pin(seg, addr + pg_size - 1, 1);
+	m0_be_seg_unpin(seg, addr, 1);
+	M0_UT_ASSERT(m0_atomic64_get(&seg->bs_pg_resident) ==
+		     BE_UT_SEG_PG_BUDGET + 1);
+	(void)m0_be_seg_evict(seg);
+	M0_UT_ASSERT((m0_atomic64_get(&seg->bs_pg_map[
+			BE_UT_SEG_IO_OFFS >> BE_UT_SEG_PG_SHIFT]) &
+		      M0_BE_SEG_PG_PRESENT) != 0);
+	m0_be_seg_unpin(seg, addr + pg_size - 1, 1);
+
+	m0_be_seg_paging_disable(seg);
+	M0_UT_ASSERT(!m0_be_seg_is_paged(seg));
+	m0_be_ut_seg_fini(&ut_seg);
+}
+
 #undef M0_TRACE_SUBSYSTEM
 
 /*
@@ -115,6 +115,14 @@ static int cas_fops_init(const struct m0_sm_conf           *sm_conf,
 			 .fom_ops   = &m0_fsync_fom_ops,
 #endif
 			 .rpc_flags = M0_RPC_ITEM_TYPE_REQUEST);
+	/*
+	 * CAS foms are spread over localities round-robin
+	 * (cas_fom_home_locality()), an idle locality can take them over.
+	 */
+	cas_get_fopt.ft_fom_type.ft_migratable = true;
+	cas_put_fopt.ft_fom_type.ft_migratable = true;
+	cas_del_fopt.ft_fom_type.ft_migratable = true;
+	cas_cur_fopt.ft_fom_type.ft_migratable = true;
 	return  m0_fop_type_addb2_instrument(&cas_get_fopt) ?:
 		m0_fop_type_addb2_instrument(&cas_put_fopt) ?:
 		m0_fop_type_addb2_instrument(&cas_del_fopt) ?:
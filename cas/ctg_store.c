@@ -414,6 +414,8 @@ static int ctg_cmp(const void *opaque_key_left, const void *opaque_key_right)
 
 static void ctg_init(struct m0_cas_ctg *ctg, struct m0_be_seg *seg)
 {
+	/* Channel and its guard are volatile, see m0_be_btree_init(). */
+	m0_be_seg_pin(seg, ctg, sizeof *ctg);
 	m0_format_header_pack(&ctg->cc_head, &(struct m0_format_tag){
 		.ot_version = M0_CAS_CTG_FORMAT_VERSION,
 		.ot_type    = M0_FORMAT_TYPE_CAS_CTG,
@@ -430,12 +432,15 @@ static void ctg_init(struct m0_cas_ctg *ctg, struct m0_be_seg *seg)
 
 static void ctg_fini(struct m0_cas_ctg *ctg)
 {
+	struct m0_be_seg *seg = ctg->cc_tree.bb_seg;
+
 	M0_ENTRY("ctg=%p", ctg);
 	ctg->cc_inited = false;
 	m0_be_btree_fini(&ctg->cc_tree);
 	m0_long_lock_fini(m0_ctg_lock(ctg));
 	m0_chan_fini_lock(&ctg->cc_chan.bch_chan);
 	m0_mutex_fini(&ctg->cc_chan_guard.bm_u.mutex);
+	m0_be_seg_unpin(seg, ctg, sizeof *ctg);
 }
 
 int m0_ctg_create(struct m0_be_seg *seg, struct m0_be_tx *tx,
@@ -678,12 +683,26 @@ static int ctg_state_create(struct m0_be_seg     *seg,
         return M0_RC(rc);
 }
 
+static void ctg_state_init(struct m0_cas_state *state, struct m0_be_seg *seg)
+{
+	/* cs_ctg_init_mutex is volatile, see m0_be_btree_init(). */
+	m0_be_seg_pin(seg, state, sizeof *state);
+	m0_mutex_init(&state->cs_ctg_init_mutex.bm_u.mutex);
+}
+
+static void ctg_state_fini(struct m0_cas_state *state, struct m0_be_seg *seg)
+{
+	m0_mutex_fini(&state->cs_ctg_init_mutex.bm_u.mutex);
+	m0_be_seg_unpin(seg, state, sizeof *state);
+}
+
 static void ctg_state_destroy(struct m0_cas_state *state,
 			      struct m0_be_tx     *tx)
 {
 	struct m0_cas_ctg *meta = state->cs_meta;
 	struct m0_be_seg  *seg  = meta->cc_tree.bb_seg;
 
+	ctg_state_fini(state, seg);
         ctg_meta_selfrm(&meta->cc_tree, tx);
 	ctg_destroy(meta, tx);
 	M0_BE_FREE_PTR_SYNC(state, seg, tx);
@@ -699,7 +718,7 @@ static int ctg_store__init(struct m0_be_seg *seg, struct m0_cas_state *state)
 	M0_ENTRY();
 
 	ctg_store.cs_state = state;
-	m0_mutex_init(&state->cs_ctg_init_mutex.bm_u.mutex);
+	ctg_state_init(state, seg);
 	ctg_init(state->cs_meta, seg);
 
 	/* Searching for catalogue-index catalogue. */
@@ -752,7 +771,7 @@ static int ctg_store_create(struct m0_be_seg *seg)
 	rc = ctg_state_create(seg, &tx, &state);
 	if (rc != 0)
 		goto end;
-	m0_mutex_init(&state->cs_ctg_init_mutex.bm_u.mutex);
+	ctg_state_init(state, seg);
 
 	/* Create catalog-index catalogue. */
 	rc = m0_ctg_create(seg, &tx, &ctidx, &m0_cas_ctidx_fid);
@@ -861,6 +880,8 @@ static void ctg_store_release(struct m0_ref *ref)
 
 	M0_ENTRY();
 	m0_mutex_fini(&ctg_store->cs_state_mutex);
+	ctg_state_fini(ctg_store->cs_state,
+		       ctg_store->cs_state->cs_meta->cc_tree.bb_seg);
 	ctg_store->cs_state = NULL;
 	ctg_store->cs_ctidx = NULL;
 	m0_long_lock_fini(&ctg_store->cs_del_lock);
@@ -448,6 +448,7 @@ M0_INTERNAL void m0_cas_gc_init(void)
 			 .fom_ops   = &cgc_fom_type_ops,
 			 .sm        = &cgc_sm_conf,
 			 .svc_type  = &m0_cas_service_type);
+	cgc_fake_fopt.ft_fom_type.ft_class = M0_FOM_CLASS_BACKGROUND;
 
 	M0_LEAVE();
 }
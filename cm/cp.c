@@ -582,6 +582,7 @@ M0_INTERNAL void m0_cm_cp_init(struct m0_cm_type *cmtype,
 {
 	m0_fom_type_init(&cmtype->ct_fomt, cmtype->ct_fom_id, ft_ops,
 			 &cmtype->ct_stype, &m0_cm_cp_sm_conf);
+	cmtype->ct_fomt.ft_class = M0_FOM_CLASS_BACKGROUND;
 }
 
 M0_INTERNAL bool m0_cm_cp_invariant(const struct m0_cm_cp *cp)
@@ -712,6 +712,8 @@ int m0_cob_domain_init(struct m0_cob_domain *dom, struct m0_be_seg *seg)
 	M0_PRE(dom != NULL);
 	M0_PRE(dom->cd_id.id != 0);
 
+	/* cd_lock is volatile, see m0_be_btree_init(). */
+	m0_be_seg_pin(seg, dom, sizeof *dom);
 	m0_be_btree_init(&dom->cd_object_index,   seg, &cob_oi_ops);
 	m0_be_btree_init(&dom->cd_namespace,	  seg, &cob_ns_ops);
 	m0_be_btree_init(&dom->cd_fileattr_basic, seg, &cob_fab_ops);
@@ -725,6 +727,8 @@ int m0_cob_domain_init(struct m0_cob_domain *dom, struct m0_be_seg *seg)
 
 void m0_cob_domain_fini(struct m0_cob_domain *dom)
 {
+	struct m0_be_seg *seg = dom->cd_object_index.bb_seg;
+
 	m0_be_btree_fini(&dom->cd_fileattr_ea);
 	m0_be_btree_fini(&dom->cd_fileattr_omg);
 	m0_be_btree_fini(&dom->cd_fileattr_basic);
@@ -732,6 +736,7 @@ void m0_cob_domain_fini(struct m0_cob_domain *dom)
 	m0_be_btree_fini(&dom->cd_namespace);
 	m0_be_btree_fini(&dom->cd_bytecount);
 	m0_rwlock_fini(&dom->cd_lock.bl_u.rwlock);
+	m0_be_seg_unpin(seg, dom, sizeof *dom);
 }
 
 static void cob_domain_id2str(char **s, const struct m0_cob_domain_id *cdid)
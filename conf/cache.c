@@ -30,12 +30,19 @@
 #include "conf/onwire.h"    /* m0_confx */
 #include "lib/errno.h"      /* EEXIST */
 #include "lib/memory.h"     /* M0_ALLOC_PTR, M0_ALLOC_ARR */
+#include "lib/misc.h"       /* M0_SET0 */
 
 /**
  * @defgroup conf_dlspec_cache Configuration Cache (lspec)
  *
  * The implementation of m0_conf_cache::ca_registry is based on linked
- * list data structure.
+ * list data structure.  The list preserves insertion order, which
+ * m0_conf_cache_encode() and m0_conf_cache_clean() rely upon.
+ *
+ * Lookups by fid go through m0_conf_cache::ca_index, a hash table that
+ * contains exactly the objects of ca_registry.  Without it every
+ * m0_conf_cache_add() would scan the registry, making the load of a
+ * configuration quadratic in the number of objects.
  *
  * @see @ref conf, @ref conf-lspec
  *
@@ -47,6 +54,38 @@ M0_TL_DESCR_DEFINE(m0_conf_cache, "registered m0_conf_obj-s", ,
 		   M0_CONF_OBJ_MAGIC, M0_CONF_CACHE_MAGIC);
 M0_TL_DEFINE(m0_conf_cache, M0_INTERNAL, struct m0_conf_obj);
 
+enum {
+	/**
+	 * Initial number of m0_conf_cache::ca_index buckets. The index grows
+	 * with the number of cached objects.
+	 */
+	CONF_CACHE_BUCKET_NR = 256
+};
+
+static uint64_t conf_cache_hash_func(const struct m0_htable *htable,
+				     const struct m0_fid *fid)
+{
+	return m0_fid_hash(fid) % htable->h_bucket_nr;
+}
+
+static bool conf_cache_hash_key_eq(const struct m0_fid *fid1,
+				   const struct m0_fid *fid2)
+{
+	return m0_fid_eq(fid1, fid2);
+}
+
+M0_HT_DESCR_DEFINE(m0_conf_cache_hash, "conf cache fid index", ,
+		   struct m0_conf_obj, co_cache_hlink, co_gen_magic,
+		   M0_CONF_OBJ_MAGIC, M0_CONF_CACHE_HASH_MAGIC,
+		   co_id, conf_cache_hash_func, conf_cache_hash_key_eq);
+M0_HT_DEFINE(m0_conf_cache_hash, M0_INTERNAL, struct m0_conf_obj,
+	     struct m0_fid);
+
+static bool conf_cache_is_indexed(const struct m0_conf_cache *cache)
+{
+	return cache->ca_index.h_buckets != NULL;
+}
+
 M0_INTERNAL void m0_conf_cache_lock(struct m0_conf_cache *cache)
 {
 	m0_mutex_lock(cache->ca_lock);
@@ -68,6 +107,12 @@ m0_conf_cache_init(struct m0_conf_cache *cache, struct m0_mutex *lock)
 	M0_ENTRY();
 
 	m0_conf_cache_tlist_init(&cache->ca_registry);
+	if (m0_conf_cache_hash_htable_init_resizable(&cache->ca_index,
+						     CONF_CACHE_BUCKET_NR) != 0) {
+		M0_LOG(M0_WARN, "No memory for fid index, "
+		       "lookups will scan the registry");
+		M0_SET0(&cache->ca_index);
+	}
 	cache->ca_lock = lock;
 	cache->ca_ver  = 0;
 	cache->ca_fid_counter = 0;
@@ -88,6 +133,8 @@ m0_conf_cache_add(struct m0_conf_cache *cache, struct m0_conf_obj *obj)
 	if (x != NULL)
 		return M0_ERR(-EEXIST);
 	m0_conf_cache_tlist_add(&cache->ca_registry, obj);
+	if (conf_cache_is_indexed(cache))
+		m0_conf_cache_hash_htable_add(&cache->ca_index, obj);
 	return M0_RC(0);
 }
 
@@ -106,14 +153,18 @@ M0_INTERNAL struct m0_conf_obj *
 m0_conf_cache_lookup(const struct m0_conf_cache *cache,
 		     const struct m0_fid *id)
 {
+	if (conf_cache_is_indexed(cache))
+		return m0_conf_cache_hash_htable_lookup(&cache->ca_index, id);
 	return m0_tl_find(m0_conf_cache, obj, &cache->ca_registry,
 			  m0_fid_eq(&obj->co_id, id));
 }
 
-static void _obj_del(struct m0_conf_obj *obj)
+static void _obj_del(struct m0_conf_cache *cache, struct m0_conf_obj *obj)
 {
 	M0_ENTRY("obj="FID_F, FID_P(&obj->co_id));
 
+	if (conf_cache_is_indexed(cache))
+		m0_conf_cache_hash_htable_del(&cache->ca_index, obj);
 	m0_conf_cache_tlist_del(obj);
 	m0_conf_obj_delete(obj);
 
@@ -121,13 +172,13 @@ static void _obj_del(struct m0_conf_obj *obj)
 }
 
 M0_INTERNAL void
-m0_conf_cache_del(const struct m0_conf_cache *cache, struct m0_conf_obj *obj)
+m0_conf_cache_del(struct m0_conf_cache *cache, struct m0_conf_obj *obj)
 {
 	M0_ENTRY();
 	M0_PRE(m0_conf_cache_is_locked(cache));
 	M0_PRE(m0_conf_cache_tlist_contains(&cache->ca_registry, obj));
 
-	_obj_del(obj);
+	_obj_del(cache, obj);
 
 	M0_LEAVE();
 }
@@ -159,7 +210,7 @@ static void conf_cache_clean(struct m0_conf_cache *cache,
 		if (type == NULL || m0_conf_obj_type(obj) == type) {
 			if (gc && !obj->co_deleted)
 				continue;
-			_obj_del(obj);
+			_obj_del(cache, obj);
 		}
 	} m0_tl_endfor;
 	M0_LEAVE();
@@ -186,6 +237,8 @@ M0_INTERNAL void m0_conf_cache_fini(struct m0_conf_cache *cache)
 
 	m0_conf_cache_lock(cache);
 	m0_conf_cache_clean(cache, NULL);
+	if (conf_cache_is_indexed(cache))
+		m0_conf_cache_hash_htable_fini(&cache->ca_index);
 	m0_conf_cache_tlist_fini(&cache->ca_registry);
 	m0_conf_cache_unlock(cache);
 
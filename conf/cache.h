@@ -25,11 +25,15 @@
 
 #include "conf/obj.h"
 #include "lib/tlist.h"  /* M0_TL_DESCR_DECLARE */
+#include "lib/hash.h"   /* M0_HT_DECLARE */
 
 struct m0_mutex;
 
 M0_TL_DESCR_DECLARE(m0_conf_cache, extern);
 M0_TL_DECLARE(m0_conf_cache, M0_INTERNAL, struct m0_conf_obj);
+M0_HT_DESCR_DECLARE(m0_conf_cache_hash, extern);
+M0_HT_DECLARE(m0_conf_cache_hash, M0_INTERNAL, struct m0_conf_obj,
+	      struct m0_fid);
 
 /**
  * @page conf-fspec-cache Configuration Cache
@@ -41,7 +45,9 @@ M0_TL_DECLARE(m0_conf_cache, M0_INTERNAL, struct m0_conf_obj);
  * A registry of cached configuration objects --
  * m0_con_cache::ca_registry -- performs the following functions:
  *
- *   - maps object identities to memory addresses of these objects;
+ *   - maps object identities to memory addresses of these objects.
+ *     The mapping is indexed by m0_conf_cache::ca_index, so that
+ *     m0_conf_cache_lookup() does not depend on the size of the cache;
  *
  *   - ensures uniqueness of configuration objects in the cache.
  *     After an object has been added to the registry, any attempt to
@@ -98,6 +104,16 @@ struct m0_conf_cache {
 	 */
 	struct m0_tl     ca_registry;
 
+	/**
+	 * Fid index of ca_registry.
+	 * Hash of m0_conf_obj-s, linked through m0_conf_obj::co_cache_hlink.
+	 *
+	 * Left zeroed if the buckets could not be allocated by
+	 * m0_conf_cache_init(); m0_conf_cache_lookup() then falls back to
+	 * scanning ca_registry.
+	 */
+	struct m0_htable ca_index;
+
 	/** Cache lock. */
 	struct m0_mutex *ca_lock;
 
@@ -162,7 +178,7 @@ M0_INTERNAL int m0_conf_cache_add(struct m0_conf_cache *cache,
  * @pre  m0_conf_cache_is_locked(cache)
  * @pre  m0_conf_cache_tlist_contains(&cache->ca_registry, obj)
  */
-M0_INTERNAL void m0_conf_cache_del(const struct m0_conf_cache *cache,
+M0_INTERNAL void m0_conf_cache_del(struct m0_conf_cache *cache,
 				   struct m0_conf_obj *obj);
 
 /**
@@ -100,6 +100,7 @@ m0_conf_obj_create(const struct m0_fid *id, struct m0_conf_cache *cache)
 	m0_chan_init(&obj->co_chan, cache->ca_lock);
 	m0_chan_init(&obj->co_ha_chan, cache->ca_lock);
 	m0_conf_cache_tlink_init(obj);
+	m0_conf_cache_hash_tlink_init(obj);
 	m0_conf_dir_tlink_init(obj);
 	/*
 	 * m0_ha_state_accept() does not expect .co_ha_state to be
@@ -173,6 +174,7 @@ M0_INTERNAL void m0_conf_obj_delete(struct m0_conf_obj *obj)
 
 	/* Finalise generic fields. */
 	m0_conf_dir_tlink_fini(obj);
+	m0_conf_cache_hash_tlink_fini(obj);
 	m0_conf_cache_tlink_fini(obj);
 	m0_chan_fini(&obj->co_ha_chan);
 	m0_chan_fini(&obj->co_chan);
@@ -26,10 +26,12 @@
 #include "conf/onwire.h"   /* m0_confx_obj, m0_confx */
 #include "conf/dir.h"      /* m0_conf_dir_add */
 #include "conf/ut/common.h"
+#include "lib/arith.h"     /* m0_rnd64 */
 #include "lib/buf.h"       /* m0_buf, M0_BUF_INITS */
 #include "lib/errno.h"     /* ENOENT */
 #include "lib/fs.h"        /* m0_file_read */
 #include "lib/memory.h"    /* m0_free0 */
+#include "lib/ub.h"        /* m0_ub_set */
 #include "ut/misc.h"       /* M0_UT_PATH */
 #include "ut/ut.h"
 
@@ -128,6 +130,70 @@ static void test_cache(void)
 	m0_conf_cache_unlock(&m0_conf_ut_cache);
 }
 
+/* Types of the objects that dominate a large configuration. */
+static const struct m0_conf_obj_type *conf_ut_bulk_types[] = {
+	&M0_CONF_SDEV_TYPE,
+	&M0_CONF_DRIVE_TYPE,
+	&M0_CONF_PROCESS_TYPE,
+	&M0_CONF_SERVICE_TYPE
+};
+
+static void conf_ut_bulk_fid(struct m0_fid *fid, uint64_t key)
+{
+	m0_fid_tset(fid, conf_ut_bulk_types[key %
+					    ARRAY_SIZE(conf_ut_bulk_types)]->
+		    cot_ftype.ft_id, 1, key);
+}
+
+static void test_cache_index(void)
+{
+	enum { NR = 1000 };
+	struct m0_conf_cache *cache = &m0_conf_ut_cache;
+	struct m0_conf_obj   *objs[NR];
+	struct m0_conf_obj   *obj;
+	struct m0_fid         fid;
+	uint64_t              nr;
+	int                   rc;
+	int                   i;
+
+	m0_conf_cache_lock(cache);
+	nr = m0_conf_cache_tlist_length(&cache->ca_registry);
+	M0_UT_ASSERT(m0_conf_cache_hash_htable_size(&cache->ca_index) == nr);
+	for (i = 0; i < NR; ++i) {
+		conf_ut_bulk_fid(&fid, i);
+		rc = m0_conf_obj_find(cache, &fid, &objs[i]);
+		M0_UT_ASSERT(rc == 0);
+	}
+	M0_UT_ASSERT(m0_conf_cache_hash_htable_size(&cache->ca_index) ==
+		     nr + NR);
+	M0_UT_ASSERT(m0_conf_cache_tlist_length(&cache->ca_registry) ==
+		     nr + NR);
+	for (i = 0; i < NR; ++i) {
+		conf_ut_bulk_fid(&fid, i);
+		M0_UT_ASSERT(m0_conf_cache_lookup(cache, &fid) == objs[i]);
+		rc = m0_conf_obj_find(cache, &fid, &obj);
+		M0_UT_ASSERT(rc == 0 && obj == objs[i]);
+	}
+	/* Same key, type that is not used by conf_ut_bulk_fid(). */
+	m0_fid_tset(&fid, M0_CONF_NODE_TYPE.cot_ftype.ft_id, 1, 0);
+	M0_UT_ASSERT(m0_conf_cache_lookup(cache, &fid) == NULL);
+
+	for (i = 0; i < NR; i += 2)
+		m0_conf_cache_del(cache, objs[i]);
+	for (i = 0; i < NR; ++i) {
+		conf_ut_bulk_fid(&fid, i);
+		M0_UT_ASSERT(m0_conf_cache_lookup(cache, &fid) ==
+			     (i % 2 == 0 ? NULL : objs[i]));
+	}
+	M0_UT_ASSERT(m0_conf_cache_hash_htable_size(&cache->ca_index) ==
+		     nr + NR / 2);
+	for (i = 1; i < NR; i += 2)
+		m0_conf_cache_del(cache, objs[i]);
+	M0_UT_ASSERT(m0_conf_cache_hash_htable_size(&cache->ca_index) == nr);
+	M0_UT_ASSERT(m0_conf_cache_tlist_length(&cache->ca_registry) == nr);
+	m0_conf_cache_unlock(cache);
+}
+
 static void test_obj_find(void)
 {
 	int                 rc;
@@ -190,9 +256,103 @@ struct m0_ut_suite conf_ut = {
 	.ts_tests = {
 		{ "obj-xtors",   test_obj_xtors },
 		{ "cache",       test_cache     },
+		{ "cache-index", test_cache_index },
 		{ "obj-find",    test_obj_find  },
 		{ "obj-fill",    test_obj_fill  },
 		{ "dir-add-del", test_dir_add_del },
 		{ NULL, NULL }
 	}
 };
+
+enum {
+	CONF_UB_CACHE_NR   = 100000,
+	CONF_UB_LOAD_ITER  = 10,
+	CONF_UB_CACHE_ITER = 1000000,
+};
+
+static struct m0_mutex      conf_ub_lock;
+static struct m0_conf_cache conf_ub_cache;
+static uint64_t             conf_ub_seed;
+
+/*
+ * Registers CONF_UB_CACHE_NR stubs the way confc and confd preload
+ * does it: m0_conf_obj_find() looks the fid up and adds a new object.
+ */
+static int conf_ub_cache_fill(struct m0_conf_cache *cache)
+{
+	struct m0_conf_obj *obj;
+	struct m0_fid       fid;
+	int                 rc = 0;
+	int                 i;
+
+	m0_conf_cache_lock(cache);
+	for (i = 0; i < CONF_UB_CACHE_NR && rc == 0; ++i) {
+		conf_ut_bulk_fid(&fid, i);
+		rc = m0_conf_obj_find(cache, &fid, &obj);
+	}
+	m0_conf_cache_unlock(cache);
+	return rc;
+}
+
+static int conf_ub_init(const char *opts M0_UNUSED)
+{
+	int rc;
+
+	m0_mutex_init(&conf_ub_lock);
+	m0_conf_cache_init(&conf_ub_cache, &conf_ub_lock);
+	rc = conf_ub_cache_fill(&conf_ub_cache);
+	if (rc != 0) {
+		m0_conf_cache_fini(&conf_ub_cache);
+		m0_mutex_fini(&conf_ub_lock);
+	}
+	return rc;
+}
+
+static void conf_ub_fini(void)
+{
+	m0_conf_cache_fini(&conf_ub_cache);
+	m0_mutex_fini(&conf_ub_lock);
+}
+
+static void conf_ub_load(int i)
+{
+	struct m0_mutex      lock;
+	struct m0_conf_cache cache;
+	int                  rc;
+
+	m0_mutex_init(&lock);
+	m0_conf_cache_init(&cache, &lock);
+	rc = conf_ub_cache_fill(&cache);
+	M0_ASSERT(rc == 0);
+	m0_conf_cache_fini(&cache);
+	m0_mutex_fini(&lock);
+}
+
+static void conf_ub_lookup(int i)
+{
+	struct m0_fid       fid;
+	struct m0_conf_obj *obj;
+
+	conf_ut_bulk_fid(&fid, m0_rnd64(&conf_ub_seed) % CONF_UB_CACHE_NR);
+	m0_conf_cache_lock(&conf_ub_cache);
+	obj = m0_conf_cache_lookup(&conf_ub_cache, &fid);
+	m0_conf_cache_unlock(&conf_ub_cache);
+	M0_ASSERT(obj != NULL);
+}
+
+struct m0_ub_set m0_conf_ub = {
+	.us_name = "conf-ub",
+	.us_init = conf_ub_init,
+	.us_fini = conf_ub_fini,
+	.us_run  = {
+		{ .ub_name  = "load-1e5",
+		  .ub_iter  = CONF_UB_LOAD_ITER,
+		  .ub_round = conf_ub_load },
+
+		{ .ub_name  = "lookup-1e5",
+		  .ub_iter  = CONF_UB_CACHE_ITER,
+		  .ub_round = conf_ub_lookup },
+
+		{ .ub_name = NULL }
+	}
+};
@@ -250,6 +250,8 @@ M0_INTERNAL void m0_fdmi__src_dock_fom_init(void)
 			 M0_FDMI_SOURCE_DOCK_TIMER_OPCODE,
 			 &fdmi_sd_timer_fom_type_ops, &m0_fdmi_service_type,
 			 &fdmi_src_dock_timer_fom_sm_conf);
+	fdmi_sd_fom_type.ft_class       = M0_FOM_CLASS_BACKGROUND;
+	fdmi_sd_timer_fom_type.ft_class = M0_FOM_CLASS_BACKGROUND;
 	M0_LEAVE();
 }
 
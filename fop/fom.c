@@ -53,6 +53,10 @@
 #include "fdmi/fol_fdmi_src.h"
 #include "motr/iem.h"
 
+#ifndef __KERNEL__
+#include <stdlib.h>                   /* getenv */
+#endif
+
 /**
  * @addtogroup fom
  *
@@ -138,6 +142,36 @@ enum {
 	HUNG_FOP_SEC_PERIOD   = 5,
 	HUNG_FOP_TIME_SEC_MAX = 2*60,
 	HUNG_FOP_TIME_SEC_IEM = 5*60,
+	/** How often an idle handler looks for work to steal. */
+	STEAL_PERIOD          = M0_TIME_ONE_MSEC,
+	/** Minimal run-queue length of a locality to be robbed. */
+	STEAL_RUNQ_MIN        = 2,
+	/** Maximal number of foms handed over in response to a request. */
+	STEAL_BATCH_MAX       = 16,
+	/** Number of run-queue entries (from the tail) examined per request. */
+	STEAL_SCAN_MAX        = 64,
+	/**
+	 * Foreground run-queue length above which background foms are held
+	 * back.
+	 */
+	RUNQ_BG_THROTTLE      = 32,
+	/** Maximal time a held back background fom waits in the run-queue. */
+	RUNQ_BG_DELAY_MAX     = 10 * M0_TIME_ONE_MSEC,
+};
+
+/**
+ * Deficit round-robin weights of fom scheduling classes: the number of foms
+ * dequeued from a non-empty run-queue per round.
+ */
+static const unsigned fom_class_weight[M0_FOM_CLASS_NR] = {
+	[M0_FOM_CLASS_FOREGROUND] = 8,
+	[M0_FOM_CLASS_BACKGROUND] = 1
+};
+
+/** Addb2 labels of per-class queueing delay histograms. */
+static const uint64_t fom_class_delay_id[M0_FOM_CLASS_NR] = {
+	[M0_FOM_CLASS_FOREGROUND] = M0_AVI_RUNQ_DELAY_FOREGROUND,
+	[M0_FOM_CLASS_BACKGROUND] = M0_AVI_RUNQ_DELAY_BACKGROUND
 };
 
 /**
@@ -231,9 +265,15 @@ M0_INTERNAL bool m0_fom_group_is_locked(const struct m0_fom *fom)
 	return m0_mutex_is_locked(&fom->fo_loc->fl_group.s_lock);
 }
 
+static enum m0_fom_class fom_class(const struct m0_fom *fom)
+{
+	M0_PRE(IS_IN_ARRAY(fom->fo_type->ft_class, fom_class_weight));
+	return fom->fo_type->ft_class;
+}
+
 static bool is_in_runq(const struct m0_fom *fom)
 {
-	return runq_tlist_contains(&fom->fo_loc->fl_runq, fom);
+	return runq_tlist_contains(&fom->fo_loc->fl_runq[fom_class(fom)], fom);
 }
 
 static bool is_in_wail(const struct m0_fom *fom)
@@ -268,14 +308,20 @@ M0_INTERNAL bool m0_locality_invariant(const struct m0_fom_locality *loc)
 	return
 		_0C(loc != NULL && loc->fl_dom != NULL) &&
 		_0C(m0_mutex_is_locked(&loc->fl_group.s_lock)) &&
-		_0C(M0_CHECK_EX(m0_tlist_invariant(&runq_tl, &loc->fl_runq))) &&
+		_0C(m0_forall(c, M0_FOM_CLASS_NR,
+			M0_CHECK_EX(m0_tlist_invariant(&runq_tl,
+						       &loc->fl_runq[c])))) &&
+		_0C(loc->fl_runq_nr == m0_reduce(c, M0_FOM_CLASS_NR, (size_t)0,
+					 + loc->fl_runq_class_nr[c])) &&
 		_0C(M0_CHECK_EX(m0_tlist_invariant(&wail_tl, &loc->fl_wail))) &&
 		_0C(m0_tl_forall(thr, t, &loc->fl_threads,
 			     t->lt_loc == loc && thread_invariant(t))) &&
 		_0C(ergo(loc->fl_handler != NULL,
 		     thr_tlist_contains(&loc->fl_threads, loc->fl_handler))) &&
-		_0C(M0_CHECK_EX(m0_tl_forall(runq, fom, &loc->fl_runq,
-					 fom->fo_loc == loc))) &&
+		_0C(m0_forall(c, M0_FOM_CLASS_NR,
+			M0_CHECK_EX(m0_tl_forall(runq, fom, &loc->fl_runq[c],
+						 fom->fo_loc == loc &&
+						 fom_class(fom) == c)))) &&
 		_0C(M0_CHECK_EX(m0_tl_forall(wail, fom, &loc->fl_wail,
 					 fom->fo_loc == loc)));
 }
@@ -402,6 +448,33 @@ static bool fom_wait_time_is_out(const struct m0_fom_domain *dom,
 	return hung_fom_notify(fom);
 }
 
+/**
+ * Adds fom to the run-queue of its class and wakes the handler up if the
+ * locality had no ready foms.
+ */
+static void runq_add(struct m0_fom_locality *loc, struct m0_fom *fom)
+{
+	enum m0_fom_class cl    = fom_class(fom);
+	bool              empty = loc->fl_runq_nr == 0;
+
+	runq_tlist_add_tail(&loc->fl_runq[cl], fom);
+	M0_CNT_INC(loc->fl_runq_class_nr[cl]);
+	M0_CNT_INC(loc->fl_runq_nr);
+	m0_addb2_hist_mod(&loc->fl_runq_counter, loc->fl_runq_nr);
+	if (empty)
+		m0_chan_signal(&loc->fl_runrun);
+}
+
+static void runq_del(struct m0_fom_locality *loc, struct m0_fom *fom)
+{
+	enum m0_fom_class cl = fom_class(fom);
+
+	runq_tlist_del(fom);
+	M0_CNT_DEC(loc->fl_runq_class_nr[cl]);
+	M0_CNT_DEC(loc->fl_runq_nr);
+	m0_addb2_hist_mod(&loc->fl_runq_counter, loc->fl_runq_nr);
+}
+
 /**
  * Enqueues fom into locality runq list and increments
  * number of items in runq, m0_fom_locality::fl_runq_nr.
@@ -412,17 +485,9 @@ static bool fom_wait_time_is_out(const struct m0_fom_domain *dom,
  */
 static void fom_ready(struct m0_fom *fom)
 {
-	struct m0_fom_locality *loc;
-	bool                    empty;
-
 	fom_state_set(fom, M0_FOS_READY);
-	loc = fom->fo_loc;
-	empty = runq_tlist_is_empty(&loc->fl_runq);
-	runq_tlist_add_tail(&loc->fl_runq, fom);
-	M0_CNT_INC(loc->fl_runq_nr);
-	m0_addb2_hist_mod(&loc->fl_runq_counter, loc->fl_runq_nr);
-	if (empty)
-		m0_chan_signal(&loc->fl_runrun);
+	fom->fo_ready_at = m0_time_now();
+	runq_add(fom->fo_loc, fom);
 	M0_POST(m0_fom_invariant(fom));
 }
 
@@ -856,24 +921,188 @@ static void fom_exec(struct m0_fom *fom)
 	}
 }
 
+/**
+ * Returns true iff the head of the given run-queue can be dequeued now.
+ *
+ * Background foms are held back while the foreground run-queue is long, but
+ * not longer than RUNQ_BG_DELAY_MAX.
+ */
+static bool runq_is_eligible(const struct m0_fom_locality *loc,
+			     enum m0_fom_class cl, m0_time_t now)
+{
+	const struct m0_fom *head = runq_tlist_head(&loc->fl_runq[cl]);
+
+	return head != NULL &&
+		ergo(cl == M0_FOM_CLASS_BACKGROUND,
+		     loc->fl_runq_class_nr[M0_FOM_CLASS_FOREGROUND] <
+		     RUNQ_BG_THROTTLE ||
+		     m0_time_sub(now, head->fo_ready_at) > RUNQ_BG_DELAY_MAX);
+}
+
 /**
  * Dequeues a fom from runq list of the locality.
  *
+ * Run-queues of different classes are served in deficit round-robin order:
+ * each visit to a run-queue adds fom_class_weight[] to its deficit and the
+ * run-queue is served until its deficit is exhausted or it has no eligible
+ * foms.
+ *
  * @retval m0_fom if queue is not empty, NULL otherwise
  */
 static struct m0_fom *fom_dequeue(struct m0_fom_locality *loc)
 {
-	struct m0_fom *fom;
+	struct m0_fom    *fom = NULL;
+	m0_time_t         now;
+	enum m0_fom_class cl;
+	int               i;
 
-	fom = runq_tlist_pop(&loc->fl_runq);
-	if (fom != NULL) {
-		M0_ASSERT(fom->fo_loc == loc);
-		M0_CNT_DEC(loc->fl_runq_nr);
-		m0_addb2_hist_mod(&loc->fl_runq_counter, loc->fl_runq_nr);
+	if (loc->fl_runq_nr == 0)
+		return NULL;
+	now = m0_time_now();
+	/*
+	 * An eligible run-queue always exists: the background run-queue is
+	 * only held back when the foreground one is not empty. Two full rounds
+	 * are enough to find it.
+	 */
+	for (i = 0; fom == NULL; ++i) {
+		M0_ASSERT(i <= 2 * M0_FOM_CLASS_NR);
+		cl = loc->fl_runq_cur;
+		if (loc->fl_runq_deficit[cl] > 0 &&
+		    runq_is_eligible(loc, cl, now)) {
+			fom = runq_tlist_head(&loc->fl_runq[cl]);
+			--loc->fl_runq_deficit[cl];
+		} else {
+			loc->fl_runq_deficit[cl] = 0;
+			cl = loc->fl_runq_cur = (cl + 1) % M0_FOM_CLASS_NR;
+			loc->fl_runq_deficit[cl] = fom_class_weight[cl];
+		}
 	}
+	M0_ASSERT(fom->fo_loc == loc);
+	runq_del(loc, fom);
+	m0_addb2_loghist_mod(&loc->fl_runq_delay[cl],
+			     m0_time_sub(now, fom->fo_ready_at));
 	return fom;
 }
 
+/**
+ * @name Work stealing
+ *
+ * When m0_fom_domain::fd_steal is set, a handler thread that finds its
+ * run-queue empty posts m0_fom_locality::fl_steal_ast to the locality with the
+ * longest run-queue (fom_steal()). Group locks of localities are held by their
+ * handlers for long periods (including sleeps), so foms are never taken from
+ * another locality directly. Instead, the victim handler executes the ast
+ * (steal_give()), detaches a batch of foms from the tail of its run-queue and
+ * re-posts them to the thief group, where they are re-attached by
+ * stolen_queueit().
+ *
+ * Only foms that have not started execution yet (fom_is_migratable()) are
+ * moved: a fom that executed a phase transition might have locality-bound
+ * state (transactions, timers, call-backs, long locks).
+ *
+ * While a fom is in transit it is in no locality list and is accounted in
+ * m0_reqh_service::rs_fom_queued, as a newly queued fom is.
+ *
+ * @{
+ */
+
+static bool fom_is_migratable(struct m0_fom *fom)
+{
+	return fom->fo_type->ft_migratable && fom->fo_service != NULL &&
+		m0_fom_phase(fom) == M0_FOM_PHASE_INIT &&
+		fom->fo_transitions == 0 && fom->fo_pending == NULL &&
+		fom->fo_thread == NULL &&
+		!m0_chan_has_waiters(&fom->fo_sm_phase.sm_chan) &&
+		!m0_chan_has_waiters(&fom->fo_sm_state.sm_chan);
+}
+
+static void stolen_queueit(struct m0_sm_group *grp, struct m0_sm_ast *ast)
+{
+	struct m0_fom          *fom = container_of(ast, struct m0_fom,
+						   fo_cb.fc_ast);
+	struct m0_fom_locality *loc = container_of(grp, struct m0_fom_locality,
+						   fl_group);
+
+	M0_PRE(fom_state(fom) == M0_FOS_READY);
+
+	fom->fo_loc     = loc;
+	fom->fo_loc_idx = loc->fl_idx;
+	m0_sm_regroup(&fom->fo_sm_phase, grp);
+	m0_sm_regroup(&fom->fo_sm_state, grp);
+	m0_fom_locality_inc(fom);
+	m0_atomic64_dec(&fom->fo_service->rs_fom_queued);
+	m0_addb2_counter_mod(&loc->fl_steal_got, 1);
+	runq_add(loc, fom);
+	M0_POST(m0_fom_invariant(fom));
+}
+
+static void steal_give(struct m0_sm_group *grp, struct m0_sm_ast *ast)
+{
+	struct m0_fom_locality *loc   = container_of(grp, struct m0_fom_locality,
+						     fl_group);
+	struct m0_fom_locality *thief = ast->sa_datum;
+	struct m0_fom          *fom;
+	struct m0_fom          *prev;
+	size_t                  nr;
+	int                     scan = 0;
+	int                     cl;
+
+	M0_PRE(thief != loc);
+
+	nr = min_check(loc->fl_runq_nr / 2, (size_t)STEAL_BATCH_MAX);
+	for (cl = 0; cl < M0_FOM_CLASS_NR; ++cl) {
+		for (fom = runq_tlist_tail(&loc->fl_runq[cl]);
+		     fom != NULL && nr > 0 && scan < STEAL_SCAN_MAX &&
+			     !thief->fl_shutdown;
+		     fom = prev, ++scan) {
+			prev = runq_tlist_prev(&loc->fl_runq[cl], fom);
+			if (!fom_is_migratable(fom))
+				continue;
+			runq_del(loc, fom);
+			m0_atomic64_inc(&fom->fo_service->rs_fom_queued);
+			m0_fom_locality_dec(fom);
+			fom->fo_cb.fc_ast.sa_cb = &stolen_queueit;
+			m0_sm_ast_post(&thief->fl_group, &fom->fo_cb.fc_ast);
+			--nr;
+		}
+	}
+	m0_atomic64_set(&thief->fl_steal_pending, 0);
+}
+
+/**
+ * Asks the locality with the longest run-queue to hand over some of its ready
+ * foms to "loc". Run-queue lengths of other localities are read without
+ * locking, they are only used as a hint.
+ */
+static void fom_steal(struct m0_fom_locality *loc)
+{
+	struct m0_fom_domain   *dom    = loc->fl_dom;
+	struct m0_fom_locality *victim = NULL;
+	size_t                  longest = STEAL_RUNQ_MIN - 1;
+	size_t                  i;
+
+	if (m0_atomic64_get(&loc->fl_steal_pending) != 0)
+		return;
+	for (i = 0; i < dom->fd_localities_nr; ++i) {
+		struct m0_fom_locality *other = dom->fd_localities[i];
+		size_t                  nr    = other->fl_runq_nr;
+
+		if (other != loc && !other->fl_shutdown && nr > longest) {
+			victim  = other;
+			longest = nr;
+		}
+	}
+	if (victim != NULL) {
+		m0_atomic64_set(&loc->fl_steal_pending, 1);
+		loc->fl_steal_ast.sa_cb    = &steal_give;
+		loc->fl_steal_ast.sa_datum = loc;
+		m0_sm_ast_post(&victim->fl_group, &loc->fl_steal_ast);
+		m0_addb2_counter_mod(&loc->fl_steal_try, 1);
+	}
+}
+
+/** @} end of work stealing */
+
 /**
  * Locality handler thread. See the "Locality internals" section.
  */
@@ -945,7 +1174,15 @@ static void loc_handler_thread(struct m0_loc_thread *th)
 				m0_addb2_pop(M0_AVI_FOM);
 			} else if (loc->fl_shutdown)
 				break;
-			else
+			else if (loc->fl_dom->fd_steal) {
+				fom_steal(loc);
+				/*
+				 * Wake up periodically to look for overloaded
+				 * localities.
+				 */
+				m0_chan_timedwait(clink,
+					m0_time_from_now(0, STEAL_PERIOD));
+			} else
 				/*
 				 * Yes, sleep with the lock held. Knock on
 				 * &loc->fl_runrun or &loc->fl_group.s_clink to
@@ -972,7 +1209,16 @@ static void loc_handler_thread(struct m0_loc_thread *th)
  */
 static int loc_thr_init(struct m0_loc_thread *th)
 {
-	return m0_thread_confine(&th->lt_thread, &th->lt_loc->fl_processors);
+	struct m0_fom_locality *loc = th->lt_loc;
+	int                     rc;
+
+	rc = m0_thread_confine(&th->lt_thread, &loc->fl_processors);
+	/* Failure to set memory policy is not fatal. */
+	if (rc == 0 && loc->fl_dom->fd_numa &&
+	    m0_memory_thread_bind(loc->fl_numa_node) != 0)
+		M0_LOG(M0_WARN, "Cannot bind memory of locality %i to node %i.",
+		       loc->fl_idx, loc->fl_numa_node);
+	return rc;
 }
 
 static void loc_thr_fini(struct m0_loc_thread *th)
@@ -1032,6 +1278,7 @@ static void loc_addb2_fini(struct m0_fom_locality *loc)
 static void loc_fini(struct m0_fom_locality *loc)
 {
 	struct m0_loc_thread *th;
+	int                   i;
 
 	loc->fl_shutdown = true;
 	m0_clink_signal(&loc->fl_group.s_clink);
@@ -1047,7 +1294,8 @@ static void loc_fini(struct m0_fom_locality *loc)
 	}
 	group_unlock(loc);
 
-	runq_tlist_fini(&loc->fl_runq);
+	for (i = 0; i < M0_FOM_CLASS_NR; ++i)
+		runq_tlist_fini(&loc->fl_runq[i]);
 	M0_ASSERT(loc->fl_runq_nr == 0);
 	wail_tlist_fini(&loc->fl_wail);
 	M0_ASSERT(loc->fl_wail_nr == 0);
@@ -1078,22 +1326,31 @@ static void loc_fini(struct m0_fom_locality *loc)
 static int loc_init(struct m0_fom_locality *loc, struct m0_fom_domain *dom,
 		    size_t idx)
 {
-	int                   res;
-	struct m0_addb2_mach *orig = m0_thread_tls()->tls_addb2_mach;
+	int                       res;
+	int                       i;
+	struct m0_addb2_mach     *orig = m0_thread_tls()->tls_addb2_mach;
+	struct m0_processor_descr pd;
 
 	M0_PRE(loc != NULL);
 
 	M0_ENTRY();
 
 	loc->fl_dom = dom;
+	loc->fl_numa_node = m0_processor_describe(idx, &pd) == 0 ?
+		pd.pd_numa_node : 0;
 	loc->fl_addb2_mach = m0_addb2_sys_get(dom->fd_addb2_sys);
 	if (loc->fl_addb2_mach == NULL) {
 		res = M0_ERR(-ENOMEM);
 		goto err;
 	}
 
-	runq_tlist_init(&loc->fl_runq);
+	for (i = 0; i < M0_FOM_CLASS_NR; ++i) {
+		runq_tlist_init(&loc->fl_runq[i]);
+		loc->fl_runq_class_nr[i] = 0;
+		loc->fl_runq_deficit[i] = 0;
+	}
 	loc->fl_runq_nr = 0;
+	loc->fl_runq_cur = 0;
 	wail_tlist_init(&loc->fl_wail);
 	loc->fl_wail_nr = 0;
 	loc->fl_idx = idx;
@@ -1104,15 +1361,20 @@ static int loc_init(struct m0_fom_locality *loc, struct m0_fom_domain *dom,
 	m0_addb2_clock_add(&loc->fl_clock, M0_AVI_CLOCK, -1);
 	m0_addb2_hist_add(&loc->fl_fom_active,   1, 30, M0_AVI_FOM_ACTIVE, -1);
 	m0_addb2_hist_add(&loc->fl_runq_counter, 1, 30, M0_AVI_RUNQ, -1);
+	for (i = 0; i < M0_FOM_CLASS_NR; ++i)
+		m0_addb2_loghist_add(&loc->fl_runq_delay[i],
+				     fom_class_delay_id[i], -1);
 	m0_addb2_hist_add(&loc->fl_wail_counter, 1, 30, M0_AVI_WAIL, -1);
-	m0_addb2_hist_add_auto(&loc->fl_grp_addb2.ga_forq_hist, 1000,
-			       M0_AVI_LOCALITY_FORQ, -1);
-	m0_addb2_hist_add_auto(&loc->fl_chan_addb2.ca_wait_hist, 1000,
-			       M0_AVI_LOCALITY_CHAN_WAIT, -1);
-	m0_addb2_hist_add_auto(&loc->fl_chan_addb2.ca_cb_hist, 1000,
-			       M0_AVI_LOCALITY_CHAN_CB, -1);
+	m0_addb2_loghist_add(&loc->fl_grp_addb2.ga_forq_hist,
+			     M0_AVI_LOCALITY_FORQ, -1);
+	m0_addb2_loghist_add(&loc->fl_chan_addb2.ca_wait_hist,
+			     M0_AVI_LOCALITY_CHAN_WAIT, -1);
+	m0_addb2_loghist_add(&loc->fl_chan_addb2.ca_cb_hist,
+			     M0_AVI_LOCALITY_CHAN_CB, -1);
 	m0_addb2_hist_add_auto(&loc->fl_chan_addb2.ca_queue_hist, 1000,
 			       M0_AVI_LOCALITY_CHAN_QUEUE, -1);
+	m0_addb2_counter_add(&loc->fl_steal_try, M0_AVI_LOCALITY_STEAL_TRY, -1);
+	m0_addb2_counter_add(&loc->fl_steal_got, M0_AVI_LOCALITY_STEAL_GOT, -1);
 	loc->fl_grp_addb2.ga_forq = M0_AVI_LOCALITY_FORQ_DURATION;
 	m0_thread_tls()->tls_addb2_mach = orig;
 
@@ -1124,12 +1386,11 @@ static int loc_init(struct m0_fom_locality *loc, struct m0_fom_domain *dom,
 	loc->fl_runrun.ch_addb2 = &loc->fl_chan_addb2;
 	thr_tlist_init(&loc->fl_threads);
 	m0_atomic64_set(&loc->fl_unblocking, 0);
+	m0_atomic64_set(&loc->fl_steal_pending, 0);
 	m0_chan_init(&loc->fl_idle, &loc->fl_group.s_lock);
 
 	res = m0_bitmap_init(&loc->fl_processors, dom->fd_localities_nr);
 	if (res == 0) {
-		int i;
-
 		m0_bitmap_set(&loc->fl_processors, idx, true);
 		/* create a pool of idle threads plus the handler thread. */
 		group_lock(loc);
@@ -1176,9 +1437,11 @@ static void hung_foms_notify(struct m0_locality_chore *chore,
 	struct m0_fom_locality *floc = container_of(loc, struct m0_fom_locality,
 						    fl_locality);
 	const struct m0_fom_domain *dom = floc->fl_dom;
+	int                         i;
 
-	(void)m0_tl_forall(runq, fom, &floc->fl_runq,
-			   dom->fd_ops->fdo_time_is_out(dom, fom));
+	for (i = 0; i < M0_FOM_CLASS_NR; ++i)
+		(void)m0_tl_forall(runq, fom, &floc->fl_runq[i],
+				   dom->fd_ops->fdo_time_is_out(dom, fom));
 	(void)m0_tl_forall(wail, fom, &floc->fl_wail,
 			   dom->fd_ops->fdo_time_is_out(dom, fom));
 }
@@ -1210,6 +1473,10 @@ M0_INTERNAL int m0_fom_domain_init(struct m0_fom_domain **out)
 		return M0_ERR(-ENOMEM);
 	}
 	dom->fd_ops = &m0_fom_dom_ops;
+#ifndef __KERNEL__
+	dom->fd_steal = getenv("M0_FOM_STEAL") != NULL;
+	dom->fd_numa  = getenv("M0_FOM_NUMA") != NULL;
+#endif
 
 	result = m0_addb2_sys_init(&dom->fd_addb2_sys,
 				   &(struct m0_addb2_config) {
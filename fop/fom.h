@@ -235,6 +235,26 @@ struct m0_loc_thread;
 
 #define FOM_PHASE_DEBUG (1)
 
+/**
+ * Scheduling classes of foms, see m0_fom_type::ft_class.
+ *
+ * Each locality has a run-queue per class. Run-queues are served in deficit
+ * round-robin order, with a larger weight given to the foreground class.
+ * Additionally, background foms are held back while the foreground run-queue
+ * is long, unless they have been waiting for too long.
+ *
+ * A fom type that foreground foms wait for (e.g., the BE tx group fom, which
+ * closes transactions of client requests) must stay foreground: holding it
+ * back would hold back the foreground foms as well.
+ */
+enum m0_fom_class {
+	/** Latency sensitive foms, e.g., client requests. The default. */
+	M0_FOM_CLASS_FOREGROUND,
+	/** Background activity: repair, garbage collection, etc. */
+	M0_FOM_CLASS_BACKGROUND,
+	M0_FOM_CLASS_NR
+};
+
 /**
  * A locality is a partition of computational resources dedicated to fom
  * execution on the node.
@@ -255,9 +275,18 @@ struct m0_loc_thread;
 struct m0_fom_locality {
 	struct m0_fom_domain          *fl_dom;
 
-	/** Run-queue */
-	struct m0_tl		       fl_runq;
+	/** Run-queues, one per scheduling class (enum m0_fom_class). */
+	struct m0_tl		       fl_runq[M0_FOM_CLASS_NR];
+	/** Total number of foms in all run-queues. */
 	size_t			       fl_runq_nr;
+	/** Number of foms in each run-queue. */
+	size_t                         fl_runq_class_nr[M0_FOM_CLASS_NR];
+	/**
+	 * Deficit round-robin state: the class currently served and the number
+	 * of foms each class can still dequeue in the current round.
+	 */
+	unsigned                       fl_runq_cur;
+	unsigned                       fl_runq_deficit[M0_FOM_CLASS_NR];
 
 	/** Wait list */
 	struct m0_tl		       fl_wail;
@@ -297,12 +326,30 @@ struct m0_fom_locality {
 	struct m0_addb2_mach          *fl_addb2_mach;
 	struct m0_addb2_hist           fl_fom_active;
 	struct m0_addb2_hist           fl_runq_counter;
+	/** Queueing delay (time in run-queue) for each class. */
+	struct m0_addb2_loghist        fl_runq_delay[M0_FOM_CLASS_NR];
 	struct m0_addb2_hist           fl_wail_counter;
 	struct m0_addb2_sensor         fl_clock;
 	struct m0_locality             fl_locality;
 	struct m0_sm_group_addb2       fl_grp_addb2;
 	struct m0_chan_addb2           fl_chan_addb2;
-	/** Something for memory, see set_mempolicy(2). */
+	/**
+	 * Ast posted to a busy locality to request ready foms for this
+	 * locality, when m0_fom_domain::fd_steal is set. See fom_steal().
+	 */
+	struct m0_sm_ast               fl_steal_ast;
+	/** Non-zero while fl_steal_ast is posted and not yet executed. */
+	struct m0_atomic64             fl_steal_pending;
+	/** Counter: steal requests posted by this locality. */
+	struct m0_addb2_counter        fl_steal_try;
+	/** Counter: foms stolen by this locality. */
+	struct m0_addb2_counter        fl_steal_got;
+	/**
+	 * NUMA node of the locality processors. When m0_fom_domain::fd_numa
+	 * is set, memory allocations of locality threads prefer this node
+	 * (see m0_memory_thread_bind()).
+	 */
+	int                            fl_numa_node;
 };
 
 /**
@@ -336,6 +383,22 @@ struct m0_fom_domain {
 	/** Long living foms detecting chore. */
 	struct m0_locality_chore        fd_hung_foms_chore;
 	struct m0_addb2_sys            *fd_addb2_sys;
+	/**
+	 * When true, an idle locality handler steals ready foms of migratable
+	 * types (m0_fom_type::ft_migratable) from busier localities.
+	 *
+	 * Off by default. In user space it is switched on by setting
+	 * M0_FOM_STEAL environment variable.
+	 */
+	bool                            fd_steal;
+	/**
+	 * When true, locality threads allocate memory from the NUMA node of
+	 * their locality, and per-locality buffers are placed on this node.
+	 *
+	 * Off by default. In user space it is switched on by setting
+	 * M0_FOM_NUMA environment variable.
+	 */
+	bool                            fd_numa;
 };
 
 /** Operations vector attached to a domain. */
@@ -515,6 +578,8 @@ struct m0_fom {
 	/** Counter of transitions, used to ensure FOM was inactive,
 	    while waiting for a longlock. */
 	unsigned                  fo_transitions_saved;
+	/** Time when the fom was last put in a run-queue. */
+	m0_time_t                 fo_ready_at;
 
 	/** State machine for generic and specfic FOM phases.
 	    sm_rc contains result of fom execution, -errno on failure.
@@ -615,6 +680,15 @@ struct m0_fom_type {
 	      struct m0_sm_conf            ft_conf;
 	      struct m0_sm_conf            ft_state_conf;
 	const struct m0_reqh_service_type *ft_rstype;
+	/**
+	 * True iff foms of this type can be moved to a different locality by
+	 * work stealing (m0_fom_domain::fd_steal) before they start
+	 * execution. Only set this for types that do not depend on
+	 * m0_fom_ops::fo_home_locality() for correctness.
+	 */
+	bool                               ft_migratable;
+	/** Scheduling class of foms of this type. */
+	enum m0_fom_class                  ft_class;
 };
 
 /**
@@ -38,6 +38,11 @@ static char                    g_mem[8 * (1 << 20)];
 static struct m0_mutex        *g_mutexes;
 static size_t                  g_mutexes_nr;
 static struct m0_long_lock     g_long_lock;
+/* If true, all FOMs are queued to the first locality. */
+static bool                    g_skewed;
+/* Per-locality memory for SC_MEM_LOC scenario. */
+static char                  **g_loc_mem;
+static size_t                  g_loc_nr;
 
 /** Benchmark presets. */
 enum {
@@ -52,6 +57,9 @@ enum {
 
 	/** The number of cpu_utilize() iterations for SC_MEM_B scenario. */
 	ST_CYCLES_BYTES   = ST_CYCLES_DEFAULT * 20,
+
+	/** Size of per-locality memory for SC_MEM_LOC scenario. */
+	ST_LOC_MEM_SIZE   = 1 << 20,
 };
 
 /** Types of benchmarks. */
@@ -77,6 +85,9 @@ enum scenario {
 	/** Calling m0_fom_block_{enter,leave}(). */
 	SC_BLOCK,
 
+	/** Accessing megabytes of memory owned by the current locality. */
+	SC_MEM_LOC,
+
 	SC_NR
 };
 
@@ -200,7 +211,7 @@ static size_t mem_mask(enum scenario test)
 {
 	if (test == SC_MEM_B)
 		return 0xff;    /* 256 bytes max */
-	else if (test == SC_MEM_MB)
+	else if (test == SC_MEM_MB || test == SC_MEM_LOC)
 		return 0xfffff; /* 1 MB max */
 	else
 		return 0xffff;  /* 64 KB max */
@@ -215,6 +226,8 @@ static size_t cycles(enum scenario test)
 static void cpu_utilize(const struct ub_fom *mach)
 {
 	volatile char x M0_UNUSED;
+	char         *mem   = g_mem;
+	size_t        size  = ARRAY_SIZE(g_mem);
 	size_t        left;
 	size_t        start;
 	size_t        len;
@@ -222,22 +235,26 @@ static void cpu_utilize(const struct ub_fom *mach)
 
 	M0_PRE(0 <= mach->uf_test && mach->uf_test < SC_NR);
 
-	start = mach->uf_seqn % ARRAY_SIZE(g_mem);
-	len = min_check(ARRAY_SIZE(g_mem) - start,
-			start & mem_mask(mach->uf_test));
-	M0_ASSERT(start + len <= ARRAY_SIZE(g_mem));
+	if (mach->uf_test == SC_MEM_LOC) {
+		M0_ASSERT(mach->uf_gen.fo_loc_idx < g_loc_nr);
+		mem  = g_loc_mem[mach->uf_gen.fo_loc_idx];
+		size = ST_LOC_MEM_SIZE;
+	}
+	start = mach->uf_seqn % size;
+	len = min_check(size - start, start & mem_mask(mach->uf_test));
+	M0_ASSERT(start + len <= size);
 
 	for (left = cycles(mach->uf_test); left > 0; --left) {
 		for (i = start; i < start + len; ++i) {
 			switch (mach->uf_seqn % 3) {
 			case 0:
-				g_mem[i] = (char)i; /* write */
+				mem[i] = (char)i; /* write */
 				break;
 			case 1:
-				x = g_mem[i];       /* read */
+				x = mem[i];       /* read */
 				break;
 			default:
-				++g_mem[i];         /* read and write */
+				++mem[i];         /* read and write */
 			}
 		}
 	}
@@ -250,7 +267,8 @@ static int (*ticks[SC_NR])(struct m0_fom *fom) = {
 	[SC_MUTEX]         = mutex_tick,
 	[SC_MUTEX_PER_CPU] = mutex_per_cpu_tick,
 	[SC_LONG_LOCK]     = long_lock_tick,
-	[SC_BLOCK]         = block_tick
+	[SC_BLOCK]         = block_tick,
+	[SC_MEM_LOC]       = mem_tick
 };
 
 /* ----------------------------------------------------------------
@@ -333,7 +351,7 @@ static size_t ub_fom_home_locality(const struct m0_fom *fom)
 	static size_t locality = 0;
 
 	M0_PRE(fom != NULL);
-	return locality++;
+	return g_skewed ? 0 : locality++;
 }
 
 static const struct m0_fom_ops ub_fom_ops = {
@@ -406,8 +424,52 @@ _UB_ROUND_DEFINE(ub_fom_long_lock,     SC_LONG_LOCK);
 #ifndef ENABLE_PROFILER
 _UB_ROUND_DEFINE(ub_fom_block,         SC_BLOCK);
 #endif
+_UB_ROUND_DEFINE(ub_fom_mem_loc,       SC_MEM_LOC);
 
 #undef _UB_ROUND_DEFINE
+
+/**
+ * Skewed load: all FOMs are queued to one locality, the others are idle
+ * unless they steal work (m0_fom_domain::fd_steal).
+ */
+static void skewed_test(bool steal)
+{
+	struct m0_fom_domain *dom = m0_fom_dom();
+	bool                  orig = dom->fd_steal;
+
+	g_skewed = true;
+	dom->fd_steal = steal;
+	reqh_test(&g_reqh, SC_MEM_KB);
+	dom->fd_steal = orig;
+	g_skewed = false;
+}
+
+static void ub_fom_skewed(int iter)
+{
+	skewed_test(false);
+}
+
+static void ub_fom_skewed_steal(int iter)
+{
+	skewed_test(true);
+}
+
+/**
+ * Moves per-locality memory to the NUMA nodes of localities. Memory was
+ * allocated and touched by _init() thread, so before this round it is
+ * placed on a single node.
+ */
+static void ub_fom_numa_bind(int iter)
+{
+	struct m0_fom_domain *dom = m0_fom_dom();
+	size_t                i;
+
+	for (i = 0; i < g_loc_nr; ++i) {
+		if (m0_memory_bind(g_loc_mem[i], ST_LOC_MEM_SIZE,
+				   dom->fd_localities[i]->fl_numa_node) != 0)
+			M0_LOG(M0_WARN, "Cannot bind locality memory.");
+	}
+}
 
 /* ---------------------------------------------------------------- */
 
@@ -421,6 +483,7 @@ static int _init(const char *opts M0_UNUSED)
 
 	m0_fom_type_init(&ub_fom_type, M0_UB_FOM_OPCODE,
 			 &ub_fom_type_ops, &ub_fom_stype, &m0_generic_conf);
+	ub_fom_type.ft_migratable = true;
 
 	/* This benchmark doesn't need network, database and some other
 	 * subsystems for its operation.  Simplistic initialisation
@@ -443,6 +506,16 @@ static int _init(const char *opts M0_UNUSED)
 	for (i = 0; i < ARRAY_SIZE(g_mem); ++i)
 		g_mem[i] = (char)i; /* dummy values */
 
+	g_loc_nr = m0_reqh_nr_localities(&g_reqh);
+	M0_ALLOC_ARR(g_loc_mem, g_loc_nr);
+	M0_UB_ASSERT(g_loc_mem != NULL);
+	for (i = 0; i < g_loc_nr; ++i) {
+		g_loc_mem[i] = m0_alloc_aligned(ST_LOC_MEM_SIZE,
+						m0_pageshift_get());
+		M0_UB_ASSERT(g_loc_mem[i] != NULL);
+		memset(g_loc_mem[i], (int)i, ST_LOC_MEM_SIZE);
+	}
+
 	g_mutexes_nr = m0_reqh_nr_localities(&g_reqh);
 	M0_ALLOC_ARR(g_mutexes, g_mutexes_nr);
 	M0_UB_ASSERT(g_mutexes != NULL);
@@ -461,6 +534,10 @@ static void _fini(void)
 	for (i = 0; i < g_mutexes_nr; ++i)
 		m0_mutex_fini(&g_mutexes[i]);
 	m0_free(g_mutexes);
+	for (i = 0; i < g_loc_nr; ++i)
+		m0_free_aligned(g_loc_mem[i], ST_LOC_MEM_SIZE,
+				m0_pageshift_get());
+	m0_free(g_loc_mem);
 
 	m0_reqh_service_prepare_to_stop(g_svc);
 	m0_reqh_shutdown_wait(&g_reqh);
@@ -499,6 +576,21 @@ struct m0_ub_set m0_fom_ub = {
 		  .ub_iter  = 1,
 		  .ub_round = ub_fom_block },
 #endif
+		{ .ub_name  = "skewed",
+		  .ub_iter  = 1,
+		  .ub_round = ub_fom_skewed },
+		{ .ub_name  = "skewed-steal",
+		  .ub_iter  = 1,
+		  .ub_round = ub_fom_skewed_steal },
+		{ .ub_name  = "mem-locality",
+		  .ub_iter  = 1,
+		  .ub_round = ub_fom_mem_loc },
+		{ .ub_name  = "numa-bind",
+		  .ub_iter  = 1,
+		  .ub_round = ub_fom_numa_bind },
+		{ .ub_name  = "mem-locality-bound",
+		  .ub_iter  = 1,
+		  .ub_round = ub_fom_mem_loc },
 		{ .ub_name = NULL}
 	}
 };
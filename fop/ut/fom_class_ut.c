@@ -0,0 +1,340 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2021 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include "lib/memory.h"
+#include "lib/semaphore.h"
+#include "lib/time.h"
+#include "rpc/rpc_opcodes.h"
+#include "fop/fom.h"
+#include "reqh/reqh.h"
+#include "reqh/reqh_service.h"
+#include "ut/ut.h"
+
+/*
+ * Tests of fom scheduling classes: deficit round-robin between the
+ * foreground and background run-queues and the bounded hold-back of
+ * background foms, see fom_dequeue() and runq_is_eligible().
+ */
+
+enum {
+	/* Must match fom_class_weight[] in fop/fom.c. */
+	FC_WEIGHT_FG    = 8,
+	/* Must match RUNQ_BG_THROTTLE in fop/fom.c. */
+	FC_BG_THROTTLE  = 32,
+	/* Must match RUNQ_BG_DELAY_MAX in fop/fom.c. */
+	FC_BG_DELAY_MAX = 10 * M0_TIME_ONE_MSEC,
+	FC_FOM_MAX      = 2 * FC_BG_THROTTLE + 1,
+};
+
+static struct m0_sm_state_descr fc_fom_phases[] = {
+	[M0_FOM_PHASE_INIT] = {
+		.sd_flags   = M0_SDF_INITIAL,
+		.sd_name    = "init",
+		.sd_allowed = M0_BITS(M0_FOM_PHASE_FINISH)
+	},
+	[M0_FOM_PHASE_FINISH] = {
+		.sd_name    = "finish",
+		.sd_flags   = M0_SDF_TERMINAL,
+	}
+};
+
+static struct m0_sm_conf fc_sm_conf = {
+	.scf_name      = "fc_fom",
+	.scf_nr_states = ARRAY_SIZE(fc_fom_phases),
+	.scf_state     = fc_fom_phases,
+};
+
+struct fc_fom {
+	struct m0_fom fc_fom;
+	/* Time spent in the tick, to keep the foreground run-queue long. */
+	m0_time_t     fc_tick_time;
+	/* The fom holds the locality handler until fc_gate_open is up. */
+	bool          fc_gate;
+};
+
+static struct m0_fom_type       fc_fomt[M0_FOM_CLASS_NR];
+static struct m0_reqh           fcreqh;
+static struct m0_reqh_service  *fcsvc;
+static struct m0_semaphore      fc_done;
+static struct m0_semaphore      fc_gate_entered;
+static struct m0_semaphore      fc_gate_open;
+
+/* Classes of foms in the order of their execution, and execution times. */
+static enum m0_fom_class        fc_order[FC_FOM_MAX];
+static m0_time_t                fc_time[FC_FOM_MAX];
+static int                      fc_nr;
+
+static void   fc_fom_fini(struct m0_fom *fom);
+static int    fc_fom_tick(struct m0_fom *fom);
+static size_t fc_fom_home_locality(const struct m0_fom *fom);
+
+static const struct m0_fom_ops fc_fom_ops = {
+	.fo_fini          = fc_fom_fini,
+	.fo_tick          = fc_fom_tick,
+	.fo_home_locality = fc_fom_home_locality
+};
+
+static const struct m0_fom_type_ops fc_fom_type_ops = {
+	.fto_create = NULL
+};
+
+static int fcsvc_start(struct m0_reqh_service *svc)
+{
+	return 0;
+}
+
+static void fcsvc_stop(struct m0_reqh_service *svc)
+{
+}
+
+static void fcsvc_fini(struct m0_reqh_service *svc)
+{
+	m0_free(svc);
+}
+
+static const struct m0_reqh_service_ops fcsvc_ops = {
+	.rso_start_async = &m0_reqh_service_async_start_simple,
+	.rso_start       = &fcsvc_start,
+	.rso_stop        = &fcsvc_stop,
+	.rso_fini        = &fcsvc_fini
+};
+
+static int fcsvc_type_allocate(struct m0_reqh_service            **svc,
+			       const struct m0_reqh_service_type  *stype)
+{
+	M0_ALLOC_PTR(*svc);
+	M0_UT_ASSERT(*svc != NULL);
+	(*svc)->rs_type = stype;
+	(*svc)->rs_ops = &fcsvc_ops;
+	return 0;
+}
+
+static const struct m0_reqh_service_type_ops fcsvc_type_ops = {
+	.rsto_service_allocate = &fcsvc_type_allocate
+};
+
+static struct m0_reqh_service_type ut_fc_service_type = {
+	.rst_name     = "fc_ut",
+	.rst_ops      = &fcsvc_type_ops,
+	.rst_level    = M0_RS_LEVEL_NORMAL,
+	.rst_typecode = M0_CST_DS1
+};
+
+static size_t fc_fom_home_locality(const struct m0_fom *fom)
+{
+	return 1;
+}
+
+static int fc_fom_tick(struct m0_fom *fom0)
+{
+	struct fc_fom *fom = M0_AMB(fom, fom0, fc_fom);
+
+	if (fom->fc_gate) {
+		m0_semaphore_up(&fc_gate_entered);
+		m0_semaphore_down(&fc_gate_open);
+		m0_fom_phase_set(fom0, M0_FOM_PHASE_FINISH);
+		return M0_FSO_WAIT;
+	}
+	M0_UT_ASSERT(fc_nr < ARRAY_SIZE(fc_order));
+	fc_order[fc_nr] = fom0->fo_type->ft_class;
+	fc_time[fc_nr]  = m0_time_now();
+	++fc_nr;
+	if (fom->fc_tick_time != 0)
+		m0_nanosleep(fom->fc_tick_time, NULL);
+	m0_fom_phase_set(fom0, M0_FOM_PHASE_FINISH);
+	return M0_FSO_WAIT;
+}
+
+static void fc_fom_fini(struct m0_fom *fom0)
+{
+	struct fc_fom *fom = M0_AMB(fom, fom0, fc_fom);
+
+	m0_fom_fini(fom0);
+	m0_free(fom);
+	m0_semaphore_up(&fc_done);
+}
+
+static void fc_init(void)
+{
+	int rc;
+
+	rc = M0_REQH_INIT(&fcreqh,
+			  .rhia_dtm     = (void *)1,
+			  .rhia_mdstore = (void *)1,
+			  .rhia_fid     = &g_process_fid);
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_reqh_service_allocate(&fcsvc, &ut_fc_service_type, NULL);
+	M0_UT_ASSERT(rc == 0);
+	m0_reqh_service_init(fcsvc, &fcreqh, NULL);
+	m0_reqh_service_start(fcsvc);
+	m0_reqh_start(&fcreqh);
+	m0_semaphore_init(&fc_done, 0);
+	m0_semaphore_init(&fc_gate_entered, 0);
+	m0_semaphore_init(&fc_gate_open, 0);
+	fc_nr = 0;
+}
+
+static void fc_fini(void)
+{
+	m0_semaphore_fini(&fc_gate_open);
+	m0_semaphore_fini(&fc_gate_entered);
+	m0_semaphore_fini(&fc_done);
+	m0_reqh_service_prepare_to_stop(fcsvc);
+	m0_reqh_idle_wait_for(&fcreqh, fcsvc);
+	m0_reqh_service_stop(fcsvc);
+	m0_reqh_service_fini(fcsvc);
+	m0_reqh_services_terminate(&fcreqh);
+	m0_reqh_fini(&fcreqh);
+}
+
+static void fc_fom_queue(enum m0_fom_class cl, m0_time_t tick_time, bool gate)
+{
+	struct fc_fom *fom;
+
+	M0_ALLOC_PTR(fom);
+	M0_UT_ASSERT(fom != NULL);
+	fom->fc_tick_time = tick_time;
+	fom->fc_gate      = gate;
+	m0_fom_init(&fom->fc_fom, &fc_fomt[cl], &fc_fom_ops, NULL, NULL,
+		    &fcreqh);
+	m0_fom_queue(&fom->fc_fom);
+}
+
+/**
+ * Queues @fg_nr foreground and @bg_nr background foms, so that all of them
+ * are in the run-queues before the first one is dequeued, and waits until
+ * they are executed.
+ *
+ * The locality handler keeps the group locked, so the run-queues are filled
+ * while a gate fom holds the handler: m0_fom_queue() posts asts, which are all
+ * executed by the handler before it dequeues the next fom.
+ */
+static void fc_run(int fg_nr, int bg_nr, m0_time_t fg_tick_time,
+		   m0_time_t *queued)
+{
+	int i;
+
+	M0_PRE(fg_nr + bg_nr <= FC_FOM_MAX);
+
+	fc_fom_queue(M0_FOM_CLASS_FOREGROUND, 0, true);
+	m0_semaphore_down(&fc_gate_entered);
+	for (i = 0; i < fg_nr; ++i)
+		fc_fom_queue(M0_FOM_CLASS_FOREGROUND, fg_tick_time, false);
+	for (i = 0; i < bg_nr; ++i)
+		fc_fom_queue(M0_FOM_CLASS_BACKGROUND, 0, false);
+	*queued = m0_time_now();
+	m0_semaphore_up(&fc_gate_open);
+	for (i = 0; i < fg_nr + bg_nr + 1; ++i)
+		m0_semaphore_down(&fc_done);
+	M0_UT_ASSERT(fc_nr == fg_nr + bg_nr);
+}
+
+/*
+ * While both run-queues are not empty and the foreground one is short,
+ * exactly FC_WEIGHT_FG foreground foms are executed between background ones.
+ */
+static void drr_ratio(void)
+{
+	enum { BG_NR = 3, FG_NR = BG_NR * FC_WEIGHT_FG };
+	m0_time_t queued;
+	int       fg = 0;
+	int       bg = 0;
+	int       i;
+
+	M0_CASSERT((int)FG_NR < (int)FC_BG_THROTTLE);
+	fc_init();
+	fc_run(FG_NR, BG_NR, 0, &queued);
+	for (i = 0; i < fc_nr; ++i) {
+		if (fc_order[i] == M0_FOM_CLASS_FOREGROUND) {
+			++fg;
+			continue;
+		}
+		/* The first round may start with a partial deficit. */
+		M0_UT_ASSERT(bg == 0 ? fg <= FC_WEIGHT_FG :
+			     fg == FC_WEIGHT_FG);
+		fg = 0;
+		++bg;
+	}
+	M0_UT_ASSERT(bg == BG_NR);
+	fc_fini();
+}
+
+/*
+ * A background fom is held back while the foreground run-queue is long, but
+ * only for FC_BG_DELAY_MAX: it is executed while the foreground run-queue is
+ * still above the throttle.
+ */
+static void bg_delay(void)
+{
+	enum { FG_NR = 2 * FC_BG_THROTTLE };
+	m0_time_t queued;
+	int       i;
+
+	fc_init();
+	fc_run(FG_NR, 1, M0_TIME_ONE_MSEC, &queued);
+	for (i = 0; i < fc_nr; ++i) {
+		if (fc_order[i] == M0_FOM_CLASS_BACKGROUND)
+			break;
+	}
+	M0_UT_ASSERT(i < fc_nr);
+	/* Held back ... */
+	M0_UT_ASSERT(m0_time_sub(fc_time[i], queued) >= FC_BG_DELAY_MAX);
+	/* ... but not until the foreground run-queue became short. */
+	M0_UT_ASSERT(FG_NR - i >= FC_BG_THROTTLE);
+	fc_fini();
+}
+
+static int fc_suite_init(void)
+{
+	m0_fom_type_init(&fc_fomt[M0_FOM_CLASS_FOREGROUND],
+			 M0_UT_FOM_CLASS_FG_OPCODE, &fc_fom_type_ops,
+			 &ut_fc_service_type, &fc_sm_conf);
+	m0_fom_type_init(&fc_fomt[M0_FOM_CLASS_BACKGROUND],
+			 M0_UT_FOM_CLASS_BG_OPCODE, &fc_fom_type_ops,
+			 &ut_fc_service_type, &fc_sm_conf);
+	fc_fomt[M0_FOM_CLASS_BACKGROUND].ft_class = M0_FOM_CLASS_BACKGROUND;
+	return 0;
+}
+
+struct m0_ut_suite fom_class_ut = {
+	.ts_name = "fom-class-ut",
+	.ts_init = fc_suite_init,
+	.ts_fini = NULL,
+	.ts_tests = {
+		{ "drr-ratio", drr_ratio },
+		{ "bg-delay",  bg_delay  },
+		{ NULL, NULL }
+	}
+};
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
@@ -1287,6 +1287,17 @@ out:
 	M0_LEAVE();
 	return M0_FSO_AGAIN;
 }
+
+/**
+ * Returns the colour of network buffers used by an io fom: buffers are
+ * coloured by the fom locality, so that they stay on the locality NUMA node
+ * (see m0_ios_create_buffer_pool()).
+ */
+static uint32_t io_fom_colour(const struct m0_fom *fom)
+{
+	return fom->fo_loc_idx;
+}
+
 /**
  * Acquire network buffers.
  * Gets as many network buffer as it can to process io request.
@@ -1346,7 +1357,7 @@ static int net_buffer_acquire(struct m0_fom *fom)
 		M0_ASSERT(bpdesc != NULL);
 		fom_obj->fcrw_bp = pool = &bpdesc->rios_bp;
 	}
-	colour = m0_net_tm_colour_get(tm);
+	colour = io_fom_colour(fom);
 
 	acquired_net_bufs = netbufs_tlist_length(&fom_obj->fcrw_netbuf_list);
 	required_net_bufs = fom_obj->fcrw_ndesc - fom_obj->fcrw_curr_desc_index;
@@ -1452,9 +1463,7 @@ static int nbuf_release_done(struct m0_fom *fom, int still_required)
 	uint32_t                  colour;
 	int                       acquired;
 	int                       released = 0;
-	struct m0_fop             *fop;
 	struct m0_io_fom_cob_rw   *fom_obj;
-	struct m0_net_transfer_mc *tm;
 
 	M0_PRE(fom != NULL);
 	M0_PRE(m0_is_read_fop(fom->fo_fop) || m0_is_write_fop(fom->fo_fop));
@@ -1466,9 +1475,7 @@ static int nbuf_release_done(struct m0_fom *fom, int still_required)
 	M0_ASSERT(m0_io_fom_cob_rw_invariant(fom_obj));
 	M0_ASSERT(fom_obj->fcrw_bp != NULL);
 
-	fop    = fom->fo_fop;
-	tm     = m0_fop_tm_get(fop);
-	colour = m0_net_tm_colour_get(tm);
+	colour = io_fom_colour(fom);
 
 	M0_INVARIANT_EX(m0_tlist_invariant(&netbufs_tl,
 					   &fom_obj->fcrw_netbuf_list));
@@ -2400,7 +2407,6 @@ static void m0_io_fom_cob_rw_fini(struct m0_fom *fom)
 	struct m0_io_fom_cob_rw   *fom_obj;
 	struct m0_reqh_io_service *serv_obj;
 	struct m0_net_buffer      *nb;
-	struct m0_net_transfer_mc *tm;
 	struct m0_stob_io_desc    *stio_desc;
 	struct m0_fop_cob_rw      *rw;
 
@@ -2435,8 +2441,7 @@ static void m0_io_fom_cob_rw_fini(struct m0_fom *fom)
                      M0_AVI_IOS_IO_ATTR_FOMCRW_BYTES,
                      fom_obj->fcrw_count << fom_obj->fcrw_bshift);
 
-	tm     = m0_fop_tm_get(fop);
-	colour = m0_net_tm_colour_get(tm);
+	colour = io_fom_colour(fom);
 
 	if (fom_obj->fcrw_bp != NULL) {
 		M0_INVARIANT_EX(m0_tlist_invariant(&netbufs_tl,
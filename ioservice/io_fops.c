@@ -423,6 +423,16 @@ M0_INTERNAL int m0_ioservice_fop_init(void)
 			 .opcode    = M0_IOSERVICE_COB_SETATTR_REP_OPCODE,
 			 .xt        = m0_fop_cob_setattr_reply_xc,
 			 .rpc_flags = M0_RPC_ITEM_TYPE_REPLY);
+#ifndef __KERNEL__
+	/*
+	 * The home locality of a read or write fom (a hash of the cob fid) only
+	 * spreads the load. Locality-bound resources (network buffers coloured
+	 * by io_fom_colour(), transactions) are taken when the fom runs, so an
+	 * idle locality can take over a fom that has not started.
+	 */
+	m0_fop_cob_readv_fopt.ft_fom_type.ft_migratable  = true;
+	m0_fop_cob_writev_fopt.ft_fom_type.ft_migratable = true;
+#endif
 
 	return  m0_fop_type_addb2_instrument(&m0_fop_cob_readv_fopt)   ?:
 		m0_fop_type_addb2_instrument(&m0_fop_cob_writev_fopt)  ?:
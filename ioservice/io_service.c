@@ -199,6 +199,22 @@ M0_INTERNAL bool m0_reqh_io_service_invariant(const struct m0_reqh_io_service
  *
  * @pre service != NULL
  */
+/**
+ * Places buffers of each colour on the NUMA node of the corresponding
+ * locality.
+ */
+static void ios_buffer_pool_numa_set(struct m0_net_buffer_pool *bp)
+{
+	struct m0_fom_domain *dom = m0_fom_dom();
+	uint32_t              i;
+
+	for (i = 0; i < bp->nbp_colours_nr && i < dom->fd_localities_nr; ++i) {
+		if (m0_net_buffer_pool_colour_node_set(bp, i,
+				dom->fd_localities[i]->fl_numa_node) != 0)
+			break;
+	}
+}
+
 M0_INTERNAL int m0_ios_create_buffer_pool(struct m0_reqh_service *service)
 {
 	int                         nbuffs;
@@ -233,7 +249,8 @@ M0_INTERNAL int m0_ios_create_buffer_pool(struct m0_reqh_service *service)
 		newbp->rios_ndom = rpcmach->rm_tm.ntm_dom;
 		newbp->rios_bp_magic = M0_IOS_BUFFER_POOL_MAGIC;
 
-		colours = m0_list_length(&newbp->rios_ndom->nd_tms);
+		/* Buffers are coloured by locality, see io_fom_colour(). */
+		colours = m0_reqh_nr_localities(reqh);
 
 		segment_size = m0_net_domain_get_max_buffer_segment_size(
 							      newbp->rios_ndom);
@@ -261,6 +278,8 @@ M0_INTERNAL int m0_ios_create_buffer_pool(struct m0_reqh_service *service)
 
 		/* Pre-allocate network buffers */
 		m0_net_buffer_pool_lock(&newbp->rios_bp);
+		if (m0_fom_dom()->fd_numa)
+			ios_buffer_pool_numa_set(&newbp->rios_bp);
 		nbuffs = m0_net_buffer_pool_provision(&newbp->rios_bp,
 						      ios_net_buffer_pool_size);
 		m0_net_buffer_pool_unlock(&newbp->rios_bp);
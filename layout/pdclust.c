@@ -48,7 +48,8 @@
  *
  * Once permutation's Lehmer code is generated, it has to be applied to the set
  * of columns. permute() function applies a permutation, simultaneously building
- * an inverse permutation.
+ * an inverse permutation. Permutations of the few most recently used tiles are
+ * cached in the instance (tile_get()).
  *
  * Finally, layout mapping function is defined in terms of conversions between
  * matrices of different shapes. Let's call a matrix having M columns and an
@@ -155,15 +156,19 @@ static bool pdclust_instance_invariant(const struct m0_pdclust_instance *pi)
 	pl = bob_of(pi->pi_base.li_l, struct m0_pdclust_layout,
 		    pl_base.sl_base, &pdclust_bob);
 	P  = pl->pl_attr.pa_P;
-	tc = &pi->pi_tile_cache;
+	tc = pi->pi_tile_last;
 
 	return
 		m0_pdclust_instance_bob_check(pi) &&
 		m0_layout__instance_invariant(&pi->pi_base) &&
 		pdclust_invariant(pl) &&
+		pi->pi_tile_last >= pi->pi_tile_cache &&
+		pi->pi_tile_last < pi->pi_tile_cache +
+				   ARRAY_SIZE(pi->pi_tile_cache) &&
 		/*
 		 * tc->tc_permute[] and tc->tc_inverse[] are mutually inverse
-		 * bijections of {0, ..., P - 1}.
+		 * bijections of {0, ..., P - 1}. Only the most recently used
+		 * entry is checked, to keep the invariant O(P).
 		 */
 		m0_forall(i, P,
 			  tc->tc_lcode[i] + i < P &&
@@ -594,26 +599,34 @@ static void m_dec(uint64_t width, uint64_t pos, uint64_t *row, uint64_t *column)
 	*column = pos % width;
 }
 
+static inline uint32_t lowbit(uint32_t x)
+{
+	return x & (~x + 1);
+}
+
 /**
- * Apply a permutation given by its Lehmer code in k[] to a set s[] of n
- * elements and build inverse permutation in r[].
+ * Apply a permutation given by its Lehmer code in k[] to the set of n elements
+ * {0, ..., n - 1}, building it in s[], and build inverse permutation in r[].
  *
- * @param n - number of elements in k[], s[] and r[]
- * @param k - Lehmer code of the permutation
- * @param s - an array to permute
- * @param r - an array to build inverse permutation in
+ * @param n    - number of elements in k[], s[] and r[]
+ * @param k    - Lehmer code of the permutation
+ * @param s    - an array to build the permutation in
+ * @param r    - an array to build inverse permutation in
+ * @param tree - scratch array of n + 1 elements
  *
  * @pre  m0_forall(i, n, k[i] + i < n)
- * @pre  m0_forall(i, n, s[i] < n && ergo(s[i] == s[j], i == j))
  * @post m0_forall(i, n, s[i] < n && ergo(s[i] == s[j], i == j))
  * @post m0_forall(i, n, s[r[i]] == i && r[s[i]] == i)
  */
-static void permute(uint32_t n, uint32_t *k, uint32_t *s, uint32_t *r)
+static void permute(uint32_t n, const uint32_t *k, uint32_t *s, uint32_t *r,
+		    uint32_t *tree)
 {
 	uint32_t i;
 	uint32_t j;
-	uint32_t t;
-	uint32_t x;
+	uint32_t pos;
+	uint32_t rem;
+	uint32_t step;
+	uint32_t top;
 
 	/*
 	 * k[0] is an index of one of the n elements that permutation moves to
@@ -622,27 +635,91 @@ static void permute(uint32_t n, uint32_t *k, uint32_t *s, uint32_t *r)
 	 * k[1] is an index of one of the (n - 1) remaining elements that
 	 * permutation moves to the 1-st position in s[], etc.
 	 *
-	 * To produce i-th element of s[], pick one of remaining elements, say
-	 * s[t], as specified by k[i], shift elements s[i] ... s[t] to the right
-	 * by one and place s[t] in s[i]. This guarantees that at beginning of
-	 * the loop elements s[0] ... s[i - 1] are already selected and elements
-	 * s[i] ... s[n - 1] are "remaining".
+	 * Remaining elements are kept in increasing order, so s[i] is the
+	 * k[i]-th smallest of the elements not selected yet. Instead of keeping
+	 * remaining elements in an array and shifting them on every selection,
+	 * which is O(n^2), count them in a Fenwick tree: tree[j] is the number
+	 * of remaining elements among {j - lowbit(j), ..., j - 1}. The k-th
+	 * remaining element is found by descending the tree in O(log n) steps.
 	 */
+	for (j = 1; j <= n; ++j)
+		tree[j] = lowbit(j);
+	for (top = 1; top <= n / 2; top *= 2)
+		;
+	for (i = 0; i < n; ++i) {
+		M0_ASSERT(k[i] + i < n);
+		/*
+		 * Find the largest pos, such that fewer than k[i] + 1
+		 * elements less than pos remain: pos is then the element.
+		 */
+		pos = 0;
+		rem = k[i] + 1;
+		for (step = top; step > 0; step /= 2) {
+			if (pos + step <= n && tree[pos + step] < rem) {
+				pos += step;
+				rem -= tree[pos];
+			}
+		}
+		M0_ASSERT(pos < n);
+		s[i]   = pos;
+		r[pos] = i;
+		for (j = pos + 1; j <= n; j += lowbit(j))
+			--tree[j];
+	}
+}
+
+/** Builds column permutation for tile omega in the given cache entry. */
+static void tile_build(struct m0_pdclust_instance *pi, struct tile_cache *tc,
+		       uint64_t omega)
+{
+	struct m0_pdclust_attr  attr = pi_to_pl(pi)->pl_attr;
+	struct m0_fid          *gfid = &pi->pi_base.li_gfid;
+	uint64_t                rstate;
+	uint32_t                i;
+
+	/* Initialise PRNG. */
+	rstate = m0_hash(attr.pa_seed.u_hi + gfid->f_key) ^
+		 m0_hash(attr.pa_seed.u_lo + omega + gfid->f_container);
+
+	/* Generate permutation number in lexicographic ordering. */
+	for (i = 0; i < attr.pa_P - 1; ++i)
+		tc->tc_lcode[i] = m0_rnd(attr.pa_P - i, &rstate);
+	tc->tc_lcode[attr.pa_P - 1] = 0;
+
+	/* Apply the permutation. */
+	permute(attr.pa_P, tc->tc_lcode, tc->tc_permute, tc->tc_inverse,
+		pi->pi_tile_tree);
+	tc->tc_tile_no = omega;
+}
+
+/**
+ * Returns the tile cache entry for tile omega, building it in place of the
+ * least recently used entry if necessary.
+ */
+static struct tile_cache *tile_get(struct m0_pdclust_instance *pi,
+				   uint64_t omega)
+{
+	struct tile_cache *tc = pi->pi_tile_last;
+	struct tile_cache *lru;
+	uint32_t           i;
 
-	for (i = 0; i < n - 1; ++i) {
-		t = k[i] + i;
-		M0_ASSERT(t < n);
-		x = s[t];
-		for (j = t; j > i; --j)
-			s[j] = s[j - 1];
-		s[i] = x;
-		r[x] = i;
+	if (tc->tc_tile_no != omega) {
+		lru = &pi->pi_tile_cache[0];
+		for (i = 0; i < ARRAY_SIZE(pi->pi_tile_cache); ++i) {
+			tc = &pi->pi_tile_cache[i];
+			if (tc->tc_tile_no == omega)
+				break;
+			if (tc->tc_used < lru->tc_used)
+				lru = tc;
+		}
+		if (i == ARRAY_SIZE(pi->pi_tile_cache)) {
+			tc = lru;
+			tile_build(pi, tc, omega);
+		}
+		pi->pi_tile_last = tc;
 	}
-	/*
-	 * The loop above iterates n-1 times, because the last element finds its
-	 * place automatically. Complete inverse permutation.
-	 */
-	r[s[n - 1]] = n - 1;
+	tc->tc_used = ++pi->pi_tile_clock;
+	return tc;
 }
 
 /**
@@ -652,47 +729,14 @@ static void permute(uint32_t n, uint32_t *k, uint32_t *s, uint32_t *r)
 static uint64_t permute_column(struct m0_pdclust_instance *pi,
 			       uint64_t omega, uint64_t t)
 {
-	struct tile_cache        *tc;
-	struct m0_pdclust_attr    attr;
-	struct m0_pdclust_layout *pl;
-	struct m0_fid            *gfid;
-
-	pl   = pi_to_pl(pi);
-	attr =  pl->pl_attr;
-	gfid = &pi->pi_base.li_gfid;
-
-	M0_ENTRY("t %lu, P %lu", (unsigned long)t, (unsigned long)attr.pa_P);
-	M0_ASSERT(t < attr.pa_P);
-	tc = &pi->pi_tile_cache;
-
-	/* If cached values are for different tile, update the cache. */
-	if (tc->tc_tile_no != omega) {
-		uint32_t i;
-		uint64_t rstate;
-
-		/* Initialise columns array that will be permuted. */
-		for (i = 0; i < attr.pa_P; ++i)
-			tc->tc_permute[i] = i;
-
-		/* Initialise PRNG. */
-		rstate = m0_hash(attr.pa_seed.u_hi + gfid->f_key) ^
-			 m0_hash(attr.pa_seed.u_lo + omega + gfid->f_container);
-
-		/* Generate permutation number in lexicographic ordering. */
-		for (i = 0; i < attr.pa_P - 1; ++i)
-			tc->tc_lcode[i] = m0_rnd(attr.pa_P - i, &rstate);
-
-		/* Apply the permutation. */
-		permute(attr.pa_P, tc->tc_lcode,
-			tc->tc_permute, tc->tc_inverse);
-		tc->tc_tile_no = omega;
-	}
+	struct tile_cache *tc;
+	uint32_t           P = pi_to_pl(pi)->pl_attr.pa_P;
 
-	/**
-	 * @todo Not sure if this should be replaced by an ADDB DP or a M0_LOG.
-	 */
+	M0_ENTRY("t %lu, P %lu", (unsigned long)t, (unsigned long)P);
+	M0_ASSERT(t < P);
+	tc = tile_get(pi, omega);
 
-	M0_POST(tc->tc_permute[t] < attr.pa_P);
+	M0_POST(tc->tc_permute[t] < P);
 	M0_POST(tc->tc_inverse[tc->tc_permute[t]] == t);
 	M0_POST(tc->tc_permute[tc->tc_inverse[t]] == t);
 	return tc->tc_permute[t];
@@ -777,8 +821,7 @@ M0_INTERNAL void m0_pdclust_instance_inv(struct m0_pdclust_instance *pi,
 	 * reverse order.
 	 */
 	m_dec(L, tgt->ta_frame, &omega, &r);
-	permute_column(pi, omega, t); /* Force tile cache update */
-	t = pi->pi_tile_cache.tc_inverse[t];
+	t = tile_get(pi, omega)->tc_inverse[t];
 	m_dec(N + K + S, m_enc(P, r, t), &j, &src->sa_unit);
 	src->sa_group = m_enc(C, omega, j);
 }
@@ -831,6 +874,54 @@ M0_INTERNAL bool m0_pdclust_is_replicated(struct m0_pdclust_layout *play)
 	return play->pl_attr.pa_N == 1;
 }
 
+static void tile_cache_fini(struct m0_pdclust_instance *pi)
+{
+	struct tile_cache *tc;
+	uint32_t           i;
+
+	for (i = 0; i < ARRAY_SIZE(pi->pi_tile_cache); ++i) {
+		tc = &pi->pi_tile_cache[i];
+		m0_free(tc->tc_inverse);
+		m0_free(tc->tc_permute);
+		m0_free(tc->tc_lcode);
+	}
+	m0_free(pi->pi_tile_tree);
+}
+
+static int tile_cache_init(struct m0_pdclust_instance *pi, uint32_t P)
+{
+	struct tile_cache *tc;
+	uint32_t           i;
+
+	M0_ALLOC_ARR(pi->pi_tile_tree, P + 1);
+	if (pi->pi_tile_tree == NULL)
+		return M0_ERR(-ENOMEM);
+	for (i = 0; i < ARRAY_SIZE(pi->pi_tile_cache); ++i) {
+		tc = &pi->pi_tile_cache[i];
+		M0_ALLOC_ARR(tc->tc_lcode, P);
+		M0_ALLOC_ARR(tc->tc_permute, P);
+		M0_ALLOC_ARR(tc->tc_inverse, P);
+		if (tc->tc_lcode == NULL || tc->tc_permute == NULL ||
+		    tc->tc_inverse == NULL)
+			return M0_ERR(-ENOMEM);
+	}
+	pi->pi_tile_last = &pi->pi_tile_cache[0];
+	return 0;
+}
+
+/**
+ * Fills the tile cache with the first tiles of the file, which are the ones
+ * sequential IO starts with.
+ */
+static void tile_cache_fill(struct m0_pdclust_instance *pi)
+{
+	uint32_t i;
+
+	for (i = 0; i < ARRAY_SIZE(pi->pi_tile_cache); ++i)
+		tile_build(pi, &pi->pi_tile_cache[i], i);
+	pi->pi_tile_last = &pi->pi_tile_cache[0];
+}
+
 /**
  * Implementation of lo_instance_build().
  *
@@ -847,7 +938,6 @@ static int pdclust_instance_build(struct m0_layout           *l,
 {
 	struct m0_pdclust_layout   *pl = m0_layout_to_pdl(l);
 	struct m0_pdclust_instance *pi;
-	struct tile_cache          *tc = NULL; /* to keep gcc happy */
 	uint32_t                    N;
 	uint32_t                    K;
 	uint32_t                    P;
@@ -871,19 +961,11 @@ err1_injected:
 		if (rc != 0)
 		return M0_RC(rc);
 
-		tc = &pi->pi_tile_cache;
-
 		if (M0_FI_ENABLED("mem_err2"))
-			{ tc->tc_lcode = NULL; goto err2_injected; }
-		M0_ALLOC_ARR(tc->tc_lcode, P);
-		M0_ALLOC_ARR(tc->tc_permute, P);
-		M0_ALLOC_ARR(tc->tc_inverse, P);
+			{ rc = -ENOMEM; goto err2_injected; }
+		rc = tile_cache_init(pi, P);
 err2_injected:
-		if (tc->tc_lcode != NULL &&
-		    tc->tc_permute != NULL &&
-		    tc->tc_inverse != NULL) {
-			tc->tc_tile_no = 1;
-
+		if (rc == 0) {
 			if (M0_FI_ENABLED("parity_math_err"))
 				{ rc = -EPROTO; goto err3_injected; }
 			if (K > 0 && N != 1)
@@ -894,7 +976,7 @@ err3_injected:
 							&pdclust_instance_ops);
 				m0_pdclust_instance_bob_init(pi);
 				m0_mutex_init(&pi->pi_mutex);
-				permute_column(pi, 0, 0);
+				tile_cache_fill(pi);
 			}
 			else
 				M0_LOG(M0_ERROR, "pi %p, m0_parity_math_init()"
@@ -913,11 +995,8 @@ err3_injected:
 			m0_layout__log("pdclust_instance_build",
 				       "M0_ALLOC() failed",
 				       l->l_id, rc);
-		if (pi != NULL) {
-			m0_free(tc->tc_inverse);
-			m0_free(tc->tc_permute);
-			m0_free(tc->tc_lcode);
-		}
+		if (pi != NULL)
+			tile_cache_fini(pi);
 		m0_free(pi);
 	}
 
@@ -942,9 +1021,7 @@ M0_INTERNAL void pdclust_instance_fini(struct m0_layout_instance *li)
 	m0_layout__instance_fini(&pi->pi_base);
 	m0_mutex_fini(&pi->pi_mutex);
 	m0_pdclust_instance_bob_fini(pi);
-	m0_free(pi->pi_tile_cache.tc_inverse);
-	m0_free(pi->pi_tile_cache.tc_permute);
-	m0_free(pi->pi_tile_cache.tc_lcode);
+	tile_cache_fini(pi);
 	m0_free(pi);
 	M0_LEAVE();
 }
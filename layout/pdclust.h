@@ -162,6 +162,11 @@ struct m0_pdclust_layout {
 	uint64_t                  pl_magic;
 };
 
+enum {
+	/** Number of tiles, permutations of which an instance caches. */
+	M0_PDCLUST_TILE_CACHE_NR = 8
+};
+
 /**
  * Parity de-clustered layout instance for a particular file.
  *
@@ -172,19 +177,27 @@ struct m0_pdclust_instance {
 	/* Super class, storing pointer to the layout being used. */
 	struct m0_layout_instance    pi_base;
 	/**
-	 * Caches information about the most recently used tile.
+	 * Caches information about the recently used tiles.
 	 *
 	 * Some auxiliary data, such as permutations, used by layout mapping
 	 * function is relatively expensive to re-compute. To reduce the
 	 * overhead, such information is cached.
 	 *
-	 * Currently only information for a single tile is cached. More
-	 * sophisticated schemes are possible.
+	 * Information for M0_PDCLUST_TILE_CACHE_NR tiles is cached, the least
+	 * recently used entry is replaced on a miss. Random IO over a file
+	 * hops between tiles, a single entry would be re-computed on almost
+	 * every mapping.
 	 */
 	struct tile_cache {
 		/** Tile to which caches information pertains. */
 		uint64_t  tc_tile_no;
 
+		/**
+		 * Value of m0_pdclust_instance::pi_tile_clock when the entry
+		 * was last used.
+		 */
+		uint64_t  tc_used;
+
 		/**
 		 * Column permutation for this tile.
 		 * This is an array of m0_pdclust_layout::pl_P elements, each
@@ -215,7 +228,17 @@ struct m0_pdclust_instance {
 		 * @see http://en.wikipedia.org/wiki/Lehmer_code
 		 */
 		uint32_t *tc_lcode;
-	} pi_tile_cache;
+	} pi_tile_cache[M0_PDCLUST_TILE_CACHE_NR];
+
+	/** Most recently used entry of pi_tile_cache[]. */
+	struct tile_cache           *pi_tile_last;
+	/** Logical clock, ticks on every tile cache access. */
+	uint64_t                     pi_tile_clock;
+	/**
+	 * Scratch array of m0_pdclust_layout::pl_P + 1 elements, used to
+	 * build permutations.
+	 */
+	uint32_t                    *pi_tile_tree;
 
 	uint64_t                     pi_cache_nr;
 	struct m0_fd_perm_cache     *pi_perm_cache;
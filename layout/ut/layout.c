@@ -27,6 +27,8 @@
 #include "lib/bitstring.h"
 #include "lib/vec.h"
 #include "lib/errno.h"     /* ENOENT */
+#include "lib/arith.h"     /* m0_rnd */
+#include "lib/hash.h"      /* m0_hash */
 
 #define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_LAYOUT
 #include "lib/trace.h"                   /* M0_LOG */
@@ -3760,6 +3762,131 @@ static void test_delete_failure(void)
 #endif /* __KERNEL__ */
 #endif
 
+/*
+ * Wide pool with narrow parity groups: many tiles, each tile permutation is
+ * expensive to build.
+ */
+enum {
+	WIDE_N = 8,
+	WIDE_K = 2,
+	WIDE_S = 2,
+	WIDE_P = 256
+};
+
+struct wide_layout {
+	struct m0_pdclust_layout     *wl_pl;
+	struct m0_layout_linear_enum *wl_enum;
+	struct m0_pool_version        wl_pver;
+	uint64_t                      wl_cache_len[1];
+	struct m0_pdclust_instance   *wl_pi;
+};
+
+static void wide_layout_init(struct wide_layout *wl, uint64_t lid)
+{
+	struct m0_uint128          seed;
+	struct m0_fid              gfid;
+	struct m0_layout_instance *li;
+
+	M0_SET0(wl);
+	m0_uint128_init(&seed, "buildpdclustlayo");
+	rc = m0_pool_init(&pool, &M0_FID_INIT(0, LINEAR_ENUM_ID), 0);
+	M0_UT_ASSERT(rc == 0);
+	rc = pdclust_layout_build(LINEAR_ENUM_ID, lid,
+				  WIDE_N, WIDE_K, WIDE_S, WIDE_P, &seed,
+				  10, 20, &wl->wl_pl, &wl->wl_enum,
+				  !FAILURE_TEST);
+	M0_UT_ASSERT(rc == 0);
+
+	wl->wl_cache_len[0] = 1;
+	wl->wl_pver.pv_fd_tree.ft_cache_info.fci_nr =
+		ARRAY_SIZE(wl->wl_cache_len);
+	wl->wl_pver.pv_fd_tree.ft_cache_info.fci_info = wl->wl_cache_len;
+	m0_pdl_to_layout(wl->wl_pl)->l_pver = &wl->wl_pver;
+
+	m0_fid_set(&gfid, 0, 999);
+	rc = m0_layout_instance_build(m0_pdl_to_layout(wl->wl_pl), &gfid, &li);
+	M0_UT_ASSERT(rc == 0);
+	wl->wl_pi = m0_layout_instance_to_pdi(li);
+}
+
+static void wide_layout_fini(struct wide_layout *wl, uint64_t lid)
+{
+	m0_layout_instance_fini(&wl->wl_pi->pi_base);
+	m0_layout_put(m0_pdl_to_layout(wl->wl_pl));
+	M0_UT_ASSERT(list_lookup(lid) == NULL);
+	m0_pool_fini(&pool);
+}
+
+/*
+ * Permutation of the tile omega, as pdclust computed it before tile cache
+ * and O(P log P) permutation generation were introduced.
+ */
+static void tile_ref(const struct m0_pdclust_instance *pi, uint64_t omega,
+		     uint32_t *perm)
+{
+	const struct m0_pdclust_attr *attr =
+		&m0_layout_to_pdl(pi->pi_base.li_l)->pl_attr;
+	const struct m0_fid          *gfid = &pi->pi_base.li_gfid;
+	uint32_t                      P = attr->pa_P;
+	uint64_t                      rstate;
+	uint32_t                      i;
+	uint32_t                      j;
+	uint32_t                      t;
+	uint32_t                      x;
+
+	rstate = m0_hash(attr->pa_seed.u_hi + gfid->f_key) ^
+		 m0_hash(attr->pa_seed.u_lo + omega + gfid->f_container);
+	for (i = 0; i < P; ++i)
+		perm[i] = i;
+	for (i = 0; i < P - 1; ++i) {
+		t = m0_rnd(P - i, &rstate) + i;
+		x = perm[t];
+		for (j = t; j > i; --j)
+			perm[j] = perm[j - 1];
+		perm[i] = x;
+	}
+}
+
+/*
+ * Maps groups from random tiles, some of them cached, some not, and checks
+ * the result against the reference permutation.
+ */
+static void test_pdclust_tile_cache(void)
+{
+	struct wide_layout         wl;
+	struct m0_pdclust_src_addr src;
+	struct m0_pdclust_src_addr src1;
+	struct m0_pdclust_tgt_addr tgt;
+	uint32_t                   perm[WIDE_P];
+	uint32_t                   W = WIDE_N + WIDE_K + WIDE_S;
+	uint64_t                   rstate = 42;
+	uint64_t                   omega;
+	uint64_t                   pos;
+	uint32_t                   C;
+	uint32_t                   L;
+	uint32_t                   i;
+
+	wide_layout_init(&wl, 12010);
+	C = wl.wl_pl->pl_C;
+	L = wl.wl_pl->pl_L;
+	for (i = 0; i < 500; ++i) {
+		omega = m0_rnd(i % 2 == 0 ? M0_PDCLUST_TILE_CACHE_NR * 2 :
+			       1000000, &rstate);
+		tile_ref(wl.wl_pi, omega, perm);
+		src.sa_group = omega * C + m0_rnd(C, &rstate);
+		for (src.sa_unit = 0; src.sa_unit < W; ++src.sa_unit) {
+			m0_pdclust_instance_map(wl.wl_pi, &src, &tgt);
+			pos = (src.sa_group % C) * W + src.sa_unit;
+			M0_UT_ASSERT(tgt.ta_obj == perm[pos % WIDE_P]);
+			M0_UT_ASSERT(tgt.ta_frame == omega * L + pos / WIDE_P);
+			m0_pdclust_instance_inv(wl.wl_pi, &tgt, &src1);
+			M0_UT_ASSERT(src1.sa_group == src.sa_group &&
+				     src1.sa_unit == src.sa_unit);
+		}
+	}
+	wide_layout_fini(&wl, 12010);
+}
+
 struct m0_ut_suite layout_ut = {
 	.ts_name  = "layout-ut",
 	.ts_owners = "Trupti",
@@ -3789,6 +3916,7 @@ struct m0_ut_suite layout_ut = {
 		{ "layout-pdclust-instance", test_pdclust_instance },
 		{ "layout-pdclust-instance-failure",
 					test_pdclust_instance_failure },
+		{ "layout-pdclust-tile-cache", test_pdclust_tile_cache },
 /*#ifndef __KERNEL__
 		{ "layout-lookup", test_lookup },
 		{ "layout-lookup-failure", test_lookup_failure },
@@ -3804,6 +3932,79 @@ struct m0_ut_suite layout_ut = {
 };
 M0_EXPORTED(layout_ut);
 
+#ifndef __KERNEL__
+enum {
+	UB_ITER   = 100000,
+	UB_GROUPS = 1 << 24
+};
+
+static struct wide_layout ub_wl;
+static uint64_t           ub_rstate;
+
+static int ub_init(const char *opts M0_UNUSED)
+{
+	test_init();
+	wide_layout_init(&ub_wl, 12011);
+	ub_rstate = 42;
+	return 0;
+}
+
+static void ub_fini(void)
+{
+	wide_layout_fini(&ub_wl, 12011);
+	test_fini();
+}
+
+static void ub_map_group(uint64_t group)
+{
+	struct m0_pdclust_src_addr src = { .sa_group = group };
+	struct m0_pdclust_tgt_addr tgt;
+
+	for (src.sa_unit = 0; src.sa_unit < WIDE_N + WIDE_K + WIDE_S;
+	     ++src.sa_unit)
+		m0_pdclust_instance_map(ub_wl.wl_pi, &src, &tgt);
+}
+
+static void ub_map_seq(int i)
+{
+	ub_map_group(i);
+}
+
+/* Random groups from as many tiles as the instance caches. */
+static void ub_map_rand_cached(int i)
+{
+	ub_map_group(m0_rnd(ub_wl.wl_pl->pl_C * M0_PDCLUST_TILE_CACHE_NR,
+			    &ub_rstate));
+}
+
+/* Random groups over a large file: almost every mapping misses. */
+static void ub_map_rand(int i)
+{
+	ub_map_group(m0_rnd(UB_GROUPS, &ub_rstate));
+}
+
+struct m0_ub_set m0_layout_ub = {
+	.us_name = "layout-ub",
+	.us_init = ub_init,
+	.us_fini = ub_fini,
+	.us_run  = {
+		{ .ub_name  = "map-seq",
+		  .ub_iter  = UB_ITER,
+		  .ub_round = ub_map_seq },
+
+		{ .ub_name  = "map-rand-cached",
+		  .ub_iter  = UB_ITER,
+		  .ub_round = ub_map_rand_cached },
+
+		{ .ub_name  = "map-rand",
+		  .ub_iter  = UB_ITER,
+		  .ub_round = ub_map_rand },
+
+		{ .ub_name = NULL }
+	}
+};
+#endif /* __KERNEL__ */
+
 #undef M0_TRACE_SUBSYSTEM
 
 /*
@@ -134,9 +134,9 @@ static void clink_signal(struct m0_clink *clink)
 		if (ca == NULL)
 			consumed = clink->cl_cb(clink);
 		else
-			M0_ADDB2_HIST(ca->ca_cb, &ca->ca_cb_hist,
-				      m0_ptr_wrap(clink->cl_cb),
-				      consumed = clink->cl_cb(clink));
+			M0_ADDB2_LOGHIST(ca->ca_cb, &ca->ca_cb_hist,
+					 m0_ptr_wrap(clink->cl_cb),
+					 consumed = clink->cl_cb(clink));
 		m0_exit_awkward();
 	}
 	if (!consumed)
@@ -340,9 +340,9 @@ M0_INTERNAL void m0_chan_wait(struct m0_clink *link)
 	if (ca == NULL)
 		m0_semaphore_down(&link->cl_group->cl_wait);
 	else
-		M0_ADDB2_HIST(ca->ca_wait, &ca->ca_wait_hist,
-			      m0_ptr_wrap(__builtin_return_address(0)),
-			      m0_semaphore_down(&link->cl_group->cl_wait));
+		M0_ADDB2_LOGHIST(ca->ca_wait, &ca->ca_wait_hist,
+				 m0_ptr_wrap(__builtin_return_address(0)),
+				 m0_semaphore_down(&link->cl_group->cl_wait));
 }
 M0_EXPORTED(m0_chan_wait);
 
@@ -356,7 +356,7 @@ M0_INTERNAL bool m0_chan_timedwait(struct m0_clink *link,
 		got = m0_semaphore_timeddown(&link->cl_group->cl_wait,
 					     abs_timeout);
 	else
-		M0_ADDB2_HIST(ca->ca_wait, &ca->ca_wait_hist,
+		M0_ADDB2_LOGHIST(ca->ca_wait, &ca->ca_wait_hist,
 		       m0_ptr_wrap(__builtin_return_address(0)),
 		       got = m0_semaphore_timeddown(&link->cl_group->cl_wait,
 						    abs_timeout));
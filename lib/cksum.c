@@ -21,11 +21,20 @@
 
 
 #include "lib/memory.h"               /* m0_alloc, m0_free */
+#include "lib/arith.h"                /* max64u */
+#include "lib/misc.h"                 /* memcpy, offsetof */
 #include "lib/cksum.h"
 
 #define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_LIB
 #include "lib/trace.h"
 
+#if defined(__x86_64__) && !defined(__KERNEL__) && defined(__GNUC__)
+#  define CKSUM_CRC32C_HW (1)
+#  include <nmmintrin.h>
+#else
+#  define CKSUM_CRC32C_HW (0)
+#endif
+
 
 M0_INTERNAL int m0_calculate_md5_inc_context(
 		struct m0_md5_inc_context_pi *pi,
@@ -143,26 +152,490 @@ M0_INTERNAL int m0_calculate_md5_inc_context(
 	return  M0_RC(0);
 }
 
+/**
+ * @name CRC32C
+ *
+ * Software implementation processes 8 bytes per step with 8 lookup tables
+ * ("slicing-by-8"). The tables are generated by the first call. Hardware
+ * implementation uses crc32 instruction of SSE4.2. The implementation is
+ * selected by the first call, races on initialisation are benign: all threads
+ * build the same tables and select the same implementation.
+ *
+ * @{
+ */
+
+enum {
+	/* Reflected Castagnoli polynomial. */
+	CRC32C_POLY = 0x82f63b78
+};
+
+static uint32_t crc32c_table[8][256];
+static bool     crc32c_table_ready = false;
+/* -1: not selected yet. */
+static int      crc32c_hw_on       = -1;
+
+static void crc32c_mktable(void)
+{
+	uint32_t crc;
+	int      i;
+	int      j;
+
+	for (i = 0; i < 256; ++i) {
+		crc = i;
+		for (j = 0; j < 8; ++j)
+			crc = (crc >> 1) ^ (crc & 1 ? CRC32C_POLY : 0);
+		crc32c_table[0][i] = crc;
+	}
+	for (i = 0; i < 256; ++i) {
+		for (j = 1; j < 8; ++j)
+			crc32c_table[j][i] = (crc32c_table[j - 1][i] >> 8) ^
+				crc32c_table[0][crc32c_table[j - 1][i] & 0xff];
+	}
+}
+
+static uint32_t crc32c_sw(uint32_t crc, const uint8_t *p, size_t len)
+{
+	uint32_t (*t)[256] = crc32c_table;
+	uint64_t   word;
+	uint32_t   lo;
+	uint32_t   hi;
+
+	if (!crc32c_table_ready) {
+		crc32c_mktable();
+		crc32c_table_ready = true;
+	}
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	for (; len > 0 && ((unsigned long)p & 7) != 0; --len)
+		crc = t[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+	for (; len >= 8; len -= 8, p += 8) {
+		memcpy(&word, p, sizeof word);
+		lo  = (uint32_t)word ^ crc;
+		hi  = word >> 32;
+		crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^
+		      t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+		      t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^
+		      t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+	}
+#else
+	(void)word;
+	(void)lo;
+	(void)hi;
+#endif
+	for (; len > 0; --len)
+		crc = t[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+	return crc;
+}
+
+#if CKSUM_CRC32C_HW
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_hw(uint32_t crc, const uint8_t *p, size_t len)
+{
+	uint64_t crc64;
+	uint64_t word;
+
+	for (; len > 0 && ((unsigned long)p & 7) != 0; --len)
+		crc = _mm_crc32_u8(crc, *p++);
+	for (crc64 = crc; len >= 8; len -= 8, p += 8) {
+		memcpy(&word, p, sizeof word);
+		crc64 = _mm_crc32_u64(crc64, word);
+	}
+	for (crc = crc64; len > 0; --len)
+		crc = _mm_crc32_u8(crc, *p++);
+	return crc;
+}
+#endif
+
+static bool crc32c_hw_supported(void)
+{
+#if CKSUM_CRC32C_HW
+	return __builtin_cpu_supports("sse4.2");
+#else
+	return false;
+#endif
+}
+
+M0_INTERNAL bool m0_crc32c_hw(void)
+{
+	if (crc32c_hw_on < 0)
+		crc32c_hw_on = crc32c_hw_supported();
+	return crc32c_hw_on;
+}
+
+M0_INTERNAL void m0_crc32c_hw_set(bool hw)
+{
+	M0_PRE(!hw || crc32c_hw_supported());
+	crc32c_hw_on = hw;
+}
+
+M0_INTERNAL uint32_t m0_crc32c(uint32_t crc, const void *buf, size_t len)
+{
+#if CKSUM_CRC32C_HW
+	if (m0_crc32c_hw())
+		return ~crc32c_hw(~crc, buf, len);
+#endif
+	return ~crc32c_sw(~crc, buf, len);
+}
+
+/** @} end of CRC32C */
+
+/**
+ * @name XXH64
+ *
+ * 64-bit xxHash, see https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+ *
+ * @{
+ */
+
+#define XXH_P1 11400714785074694791ULL
+#define XXH_P2 14029467366897019727ULL
+#define XXH_P3  1609587929392839161ULL
+#define XXH_P4  9650029242287828579ULL
+#define XXH_P5  2870177450012600261ULL
+
+/** XXH64 streaming state. */
+struct xxh64_ctx {
+	uint64_t x_total;
+	uint64_t x_acc[4];
+	/* Tail of the input, shorter than a stripe. */
+	uint8_t  x_mem[32];
+	uint32_t x_memsize;
+	uint32_t x_reserved;
+};
+M0_BASSERT(sizeof(struct xxh64_ctx) == M0_XXH64_CONTEXT_LEN);
+
+static inline uint64_t xxh_rotl(uint64_t x, int r)
+{
+	return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t xxh_read64(const uint8_t *p)
+{
+	uint64_t v;
+
+	memcpy(&v, p, sizeof v);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	v = __builtin_bswap64(v);
+#endif
+	return v;
+}
+
+static inline uint32_t xxh_read32(const uint8_t *p)
+{
+	uint32_t v;
+
+	memcpy(&v, p, sizeof v);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	v = __builtin_bswap32(v);
+#endif
+	return v;
+}
+
+static inline uint64_t xxh_round(uint64_t acc, uint64_t in)
+{
+	return xxh_rotl(acc + in * XXH_P2, 31) * XXH_P1;
+}
+
+static inline uint64_t xxh_merge(uint64_t acc, uint64_t v)
+{
+	return (acc ^ xxh_round(0, v)) * XXH_P1 + XXH_P4;
+}
+
+static void xxh64_init(struct xxh64_ctx *x, uint64_t seed)
+{
+	M0_SET0(x);
+	x->x_acc[0] = seed + XXH_P1 + XXH_P2;
+	x->x_acc[1] = seed + XXH_P2;
+	x->x_acc[2] = seed;
+	x->x_acc[3] = seed - XXH_P1;
+}
+
+static void xxh64_stripes(struct xxh64_ctx *x, const uint8_t *p, size_t nr)
+{
+	uint64_t a0 = x->x_acc[0];
+	uint64_t a1 = x->x_acc[1];
+	uint64_t a2 = x->x_acc[2];
+	uint64_t a3 = x->x_acc[3];
+
+	for (; nr > 0; --nr, p += 32) {
+		a0 = xxh_round(a0, xxh_read64(p));
+		a1 = xxh_round(a1, xxh_read64(p + 8));
+		a2 = xxh_round(a2, xxh_read64(p + 16));
+		a3 = xxh_round(a3, xxh_read64(p + 24));
+	}
+	x->x_acc[0] = a0;
+	x->x_acc[1] = a1;
+	x->x_acc[2] = a2;
+	x->x_acc[3] = a3;
+}
+
+static void xxh64_update(struct xxh64_ctx *x, const void *buf, size_t len)
+{
+	const uint8_t *p = buf;
+	size_t         nob;
+
+	x->x_total += len;
+	if (x->x_memsize > 0) {
+		nob = min64u(len, sizeof x->x_mem - x->x_memsize);
+		memcpy(x->x_mem + x->x_memsize, p, nob);
+		x->x_memsize += nob;
+		p   += nob;
+		len -= nob;
+		if (x->x_memsize < sizeof x->x_mem)
+			return;
+		xxh64_stripes(x, x->x_mem, 1);
+		x->x_memsize = 0;
+	}
+	xxh64_stripes(x, p, len / 32);
+	p   += len & ~31UL;
+	len &= 31;
+	memcpy(x->x_mem, p, len);
+	x->x_memsize = len;
+}
+
+static uint64_t xxh64_digest(const struct xxh64_ctx *x)
+{
+	const uint8_t *p   = x->x_mem;
+	const uint8_t *end = p + x->x_memsize;
+	uint64_t       h;
+
+	if (x->x_total >= 32) {
+		h = xxh_rotl(x->x_acc[0], 1) + xxh_rotl(x->x_acc[1], 7) +
+			xxh_rotl(x->x_acc[2], 12) + xxh_rotl(x->x_acc[3], 18);
+		h = xxh_merge(h, x->x_acc[0]);
+		h = xxh_merge(h, x->x_acc[1]);
+		h = xxh_merge(h, x->x_acc[2]);
+		h = xxh_merge(h, x->x_acc[3]);
+	} else
+		h = x->x_acc[2] /* seed */ + XXH_P5;
+	h += x->x_total;
+	for (; p + 8 <= end; p += 8)
+		h = xxh_rotl(h ^ xxh_round(0, xxh_read64(p)), 27) * XXH_P1 +
+			XXH_P4;
+	if (p + 4 <= end) {
+		h = xxh_rotl(h ^ (xxh_read32(p) * XXH_P1), 23) * XXH_P2 +
+			XXH_P3;
+		p += 4;
+	}
+	for (; p < end; ++p)
+		h = xxh_rotl(h ^ (*p * XXH_P5), 11) * XXH_P1;
+	h ^= h >> 33;
+	h *= XXH_P2;
+	h ^= h >> 29;
+	h *= XXH_P3;
+	h ^= h >> 32;
+	return h;
+}
+
+M0_INTERNAL uint64_t m0_xxh64(const void *buf, size_t len, uint64_t seed)
+{
+	struct xxh64_ctx x;
+
+	xxh64_init(&x, seed);
+	xxh64_update(&x, buf, len);
+	return xxh64_digest(&x);
+}
+
+/** @} end of XXH64 */
+
+/**
+ * Checksum algorithm of an incremental PI type, other than MD5.
+ *
+ * Algorithm context is kept in the PI structure and passed around as an
+ * opaque byte array of pa_ctx_size bytes.
+ */
+union pi_ctx {
+	uint32_t         pc_crc;
+	struct xxh64_ctx pc_xxh;
+};
+
+struct pi_inc_alg {
+	uint32_t pa_size;
+	uint32_t pa_ctx_size;
+	uint32_t pa_val_size;
+	size_t   pa_ctx_off;
+	size_t   pa_val_off;
+	void   (*pa_init)(union pi_ctx *ctx);
+	void   (*pa_update)(union pi_ctx *ctx, const void *buf, size_t len);
+	void   (*pa_final)(const union pi_ctx *ctx, unsigned char *value);
+};
+
+static void crc32c_ctx_init(union pi_ctx *ctx)
+{
+	ctx->pc_crc = 0;
+}
+
+static void crc32c_ctx_update(union pi_ctx *ctx, const void *buf, size_t len)
+{
+	ctx->pc_crc = m0_crc32c(ctx->pc_crc, buf, len);
+}
+
+static void crc32c_ctx_final(const union pi_ctx *ctx, unsigned char *value)
+{
+	uint32_t crc = ctx->pc_crc;
+	int      i;
+
+	/* Little-endian, as CRC32C is usually stored. */
+	for (i = 0; i < M0_CRC32C_LEN; ++i, crc >>= 8)
+		value[i] = crc & 0xff;
+}
+
+static void xxh64_ctx_init(union pi_ctx *ctx)
+{
+	xxh64_init(&ctx->pc_xxh, 0);
+}
+
+static void xxh64_ctx_update(union pi_ctx *ctx, const void *buf, size_t len)
+{
+	xxh64_update(&ctx->pc_xxh, buf, len);
+}
+
+static void xxh64_ctx_final(const union pi_ctx *ctx, unsigned char *value)
+{
+	uint64_t h = xxh64_digest(&ctx->pc_xxh);
+	int      i;
+
+	/* Big-endian, canonical xxHash representation. */
+	for (i = M0_XXH64_LEN - 1; i >= 0; --i, h >>= 8)
+		value[i] = h & 0xff;
+}
+
+static const struct pi_inc_alg pi_inc_algs[M0_PI_TYPE_MAX] = {
+	[M0_PI_TYPE_CRC32C_INC_CONTEXT] = {
+		.pa_size     = sizeof(struct m0_crc32c_inc_context_pi),
+		.pa_ctx_size = M0_CRC32C_LEN,
+		.pa_val_size = M0_CRC32C_LEN,
+		.pa_ctx_off  = offsetof(struct m0_crc32c_inc_context_pi,
+					picrc_prev_context),
+		.pa_val_off  = offsetof(struct m0_crc32c_inc_context_pi,
+					picrc_value),
+		.pa_init     = &crc32c_ctx_init,
+		.pa_update   = &crc32c_ctx_update,
+		.pa_final    = &crc32c_ctx_final
+	},
+	[M0_PI_TYPE_XXH64_INC_CONTEXT] = {
+		.pa_size     = sizeof(struct m0_xxh64_inc_context_pi),
+		.pa_ctx_size = M0_XXH64_CONTEXT_LEN,
+		.pa_val_size = M0_XXH64_LEN,
+		.pa_ctx_off  = offsetof(struct m0_xxh64_inc_context_pi,
+					pixxh_prev_context),
+		.pa_val_off  = offsetof(struct m0_xxh64_inc_context_pi,
+					pixxh_value),
+		.pa_init     = &xxh64_ctx_init,
+		.pa_update   = &xxh64_ctx_update,
+		.pa_final    = &xxh64_ctx_final
+	}
+};
+
+static const struct pi_inc_alg *pi_inc_alg(uint8_t type)
+{
+	return type < ARRAY_SIZE(pi_inc_algs) &&
+		pi_inc_algs[type].pa_init != NULL ? &pi_inc_algs[type] : NULL;
+}
+
+M0_INTERNAL int m0_calculate_inc_context(struct m0_generic_pi *pi,
+					 struct m0_pi_seed *seed,
+					 struct m0_bufvec *bvec,
+					 enum m0_pi_calc_flag flag,
+					 unsigned char *curr_context,
+					 unsigned char *pi_value_without_seed)
+{
+	const struct pi_inc_alg *alg = pi_inc_alg(pi->pi_hdr.pih_type);
+	unsigned char           *prev_context;
+	union pi_ctx             ctx;
+	union pi_ctx             seeded;
+	uint64_t                 seed_val[3];
+	int                      i;
+
+	M0_ENTRY();
+
+	M0_PRE(alg != NULL);
+	M0_PRE(curr_context != NULL);
+	M0_PRE(ergo(bvec != NULL && bvec->ov_vec.v_nr != 0,
+		    bvec->ov_vec.v_count != NULL && bvec->ov_buf != NULL));
+
+	prev_context = (unsigned char *)pi + alg->pa_ctx_off;
+	if (flag & M0_PI_CALC_UNIT_ZERO) {
+		pi->pi_hdr.pih_size = alg->pa_size;
+		alg->pa_init(&ctx);
+		memcpy(prev_context, &ctx, alg->pa_ctx_size);
+	} else
+		memcpy(&ctx, prev_context, alg->pa_ctx_size);
+
+	if (bvec != NULL) {
+		for (i = 0; i < bvec->ov_vec.v_nr; i++)
+			alg->pa_update(&ctx, bvec->ov_buf[i],
+				       bvec->ov_vec.v_count[i]);
+	}
+	/* curr_context never includes the seed. */
+	memcpy(curr_context, &ctx, alg->pa_ctx_size);
+	if (pi_value_without_seed != NULL)
+		alg->pa_final(&ctx, pi_value_without_seed);
+
+	seeded = ctx;
+	if (seed != NULL) {
+		/* Unlike MD5, the seed is hashed in binary form. */
+		seed_val[0] = seed->pis_obj_id.f_container;
+		seed_val[1] = seed->pis_obj_id.f_key;
+		seed_val[2] = seed->pis_data_unit_offset;
+		alg->pa_update(&seeded, seed_val, sizeof seed_val);
+	}
+	if (!(flag & M0_PI_SKIP_CALC_FINAL))
+		alg->pa_final(&seeded, (unsigned char *)pi + alg->pa_val_off);
+	return M0_RC(0);
+}
+
+static bool inc_context_verify(struct m0_generic_pi *pi,
+			       struct m0_pi_seed *seed,
+			       struct m0_bufvec *bvec)
+{
+	const struct pi_inc_alg *alg = pi_inc_alg(pi->pi_hdr.pih_type);
+	union {
+		struct m0_generic_pi            g;
+		struct m0_crc32c_inc_context_pi crc;
+		struct m0_xxh64_inc_context_pi  xxh;
+	}                        calc;
+	union pi_ctx             curr_context;
+
+	M0_PRE(alg != NULL);
+	memcpy(&calc, pi, alg->pa_size);
+	m0_calculate_inc_context(&calc.g, seed, bvec, M0_PI_NO_FLAG,
+				 (unsigned char *)&curr_context, NULL);
+	if (memcmp((char *)pi + alg->pa_val_off,
+		   (char *)&calc + alg->pa_val_off, alg->pa_val_size) == 0)
+		return true;
+	M0_LOG(M0_ERROR, "checksum fail type %d "
+	       "f_container 0x%" PRIx64 " f_key 0x%"PRIx64
+	       " data_unit_offset 0x%"PRIx64, (int)pi->pi_hdr.pih_type,
+	       seed->pis_obj_id.f_container, seed->pis_obj_id.f_key,
+	       seed->pis_data_unit_offset);
+	return false;
+}
+
 M0_INTERNAL uint64_t m0_calculate_cksum_size(struct m0_generic_pi *pi)
 {
 	M0_ENTRY();
-#ifndef __KERNEL__
 	switch (pi->pi_hdr.pih_type) {
+#ifndef __KERNEL__
 	case M0_PI_TYPE_MD5_INC_CONTEXT:
 		return sizeof(struct m0_md5_inc_context_pi);
 		break;
 	case M0_PI_TYPE_MD5:
 		return sizeof(struct m0_md5_pi);
 		break;
-	}
 #endif
+	case M0_PI_TYPE_CRC32C_INC_CONTEXT:
+	case M0_PI_TYPE_XXH64_INC_CONTEXT:
+		return pi_inc_alg(pi->pi_hdr.pih_type)->pa_size;
+	}
 	return 0;
 }
 
 M0_INTERNAL uint64_t max_cksum_size(void)
 {
-	return (sizeof(struct m0_md5_pi) > sizeof(struct m0_md5_inc_context_pi) ?
-			sizeof(struct m0_md5_pi) : sizeof(struct m0_md5_inc_context_pi));
+	return max64u(max64u(sizeof(struct m0_md5_pi),
+			     sizeof(struct m0_md5_inc_context_pi)),
+		      max64u(sizeof(struct m0_crc32c_inc_context_pi),
+			     sizeof(struct m0_xxh64_inc_context_pi)));
 }
 
 int m0_client_calculate_pi(struct m0_generic_pi *pi,
@@ -174,8 +647,8 @@ int m0_client_calculate_pi(struct m0_generic_pi *pi,
 {
 	int rc = 0;
 	M0_ENTRY();
-#ifndef __KERNEL__
 	switch (pi->pi_hdr.pih_type) {
+#ifndef __KERNEL__
 	case M0_PI_TYPE_MD5_INC_CONTEXT: {
 		struct m0_md5_inc_context_pi *md5_context_pi =
 			(struct m0_md5_inc_context_pi *) pi;
@@ -184,8 +657,14 @@ int m0_client_calculate_pi(struct m0_generic_pi *pi,
 						  pi_value_without_seed);
 		}
 		break;
-	}
 #endif
+	case M0_PI_TYPE_CRC32C_INC_CONTEXT:
+	case M0_PI_TYPE_XXH64_INC_CONTEXT:
+		rc = m0_calculate_inc_context(pi, seed, bvec, flag,
+					      curr_context,
+					      pi_value_without_seed);
+		break;
+	}
 	return M0_RC(rc);
 }
 
@@ -195,8 +674,8 @@ bool m0_calc_verify_cksum_one_unit(struct m0_generic_pi *pi,
                                    struct m0_pi_seed *seed,
                                    struct m0_bufvec *bvec)
 {
-#ifndef __KERNEL__
 	switch (pi->pi_hdr.pih_type) {
+#ifndef __KERNEL__
 	case M0_PI_TYPE_MD5_INC_CONTEXT:
 	{
 		struct m0_md5_inc_context_pi md5_ctx_pi;
@@ -229,10 +708,13 @@ bool m0_calc_verify_cksum_one_unit(struct m0_generic_pi *pi,
 		}
 		break;
 	}
+#endif
+	case M0_PI_TYPE_CRC32C_INC_CONTEXT:
+	case M0_PI_TYPE_XXH64_INC_CONTEXT:
+		return inc_context_verify(pi, seed, bvec);
 	default:
 		M0_IMPOSSIBLE("pi_type = %d", pi->pi_hdr.pih_type);
 	}
-#endif
 	return true;
 }
 
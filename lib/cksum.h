@@ -59,9 +59,22 @@ enum
         M0_PI_TYPE_MD5,
         M0_PI_TYPE_MD5_INC_CONTEXT,
         M0_PI_TYPE_CRC,
+        /* CRC32C (Castagnoli), SSE4.2 accelerated where available */
+        M0_PI_TYPE_CRC32C_INC_CONTEXT,
+        /* 64-bit xxHash (XXH64) */
+        M0_PI_TYPE_XXH64_INC_CONTEXT,
         M0_PI_TYPE_MAX
 };
 
+enum {
+        /* size of CRC32C checksum value */
+        M0_CRC32C_LEN        = 4,
+        /* size of XXH64 checksum value */
+        M0_XXH64_LEN         = 8,
+        /* size of XXH64 streaming state, see lib/cksum.c:struct xxh64_ctx */
+        M0_XXH64_CONTEXT_LEN = 80
+};
+
 enum m0_pi_calc_flag {
 
         /* NO PI FLAG */
@@ -113,6 +126,32 @@ struct m0_md5_inc_context_pi {
 #endif
 };
 
+struct m0_crc32c_inc_context_pi {
+
+        /* header for protection info */
+        struct m0_pi_hdr picrc_hdr;
+        /* CRC of the previous data units, not finalised, without seed */
+        unsigned char    picrc_prev_context[M0_CRC32C_LEN];
+        /* protection value computed for the current data unit */
+        unsigned char    picrc_value[M0_CRC32C_LEN];
+        /* structure should be 32 byte aligned */
+        char             picrc_pad[M0_CALC_PAD((sizeof(struct m0_pi_hdr)+
+				   2 * M0_CRC32C_LEN), 32)];
+};
+
+struct m0_xxh64_inc_context_pi {
+
+        /* header for protection info */
+        struct m0_pi_hdr pixxh_hdr;
+        /* context of previous data unit, required for checksum computation */
+        unsigned char    pixxh_prev_context[M0_XXH64_CONTEXT_LEN];
+        /* protection value computed for the current data unit */
+        unsigned char    pixxh_value[M0_XXH64_LEN];
+        /* structure should be 32 byte aligned */
+        char             pixxh_pad[M0_CALC_PAD((sizeof(struct m0_pi_hdr)+
+				   M0_XXH64_CONTEXT_LEN+M0_XXH64_LEN), 32)];
+};
+
 struct m0_generic_pi {
         /* header for protection info */
         struct m0_pi_hdr pi_hdr;
@@ -155,6 +194,37 @@ M0_INTERNAL int m0_calculate_md5_inc_context(
                 unsigned char *curr_context,
                 unsigned char *pi_value_without_seed);
 
+/**
+ * Calculate checksum/protection info for PI types M0_PI_TYPE_CRC32C_INC_CONTEXT
+ * and M0_PI_TYPE_XXH64_INC_CONTEXT. Parameters are the same as for
+ * m0_calculate_md5_inc_context(), except that the seed is hashed in binary
+ * form.
+ */
+M0_INTERNAL int m0_calculate_inc_context(struct m0_generic_pi *pi,
+					 struct m0_pi_seed *seed,
+					 struct m0_bufvec *bvec,
+					 enum m0_pi_calc_flag flag,
+					 unsigned char *curr_context,
+					 unsigned char *pi_value_without_seed);
+
+/**
+ * Updates CRC32C of data. Pass 0 as crc for the first buffer. The result of
+ * m0_crc32c(m0_crc32c(0, a, x), b, y) is CRC32C of the concatenation of a and b.
+ */
+M0_INTERNAL uint32_t m0_crc32c(uint32_t crc, const void *buf, size_t len);
+
+/** Returns XXH64 of the buffer. */
+M0_INTERNAL uint64_t m0_xxh64(const void *buf, size_t len, uint64_t seed);
+
+/** True iff m0_crc32c() uses the SSE4.2 crc32 instruction. */
+M0_INTERNAL bool m0_crc32c_hw(void);
+
+/**
+ * Selects the implementation used by m0_crc32c(). Hardware implementation can
+ * be selected only if the processor supports SSE4.2.
+ */
+M0_INTERNAL void m0_crc32c_hw_set(bool hw);
+
 /**
  * Calculate checksum size
  * @param pi generic pointer for checksum data structure
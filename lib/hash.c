@@ -47,29 +47,74 @@ static const struct m0_bob_type htable_bobtype = {
 
 static bool htable_invariant(const struct m0_htable *htable);
 
-static void hbucket_init(const struct m0_ht_descr *d,
-			 struct m0_hbucket        *bucket)
+static void *obj_key(const struct m0_ht_descr *hd, void *obj)
 {
-	M0_PRE(bucket != NULL);
-	M0_PRE(d != NULL);
+	return obj + hd->hd_key_offset;
+}
 
-	m0_tlist_init(d->hd_tldescr, &bucket->hb_objects);
-	m0_mutex_init(&bucket->hb_mutex);
+static uint64_t htable_split_get(const struct m0_htable *htable)
+{
+	return (uint64_t)m0_atomic64_get(&htable->h_split);
 }
 
-static void hbucket_fini(const struct m0_ht_descr *d,
-			 struct m0_hbucket        *bucket)
+/** Number of allocated elements of m0_htable::h_buckets. */
+static uint64_t htable_alloc_nr(const struct m0_htable *htable)
 {
-	M0_PRE(bucket != NULL);
-	M0_PRE(d != NULL);
+	return htable->h_resizable ? 2 * htable->h_base_nr :
+		htable->h_bucket_nr;
+}
 
-	m0_tlist_fini(d->hd_tldescr, &bucket->hb_objects);
-	m0_mutex_fini(&bucket->hb_mutex);
+/**
+ * Returns full hash of a key of a resizable table, see M0_HT_HASH_RANGE.
+ * For a fixed table returns the bucket id of the key.
+ */
+static uint64_t htable_hash(const struct m0_htable *htable, const void *key)
+{
+	const struct m0_htable range = {
+		.h_magic     = M0_LIB_HASHLIST_MAGIC,
+		.h_bucket_nr = M0_HT_HASH_RANGE,
+		.h_descr     = htable->h_descr
+	};
+
+	return htable->h_descr->hd_hash_func(htable->h_resizable ?
+					     &range : htable, key);
 }
 
-static void *obj_key(const struct m0_ht_descr *hd, void *obj)
+/**
+ * Maps full hash to a bucket of a resizable table. Buckets below
+ * m0_htable::h_split have been split in the current round and use one more
+ * bit of the hash.
+ *
+ * The result is stable while the stripe of the hash is held: a concurrent
+ * split of a bucket in another stripe changes h_split from j to j + 1, which
+ * does not change the comparison below for bucket != j.
+ */
+static uint64_t hash_bucket(const struct m0_htable *htable, uint64_t hash)
 {
-	return obj + hd->hd_key_offset;
+	uint64_t bucket = hash & (htable->h_base_nr - 1);
+
+	if (bucket < htable_split_get(htable))
+		bucket = hash & (2 * htable->h_base_nr - 1);
+	return bucket;
+}
+
+static uint64_t htable_bucket(const struct m0_htable *htable, const void *key)
+{
+	uint64_t hash = htable_hash(htable, key);
+
+	return htable->h_resizable ? hash_bucket(htable, hash) : hash;
+}
+
+/**
+ * Returns the stripe lock of a key. For a resizable table
+ * m0_htable::h_stripe_nr divides m0_htable::h_base_nr, so the stripe of a key
+ * does not depend on the split state.
+ */
+static struct m0_mutex *htable_stripe(const struct m0_htable *htable,
+				      const void             *key)
+{
+	return &htable->h_stripes[htable_hash(htable, key) %
+				  htable->h_stripe_nr];
 }
 
 static bool hbucket_invariant(const struct m0_ht_descr *desc,
@@ -85,7 +130,7 @@ static bool hbucket_invariant(const struct m0_ht_descr *desc,
 		bucket != NULL &&
 		desc != NULL &&
 		m0_hbucket_forall_ol(desc->hd_tldescr, amb, bucket,
-				     index == desc->hd_hash_func(htable,
+				     index == htable_bucket(htable,
 				     obj_key(desc, amb)));
 }
 
@@ -95,14 +140,24 @@ static bool htable_invariant(const struct m0_htable *htable)
 		m0_htable_bob_check(htable) &&
 		htable->h_bucket_nr >  0 &&
 		htable->h_buckets   != NULL &&
+		htable->h_stripes   != NULL &&
+		htable->h_stripe_nr >  0 &&
+		_0C(ergo(htable->h_resizable,
+			 m0_is_po2(htable->h_base_nr) &&
+			 htable->h_base_nr % htable->h_stripe_nr == 0 &&
+			 htable_split_get(htable) <=
+			 htable->h_base_nr &&
+			 htable->h_bucket_nr == htable->h_base_nr +
+			 htable_split_get(htable))) &&
 		m0_forall(i, htable->h_bucket_nr,
 			  hbucket_invariant(htable->h_descr,
 					    &htable->h_buckets[i], htable));
 }
 
-M0_INTERNAL int m0_htable_init(const struct m0_ht_descr *d,
-			       struct m0_htable         *htable,
-			       uint64_t                  bucket_nr)
+static int htable_init(const struct m0_ht_descr *d,
+		       struct m0_htable         *htable,
+		       uint64_t                  bucket_nr,
+		       bool                      resizable)
 {
 	uint64_t nr;
 
@@ -112,37 +167,217 @@ M0_INTERNAL int m0_htable_init(const struct m0_ht_descr *d,
 
 	m0_htable_bob_init(htable);
 
+	if (resizable && !m0_is_po2(bucket_nr))
+		bucket_nr = 1ULL << (m0_log2(bucket_nr) + 1);
 	htable->h_descr     = d;
 	htable->h_bucket_nr = bucket_nr;
-	M0_ALLOC_ARR(htable->h_buckets, htable->h_bucket_nr);
-	if (htable->h_buckets == NULL)
+	htable->h_base_nr   = bucket_nr;
+	htable->h_resizable = resizable;
+	htable->h_stripe_nr = min64u(bucket_nr, M0_HT_STRIPE_NR);
+	m0_atomic64_set(&htable->h_split, 0);
+	m0_atomic64_set(&htable->h_obj_nr, 0);
+	m0_atomic64_set(&htable->h_obj_max, M0_HT_LOAD_MAX * bucket_nr);
+	M0_ALLOC_ARR(htable->h_buckets, htable_alloc_nr(htable));
+	M0_ALLOC_ARR(htable->h_stripes, htable->h_stripe_nr);
+	if (htable->h_buckets == NULL || htable->h_stripes == NULL) {
+		m0_free0(&htable->h_buckets);
+		m0_free0(&htable->h_stripes);
 		return M0_ERR(-ENOMEM);
+	}
 
-	for (nr = 0; nr < htable->h_bucket_nr; ++nr)
-		hbucket_init(d, &htable->h_buckets[nr]);
+	for (nr = 0; nr < htable_alloc_nr(htable); ++nr)
+		m0_tlist_init(d->hd_tldescr, &htable->h_buckets[nr].hb_objects);
+	for (nr = 0; nr < htable->h_stripe_nr; ++nr)
+		m0_mutex_init(&htable->h_stripes[nr]);
+	m0_mutex_init(&htable->h_grow_lock);
 	M0_POST_EX(htable_invariant(htable));
 	return 0;
 }
 
+M0_INTERNAL int m0_htable_init(const struct m0_ht_descr *d,
+			       struct m0_htable         *htable,
+			       uint64_t                  bucket_nr)
+{
+	return htable_init(d, htable, bucket_nr, false);
+}
+
+M0_INTERNAL int m0_htable_init_resizable(const struct m0_ht_descr *d,
+					 struct m0_htable         *htable,
+					 uint64_t                  bucket_nr)
+{
+	return htable_init(d, htable, bucket_nr, true);
+}
+
 M0_INTERNAL bool m0_htable_is_init(const struct m0_htable *htable)
 {
 	return htable_invariant(htable);
 }
 
-M0_INTERNAL void m0_htable_add(struct m0_htable *htable,
-			       void             *amb)
+/**
+ * Locks a stripe for growth.
+ *
+ * Without "block" the stripe is only tried, which is safe whatever stripe the
+ * caller holds: a stripe held by the caller itself is busy as well, and the
+ * growth step needing it is left to a later insertion.
+ *
+ * @param block whether to wait for a busy stripe. Only allowed when the
+ *              calling thread holds no stripe of the table.
+ */
+static bool stripe_lock(struct m0_mutex *stripe, bool block)
+{
+	if (block) {
+		m0_mutex_lock(stripe);
+		return true;
+	}
+	return m0_mutex_trylock(stripe) == 0;
+}
+
+/**
+ * Sets the number of objects above which the table grows. Called under
+ * m0_htable::h_grow_lock whenever m0_htable::h_bucket_nr changes.
+ */
+static void htable_obj_max_set(struct m0_htable *htable)
+{
+	m0_atomic64_set(&htable->h_obj_max,
+			M0_HT_LOAD_MAX * htable->h_bucket_nr);
+}
+
+/**
+ * Lockless check whether growth is needed. m0_htable::h_bucket_nr is only
+ * read under m0_htable::h_grow_lock, see htable_grow().
+ */
+static bool htable_is_overloaded(const struct m0_htable *htable)
+{
+	return m0_atomic64_get(&htable->h_obj_nr) >
+		m0_atomic64_get(&htable->h_obj_max);
+}
+
+/** Splits bucket m0_htable::h_split into itself and h_split + h_base_nr. */
+static bool htable_split(struct m0_htable *htable, bool block)
+{
+	const struct m0_tl_descr *tld   = htable->h_descr->hd_tldescr;
+	uint64_t                  base  = htable->h_base_nr;
+	uint64_t                  split = htable_split_get(htable);
+	struct m0_mutex          *stripe;
+	void                     *obj;
+
+	M0_PRE(m0_mutex_is_locked(&htable->h_grow_lock));
+	M0_PRE(split < base);
+
+	stripe = &htable->h_stripes[split % htable->h_stripe_nr];
+	if (!stripe_lock(stripe, block))
+		return false;
+	m0_tlist_for(tld, &htable->h_buckets[split].hb_objects, obj) {
+		if (htable_hash(htable, obj_key(htable->h_descr, obj)) & base)
+			m0_tlist_move(tld, &htable->h_buckets[split + base].
+				      hb_objects, obj);
+	} m0_tlist_endfor;
+	htable->h_bucket_nr = base + split + 1;
+	m0_atomic64_set(&htable->h_split, split + 1);
+	m0_mutex_unlock(stripe);
+	htable_obj_max_set(htable);
+	return true;
+}
+
+/**
+ * Starts a new split round, doubling the bucket array. All stripes are
+ * needed, because the array is reallocated.
+ */
+static bool htable_double(struct m0_htable *htable, bool block)
+{
+	const struct m0_tl_descr *tld  = htable->h_descr->hd_tldescr;
+	uint64_t                  base = htable->h_base_nr;
+	struct m0_hbucket        *buckets;
+	struct m0_hbucket        *old;
+	uint64_t                  nr;
+	uint64_t                  i;
+	void                     *obj;
+	bool                      done;
+
+	M0_PRE(m0_mutex_is_locked(&htable->h_grow_lock));
+	M0_PRE(htable_split_get(htable) == base);
+
+	M0_ALLOC_ARR(buckets, 4 * base);
+	if (buckets == NULL)
+		return false;
+	for (i = 0; i < 4 * base; ++i)
+		m0_tlist_init(tld, &buckets[i].hb_objects);
+	for (nr = 0; nr < htable->h_stripe_nr; ++nr) {
+		if (!stripe_lock(&htable->h_stripes[nr], block))
+			break;
+	}
+	done = nr == htable->h_stripe_nr;
+	if (done) {
+		old = htable->h_buckets;
+		for (i = 0; i < 2 * base; ++i) {
+			while ((obj = m0_tlist_head(tld,
+						    &old[i].hb_objects)) != NULL)
+				m0_tlist_move_tail(tld, &buckets[i].hb_objects,
+						   obj);
+			m0_tlist_fini(tld, &old[i].hb_objects);
+		}
+		htable->h_buckets   = buckets;
+		htable->h_base_nr   = 2 * base;
+		htable->h_bucket_nr = 2 * base;
+		m0_atomic64_set(&htable->h_split, 0);
+		htable_obj_max_set(htable);
+		buckets = old;
+	} else {
+		for (i = 0; i < 4 * base; ++i)
+			m0_tlist_fini(tld, &buckets[i].hb_objects);
+	}
+	while (nr-- > 0)
+		m0_mutex_unlock(&htable->h_stripes[nr]);
+	m0_free(buckets);
+	return done;
+}
+
+/**
+ * Grows an overloaded resizable table until its load is back to
+ * M0_HT_LOAD_MAX. Insertions racing with the owner of the growth lock do not
+ * wait for it, so the owner catches up for them. If the growth lock is busy,
+ * or a required stripe is busy and "block" is false, growth is left to a later
+ * insertion.
+ *
+ * Waiting for stripes is only allowed to a thread which holds no stripe:
+ * stripes are taken in index order by the single thread owning the growth
+ * lock, and other threads never wait for the growth lock.
+ */
+static void htable_grow(struct m0_htable *htable, bool block)
+{
+	if (!htable->h_resizable || !htable_is_overloaded(htable) ||
+	    m0_mutex_trylock(&htable->h_grow_lock) != 0)
+		return;
+	while (m0_atomic64_get(&htable->h_obj_nr) >
+	       M0_HT_LOAD_MAX * htable->h_bucket_nr &&
+	       (htable_split_get(htable) == htable->h_base_nr ?
+		htable_double(htable, block) : htable_split(htable, block)))
+		;
+	m0_mutex_unlock(&htable->h_grow_lock);
+}
+
+static void htable_add(struct m0_htable *htable, void *amb)
 {
 	uint64_t bucket_id;
 
+	bucket_id = htable_bucket(htable, obj_key(htable->h_descr, amb));
+
+	m0_tlist_add(htable->h_descr->hd_tldescr,
+		     &htable->h_buckets[bucket_id].hb_objects, amb);
+	if (htable->h_resizable)
+		m0_atomic64_inc(&htable->h_obj_nr);
+}
+
+M0_INTERNAL void m0_htable_add(struct m0_htable *htable,
+			       void             *amb)
+{
 	M0_PRE_EX(htable_invariant(htable));
 	M0_PRE(amb != NULL);
 	M0_PRE(!m0_tlink_is_in(htable->h_descr->hd_tldescr, amb));
 
-	bucket_id = htable->h_descr->hd_hash_func(htable,
-			obj_key(htable->h_descr, amb));
-
-	m0_tlist_add(htable->h_descr->hd_tldescr,
-		     &htable->h_buckets[bucket_id].hb_objects, amb);
+	htable_add(htable, amb);
+	/* The caller may hold a stripe, see stripe_lock(). */
+	htable_grow(htable, false);
 	M0_POST_EX(htable_invariant(htable));
 	M0_POST(m0_tlink_is_in(htable->h_descr->hd_tldescr, amb));
 }
@@ -154,6 +389,8 @@ M0_INTERNAL void m0_htable_del(struct m0_htable *htable,
 	M0_PRE(amb != NULL);
 
 	m0_tlist_del(htable->h_descr->hd_tldescr, amb);
+	if (htable->h_resizable)
+		m0_atomic64_dec(&htable->h_obj_nr);
 
 	M0_POST_EX(htable_invariant(htable));
 	M0_POST(!m0_tlink_is_in(htable->h_descr->hd_tldescr, amb));
@@ -167,7 +404,7 @@ M0_INTERNAL void *m0_htable_lookup(const struct m0_htable *htable,
 
 	M0_PRE_EX(htable_invariant(htable));
 
-	bucket_id = htable->h_descr->hd_hash_func(htable, key);
+	bucket_id = htable_bucket(htable, key);
 
 	m0_tlist_for(htable->h_descr->hd_tldescr,
 		     &htable->h_buckets[bucket_id].hb_objects, scan) {
@@ -184,9 +421,14 @@ M0_INTERNAL void m0_htable_cc_add(struct m0_htable *htable,
 {
 	M0_PRE(amb != NULL);
 
+	M0_PRE_EX(htable_invariant(htable));
+	M0_PRE(!m0_tlink_is_in(htable->h_descr->hd_tldescr, amb));
+
 	m0_hbucket_lock(htable, obj_key(htable->h_descr, amb));
-	m0_htable_add(htable, amb);
-	m0_hbucket_unlock(htable, obj_key(htable->h_descr, amb));
+	htable_add(htable, amb);
+	m0_mutex_unlock(htable_stripe(htable, obj_key(htable->h_descr, amb)));
+	/* No stripe is held here, so growth may wait for stripes. */
+	htable_grow(htable, true);
 }
 
 M0_INTERNAL void m0_htable_cc_del(struct m0_htable *htable,
@@ -215,23 +457,22 @@ M0_INTERNAL void *m0_htable_cc_lookup(struct m0_htable *htable,
 M0_INTERNAL void m0_hbucket_lock(struct m0_htable *htable,
 				 const void       *key)
 {
-	uint64_t bucket_id;
-
 	M0_PRE_EX(htable_invariant(htable));
 
-	bucket_id = htable->h_descr->hd_hash_func(htable, key);
-	m0_mutex_lock(&htable->h_buckets[bucket_id].hb_mutex);
+	m0_mutex_lock(htable_stripe(htable, key));
 }
 
 M0_INTERNAL void m0_hbucket_unlock(struct m0_htable *htable,
 				   const void       *key)
 {
-	uint64_t bucket_id;
-
 	M0_PRE_EX(htable_invariant(htable));
 
-	bucket_id = htable->h_descr->hd_hash_func(htable, key);
-	m0_mutex_unlock(&htable->h_buckets[bucket_id].hb_mutex);
+	m0_mutex_unlock(htable_stripe(htable, key));
+	/*
+	 * Insertions made under the stripe could not use it for growth.
+	 * Don't wait for stripes: the caller may hold other locks.
+	 */
+	htable_grow(htable, false);
 }
 
 M0_INTERNAL void m0_htable_fini(struct m0_htable *htable)
@@ -240,12 +481,20 @@ M0_INTERNAL void m0_htable_fini(struct m0_htable *htable)
 
 	M0_PRE_EX(htable_invariant(htable));
 
-	for (nr = 0; nr < htable->h_bucket_nr; ++nr)
-		hbucket_fini(htable->h_descr, &htable->h_buckets[nr]);
+	for (nr = 0; nr < htable_alloc_nr(htable); ++nr)
+		m0_tlist_fini(htable->h_descr->hd_tldescr,
+			      &htable->h_buckets[nr].hb_objects);
+	for (nr = 0; nr < htable->h_stripe_nr; ++nr)
+		m0_mutex_fini(&htable->h_stripes[nr]);
+	m0_mutex_fini(&htable->h_grow_lock);
 	m0_free(htable->h_buckets);
+	m0_free(htable->h_stripes);
 	m0_htable_bob_fini(htable);
 	htable->h_buckets   = NULL;
 	htable->h_bucket_nr = 0;
+	htable->h_stripes   = NULL;
+	htable->h_stripe_nr = 0;
+	htable->h_base_nr   = 0;
 	htable->h_descr     = NULL;
 }
 
@@ -255,6 +504,8 @@ M0_INTERNAL bool m0_htable_is_empty(const struct m0_htable *htable)
 
 	M0_PRE_EX(htable_invariant(htable));
 
+	if (htable->h_resizable)
+		return m0_atomic64_get(&htable->h_obj_nr) == 0;
 	for (nr = 0; nr < htable->h_bucket_nr; ++nr) {
 		if (!m0_tlist_is_empty(htable->h_descr->hd_tldescr,
 				&htable->h_buckets[nr].hb_objects))
@@ -270,6 +521,8 @@ M0_INTERNAL uint64_t m0_htable_size(const struct m0_htable *htable)
 
 	M0_PRE_EX(htable_invariant(htable));
 
+	if (htable->h_resizable)
+		return m0_atomic64_get(&htable->h_obj_nr);
 	for (nr = 0; nr < htable->h_bucket_nr; ++nr)
 		len += m0_tlist_length(htable->h_descr->hd_tldescr,
 				&htable->h_buckets[nr].hb_objects);
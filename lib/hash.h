@@ -28,6 +28,7 @@
 #include "lib/types.h"
 #include "lib/tlist.h"
 #include "lib/mutex.h"
+#include "lib/atomic.h"
 
 /**
  * @defgroup hash Hash table.
@@ -143,6 +144,44 @@
  * m0_htable_for() and m0_htable_endfor() can be used to have a loop
  * over all objects in hashtable.
  *
+ * <b>Resizable tables</b>
+ *
+ * A table initialised by m0_htable_init() has a fixed number of buckets,
+ * so lookups degrade linearly once the population outgrows the guess made
+ * at initialisation time. A table initialised by m0_htable_init_resizable()
+ * grows with its population using linear hashing: whenever the average
+ * bucket length exceeds M0_HT_LOAD_MAX, the next bucket in split order is
+ * split in two. Only the objects of that one bucket are rehashed, so the
+ * cost of growth is spread over insertions. Once every bucket of the
+ * current round has been split, the bucket array is doubled, which
+ * relinks (but does not rehash) all objects. Tables never shrink.
+ *
+ * The hash function of a resizable table is invoked with a table whose
+ * m0_htable::h_bucket_nr is M0_HT_HASH_RANGE, so that the usual
+ * "hash % htable->h_bucket_nr" idiom returns the full hash value, which is
+ * then mapped to a bucket by the table itself.
+ *
+ * <b>Concurrency</b>
+ *
+ * Buckets are protected by an array of at most M0_HT_STRIPE_NR mutexes
+ * (stripes), a bucket being protected by the stripe with index
+ * "bucket % stripe_nr". The number of stripes is fixed at initialisation
+ * time to the smaller of M0_HT_STRIPE_NR and the initial number of buckets,
+ * so a table shared by many threads should start with at least
+ * M0_HT_STRIPE_NR buckets. m0_hbucket_lock() locks the stripe of a key,
+ * m0_htable_cc_*() functions lock it around the operation. At most one
+ * stripe may be held by a thread at a time.
+ *
+ * Growth is attempted from m0_htable_add() and m0_hbucket_unlock(), where it
+ * only tries stripe locks: a growth step needing a busy stripe (including
+ * one held by the caller) is left to a later attempt. m0_htable_cc_add()
+ * grows after releasing its stripe and waits for the stripes it needs.
+ * Bucket splits and array doubling, therefore, happen either under the
+ * caller's exclusive access to the table, or under the stripe locks of all
+ * affected buckets, and always under m0_htable::h_grow_lock. Objects of a resizable table must be removed through
+ * m0_htable_del() or m0_htable_cc_del() only, because the table keeps a
+ * count of its objects.
+ *
  * @{
  */
 
@@ -150,14 +189,26 @@ struct m0_htable;
 struct m0_hbucket;
 struct m0_ht_descr;
 
+enum {
+	/** Maximal number of stripe locks per m0_htable. */
+	M0_HT_STRIPE_NR  = 64,
+	/**
+	 * Average number of objects per bucket above which a resizable
+	 * m0_htable splits a bucket.
+	 */
+	M0_HT_LOAD_MAX   = 2,
+};
+
+/**
+ * Value of m0_htable::h_bucket_nr seen by the hash function of a resizable
+ * m0_htable.
+ */
+#define M0_HT_HASH_RANGE (1ULL << 32)
+
 /**
  * Represents a simple hash bucket.
  */
 struct m0_hbucket {
-	/**
-	 * A lock to guard concurrent access to the list of objects.
-	 */
-	struct m0_mutex hb_mutex;
 	/**
 	 * List of objects which lie in same hash bucket.
 	 * A single m0_tl_descr object would be used by all
@@ -181,11 +232,48 @@ struct m0_htable {
 	 * Array of hash buckets.
 	 * Hash buckets are supposed to be indexed in increasing order of
 	 * bucket id retrieved using hash function.
+	 * A resizable table has 2 * h_base_nr buckets allocated, of which
+	 * the first h_bucket_nr are used.
 	 */
 	struct m0_hbucket        *h_buckets;
 
 	/** Associated hash table descriptor. */
 	const struct m0_ht_descr *h_descr;
+
+	/** Stripe locks, protecting h_buckets. */
+	struct m0_mutex          *h_stripes;
+
+	/** Number of stripe locks. A power of 2 for a resizable table. */
+	uint64_t                  h_stripe_nr;
+
+	/** True iff the table was initialised by m0_htable_init_resizable(). */
+	bool                      h_resizable;
+
+	/**
+	 * Number of buckets at the beginning of the current split round of a
+	 * resizable table. A power of 2.
+	 */
+	uint64_t                  h_base_nr;
+
+	/**
+	 * Next bucket to split. Buckets [0, h_split) and
+	 * [h_base_nr, h_base_nr + h_split) have already been split in the
+	 * current round. h_bucket_nr == h_base_nr + h_split.
+	 */
+	struct m0_atomic64        h_split;
+
+	/** Number of objects in a resizable table. */
+	struct m0_atomic64        h_obj_nr;
+
+	/**
+	 * M0_HT_LOAD_MAX * h_bucket_nr, the number of objects above which a
+	 * resizable table grows. Lets insertions check for growth without
+	 * h_grow_lock.
+	 */
+	struct m0_atomic64        h_obj_max;
+
+	/** Serialises growth of a resizable table. */
+	struct m0_mutex           h_grow_lock;
 };
 
 /**
@@ -237,6 +325,18 @@ M0_INTERNAL int m0_htable_init(const struct m0_ht_descr *d,
 			       struct m0_htable         *htable,
 			       uint64_t                  bucket_nr);
 
+/**
+ * Initializes a hashtable which grows with the number of objects stored in
+ * it, see "Resizable tables" above.
+ * @param bucket_nr Initial number of buckets, rounded up to a power of 2.
+ * @pre   htable != NULL &&
+ *        bucket_nr > 0    &&
+ *        d != NULL.
+ */
+M0_INTERNAL int m0_htable_init_resizable(const struct m0_ht_descr *d,
+					 struct m0_htable         *htable,
+					 uint64_t                  bucket_nr);
+
 /* Checks if hash-table is initialised. */
 M0_INTERNAL bool m0_htable_is_init(const struct m0_htable *htable);
 
@@ -302,14 +402,17 @@ M0_INTERNAL void *m0_htable_cc_lookup(struct m0_htable *htable,
 /** Returns if m0_htable contains any objects. */
 M0_INTERNAL bool m0_htable_is_empty(const struct m0_htable *htable);
 
-/** Returns number of objects stored within m0_htable. */
+/**
+ * Returns number of objects stored within m0_htable.
+ * Constant time for a resizable table, linear otherwise.
+ */
 M0_INTERNAL uint64_t m0_htable_size(const struct m0_htable *htable);
 
-/** Locks the bucket to which the key belongs. */
+/** Locks the stripe of the bucket to which the key belongs. */
 M0_INTERNAL void m0_hbucket_lock(struct m0_htable *htable,
 				 const void       *key);
 
-/** Unlocks the bucket to which the key belongs. */
+/** Unlocks the stripe of the bucket to which the key belongs. */
 M0_INTERNAL void m0_hbucket_unlock(struct m0_htable *htable,
 				   const void       *key);
 
@@ -354,6 +457,8 @@ M0_TL_DECLARE(name, scope, amb_type);                                        \
 									     \
 scope int name ## _htable_init(struct m0_htable *htable,		     \
 			       uint64_t          bucket_nr);		     \
+scope int name ## _htable_init_resizable(struct m0_htable *htable,	     \
+					 uint64_t          bucket_nr);	     \
 scope void name ## _htable_add(struct m0_htable *htable, amb_type *amb);     \
 scope void name ## _htable_del(struct m0_htable *htable, amb_type *amb);     \
 scope amb_type *name ## _htable_lookup(const struct m0_htable *htable,	     \
@@ -384,6 +489,12 @@ scope __AUN int name ## _htable_init(struct m0_htable *htable,		     \
 	return m0_htable_init(&name ## _ht, htable, bucket_nr);		     \
 }									     \
 									     \
+scope __AUN int name ## _htable_init_resizable(struct m0_htable *htable,     \
+					       uint64_t          bucket_nr)  \
+{									     \
+	return m0_htable_init_resizable(&name ## _ht, htable, bucket_nr);    \
+}									     \
+									     \
 scope __AUN void name ## _htable_add(struct m0_htable *htable,		     \
 				     amb_type         *amb)		     \
 {									     \
@@ -121,6 +121,16 @@ M0_INTERNAL int m0_arch_dont_dump(void *p, size_t size)
 	return 0;
 }
 
+M0_INTERNAL int m0_arch_memory_bind(void *p, size_t size, int node)
+{
+	return -ENOSYS;
+}
+
+M0_INTERNAL int m0_arch_memory_thread_bind(int node)
+{
+	return -ENOSYS;
+}
+
 M0_INTERNAL int m0_arch_memory_init(void)
 {
 	return 0;
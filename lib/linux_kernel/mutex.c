@@ -26,6 +26,7 @@
 
 #include "lib/mutex.h"
 #include "lib/misc.h"  /* M0_EXPORTED */
+#include "lib/errno.h" /* EBUSY */
 
 /**
    @addtogroup mutex
@@ -55,7 +56,8 @@ M0_EXPORTED(m0_arch_mutex_lock);
 
 M0_INTERNAL int m0_arch_mutex_trylock(struct m0_arch_mutex *mutex)
 {
-	return mutex_trylock(&mutex->m_mutex);
+	/* mutex_trylock() returns 1 on success, m0_mutex_trylock() 0. */
+	return mutex_trylock(&mutex->m_mutex) ? 0 : -EBUSY;
 }
 
 M0_INTERNAL void m0_arch_mutex_unlock(struct m0_arch_mutex *mutex)
@@ -95,6 +95,8 @@ M0_INTERNAL void   m0_arch_free_aligned(void *data, size_t size, unsigned shft);
 M0_INTERNAL int    m0_arch_pagesize_get(void);
 M0_INTERNAL int    m0_arch_pageshift_get(void);
 M0_INTERNAL int    m0_arch_dont_dump(void *p, size_t size);
+M0_INTERNAL int    m0_arch_memory_bind(void *p, size_t size, int node);
+M0_INTERNAL int    m0_arch_memory_thread_bind(int node);
 M0_INTERNAL int    m0_arch_memory_init (void);
 M0_INTERNAL void   m0_arch_memory_fini (void);
 
@@ -248,6 +250,20 @@ M0_INTERNAL int m0_dont_dump(void *p, size_t size)
 	return m0_arch_dont_dump(p, size);
 }
 
+M0_INTERNAL int m0_memory_bind(void *p, size_t size, int node)
+{
+	int pagesize = m0_pagesize_get();
+	M0_PRE(((unsigned long)p / pagesize * pagesize) == (unsigned long)p);
+	M0_PRE(node >= 0);
+
+	return m0_arch_memory_bind(p, size, node);
+}
+
+M0_INTERNAL int m0_memory_thread_bind(int node)
+{
+	return m0_arch_memory_thread_bind(node);
+}
+
 M0_INTERNAL int m0_memory_init(void)
 {
 	m0_atomic64_set(&allocated, 0);
@@ -175,6 +175,22 @@ M0_INTERNAL bool m0_is_poisoned(const void *p);
  */
 M0_INTERNAL int m0_dont_dump(void *p, size_t size);
 
+/**
+ * Binds physical pages of a memory region to the given NUMA node, see
+ * mbind(2). Pages that are already allocated are migrated to the node.
+ *
+ * Returns -ENOSYS if NUMA memory policies are not supported.
+ */
+M0_INTERNAL int m0_memory_bind(void *p, size_t size, int node);
+
+/**
+ * Makes memory allocations of the calling thread prefer the given NUMA node,
+ * see set_mempolicy(2). Negative "node" restores the default policy.
+ *
+ * Returns -ENOSYS if NUMA memory policies are not supported.
+ */
+M0_INTERNAL int m0_memory_thread_bind(int node);
+
 
 /** @} end of memory group */
 #endif /* __MOTR_LIB_MEMORY_H__ */
@@ -104,10 +104,10 @@ M0_INTERNAL bool m0_mutex_is_locked(const struct m0_mutex *mutex);
 M0_INTERNAL bool m0_mutex_is_not_locked(const struct m0_mutex *mutex);
 
 struct m0_mutex_addb2 {
-	m0_time_t            ma_taken;
-	struct m0_addb2_hist ma_hold;
-	struct m0_addb2_hist ma_wait;
-	uint64_t             ma_id;
+	m0_time_t               ma_taken;
+	struct m0_addb2_loghist ma_hold;
+	struct m0_addb2_loghist ma_wait;
+	uint64_t                ma_id;
 };
 
 /*
@@ -49,6 +49,14 @@
  * file. Buffer space allocation is controlled by a single atomic variable
  * (m0_trace_buf_header::tbh_cur_pos).
  *
+ * In user space a thread does not go to tbh_cur_pos for every record. It
+ * reserves a chunk of the buffer (see trace_chunk) and places its records
+ * there, so that concurrent threads do not bounce the trace buffer header
+ * cache lines on every M0_ENTRY()/M0_LEAVE(). As a result, records of
+ * different threads are interleaved in the buffer in chunk-sized pieces, and
+ * m0_trace_parse() sorts them by timestamp. Such buffers are marked with
+ * M0_TRACE_BUF_CHUNKED.
+ *
  * Trace entries contain pointers from the process address space. To interpret
  * them, m0_trace_parse() must be called in the same binary. See utils/ut_main.c
  * for example.
@@ -88,6 +96,57 @@ size_t         m0_logbufsize = sizeof bootlog.bl_buf;
 static size_t  bufmask       = sizeof bootlog.bl_buf - 1;
 M0_BASSERT(((sizeof bootlog.bl_buf) & ((sizeof bootlog.bl_buf) - 1)) == 0);
 
+/**
+ * Incremented every time the trace buffer is switched or resized, which
+ * invalidates the chunks reserved by threads in the previous buffer.
+ *
+ * Buffers are switched by m0_trace_init() and m0_trace_fini(), after the new
+ * m0_logbuf, m0_logbufsize and bufmask are set. The atomic increment orders
+ * these stores before the new generation, so a thread which sees the new
+ * generation in chunk_reserve() reserves its next chunk in the new buffer.
+ * A thread tracing concurrently with the switch itself may still place a
+ * record in the old buffer, as before chunks were introduced.
+ */
+static struct m0_atomic64 bufgen;
+
+#ifndef __KERNEL__
+enum {
+	/** Size of a per-thread trace chunk, see trace_chunk. */
+	TRACE_CHUNK_SIZE = 1 << 14, /* 16K */
+	/**
+	 * Buffers smaller than TRACE_CHUNK_SIZE * TRACE_CHUNK_MIN_NR use
+	 * proportionally smaller chunks.
+	 */
+	TRACE_CHUNK_MIN_NR = 16,
+};
+
+/**
+ * Per-thread part of the trace buffer.
+ *
+ * A chunk is reserved with one atomic add on m0_trace_buf_header::tbh_cur_pos
+ * and a block of record numbers with one atomic add on
+ * m0_trace_buf_header::tbh_rec_cnt. The block is large enough for the
+ * smallest possible records filling the chunk, so m0_trace_allot() of the
+ * owner thread takes both the position and the record number from the chunk
+ * without touching shared state.
+ *
+ * The chunk is zeroed when reserved, so that the trace parser does not find
+ * stale records in its unused tail.
+ */
+struct trace_chunk {
+	/** Value of bufgen when the chunk was reserved. */
+	uint64_t tc_gen;
+	/** Absolute position of the first free byte in the chunk. */
+	uint64_t tc_pos;
+	/** Absolute position of the chunk end. */
+	uint64_t tc_end;
+	/** Next record number. */
+	uint64_t tc_no;
+};
+
+static __thread struct trace_chunk trace_chunk;
+#endif
+
 unsigned long m0_trace_immediate_mask = 0;
 M0_EXPORTED(m0_trace_immediate_mask);
 M0_BASSERT(sizeof(m0_trace_immediate_mask) == 8);
@@ -222,6 +281,77 @@ M0_INTERNAL void m0_trace_level_allow(unsigned level)
 }
 M0_EXPORTED(m0_trace_level_allow);
 
+#define TRACE_REC_HEADER_LEN \
+	m0_align(sizeof(struct m0_trace_rec_header), M0_TRACE_REC_ALIGN)
+
+/**
+ * Reserves len bytes in the trace buffer, returns absolute position of the
+ * reserved space. The reserved space never crosses the buffer end.
+ */
+static uint64_t buf_reserve(struct m0_trace_buf_header *tbh, uint32_t len)
+{
+	uint64_t pos;
+	uint64_t endpos;
+	uint32_t pos_in_buf;
+	uint32_t endpos_in_buf;
+
+	while (1) {
+		endpos = m0_atomic64_add_return(&tbh->tbh_cur_pos, len);
+		pos    = endpos - len;
+		pos_in_buf = pos & bufmask;
+		endpos_in_buf = endpos & bufmask;
+		/*
+		 * The record should not cross the buffer.
+		 */
+		if (pos_in_buf > endpos_in_buf && endpos_in_buf) {
+			memset(m0_logbuf + pos_in_buf, 0,
+			       m0_logbufsize - pos_in_buf);
+			memset(m0_logbuf, 0, endpos_in_buf);
+		} else
+			return pos;
+	}
+}
+
+#ifndef __KERNEL__
+static void chunk_reserve(struct m0_trace_buf_header *tbh, uint32_t len,
+			  uint64_t *pos, uint64_t *no)
+{
+	struct trace_chunk *tc   = &trace_chunk;
+	uint32_t            size = min_check((uint32_t)TRACE_CHUNK_SIZE,
+					     (uint32_t)(m0_logbufsize /
+							TRACE_CHUNK_MIN_NR));
+	uint64_t            nr   = size / TRACE_REC_HEADER_LEN;
+	uint64_t            gen;
+
+	if (len > size / 4) {
+		/* Large records would waste too much of a chunk. */
+		*no  = m0_atomic64_add_return(&tbh->tbh_rec_cnt, 1);
+		*pos = buf_reserve(tbh, len);
+		return;
+	}
+	gen = m0_atomic64_get(&bufgen);
+	/*
+	 * Other threads may have wrapped the buffer around since the chunk
+	 * was reserved, giving its space to newer chunks. Writing into it
+	 * then would tear their records. Keep a margin of one chunk for
+	 * reservations racing with this check.
+	 */
+	if (tc->tc_gen != gen || tc->tc_pos + len > tc->tc_end ||
+	    m0_atomic64_get(&tbh->tbh_cur_pos) - tc->tc_pos >
+	    m0_logbufsize - size) {
+		tc->tc_gen = gen;
+		tc->tc_pos = buf_reserve(tbh, size);
+		tc->tc_end = tc->tc_pos + size;
+		tc->tc_no  = m0_atomic64_add_return(&tbh->tbh_rec_cnt, nr) -
+			     nr + 1;
+		memset(m0_logbuf + (tc->tc_pos & bufmask), 0, size);
+	}
+	*pos = tc->tc_pos;
+	*no  = tc->tc_no++;
+	tc->tc_pos += len;
+}
+#endif
+
 M0_INTERNAL void m0_trace_allot(const struct m0_trace_descr *td,
 				const void *body)
 {
@@ -229,9 +359,7 @@ M0_INTERNAL void m0_trace_allot(const struct m0_trace_descr *td,
 	uint32_t  header_len;
 	uint32_t  record_len;
 	uint32_t  pos_in_buf;
-	uint32_t  endpos_in_buf;
 	uint64_t  pos;
-	uint64_t  endpos;
 	uint32_t  str_data_size;
 	void     *body_in_buf;
 	char     *dst_str;
@@ -254,8 +382,6 @@ M0_INTERNAL void m0_trace_allot(const struct m0_trace_descr *td,
 	if (td->td_level > allowed_level)
 		return;
 
-	record_num = m0_atomic64_add_return(&tbh->tbh_rec_cnt, 1);
-
 	/*
 	 * Allocate space in trace buffer to store trace record header
 	 * (header_len bytes) and record payload (record_len bytes).
@@ -275,26 +401,18 @@ M0_INTERNAL void m0_trace_allot(const struct m0_trace_descr *td,
 	 * would require additional synchronization between contending threads).
 	 */
 
-	header_len    = m0_align(sizeof *header, M0_TRACE_REC_ALIGN);
+	header_len    = TRACE_REC_HEADER_LEN;
 	str_data_size = calc_string_data_size(td, body);
 	record_len    = header_len + m0_align(td->td_size, M0_TRACE_REC_ALIGN) +
 			m0_align(str_data_size, M0_TRACE_REC_ALIGN);
 
-	while (1) {
-		endpos = m0_atomic64_add_return(&tbh->tbh_cur_pos, record_len);
-		pos    = endpos - record_len;
-		pos_in_buf = pos & bufmask;
-		endpos_in_buf = endpos & bufmask;
-		/*
-		 * The record should not cross the buffer.
-		 */
-		if (pos_in_buf > endpos_in_buf && endpos_in_buf) {
-			memset(m0_logbuf + pos_in_buf, 0,
-			       m0_logbufsize - pos_in_buf);
-			memset(m0_logbuf, 0, endpos_in_buf);
-		} else
-			break;
-	}
+#ifdef __KERNEL__
+	record_num = m0_atomic64_add_return(&tbh->tbh_rec_cnt, 1);
+	pos        = buf_reserve(tbh, record_len);
+#else
+	chunk_reserve(tbh, record_len, &pos, &record_num);
+#endif
+	pos_in_buf = pos & bufmask;
 
 	m0_trace_stats_update(record_len);
 
@@ -632,6 +750,7 @@ M0_INTERNAL void m0_trace_logbuf_size_set(size_t size)
 	M0_PRE(m0_is_po2(size) && size % m0_pagesize_get() == 0);
 	m0_logbufsize = size;
 	bufmask = size ? size - 1 : 0;
+	m0_atomic64_inc(&bufgen);
 }
 M0_EXPORTED(m0_trace_logbuf_size_set);
 
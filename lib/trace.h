@@ -341,8 +341,13 @@ enum m0_trace_buf_type {
 };
 
 enum m0_trace_buf_flags {
-	M0_TRACE_BUF_MKFS  = 1 << 0,
-	M0_TRACE_BUF_DIRTY = 1 << 1,
+	M0_TRACE_BUF_MKFS    = 1 << 0,
+	M0_TRACE_BUF_DIRTY   = 1 << 1,
+	/**
+	 * Records are placed in per-thread chunks and are not ordered by
+	 * position in the buffer, see m0_trace_allot().
+	 */
+	M0_TRACE_BUF_CHUNKED = 1 << 2,
 
 	M0_TRACE_BUF_FLAGS_MAX
 };
@@ -383,7 +388,11 @@ struct m0_trace_buf_header {
 			 * m0_trace_allot()
 			 */
 			struct m0_atomic64      tbh_cur_pos;
-			/** Record counter */
+			/**
+			 * Record counter. With M0_TRACE_BUF_CHUNKED record
+			 * numbers are handed out in blocks, so this is an
+			 * upper bound of the number of records.
+			 */
 			struct m0_atomic64      tbh_rec_cnt;
 			/**
 			 * Address of special trace magic symbol (used for trace
@@ -24,6 +24,8 @@
 #include <unistd.h>
 #include <errno.h>
 #include <sys/mman.h>
+#include <sys/syscall.h>        /* SYS_mbind, SYS_set_mempolicy */
+#include <linux/mempolicy.h>    /* MPOL_BIND, MPOL_PREFERRED */
 
 #include "lib/arith.h"   /* min_type, m0_is_po2 */
 #include "lib/assert.h"
@@ -194,6 +196,42 @@ M0_INTERNAL int m0_arch_dont_dump(void *p, size_t size)
 	return rc;
 }
 
+/*
+ * NUMA policies are set through system calls directly, to avoid dependency
+ * on libnuma.
+ */
+enum { NODE_MASK_BITS = sizeof(unsigned long) * 8 };
+
+M0_INTERNAL int m0_arch_memory_bind(void *p, size_t size, int node)
+{
+	unsigned long mask;
+
+	if (node >= NODE_MASK_BITS)
+		return M0_ERR(-EINVAL);
+	mask = 1UL << node;
+	if (syscall(SYS_mbind, p, size, MPOL_BIND, &mask, NODE_MASK_BITS,
+		    MPOL_MF_MOVE) != 0)
+		return M0_ERR(-errno);
+	return 0;
+}
+
+M0_INTERNAL int m0_arch_memory_thread_bind(int node)
+{
+	unsigned long mask;
+	long          rc;
+
+	if (node >= NODE_MASK_BITS)
+		return M0_ERR(-EINVAL);
+	if (node < 0)
+		rc = syscall(SYS_set_mempolicy, MPOL_DEFAULT, NULL, 0);
+	else {
+		mask = 1UL << node;
+		rc = syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask,
+			     NODE_MASK_BITS);
+	}
+	return rc == 0 ? 0 : M0_ERR(-errno);
+}
+
 M0_INTERNAL int m0_arch_memory_init(void)
 {
 	void *nothing;
@@ -306,7 +306,7 @@ M0_INTERNAL void m0_arch_trace_buf_header_init(struct m0_trace_buf_header *tbh)
 	if (strstr(tbh->tbh_cli_args, "m0mkfs") != NULL)
 		tbh->tbh_buf_flags |= M0_TRACE_BUF_MKFS;
 
-	tbh->tbh_buf_flags |= M0_TRACE_BUF_DIRTY;
+	tbh->tbh_buf_flags |= M0_TRACE_BUF_DIRTY | M0_TRACE_BUF_CHUNKED;
 }
 
 static unsigned align(FILE *file, uint64_t align, uint64_t pos)
@@ -395,8 +395,14 @@ static void print_trace_buf_header(FILE *ofile,
 	if (tbh->tbh_buf_flags & M0_TRACE_BUF_MKFS) {
 		if (need_comma)
 			fprintf(ofile, ", ");
+		need_comma = true;
 		fprintf(ofile, "MKFS");
 	}
+	if (tbh->tbh_buf_flags & M0_TRACE_BUF_CHUNKED) {
+		if (need_comma)
+			fprintf(ofile, ", ");
+		fprintf(ofile, "CHUNKED");
+	}
 	fprintf(ofile, " ]\n");
 
 	fprintf(ofile, "  header_addr:        %p\n", tbh->tbh_header_addr);
@@ -528,18 +534,108 @@ enum {
 };
 
 /**
- * Parse log buffer from a trace file.
- *
- * Normally a trace file would be called "m0trace.12345" or something like that,
- * where number represents a PID of the process which created that trace file.
- *
- * Returns sysexits.h error codes.
+ * Records of a M0_TRACE_BUF_CHUNKED trace buffer, collected by trace_parse()
+ * to be printed in timestamp order.
  */
-M0_INTERNAL int m0_trace_parse(FILE *trace_file, FILE *output_file,
-			       const char *m0tr_ko_path,
-			       enum m0_trace_parse_flags flags,
-			       const void *magic_symbols[],
-			       unsigned int magic_symbols_nr)
+struct trace_stash {
+	bool                    ts_enabled;
+	size_t                  ts_nr;
+	size_t                  ts_alloc;
+	struct trace_stash_rec *ts_recs;
+};
+
+/** Stashed record, its descriptor and data. */
+struct trace_stash_rec {
+	struct m0_trace_rec_header tsr_trh;
+	struct m0_trace_descr      tsr_td;
+	char                      *tsr_buf;
+};
+
+static int trace_stash_add(struct trace_stash *stash,
+			   const struct m0_trace_rec_header *trh, char *buf)
+{
+	struct trace_stash_rec *rec;
+
+	if (stash->ts_nr == stash->ts_alloc) {
+		size_t nr = stash->ts_alloc == 0 ? 1024 : stash->ts_alloc * 2;
+
+		M0_ALLOC_ARR(rec, nr);
+		if (rec == NULL)
+			return -ENOMEM;
+		if (stash->ts_nr > 0)
+			memcpy(rec, stash->ts_recs,
+			       stash->ts_nr * sizeof stash->ts_recs[0]);
+		m0_free(stash->ts_recs);
+		stash->ts_recs  = rec;
+		stash->ts_alloc = nr;
+	}
+	rec = &stash->ts_recs[stash->ts_nr++];
+	rec->tsr_trh = *trh;
+	rec->tsr_td  = *trh->trh_descr;
+	rec->tsr_buf = buf;
+	return 0;
+}
+
+static int trace_stash_rec_cmp(const void *a, const void *b)
+{
+	const struct m0_trace_rec_header *x =
+		&((const struct trace_stash_rec *)a)->tsr_trh;
+	const struct m0_trace_rec_header *y =
+		&((const struct trace_stash_rec *)b)->tsr_trh;
+
+	return M0_3WAY(x->trh_timestamp, y->trh_timestamp) ?:
+		M0_3WAY(x->trh_no, y->trh_no);
+}
+
+static void trace_rec_print(FILE *output_file,
+			    const struct m0_trace_rec_header *trh,
+			    const char *buf, enum m0_trace_parse_flags flags)
+{
+	static char yaml_buf[256 * 1024]; /* 256 KB */
+	int         rc;
+
+	rc = m0_trace_record_print_yaml(yaml_buf, sizeof yaml_buf, trh,
+			buf, !(flags & M0_TRACE_PARSE_YAML_SINGLE_DOC_OUTPUT));
+	if (rc == 0)
+		fprintf(output_file, "%s", yaml_buf);
+	else if (rc == -ENOBUFS)
+		warnx("Internal buffer is too small to hold trace record");
+	else
+		warnx("Failed to process trace record data for %p"
+		      " descriptor", trh->trh_descr);
+}
+
+static void trace_stash_flush(FILE *output_file, struct trace_stash *stash,
+			      enum m0_trace_parse_flags flags)
+{
+	struct trace_stash_rec *rec;
+	size_t                  i;
+
+	qsort(stash->ts_recs, stash->ts_nr, sizeof stash->ts_recs[0],
+	      &trace_stash_rec_cmp);
+	for (i = 0; i < stash->ts_nr; ++i) {
+		rec = &stash->ts_recs[i];
+		rec->tsr_trh.trh_descr = &rec->tsr_td;
+		trace_rec_print(output_file, &rec->tsr_trh, rec->tsr_buf,
+				flags);
+	}
+}
+
+static void trace_stash_fini(struct trace_stash *stash)
+{
+	size_t i;
+
+	for (i = 0; i < stash->ts_nr; ++i)
+		m0_free(stash->ts_recs[i].tsr_buf);
+	m0_free(stash->ts_recs);
+}
+
+static int trace_parse(FILE *trace_file, FILE *output_file,
+		       const char *m0tr_ko_path,
+		       enum m0_trace_parse_flags flags,
+		       const void *magic_symbols[],
+		       unsigned int magic_symbols_nr,
+		       struct trace_stash *stash)
 {
 	const struct m0_trace_buf_header *tbh;
 	struct m0_trace_rec_header        trh;
@@ -556,7 +652,6 @@ M0_INTERNAL int m0_trace_parse(FILE *trace_file, FILE *output_file,
 	bool       td_is_sane;
 	char      *buf;
 
-	static char  yaml_buf[256 * 1024]; /* 256 KB */
 	ptrdiff_t   *td_offset;
 	ptrdiff_t    td_offsets[MAGIC_SYM_OFFSETS_MAX + 1] = { 0 };
 	size_t       td_offsets_nr =
@@ -570,6 +665,7 @@ M0_INTERNAL int m0_trace_parse(FILE *trace_file, FILE *output_file,
 	print_trace_buf_header(output_file, tbh);
 	if (flags & M0_TRACE_PARSE_HEADER_ONLY)
 		return 0;
+	stash->ts_enabled = tbh->tbh_buf_flags & M0_TRACE_BUF_CHUNKED;
 
 	rc = calc_trace_descr_offset(tbh, m0tr_ko_path, &td_offsets[0]);
 	if (rc != 0)
@@ -678,20 +774,49 @@ M0_INTERNAL int m0_trace_parse(FILE *trace_file, FILE *output_file,
 		}
 		pos += nr;
 
-		rc = m0_trace_record_print_yaml(yaml_buf, sizeof yaml_buf, &trh,
-			buf, !(flags & M0_TRACE_PARSE_YAML_SINGLE_DOC_OUTPUT));
-		if (rc == 0)
-			fprintf(output_file, "%s", yaml_buf);
-		else if (rc == -ENOBUFS)
-			warnx("Internal buffer is too small to hold trace record");
-		else
-			warnx("Failed to process trace record data for %p"
-			      " descriptor", trh.trh_descr);
+		if (stash->ts_enabled) {
+			if (trace_stash_add(stash, &trh, buf) != 0) {
+				warnx("Failed to allocate memory for sorting"
+				      " of trace records");
+				m0_free(buf);
+				return EX_OSERR;
+			}
+			continue;
+		}
+		trace_rec_print(output_file, &trh, buf, flags);
 		m0_free(buf);
 	}
 	return EX_OK;
 }
 
+/**
+ * Parse log buffer from a trace file.
+ *
+ * Normally a trace file would be called "m0trace.12345" or something like that,
+ * where number represents a PID of the process which created that trace file.
+ *
+ * Records of a M0_TRACE_BUF_CHUNKED buffer are printed in timestamp order,
+ * other buffers are printed in the order of records in the file.
+ *
+ * Returns sysexits.h error codes.
+ */
+M0_INTERNAL int m0_trace_parse(FILE *trace_file, FILE *output_file,
+			       const char *m0tr_ko_path,
+			       enum m0_trace_parse_flags flags,
+			       const void *magic_symbols[],
+			       unsigned int magic_symbols_nr)
+{
+	struct trace_stash stash = {};
+	int                rc;
+
+	rc = trace_parse(trace_file, output_file, m0tr_ko_path, flags,
+			 magic_symbols, magic_symbols_nr, &stash);
+	if (rc == EX_OK)
+		trace_stash_flush(output_file, &stash, flags);
+	trace_stash_fini(&stash);
+	return rc;
+}
+
 M0_INTERNAL void m0_console_vprintf(const char *fmt, va_list args)
 {
 	vprintf(fmt, args);
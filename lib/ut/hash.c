@@ -23,6 +23,9 @@
 #include "lib/bob.h"	/* m0_bob_type */
 #include "lib/hash.h"   /* m0_htable */
 #include "lib/errno.h"  /* Include appropriate errno.h header. */
+#include "lib/memory.h" /* M0_ALLOC_ARR() */
+#include "lib/thread.h" /* M0_THREAD_INIT() */
+#include "lib/ub.h"	/* m0_ub_set */
 #include "motr/magic.h"
 #include "ut/ut.h"	/* M0_UT_ASSERT() */
 
@@ -51,6 +54,10 @@ enum {
 	FOO_NR    = 19,
 	BAR_MAGIC = 0xa817115ad15ababaULL,
 	FOO_MAGIC = 0x911ea3a7096a96e5ULL,
+	/* Objects added to a resizable table. */
+	RFOO_NR   = 4096,
+	/* Threads populating a resizable table concurrently. */
+	THREAD_NR = 4,
 };
 
 static struct foo foos[FOO_NR];
@@ -156,6 +163,223 @@ void test_hashtable(void)
 	M0_UT_ASSERT(thebar.b_hash.h_magic     == 0);
 }
 
+static struct foo *rfoos;
+
+static void rfoos_init(int nr)
+{
+	int i;
+
+	M0_ALLOC_ARR(rfoos, nr);
+	M0_UT_ASSERT(rfoos != NULL);
+	for (i = 0; i < nr; ++i) {
+		rfoos[i].f_magic = FOO_MAGIC;
+		rfoos[i].f_hkey  = i;
+		m0_tlink_init(&foohash_tl, &rfoos[i]);
+	}
+}
+
+static void rfoos_fini(int nr)
+{
+	int i;
+
+	for (i = 0; i < nr; ++i)
+		m0_tlink_fini(&foohash_tl, &rfoos[i]);
+	m0_free0(&rfoos);
+}
+
+static void resizable_worker(int idx)
+{
+	int i;
+
+	/* Half of objects go through explicit stripe locking. */
+	for (i = idx; i < RFOO_NR; i += THREAD_NR) {
+		if (i % 4 < 2) {
+			foohash_htable_cc_add(&thebar.b_hash, &rfoos[i]);
+		} else {
+			foohash_hbucket_lock(&thebar.b_hash, &rfoos[i].f_hkey);
+			foohash_htable_add(&thebar.b_hash, &rfoos[i]);
+			foohash_hbucket_unlock(&thebar.b_hash,
+					       &rfoos[i].f_hkey);
+		}
+	}
+	for (i = idx; i < RFOO_NR; i += THREAD_NR)
+		M0_UT_ASSERT(foohash_htable_cc_lookup(&thebar.b_hash,
+					&rfoos[i].f_hkey) == &rfoos[i]);
+	/* Delete odd keys. */
+	for (i = idx; i < RFOO_NR; i += THREAD_NR) {
+		if (i % 2 == 1)
+			foohash_htable_cc_del(&thebar.b_hash, &rfoos[i]);
+	}
+}
+
+void test_hashtable_resizable(void)
+{
+	struct m0_thread t[THREAD_NR] = {};
+	uint64_t         key;
+	uint64_t         nr;
+	struct foo      *f;
+	int              rc;
+	int              i;
+
+	rfoos_init(RFOO_NR);
+	/* Initial number of buckets is rounded up to a power of 2. */
+	rc = foohash_htable_init_resizable(&thebar.b_hash, 3);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(thebar.b_hash.h_bucket_nr == 4);
+
+	for (i = 0; i < RFOO_NR; ++i) {
+		foohash_htable_add(&thebar.b_hash, &rfoos[i]);
+		M0_UT_ASSERT(foohash_htable_size(&thebar.b_hash) == i + 1);
+		/* Uncontended growth keeps the load within the limit. */
+		M0_UT_ASSERT(i + 1 <= M0_HT_LOAD_MAX *
+			     thebar.b_hash.h_bucket_nr);
+	}
+	M0_UT_ASSERT(thebar.b_hash.h_bucket_nr >= RFOO_NR / M0_HT_LOAD_MAX);
+	/* Every object is in the bucket its hash maps to. */
+	M0_UT_ASSERT(m0_htable_is_init(&thebar.b_hash));
+	for (i = 0; i < RFOO_NR; ++i)
+		M0_UT_ASSERT(foohash_htable_lookup(&thebar.b_hash,
+					&rfoos[i].f_hkey) == &rfoos[i]);
+	key = RFOO_NR;
+	M0_UT_ASSERT(foohash_htable_lookup(&thebar.b_hash, &key) == NULL);
+	nr = 0;
+	m0_htable_for(foohash, f, &thebar.b_hash) {
+		M0_UT_ASSERT(f == &rfoos[f->f_hkey]);
+		++nr;
+	} m0_htable_endfor;
+	M0_UT_ASSERT(nr == RFOO_NR);
+
+	for (i = 0; i < RFOO_NR; i += 2)
+		foohash_htable_del(&thebar.b_hash, &rfoos[i]);
+	M0_UT_ASSERT(foohash_htable_size(&thebar.b_hash) == RFOO_NR / 2);
+	for (i = 0; i < RFOO_NR; ++i)
+		M0_UT_ASSERT(foohash_htable_lookup(&thebar.b_hash,
+						   &rfoos[i].f_hkey) ==
+			     (i % 2 == 0 ? NULL : &rfoos[i]));
+	for (i = 1; i < RFOO_NR; i += 2)
+		foohash_htable_del(&thebar.b_hash, &rfoos[i]);
+	M0_UT_ASSERT(foohash_htable_is_empty(&thebar.b_hash));
+	foohash_htable_fini(&thebar.b_hash);
+
+	/* Concurrent growth under stripe locks. */
+	rc = foohash_htable_init_resizable(&thebar.b_hash, 16);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(thebar.b_hash.h_stripe_nr == 16);
+	for (i = 0; i < THREAD_NR; ++i) {
+		rc = M0_THREAD_INIT(&t[i], int, NULL, &resizable_worker, i,
+				    "ht-grow-%d", i);
+		M0_UT_ASSERT(rc == 0);
+	}
+	for (i = 0; i < THREAD_NR; ++i) {
+		m0_thread_join(&t[i]);
+		m0_thread_fini(&t[i]);
+	}
+	M0_UT_ASSERT(m0_htable_is_init(&thebar.b_hash));
+	M0_UT_ASSERT(foohash_htable_size(&thebar.b_hash) == RFOO_NR / 2);
+	for (i = 0; i < RFOO_NR; ++i) {
+		M0_UT_ASSERT(foohash_htable_lookup(&thebar.b_hash,
+						   &rfoos[i].f_hkey) ==
+			     (i % 2 == 1 ? NULL : &rfoos[i]));
+		if (i % 2 == 0)
+			foohash_htable_del(&thebar.b_hash, &rfoos[i]);
+	}
+	M0_UT_ASSERT(foohash_htable_is_empty(&thebar.b_hash));
+	foohash_htable_fini(&thebar.b_hash);
+	rfoos_fini(RFOO_NR);
+}
+
+enum {
+	HT_UB_NR        = 1000000,
+	HT_UB_BUCKET_NR = 0x1000,
+};
+
+static struct m0_htable ht_ub_fixed;
+static struct m0_htable ht_ub_resizable;
+
+static int ht_ub_init(const char *opts M0_UNUSED)
+{
+	int rc;
+
+	rfoos_init(HT_UB_NR);
+	rc = foohash_htable_init(&ht_ub_fixed, HT_UB_BUCKET_NR);
+	M0_ASSERT(rc == 0);
+	rc = foohash_htable_init_resizable(&ht_ub_resizable, HT_UB_BUCKET_NR);
+	M0_ASSERT(rc == 0);
+	return 0;
+}
+
+static void ht_ub_fini(void)
+{
+	foohash_htable_fini(&ht_ub_resizable);
+	foohash_htable_fini(&ht_ub_fixed);
+	rfoos_fini(HT_UB_NR);
+}
+
+static void ht_ub_add_fixed(int i)
+{
+	foohash_htable_add(&ht_ub_fixed, &rfoos[i]);
+}
+
+static void ht_ub_lookup_fixed(int i)
+{
+	M0_ASSERT(foohash_htable_lookup(&ht_ub_fixed,
+					&rfoos[i].f_hkey) == &rfoos[i]);
+}
+
+static void ht_ub_del_fixed(int i)
+{
+	foohash_htable_del(&ht_ub_fixed, &rfoos[i]);
+}
+
+static void ht_ub_add_resizable(int i)
+{
+	foohash_htable_add(&ht_ub_resizable, &rfoos[i]);
+}
+
+static void ht_ub_lookup_resizable(int i)
+{
+	M0_ASSERT(foohash_htable_lookup(&ht_ub_resizable,
+					&rfoos[i].f_hkey) == &rfoos[i]);
+}
+
+static void ht_ub_del_resizable(int i)
+{
+	foohash_htable_del(&ht_ub_resizable, &rfoos[i]);
+}
+
+struct m0_ub_set m0_hash_ub = {
+	.us_name = "hash-ub",
+	.us_init = ht_ub_init,
+	.us_fini = ht_ub_fini,
+	.us_run  = {
+		{ .ub_name  = "add-fixed",
+		  .ub_iter  = HT_UB_NR,
+		  .ub_round = ht_ub_add_fixed },
+
+		{ .ub_name  = "lookup-fixed",
+		  .ub_iter  = HT_UB_NR,
+		  .ub_round = ht_ub_lookup_fixed },
+
+		{ .ub_name  = "del-fixed",
+		  .ub_iter  = HT_UB_NR,
+		  .ub_round = ht_ub_del_fixed },
+
+		{ .ub_name  = "add-resizable",
+		  .ub_iter  = HT_UB_NR,
+		  .ub_round = ht_ub_add_resizable },
+
+		{ .ub_name  = "lookup-resizable",
+		  .ub_iter  = HT_UB_NR,
+		  .ub_round = ht_ub_lookup_resizable },
+
+		{ .ub_name  = "del-resizable",
+		  .ub_iter  = HT_UB_NR,
+		  .ub_round = ht_ub_del_resizable },
+
+		{ .ub_name = NULL }
+	}
+};
+
 /*
  *  Local variables:
  *  c-indentation-style: "K&R"
@@ -48,12 +48,14 @@ extern void m0_ut_time_test(void);
 extern void test_timer(void);
 extern void test_tlist(void);
 extern void test_trace(void);
+extern void test_trace_wrap(void);
 extern void test_varr(void);
 extern void test_vec(void);
 extern void test_zerovec(void);
 extern void test_locality(void);
 extern void test_locality_chore(void);
 extern void test_hashtable(void);
+extern void test_hashtable_resizable(void);
 extern void test_fold(void);
 extern void m0_ut_lib_thread_pool_test(void);
 extern void test_combinations(void);
@@ -76,6 +78,7 @@ struct m0_ut_suite libm0_ut = {
 		{ "finject",          test_finject,      "Dima" },
 		{ "getopts",          test_getopts       },
 		{ "hash",	      test_hashtable     },
+		{ "hash-resizable",   test_hashtable_resizable },
 		{ "list",             test_list          },
 		{ "locality",         test_locality,     "Nikita" },
 		{ "locality-chore",   test_locality_chore, "Nikita" },
@@ -92,6 +95,7 @@ struct m0_ut_suite libm0_ut = {
 		{ "timer",            test_timer,        "Max" },
 		{ "tlist",            test_tlist         },
 		{ "trace",            test_trace,        "Dima, Andriy" },
+		{ "trace-wrap",       test_trace_wrap,   "Dima, Andriy" },
 		{ "uuid",             m0_test_lib_uuid   },
 		{ "varr",             test_varr          },
 		{ "vec",              test_vec,          "Huang Hua"},
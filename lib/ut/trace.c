@@ -24,9 +24,12 @@
 #include "lib/ub.h"
 #include "ut/ut.h"
 #include "lib/thread.h"
+#include "lib/atomic.h"
+#include "lib/semaphore.h"
 #include "lib/assert.h"
 #define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_UT
 #include "lib/trace.h"
+#include "lib/trace_internal.h" /* m0_trace_logbuf_pos_get */
 
 enum {
 	NR       = 16,
@@ -73,6 +76,81 @@ void test_trace(void)
 		(char *)"foobar");
 }
 
+enum {
+	WRAP_NR = 4
+};
+
+static struct m0_semaphore wrap_ready;
+static struct m0_semaphore wrap_go;
+static struct m0_semaphore wrap_done;
+static struct m0_atomic64  wrap_stop;
+
+/* Logs a record, idles while the buffer wraps, then logs again. */
+static void wrap_idle_func(int d)
+{
+	M0_LOG(M0_DEBUG, "idle: %i", d);
+	m0_semaphore_up(&wrap_ready);
+	m0_semaphore_down(&wrap_go);
+	M0_LOG(M0_DEBUG, "idle again: %i", d);
+	m0_semaphore_up(&wrap_done);
+}
+
+static void wrap_busy_func(int d)
+{
+	while (m0_atomic64_get(&wrap_stop) == 0)
+		M0_LOG(M0_DEBUG, "busy: %i", d);
+}
+
+/*
+ * A thread that idled while other threads wrapped the trace buffer around
+ * must not write into its old chunk, which now belongs to other threads.
+ */
+void test_trace_wrap(void)
+{
+	struct m0_thread idle = {};
+	struct m0_thread busy[WRAP_NR] = {};
+	uint64_t         pos;
+	int              result;
+	int              i;
+
+	m0_semaphore_init(&wrap_ready, 0);
+	m0_semaphore_init(&wrap_go, 0);
+	m0_semaphore_init(&wrap_done, 0);
+	m0_atomic64_set(&wrap_stop, 0);
+
+	result = M0_THREAD_INIT(&idle, int, NULL, &wrap_idle_func, 0,
+				"trace_idle");
+	M0_UT_ASSERT(result == 0);
+	m0_semaphore_down(&wrap_ready);
+	/* The idle thread's chunk starts below this position. */
+	pos = m0_trace_logbuf_pos_get();
+
+	for (i = 0; i < WRAP_NR; ++i) {
+		result = M0_THREAD_INIT(&busy[i], int, NULL, &wrap_busy_func,
+					i, "trace_busy_%i", i);
+		M0_UT_ASSERT(result == 0);
+	}
+	while (m0_trace_logbuf_pos_get() < pos + m0_trace_logbuf_size_get())
+		M0_LOG(M0_DEBUG, "main: %i", 0);
+	m0_atomic64_set(&wrap_stop, 1);
+	for (i = 0; i < WRAP_NR; ++i) {
+		m0_thread_join(&busy[i]);
+		m0_thread_fini(&busy[i]);
+	}
+
+	/* The idle thread has to reserve a new chunk for its next record. */
+	pos = m0_trace_logbuf_pos_get();
+	m0_semaphore_up(&wrap_go);
+	m0_semaphore_down(&wrap_done);
+	M0_UT_ASSERT(m0_trace_logbuf_pos_get() > pos);
+
+	m0_thread_join(&idle);
+	m0_thread_fini(&idle);
+	m0_semaphore_fini(&wrap_done);
+	m0_semaphore_fini(&wrap_go);
+	m0_semaphore_fini(&wrap_ready);
+}
+
 enum {
 	UB_ITER = 5000000
 };
@@ -94,6 +172,74 @@ static void ub_64(int i)
 		i + 6, i + 7);
 }
 
+enum {
+	UB_MT_NR_MAX = 32
+};
+
+/*
+ * Multi-threaded benchmarks: while the benchmark thread logs, UB_MT_NR - 1
+ * helper threads log the same records in a loop. op/sec of "mt-N" is the
+ * records/sec rate of one of N writers; the aggregate rate is N times that.
+ */
+static struct m0_thread   ub_mt_thread[UB_MT_NR_MAX];
+static int                ub_mt_nr;
+static struct m0_atomic64 ub_mt_stop;
+
+static void ub_mt_func(int d)
+{
+	while (m0_atomic64_get(&ub_mt_stop) == 0)
+		M0_LOG(M0_DEBUG, "%i", d);
+}
+
+static void ub_mt_start(int nr)
+{
+	int i;
+	int result;
+
+	M0_PRE(nr < UB_MT_NR_MAX);
+	M0_SET_ARR0(ub_mt_thread);
+	m0_atomic64_set(&ub_mt_stop, 0);
+	for (i = 0; i < nr; ++i) {
+		result = M0_THREAD_INIT(&ub_mt_thread[i], int, NULL,
+					&ub_mt_func, i, "trace_ub_%i", i);
+		M0_ASSERT(result == 0);
+	}
+	ub_mt_nr = nr;
+}
+
+static void ub_mt_stop_all(void)
+{
+	int i;
+
+	m0_atomic64_set(&ub_mt_stop, 1);
+	for (i = 0; i < ub_mt_nr; ++i) {
+		m0_thread_join(&ub_mt_thread[i]);
+		m0_thread_fini(&ub_mt_thread[i]);
+	}
+	ub_mt_nr = 0;
+}
+
+#define UB_MT(nr)						\
+static void ub_mt_init_ ## nr(void)				\
+{								\
+	ub_mt_start(nr - 1);					\
+}
+
+UB_MT(2)
+UB_MT(4)
+UB_MT(8)
+UB_MT(16)
+
+#undef UB_MT
+
+#define UB_MT_BENCH(nr) {					\
+	.ub_name  = "mt-" #nr,					\
+	.ub_iter  = UB_ITER,					\
+	.ub_init  = ub_mt_init_ ## nr,				\
+	.ub_fini  = ub_mt_stop_all,				\
+	.ub_round = ub_8					\
+}
+
 struct m0_ub_set m0_trace_ub = {
 	.us_name = "trace-ub",
 	.us_run  = {
@@ -109,6 +255,11 @@ struct m0_ub_set m0_trace_ub = {
 		  .ub_iter = UB_ITER,
 		  .ub_round = ub_64 },
 
+		UB_MT_BENCH(2),
+		UB_MT_BENCH(4),
+		UB_MT_BENCH(8),
+		UB_MT_BENCH(16),
+
 		{ .ub_name = NULL }
 	}
 };
@@ -352,6 +352,20 @@ M0_INTERNAL int m0__bufvec_dont_dump(struct m0_bufvec *bufvec)
 }
 M0_EXPORTED(m0__bufvec_dont_dump);
 
+M0_INTERNAL int m0__bufvec_bind(struct m0_bufvec *bufvec, int node)
+{
+	uint32_t i;
+	int      rc = 0;
+
+	M0_ENTRY();
+	M0_PRE(bufvec->ov_vec.v_nr > 0);
+
+	for (i = 0; i < bufvec->ov_vec.v_nr && rc == 0; ++i)
+		rc = m0_memory_bind(bufvec->ov_buf[i],
+				    (size_t)bufvec->ov_vec.v_count[i], node);
+	return M0_RC(rc);
+}
+
 M0_INTERNAL int m0_bufvec_alloc_aligned(struct m0_bufvec *bufvec,
 					uint32_t num_segs,
 					m0_bcount_t seg_size, unsigned shift)
@@ -245,6 +245,10 @@ M0_INTERNAL int m0_bufvec_alloc_aligned_packed(struct m0_bufvec *bufvec,
  * Make all its memory excluded from core dump.
  */
 M0_INTERNAL int m0__bufvec_dont_dump(struct m0_bufvec *bufvec);
+/**
+ * Binds all its memory to the given NUMA node, see m0_memory_bind().
+ */
+M0_INTERNAL int m0__bufvec_bind(struct m0_bufvec *bufvec, int node);
 
 /**
    Frees the buffers pointed to by m0_bufvec.ov_buf and
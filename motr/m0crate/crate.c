@@ -45,6 +45,7 @@
 #include "lib/memory.h"
 #include "lib/types.h"
 #include "lib/trace.h"
+#include "lib/cksum.h"
 #include "module/instance.h"
 
 #include "motr/m0crate/logger.h"
@@ -140,6 +141,9 @@ static void fletcher_2_native(void *buf, uint64_t size);
 static void fletcher_4_native(void *buf, uint64_t size);
 static void csum_touch(void *buf, uint64_t size);
 static void csum_none(void *buf, uint64_t size);
+static void csum_pi_md5(void *buf, uint64_t size);
+static void csum_pi_crc32c(void *buf, uint64_t size);
+static void csum_pi_xxh64(void *buf, uint64_t size);
 
 static const struct csum_alg {
         const char *ca_label;
@@ -161,6 +165,19 @@ static const struct csum_alg {
                 .ca_label = "sha256",
                 .ca_func  = NULL
         },
+        /* Protection info types, see lib/cksum.h. */
+        {
+                .ca_label = "pi-md5",
+                .ca_func  = csum_pi_md5
+        },
+        {
+                .ca_label = "pi-crc32c",
+                .ca_func  = csum_pi_crc32c
+        },
+        {
+                .ca_label = "pi-xxh64",
+                .ca_func  = csum_pi_xxh64
+        },
         {
                 .ca_label = "none",
                 .ca_func  = csum_none
@@ -776,6 +793,42 @@ static void csum_touch(void *buf, uint64_t size)
 	(void)word; /* suppress "set but not used" warning. */
 }
 
+/*
+ * Computes protection info of the given type, as client does for a data unit.
+ */
+static void csum_pi(void *buf, uint64_t size, uint8_t type)
+{
+        union {
+                struct m0_generic_pi            g;
+                struct m0_md5_inc_context_pi    md5;
+                struct m0_crc32c_inc_context_pi crc;
+                struct m0_xxh64_inc_context_pi  xxh;
+        }                pi = {};
+        unsigned char    context[sizeof(struct m0_md5_inc_context_pi)];
+        m0_bcount_t      count = size;
+        struct m0_bufvec bvec  = M0_BUFVEC_INIT_BUF(&buf, &count);
+
+        pi.g.pi_hdr.pih_type = type;
+        if (m0_client_calculate_pi(&pi.g, NULL, &bvec, M0_PI_CALC_UNIT_ZERO,
+                                   context, NULL) != 0)
+                errx(1, "protection info calculation failed");
+}
+
+static void csum_pi_md5(void *buf, uint64_t size)
+{
+        csum_pi(buf, size, M0_PI_TYPE_MD5_INC_CONTEXT);
+}
+
+static void csum_pi_crc32c(void *buf, uint64_t size)
+{
+        csum_pi(buf, size, M0_PI_TYPE_CRC32C_INC_CONTEXT);
+}
+
+static void csum_pi_xxh64(void *buf, uint64_t size)
+{
+        csum_pi(buf, size, M0_PI_TYPE_XXH64_INC_CONTEXT);
+}
+
 /*
  * Hash functions copied from zfs.
  */
@@ -245,6 +245,9 @@ enum m0_magic_satchel {
 	/* m0_conf_cache::ca_registry::t_magic (fabled feodal) */
 	M0_CONF_CACHE_MAGIC = 0x33fab1edfe0da177,
 
+	/* conf/cache.c:m0_conf_cache_hash_tl::td_head_magic (cascaded base) */
+	M0_CONF_CACHE_HASH_MAGIC = 0x33ca5ceddeba5e77,
+
 	/* m0_conf_obj::co_gen_magic (selfless cell) */
 	M0_CONF_OBJ_MAGIC = 0x335e1f1e55ce1177,
 
@@ -889,6 +892,9 @@ enum m0_magic_satchel {
 	/* rpc_buffer::rb_magic (iodized isaac) */
 	M0_RPC_BUF_MAGIC = 0x3310d12ed15aac77,
 
+	/* rpcbuf_tl::td_head_magic (assessed boa) */
+	M0_RPC_BUF_HEAD_MAGIC = 0x33a55e55edb0a177,
+
 	/* m0_rpc_machine::rm_magix (deboise aloof) */
 	M0_RPC_MACHINE_MAGIC = 0x33deb015ea100f77,
 
@@ -958,6 +964,12 @@ enum m0_magic_satchel {
 	/* stob/cache.c:stob_cache_tl::td_head_magic (cache billed) */
 	M0_STOB_CACHE_HEAD_MAGIC    = 0x33cac4eb111ed77,
 
+	/* m0_stob::so_cache_hmagic (cache hashed) */
+	M0_STOB_CACHE_HASH_MAGIC    = 0x33cac4e4a54ed77,
+
+	/* stob/cache.c:stob_cache_hash_tl::td_head_magic (cache bucket) */
+	M0_STOB_CACHE_HASH_HEAD_MAGIC = 0x33cac4eb0c4e757,
+
 	/* m0_stob_type::st_magic (disc class) */
 	M0_STOB_TYPES_MAGIC         = 0x33d15cc1a5577,
 
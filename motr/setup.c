@@ -1530,6 +1530,8 @@ static int cs_be_init(struct m0_reqh_context *rctx,
 		be->but_dom_cfg.bc_engine.bec_group_freeze_timeout_max =
 			rctx->rc_be_tx_group_freeze_timeout_max;
 	}
+	be->but_dom_cfg.bc_seg_paging.bspc_budget =
+		rctx->rc_be_seg_paging_budget;
 	rc = cs_be_dom_cfg_zone_pcnt_fill(&rctx->rc_reqh, &be->but_dom_cfg);
 	if (rc != 0)
 		goto err;
@@ -2249,6 +2251,11 @@ static int _args_parse(struct m0_motr *cctx, int argc, char **argv)
 				       rctx->rc_be_tx_group_freeze_timeout_max =
 						t * M0_TIME_ONE_MSEC;
 				})),
+			M0_NUMBERARG('W', "BE segment paging memory budget",
+				LAMBDA(void, (int64_t size)
+				{
+					rctx->rc_be_seg_paging_budget = size;
+				})),
 			M0_VOIDARG('a', "Preallocate BE segment",
 				LAMBDA(void, (void)
 				{
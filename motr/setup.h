@@ -288,6 +288,11 @@ struct m0_reqh_context {
 	m0_bcount_t                  rc_be_tx_payload_size_max;
 	m0_time_t                    rc_be_tx_group_freeze_timeout_min;
 	m0_time_t                    rc_be_tx_group_freeze_timeout_max;
+	/**
+	 * Budget for modified pages of BE segments kept in memory.
+	 * 0 disables demand paging. @see m0_be_seg_paging_cfg
+	 */
+	m0_bcount_t                  rc_be_seg_paging_budget;
 
 	/**
 	 * Default path to the configuration database.
@@ -118,6 +118,8 @@ M0_INTERNAL struct m0_pdclust_instance *
 ut_dummy_pdclust_instance_create(struct m0_pdclust_layout  *pdl)
 {
 	int                         i;
+	int                         j;
+	struct tile_cache          *tc;
 	struct m0_pdclust_instance *pdi;
 
 	M0_ALLOC_PTR(pdi);
@@ -135,21 +137,26 @@ ut_dummy_pdclust_instance_create(struct m0_pdclust_layout  *pdl)
 	pdi->pi_base.li_ops = (struct m0_layout_instance_ops *)DUMMY_PTR;
 
 	/* tc */
-	M0_ALLOC_ARR(pdi->pi_tile_cache.tc_lcode, pdl->pl_attr.pa_P);
-	M0_ALLOC_ARR(pdi->pi_tile_cache.tc_permute, pdl->pl_attr.pa_P);
-	M0_ALLOC_ARR(pdi->pi_tile_cache.tc_inverse, pdl->pl_attr.pa_P);
-
-	for (i = 0; i < pdl->pl_attr.pa_P; i++) {
-		/*
-		 * These aren't valid values - but they keep the invariant
-		 * check happy
-		 */
-		pdi->pi_tile_cache.tc_lcode[i] = 0;
-
- 		/* tc->tc_permute[tc->tc_inverse[N]] = N */
-		pdi->pi_tile_cache.tc_permute[i] = i;
-		pdi->pi_tile_cache.tc_inverse[i] = i;
+	M0_ALLOC_ARR(pdi->pi_tile_tree, pdl->pl_attr.pa_P + 1);
+	for (j = 0; j < ARRAY_SIZE(pdi->pi_tile_cache); j++) {
+		tc = &pdi->pi_tile_cache[j];
+		M0_ALLOC_ARR(tc->tc_lcode, pdl->pl_attr.pa_P);
+		M0_ALLOC_ARR(tc->tc_permute, pdl->pl_attr.pa_P);
+		M0_ALLOC_ARR(tc->tc_inverse, pdl->pl_attr.pa_P);
+
+		for (i = 0; i < pdl->pl_attr.pa_P; i++) {
+			/*
+			 * These aren't valid values - but they keep the
+			 * invariant check happy
+			 */
+			tc->tc_lcode[i] = 0;
+
+			/* tc->tc_permute[tc->tc_inverse[N]] = N */
+			tc->tc_permute[i] = i;
+			tc->tc_inverse[i] = i;
+		}
 	}
+	pdi->pi_tile_last = &pdi->pi_tile_cache[0];
 
 	return pdi;
 }
@@ -157,9 +164,14 @@ ut_dummy_pdclust_instance_create(struct m0_pdclust_layout  *pdl)
 M0_INTERNAL void
 ut_dummy_pdclust_instance_delete(struct m0_pdclust_instance *pdi)
 {
-	m0_free(pdi->pi_tile_cache.tc_lcode);
-	m0_free(pdi->pi_tile_cache.tc_permute);
-	m0_free(pdi->pi_tile_cache.tc_inverse);
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(pdi->pi_tile_cache); i++) {
+		m0_free(pdi->pi_tile_cache[i].tc_lcode);
+		m0_free(pdi->pi_tile_cache[i].tc_permute);
+		m0_free(pdi->pi_tile_cache[i].tc_inverse);
+	}
+	m0_free(pdi->pi_tile_tree);
 
 	/* Fini the layout_instance part */
 	m0_layout_instance_bob_fini(&pdi->pi_base);
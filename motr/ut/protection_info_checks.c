@@ -313,6 +313,101 @@ static void ut_test_pi_api_case_third(void)
 
 }
 
+union pi_inc {
+	struct m0_generic_pi            g;
+	struct m0_crc32c_inc_context_pi crc;
+	struct m0_xxh64_inc_context_pi  xxh;
+};
+
+static unsigned char *pi_inc_context(union pi_inc *pi)
+{
+	return pi->g.pi_hdr.pih_type == M0_PI_TYPE_CRC32C_INC_CONTEXT ?
+		pi->crc.picrc_prev_context : pi->xxh.pixxh_prev_context;
+}
+
+static unsigned char *pi_inc_value(union pi_inc *pi)
+{
+	return pi->g.pi_hdr.pih_type == M0_PI_TYPE_CRC32C_INC_CONTEXT ?
+		pi->crc.picrc_value : pi->xxh.pixxh_value;
+}
+
+/*
+ * Calculates PI of the given type unit by unit, with the seed passed for the
+ * last unit, and for all units as one chunk.
+ * Verification: seeded and unseeded checksums from both steps match, the last
+ * unit verifies with m0_calc_verify_cksum_one_unit() and does not verify
+ * once the checksum is corrupted.
+ */
+static void pi_inc_check(uint8_t type, int ctx_size, int val_size)
+{
+	union pi_inc      pi;
+	union pi_inc      big;
+	unsigned char     ctx[M0_XXH64_CONTEXT_LEN];
+	unsigned char     unseeded[M0_XXH64_LEN];
+	unsigned char     big_unseeded[M0_XXH64_LEN];
+	struct m0_pi_seed seed;
+	int               j;
+	int               rc;
+
+	m0_fid_set(&seed.pis_obj_id, OBJ_CONTAINER, OBJ_KEY);
+	seed.pis_data_unit_offset = (DATA_UNIT_COUNT-1)*SEGS_NR*BUFFER_SIZE;
+
+	memset(&pi, 0, sizeof pi);
+	pi.g.pi_hdr.pih_type = type;
+	for (j = 0; j < DATA_UNIT_COUNT; j++) {
+		rc = m0_client_calculate_pi(&pi.g,
+				j == DATA_UNIT_COUNT - 1 ? &seed : NULL,
+				&user_data[j],
+				j == 0 ? M0_PI_CALC_UNIT_ZERO : M0_PI_NO_FLAG,
+				ctx, j == DATA_UNIT_COUNT - 1 ? unseeded : NULL);
+		M0_UT_ASSERT(rc == 0);
+		if (j < DATA_UNIT_COUNT - 1)
+			memcpy(pi_inc_context(&pi), ctx, ctx_size);
+	}
+	M0_UT_ASSERT(m0_calculate_cksum_size(&pi.g) == pi.g.pi_hdr.pih_size);
+	M0_UT_ASSERT(m0_calculate_cksum_size(&pi.g) <= max_cksum_size());
+
+	memset(&big, 0, sizeof big);
+	big.g.pi_hdr.pih_type = type;
+	rc = m0_client_calculate_pi(&big.g, &seed, big_user_data,
+				    M0_PI_CALC_UNIT_ZERO, ctx, big_unseeded);
+	M0_UT_ASSERT(rc == 0);
+	M0_UT_ASSERT(memcmp(pi_inc_value(&pi), pi_inc_value(&big),
+			    val_size) == 0);
+	M0_UT_ASSERT(memcmp(unseeded, big_unseeded, val_size) == 0);
+	M0_UT_ASSERT(memcmp(unseeded, pi_inc_value(&pi), val_size) != 0);
+
+	M0_UT_ASSERT(m0_calc_verify_cksum_one_unit(&pi.g, &seed,
+					&user_data[DATA_UNIT_COUNT - 1]));
+	pi_inc_value(&pi)[0] ^= 1;
+	M0_UT_ASSERT(!m0_calc_verify_cksum_one_unit(&pi.g, &seed,
+					&user_data[DATA_UNIT_COUNT - 1]));
+}
+
+static void ut_test_pi_crc32c(void)
+{
+	bool hw = m0_crc32c_hw();
+
+	M0_UT_ASSERT(m0_crc32c(0, "123456789", 9) == 0xe3069283);
+	pi_inc_check(M0_PI_TYPE_CRC32C_INC_CONTEXT, M0_CRC32C_LEN,
+		     M0_CRC32C_LEN);
+	/* Software implementation. */
+	m0_crc32c_hw_set(false);
+	M0_UT_ASSERT(m0_crc32c(0, "123456789", 9) == 0xe3069283);
+	M0_UT_ASSERT(m0_crc32c(m0_crc32c(0, "1234", 4), "56789", 5) ==
+		     0xe3069283);
+	pi_inc_check(M0_PI_TYPE_CRC32C_INC_CONTEXT, M0_CRC32C_LEN,
+		     M0_CRC32C_LEN);
+	m0_crc32c_hw_set(hw);
+}
+
+static void ut_test_pi_xxh64(void)
+{
+	M0_UT_ASSERT(m0_xxh64("", 0, 0) == 0xef46db3751d8e999ULL);
+	M0_UT_ASSERT(m0_xxh64("abc", 3, 0) == 0x44bc2cf5ad770999ULL);
+	pi_inc_check(M0_PI_TYPE_XXH64_INC_CONTEXT, M0_XXH64_CONTEXT_LEN,
+		     M0_XXH64_LEN);
+}
 
 struct m0_ut_suite ut_suite_pi = {
 	.ts_name = "pi_ut",
@@ -323,6 +418,8 @@ struct m0_ut_suite ut_suite_pi = {
 		/* Initialising client. */
 		{ "m0_pi_checks_case_one_two", &ut_test_pi_api_case_one_two},
 		{ "m0_pi_checks_case_third", &ut_test_pi_api_case_third},
+		{ "m0_pi_checks_crc32c", &ut_test_pi_crc32c},
+		{ "m0_pi_checks_xxh64", &ut_test_pi_xxh64},
 		{ NULL, NULL },
 	}
 };
@@ -35,6 +35,12 @@
 
 enum {
 	M0_AVI_NET_BUF = M0_AVI_NET_RANGE_START + 1,
+	/** sock transport poller thread context: (tm, poller index). */
+	M0_AVI_NET_SOCK_POLLER,
+	/** Counter of events returned by epoll_wait() to a sock poller. */
+	M0_AVI_NET_SOCK_EVENTS,
+	/** Counter of bytes moved by a sock poller per readv()/writev(). */
+	M0_AVI_NET_SOCK_IO,
 };
 
 /** @} end of stob group */
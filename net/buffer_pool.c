@@ -100,6 +100,7 @@ M0_INTERNAL int m0_net_buffer_pool_init(struct m0_net_buffer_pool *pool,
 	pool->nbp_colours_nr = colours;
 	pool->nbp_align      = shift;
 	pool->nbp_dont_dump  = dont_dump;
+	pool->nbp_colour_node = NULL;
 
 	if (colours == 0)
 		pool->nbp_colours = NULL;
@@ -122,6 +123,26 @@ M0_INTERNAL int m0_net_buffer_pool_init(struct m0_net_buffer_pool *pool,
 static bool net_buffer_pool_grow(struct m0_net_buffer_pool *pool);
 
 
+M0_INTERNAL int m0_net_buffer_pool_colour_node_set(struct m0_net_buffer_pool
+						   *pool, uint32_t colour,
+						   int node)
+{
+	int i;
+
+	M0_PRE(m0_net_buffer_pool_is_locked(pool));
+	M0_PRE(colour < pool->nbp_colours_nr);
+
+	if (pool->nbp_colour_node == NULL) {
+		M0_ALLOC_ARR(pool->nbp_colour_node, pool->nbp_colours_nr);
+		if (pool->nbp_colour_node == NULL)
+			return M0_ERR(-ENOMEM);
+		for (i = 0; i < pool->nbp_colours_nr; ++i)
+			pool->nbp_colour_node[i] = -1;
+	}
+	pool->nbp_colour_node[colour] = node;
+	return 0;
+}
+
 M0_INTERNAL int m0_net_buffer_pool_provision(struct m0_net_buffer_pool *pool,
 					     uint32_t buf_nr)
 {
@@ -180,6 +201,7 @@ M0_INTERNAL void m0_net_buffer_pool_fini(struct m0_net_buffer_pool *pool)
 		m0_net_tm_tlist_fini(&pool->nbp_colours[i]);
 	if (pool->nbp_colours != NULL)
 		m0_free(pool->nbp_colours);
+	m0_free(pool->nbp_colour_node);
 	m0_mutex_fini(&pool->nbp_mutex);
 }
 
@@ -271,6 +293,7 @@ static bool net_buffer_pool_grow(struct m0_net_buffer_pool *pool)
 {
 	int		      rc;
 	struct m0_net_buffer *nb;
+	uint32_t              colour = M0_BUFFER_ANY_COLOUR;
 
 	M0_PRE(m0_net_buffer_pool_invariant(pool));
 
@@ -281,6 +304,18 @@ static bool net_buffer_pool_grow(struct m0_net_buffer_pool *pool)
 					    pool->nbp_seg_size, pool->nbp_align);
 	if (rc != 0)
 		goto clean;
+	if (pool->nbp_colour_node != NULL) {
+		colour = pool->nbp_buf_nr % pool->nbp_colours_nr;
+		/*
+		 * Bind before registration: registered memory can be pinned
+		 * and not movable. Failure to bind is not fatal.
+		 */
+		if (pool->nbp_align != 0 && pool->nbp_colour_node[colour] >= 0 &&
+		    m0__bufvec_bind(&nb->nb_buffer,
+				    pool->nbp_colour_node[colour]) != 0)
+			M0_LOG(M0_WARN, "failed to bind bufvec %p to node %i",
+			       &nb->nb_buffer, pool->nbp_colour_node[colour]);
+	}
 	if(pool->nbp_align != 0 && pool->nbp_dont_dump) {
 		rc = m0__bufvec_dont_dump(&nb->nb_buffer);
 		if (rc != 0) {
@@ -297,7 +332,7 @@ static bool net_buffer_pool_grow(struct m0_net_buffer_pool *pool)
 	m0_net_tm_tlink_init(nb);
 
 	M0_CNT_INC(pool->nbp_buf_nr);
-	m0_net_buffer_pool_put(pool, nb, M0_BUFFER_ANY_COLOUR);
+	m0_net_buffer_pool_put(pool, nb, colour);
 	M0_POST(m0_net_buffer_pool_invariant(pool));
 	return true;
 clean:
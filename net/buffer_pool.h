@@ -176,6 +176,22 @@ M0_INTERNAL int m0_net_buffer_pool_init(struct m0_net_buffer_pool *pool,
 					m0_bcount_t seg_size, uint32_t colours,
 					unsigned shift, bool dont_dump);
 
+/**
+   Associates a colour with a NUMA node.
+
+   Buffers added to the pool by m0_net_buffer_pool_provision() after this call
+   are distributed evenly across colours. Memory of a buffer is bound to the
+   NUMA node of its colour (when the pool is page-aligned), and the buffer is
+   placed in the list of this colour. This should be called before the pool is
+   provisioned, as memory of registered buffers cannot be moved.
+
+   @pre m0_net_buffer_pool_is_locked(pool)
+   @pre colour < pool->nbp_colours_nr
+ */
+M0_INTERNAL int m0_net_buffer_pool_colour_node_set(struct m0_net_buffer_pool
+						   *pool, uint32_t colour,
+						   int node);
+
 /**
    It adds the buf_nr buffers in the buffer pool.
    Suppose to add 10 items to the pool, m0_net_buffer_pool_provision(pool, 10)
@@ -275,6 +291,11 @@ struct m0_net_buffer_pool {
 	unsigned			     nbp_align;
 	/** Memory in this pool is excluded in core dump or not */
 	bool                                 nbp_dont_dump;
+	/**
+	   NUMA node of each colour (-1 if none), or NULL.
+	   See m0_net_buffer_pool_colour_node_set().
+	 */
+	int				    *nbp_colour_node;
 	/**
 	   A list of all buffers in the pool.
 	   This list is maintained in LRU order. The head of this list (which is
@@ -83,7 +83,9 @@
  * (m0_net_buf_add()->...->libfab_buf_add()).
  *
  * If the buffer is added to M0_NET_QT_MSG_RECV queue it is just placed on the
- * libfabric internal receive queue, waiting for the incoming data.
+ * libfabric internal receive queue, waiting for the incoming data. If the
+ * provider supports FI_MULTI_RECV, the buffer receives multiple messages, see
+ * libfab_recv_post().
  *
  * If the buffer is added to M0_NET_QT_MSG_SEND, M0_NET_QT_ACTIVE_BULK_RECV,
  * M0_NET_QT_ACTIVE_BULK_SEND then if the connection is established between two
@@ -302,7 +304,9 @@ static void libfab_ep_release(struct m0_ref *ref);
 static uint64_t libfab_mr_keygen(struct m0_fab__tm *tm);
 static int libfab_check_for_event(struct fid_eq *eq, uint32_t *ev);
 static int libfab_check_for_comp(struct fid_cq *cq, uint32_t *ctx,
-				 m0_bindex_t *len, uint64_t *rem_cq_data);
+				 m0_bindex_t *len, uint64_t *rem_cq_data,
+				 uint64_t *flags, void **rbuf);
+static int libfab_recv_post(struct m0_fab__tm *ma, struct m0_fab__buf *fbp);
 static void libfab_tm_fini(struct m0_net_transfer_mc *tm);
 static int libfab_buf_dom_reg(struct m0_net_buffer *nb, struct m0_fab__tm *tm);
 static int libfab_buf_dom_dereg(struct m0_fab__buf *fbp);
@@ -672,16 +676,29 @@ static void libfab_rxep_comp_read(struct fid_cq *cq, struct m0_fab__ep *ep,
 	uint32_t             token[FAB_MAX_COMP_READ];
 	m0_bindex_t          len[FAB_MAX_COMP_READ];
 	uint64_t             data[FAB_MAX_COMP_READ];
+	uint64_t             flags[FAB_MAX_COMP_READ];
+	void                *rbuf[FAB_MAX_COMP_READ];
 	int                  i;
 	int                  cnt;
 	uint32_t             rem_token;
 
 	if (cq != NULL) {
-		cnt = libfab_check_for_comp(cq, token, len, data);
+		cnt = libfab_check_for_comp(cq, token, len, data, flags, rbuf);
 		for (i = 0; i < cnt; i++) {
 			fb = fab_bufhash_htable_lookup(
 				&tm->ftm_bufhash.bht_hash,
 				&token[i]);
+			if (fb != NULL && fb->fb_multi) {
+				/*
+				 * Each completion of a multi-receive buffer
+				 * reports one message placed in the buffer.
+				 */
+				fb->fb_length = len[i];
+				fb->fb_offset = len[i] == 0 ? 0 :
+					(char *)rbuf[i] -
+					(char *)fb->fb_nb->nb_buffer.ov_buf[0];
+				fb->fb_released = flags[i] & FI_MULTI_RECV;
+			}
 			if (fb != NULL) {
 				if (fb->fb_length == 0)
 					fb->fb_length = len[i];
@@ -711,7 +728,7 @@ static void libfab_txep_comp_read(struct fid_cq *cq, struct m0_fab__tm *tm)
 	int                       i;
 	int                       cnt;
 
-	cnt = libfab_check_for_comp(cq, token, NULL, NULL);
+	cnt = libfab_check_for_comp(cq, token, NULL, NULL, NULL, NULL);
 	for (i = 0; i < cnt; i++) {
 		if (token[i] != 0)
 			fb = fab_bufhash_htable_lookup(
@@ -1313,7 +1330,6 @@ static int libfab_passive_ep_create(struct m0_fab__ep *ep,
 	}
 
 	hints->ep_attr->type = FI_EP_MSG;
-	hints->caps = FI_MSG | FI_RMA;
 	hints->mode |= FI_RX_CQ_DATA;
 	hints->domain_attr->mr_mode = FI_MR_LOCAL | FI_MR_ALLOCATED |
 				      FI_MR_PROV_KEY | FI_MR_VIRT_ADDR;
@@ -1321,8 +1337,15 @@ static int libfab_passive_ep_create(struct m0_fab__ep *ep,
 
 	for (idx = 0; idx < FAB_FABRIC_PROV_MAX; idx++) {
 		hints->fabric_attr->prov_name = (char *)providers[idx];
+		/* Prefer multi-receive, see libfab_recv_post(). */
+		hints->caps = FI_MSG | FI_RMA | FI_MULTI_RECV;
 		rc = fi_getinfo(LIBFAB_VERSION, addr, port, FI_SOURCE, hints,
 				&fi);
+		if (rc != 0) {
+			hints->caps = FI_MSG | FI_RMA;
+			rc = fi_getinfo(LIBFAB_VERSION, addr, port, FI_SOURCE,
+					hints, &fi);
+		}
 		if (rc == 0)
 			break;
 	}
@@ -1374,6 +1397,14 @@ static int libfab_passive_ep_create(struct m0_fab__ep *ep,
 		libfab_pep_param_free(pep, tm);
 		return M0_ERR(rc);
 	}
+	if (tm->ftm_fab->fab_fi->caps & FI_MULTI_RECV) {
+		size_t min = FAB_MULTI_RECV_MIN;
+
+		tm->ftm_multi_recv = fi_setopt(&tm->ftm_rctx->fid,
+					       FI_OPT_ENDPOINT,
+					       FI_OPT_MIN_MULTI_RECV,
+					       &min, sizeof min) == 0;
+	}
 
 	rc = libfab_tm_res_init(tm);
 	if (rc != 0) {
@@ -1688,6 +1719,9 @@ static void libfab_buf_fini(struct m0_fab__buf *buf)
 	}
 	buf->fb_status = 0;
 	buf->fb_length = 0;
+	buf->fb_offset = 0;
+	buf->fb_multi = false;
+	buf->fb_released = false;
 	buf->fb_token = 0;
 	/*
 	 * If the buffer operation has timedout or has been cancelled by
@@ -1750,6 +1784,9 @@ static void libfab_buf_complete(struct m0_fab__buf *buf)
 		.nbe_status = buf->fb_status,
 		.nbe_time   = m0_time_now()
 	};
+	/* A multi-receive buffer stays posted until released. */
+	bool                  retain = buf->fb_multi && !buf->fb_released &&
+				       buf->fb_status == 0;
 
 	M0_ENTRY("fb=%p nb=%p q=%d rc=%d", buf, nb, buf->fb_nb->nb_qtype,
 		 buf->fb_status);
@@ -1764,11 +1801,16 @@ static void libfab_buf_complete(struct m0_fab__buf *buf)
 			ev.nbe_ep = &buf->fb_ev_ep->fep_nep;
 			libfab_ep_get(buf->fb_ev_ep);
 		}
+		ev.nbe_offset = buf->fb_offset;
 	}
 	ma->ftm_ntm->ntm_callback_counter++;
 
-	fab_bufhash_htable_del(&ma->ftm_bufhash.bht_hash, buf);
-	libfab_buf_fini(buf);
+	if (retain)
+		nb->nb_flags |= M0_NET_BUF_RETAIN;
+	else {
+		fab_bufhash_htable_del(&ma->ftm_bufhash.bht_hash, buf);
+		libfab_buf_fini(buf);
+	}
 	M0_ASSERT(libfab_tm_invariant(ma));
 	libfab_tm_evpost_lock(ma);
 	libfab_tm_unlock(ma);
@@ -1785,6 +1827,10 @@ static void libfab_buf_complete(struct m0_fab__buf *buf)
  * This function will check if the received message is a dummy message for
  * notification of RDMA operation completion.
  * If yes it will return 0 or else return -1.
+ *
+ * For a multi-receive buffer, 0 is also returned for the empty completion
+ * that only reports the buffer release. A released buffer, which last message
+ * does not need a call-back, is re-posted.
  */
 static int libfab_dummy_msg_rcv_chk(struct m0_fab__buf *fbp)
 {
@@ -1796,8 +1842,11 @@ static int libfab_dummy_msg_rcv_chk(struct m0_fab__buf *fbp)
 	uint32_t              token;
 	int                   ret = -1;
 
-	if (fbp->fb_length == (sizeof(uint32_t) * 2)) {
-		ptr = (uint32_t *)nb->nb_buffer.ov_buf[0];
+	if (fbp->fb_multi && fbp->fb_length == 0) {
+		ret = 0;
+	} else if (fbp->fb_length == (sizeof(uint32_t) * 2)) {
+		ptr = (uint32_t *)((char *)nb->nb_buffer.ov_buf[0] +
+				   fbp->fb_offset);
 		if (*ptr == FAB_DUMMY_DATA) {
 			ptr++;
 			token = *ptr;
@@ -1810,21 +1859,63 @@ static int libfab_dummy_msg_rcv_chk(struct m0_fab__buf *fbp)
 			/*
 			 * Repost this buffer to the receive
 			 * queue without generating a callback
-			 * as it contains only dummy data
+			 * as it contains only dummy data.
+			 * A multi-receive buffer is still posted
+			 * until released.
 			 */
-			fbp->fb_length = nb->nb_length;
-			iv.iov_base = nb->nb_buffer.ov_buf[0];
-			iv.iov_len =  nb->nb_buffer.ov_vec.v_count[0];
-			M0_ASSERT(fi_recvv(ma->ftm_rctx, &iv,
-				  fbp->fb_mr.bm_desc, 1, 0,
-				  U32_TO_VPTR(fbp->fb_token)) == 0);
+			if (!fbp->fb_multi) {
+				fbp->fb_length = nb->nb_length;
+				iv.iov_base = nb->nb_buffer.ov_buf[0];
+				iv.iov_len =  nb->nb_buffer.ov_vec.v_count[0];
+				M0_ASSERT(fi_recvv(ma->ftm_rctx, &iv,
+					  fbp->fb_mr.bm_desc, 1, 0,
+					  U32_TO_VPTR(fbp->fb_token)) == 0);
+			}
 			ret = 0;
 		}
 	}
+	if (ret == 0 && fbp->fb_multi && fbp->fb_released)
+		M0_ASSERT(libfab_recv_post(ma, fbp) == 0);
 
 	return ret;
 }
 
+/**
+ * Posts a M0_NET_QT_MSG_RECV buffer to the shared receive context.
+ *
+ * If the provider supports it and the user allows multiple messages in the
+ * buffer (m0_net_buffer::nb_max_receive_msgs), the buffer is posted with
+ * FI_MULTI_RECV: the provider places incoming messages one after another and
+ * releases the buffer when less than FAB_MULTI_RECV_MIN bytes remain. Each
+ * message is delivered by a separate completion event with M0_NET_BUF_RETAIN
+ * flag (libfab_buf_complete()). Note, that nb_max_receive_msgs is used only to
+ * enable multi-receive: the number of messages is limited by the free space.
+ */
+static int libfab_recv_post(struct m0_fab__tm *ma, struct m0_fab__buf *fbp)
+{
+	struct m0_net_buffer *nb = fbp->fb_nb;
+	struct iovec          iv = {
+		.iov_base = nb->nb_buffer.ov_buf[0],
+		.iov_len  = nb->nb_buffer.ov_vec.v_count[0]
+	};
+	struct fi_msg         msg = {
+		.msg_iov   = &iv,
+		.desc      = fbp->fb_mr.bm_desc,
+		.iov_count = 1,
+		.context   = U32_TO_VPTR(fbp->fb_token)
+	};
+
+	M0_PRE(nb->nb_buffer.ov_vec.v_nr == 1);
+	fbp->fb_offset   = 0;
+	fbp->fb_released = false;
+	fbp->fb_multi    = ma->ftm_multi_recv && nb->nb_max_receive_msgs > 1 &&
+			   iv.iov_len > FAB_MULTI_RECV_MIN;
+	return fbp->fb_multi ?
+		fi_recvmsg(ma->ftm_rctx, &msg, FI_MULTI_RECV | FI_COMPLETION) :
+		fi_recvv(ma->ftm_rctx, &iv, fbp->fb_mr.bm_desc, 1, 0,
+			 U32_TO_VPTR(fbp->fb_token));
+}
+
 /**
  * Completes the buffer operation.
  */
@@ -1925,9 +2016,13 @@ static int libfab_check_for_event(struct fid_eq *eq, uint32_t *ev)
  * A helper function to read the entries from a completion queue
  * If success, returns the number of entries read
  * else returns the negative error code
+ *
+ * "flags" and "rbuf" (completion flags and the address of received data) are
+ * only needed for multi-receive buffers and can be NULL.
  */
 static int libfab_check_for_comp(struct fid_cq *cq, uint32_t *ctx,
-				 m0_bindex_t *len, uint64_t *data)
+				 m0_bindex_t *len, uint64_t *data,
+				 uint64_t *flags, void **rbuf)
 {
 	struct fi_cq_data_entry entry[FAB_MAX_COMP_READ];
 	struct fi_cq_err_entry  err_entry;
@@ -1945,6 +2040,10 @@ static int libfab_check_for_comp(struct fid_cq *cq, uint32_t *ctx,
 			if (data != NULL)
 				data[i] = ((entry[i].flags & wr_cqdata)) ?
 					  entry[i].data : 0;
+			if (flags != NULL)
+				flags[i] = entry[i].flags;
+			if (rbuf != NULL)
+				rbuf[i] = entry[i].buf;
 		}
 	} else if (ret != -FI_EAGAIN) {
 		memset(&err_entry, 0, sizeof(err_entry));
@@ -3144,10 +3243,7 @@ static int libfab_buf_add(struct m0_net_buffer *nb)
 	case M0_NET_QT_MSG_RECV: {
 		M0_ASSERT(nb->nb_buffer.ov_vec.v_nr == 1);
 		fbp->fb_length = nb->nb_length;
-		iv.iov_base = nb->nb_buffer.ov_buf[0];
-		iv.iov_len = nb->nb_buffer.ov_vec.v_count[0];
-		ret = fi_recvv(ma->ftm_rctx, &iv, fbp->fb_mr.bm_desc, 1, 0,
-			       U32_TO_VPTR(fbp->fb_token));
+		ret = libfab_recv_post(ma, fbp);
 		break;
 	}
 
@@ -3403,7 +3499,12 @@ static uint32_t libfab_rpc_max_recv_msgs(struct m0_net_domain *ndom,
 					 m0_bcount_t rpc_size)
 {
 	M0_PRE(ndom != NULL);
-	return FAB_MAX_RPC_RECV_MSG_NR;
+	/*
+	 * Multiple messages can be received in a buffer only if no message is
+	 * larger than the free space the provider keeps in the buffer.
+	 */
+	return libfab_rpc_max_msg_size(ndom, rpc_size) <= FAB_MULTI_RECV_MIN ?
+		FAB_MAX_RPC_RECV_MSG_NR : 1;
 }
 
 static const struct m0_net_xprt_ops libfab_xprt_ops = {
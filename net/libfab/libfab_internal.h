@@ -83,8 +83,16 @@ enum m0_fab__libfab_params {
 	FAB_MAX_RPC_SEG_SIZE           = (1 << 20),
 	/** Max number of segments for rpc buffer */
 	FAB_MAX_RPC_SEG_NR             = 1,
+	/**
+	 * Minimal free space left in a multi-receive rpc buffer
+	 * (FI_OPT_MIN_MULTI_RECV). Must not be less than the maximal rpc
+	 * message size received in such buffers (libfab_rpc_max_recv_msgs()).
+	 */
+	FAB_MULTI_RECV_MIN             = (1 << 17),
 	/** Max number of recevive messages in rpc buffer */
-	FAB_MAX_RPC_RECV_MSG_NR        = 1,
+	FAB_MAX_RPC_RECV_MSG_NR        = FAB_MAX_RPC_SEG_SIZE *
+					 FAB_MAX_RPC_SEG_NR /
+					 FAB_MULTI_RECV_MIN,
 	/** Dummy data used to notify remote end for read-rma op completions */
 	FAB_DUMMY_DATA                 = 0xFABC0DE,
 	/** Max number of completion events to read from a completion queue */
@@ -481,6 +489,12 @@ struct m0_fab__tm {
 
 	/** Buffer operation id for the transfer machine */
 	uint32_t                        ftm_op_id;
+
+	/**
+	 * True iff the provider supports FI_MULTI_RECV on the shared receive
+	 * context, so that a receive buffer can hold multiple messages.
+	 */
+	bool                            ftm_multi_recv;
 };
 
 /**
@@ -580,6 +594,18 @@ struct m0_fab__buf {
 	
 	/** Total size of data to be received/sent/read/written */
 	m0_bindex_t                      fb_length;
+
+	/** Offset of the last received message in a multi-receive buffer */
+	m0_bindex_t                      fb_offset;
+
+	/** The receive buffer is posted with FI_MULTI_RECV */
+	bool                             fb_multi;
+
+	/**
+	 * The provider released the multi-receive buffer: no more messages
+	 * will be placed in it.
+	 */
+	bool                             fb_released;
 	
 	/** Count of work request generated for bulk rma operation */
 	volatile uint32_t                fb_wr_cnt;
@@ -161,12 +161,13 @@
  *
  * An end-point keeps a list of all writers writing data to its sockets
  * (ep::e_writer). Note that a writer is associated with an end-point rather
- * than a particular socket to this end-point. This allows, in principle, use of
- * multiple sockets to write the same buffer in parallel. While writing a
- * particular packet, the writer and the socket are "locked" together and the
- * socket cannot be used to write other packets (because doing so would make it
- * impossible to parse packets at the other end). While locked, the writer
- * mover::m_sock points to the socket (see sock_writer()).
+ * than a particular socket to this end-point. This allows use of multiple
+ * sockets to write the same buffer in parallel (see "Parallel sockets"
+ * below). While writing a particular packet, the writer and the socket are
+ * "locked" together and the socket cannot be used to write other packets
+ * (because doing so would make it impossible to parse packets at the other
+ * end). While locked, the writer mover::m_sock points to the socket (see
+ * sock_writer()). A socket is locked to at most one writer at a time.
  *
  * An address uniquely identifies an end-point in the network. An end-point
  * embeds its address (ep::e_a). An address has address family independent part
@@ -223,9 +224,13 @@
  * stays in S_LISTENING mode.
  *
  * The starting point of asynchronous activity associated with a sock transfer
- * machine is poller(). Currently, this function is ran as a separate thread,
- * but it can easily be adapted to be executed as a chore
- * (m0_locality_chore_init()) within a locality.
+ * machine is poller(). A transfer machine has one or more pollers (struct
+ * poller, ma::t_poller[]), each with its own epoll instance and a shard of the
+ * sockets (sock::s_poller), assigned round-robin as sockets are created. The
+ * number of pollers is set by m0_net_sock_pollers_set() or
+ * M0_NET_SOCK_POLLERS environment variable, 1 by default. Currently, each
+ * poller runs as a separate thread, but it can easily be adapted to be
+ * executed as a chore (m0_locality_chore_init()) within a locality.
  *
  * poller() gets from epoll_wait(2) a list of readable and writable sockets and
  * calls sock_event(), which is socket state machine transition
@@ -329,7 +334,9 @@
  * protected by a per-tm mutex: m0_net_transfer_mc::ntm_mutex. For synchronous
  * activity, this mutex is taken by the entry-point code in net/ and is not
  * released until the entry-point completes. For asynchronous activity, poller()
- * keeps the lock taken most of the time.
+ * keeps the lock taken most of the time, except for epoll_wait(), completion
+ * call-backs and the readv(2)/writev(2) calls (pk_io()). The latter is where
+ * data are copied, so pollers of different sockets move data in parallel.
  *
  * A few items related to concurrency worth mentioning:
  *
@@ -339,8 +346,13 @@
  *       be freed in a synchronous context, lest the epoll-stored state points
  *       to an invalid memory region. To deal with this, a sock is not freed
  *       immediately. Instead it is moved to S_DELETED state and placed on a
- *       special per-tm list: ma::t_deathrow. Actual freeing is done by
- *       ma_prune() called from poller();
+ *       special per-poller list: poller::p_deathrow. Actual freeing is done
+ *       by poller_prune() called from the socket's poller();
+ *
+ *     - while a poller does io without the tm lock, the socket and the mover
+ *       are not touched by other threads: socket events are only delivered
+ *       to its poller and the writer is locked to the socket. The buffer is
+ *       pinned by buf::b_io: its completion is postponed to ma_buf_done();
  *
  *     - buffer completion (buf_done()) includes removing the buffer from its
  *       queue and invoking a user-supplied call-back
@@ -369,18 +381,32 @@
  *
  *     - bsd Reno "len" fields in socket address structures are optionally used;
  *
- *     - ipv4 and ipv6 protocol families are supported. Unix domain sockets are
- *       not supported.
+ *     - ipv4 and ipv6 protocol families are supported. The unix family is a
+ *       unix-socket transport for end-points co-located on the same node
+ *       ("unix:stream:NAME@PORT", see unix_encode()). It avoids the tcp/ip
+ *       stack on the loopback path: no checksums, segmentation or
+ *       acknowledgements. It is not a shared-memory transport: messages and
+ *       bulk data are copied through the kernel over the connection, like
+ *       over tcp. Connections are accepted only from processes of the same
+ *       user or root (sock_peer_admit()). The peer of an accepted connection
+ *       is anonymous, it is identified by the source address of its first
+ *       packet (sock_peer_bind());
+ *
+ *     - on linux, stream sockets send large payloads with MSG_ZEROCOPY
+ *       (sock_zc_init(), pk_io()). A buffer is completed only after the kernel
+ *       reports through the socket error queue that all its zero-copy sends
+ *       are released (sock_zc_reap()). Zero-copy is switched off for a socket
+ *       when the kernel reports that data were copied anyway (loopback), and
+ *       is not used at all if SO_ZEROCOPY is not supported or
+ *       M0_NET_SOCK_ZEROCOPY=0 is set in the environment.
  *
  * When a socket is created, it is added to the epoll instance monitored by
  * poller() (sock_init_fd()). All sockets are monitored for read events. Only
  * sockets to end-points with a non-empty list of writers are monitored for
- * writes (ep_balance()).
- *
- * @todo It is not clear how to manage write-monitoring in case of multiple
- * "parallel" sockets to the same end-point. If writeability of all such sockets
- * is monitored, epoll_wait() can busy-loop. If not all of them are monitored,
- * they are useless for concurrent writes.
+ * writes (ep_balance()). A writeable socket, for which all writers of its
+ * end-point are locked to other sockets, is removed from write-monitoring
+ * (sock_out()) to avoid busy-looping in epoll_wait(). It is monitored again
+ * when the next writer is added to the end-point.
  *
  * Buffer data are transmitted as a collection of PUT packets. For each packet,
  * first the header is transmitted, then the payload. The payload is transmitted
@@ -390,7 +416,8 @@
  *
  *     - for stream sockets, packet size is equal to the buffer data size
  *       (stream_pk_size()), that is, the entire buffer is transmitted as a
- *       single packet, consisting of multiple intervals. Note, that it is not
+ *       single packet, consisting of multiple intervals, unless the buffer is
+ *       striped over parallel sockets (see below). Note, that it is not
  *       required that the entire header is written in one write;
  *
  *     - for datagram sockets, packet size is equal to the maximal datagram size
@@ -523,27 +550,53 @@
  *
  * sock has its own provisioning, see the comment in pk_header_done().
  *
+ * A buffer on the receive queue can receive multiple incoming messages (see
+ * m0_net_buffer::nb_min_receive_size, m0_net_buffer::nb_max_receive_msgs). When
+ * a message is received, the completion event is posted with M0_NET_BUF_RETAIN
+ * flag and m0_net_buffer_event::nbe_offset set to the message offset, and the
+ * buffer stays on the queue to receive the next message after the current one
+ * (buf_complete(), buf_recv_next()). The rpc layer gets up to SOCK_RECV_MSG_NR
+ * messages per buffer (get_rpc_max_recv_msgs()), so that small messages do
+ * not consume a receive buffer each.
+ *
+ * Parallel sockets
+ * ----------------
+ *
+ * A transfer machine can open multiple parallel sockets to the same remote
+ * end-point (ma::t_sock_nr, set by m0_net_sock_ep_sockets_set() or
+ * M0_NET_SOCK_EP_SOCKETS environment variable, 1 by default). Additional
+ * sockets are opened by ep_balance() when the end-point has writers, only to
+ * end-points that were connected to (sock::s_flags & OUTGOING), because an
+ * ephemeral address of an accepted connection cannot be connected to.
+ *
+ * The packets of a large M0_NET_QT_ACTIVE_BULK_SEND buffer are striped across
+ * the sockets: in addition to buf::b_writer, the buffer gets up to
+ * ma::t_sock_nr - 1 "lanes" (buf::b_lane[]), which are additional writers. The
+ * buffer is split into buf::b_lane_nr packets, and every writer, when it gets
+ * hold of a socket, claims the next unsent packet (buf::b_pknext). The
+ * receiver already accepts packets of a buffer in any order and over any socket
+ * (buf_accept()), so the protocol is unchanged. The buffer completes when all
+ * its writers are done (buf::b_busy).
+ *
+ * Messages (M0_NET_QT_MSG_SEND) are not striped: a message is matched to a
+ * receive buffer when its first packet arrives (pk_header_done()), and
+ * packets of the same message coming over different sockets could end up in
+ * different receive buffers.
+ *
  * Limitations and options
  * -----------------------
  *
  * Only TCP sockets have been tested so far.
  *
- * Only 1 socket to a particular end-point is supported, that is, multiple
- * parallel sockets are not opened. Whether they are needed at all is an
- * interesting question.
- *
  * Once opened, a socket is never closed until an error or tm
  * finalisation. Sockets should perhaps be garbage collected after a period of
  * inactivity.
  *
- * Packets for a buffer are sent sequentially.
+ * M0_NET_QT_PASSIVE_BULK_SEND buffers are sent over the socket, which carried
+ * the GET request, and are not striped.
  *
  * rdma (ROCE or iWARP) is not supported.
  *
- * Multiple incoming messages in one buffer (see M0_NET_QT_MSG_RECV,
- * m0_net_buffer::nb_min_receive_size, m0_net_buffer::nb_max_receive_msgs) are
- * not supported.
- *
  * Differences with lnet
  * ---------------------
  *
@@ -609,14 +662,25 @@
 #include <sys/types.h>
 #include <sys/uio.h>
 #include <sys/socket.h>                    /* epoll_create */
+#include <sys/un.h>                        /* sockaddr_un */
 #include <netinet/in.h>                    /* INET_ADDRSTRLEN */
 #include <netinet/ip.h>
 #include <arpa/inet.h>                     /* inet_pton, htons */
 #include <string.h>                        /* strchr */
+#include <stdlib.h>                        /* getenv, atoi */
 #include <unistd.h>                        /* close */
+#if defined(MSG_ZEROCOPY) && defined(SO_ZEROCOPY)
+#include <linux/errqueue.h>                /* sock_extended_err */
+#define SOCK_HAS_ZEROCOPY (1)
+#define SOCK_MSG_ZEROCOPY MSG_ZEROCOPY
+#else
+#define SOCK_HAS_ZEROCOPY (0)
+#define SOCK_MSG_ZEROCOPY (0)
+#endif
 
 #define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_NET
 #include "lib/trace.h"
+#include "lib/atomic.h"
 #include "lib/errno.h"                     /* EINTR, ENOMEM */
 #include "lib/thread.h"
 #include "lib/misc.h"                      /* ARRAY_SIZE, IS_IN_ARRAY */
@@ -629,13 +693,18 @@
 #include "lib/bitmap.h"
 #include "lib/refs.h"
 #include "lib/time.h"
+#include "lib/finject.h"                   /* M0_FI_ENABLED */
 #include "sm/sm.h"
 #include "motr/magic.h"
+#include "addb2/addb2.h"
+#include "addb2/counter.h"
 #include "net/net.h"
+#include "net/addb2.h"                     /* M0_AVI_NET_SOCK_EVENTS */
 #include "net/buffer_pool.h"
 #include "net/net_internal.h"              /* m0_net__tm_invariant */
 #include "format/format.h"
 
+#include "net/sock/sock.h"
 #include "net/sock/xcode.h"
 #include "net/sock/xcode_xc.h"
 
@@ -656,6 +725,50 @@ struct ma;
 struct bdesc;
 struct packet;
 
+enum {
+	/** Maximal number of parallel sockets to a remote end-point. */
+	SOCK_EP_MAX     = 16,
+	/** Minimal payload size of a packet of a buffer striped over sockets. */
+	SOCK_STRIPE_MIN = 64 * 1024,
+	/** Maximal number of poller threads in a transfer machine. */
+	SOCK_POLLER_MAX = 16,
+	/**
+	 * Maximal number of MSG_ZEROCOPY sends on a socket, not yet released
+	 * by the kernel, see sock::s_zc.
+	 */
+	SOCK_ZC_NR      = 256,
+	/** Minimal payload size sent with MSG_ZEROCOPY. */
+	SOCK_ZC_MIN     = 32 * 1024,
+	/**
+	 * Maximal number of rpc messages received in one buffer, see
+	 * get_rpc_max_recv_msgs().
+	 */
+	SOCK_RECV_MSG_NR = 32,
+	/**
+	 * A receive buffer with less room left is completed, rather than
+	 * kept on the queue for the next message (buf_recv_next()).
+	 */
+	SOCK_RECV_MIN   = 4096
+};
+
+/**
+ * Number of parallel sockets to a remote end-point for transfer machines
+ * initialised from now on, see m0_net_sock_ep_sockets_set().
+ */
+static uint32_t sock_ep_nr = 1;
+
+/**
+ * Number of poller threads for transfer machines initialised from now on, see
+ * m0_net_sock_pollers_set().
+ */
+static uint32_t sock_poller_nr = 1;
+
+/**
+ * Whether stream sockets opened from now on send large payloads with
+ * MSG_ZEROCOPY, see m0_net_sock_zerocopy_set().
+ */
+static bool sock_zerocopy = true;
+
 /**
  * State of a sock state machine. Stored in sock::s_sm.sm_state.
  */
@@ -685,7 +798,8 @@ enum sock_state {
 	S_OPEN,
 	/**
 	 * The sock has been finalised (sock_done()) and is now placed on
-	 * ma::t_deathrow list. It will be collected and freed by ma_prune().
+	 * poller::p_deathrow list. It will be collected and freed by
+	 * poller_prune().
 	 */
 	S_DELETED
 };
@@ -710,7 +824,17 @@ enum sock_flags {
 	/** Non blocking write is possible on the sock. */
 	HAS_WRITE  = M0_BITS(M_WRITE),
 	/** Non-blocking writes are monitored for this sock by epoll(2). */
-	WRITE_POLL = M0_BITS(M_NR + 1)
+	WRITE_POLL = M0_BITS(M_NR + 1),
+	/**
+	 * The sock was connected to the end-point, rather than accepted from
+	 * it. Only such end-points get parallel sockets (ep_balance()).
+	 */
+	OUTGOING   = M0_BITS(M_NR + 2),
+	/**
+	 * SO_ZEROCOPY is enabled on the sock: large payloads are sent with
+	 * MSG_ZEROCOPY (pk_io()).
+	 */
+	ZEROCOPY   = M0_BITS(M_NR + 3)
 };
 
 /**
@@ -768,36 +892,63 @@ struct ep {
 #endif
 };
 
+/**
+ * A poller: a thread monitoring a shard of the sockets of a transfer machine.
+ *
+ * All asynchronous activity happens in poller threads:
+ *
+ *     - notifications about incoming connections;
+ *
+ *     - notifications about possibility of non-blocking socket io;
+ *
+ *     - buffer completion events (ma_buf_done());
+ *
+ *     - buffer timeouts (ma_buf_timeout(), only in the first poller);
+ *
+ *     - freeing socket structures (poller_prune());
+ *
+ * Each socket is assigned to a poller when created (sock::s_poller) and is
+ * registered with the epoll instance of this poller only. Hence, events for
+ * a socket are handled by a single thread and a sock structure is freed by the
+ * same thread that receives its events.
+ *
+ * Poller can easily be adapted to be a "chore" in a locality.
+ */
+struct poller {
+	/** The transfer machine. */
+	struct ma               *p_ma;
+	/** Index of this poller in ma::t_poller[]. */
+	uint32_t                 p_idx;
+	/** Thread executing poller(). */
+	struct m0_thread         p_thread;
+	/** epoll(2) instance file descriptor. */
+	int                      p_epollfd;
+	/** List of finalised sock structures of this poller. */
+	struct m0_tl             p_deathrow;
+	/** Number of events returned by epoll_wait(), M0_AVI_NET_SOCK_EVENTS. */
+	struct m0_addb2_counter  p_events;
+	/** Bytes transferred per readv(2) or writev(2), M0_AVI_NET_SOCK_IO. */
+	struct m0_addb2_counter  p_io;
+};
+
 /** A network transfer machine */
 struct ma {
 	/** Generic transfer machine with buffer queues, etc. */
 	struct m0_net_transfer_mc *t_ma;
-	/**
-	 * Poller thread.
-	 *
-	 * All asynchronous activity happens in this thread:
-	 *
-	 *     - notifications about incoming connections;
-	 *
-	 *     - notifications about possibility of non-blocking socket io;
-	 *
-	 *     - buffer completion events (ma_buf_done());
-	 *
-	 *     - buffer timeouts (ma_buf_timeout());
-	 *
-	 *     - freeing socket structures (ma_prune());
-	 *
-	 * Poller can easily be adapter to be a "chore" in a locality.
-	 *
-	 */
-	struct m0_thread           t_poller;
-	/** epoll(2) instance file descriptor. */
-	int                        t_epollfd;
+	/** Pollers, the first ma::t_poller_nr elements are used. */
+	struct poller              t_poller[SOCK_POLLER_MAX];
+	/** Number of pollers, copied from sock_poller_nr on initialisation. */
+	uint32_t                   t_poller_nr;
+	/** The poller, to which the next socket is assigned (round-robin). */
+	uint32_t                   t_poller_next;
 	bool                       t_shutdown;
-	/** List of finalised sock structures. */
-	struct m0_tl               t_deathrow;
 	/** List of completed buffers. */
 	struct m0_tl               t_done;
+	/**
+	 * Maximal number of parallel sockets to a remote end-point, copied
+	 * from sock_ep_nr on initialisation.
+	 */
+	uint32_t                   t_sock_nr;
 };
 
 /**
@@ -849,12 +1000,13 @@ struct mover {
 	 * For a reader, which is always embedded in a sock (sock::s_reader),
 	 * this points back to the ambient sock.
 	 *
-	 * A writer is always embedded in a buffer (buf::b_writer) and is
-	 * associated with a particular end-point (mover::m_ep), but can switch
-	 * between different sockets to that end-point. This switch can happen
-	 * only on a boundary between packets. When the writer is busy writing a
-	 * packet (R_PK, R_HEADER, R_INTERVAL and R_PK_DONE states), it is
-	 * locked to the socket to which mover::m_sock points.
+	 * A writer is always embedded in a buffer (buf::b_writer or
+	 * buf::b_lane[]) and is associated with a particular end-point
+	 * (mover::m_ep), but can switch between different sockets to that
+	 * end-point. This switch can happen only on a boundary between
+	 * packets. When the writer is busy writing a packet (R_PK, R_HEADER,
+	 * R_INTERVAL and R_PK_DONE states), it is locked to the socket to which
+	 * mover::m_sock points.
 	 */
 	struct sock               *m_sock;
 	/** The end-point. A writer takes a reference to it (ep_add()). */
@@ -892,6 +1044,21 @@ struct buf {
 	struct m0_net_buffer *b_buf;
 	/** Writer moving the data from this buffer. */
 	struct mover          b_writer;
+	/**
+	 * Additional writers, striping the buffer over parallel sockets,
+	 * array of b_lane_nr - 1 elements or NULL.
+	 */
+	struct mover         *b_lane;
+	/** Total number of writers, including b_writer. */
+	uint32_t              b_lane_nr;
+	/** Number of writers not yet done with the buffer. */
+	uint32_t              b_busy;
+	/** Payload size of outgoing packets, set with the first packet. */
+	m0_bcount_t           b_pksize;
+	/** Number of outgoing packets, 0 until the first packet is started. */
+	uint32_t              b_pknr;
+	/** Index of the next outgoing packet to be claimed by a writer. */
+	uint32_t              b_pknext;
 	/** Bitmap of received packets. */
 	struct m0_bitmap      b_done;
 	/** Descriptor of the other buffer in the transfer operation. */
@@ -900,13 +1067,34 @@ struct buf {
 	struct ep            *b_other;
 	/** Linkage in the list of completed buffers (ma::t_done). */
 	struct m0_tlink       b_linkage;
-	/** Not currently used. */
+	/**
+	 * Offset in a M0_NET_QT_MSG_RECV buffer, at which the current incoming
+	 * message is placed (see buf_recv_next()). 0 for other buffers.
+	 */
 	m0_bindex_t           b_offset;
 	/**
 	 * The total size of data expected to be received, copied from
 	 * packet::p_totalsize.
 	 */
 	m0_bindex_t           b_length;
+	/**
+	 * Number of pollers doing io to or from this buffer without the tm
+	 * lock (pk_io()). The buffer is not completed while this is non-zero.
+	 */
+	uint32_t              b_io;
+	/**
+	 * Number of MSG_ZEROCOPY sends from this buffer, which the kernel has
+	 * not released yet (sock_zc_reap()). The buffer is not completed while
+	 * this is non-zero.
+	 */
+	uint32_t              b_zc;
+	/**
+	 * True while the call-back for a message received in a retained
+	 * M0_NET_QT_MSG_RECV buffer runs (buf_complete()). The buffer neither
+	 * accepts the next message, nor is completed until the call-back
+	 * returns.
+	 */
+	bool                  b_upcall;
 };
 
 /** A socket: connection to an end-point. */
@@ -919,12 +1107,29 @@ struct sock {
 	struct m0_sm    s_sm;
 	/** The end-point to which this socket connects. */
 	struct ep      *s_ep;
+	/** The poller monitoring this socket. */
+	struct poller  *s_poller;
 	/** The reader that handles packets incoming to this socket. */
 	struct mover    s_reader;
-	/** Linkage in the list of finalised sockets (ma::t_deathrow). */
+	/** Linkage in the list of finalised sockets (poller::p_deathrow). */
 	struct m0_tlink s_linkage;
 	/** Not currently used. Will be used to garbage collect idle sockets. */
 	m0_time_t       s_last;
+	/**
+	 * Ring of buffers with MSG_ZEROCOPY sends not yet released by the
+	 * kernel, indexed by the send sequence number modulo SOCK_ZC_NR. NULL
+	 * if zero-copy is not used by the socket.
+	 */
+	struct buf    **s_zc;
+	/** Sequence number of the oldest unreleased zero-copy send. */
+	uint32_t        s_zc_head;
+	/** Sequence number of the next zero-copy send. */
+	uint32_t        s_zc_next;
+	/**
+	 * Source address of the packets of an anonymous unix peer, taken from
+	 * its first packet, see sock_peer_bind(). Zero until then.
+	 */
+	struct addr     s_peer;
 };
 
 /**
@@ -951,22 +1156,29 @@ struct socktype {
 /**
  * Protocol (and address) family.
  *
- * Abstracts the differences between ipv4 and ipv6.
+ * Abstracts the differences between ipv4, ipv6 and unix.
  */
 struct pfamily {
 	const char *f_name;
 	/**
 	 * Encode sock address in sockaddr.
 	 *
-	 * @see ipv4_encode(), ipv6_encode().
+	 * @see ipv4_encode(), ipv6_encode(), unix_encode().
 	 */
 	void      (*f_encode)(const struct addr *a, struct sockaddr *sa);
 	/**
 	 * Decode sock address from sockaddr.
 	 *
-	 * @see ipv4_decode(), ipv6_decode().
+	 * @see ipv4_decode(), ipv6_decode(), unix_decode().
 	 */
 	void      (*f_decode)(struct addr *a, const struct sockaddr *sa);
+	/**
+	 * Returns the length of an encoded sockaddr, to be passed to bind(2)
+	 * and connect(2). If NULL, sizeof(struct sockaddr_storage) is used.
+	 *
+	 * @see unix_len().
+	 */
+	socklen_t (*f_len)(const struct sockaddr *sa);
 };
 
 /*
@@ -1028,7 +1240,9 @@ static m0_bcount_t get_max_buffer_segment_size(const struct m0_net_domain *);
 static int32_t get_max_buffer_segments(const struct m0_net_domain *dom);
 static m0_bcount_t get_max_buffer_desc_size(const struct m0_net_domain *);
 
-static void poller   (struct ma *ma);
+static void poller   (struct poller *p);
+static void poller_prune(struct poller *p);
+static struct poller *poller_self(struct ma *ma);
 static void ma__fini (struct ma *ma);
 static void ma_prune (struct ma *ma);
 static void ma_lock  (struct ma *ma);
@@ -1066,6 +1280,9 @@ static void  addr_encode      (const struct addr *addr, struct sockaddr *sa);
 static char *addr_print       (const struct addr *addr);
 static bool  addr_invariant   (const struct addr *addr);
 static bool  addr_eq          (const struct addr *a0, const struct addr *a1);
+static bool  addr_is_anon     (const struct addr *addr);
+static socklen_t addr_len     (const struct addr *addr,
+			       const struct sockaddr *sa);
 
 static int  sock_in(struct sock *s);
 static void sock_out(struct sock *s);
@@ -1078,13 +1295,24 @@ static int  sock_init_fd(int fd, struct sock *s, struct ep *ep, uint32_t flags);
 static int  sock_init(int fd, struct ep *src, struct ep *tgt, uint32_t flags);
 static struct mover *sock_writer(struct sock *s);
 static bool sock_invariant(const struct sock *s);
+static void sock_zc_init(struct sock *s);
+static void sock_zc_fini(struct sock *s);
+static void sock_zc_reap(struct sock *s);
+static int  sock_peer_admit(int fd, const struct addr *a);
+static int  sock_peer_bind(struct sock *s, const struct addr *src);
+static uint32_t sock_zc_event(struct sock *s, uint32_t ev);
 
 static struct ma *buf_ma(struct buf *buf);
 static bool buf_invariant(const struct buf *buf);
 static void buf_fini     (struct buf *buf);
+static int  buf_lanes_add(struct buf *buf, struct ep *ep);
+static void buf_writers_fini(struct buf *buf);
 static int  buf_accept   (struct buf *buf, struct mover *m);
 static void buf_done     (struct buf *buf, int rc);
+static void buf_postpone (struct buf *buf, int rc);
 static void buf_complete (struct buf *buf);
+static bool buf_is_pinned(const struct buf *buf);
+static bool buf_recv_next(struct buf *buf);
 
 static int bdesc_create(struct addr *addr, struct buf *buf,
 			struct m0_net_buf_desc *out);
@@ -1143,6 +1371,9 @@ static void ip4_encode(const struct addr *a, struct sockaddr *sa);
 static void ip4_decode(struct addr *a, const struct sockaddr *sa);
 static void ip6_encode(const struct addr *a, struct sockaddr *sa);
 static void ip6_decode(struct addr *a, const struct sockaddr *sa);
+static void unix_encode(const struct addr *a, struct sockaddr *sa);
+static void unix_decode(struct addr *a, const struct sockaddr *sa);
+static socklen_t unix_len(const struct sockaddr *sa);
 
 static const struct m0_sm_conf sock_conf;
 static const struct m0_sm_conf rw_conf;
@@ -1160,7 +1391,10 @@ static const struct m0_format_tag get_tag;
 
 static const struct pfamily pf[] = {
 	[AF_UNIX]  = {
-		.f_name = "unix"
+		.f_name   = "unix",
+		.f_encode = &unix_encode,
+		.f_decode = &unix_decode,
+		.f_len    = &unix_len
 	},
 	[AF_INET]  = {
 		.f_name   = "inet",
@@ -1221,20 +1455,28 @@ static bool ma_invariant(const struct ma *ma)
 	return  _0C(net != NULL) &&
 		_0C(net->ntm_xprt_private == ma) &&
 		m0_net__tm_invariant(net) &&
-		s_tlist_invariant(&ma->t_deathrow) &&
+		_0C(0 < ma->t_poller_nr && ma->t_poller_nr <= SOCK_POLLER_MAX) &&
+		_0C(m0_forall(i, ma->t_poller_nr,
+			      s_tlist_invariant(&ma->t_poller[i].p_deathrow) &&
+			      m0_tl_forall(s, s, &ma->t_poller[i].p_deathrow,
+					   sock_invariant(s)))) &&
 		/* ma is either fully uninitialised or fully initialised. */
-		_0C((ma->t_poller.t_func == NULL && ma->t_epollfd == -1 &&
-		     m0_nep_tlist_is_empty(eps) &&
-		     s_tlist_is_empty(&ma->t_deathrow)) ||
-		    (ma->t_poller.t_func != NULL && ma->t_epollfd >= 0 &&
+		_0C((m0_forall(i, ma->t_poller_nr,
+			       ma->t_poller[i].p_thread.t_func == NULL &&
+			       ma->t_poller[i].p_epollfd == -1 &&
+			       s_tlist_is_empty(&ma->t_poller[i].p_deathrow)) &&
+		     m0_nep_tlist_is_empty(eps)) ||
+		    (m0_forall(i, ma->t_poller_nr,
+			       ma->t_poller[i].p_thread.t_func != NULL &&
+			       ma->t_poller[i].p_epollfd >= 0) &&
 		     m0_tl_exists(m0_nep, nep, eps,
 				  m0_tl_exists(s, s, &ep_net(nep)->e_sock,
 					  s->s_sm.sm_state == S_LISTENING))) ||
 		    ma->t_shutdown) &&
 		/* In STARTED state ma is fully initialised. */
 		_0C(ergo(net->ntm_state == M0_NET_TM_STARTED,
-			 ma->t_epollfd >= 0)) &&
-		_0C(m0_tl_forall(s, s, &ma->t_deathrow, sock_invariant(s))) &&
+			 m0_forall(i, ma->t_poller_nr,
+				   ma->t_poller[i].p_epollfd >= 0))) &&
 		/* Endpoints are unique. */
 		_0C(m0_tl_forall(m0_nep, p, eps,
 			m0_tl_forall(m0_nep, q, eps,
@@ -1251,10 +1493,14 @@ static bool sock_invariant(const struct sock *s)
 {
 	struct ma *ma = ep_ma(s->s_ep);
 
-	return  _0C((s->s_sm.sm_state == S_DELETED) ==
-		    s_tlist_contains(&ma->t_deathrow, s)) &&
+	return  _0C(s->s_poller >= ma->t_poller &&
+		    s->s_poller < ma->t_poller + ma->t_poller_nr) &&
+		_0C((s->s_sm.sm_state == S_DELETED) ==
+		    s_tlist_contains(&s->s_poller->p_deathrow, s)) &&
 		_0C((s->s_sm.sm_state != S_DELETED) ==
-		    s_tlist_contains(&s->s_ep->e_sock, s));
+		    s_tlist_contains(&s->s_ep->e_sock, s)) &&
+		_0C(ergo(s->s_flags & ZEROCOPY, s->s_zc != NULL)) &&
+		_0C(s->s_zc_next - s->s_zc_head <= SOCK_ZC_NR);
 }
 
 static bool buf_invariant(const struct buf *buf)
@@ -1269,6 +1515,12 @@ static bool buf_invariant(const struct buf *buf)
 		 _0C(nb->nb_tm != NULL) &&
 		 _0C(ergo(buf->b_writer.m_sm.sm_conf != NULL,
 			  mover_invariant(&buf->b_writer))) &&
+		 _0C((buf->b_lane != NULL) == (buf->b_lane_nr > 1)) &&
+		 _0C(buf->b_busy <= max32u(buf->b_lane_nr, 1)) &&
+		 _0C(buf->b_pknext <= buf->b_pknr) &&
+		 _0C(m0_forall(i, buf->b_lane == NULL ? 0 : buf->b_lane_nr - 1,
+			       ergo(buf->b_lane[i].m_sm.sm_conf != NULL,
+				    mover_invariant(&buf->b_lane[i])))) &&
 		 _0C(m0_net__buffer_invariant(nb)));
 }
 
@@ -1278,9 +1530,11 @@ static bool addr_invariant(const struct addr *a)
 		_0C(pf[a->a_family].f_name != NULL) &&
 		_0C(IS_IN_ARRAY(a->a_socktype, stype)) &&
 		_0C(stype[a->a_socktype].st_name != NULL) &&
-		_0C(M0_IN(a->a_family, (AF_INET, AF_INET6))) &&
+		_0C(M0_IN(a->a_family, (AF_INET, AF_INET6, AF_UNIX))) &&
 		_0C(M0_IN(a->a_socktype, (SOCK_STREAM, SOCK_DGRAM))) &&
-		_0C(M0_IN(a->a_protocol, (0, IPPROTO_TCP, IPPROTO_UDP)));
+		_0C(M0_IN(a->a_protocol, (0, IPPROTO_TCP, IPPROTO_UDP))) &&
+		_0C(ergo(a->a_family == AF_UNIX,
+			 a->a_socktype == SOCK_STREAM && a->a_protocol == 0));
 }
 
 static bool ep_invariant(const struct ep *ep)
@@ -1298,23 +1552,26 @@ static bool ep_invariant(const struct ep *ep)
 		/* Each writer got a reference... */
 		_0C(ep->e_r_mover == m_tlist_length(&ep->e_writer)) &&
 		/*
-		 * and each socket (including ones lingering on ma->t_deathrow)
-		 * got a reference.
+		 * and each socket (including ones lingering on pollers'
+		 * death-rows) got a reference.
 		 */
 		_0C(ep->e_r_sock  == s_tlist_length(&ep->e_sock) +
-		    m0_tl_fold(s, s, dead, &ma->t_deathrow, 0,
-			       dead + (s->s_ep == ep))) &&
+		    m0_reduce(i, ma->t_poller_nr, 0,
+			      + m0_tl_fold(s, s, dead,
+					   &ma->t_poller[i].p_deathrow, 0,
+					   dead + (s->s_ep == ep)))) &&
 #endif
 		_0C(m0_tl_forall(s, s, &ep->e_sock,
 				 s->s_ep == ep && sock_invariant(s))) &&
 		_0C(m0_tl_forall(m, w, &ep->e_writer,
 				 w->m_ep == ep &&
-				 /*
-				  * The writer locked to a socket is always at
-				  * the head of the writers list.
-				  */
 				 ergo(w->m_sock != NULL,
-				      w == m_tlist_head(&ep->e_writer))));
+				      s_tlist_contains(&ep->e_sock,
+						       w->m_sock)))) &&
+		/* A socket is locked to at most one writer. */
+		_0C(m0_tl_forall(s, s, &ep->e_sock,
+				 m0_tl_fold(m, w, nr, &ep->e_writer, 0,
+					    nr + (w->m_sock == s)) <= 1));
 }
 
 static bool mover_invariant(const struct mover *m)
@@ -1355,21 +1612,28 @@ static bool ma_is_locked(const struct ma *ma)
 }
 
 /**
- * Main loop of a per-ma thread that polls sockets.
+ * Main loop of a poller thread.
  */
-static void poller(struct ma *ma)
+static void poller(struct poller *p)
 {
 	enum { EV_NR = 256 };
+	struct ma         *ma = p->p_ma;
 	struct epoll_event ev[EV_NR] = {};
 	int                nr;
 	int                i;
+
+	M0_SET0(&p->p_events);
+	M0_SET0(&p->p_io);
+	M0_ADDB2_PUSH(M0_AVI_NET_SOCK_POLLER, (uint64_t)ma, p->p_idx);
+	m0_addb2_counter_add(&p->p_events, M0_AVI_NET_SOCK_EVENTS, -1);
+	m0_addb2_counter_add(&p->p_io, M0_AVI_NET_SOCK_IO, -1);
 	/*
 	 * Notify users that ma reached M0_NET_TM_STARTED state.
 	 *
 	 * This also sets ma->ntm_ep.
 	 *
-	 * This should be done once per tm, so if multiple poller threads are
-	 * used, only 1 event should be posted.
+	 * This should be done once per tm, so only the first poller posts the
+	 * event.
 	 *
 	 * @todo there is a race condition here: an application (i.e., the rpc
 	 * layer), might timeout waiting for the ma to start and call
@@ -1378,11 +1642,12 @@ static void poller(struct ma *ma)
 	 *
 	 * Because of this, we do not assert ma states here.
 	 */
-	ma_event_post(ma, M0_NET_TM_STARTED);
+	if (p->p_idx == 0)
+		ma_event_post(ma, M0_NET_TM_STARTED);
 	while (1) {
 		if (ma->t_shutdown)
 			break;
-		nr = epoll_wait(ma->t_epollfd, ev, ARRAY_SIZE(ev), 1000);
+		nr = epoll_wait(p->p_epollfd, ev, ARRAY_SIZE(ev), 1000);
 		if (nr == -1) {
 			M0_LOG(M0_DEBUG, "epoll: %i.", -errno);
 			M0_ASSERT(errno == EINTR);
@@ -1392,6 +1657,8 @@ static void poller(struct ma *ma)
 		if (ma->t_shutdown)
 			break;
 		M0_LOG(M0_DEBUG, "Got: %d.", nr);
+		if (nr > 0)
+			m0_addb2_counter_mod(&p->p_events, nr);
 		ma_lock(ma);
 		M0_ASSERT(ma_is_locked(ma) && ma_invariant(ma));
 		for (i = 0; i < nr; ++i) {
@@ -1408,7 +1675,8 @@ static void poller(struct ma *ma)
 				break;
 		}
 		/* @todo close long-unused sockets. */
-		ma_buf_timeout(ma);
+		if (p->p_idx == 0)
+			ma_buf_timeout(ma);
 		/*
 		 * Deliver buffer completion events and re-provision receive
 		 * queue if necessary.
@@ -1417,12 +1685,29 @@ static void poller(struct ma *ma)
 		M0_ASSERT(ma_invariant(ma));
 		/*
 		 * This is the only place, where sock structures are freed,
-		 * except for ma finalisation.
+		 * except for ma finalisation. Only the sockets of this poller
+		 * are freed, because other pollers might have events for their
+		 * sockets pending in their ev[] arrays.
 		 */
-		ma_prune(ma);
+		poller_prune(p);
 		M0_ASSERT(ma_invariant(ma));
 		ma_unlock(ma);
 	}
+	m0_addb2_counter_del(&p->p_io);
+	m0_addb2_counter_del(&p->p_events);
+	m0_addb2_pop(M0_AVI_NET_SOCK_POLLER);
+}
+
+/** Returns the poller running in the current thread or NULL. */
+static struct poller *poller_self(struct ma *ma)
+{
+	int i;
+
+	for (i = 0; i < ma->t_poller_nr; ++i) {
+		if (m0_thread_self() == &ma->t_poller[i].p_thread)
+			return &ma->t_poller[i];
+	}
+	return NULL;
 }
 
 /**
@@ -1446,33 +1731,51 @@ static int ma_init(struct m0_net_transfer_mc *net)
 {
 	struct ma *ma;
 	int        result;
+	int        i;
 
 	M0_ASSERT(net->ntm_xprt_private == NULL);
 
 	M0_ALLOC_PTR(ma);
 	if (ma != NULL) {
-		ma->t_epollfd = -1;
 		ma->t_shutdown = false;
 		net->ntm_xprt_private = ma;
 		ma->t_ma = net;
-		s_tlist_init(&ma->t_deathrow);
+		ma->t_poller_nr = sock_poller_nr;
+		for (i = 0; i < ma->t_poller_nr; ++i) {
+			struct poller *p = &ma->t_poller[i];
+
+			p->p_ma      = ma;
+			p->p_idx     = i;
+			p->p_epollfd = -1;
+			s_tlist_init(&p->p_deathrow);
+		}
 		b_tlist_init(&ma->t_done);
+		ma->t_sock_nr = sock_ep_nr;
 		result = 0;
 	} else
 		result = M0_ERR(-ENOMEM);
 	return M0_RC(result);
 }
 
-/** Frees finalised sock structures. */
-static void ma_prune(struct ma *ma)
+/** Frees finalised sock structures of a poller. */
+static void poller_prune(struct poller *p)
 {
 	struct sock *sock;
 
-	M0_PRE(ma_is_locked(ma));
-	m0_tl_for(s, &ma->t_deathrow, sock) {
+	M0_PRE(ma_is_locked(p->p_ma));
+	m0_tl_for(s, &p->p_deathrow, sock) {
 		sock_fini(sock);
 	} m0_tl_endfor;
-	M0_POST(s_tlist_is_empty(&ma->t_deathrow));
+	M0_POST(s_tlist_is_empty(&p->p_deathrow));
+}
+
+/** Frees finalised sock structures of all pollers. */
+static void ma_prune(struct ma *ma)
+{
+	int i;
+
+	for (i = 0; i < ma->t_poller_nr; ++i)
+		poller_prune(&ma->t_poller[i]);
 }
 
 /**
@@ -1484,18 +1787,23 @@ static void ma_prune(struct ma *ma)
 static void ma__fini(struct ma *ma)
 {
 	struct m0_net_end_point *net;
+	int                      i;
 
 	M0_PRE(ma_is_locked(ma));
 	if (!ma->t_shutdown) {
 		/* Set the shutdown flag.
-		 * Release the lock and wait for poller(), so that the poller()
+		 * Release the lock and wait for pollers, so that each poller()
 		 * will get a chance to detect this flag and exit.
 		 */
 		ma->t_shutdown = true;
 		ma_unlock(ma);
-		if (ma->t_poller.t_func != NULL) {
-			m0_thread_join(&ma->t_poller);
-			m0_thread_fini(&ma->t_poller);
+		for (i = 0; i < ma->t_poller_nr; ++i) {
+			struct m0_thread *t = &ma->t_poller[i].p_thread;
+
+			if (t->t_func != NULL) {
+				m0_thread_join(t);
+				m0_thread_fini(t);
+			}
 		}
 		/* Go on finalizing the ma */
 		ma_lock(ma);
@@ -1510,14 +1818,19 @@ static void ma__fini(struct ma *ma)
 		 * Finalise epoll after sockets, because sock_done() removes the
 		 * socket from the poll set.
 		 */
-		if (ma->t_epollfd >= 0) {
-			close(ma->t_epollfd);
-			ma->t_epollfd = -1;
+		for (i = 0; i < ma->t_poller_nr; ++i) {
+			struct poller *p = &ma->t_poller[i];
+
+			if (p->p_epollfd >= 0) {
+				close(p->p_epollfd);
+				p->p_epollfd = -1;
+			}
 		}
 		ma_buf_done(ma);
 		ma_prune(ma);
 		b_tlist_fini(&ma->t_done);
-		s_tlist_fini(&ma->t_deathrow);
+		for (i = 0; i < ma->t_poller_nr; ++i)
+			s_tlist_fini(&ma->t_poller[i].p_deathrow);
 		M0_ASSERT(m0_nep_tlist_is_empty(&ma->t_ma->ntm_end_points));
 		ma->t_ma->ntm_ep = NULL;
 	}
@@ -1552,39 +1865,46 @@ static int ma_start(struct m0_net_transfer_mc *net, const char *name)
 {
 	struct ma *ma = net->ntm_xprt_private;
 	int        result;
+	int        i;
 
 	M0_PRE(ma_is_locked(ma) && ma_invariant(ma));
 	M0_PRE(net->ntm_state == M0_NET_TM_STARTING);
 
 	/*
-	 * - initialise epoll
+	 * - initialise epoll instances of the pollers
 	 *
 	 * - parse the address and create the source endpoint
 	 *
 	 * - create the listening socket
 	 *
-	 * - start the poller thread.
+	 * - start the poller threads.
 	 *
-	 * Should be done in this order, because the poller thread uses the
+	 * Should be done in this order, because the first poller thread uses the
 	 * listening socket to get the source endpoint to post a ma state change
 	 * event (outside of ma lock).
 	 */
-	ma->t_epollfd = epoll_create(1);
-	if (ma->t_epollfd >= 0) {
+	for (i = 0, result = 0; i < ma->t_poller_nr && result == 0; ++i) {
+		ma->t_poller[i].p_epollfd = epoll_create(1);
+		if (ma->t_poller[i].p_epollfd < 0)
+			result = -errno;
+	}
+	if (result == 0) {
 		struct ep *ep;
 
 		result = ep_find(ma, name, &ep);
 		if (result == 0) {
 			result = sock_init(-1, ep, NULL, EPOLLET);
-			if (result == 0) {
-				result = M0_THREAD_INIT(&ma->t_poller,
-							struct ma *, NULL,
-							&poller, ma, "socktm");
+			for (i = 0; i < ma->t_poller_nr && result == 0; ++i) {
+				struct poller *p = &ma->t_poller[i];
+
+				result = M0_THREAD_INIT(&p->p_thread,
+							struct poller *, NULL,
+							&poller, p,
+							"socktm%i", i);
 			}
 			EP_PUT(ep, find);
 		}
-	} else
-		result = -errno;
+	}
 	if (result != 0)
 		ma__fini(ma);
 	M0_POST(ma_invariant(ma));
@@ -1666,7 +1986,12 @@ static void ma_buf_timeout(struct ma *ma)
 		m0_tl_for(m0_net_tm, &ma->t_ma->ntm_q[i], nb) {
 			if (nb->nb_timeout < now) {
 				nb->nb_flags |= M0_NET_BUF_TIMED_OUT;
-				buf_done(nb->nb_xprt_private, -ETIMEDOUT);
+				/*
+				 * Do not complete here: completion releases
+				 * the tm lock and other pollers can modify
+				 * the queue being scanned.
+				 */
+				buf_postpone(nb->nb_xprt_private, -ETIMEDOUT);
 			}
 		} m0_tl_endfor;
 	}
@@ -1686,11 +2011,17 @@ static void ma_buf_done(struct ma *ma)
 	int         nr = 0;
 
 	M0_PRE(ma_is_locked(ma) && ma_invariant(ma));
-	m0_tl_for(b, &ma->t_done, buf) {
+	/*
+	 * buf_complete() releases the lock and other pollers can complete
+	 * buffers from the list, so restart the scan from the head every
+	 * time. Skip pinned buffers (buf_is_pinned()).
+	 */
+	while ((buf = m0_tl_find(b, buf, &ma->t_done,
+				 !buf_is_pinned(buf))) != NULL) {
 		b_tlist_del(buf);
 		buf_complete(buf);
 		nr++;
-	} m0_tl_endfor;
+	}
 	if (nr > 0 && ma->t_ma->ntm_callback_counter == 0)
 		m0_chan_broadcast(&ma->t_ma->ntm_chan);
 	M0_POST(ma_invariant(ma));
@@ -1699,6 +2030,9 @@ static void ma_buf_done(struct ma *ma)
 /**
  * Finds a buffer on M0_NET_QT_MSG_RECV queue, ready to receive "len" bytes of
  * data.
+ *
+ * A buffer that already holds some messages (buf::b_offset > 0) is selected if
+ * the message fits in the remaining space.
  */
 static struct buf *ma_recv_buf(struct ma *ma, m0_bcount_t len)
 {
@@ -1706,8 +2040,8 @@ static struct buf *ma_recv_buf(struct ma *ma, m0_bcount_t len)
 	nb = m0_tl_find(m0_net_tm, nb, &ma->t_ma->ntm_q[M0_NET_QT_MSG_RECV],({
 			struct buf *b = nb->nb_xprt_private;
 
-			b->b_done.b_words == NULL &&
-			m0_vec_count(&nb->nb_buffer.ov_vec) >= len;
+			b->b_done.b_words == NULL && !b->b_upcall &&
+			m0_vec_count(&nb->nb_buffer.ov_vec) - b->b_offset >= len;
 	      }));
 	return nb != NULL ? nb->nb_xprt_private : NULL;
 }
@@ -1803,6 +2137,8 @@ static int buf_add(struct m0_net_buffer *nb)
 	else if (qt == M0_NET_QT_ACTIVE_BULK_RECV)
 		mover_init(w, ma, &get_op);
 	w->m_buf = buf;
+	buf->b_lane_nr = 1;
+	buf->b_busy    = 1;
 	switch (qt) {
 	case M0_NET_QT_MSG_RECV:
 		result = 0;
@@ -1828,6 +2164,9 @@ static int buf_add(struct m0_net_buffer *nb)
 			result = ep_create(ma, &peer->bd_addr, NULL, &ep);
 			if (result == 0) {
 				result = ep_add(ep, w);
+				if (result == 0 &&
+				    qt == M0_NET_QT_ACTIVE_BULK_SEND)
+					result = buf_lanes_add(buf, ep);
 				EP_PUT(ep, find);
 			}
 		}
@@ -1837,7 +2176,7 @@ static int buf_add(struct m0_net_buffer *nb)
 		break;
 	}
 	if (result != 0)
-		mover_fini(w);
+		buf_writers_fini(buf);
 	M0_POST(ma_is_locked(ma) && ma_invariant(ma) && buf_invariant(buf));
 	TLOG(B_F, B_P(buf));
 	return M0_RC(result);
@@ -1955,6 +2294,19 @@ static uint32_t get_rpc_max_segs_nr(struct m0_net_domain *ndom)
 		return default_xo_rpc_max_segs_nr(ndom);
 }
 
+/**
+ * Maximal number of rpc messages received in a single buffer.
+ *
+ * Used as m0_net_xprt_ops::xo_rpc_max_recv_msgs()
+ *
+ * @see m0_net_domain_rpc_max_recv_msgs()
+ */
+static uint32_t get_rpc_max_recv_msgs(struct m0_net_domain *ndom,
+				      m0_bcount_t rpc_size)
+{
+	return SOCK_RECV_MSG_NR;
+}
+
 /** Processes a "readable" event for a socket. */
 static int sock_in(struct sock *s)
 {
@@ -1967,6 +2319,7 @@ static int sock_in(struct sock *s)
 /** Processes a "writable" event for a socket. */
 static void sock_out(struct sock *s)
 {
+	struct ep    *ep = s->s_ep;
 	struct mover *w;
 	int           state;
 
@@ -1974,15 +2327,28 @@ static void sock_out(struct sock *s)
 	TLOG(SOCK_F, SOCK_P(s));
 	s->s_flags |= HAS_WRITE;
 	/*
+	 * Continue with the writer locked to this socket, if any, otherwise
+	 * pick the first writer not locked to any socket.
+	 *
 	 * @todo this can monopolise processor. Consider breaking out of this
 	 * loop after some number of iterations.
 	 */
-	while ((s->s_flags & HAS_WRITE) &&
-	       (w = m_tlist_head(&s->s_ep->e_writer)) != NULL) {
+	while ((s->s_flags & HAS_WRITE) && s->s_sm.sm_state == S_OPEN &&
+	       (w = sock_writer(s) ?:
+		m0_tl_find(m, w, &ep->e_writer, w->m_sock == NULL)) != NULL) {
 		state = mover_op(w, s, M_WRITE);
 		if (state != R_DONE && w->m_sock != s)
-			m_tlist_move_tail(&s->s_ep->e_writer, w);
+			m_tlist_move_tail(&ep->e_writer, w);
 	}
+	/*
+	 * The socket is still writable, but all writers are locked to other
+	 * parallel sockets. Stop monitoring it for writes, otherwise
+	 * epoll_wait() would return immediately. ep_balance() resumes
+	 * monitoring when a writer is added.
+	 */
+	if ((s->s_flags & (HAS_WRITE|WRITE_POLL)) == (HAS_WRITE|WRITE_POLL) &&
+	    s->s_sm.sm_state == S_OPEN && !m_tlist_is_empty(&ep->e_writer))
+		sock_ctl(s, EPOLL_CTL_MOD, 0);
 }
 
 /** Processes an "error" event for a socket. */
@@ -1998,9 +2364,7 @@ static void sock_close(struct sock *s)
 /** Returns the writer locked to the socket, if any. */
 static struct mover *sock_writer(struct sock *s)
 {
-	struct mover *w = m_tlist_head(&s->s_ep->e_writer);
-
-	return w != NULL && w->m_sock == s ? w : NULL;
+	return m0_tl_find(m, w, &s->s_ep->e_writer, w->m_sock == s);
 }
 
 /**
@@ -2017,7 +2381,7 @@ static void sock_fini(struct sock *s)
 	M0_PRE(s->s_reader.m_sm.sm_conf == NULL);
 	M0_PRE(s->s_sm.sm_conf != NULL);
 	M0_PRE(s->s_sm.sm_state == S_DELETED);
-	M0_PRE(s_tlist_contains(&ma->t_deathrow, s));
+	M0_PRE(s_tlist_contains(&s->s_poller->p_deathrow, s));
 
 	TLOG(SOCK_F, SOCK_P(s));
 	EP_PUT(s->s_ep, sock);
@@ -2052,12 +2416,13 @@ static void sock_done(struct sock *s, bool balance)
 		if (s->s_fd > 0) {
 			int result = sock_ctl(s, EPOLL_CTL_DEL, 0);
 			M0_ASSERT(ergo(result != 0, errno == ENOENT));
+			sock_zc_fini(s);
 			shutdown(s->s_fd, SHUT_RDWR);
 			close(s->s_fd);
 			s->s_fd = -1;
 		}
 		m0_sm_state_set(&s->s_sm, S_DELETED);
-		s_tlist_move(&ma->t_deathrow, s);
+		s_tlist_move(&s->s_poller->p_deathrow, s);
 		if (balance)
 			(void)ep_balance(s->s_ep);
 	}
@@ -2096,6 +2461,9 @@ static int sock_init(int fd, struct ep *src, struct ep *tgt, uint32_t flags)
 	if (s == NULL)
 		return M0_ERR(-ENOMEM);
 	s->s_ep = ep;
+	/* The listening socket goes to the first poller, others round-robin. */
+	s->s_poller = &ma->t_poller[fd < 0 && tgt == NULL ? 0 :
+				    ma->t_poller_next++ % ma->t_poller_nr];
 	EP_GET(ep, sock);
 	s_tlink_init_at(s, &ep->e_sock);
 	m0_sm_init(&s->s_sm, &sock_conf, state, &ma->t_ma->ntm_group);
@@ -2105,6 +2473,7 @@ static int sock_init(int fd, struct ep *src, struct ep *tgt, uint32_t flags)
 	if (result == 0) {
 		if (fd >= 0) {
 			state = S_OPEN;
+			sock_zc_init(s);
 		} else if (tgt == NULL) {
 			/* Listening. */
 			if (ep->e_a.a_socktype == SOCK_STREAM)
@@ -2118,12 +2487,15 @@ static int sock_init(int fd, struct ep *src, struct ep *tgt, uint32_t flags)
 				result = M0_ERR(-errno);
 		} else {
 			/* Connecting. */
+			s->s_flags |= OUTGOING;
+			sock_zc_init(s);
 			if (ep->e_a.a_socktype == SOCK_STREAM) {
 				struct sockaddr_storage sa = {};
 
 				addr_encode(&ep->e_a, (void *)&sa);
-				result = connect(s->s_fd,
-						 (void *)&sa, sizeof sa);
+				result = connect(s->s_fd, (void *)&sa,
+						 addr_len(&ep->e_a,
+							  (void *)&sa));
 			}
 			if (result == 0) {
 				state = S_OPEN;
@@ -2176,7 +2548,8 @@ static int sock_init_fd(int fd, struct sock *s, struct ep *ep, uint32_t flags)
 				if (result == 0) {
 					addr_encode(&ep->e_a, (void *)&sa);
 					result = bind(fd, (void *)&sa,
-						      sizeof sa);
+						      addr_len(&ep->e_a,
+							       (void *)&sa));
 				} else
 					result = M0_ERR(-errno);
 			} else
@@ -2192,6 +2565,200 @@ static int sock_init_fd(int fd, struct sock *s, struct ep *ep, uint32_t flags)
 	return M0_RC(result);
 }
 
+/**
+ * Enables zero-copy sends on a stream socket.
+ *
+ * If the kernel does not support SO_ZEROCOPY, the socket silently falls back
+ * to copying sends.
+ */
+static void sock_zc_init(struct sock *s)
+{
+#if SOCK_HAS_ZEROCOPY
+	int flag = true;
+
+	M0_PRE(s->s_zc == NULL && s->s_fd >= 0);
+	if (!sock_zerocopy || s->s_ep->e_a.a_socktype != SOCK_STREAM ||
+	    s->s_ep->e_a.a_family == AF_UNIX)
+		return;
+	M0_ALLOC_ARR(s->s_zc, SOCK_ZC_NR);
+	if (s->s_zc == NULL)
+		return;
+	if (setsockopt(s->s_fd, SOL_SOCKET, SO_ZEROCOPY,
+		       &flag, sizeof flag) == 0)
+		s->s_flags |= ZEROCOPY;
+	else
+		m0_free0(&s->s_zc);
+#endif
+}
+
+/** Releases zero-copy send with the given sequence number. */
+static void sock_zc_release(struct sock *s, uint32_t id)
+{
+	struct buf **slot = &s->s_zc[id % SOCK_ZC_NR];
+
+	if (id - s->s_zc_head < s->s_zc_next - s->s_zc_head && *slot != NULL) {
+		M0_CNT_DEC((*slot)->b_zc);
+		*slot = NULL;
+	}
+}
+
+/** Advances the ring head past the released sends. */
+static void sock_zc_advance(struct sock *s)
+{
+	while (s->s_zc_head != s->s_zc_next &&
+	       s->s_zc[s->s_zc_head % SOCK_ZC_NR] == NULL)
+		s->s_zc_head++;
+}
+
+/**
+ * Finalises zero-copy state of a socket that is being closed.
+ *
+ * Completion notifications are not delivered for a closed socket, so all
+ * outstanding sends are released here. To guarantee that the kernel does not
+ * touch the pages of the released buffers after they are completed, the
+ * connection is aborted (SO_LINGER with zero timeout), which drops the data
+ * still queued in the socket. A completed buffer, which data might not have
+ * reached the peer, is failed.
+ */
+static void sock_zc_fini(struct sock *s)
+{
+	uint32_t id;
+
+	if (s->s_zc == NULL)
+		return;
+	sock_zc_reap(s);
+	if (s->s_zc_head != s->s_zc_next) {
+		struct linger lg = { .l_onoff = 1, .l_linger = 0 };
+
+		(void)setsockopt(s->s_fd, SOL_SOCKET, SO_LINGER,
+				 &lg, sizeof lg);
+		for (id = s->s_zc_head; id != s->s_zc_next; ++id) {
+			struct buf *buf = s->s_zc[id % SOCK_ZC_NR];
+
+			if (buf != NULL && b_tlink_is_in(buf) &&
+			    buf->b_writer.m_sm.sm_rc == 0)
+				buf->b_writer.m_sm.sm_rc = -ECONNABORTED;
+			sock_zc_release(s, id);
+		}
+	}
+	s->s_flags &= ~ZEROCOPY;
+	s->s_zc_head = s->s_zc_next = 0;
+	m0_free0(&s->s_zc);
+}
+
+/**
+ * Processes zero-copy completion notifications from the socket error queue.
+ *
+ * Each notification covers a range of send sequence numbers. If the kernel
+ * reports that it had to copy the data anyway (e.g., for a loopback
+ * connection), zero-copy is switched off for the socket: copying sends are
+ * cheaper than page pinning plus notifications.
+ */
+static void sock_zc_reap(struct sock *s)
+{
+#if SOCK_HAS_ZEROCOPY
+	char control[256];
+
+	M0_PRE(s->s_zc != NULL);
+	if (M0_FI_ENABLED("zc-hold"))
+		return; /* Leave the notifications queued. */
+	while (1) {
+		struct msghdr msg = {
+			.msg_control    = control,
+			.msg_controllen = sizeof control
+		};
+		struct cmsghdr *cm;
+
+		if (recvmsg(s->s_fd, &msg, MSG_ERRQUEUE) < 0)
+			break; /* EAGAIN: the queue is empty. */
+		for (cm = CMSG_FIRSTHDR(&msg); cm != NULL;
+		     cm = CMSG_NXTHDR(&msg, cm)) {
+			struct sock_extended_err *ee = (void *)CMSG_DATA(cm);
+			uint32_t                  nr;
+			uint32_t                  i;
+
+			if (!((cm->cmsg_level == SOL_IP &&
+			       cm->cmsg_type == IP_RECVERR) ||
+			      (cm->cmsg_level == SOL_IPV6 &&
+			       cm->cmsg_type == IPV6_RECVERR)) ||
+			    ee->ee_errno != 0 ||
+			    ee->ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+				continue;
+			/* The range is inclusive and can wrap around. */
+			nr = min32u(ee->ee_data - ee->ee_info, SOCK_ZC_NR);
+			for (i = 0; i <= nr; ++i)
+				sock_zc_release(s, ee->ee_info + i);
+			if (ee->ee_code & SO_EE_CODE_ZEROCOPY_COPIED ||
+			    M0_FI_ENABLED("zc-copied"))
+				s->s_flags &= ~ZEROCOPY;
+		}
+	}
+	sock_zc_advance(s);
+#endif
+}
+
+/**
+ * Handles EPOLLERR on a socket with zero-copy sends.
+ *
+ * Completion notifications are reported as EPOLLERR. Returns the event mask
+ * with EPOLLERR cleared, unless there is a real error on the socket.
+ */
+static uint32_t sock_zc_event(struct sock *s, uint32_t ev)
+{
+	int       err = 0;
+	socklen_t len = sizeof err;
+
+	sock_zc_reap(s);
+	if (getsockopt(s->s_fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0 &&
+	    err == 0)
+		ev &= ~EPOLLERR;
+	return ev;
+}
+
+/**
+ * Admission policy for an accepted connection.
+ *
+ * Anybody on the node can connect to an abstract unix socket. A unix peer is
+ * admitted only if it runs as the same user or as root (SO_PEERCRED, see
+ * unix(7)). Other families are admitted unconditionally.
+ */
+static int sock_peer_admit(int fd, const struct addr *a)
+{
+	struct ucred cred;
+	socklen_t    len = sizeof cred;
+
+	if (a->a_family != AF_UNIX)
+		return 0;
+	if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0)
+		return M0_ERR(-errno);
+	if (cred.uid != geteuid() && cred.uid != 0)
+		return M0_ERR_INFO(-EACCES, "pid: %i, uid: %i.",
+				   (int)cred.pid, (int)cred.uid);
+	return 0;
+}
+
+/**
+ * Binds an anonymous unix peer to the source address of its first packet.
+ *
+ * An accepted unix connection has no name (unix_decode()), so the source
+ * address in the packet header cannot be checked against the socket. Instead,
+ * the first packet names the peer and all later packets on the connection must
+ * come from the same named end-point.
+ */
+static int sock_peer_bind(struct sock *s, const struct addr *src)
+{
+	M0_PRE(addr_is_anon(&s->s_ep->e_a));
+
+	if (M0_IS0(&s->s_peer)) {
+		if (src->a_family != AF_UNIX || addr_is_anon(src))
+			return M0_ERR(-EPROTO);
+		s->s_peer = *src;
+		return 0;
+	}
+	return addr_eq(&s->s_peer, src) && s->s_peer.a_port == src->a_port ?
+		0 : M0_ERR(-EPERM);
+}
+
 /**
  * Implements a state transition in a socket state machine.
  *
@@ -2228,14 +2795,9 @@ static bool sock_event(struct sock *s, uint32_t ev)
 
 				addr_decode(&addr, (void *)&sa);
 				M0_ASSERT(addr_invariant(&addr));
-				result = ep_create(ep_ma(we),
-						   &addr, NULL, &ep) ?:
-					/*
-					 * Accept incoming connections
-					 * unconditionally. Alternatively, it
-					 * can be rejected by some admission
-					 * policy.
-					 */
+				result = sock_peer_admit(fd, &addr) ?:
+					ep_create(ep_ma(we),
+						  &addr, NULL, &ep) ?:
 					sock_init(fd, we, ep, 0);
 				if (result != 0)
 					/*
@@ -2282,6 +2844,8 @@ static bool sock_event(struct sock *s, uint32_t ev)
 		}
 		break;
 	case S_OPEN:
+		if (ev & EPOLLERR && s->s_zc != NULL)
+			ev = sock_zc_event(s, ev);
 		if (ev & EPOLLIN) {
 			/* Ran out of buffer on the receive queue. */
 			if (sock_in(s) == -ENOBUFS)
@@ -2308,7 +2872,7 @@ static int sock_ctl(struct sock *s, int op, uint32_t flags)
 
 	/* Always monitor errors. */
 	flags |= EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP;
-	result = epoll_ctl(ep_ma(s->s_ep)->t_epollfd, op, s->s_fd,
+	result = epoll_ctl(s->s_poller->p_epollfd, op, s->s_fd,
 			   &(struct epoll_event){
 				   .events = flags,
 				   .data   = { .ptr = s }});
@@ -2449,13 +3013,18 @@ static void ep_del(struct mover *w)
 /**
  * Updates end-point when a writer is added or removed.
  *
- * If there are writers, but no sockets, open a socket.
+ * If there are writers, but not enough sockets, open sockets: the first one,
+ * or parallel ones up to ma::t_sock_nr, if all the existing sockets were
+ * connected by this transfer machine. Monitor all sockets for writes.
  *
- * If there are sockets, but no writers, stop monitoring sockets for writer.
+ * If there are sockets, but no writers, stop monitoring sockets for writes.
  */
 static int ep_balance(struct ep *ep)
 {
+	struct ma   *ma     = ep_ma(ep);
 	int          result = 0;
+	uint32_t     nr     = 0;
+	uint32_t     out    = 0;
 	struct sock *s;
 
 	if (m_tlist_is_empty(&ep->e_writer)) {
@@ -2465,25 +3034,34 @@ static int ep_balance(struct ep *ep)
 		 * @todo Consider closing the sockets to this endpoint (after
 		 * some time?).
 		 */
-		s = s_tlist_head(&ep->e_sock);
-		if (s != NULL)
-			result = sock_ctl(s, EPOLL_CTL_MOD, 0);
-		M0_ASSERT(result == 0);
+		m0_tl_for(s, &ep->e_sock, s) {
+			if (s->s_flags & WRITE_POLL)
+				result = sock_ctl(s, EPOLL_CTL_MOD, 0);
+			M0_ASSERT(result == 0);
+		} m0_tl_endfor;
 	} else {
-		s = m0_tl_find(s, s, &ep->e_sock, M0_IN(s->s_sm.sm_state,
-						(S_CONNECTING, S_OPEN)));
-		if (s == NULL)
-			result = sock_init(-1, ma_src(ep_ma(ep)), ep, EPOLLOUT);
-		else {
-			/*
-			 * @todo Alternatively, more parallel sockets can be
-			 * opened.
-			 */
-			/* Make sure that at least one socket is writable. */
-			if (!(s->s_flags & WRITE_POLL))
+		m0_tl_for(s, &ep->e_sock, s) {
+			if (!M0_IN(s->s_sm.sm_state, (S_CONNECTING, S_OPEN)))
+				continue;
+			++nr;
+			if (s->s_flags & OUTGOING)
+				++out;
+			/* Make sure that every socket is writable. */
+			if (!(s->s_flags & WRITE_POLL)) {
 				result = sock_ctl(s, EPOLL_CTL_MOD, EPOLLOUT);
-			else
-				result = 0;
+				if (result != 0)
+					break;
+			}
+		} m0_tl_endfor;
+		if (result == 0 && nr == 0) {
+			result = sock_init(-1, ma_src(ma), ep, EPOLLOUT);
+			nr = out = 1;
+		}
+		/* Parallel sockets are optional, ignore failures. */
+		while (result == 0 && nr == out && nr < ma->t_sock_nr &&
+		       sock_init(-1, ma_src(ma), ep, EPOLLOUT) == 0) {
+			++nr;
+			++out;
 		}
 	}
 	return result;
@@ -2548,7 +3126,10 @@ static int addr_resolve(struct addr *addr, const char *name)
  *
  *       for example: "inet:stream:lanl.gov@23",
  *       "inet6:dgram:FE80::0202:B3FF:FE1E:8329@6663" or
- *       "unix:dgram:/tmp/socket".
+ *       "unix:stream:m0d-ios1@3001".
+ *
+ *       For the unix family, the "ipaddr" part is an end-point name of up to
+ *       16 characters, see unix_encode().
  *
  */
 static int addr_parse(struct addr *addr, const char *name)
@@ -2684,15 +3265,28 @@ static int addr_parse_native(struct addr *addr, const char *name)
 		if (port < 0 || port > USHRT_MAX)
 			return M0_ERR(-ERANGE);
 	}
-	memcpy(ip, name, min64(at - name, ARRAY_SIZE(ip) - 1));
-	result = inet_pton(f, ip, addr->a_data.v_data);
-	if (result == 0)
-		return M0_ERR(-EINVAL);
-	if (result == -1)
-		return M0_ERR(-errno);
+	if (f == AF_UNIX) {
+		/*
+		 * The name of a unix end-point is stored in a_data verbatim,
+		 * see unix_encode().
+		 */
+		if (s != SOCK_STREAM)
+			return M0_ERR(-EPROTONOSUPPORT);
+		if (at == name || at - name > ARRAY_SIZE(addr->a_data.v_data))
+			return M0_ERR(-EINVAL);
+		M0_SET0(&addr->a_data);
+		memcpy(addr->a_data.v_data, name, at - name);
+	} else {
+		memcpy(ip, name, min64(at - name, ARRAY_SIZE(ip) - 1));
+		result = inet_pton(f, ip, addr->a_data.v_data);
+		if (result == 0)
+			return M0_ERR(-EINVAL);
+		if (result == -1)
+			return M0_ERR(-errno);
+	}
 	addr->a_family   = f;
 	addr->a_socktype = s;
-	addr->a_protocol = stype[s].st_proto;
+	addr->a_protocol = f == AF_UNIX ? 0 : stype[s].st_proto;
 	addr->a_port     = port;
 	M0_POST(addr_invariant(addr));
 	return 0;
@@ -2744,6 +3338,73 @@ static void ip6_decode(struct addr *a, const struct sockaddr *sa)
 	       sizeof sin6->sin6_addr.s6_addr);
 }
 
+enum {
+	/** Length of the unix end-point name. */
+	UNIX_NAME_LEN = sizeof ((struct addr *)0)->a_data.v_data
+};
+
+/** Prefix of abstract unix socket names used by the transport. */
+static const char unix_prefix[] = "motr-sock:";
+
+/**
+ * Encodes an addr structure in a unix sockaddr.
+ *
+ * The socket is bound in the linux abstract namespace (see unix(7)), sun_path
+ * is "\0motr-sock:NAME@PORT". Abstract sockets need no file-system clean-up
+ * and disappear together with the last descriptor.
+ */
+static void unix_encode(const struct addr *a, struct sockaddr *sa)
+{
+	struct sockaddr_un *sun = (void *)sa;
+
+	M0_SET0(sun);
+	snprintf(sun->sun_path + 1, sizeof sun->sun_path - 1, "%s%.*s@%u",
+		 unix_prefix, (int)strnlen(a->a_data.v_data, UNIX_NAME_LEN),
+		 a->a_data.v_data, a->a_port);
+}
+
+/**
+ * Fills an addr struct from a unix sockaddr.
+ *
+ * The peer of an accepted connection is not bound to a name. It is given an
+ * anonymous address (empty name) with a unique port, so that each accepted
+ * connection gets its own end-point, like an ephemeral tcp port.
+ */
+static void unix_decode(struct addr *a, const struct sockaddr *sa)
+{
+	static struct m0_atomic64 anon = {};
+	const struct sockaddr_un *sun  = (void *)sa;
+	const char               *path = sun->sun_path + 1;
+	const char               *at;
+	unsigned long             port;
+	char                     *end;
+
+	if (sun->sun_path[0] == 0 &&
+	    strncmp(path, unix_prefix, strlen(unix_prefix)) == 0) {
+		path += strlen(unix_prefix);
+		at = strchr(path, '@');
+		if (at != NULL && at - path <= UNIX_NAME_LEN) {
+			port = strtoul(at + 1, &end, 10);
+			if (*end == 0 && port <= UINT32_MAX) {
+				memcpy(a->a_data.v_data, path, at - path);
+				a->a_port = port;
+				return;
+			}
+		}
+	}
+	M0_SET0(&a->a_data);
+	a->a_port = m0_atomic64_add_return(&anon, 1);
+}
+
+/** Returns the length of an abstract unix sockaddr, see unix_encode(). */
+static socklen_t unix_len(const struct sockaddr *sa)
+{
+	const struct sockaddr_un *sun = (void *)sa;
+
+	return offsetof(struct sockaddr_un, sun_path) + 1 +
+		strnlen(sun->sun_path + 1, sizeof sun->sun_path - 1);
+}
+
 /** Returns the canonical name for an addr. */
 static char *addr_print(const struct addr *a)
 {
@@ -2774,6 +3435,11 @@ static char *addr_print(const struct addr *a)
 		inet_ntop(AF_INET6, &sin->sin6_addr, name + nob, MAX_LEN - nob);
 		break;
 	}
+	case AF_UNIX:
+		snprintf(name + nob, MAX_LEN - nob, "%.*s",
+			 (int)strnlen(a->a_data.v_data, UNIX_NAME_LEN),
+			 a->a_data.v_data);
+		break;
 	default:
 		M0_IMPOSSIBLE("Wrong family: %i.", a->a_family);
 	}
@@ -2802,6 +3468,13 @@ static void addr_encode(const struct addr *addr, struct sockaddr *sa)
 	sa->sa_family = addr->a_family;
 }
 
+/** Returns the length of a sockaddr encoded by addr_encode(). */
+static socklen_t addr_len(const struct addr *addr, const struct sockaddr *sa)
+{
+	return pf[addr->a_family].f_len != NULL ?
+		pf[addr->a_family].f_len(sa) : sizeof(struct sockaddr_storage);
+}
+
 /** Returns true iff 2 addresses are equal. */
 static bool addr_eq(const struct addr *a0, const struct addr *a1)
 {
@@ -2812,6 +3485,12 @@ static bool addr_eq(const struct addr *a0, const struct addr *a1)
 		       ARRAY_SIZE(a0->a_data.v_data)) == 0;
 }
 
+/** Returns true iff the addr is an anonymous unix peer, see unix_decode(). */
+static bool addr_is_anon(const struct addr *a)
+{
+	return a->a_family == AF_UNIX && M0_IS0(&a->a_data);
+}
+
 /** Returns true iff an end-point has a given addr. */
 static bool ep_eq(const struct ep *ep, const struct addr *a0)
 {
@@ -2836,7 +3515,8 @@ static int buf_accept(struct buf *buf, struct mover *m)
 {
 	struct packet *p      = &m->m_pk;
 	struct bdesc  *src    = &p->p_src;
-	m0_bcount_t    length = m0_vec_count(&buf->b_buf->nb_buffer.ov_vec);
+	m0_bcount_t    length = m0_vec_count(&buf->b_buf->nb_buffer.ov_vec) -
+				buf->b_offset;
 	int            result = 0;
 
 	M0_PRE(mover_invariant(m) && mover_is_reader(m));
@@ -2882,7 +3562,8 @@ static int buf_accept(struct buf *buf, struct mover *m)
  */
 static void buf_fini(struct buf *buf)
 {
-	mover_fini(&buf->b_writer);
+	M0_PRE(buf->b_zc == 0 && !buf->b_upcall);
+	buf_writers_fini(buf);
 	b_tlink_fini(buf);
 	if (buf->b_done.b_words > 0)
 		m0_bitmap_fini(&buf->b_done);
@@ -2896,6 +3577,58 @@ static void buf_fini(struct buf *buf)
 	buf->b_writer.m_sm.sm_rc = 0;
 }
 
+/**
+ * Stripes a M0_NET_QT_ACTIVE_BULK_SEND buffer over parallel sockets.
+ *
+ * Adds to the end-point up to ma::t_sock_nr - 1 additional writers, so that at
+ * least SOCK_STRIPE_MIN bytes are sent by each writer. Lanes are an
+ * optimisation: if they cannot be allocated, buf::b_writer sends the entire
+ * buffer.
+ */
+static int buf_lanes_add(struct buf *buf, struct ep *ep)
+{
+	struct ma  *ma  = buf_ma(buf);
+	m0_bcount_t len = buf->b_buf->nb_length;
+	uint32_t    nr;
+	int         result = 0;
+	int         i;
+
+	nr = min64u(ma->t_sock_nr, max64u(len / SOCK_STRIPE_MIN, 1));
+	if (nr > 1) {
+		M0_ALLOC_ARR(buf->b_lane, nr - 1);
+		if (buf->b_lane == NULL)
+			return 0;
+		buf->b_lane_nr = nr;
+		for (i = 0; i < nr - 1; ++i) {
+			mover_init(&buf->b_lane[i], ma, &writer_op);
+			buf->b_lane[i].m_buf = buf;
+		}
+		for (i = 0; i < nr - 1 && result == 0; ++i) {
+			result = ep_add(ep, &buf->b_lane[i]);
+			++buf->b_busy;
+		}
+	}
+	return result;
+}
+
+/** Finalises the writers of the buffer. */
+static void buf_writers_fini(struct buf *buf)
+{
+	int i;
+
+	mover_fini(&buf->b_writer);
+	if (buf->b_lane != NULL) {
+		for (i = 0; i < buf->b_lane_nr - 1; ++i)
+			mover_fini(&buf->b_lane[i]);
+		m0_free0(&buf->b_lane);
+	}
+	buf->b_lane_nr = 0;
+	buf->b_busy    = 0;
+	buf->b_pksize  = 0;
+	buf->b_pknr    = 0;
+	buf->b_pknext  = 0;
+}
+
 /** Completes the buffer operation. */
 static void buf_done(struct buf *buf, int rc)
 {
@@ -2913,18 +3646,58 @@ static void buf_done(struct buf *buf, int rc)
 	 */
 	if (!b_tlink_is_in(buf)) {
 		/* Try to finalise. */
-		if (m0_thread_self() == &ma->t_poller)
+		if (poller_self(ma) != NULL && !buf_is_pinned(buf))
 			buf_complete(buf);
 		else
-			/* Otherwise, postpone finalisation to ma_buf_done(). */
+			/*
+			 * Otherwise, postpone finalisation to ma_buf_done().
+			 * A pinned buffer is completed after it is unpinned
+			 * (see buf_is_pinned()).
+			 */
 			b_tlist_add_tail(&ma->t_done, buf);
 	}
 }
 
-/** Invokes completion call-back (releasing tm lock). */
+/**
+ * Returns true iff the buffer cannot be completed right now:
+ *
+ *     - io to or from the buffer is in progress in another poller (pk_io());
+ *
+ *     - the buffer pages are still referenced by zero-copy sends, not yet
+ *       released by the kernel (sock_zc_reap());
+ *
+ *     - the call-back for the previous message received in the buffer is
+ *       still running (buf_complete()).
+ */
+static bool buf_is_pinned(const struct buf *buf)
+{
+	return buf->b_io > 0 || buf->b_zc > 0 || buf->b_upcall;
+}
+
+/**
+ * Records the result of a buffer operation, leaving the completion to
+ * ma_buf_done().
+ */
+static void buf_postpone(struct buf *buf, int rc)
+{
+	M0_PRE(ma_is_locked(buf_ma(buf)) && buf_invariant(buf));
+	if (buf->b_writer.m_sm.sm_rc == 0)
+		buf->b_writer.m_sm.sm_rc = rc;
+	if (!b_tlink_is_in(buf))
+		b_tlist_add_tail(&buf_ma(buf)->t_done, buf);
+}
+
+/**
+ * Invokes completion call-back (releasing tm lock).
+ *
+ * A M0_NET_QT_MSG_RECV buffer that has room for more messages is not dequeued:
+ * the event is posted with M0_NET_BUF_RETAIN flag and the buffer is prepared to
+ * receive the next message after the current one (buf_recv_next()).
+ */
 static void buf_complete(struct buf *buf)
 {
-	struct ma *ma  = buf_ma(buf);
+	struct ma *ma     = buf_ma(buf);
+	bool       retain = false;
 
 	struct m0_net_buffer *nb = buf->b_buf;
 	struct m0_net_buffer_event ev = {
@@ -2942,29 +3715,65 @@ static void buf_complete(struct buf *buf)
 			ev.nbe_ep = &buf->b_other->e_ep;
 			EP_GET(buf->b_other, find);
 		}
-		ev.nbe_offset = 0; /* Starting offset not supported. */
+		ev.nbe_offset = buf->b_offset;
+		retain = ev.nbe_status == 0 && buf_recv_next(buf);
 	}
 	ma->t_ma->ntm_callback_counter++;
 	/*printf("DONE: %p[%i] %" PRIi64 " %i\n", buf,
 	  buf->b_buf != NULL ? buf->b_buf->nb_qtype : -1,
 	  buf->b_length, ev.nbe_status); */
 	TLOG(B_F" nb: %p %i", B_P(buf), buf->b_buf, ev.nbe_status);
-	/*
-	 * It's ok to clear buf state, because sock doesn't support
-	 * M0_NET_BUF_RETAIN flag and the buffer will be unqueued
-	 * unconditionally.
-	 */
-	buf_fini(buf);
+	if (retain) {
+		nb->nb_flags |= M0_NET_BUF_RETAIN;
+		buf->b_upcall = true;
+	} else
+		/*
+		 * It's ok to clear buf state, because the buffer will be
+		 * unqueued.
+		 */
+		buf_fini(buf);
 	M0_ASSERT(ma_invariant(ma));
 	ma_unlock(ma);
 	m0_net_buffer_event_post(&ev);
 	ma_lock(ma);
+	if (retain) /* The buffer is still queued, hence, still allocated. */
+		buf->b_upcall = false;
 	M0_ASSERT(ma_invariant(ma));
 	M0_ASSERT(M0_IN(ma->t_ma->ntm_state, (M0_NET_TM_STARTED,
 					      M0_NET_TM_STOPPING)));
 	ma->t_ma->ntm_callback_counter--;
 }
 
+/**
+ * Prepares a M0_NET_QT_MSG_RECV buffer to receive the next message.
+ *
+ * The next message is placed after the current one. Returns false if the
+ * buffer is full (as defined by m0_net_buffer::nb_min_receive_size and
+ * m0_net_buffer::nb_max_receive_msgs) and has to be dequeued.
+ */
+static bool buf_recv_next(struct buf *buf)
+{
+	struct m0_net_buffer *nb   = buf->b_buf;
+	m0_bcount_t           size = m0_vec_count(&nb->nb_buffer.ov_vec);
+	m0_bindex_t           next = m0_align(buf->b_offset + buf->b_length, 8);
+
+	M0_PRE(nb->nb_qtype == M0_NET_QT_MSG_RECV);
+	if (nb->nb_msgs_received + 1 >= nb->nb_max_receive_msgs ||
+	    next >= size ||
+	    size - next < max64u(nb->nb_min_receive_size, SOCK_RECV_MIN))
+		return false;
+	if (buf->b_done.b_words != NULL)
+		m0_bitmap_fini(&buf->b_done);
+	if (buf->b_other != NULL) {
+		EP_PUT(buf->b_other, buf);
+		buf->b_other = NULL;
+	}
+	M0_SET0(&buf->b_peer);
+	buf->b_offset = next;
+	buf->b_length = 0;
+	return true;
+}
+
 /** Creates the descriptor for a (passive) network buffer. */
 static int bdesc_create(struct addr *addr, struct buf *buf,
 			struct m0_net_buf_desc *out)
@@ -3196,7 +4005,8 @@ static int pk_iov_prep(struct mover *m, struct iovec *iv, int nr,
 	if (tgt == sizeof m->m_pkbuf) /* Only header is ioed. */
 		return idx;
 	m0_bufvec_cursor_init(&cur, bv);
-	m0_bufvec_cursor_move(&cur, m->m_pk.p_offset + pk_dnob(m));
+	m0_bufvec_cursor_move(&cur, (m->m_buf != NULL ? m->m_buf->b_offset : 0) +
+			      m->m_pk.p_offset + pk_dnob(m));
 	for (; idx < nr && !m0_bufvec_cursor_move(&cur, 0); ++idx) {
 		m0_bcount_t frag = m0_bufvec_cursor_step(&cur);
 
@@ -3218,21 +4028,86 @@ static int pk_iov_prep(struct mover *m, struct iovec *iv, int nr,
  * "bv" is a data buffer for payload.
  *
  * "tgt" is how many bytes (both header and payload) to try to io.
+ *
+ * When called by a poller, the tm lock is released for the duration of the
+ * system call, so that pollers can move data for different sockets in
+ * parallel. This is safe, because the socket and its locked mover are only
+ * accessed by the poller of the socket, and the buffer is not completed while
+ * buf::b_io is non-zero.
+ *
+ * Writes use sendmsg(2). If zero-copy is enabled on the socket (sock_zc_init())
+ * and enough payload remains, the payload is sent with MSG_ZEROCOPY: the kernel
+ * transmits directly from the buffer pages, which stay referenced until the
+ * completion notification arrives (sock_zc_reap()). The header is always
+ * copied, because mover::m_pkbuf is re-used for the next packet.
  */
 static int pk_io(struct mover *m, struct sock *s, uint64_t flag,
 		 struct m0_bufvec *bv, m0_bcount_t tgt)
 {
-	struct iovec iv[256] = {};
-	int          count;
-	int          nr;
-	int          rc;
+	struct ma     *ma  = ep_ma(s->s_ep);
+	struct buf    *buf = m->m_buf;
+	struct poller *p   = poller_self(ma);
+	struct iovec   iv[256] = {};
+	int            count;
+	int            nr;
+	int            rc;
+	int            err;
+	bool           zc = false;
 
 	M0_PRE(M0_IN(flag, (HAS_READ, HAS_WRITE)));
+	M0_PRE(ergo(p != NULL, p == s->s_poller));
+	if (flag == HAS_WRITE && s->s_flags & ZEROCOPY && buf != NULL &&
+	    bv == NULL &&
+	    tgt - max64u(m->m_nob, sizeof m->m_pkbuf) >= SOCK_ZC_MIN &&
+	    s->s_zc_next - s->s_zc_head < SOCK_ZC_NR) {
+		if (m->m_nob < sizeof m->m_pkbuf)
+			tgt = sizeof m->m_pkbuf; /* Copy the header first. */
+		else
+			zc = true;
+	}
 	nr = pk_iov_prep(m, iv, ARRAY_SIZE(iv),
-			 bv ?: m->m_buf != NULL ?
-			 &m->m_buf->b_buf->nb_buffer : NULL, tgt, &count);
+			 bv ?: buf != NULL ? &buf->b_buf->nb_buffer : NULL,
+			 tgt, &count);
 	s->s_flags &= ~flag;
-	rc = (flag == HAS_READ ? readv : writev)(s->s_fd, iv, nr);
+	if (p != NULL) {
+		if (buf != NULL)
+			++buf->b_io;
+		ma_unlock(ma);
+	}
+	if (flag == HAS_READ)
+		rc = readv(s->s_fd, iv, nr);
+	else {
+		struct msghdr msg = { .msg_iov = iv, .msg_iovlen = nr };
+
+		if (M0_FI_ENABLED("write-fail")) {
+			rc = -1;
+			errno = ECONNRESET;
+		} else if (zc && M0_FI_ENABLED("zc-enobufs")) {
+			rc = -1;
+			errno = ENOBUFS;
+		} else
+			rc = sendmsg(s->s_fd, &msg, MSG_NOSIGNAL |
+				     (zc ? SOCK_MSG_ZEROCOPY : 0));
+		if (rc < 0 && zc && errno == ENOBUFS) {
+			/* Out of optmem for notifications: copy this time. */
+			zc = false;
+			rc = sendmsg(s->s_fd, &msg, MSG_NOSIGNAL);
+		}
+	}
+	err = errno;
+	if (p != NULL) {
+		if (rc > 0)
+			m0_addb2_counter_mod(&p->p_io, rc);
+		ma_lock(ma);
+		if (buf != NULL)
+			M0_CNT_DEC(buf->b_io);
+	}
+	if (zc && rc > 0) {
+		/* The kernel numbers successful zero-copy sends from 0. */
+		s->s_zc[s->s_zc_next++ % SOCK_ZC_NR] = buf;
+		++buf->b_zc;
+	}
+	errno = err;
 	M0_LOG(M0_DEBUG, "flag: %" PRIi64 ", rc: %i, idx: %i, errno: %i.",
 	       flag, rc, nr, errno);
 	if (rc >= 0) {
@@ -3316,7 +4191,11 @@ static int pk_header_done(struct mover *m)
 		return M0_ERR(-EPROTO);
 	if (!ep_eq(ma_src(ma), &p->p_dst.bd_addr))
 		return M0_ERR(-EPROTO);
-	if (!addr_eq(&m->m_sock->s_ep->e_a, &p->p_src.bd_addr))
+	if (addr_is_anon(&m->m_sock->s_ep->e_a)) {
+		result = sock_peer_bind(m->m_sock, &p->p_src.bd_addr);
+		if (result != 0)
+			return M0_ERR(result);
+	} else if (!addr_eq(&m->m_sock->s_ep->e_a, &p->p_src.bd_addr))
 		return M0_ERR(-EPROTO);
 	hassrc = !M0_IS0(&p->p_src.bd_cookie);
 	hasdst = !M0_IS0(&p->p_dst.bd_cookie);
@@ -3608,15 +4487,29 @@ static void dgram_error(struct mover *m, struct sock *s)
 {
 }
 
-/** Initialises a writer. */
+/**
+ * Initialises a writer.
+ *
+ * The first writer of the buffer to get here splits the buffer into packets:
+ * packet size is limited by the socket type and, for a striped buffer, by the
+ * number of writers (buf::b_lane_nr).
+ */
 static int writer_idle(struct mover *w, struct sock *s)
 {
-	m0_bcount_t pksize = pk_size(w, s);
-	m0_bcount_t size   = w->m_buf->b_buf->nb_length;
+	struct buf *buf  = w->m_buf;
+	m0_bcount_t size = buf->b_buf->nb_length;
 
 	M0_ASSERT(size > 0);
+	if (buf->b_pknr == 0) {
+		buf->b_pksize = min64u(pk_size(w, s),
+				       (size + buf->b_lane_nr - 1) /
+				       buf->b_lane_nr);
+		buf->b_pknr   = (size + buf->b_pksize - 1) / buf->b_pksize;
+	}
+	if (buf->b_pknext == buf->b_pknr)
+		return R_DONE; /* Other writers took all the packets. */
 	pk_header_init(w, s);
-	w->m_pk.p_nr = (size + pksize - 1) / pksize;
+	w->m_pk.p_nr = buf->b_pknr;
 	m0_format_header_pack(&w->m_pk.p_header, &put_tag);
 	return R_PK;
 }
@@ -3624,15 +4517,18 @@ static int writer_idle(struct mover *w, struct sock *s)
 /**
  * Starts a packet write-out.
  *
- * Select the packet size, lock the writer to the socket.
+ * Claim the next unsent packet of the buffer, lock the writer to the socket.
  */
 static int writer_pk(struct mover *w, struct sock *s)
 {
-	m0_bcount_t pksize = pk_size(w, s);
-	m0_bcount_t size   = w->m_buf->b_buf->nb_length;
+	struct buf *buf  = w->m_buf;
+	m0_bcount_t size = buf->b_buf->nb_length;
 
+	M0_PRE(buf->b_pknext < buf->b_pknr);
 	w->m_nob = 0;
-	w->m_pk.p_size = min64u(pksize, size - pk_dnob(w));
+	w->m_pk.p_idx    = buf->b_pknext++;
+	w->m_pk.p_offset = w->m_pk.p_idx * buf->b_pksize;
+	w->m_pk.p_size   = min64u(buf->b_pksize, size - w->m_pk.p_offset);
 	pk_encode(w);
 	w->m_sock = s; /* Lock the socket and the writer together. */
 	return R_HEADER;
@@ -3652,18 +4548,15 @@ static int writer_write(struct mover *w, struct sock *s)
 /**
  * Completes packet write-out.
  *
- * Unlock the writer from the socket. Is all packets for the buffer have been
- * written, complete the writer, otherwise switch to the next packet.
+ * Unlock the writer from the socket. If all packets for the buffer have been
+ * claimed, complete the writer, otherwise switch to the next packet.
  */
 static int writer_pk_done(struct mover *w, struct sock *s)
 {
+	struct buf *buf = w->m_buf;
+
 	w->m_sock = NULL;
-	if (++w->m_pk.p_idx == w->m_pk.p_nr)
-		return R_DONE;
-	else {
-		w->m_pk.p_offset += w->m_pk.p_size;
-		return R_PK;
-	}
+	return buf->b_pknext == buf->b_pknr ? R_DONE : R_PK;
 }
 
 /** Handles R_DONE state in a writer. */
@@ -3677,12 +4570,23 @@ static void writer_done(struct mover *w, struct sock *s)
  *
  * This handles both normal (rc == 0) and error cases.
  *
- * Remove the writer from the socket and complete the buffer.
+ * Remove the writer from the socket. Complete the buffer when its last writer
+ * is done. On error, other writers of the buffer stop after their current
+ * packets and the first error is returned.
  */
 static void writer_error(struct mover *w, struct sock *s, int rc)
 {
+	struct buf *buf = w->m_buf;
+
 	ep_del(w);
-	buf_done(w->m_buf, rc);
+	if (rc != 0) {
+		buf->b_pknext = buf->b_pknr;
+		if (buf->b_writer.m_sm.sm_rc == 0)
+			buf->b_writer.m_sm.sm_rc = rc;
+	}
+	M0_CNT_DEC(buf->b_busy);
+	if (buf->b_busy == 0)
+		buf_done(buf, rc);
 }
 
 /** Starts processing of a GET packet. */
@@ -3910,7 +4814,7 @@ static const struct m0_net_xprt_ops xprt_ops = {
 	.xo_rpc_max_seg_size            = &get_rpc_max_seg_size,
 	.xo_rpc_max_segs_nr             = &get_rpc_max_segs_nr,
 	.xo_rpc_max_msg_size            = default_xo_rpc_max_msg_size,
-	.xo_rpc_max_recv_msgs           = default_xo_rpc_max_recv_msgs,
+	.xo_rpc_max_recv_msgs           = &get_rpc_max_recv_msgs,
 
 };
 
@@ -3930,9 +4834,29 @@ const struct m0_net_xprt m0_net_sock_xprt = {
 };
 M0_EXPORTED(m0_net_sock_xprt);
 
+M0_INTERNAL void m0_net_sock_ep_sockets_set(uint32_t nr)
+{
+	M0_PRE(nr > 0);
+	sock_ep_nr = min32u(nr, SOCK_EP_MAX);
+}
+
+M0_INTERNAL void m0_net_sock_pollers_set(uint32_t nr)
+{
+	M0_PRE(nr > 0);
+	sock_poller_nr = min32u(nr, SOCK_POLLER_MAX);
+}
+
+M0_INTERNAL void m0_net_sock_zerocopy_set(bool on)
+{
+	sock_zerocopy = on;
+}
+
 M0_INTERNAL int m0_net_sock_mod_init(void)
 {
-	int result;
+	const char *nr      = getenv("M0_NET_SOCK_EP_SOCKETS");
+	const char *pollers = getenv("M0_NET_SOCK_POLLERS");
+	const char *zc      = getenv("M0_NET_SOCK_ZEROCOPY");
+	int         result;
 
 	if (MOCK_LNET) {
 		m0_net_xprt_register(&m0_net_lnet_xprt);
@@ -3943,11 +4867,17 @@ M0_INTERNAL int m0_net_sock_mod_init(void)
 		if (m0_streq(M0_DEFAULT_NETWORK, "SOCK"))
 			m0_net_xprt_default_set(&m0_net_sock_xprt);
 	}
+	if (nr != NULL && atoi(nr) > 0)
+		m0_net_sock_ep_sockets_set(atoi(nr));
+	if (pollers != NULL && atoi(pollers) > 0)
+		m0_net_sock_pollers_set(atoi(pollers));
+	if (zc != NULL)
+		m0_net_sock_zerocopy_set(atoi(zc) != 0);
 	/*
 	 * Ignore SIGPIPE that a write to socket gets when RST is received.
 	 *
-	 * A more elegant approach is to use sendmsg(2) with MSG_NOSIGNAL flag
-	 * instead of writev(2).
+	 * Writes use sendmsg(2) with MSG_NOSIGNAL (pk_io()), but keep the
+	 * handler for other socket writes that might be added.
 	 */
 	result = sigaction(SIGPIPE,
 			   &(struct sigaction){ .sa_handler = SIG_IGN }, NULL);
@@ -25,8 +25,38 @@
 #ifndef __MOTR_NET_SOCK_SOCK_H__
 #define __MOTR_NET_SOCK_SOCK_H__
 
+#include "lib/types.h"                     /* uint32_t */
+
 #ifndef __KERNEL__
 extern const struct m0_net_xprt m0_net_sock_xprt;
+
+/**
+ * Sets the number of parallel sockets opened to a remote end-point by transfer
+ * machines initialised after the call.
+ *
+ * The default is 1, or the value of M0_NET_SOCK_EP_SOCKETS environment
+ * variable at module initialisation. The value is capped by an internal
+ * maximum.
+ */
+M0_INTERNAL void m0_net_sock_ep_sockets_set(uint32_t nr);
+
+/**
+ * Sets the number of poller threads of transfer machines initialised after
+ * the call. Sockets of a transfer machine are distributed across its pollers.
+ *
+ * The default is 1, or the value of M0_NET_SOCK_POLLERS environment variable
+ * at module initialisation. The value is capped by an internal maximum.
+ */
+M0_INTERNAL void m0_net_sock_pollers_set(uint32_t nr);
+
+/**
+ * Enables or disables MSG_ZEROCOPY sends of large payloads on stream sockets
+ * opened after the call.
+ *
+ * Enabled by default where the kernel supports it, unless
+ * M0_NET_SOCK_ZEROCOPY=0 is set in the environment at module initialisation.
+ */
+M0_INTERNAL void m0_net_sock_zerocopy_set(bool on);
 #endif
 /**
  * @defgroup netsock
@@ -0,0 +1,755 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2021 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include "net/sock/sock.c"         /* to access internal structures */
+
+#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_UT
+#include "lib/trace.h"
+
+#include "lib/semaphore.h"
+#include "lib/finject.h"
+#include "ut/ut.h"
+
+/*
+ * Transfers between transfer machines of the sock transport in the same
+ * process.
+ *
+ * Transport parameters are set through m0_net_sock_*_set() and the transfer
+ * machines use m0_net_sock_xprt. The internal structures of sock.c are only
+ * inspected.
+ */
+
+enum {
+	SU_BUF_NR  = 4,
+	SU_SEG     = 64 * 1024,
+	/* Seconds to wait for a buffer completion. */
+	SU_TIMEOUT = 10
+};
+
+struct su_buf {
+	struct m0_net_buffer     b_nb;
+	/* Upped for each completion event of the buffer. */
+	struct m0_semaphore      b_ev;
+	/* Parameters of the last event. */
+	int32_t                  b_status;
+	m0_bcount_t              b_length;
+	m0_bindex_t              b_offset;
+	/* The buffer stayed queued after the event (M0_NET_BUF_RETAIN). */
+	bool                     b_retained;
+	/* Sender of the last received message, with a reference. */
+	struct m0_net_end_point *b_ep;
+};
+
+struct su_tm {
+	struct m0_net_domain      t_dom;
+	struct m0_net_transfer_mc t_tm;
+	struct m0_clink           t_clink;
+	struct su_buf             t_buf[SU_BUF_NR];
+};
+
+static void su_tm_event(const struct m0_net_tm_event *ev)
+{
+}
+
+static const struct m0_net_tm_callbacks su_tm_cb = {
+	.ntc_event_cb = &su_tm_event
+};
+
+static void su_buf_event(const struct m0_net_buffer_event *ev)
+{
+	struct su_buf *b = container_of(ev->nbe_buffer, struct su_buf, b_nb);
+
+	b->b_status   = ev->nbe_status;
+	b->b_length   = ev->nbe_length;
+	b->b_offset   = ev->nbe_offset;
+	b->b_retained = ev->nbe_buffer->nb_flags & M0_NET_BUF_QUEUED;
+	if (ev->nbe_buffer->nb_qtype == M0_NET_QT_MSG_RECV &&
+	    ev->nbe_status == 0 && b->b_ep == NULL) {
+		b->b_ep = ev->nbe_ep;
+		m0_net_end_point_get(b->b_ep);
+	}
+	m0_semaphore_up(&b->b_ev);
+}
+
+static const struct m0_net_buffer_callbacks su_buf_cb = {
+	.nbc_cb = {
+		[M0_NET_QT_MSG_RECV]          = &su_buf_event,
+		[M0_NET_QT_MSG_SEND]          = &su_buf_event,
+		[M0_NET_QT_PASSIVE_BULK_RECV] = &su_buf_event,
+		[M0_NET_QT_PASSIVE_BULK_SEND] = &su_buf_event,
+		[M0_NET_QT_ACTIVE_BULK_RECV]  = &su_buf_event,
+		[M0_NET_QT_ACTIVE_BULK_SEND]  = &su_buf_event
+	}
+};
+
+static void su_tm_start(struct su_tm *t, const char *addr)
+{
+	int rc;
+
+	M0_SET0(t);
+	rc = m0_net_domain_init(&t->t_dom, &m0_net_sock_xprt);
+	M0_UT_ASSERT(rc == 0);
+	t->t_tm.ntm_callbacks = &su_tm_cb;
+	rc = m0_net_tm_init(&t->t_tm, &t->t_dom);
+	M0_UT_ASSERT(rc == 0);
+	m0_clink_init(&t->t_clink, NULL);
+	m0_clink_add_lock(&t->t_tm.ntm_chan, &t->t_clink);
+	rc = m0_net_tm_start(&t->t_tm, addr);
+	M0_UT_ASSERT(rc == 0);
+	while (t->t_tm.ntm_state == M0_NET_TM_STARTING)
+		m0_chan_wait(&t->t_clink);
+	m0_clink_del_lock(&t->t_clink);
+	M0_UT_ASSERT(t->t_tm.ntm_state == M0_NET_TM_STARTED);
+}
+
+static void su_tm_stop(struct su_tm *t)
+{
+	struct su_buf *b;
+	int            rc;
+	int            i;
+
+	for (i = 0; i < ARRAY_SIZE(t->t_buf); ++i) {
+		b = &t->t_buf[i];
+		if (b->b_ep != NULL) {
+			m0_net_end_point_put(b->b_ep);
+			b->b_ep = NULL;
+		}
+	}
+	m0_clink_add_lock(&t->t_tm.ntm_chan, &t->t_clink);
+	rc = m0_net_tm_stop(&t->t_tm, true);
+	M0_UT_ASSERT(rc == 0);
+	while (t->t_tm.ntm_state != M0_NET_TM_STOPPED)
+		m0_chan_wait(&t->t_clink);
+	m0_clink_del_lock(&t->t_clink);
+	m0_clink_fini(&t->t_clink);
+	m0_net_tm_fini(&t->t_tm);
+	for (i = 0; i < ARRAY_SIZE(t->t_buf); ++i) {
+		b = &t->t_buf[i];
+		if (b->b_nb.nb_buffer.ov_vec.v_nr == 0)
+			continue;
+		m0_net_buffer_deregister(&b->b_nb, &t->t_dom);
+		m0_bufvec_free(&b->b_nb.nb_buffer);
+		m0_semaphore_fini(&b->b_ev);
+	}
+	m0_net_domain_fini(&t->t_dom);
+}
+
+/* Allocates and registers the idx-th buffer of the transfer machine. */
+static struct su_buf *su_buf_init(struct su_tm *t, int idx, m0_bcount_t size)
+{
+	struct su_buf *b = &t->t_buf[idx];
+	m0_bcount_t    seg = min64u(size, SU_SEG);
+	int            rc;
+
+	M0_PRE(size % seg == 0);
+	rc = m0_bufvec_alloc(&b->b_nb.nb_buffer, size / seg, seg);
+	M0_UT_ASSERT(rc == 0);
+	rc = m0_net_buffer_register(&b->b_nb, &t->t_dom);
+	M0_UT_ASSERT(rc == 0);
+	b->b_nb.nb_callbacks = &su_buf_cb;
+	m0_semaphore_init(&b->b_ev, 0);
+	return b;
+}
+
+/* Waits for the next completion event of the buffer. */
+static void su_wait(struct su_buf *b)
+{
+	M0_UT_ASSERT(m0_semaphore_timeddown(&b->b_ev,
+					    m0_time_from_now(SU_TIMEOUT, 0)));
+}
+
+/* Fills (or checks) "len" bytes of the buffer at "off" with a pattern. */
+static bool su_pattern(struct su_buf *b, m0_bindex_t off, m0_bcount_t len,
+		       uint8_t seed, bool check)
+{
+	struct m0_bufvec_cursor cur;
+	m0_bcount_t             i = 0;
+	bool                    match = true;
+
+	m0_bufvec_cursor_init(&cur, &b->b_nb.nb_buffer);
+	m0_bufvec_cursor_move(&cur, off);
+	while (i < len) {
+		uint8_t    *p    = m0_bufvec_cursor_addr(&cur);
+		m0_bcount_t step = min64u(m0_bufvec_cursor_step(&cur), len - i);
+		m0_bcount_t j;
+
+		for (j = 0; j < step; ++j, ++i) {
+			if (!check)
+				p[j] = seed + i;
+			else if (p[j] != (uint8_t)(seed + i))
+				match = false;
+		}
+		m0_bufvec_cursor_move(&cur, step);
+	}
+	return match;
+}
+
+static void su_add(struct su_tm *t, struct su_buf *b,
+		   enum m0_net_queue_type qt, m0_bcount_t len)
+{
+	int rc;
+
+	b->b_nb.nb_qtype   = qt;
+	b->b_nb.nb_length  = len;
+	b->b_nb.nb_offset  = 0;
+	b->b_nb.nb_timeout = M0_TIME_NEVER;
+	rc = m0_net_buffer_add(&b->b_nb, &t->t_tm);
+	M0_UT_ASSERT(rc == 0);
+}
+
+static void su_recv_add(struct su_tm *t, struct su_buf *b,
+			m0_bcount_t min_size, uint32_t max_msgs)
+{
+	b->b_nb.nb_ep               = NULL;
+	b->b_nb.nb_min_receive_size = min_size;
+	b->b_nb.nb_max_receive_msgs = max_msgs;
+	su_add(t, b, M0_NET_QT_MSG_RECV, 0);
+}
+
+/* Sends a message of "len" bytes to the end-point and waits for completion. */
+static void su_send(struct su_tm *t, struct su_buf *b,
+		    struct m0_net_end_point *ep, m0_bcount_t len, uint8_t seed)
+{
+	su_pattern(b, 0, len, seed, false);
+	b->b_nb.nb_ep = ep;
+	su_add(t, b, M0_NET_QT_MSG_SEND, len);
+	su_wait(b);
+	M0_UT_ASSERT(b->b_status == 0);
+}
+
+static void su_send_to(struct su_tm *t, struct su_buf *b, const char *addr,
+		       m0_bcount_t len, uint8_t seed)
+{
+	struct m0_net_end_point *ep;
+	int                      rc;
+
+	rc = m0_net_end_point_create(&ep, &t->t_tm, addr);
+	M0_UT_ASSERT(rc == 0);
+	su_send(t, b, ep, len, seed);
+	m0_net_end_point_put(ep);
+}
+
+/* Waits for a message received at offset "off" and checks its contents. */
+static void su_recv_check(struct su_buf *b, m0_bindex_t off, m0_bcount_t len,
+			  uint8_t seed)
+{
+	su_wait(b);
+	M0_UT_ASSERT(b->b_status == 0);
+	M0_UT_ASSERT(b->b_offset == off);
+	M0_UT_ASSERT(b->b_length == len);
+	M0_UT_ASSERT(su_pattern(b, off, len, seed, true));
+}
+
+/**
+ * Starts a bulk transfer of "len" bytes between an active buffer of "at" and a
+ * passive buffer of "pt": from the active buffer to the passive one if "push",
+ * in the opposite direction otherwise.
+ *
+ * Returns the completion status of the active buffer. On success the passive
+ * buffer is completed too and the data are checked.
+ */
+static int su_bulk(struct su_tm *at, struct su_buf *ab,
+		   struct su_tm *pt, struct su_buf *pb,
+		   m0_bcount_t len, uint8_t seed, bool push)
+{
+	struct su_buf *src = push ? ab : pb;
+	struct su_buf *dst = push ? pb : ab;
+	int            rc;
+
+	su_pattern(src, 0, len, seed, false);
+	su_add(pt, pb, push ? M0_NET_QT_PASSIVE_BULK_RECV :
+	       M0_NET_QT_PASSIVE_BULK_SEND, push ? 0 : len);
+	rc = m0_net_desc_copy(&pb->b_nb.nb_desc, &ab->b_nb.nb_desc);
+	M0_UT_ASSERT(rc == 0);
+	su_add(at, ab, push ? M0_NET_QT_ACTIVE_BULK_SEND :
+	       M0_NET_QT_ACTIVE_BULK_RECV, len);
+	su_wait(ab);
+	if (ab->b_status == 0) {
+		su_wait(pb);
+		M0_UT_ASSERT(pb->b_status == 0);
+		M0_UT_ASSERT(dst->b_length == len);
+		M0_UT_ASSERT(su_pattern(dst, 0, len, seed, true));
+	}
+	m0_net_desc_free(&ab->b_nb.nb_desc);
+	m0_net_desc_free(&pb->b_nb.nb_desc);
+	return ab->b_status;
+}
+
+/*
+ * Returns the number of pollers monitoring the sockets connected to the peers
+ * of the transfer machine and the number of these sockets in *sock_nr.
+ */
+static uint32_t su_pollers_used(struct su_tm *t, uint32_t *sock_nr)
+{
+	struct m0_net_transfer_mc *tm   = &t->t_tm;
+	uint64_t                   used = 0;
+	struct m0_net_end_point   *net;
+	struct sock               *sock;
+
+	*sock_nr = 0;
+	m0_mutex_lock(&tm->ntm_mutex);
+	m0_tl_for(m0_nep, &tm->ntm_end_points, net) {
+		if (net == tm->ntm_ep) /* Skip the listening socket. */
+			continue;
+		m0_tl_for(s, &ep_net(net)->e_sock, sock) {
+			used |= M0_BITS(sock->s_poller->p_idx);
+			++*sock_nr;
+		} m0_tl_endfor;
+	} m0_tl_endfor;
+	m0_mutex_unlock(&tm->ntm_mutex);
+	return m0_no_of_bits_set(used);
+}
+
+/*
+ * Returns the number of sockets connected or connecting from the transfer
+ * machine to "addr" and the number of outgoing ones among them in *out.
+ */
+static uint32_t su_ep_sockets(struct su_tm *t, const char *addr, uint32_t *out)
+{
+	struct m0_net_end_point *net;
+	struct sock             *sock;
+	uint32_t                 nr = 0;
+	int                      rc;
+
+	*out = 0;
+	rc = m0_net_end_point_create(&net, &t->t_tm, addr);
+	M0_UT_ASSERT(rc == 0);
+	m0_mutex_lock(&t->t_tm.ntm_mutex);
+	m0_tl_for(s, &ep_net(net)->e_sock, sock) {
+		if (M0_IN(sock->s_sm.sm_state, (S_CONNECTING, S_OPEN))) {
+			++nr;
+			if (sock->s_flags & OUTGOING)
+				++*out;
+		}
+	} m0_tl_endfor;
+	m0_mutex_unlock(&t->t_tm.ntm_mutex);
+	m0_net_end_point_put(net);
+	return nr;
+}
+
+/*
+ * Returns an open outgoing socket from the transfer machine to "addr", or NULL.
+ * The transfer machine must be locked.
+ */
+static struct sock *su_sock(struct su_tm *t, const char *addr)
+{
+	struct m0_net_end_point *net;
+
+	M0_PRE(m0_mutex_is_locked(&t->t_tm.ntm_mutex));
+	net = m0_tl_find(m0_nep, net, &t->t_tm.ntm_end_points,
+			 m0_streq(net->nep_addr, addr));
+	return net == NULL ? NULL :
+		m0_tl_find(s, sock, &ep_net(net)->e_sock,
+			   sock->s_sm.sm_state == S_OPEN &&
+			   sock->s_flags & OUTGOING);
+}
+
+/*
+ * A message to a unix end-point and a reply to the sender, as reported in the
+ * receive event. The connection accepted by the receiver has an anonymous peer
+ * (unix_decode()), the reply goes to the named end-point of the sender.
+ */
+static void unix_msg(void)
+{
+	enum { LEN = 3000 };
+	struct su_tm  *a;
+	struct su_tm  *b;
+	struct su_buf *recv;
+
+	M0_ALLOC_PTR(a);
+	M0_ALLOC_PTR(b);
+	M0_UT_ASSERT(a != NULL && b != NULL);
+	su_tm_start(a, "unix:stream:su-msg-a@1");
+	su_tm_start(b, "unix:stream:su-msg-b@1");
+	su_buf_init(a, 0, SU_SEG);
+	su_buf_init(a, 1, SU_SEG);
+	su_buf_init(b, 0, SU_SEG);
+	su_buf_init(b, 1, SU_SEG);
+
+	su_recv_add(b, &b->t_buf[0], LEN, 1);
+	su_recv_add(a, &a->t_buf[1], LEN, 1);
+	su_send_to(a, &a->t_buf[0], "unix:stream:su-msg-b@1", LEN, 1);
+	recv = &b->t_buf[0];
+	su_recv_check(recv, 0, LEN, 1);
+	M0_UT_ASSERT(!recv->b_retained);
+	M0_UT_ASSERT(recv->b_ep != NULL);
+	M0_UT_ASSERT(m0_streq(recv->b_ep->nep_addr, "unix:stream:su-msg-a@1"));
+
+	su_send(b, &b->t_buf[1], recv->b_ep, LEN, 2);
+	su_recv_check(&a->t_buf[1], 0, LEN, 2);
+
+	su_tm_stop(b);
+	su_tm_stop(a);
+	m0_free(b);
+	m0_free(a);
+}
+
+/* Bulk transfers in both directions between unix end-points. */
+static void unix_bulk(void)
+{
+	enum { LEN = 4 * SU_SEG };
+	struct su_tm *a;
+	struct su_tm *b;
+	int           rc;
+
+	M0_ALLOC_PTR(a);
+	M0_ALLOC_PTR(b);
+	M0_UT_ASSERT(a != NULL && b != NULL);
+	su_tm_start(a, "unix:stream:su-bulk-a@1");
+	su_tm_start(b, "unix:stream:su-bulk-b@1");
+	su_buf_init(a, 0, LEN);
+	su_buf_init(b, 0, LEN);
+
+	rc = su_bulk(a, &a->t_buf[0], b, &b->t_buf[0], LEN, 3, true);
+	M0_UT_ASSERT(rc == 0);
+	rc = su_bulk(a, &a->t_buf[0], b, &b->t_buf[0], LEN - 7, 4, false);
+	M0_UT_ASSERT(rc == 0);
+
+	su_tm_stop(b);
+	su_tm_stop(a);
+	m0_free(b);
+	m0_free(a);
+}
+
+/*
+ * Several messages received in a single buffer (M0_NET_BUF_RETAIN). The buffer
+ * is released when the maximal number of messages is received, or when the
+ * room left is too small. Each message starts at an 8-byte aligned offset.
+ */
+static void unix_multi_recv(void)
+{
+	enum { MSG_NR = 4, LEN = 1000, SMALL = 16 * 1024, ODD = 2999 };
+	static const char *baddr = "unix:stream:su-mrecv-b@1";
+	struct su_tm      *a;
+	struct su_tm      *b;
+	struct su_buf     *recv;
+	struct su_buf     *small;
+	m0_bindex_t        off;
+	int                i;
+
+	M0_ALLOC_PTR(a);
+	M0_ALLOC_PTR(b);
+	M0_UT_ASSERT(a != NULL && b != NULL);
+	su_tm_start(a, "unix:stream:su-mrecv-a@1");
+	su_tm_start(b, baddr);
+	su_buf_init(a, 0, SU_SEG);
+	recv  = su_buf_init(b, 0, SU_SEG);
+	small = su_buf_init(b, 1, SMALL);
+
+	/* Released after nb_max_receive_msgs messages. */
+	su_recv_add(b, recv, LEN, MSG_NR);
+	for (i = 0; i < MSG_NR; ++i) {
+		su_send_to(a, &a->t_buf[0], baddr, LEN, 16 + i);
+		su_recv_check(recv, i * LEN, LEN, 16 + i);
+		M0_UT_ASSERT(recv->b_retained == (i < MSG_NR - 1));
+	}
+	M0_UT_ASSERT(!(recv->b_nb.nb_flags & M0_NET_BUF_QUEUED));
+
+	/*
+	 * Released when less than SOCK_RECV_MIN bytes are left after the
+	 * aligned end of the last message.
+	 */
+	su_recv_add(b, small, ODD, 32);
+	for (i = 0, off = 0; off + SOCK_RECV_MIN <= SMALL; ++i) {
+		su_send_to(a, &a->t_buf[0], baddr, ODD, 32 + i);
+		su_recv_check(small, off, ODD, 32 + i);
+		off = m0_align(off + ODD, 8);
+		M0_UT_ASSERT(small->b_retained == (off + SOCK_RECV_MIN <= SMALL));
+	}
+	M0_UT_ASSERT(i == 5);
+	M0_UT_ASSERT(!(small->b_nb.nb_flags & M0_NET_BUF_QUEUED));
+
+	su_tm_stop(b);
+	su_tm_stop(a);
+	m0_free(b);
+	m0_free(a);
+}
+
+/*
+ * Several peers exchange messages with a server, all with 4 pollers. The
+ * sockets of the server (accepted from the peers and connected to them for the
+ * replies) are spread round-robin over the pollers.
+ */
+static void inet_pollers(void)
+{
+	enum { POLLER_NR = 4, PEER_NR = 3, ROUND_NR = 2, LEN = 5000 };
+	static const char *saddr = "inet:stream:127.0.0.1@31500";
+	static const char *caddr[PEER_NR] = {
+		"inet:stream:127.0.0.1@31501",
+		"inet:stream:127.0.0.1@31502",
+		"inet:stream:127.0.0.1@31503"
+	};
+	struct su_tm  *srv;
+	struct su_tm  *cl[PEER_NR];
+	struct su_buf *recv;
+	struct ma     *ma;
+	uint32_t       seen;
+	uint32_t       used;
+	uint32_t       nr;
+	int            r;
+	int            i;
+	int            j;
+
+	m0_net_sock_pollers_set(POLLER_NR);
+	M0_ALLOC_PTR(srv);
+	M0_UT_ASSERT(srv != NULL);
+	su_tm_start(srv, saddr);
+	for (i = 0; i < ARRAY_SIZE(srv->t_buf); ++i)
+		su_buf_init(srv, i, SU_SEG);
+	for (i = 0; i < PEER_NR; ++i) {
+		M0_ALLOC_PTR(cl[i]);
+		M0_UT_ASSERT(cl[i] != NULL);
+		su_tm_start(cl[i], caddr[i]);
+		su_buf_init(cl[i], 0, SU_SEG);
+		su_buf_init(cl[i], 1, SU_SEG);
+	}
+	m0_net_sock_pollers_set(1);
+	ma = srv->t_tm.ntm_xprt_private;
+	M0_UT_ASSERT(ma->t_poller_nr == POLLER_NR);
+
+	for (r = 0; r < ROUND_NR; ++r) {
+		for (i = 0; i < PEER_NR; ++i) {
+			su_recv_add(srv, &srv->t_buf[i], LEN, 1);
+			su_recv_add(cl[i], &cl[i]->t_buf[1], LEN, 1);
+		}
+		for (i = 0; i < PEER_NR; ++i)
+			su_send_to(cl[i], &cl[i]->t_buf[0], saddr, LEN,
+				   16 * i + r);
+		/* Messages land in the receive buffers in any order. */
+		for (i = 0, seen = 0; i < PEER_NR; ++i) {
+			recv = &srv->t_buf[i];
+			su_wait(recv);
+			M0_UT_ASSERT(recv->b_status == 0);
+			M0_UT_ASSERT(recv->b_length == LEN);
+			M0_UT_ASSERT(recv->b_ep != NULL);
+			for (j = 0; j < PEER_NR; ++j) {
+				if (m0_streq(recv->b_ep->nep_addr, caddr[j]))
+					break;
+			}
+			M0_UT_ASSERT(j < PEER_NR && (seen & M0_BITS(j)) == 0);
+			seen |= M0_BITS(j);
+			M0_UT_ASSERT(su_pattern(recv, 0, LEN, 16 * j + r,
+						true));
+			su_send(srv, &srv->t_buf[SU_BUF_NR - 1], recv->b_ep,
+				LEN, 16 * j + r + 8);
+			m0_net_end_point_put(recv->b_ep);
+			recv->b_ep = NULL;
+		}
+		for (i = 0; i < PEER_NR; ++i)
+			su_recv_check(&cl[i]->t_buf[1], 0, LEN, 16 * i + r + 8);
+	}
+	used = su_pollers_used(srv, &nr);
+	M0_UT_ASSERT(nr >= PEER_NR);
+	M0_UT_ASSERT(used == min32u(nr, POLLER_NR));
+
+	for (i = 0; i < PEER_NR; ++i) {
+		su_tm_stop(cl[i]);
+		m0_free(cl[i]);
+	}
+	su_tm_stop(srv);
+	m0_free(srv);
+}
+
+/*
+ * A bulk transfer striped over 4 sockets per end-point. Then a write fails in
+ * the middle of a transfer: the active buffer fails, the socket is closed and
+ * the next transfer re-opens the parallel sockets.
+ */
+static void inet_ep_sockets(void)
+{
+	enum { SOCK_NR = 4, LEN = 16 * SU_SEG };
+	static const char *aaddr = "inet:stream:127.0.0.1@31510";
+	static const char *baddr = "inet:stream:127.0.0.1@31511";
+	struct su_tm      *a;
+	struct su_tm      *b;
+	struct su_buf     *pb;
+	uint32_t           out;
+	uint32_t           nr;
+	int                rc;
+
+	m0_net_sock_ep_sockets_set(SOCK_NR);
+	M0_ALLOC_PTR(a);
+	M0_ALLOC_PTR(b);
+	M0_UT_ASSERT(a != NULL && b != NULL);
+	su_tm_start(a, aaddr);
+	su_tm_start(b, baddr);
+	m0_net_sock_ep_sockets_set(1);
+	su_buf_init(a, 0, LEN);
+	pb = su_buf_init(b, 0, LEN);
+
+	rc = su_bulk(a, &a->t_buf[0], b, pb, LEN, 5, true);
+	M0_UT_ASSERT(rc == 0);
+	nr = su_ep_sockets(a, baddr, &out);
+	M0_UT_ASSERT(nr == SOCK_NR && out == SOCK_NR);
+
+	/* Fail the third write, after some data have been sent. */
+	m0_fi_enable_off_n_on_m("pk_io", "write-fail", 2, 1);
+	rc = su_bulk(a, &a->t_buf[0], b, pb, LEN, 6, true);
+	m0_fi_disable("pk_io", "write-fail");
+	M0_UT_ASSERT(rc < 0);
+	/*
+	 * The passive buffer did not get all the data. It is either still
+	 * queued or failed by the receiver when the connection broke.
+	 */
+	m0_net_buffer_del(&pb->b_nb, &b->t_tm);
+	su_wait(pb);
+	M0_UT_ASSERT(pb->b_status != 0);
+
+	rc = su_bulk(a, &a->t_buf[0], b, pb, LEN, 7, true);
+	M0_UT_ASSERT(rc == 0);
+	nr = su_ep_sockets(a, baddr, &out);
+	M0_UT_ASSERT(nr == SOCK_NR && out == SOCK_NR);
+
+	su_tm_stop(b);
+	su_tm_stop(a);
+	m0_free(b);
+	m0_free(a);
+}
+
+/*
+ * Zero-copy sends over inet, with fault injection:
+ *
+ *     - MSG_ZEROCOPY send fails with ENOBUFS: the payload is copied instead;
+ *
+ *     - the kernel reports that zero-copy data were copied anyway: zero-copy
+ *       is switched off for the socket;
+ *
+ *     - a socket is closed with outstanding zero-copy sends: the completed
+ *       buffer fails with -ECONNABORTED.
+ *
+ * Nothing is checked if zero-copy is not supported or is switched off
+ * (M0_NET_SOCK_ZEROCOPY=0).
+ */
+static void inet_zerocopy(void)
+{
+	enum { LEN = 4 * SU_SEG, POLL_NR = 1000 };
+	static const char *aaddr = "inet:stream:127.0.0.1@31520";
+	static const char *baddr = "inet:stream:127.0.0.1@31521";
+	struct su_tm      *a;
+	struct su_tm      *b;
+	struct su_buf     *ab;
+	struct su_buf     *pb;
+	struct sock       *s;
+	struct buf        *buf;
+	bool               zc;
+	int                rc;
+	int                i;
+
+	M0_ALLOC_PTR(a);
+	M0_ALLOC_PTR(b);
+	M0_UT_ASSERT(a != NULL && b != NULL);
+	su_tm_start(a, aaddr);
+	su_tm_start(b, baddr);
+	ab = su_buf_init(a, 0, LEN);
+	pb = su_buf_init(b, 0, LEN);
+
+	m0_fi_enable("pk_io", "zc-enobufs");
+	rc = su_bulk(a, ab, b, pb, LEN, 8, true);
+	m0_fi_disable("pk_io", "zc-enobufs");
+	M0_UT_ASSERT(rc == 0);
+	m0_mutex_lock(&a->t_tm.ntm_mutex);
+	s = su_sock(a, baddr);
+	M0_UT_ASSERT(s != NULL);
+	zc = s->s_zc != NULL;
+	M0_UT_ASSERT(ergo(zc, s->s_flags & ZEROCOPY && s->s_zc_next == 0));
+	m0_mutex_unlock(&a->t_tm.ntm_mutex);
+	if (!zc)
+		goto out;
+
+	m0_fi_enable("sock_zc_reap", "zc-copied");
+	rc = su_bulk(a, ab, b, pb, LEN, 9, true);
+	m0_fi_disable("sock_zc_reap", "zc-copied");
+	M0_UT_ASSERT(rc == 0);
+	m0_mutex_lock(&a->t_tm.ntm_mutex);
+	s = su_sock(a, baddr);
+	M0_UT_ASSERT(s != NULL);
+	M0_UT_ASSERT(s->s_zc_next > 0 && s->s_zc_head == s->s_zc_next);
+	M0_UT_ASSERT(!(s->s_flags & ZEROCOPY));
+	/* Close the socket, the next transfer opens one with zero-copy. */
+	sock_done(s, true);
+	m0_mutex_unlock(&a->t_tm.ntm_mutex);
+
+	/*
+	 * Keep the sends outstanding, wait until the writer is done and the
+	 * buffer waits for the notifications, then close the socket.
+	 */
+	m0_fi_enable("sock_zc_reap", "zc-hold");
+	su_pattern(ab, 0, LEN, 10, false);
+	su_add(b, pb, M0_NET_QT_PASSIVE_BULK_RECV, 0);
+	rc = m0_net_desc_copy(&pb->b_nb.nb_desc, &ab->b_nb.nb_desc);
+	M0_UT_ASSERT(rc == 0);
+	su_add(a, ab, M0_NET_QT_ACTIVE_BULK_SEND, LEN);
+	for (i = 0, s = NULL; i < POLL_NR && s == NULL; ++i) {
+		m0_mutex_lock(&a->t_tm.ntm_mutex);
+		buf = ab->b_nb.nb_xprt_private;
+		if (b_tlink_is_in(buf) && buf->b_zc > 0) {
+			s = su_sock(a, baddr);
+			M0_UT_ASSERT(s != NULL && s->s_zc_head != s->s_zc_next);
+			sock_done(s, true);
+		}
+		m0_mutex_unlock(&a->t_tm.ntm_mutex);
+		if (s == NULL)
+			m0_nanosleep(m0_time(0, 10000000), NULL);
+	}
+	m0_fi_disable("sock_zc_reap", "zc-hold");
+	M0_UT_ASSERT(s != NULL);
+	su_wait(ab);
+	M0_UT_ASSERT(ab->b_status == -ECONNABORTED);
+	/* The receiver might or might not have got all the data. */
+	m0_net_buffer_del(&pb->b_nb, &b->t_tm);
+	su_wait(pb);
+	m0_net_desc_free(&ab->b_nb.nb_desc);
+	m0_net_desc_free(&pb->b_nb.nb_desc);
+out:
+	su_tm_stop(b);
+	su_tm_stop(a);
+	m0_free(b);
+	m0_free(a);
+}
+
+struct m0_ut_suite m0_net_sock_ut = {
+	.ts_name = "net-sock-ut",
+	.ts_tests = {
+		{ "unix-msg",   unix_msg        },
+		{ "unix-bulk",  unix_bulk       },
+		{ "multi-recv", unix_multi_recv },
+		{ "pollers",    inet_pollers    },
+		{ "ep-sockets", inet_ep_sockets },
+		{ "zerocopy",   inet_zerocopy   },
+		{ NULL, NULL }
+	}
+};
+
+#undef M0_TRACE_SUBSYSTEM
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
+/*
+ * vim: tabstop=8 shiftwidth=8 noexpandtab textwidth=80 nowrap
+ */
@@ -77,5 +77,9 @@ for KERNEL_ROLE in ${#ROLE[@]}; do
 	echo "--- bulk test (test message size is 1MiB)"
 	$CWD/st-bulk.sh
 done
+if [ "$XPRT" != "lnet" ]; then
+	echo "--- bulk test, parallel sockets per end-point"
+	$CWD/st-bulk-sockets.sh
+fi
 sandbox_fini
 report_and_exit net 0
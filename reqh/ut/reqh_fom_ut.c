@@ -122,7 +122,8 @@ static int reqh_ut_balloc_alloc(struct m0_ad_balloc *ballroom,
 				struct m0_dtx *tx,
 				m0_bcount_t count,
 				struct m0_ext *out,
-				uint64_t alloc_zone)
+				uint64_t alloc_zone,
+				const struct m0_fid *owner)
 {
 	struct reqh_ut_balloc	*rb = getballoc(ballroom);
 
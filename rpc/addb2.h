@@ -50,6 +50,11 @@ enum m0_avi_rpc_labels {
         M0_AVI_RPC_BULK_ATTR_BUF_NR,
         M0_AVI_RPC_BULK_ATTR_BYTES,
         M0_AVI_RPC_BULK_ATTR_SEG_NR,
+
+	/** Histogram of rpc machine lock wait times. */
+	M0_AVI_RPC_LOCK_WAIT,
+	/** Histogram of rpc machine lock hold times. */
+	M0_AVI_RPC_LOCK_HOLD,
 } M0_XCA_ENUM;
 
 /** @} end of rpc group */
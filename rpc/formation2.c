@@ -36,6 +36,8 @@
  * @{
  */
 static bool itemq_invariant(const struct m0_tl *q);
+static bool itemq_bucket_invariant(const struct m0_rpc_frm *frm,
+				   const struct m0_tl *q);
 static m0_bcount_t itemq_nr_bytes_acc(const struct m0_tl *q);
 
 static enum m0_rpc_frm_itemq_type
@@ -43,8 +45,9 @@ frm_which_qtype(struct m0_rpc_frm *frm, const struct m0_rpc_item *item);
 static bool frm_is_idle(const struct m0_rpc_frm *frm);
 static void frm_insert(struct m0_rpc_frm *frm, struct m0_rpc_item *item);
 static void frm_remove(struct m0_rpc_frm *frm, struct m0_rpc_item *item);
-static void __itemq_insert(struct m0_tl *q, struct m0_rpc_item *new_item);
-static void __itemq_remove(struct m0_rpc_item *item);
+static void __itemq_insert(struct m0_rpc_frm *frm, struct m0_tl *q,
+			   struct m0_rpc_item *new_item);
+static void __itemq_remove(struct m0_rpc_frm *frm, struct m0_rpc_item *item);
 static void frm_balance(struct m0_rpc_frm *frm);
 static bool frm_is_ready(const struct m0_rpc_frm *frm);
 static void frm_fill_packet(struct m0_rpc_frm *frm, struct m0_rpc_packet *p);
@@ -80,8 +83,9 @@ static const char *str_qtype[] = {
 
 M0_BASSERT(ARRAY_SIZE(str_qtype) == FRMQ_NR_QUEUES);
 
-#define frm_first_itemq(frm) (&(frm)->f_itemq[0])
-#define frm_end_itemq(frm) (&(frm)->f_itemq[ARRAY_SIZE((frm)->f_itemq)])
+#define frm_first_itemq(frm) (&(frm)->f_itemq[0][0])
+#define frm_end_itemq(frm) (frm_first_itemq(frm) + FRMQ_NR_QUEUES * \
+			    M0_RPC_ITEM_PRIO_NR)
 
 #define for_each_itemq_in_frm(itemq, frm)  \
 for (itemq = frm_first_itemq(frm); \
@@ -104,13 +108,15 @@ static bool frm_invariant(const struct m0_rpc_frm *frm)
 		frm->f_state < FRM_NR_STATES &&
 		frm->f_ops != NULL &&
 		equi(frm->f_state == FRM_IDLE,  frm_is_idle(frm)) &&
-		m0_forall(i, FRMQ_NR_QUEUES,
+		m0_forall(i, FRMQ_NR_QUEUES * M0_RPC_ITEM_PRIO_NR,
 			  ({
-				  const struct m0_tl *q = &frm->f_itemq[i];
+				  const struct m0_tl *q =
+					  frm_first_itemq(frm) + i;
 
 				  nr_items     += itemq_tlist_length(q);
 				  nr_bytes_acc += itemq_nr_bytes_acc(q);
-				  itemq_invariant(q); })) &&
+				  itemq_invariant(q) &&
+				  itemq_bucket_invariant(frm, q); })) &&
 		frm->f_nr_items == nr_items &&
 		frm->f_nr_bytes_accumulated == nr_bytes_acc;
 }
@@ -122,10 +128,40 @@ static bool itemq_invariant(const struct m0_tl *q)
 					const struct m0_rpc_item *prev =
 						itemq_tlist_prev(q, item);
 					ergo(prev != NULL,
+					     prev->ri_prio == item->ri_prio &&
 					     item_less_or_equal(prev, item));
 				}));
 }
 
+/**
+   Returns the deadline bucket of an item, see m0_rpc_frm::f_bucket.
+ */
+static uint64_t item_bucket(const struct m0_rpc_item *item)
+{
+	return item->ri_deadline >> FRM_BUCKET_SHIFT;
+}
+
+/**
+   Returns the deadline-bucket index of the list q of frm.
+ */
+static struct m0_rpc_item **itemq_bucket(const struct m0_rpc_frm *frm,
+					 const struct m0_tl *q)
+{
+	return (struct m0_rpc_item **)&frm->f_bucket[0][0][0] +
+		(q - frm_first_itemq(frm)) * FRM_BUCKET_NR;
+}
+
+static bool itemq_bucket_invariant(const struct m0_rpc_frm *frm,
+				   const struct m0_tl *q)
+{
+	struct m0_rpc_item **bucket = itemq_bucket(frm, q);
+
+	return m0_forall(i, FRM_BUCKET_NR,
+			 bucket[i] == NULL ||
+			 (bucket[i]->ri_itemq == q &&
+			  item_bucket(bucket[i]) % FRM_BUCKET_NR == i));
+}
+
 /**
    Defines total order of rpc items in itemq.
  */
@@ -163,6 +199,20 @@ M0_INTERNAL struct m0_rpc_machine *frm_rmachine(const struct m0_rpc_frm *frm)
 	return frm_rchan(frm)->rc_rpc_machine;
 }
 
+/**
+   Returns the list of queue qtype in which the item should be placed,
+   according to its priority.
+ */
+static struct m0_tl *frm_itemq(struct m0_rpc_frm *frm,
+			       enum m0_rpc_frm_itemq_type qtype,
+			       const struct m0_rpc_item *item)
+{
+	M0_PRE(IS_IN_ARRAY(qtype, frm->f_itemq));
+	M0_PRE(item->ri_prio >= M0_RPC_ITEM_PRIO_MIN &&
+	       item->ri_prio <= M0_RPC_ITEM_PRIO_MAX);
+	return &frm->f_itemq[qtype][M0_RPC_ITEM_PRIO_MAX - item->ri_prio];
+}
+
 static bool frm_rmachine_is_locked(const struct m0_rpc_frm *frm)
 {
 	return m0_rpc_machine_is_locked(frm_rmachine(frm));
@@ -242,10 +292,8 @@ static void drop_all_items(struct m0_rpc_frm *frm)
 {
 	struct m0_rpc_item *item;
 	struct m0_tl       *q;
-	int                 i;
 
-	for (i = 0; i < FRMQ_NR_QUEUES; i++) {
-		q = &frm->f_itemq[i];
+	for_each_itemq_in_frm(q, frm) {
 		m0_tl_for(itemq, q, item) {
 			M0_ASSERT(m0_rpc_item_is_oneway(item));
 			m0_rpc_item_get(item);
@@ -284,10 +332,10 @@ static void frm_insert(struct m0_rpc_frm *frm, struct m0_rpc_item *item)
 	M0_LOG(M0_DEBUG, "priority: %d", item->ri_prio);
 
 	qtype = frm_which_qtype(frm, item);
-	q     = &frm->f_itemq[qtype];
+	q     = frm_itemq(frm, qtype, item);
 
 	m0_rpc_item_get(item);
-	__itemq_insert(q, item);
+	__itemq_insert(frm, q, item);
 
 	M0_CNT_INC(frm->f_nr_items);
 	frm->f_nr_bytes_accumulated += m0_rpc_item_size(item);
@@ -327,7 +375,10 @@ up:
 M0_INTERNAL bool item_is_in_waiting_queue(const struct m0_rpc_item *item,
 					  const struct m0_rpc_frm *frm)
 {
-	return item->ri_itemq == &frm->f_itemq[FRMQ_WAITING];
+	const struct m0_tl *waiting = frm->f_itemq[FRMQ_WAITING];
+
+	return item->ri_itemq >= waiting &&
+	       item->ri_itemq <  waiting + M0_RPC_ITEM_PRIO_NR;
 }
 
 /**
@@ -356,28 +407,58 @@ frm_which_qtype(struct m0_rpc_frm *frm, const struct m0_rpc_item *item)
 }
 
 /**
-   q is sorted by m0_rpc_item::ri_prio and then by m0_rpc_item::ri_deadline.
-
-   Insert new_item such that the ordering of q is maintained.
+   q holds items of the same priority, sorted by m0_rpc_item::ri_deadline.
+
+   Insert new_item such that the ordering of q is maintained. Items with
+   equal deadlines are kept in the order of insertion.
+
+   The search starts from the last item of the latest non-empty deadline
+   bucket not after the bucket of new_item (m0_rpc_frm::f_bucket), so the
+   insertion costs a look-up of at most FRM_BUCKET_NR buckets plus a walk
+   over the items of one bucket, whatever the order of deadlines within
+   ~1s. If no bucket is found, that is, new_item's deadline is more than
+   FRM_BUCKET_NR buckets after the deadlines of all the items in q, the search
+   starts from the tail. Out-of-order inputs with deadlines spread wider than
+   the wheel, or a lot of items in one bucket, still degrade to the linear
+   walk.
  */
-static void __itemq_insert(struct m0_tl *q, struct m0_rpc_item *new_item)
+static void __itemq_insert(struct m0_rpc_frm *frm, struct m0_tl *q,
+			   struct m0_rpc_item *new_item)
 {
-	struct m0_rpc_item *item;
+	struct m0_rpc_item **bucket = itemq_bucket(frm, q);
+	struct m0_rpc_item  *item   = NULL;
+	struct m0_rpc_item  *next;
+	uint64_t             b      = item_bucket(new_item);
+	uint64_t             i;
 
 	M0_ENTRY();
 
-	/* insertion sort. */
-	m0_tl_for(itemq, q, item) {
-		if (!item_less_or_equal(item, new_item)) {
-			itemq_tlist_add_before(item, new_item);
-			break;
-		}
-	} m0_tl_endfor;
+	for (i = 0; i < FRM_BUCKET_NR && i <= b && item == NULL; ++i) {
+		item = bucket[(b - i) % FRM_BUCKET_NR];
+		if (item != NULL && item_bucket(item) != b - i)
+			item = NULL;
+	}
+	if (item == NULL)
+		item = itemq_tlist_tail(q);
+	while (item != NULL && !item_less_or_equal(item, new_item))
+		item = itemq_tlist_prev(q, item);
+	while (item != NULL &&
+	       (next = itemq_tlist_next(q, item)) != NULL &&
+	       item_less_or_equal(next, new_item))
+		item = next;
 	if (item == NULL)
-		itemq_tlist_add_tail(q, new_item);
+		itemq_tlist_add(q, new_item);
+	else
+		itemq_tlist_add_after(item, new_item);
 	new_item->ri_itemq = q;
 
-	M0_ASSERT_EX(itemq_invariant(q));
+	/* new_item is after all the items of its bucket it is not before. */
+	item = bucket[b % FRM_BUCKET_NR];
+	if (item == NULL || item_bucket(item) != b ||
+	    item_less_or_equal(item, new_item))
+		bucket[b % FRM_BUCKET_NR] = new_item;
+
+	M0_ASSERT_EX(itemq_invariant(q) && itemq_bucket_invariant(frm, q));
 	M0_LEAVE();
 }
 
@@ -397,8 +478,8 @@ static void item_move_to_urgent_queue(struct m0_rpc_frm *frm,
 {
 	M0_PRE(item != NULL);
 
-	__itemq_remove(item);
-	__itemq_insert(&frm->f_itemq[FRMQ_URGENT], item);
+	__itemq_remove(frm, item);
+	__itemq_insert(frm, frm_itemq(frm, FRMQ_URGENT, item), item);
 }
 
 /**
@@ -479,7 +560,8 @@ static bool frm_is_ready(const struct m0_rpc_frm *frm)
 	if (M0_FI_ENABLED("ready"))
 		return true;
 	has_urgent_items =
-		!itemq_tlist_is_empty(&frm->f_itemq[FRMQ_URGENT]);
+		!m0_forall(i, M0_RPC_ITEM_PRIO_NR,
+			   itemq_tlist_is_empty(&frm->f_itemq[FRMQ_URGENT][i]));
 
 	c = &frm->f_constraints;
 	return frm->f_nr_packets_enqed < c->fc_max_nr_packets_enqed &&
@@ -497,15 +579,19 @@ static void frm_fill_packet(struct m0_rpc_frm *frm, struct m0_rpc_packet *p)
 	struct m0_rpc_item *item;
 	struct m0_tl       *q;
 	m0_bcount_t         limit;
+	m0_bcount_t         min_size;
 
 	M0_ENTRY("frm: %p packet: %p", frm, p);
 
 	M0_ASSERT_EX(frm_invariant(frm));
 
+	/* No item is smaller than its on-wire header and footer. */
+	min_size = m0_rpc_item_onwire_header_size +
+		   m0_rpc_item_onwire_footer_size;
 	for_each_itemq_in_frm(q, frm) {
 		m0_tl_for(itemq, q, item) {
 			/* See FRM_FILL_PACKET_NOTE_1 at the end of this func */
-			if (available_space_in_packet(p, frm) == 0)
+			if (available_space_in_packet(p, frm) < min_size)
 				goto out;
 			if (item_will_exceed_packet_size(item, p, frm))
 				continue;
@@ -543,6 +629,9 @@ out:
  * I know that this loop is inefficient. But for now
  * let's just stick to simplicity. We can optimize it
  * later if need arises. --Amit
+ *
+ * The loop stops as soon as no item can fit in the packet, so that a full
+ * packet does not cause the scan of all the queued items.
  */
 
 static m0_bcount_t available_space_in_packet(const struct m0_rpc_packet *p,
@@ -635,7 +724,7 @@ static void frm_remove(struct m0_rpc_frm *frm, struct m0_rpc_item *item)
 	M0_PRE(frm != NULL && item != NULL);
 	M0_PRE(frm->f_nr_items > 0 && item->ri_itemq != NULL);
 
-	__itemq_remove(item);
+	__itemq_remove(frm, item);
 	item->ri_frm = NULL;
 	M0_CNT_DEC(frm->f_nr_items);
 	frm->f_nr_bytes_accumulated -= m0_rpc_item_size(item);
@@ -647,8 +736,17 @@ static void frm_remove(struct m0_rpc_frm *frm, struct m0_rpc_item *item)
 	M0_LEAVE();
 }
 
-static void __itemq_remove(struct m0_rpc_item *item)
+static void __itemq_remove(struct m0_rpc_frm *frm, struct m0_rpc_item *item)
 {
+	struct m0_rpc_item **slot = itemq_bucket(frm, item->ri_itemq) +
+				    item_bucket(item) % FRM_BUCKET_NR;
+	struct m0_rpc_item  *prev;
+
+	if (*slot == item) {
+		prev  = itemq_tlist_prev(item->ri_itemq, item);
+		*slot = prev != NULL && item_bucket(prev) == item_bucket(item) ?
+			prev : NULL;
+	}
 	itemq_tlink_del_fini(item);
 	item->ri_itemq = NULL;
 }
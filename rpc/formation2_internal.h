@@ -76,6 +76,7 @@
 
 #include "lib/types.h"
 #include "lib/tlist.h"
+#include "rpc/item.h"        /* M0_RPC_ITEM_PRIO_NR */
 
 /* Imports */
 struct m0_rpc_packet;
@@ -153,6 +154,16 @@ enum m0_rpc_frm_itemq_type {
 	FRMQ_NR_QUEUES
 };
 
+enum {
+	/** Number of deadline buckets of an itemq, see m0_rpc_frm::f_bucket. */
+	FRM_BUCKET_NR    = 128,
+	/**
+	   A bucket covers 1 << FRM_BUCKET_SHIFT nanoseconds of deadlines
+	   (~8ms), all the buckets together cover ~1s.
+	 */
+	FRM_BUCKET_SHIFT = 23
+};
+
 /**
    Formation state machine.
 
@@ -205,15 +216,31 @@ struct m0_rpc_frm {
 	/**
 	   Lists of items enqueued to Formation that are not yet
 	   added to any Packet. @see m0_rpc_frm_itemq_type
-	   itemq are sorted by m0_rpc_item::ri_prio (highest priority first).
-	   All items having equal priority are sorted by
-	   m0_rpc_item::ri_deadline (earlier first).
+	   Each queue is split in a list per priority, highest priority
+	   first: f_itemq[qtype][M0_RPC_ITEM_PRIO_MAX - item->ri_prio].
+	   Items in a list are sorted by m0_rpc_item::ri_deadline (earlier
+	   first). Together, the lists of a queue, taken in order, keep
+	   the items sorted by priority and then by deadline.
 	   An item is removed from itemq immediately upon adding the item to
 	   any packet.
 	   link: m0_rpc_item::ri_iq_link
 	   descriptor: itemq
 	 */
-	struct m0_tl                   f_itemq[FRMQ_NR_QUEUES];
+	struct m0_tl                   f_itemq[FRMQ_NR_QUEUES]
+	                                      [M0_RPC_ITEM_PRIO_NR];
+
+	/**
+	   Deadline-bucket index of f_itemq[][], a timer wheel. Deadlines
+	   are split in buckets of 1 << FRM_BUCKET_SHIFT nanoseconds. For
+	   each list, f_bucket[][][b % FRM_BUCKET_NR] points to the last item
+	   in the list with deadline in bucket b, or is NULL. An entry
+	   pointing to an item of another bucket (b +/- k * FRM_BUCKET_NR) is
+	   ignored. The index is a hint for __itemq_insert() only: the list
+	   itself keeps the order walked by frm_fill_packet().
+	 */
+	struct m0_rpc_item            *f_bucket[FRMQ_NR_QUEUES]
+	                                       [M0_RPC_ITEM_PRIO_NR]
+	                                       [FRM_BUCKET_NR];
 
 	/** Total number of items waiting in itemq */
 	uint64_t                       f_nr_items;
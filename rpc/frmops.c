@@ -66,7 +66,13 @@ const struct m0_rpc_frm_ops m0_rpc_frm_default_ops = {
 	.fo_packet_ready = packet_ready,
 };
 
-enum { M0_RPC_TMO = 8 };
+enum {
+	M0_RPC_TMO   = 8,
+	/** Default number of send shards of an rpc machine. */
+	RPC_SHARD_NR = 2
+};
+
+static uint32_t rpc_shard_nr = RPC_SHARD_NR;
 
 /**
    RPC layer's wrapper on m0_net_buffer. rpc_buffer carries one packet at
@@ -83,10 +89,16 @@ enum { M0_RPC_TMO = 8 };
 struct rpc_buffer {
 	struct m0_net_buffer   rb_netbuf;
 	struct m0_rpc_packet  *rb_packet;
+	/** Link in m0_rpc_shard::rs_queue. */
+	struct m0_tlink        rb_link;
 	/** see M0_RPC_BUF_MAGIC */
 	uint64_t               rb_magic;
 };
 
+M0_TL_DESCR_DEFINE(rpcbuf, "rpc-shard-queue", static, struct rpc_buffer,
+		   rb_link, rb_magic, M0_RPC_BUF_MAGIC, M0_RPC_BUF_HEAD_MAGIC);
+M0_TL_DEFINE(rpcbuf, static, struct rpc_buffer);
+
 static const struct m0_bob_type rpc_buffer_bob_type = {
 	.bt_name         = "rpc_buffer",
 	.bt_magix_offset = M0_MAGIX_OFFSET(struct rpc_buffer, rb_magic),
@@ -103,6 +115,10 @@ static int rpc_buffer_submit(struct rpc_buffer *rpcbuf);
 
 static void rpc_buffer_fini(struct rpc_buffer *rpcbuf);
 
+static void rpc_buffer_send(struct rpc_buffer *rpcbuf);
+
+static void rpc_active_nb_dec(struct m0_rpc_machine *machine);
+
 static void buf_send_cb(const struct m0_net_buffer_event *ev);
 
 static const struct m0_net_buffer_callbacks rpc_buf_send_cb = {
@@ -130,15 +146,23 @@ rpc_buffer__rmachine(const struct rpc_buffer *rpcbuf)
    Serialises packet p and its items in a network buffer and submits it to
    network layer.
 
+   If the rpc chan of the packet has a send shard, the packet is queued to the
+   shard and the rest is done by rpc_buffer_send() in the shard thread. Errors
+   are then reported by failing the items of the packet, and the packet is
+   completed by m0_rpc_frm_packet_done(), as if it was sent.
+
    @see m0_rpc_frm_ops::fo_packet_ready()
  */
 static int packet_ready(struct m0_rpc_packet *p)
 {
-	struct rpc_buffer *rpcbuf;
-	int                rc;
+	struct m0_rpc_machine *machine = frm_rmachine(p->rp_frm);
+	struct m0_rpc_shard   *shard   = frm_rchan(p->rp_frm)->rc_shard;
+	struct rpc_buffer     *rpcbuf;
+	int                    rc;
 
 	M0_ENTRY("packet: %p", p);
 	M0_PRE(m0_rpc_packet_invariant(p));
+	M0_PRE(m0_rpc_machine_is_locked(machine));
 
 	M0_ALLOC_PTR(rpcbuf);
 	if (rpcbuf == NULL) {
@@ -146,9 +170,6 @@ static int packet_ready(struct m0_rpc_packet *p)
 		M0_LOG(M0_ERROR, "Failed to allocate rpcbuf");
 		goto err;
 	}
-	rc = rpc_buffer_init(rpcbuf, p);
-	if (rc != 0)
-		goto err_free;
 
 	if (M0_FI_ENABLED("set_reply_error")) {
 		struct m0_rpc_item *item;
@@ -159,15 +180,30 @@ static int packet_ready(struct m0_rpc_packet *p)
 				M0_LOG(M0_ERROR, "packet %p, item %p[%"PRIu32"]"
 				       " set error to %d", p, item,
 				       item->ri_type->rit_opcode, rc);
-				goto out;
+				goto err_free;
 			}
 		} end_for_each_item_in_packet;
 	}
 
-	rc = rpc_buffer_submit(rpcbuf);
-	if (rc == 0)
+	if (shard != NULL) {
+		rpcbuf->rb_packet = p;
+		M0_CNT_INC(machine->rm_active_nb);
+		m0_sm_group_lock(&shard->rs_grp);
+		rpcbuf_tlink_init_at_tail(rpcbuf, &shard->rs_queue);
+		m0_sm_group_unlock(&shard->rs_grp);
+		m0_clink_signal(&shard->rs_grp.s_clink);
+		return M0_RC(0);
+	}
+
+	rc = rpc_buffer_init(rpcbuf, p);
+	if (rc != 0)
+		goto err_free;
+	rc = m0_rpc_packet_encode(p, &rpcbuf->rb_netbuf.nb_buffer) ?:
+		rpc_buffer_submit(rpcbuf);
+	if (rc == 0) {
+		M0_CNT_INC(machine->rm_active_nb);
 		return M0_RC(rc);
-out:
+	}
 	rpc_buffer_fini(rpcbuf);
 err_free:
 	m0_free(rpcbuf);
@@ -178,9 +214,148 @@ err:
 	return M0_RC(rc);
 }
 
+/**
+   Sends a packet queued to a send shard by packet_ready().
+
+   Runs in the shard thread. The network buffer is allocated, registered and
+   submitted without the rpc machine lock. The lock is taken to encode the
+   packet, because items can be cancelled and removed from the packet
+   (m0_rpc_item_cancel_nolock()) until then. Packet size can only decrease
+   after the packet is formed, so the buffer allocated for p->rp_size is large
+   enough.
+ */
+static void rpc_buffer_send(struct rpc_buffer *rpcbuf)
+{
+	struct m0_rpc_packet  *p       = rpcbuf->rb_packet;
+	struct m0_rpc_machine *machine = frm_rmachine(p->rp_frm);
+	int                    rc;
+
+	M0_ENTRY("rpcbuf: %p packet: %p", rpcbuf, p);
+
+	rc = rpc_buffer_init(rpcbuf, p);
+	if (rc == 0) {
+		m0_rpc_machine_lock(machine);
+		rc = m0_rpc_packet_is_empty(p) ? -ECANCELED :
+			m0_rpc_packet_encode(p, &rpcbuf->rb_netbuf.nb_buffer);
+		m0_rpc_machine_unlock(machine);
+		if (rc == 0)
+			rc = rpc_buffer_submit(rpcbuf);
+		if (rc == 0) {
+			M0_LEAVE();
+			return;
+		}
+		rpc_buffer_fini(rpcbuf);
+	}
+	m0_free(rpcbuf);
+
+	m0_rpc_machine_lock(machine);
+	m0_rpc_packet_traverse_items(p, item_fail, rc);
+	m0_rpc_frm_packet_done(p);
+	m0_rpc_packet_discard(p);
+	rpc_active_nb_dec(machine);
+	m0_rpc_machine_unlock(machine);
+	M0_LEAVE("rc: %d", rc);
+}
+
+static void rpc_shard_thread(struct m0_rpc_shard *shard)
+{
+	struct m0_sm_group *grp = &shard->rs_grp;
+	struct rpc_buffer  *rpcbuf;
+
+	M0_ENTRY("shard: %p", shard);
+	m0_sm_group_lock(grp);
+	while (true) {
+		rpcbuf = rpcbuf_tlist_pop(&shard->rs_queue);
+		if (rpcbuf != NULL) {
+			rpcbuf_tlink_fini(rpcbuf);
+			m0_sm_group_unlock(grp);
+			rpc_buffer_send(rpcbuf);
+			m0_sm_group_lock(grp);
+		} else if (shard->rs_stopping) {
+			break;
+		} else {
+			m0_sm_group_unlock(grp);
+			m0_chan_wait(&grp->s_clink);
+			m0_sm_group_lock(grp);
+		}
+	}
+	m0_sm_group_unlock(grp);
+	M0_LEAVE();
+}
+
+M0_INTERNAL void m0_rpc_shard_nr_set(uint32_t nr)
+{
+	rpc_shard_nr = nr;
+}
+
+M0_INTERNAL uint32_t m0_rpc_shard_nr_get(void)
+{
+	return rpc_shard_nr;
+}
+
+M0_INTERNAL int m0_rpc_shards_start(struct m0_rpc_machine *machine)
+{
+	struct m0_rpc_shard *shard;
+	uint32_t             i;
+	int                  rc;
+
+	M0_ENTRY("machine: %p nr: %"PRIu32, machine, rpc_shard_nr);
+	M0_PRE(machine->rm_shard == NULL && machine->rm_shard_nr == 0);
+
+	if (rpc_shard_nr == 0)
+		return M0_RC(0);
+	M0_ALLOC_ARR(machine->rm_shard, rpc_shard_nr);
+	if (machine->rm_shard == NULL)
+		return M0_ERR(-ENOMEM);
+	for (i = 0; i < rpc_shard_nr; ++i) {
+		shard = &machine->rm_shard[i];
+		shard->rs_machine = machine;
+		m0_sm_group_init(&shard->rs_grp);
+		rpcbuf_tlist_init(&shard->rs_queue);
+		rc = M0_THREAD_INIT(&shard->rs_thread, struct m0_rpc_shard *,
+				    NULL, &rpc_shard_thread, shard,
+				    "m0_rpc_shard%"PRIu32, i);
+		if (rc != 0) {
+			rpcbuf_tlist_fini(&shard->rs_queue);
+			m0_sm_group_fini(&shard->rs_grp);
+			m0_rpc_shards_stop(machine);
+			return M0_ERR(rc);
+		}
+		machine->rm_shard_nr = i + 1;
+	}
+	return M0_RC(0);
+}
+
+M0_INTERNAL void m0_rpc_shards_stop(struct m0_rpc_machine *machine)
+{
+	struct m0_rpc_shard *shard;
+	uint32_t             i;
+
+	M0_ENTRY("machine: %p", machine);
+	M0_PRE(machine->rm_active_nb == 0);
+
+	for (i = 0; i < machine->rm_shard_nr; ++i) {
+		shard = &machine->rm_shard[i];
+		m0_sm_group_lock(&shard->rs_grp);
+		shard->rs_stopping = true;
+		m0_sm_group_unlock(&shard->rs_grp);
+		m0_clink_signal(&shard->rs_grp.s_clink);
+		m0_thread_join(&shard->rs_thread);
+		m0_thread_fini(&shard->rs_thread);
+		M0_ASSERT(rpcbuf_tlist_is_empty(&shard->rs_queue));
+		rpcbuf_tlist_fini(&shard->rs_queue);
+		m0_sm_group_fini(&shard->rs_grp);
+	}
+	m0_free0(&machine->rm_shard);
+	machine->rm_shard_nr = 0;
+	M0_LEAVE();
+}
+
 /**
    Initialises rpcbuf, allocates network buffer of size enough to
    accomodate serialised packet p.
+
+   The packet is encoded by the caller.
  */
 static int rpc_buffer_init(struct rpc_buffer    *rpcbuf,
 			   struct m0_rpc_packet *p)
@@ -203,11 +378,6 @@ static int rpc_buffer_init(struct rpc_buffer    *rpcbuf,
 	if (rc != 0)
 		goto out;
 
-	rc = m0_rpc_packet_encode(p, &netbuf->nb_buffer);
-	if (rc != 0) {
-		net_buffer_free(netbuf, ndom);
-		goto out;
-	}
 	rchan = frm_rchan(p->rp_frm);
 	netbuf->nb_length = m0_vec_count(&netbuf->nb_buffer.ov_vec);
 	netbuf->nb_ep     = rchan->rc_destep;
@@ -336,15 +506,21 @@ static int rpc_buffer_submit(struct rpc_buffer *rpcbuf)
 	machine = rpc_buffer__rmachine(rpcbuf);
 	netbuf->nb_timeout = m0_time_from_now(M0_RPC_TMO, 0);
 	rc = m0_net_buffer_add(netbuf, &machine->rm_tm);
-	if (rc == 0) {
-		M0_CNT_INC(machine->rm_active_nb);
-		M0_LOG(M0_DEBUG,"+%p->rm_active_nb: %" PRIi64 " %p\n",
-		       machine, machine->rm_active_nb, rpcbuf);
-	}
 
 	return M0_RC(rc);
 }
 
+static void rpc_active_nb_dec(struct m0_rpc_machine *machine)
+{
+	M0_PRE(m0_rpc_machine_is_locked(machine));
+
+	M0_CNT_DEC(machine->rm_active_nb);
+	M0_LOG(M0_DEBUG, "-%p->rm_active_nb: %" PRIi64, machine,
+	       machine->rm_active_nb);
+	if (machine->rm_active_nb == 0)
+		m0_chan_broadcast(&machine->rm_nb_idle);
+}
+
 static void rpc_buffer_fini(struct rpc_buffer *rpcbuf)
 {
 	struct m0_net_domain  *ndom;
@@ -387,20 +563,22 @@ static void buf_send_cb(const struct m0_net_buffer_event *ev)
 			&rpc_buffer_bob_type);
 
 	machine = rpc_buffer__rmachine(rpcbuf);
+	p = rpcbuf->rb_packet;
 
 	if (M0_FI_ENABLED("delay_callback"))
 		m0_nanosleep(m0_time(0, 300000000), NULL); /* 300 msec */
 
+	/* The buffer is not shared, release it before taking the lock. */
+	rpc_buffer_fini(rpcbuf);
+	m0_free(rpcbuf);
+
 	m0_rpc_machine_lock(machine);
 
 	stats = &machine->rm_stats;
-	p = rpcbuf->rb_packet;
 	p->rp_status = ev->nbe_status;
 
 	if (M0_FI_ENABLED("fake_err"))
 		p->rp_status = -EINVAL;
-	rpc_buffer_fini(rpcbuf);
-	m0_free(rpcbuf);
 
 	if (p->rp_status == 0) {
 		stats->rs_nr_sent_packets++;
@@ -408,11 +586,7 @@ static void buf_send_cb(const struct m0_net_buffer_event *ev)
 	} else {
                 stats->rs_nr_failed_packets++;
 	}
-	M0_CNT_DEC(machine->rm_active_nb);
-	M0_LOG(M0_DEBUG, "-%p->rm_active_nb: %" PRIi64 " %p\n",
-	       machine, machine->rm_active_nb, rpcbuf);
-	if (machine->rm_active_nb == 0)
-		m0_chan_broadcast(&machine->rm_nb_idle);
+	rpc_active_nb_dec(machine);
 	/*
 	 * At this point, rpc subsystem is normally having 4 refs on item/fop:
 	 * - m0_rpc__post_locked()
@@ -564,7 +738,10 @@ static void item_sent(struct m0_rpc_item *item)
 
 static void item_fail(struct m0_rpc_packet *p, struct m0_rpc_item *item, int rc)
 {
-        /* This is only called from packet_ready() error handling code path. */
+        /*
+         * This is only called from packet_ready() and rpc_buffer_send() error
+         * handling code paths.
+         */
         M0_PRE(item != NULL);
         M0_ENTRY("item=%p[%"PRIu32"] ri_error=%"PRIi32" rc=%d",
                  item, item->ri_type->rit_opcode, item->ri_error, rc);
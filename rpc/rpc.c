@@ -34,6 +34,11 @@
 #include "rpc/rpc_internal.h"
 #include "rpc/service.h"
 #include "net/lnet/lnet.h"
+
+#ifndef __KERNEL__
+#include <stdlib.h>       /* getenv, atoi */
+#endif
+
 /**
  * @addtogroup rpc
  * @{
@@ -41,6 +46,12 @@
 
 M0_INTERNAL int m0_rpc_init(void)
 {
+#ifndef __KERNEL__
+	const char *shards = getenv("M0_RPC_SHARDS");
+
+	if (shards != NULL && atoi(shards) >= 0)
+		m0_rpc_shard_nr_set(atoi(shards));
+#endif
 	M0_ENTRY();
 	return M0_RC(m0_rpc_item_module_init() ?:
 		     m0_rpc_service_register() ?:
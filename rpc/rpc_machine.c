@@ -33,6 +33,9 @@
 #include "lib/errno.h"
 #include "lib/finject.h"       /* M0_FI_ENABLED */
 #include "addb2/addb2.h"
+#include "addb2/histogram.h"    /* m0_addb2_loghist_add */
+#include "addb2/global.h"       /* m0_addb2_global_get */
+#include "addb2/sys.h"          /* m0_addb2_sys_get */
 #include "motr/magic.h"
 #include "cob/cob.h"
 #include "net/net.h"
@@ -53,6 +56,7 @@ static int rpc_tm_setup(struct m0_net_transfer_mc *tm,
 			uint32_t                   qlen);
 static int __rpc_machine_init(struct m0_rpc_machine *machine);
 static void __rpc_machine_fini(struct m0_rpc_machine *machine);
+static void rpc_machine_lock_stats(struct m0_rpc_machine *machine, bool on);
 M0_INTERNAL void rpc_worker_thread_fn(struct m0_rpc_machine *machine);
 static struct m0_rpc_chan *rpc_chan_locate(struct m0_rpc_machine *machine,
 					   struct m0_net_end_point *dest_ep);
@@ -155,20 +159,28 @@ M0_INTERNAL int m0_rpc_machine_init(struct m0_rpc_machine *machine,
 	machine->rm_bulk_cutoff = M0_FI_ENABLED("bulk_cutoff_4K") ? 4096 :
 				  m0_align(max_msg_size / 2, m0_pagesize_get());
 	machine->rm_stopping = false;
+	rpc_machine_lock_stats(machine, true);
 	rc = M0_THREAD_INIT(&machine->rm_worker, struct m0_rpc_machine *,
 			    NULL, &rpc_worker_thread_fn, machine, "m0_rpc_worker");
 	if (rc != 0)
 		goto err;
 
+	rc = m0_rpc_shards_start(machine);
+	if (rc != 0)
+		goto err_worker;
+
 	rc = rpc_tm_setup(&machine->rm_tm, net_dom, ep_addr, receive_pool,
 			  colour, msg_size, queue_len);
 	if (rc == 0)
 		return M0_RC(0);
 
+	m0_rpc_shards_stop(machine);
+err_worker:
 	machine->rm_stopping = true;
 	m0_clink_signal(&machine->rm_sm_grp.s_clink);
 	m0_thread_join(&machine->rm_worker);
 err:
+	rpc_machine_lock_stats(machine, false);
 	__rpc_machine_fini(machine);
 	return M0_ERR(rc);
 }
@@ -250,8 +262,11 @@ void m0_rpc_machine_fini(struct m0_rpc_machine *machine)
 	m0_rpc_machine_lock(machine);
 	M0_PRE(rpc_conn_tlist_is_empty(&machine->rm_outgoing_conns));
 	m0_rpc_machine_cleanup_incoming_connections(machine);
+	/* Packets formed by the cleanup go through the send shards. */
+	machine_nb_idle(machine);
 	m0_chan_fini(&machine->rm_nb_idle);
 	m0_rpc_machine_unlock(machine);
+	m0_rpc_shards_stop(machine);
 
 	/* Detach watchers if any */
 	m0_tl_for(rmach_watch, &machine->rm_watch, watch) {
@@ -261,6 +276,7 @@ void m0_rpc_machine_fini(struct m0_rpc_machine *machine)
 	} m0_tl_endfor;
 
 	rpc_tm_cleanup(machine);
+	rpc_machine_lock_stats(machine, false);
 	__rpc_machine_fini(machine);
 	M0_LEAVE();
 }
@@ -375,6 +391,52 @@ enum {
 	DRAIN_MAX      = 128,
 };
 
+/**
+ * Attaches (on == true) or detaches lock contention histograms to the rpc
+ * machine lock.
+ *
+ * The histograms are registered with a dedicated addb2 machine, like the
+ * locality histograms in fop/fom.c, so that they are not tied to the lifetime
+ * of any thread. m0_mutex_lock() reads m0_mutex::m_addb2 before it takes the
+ * lock, so a thread waiting for the lock may update the histograms after they
+ * are detached. Hence they are detached in m0_rpc_machine_fini() only after
+ * the transfer machine is stopped and no other thread can use the lock.
+ */
+static void rpc_machine_lock_stats(struct m0_rpc_machine *machine, bool on)
+{
+	struct m0_mutex_addb2 *ma   = &machine->rm_lock_stats;
+	struct m0_mutex       *mut  = &machine->rm_sm_grp.s_lock;
+	struct m0_addb2_sys   *sys  = m0_addb2_global_get();
+	struct m0_addb2_mach  *orig = m0_thread_tls()->tls_addb2_mach;
+
+	if (on) {
+		M0_SET0(ma);
+		machine->rm_addb2_mach = sys == NULL ? NULL :
+			m0_addb2_sys_get(sys);
+		if (machine->rm_addb2_mach == NULL)
+			return;
+		m0_thread_tls()->tls_addb2_mach = machine->rm_addb2_mach;
+		M0_ADDB2_PUSH(M0_AVI_RPC_LOCK, (uint64_t)machine);
+		m0_addb2_loghist_add(&ma->ma_wait, M0_AVI_RPC_LOCK_WAIT, -1);
+		m0_addb2_loghist_add(&ma->ma_hold, M0_AVI_RPC_LOCK_HOLD, -1);
+		m0_thread_tls()->tls_addb2_mach = orig;
+		m0_rpc_machine_lock(machine);
+		mut->m_addb2 = ma;
+		ma->ma_taken = m0_time_now();
+		m0_rpc_machine_unlock(machine);
+	} else if (machine->rm_addb2_mach != NULL) {
+		m0_rpc_machine_lock(machine);
+		mut->m_addb2 = NULL;
+		m0_rpc_machine_unlock(machine);
+		m0_thread_tls()->tls_addb2_mach = machine->rm_addb2_mach;
+		/* Pop finalises the histograms. */
+		m0_addb2_pop(M0_AVI_RPC_LOCK);
+		m0_thread_tls()->tls_addb2_mach = orig;
+		m0_addb2_sys_put(sys, machine->rm_addb2_mach);
+		machine->rm_addb2_mach = NULL;
+	}
+}
+
 /* Not static because formation ut requires it. */
 M0_INTERNAL void rpc_worker_thread_fn(struct m0_rpc_machine *machine)
 {
@@ -708,6 +770,9 @@ static int rpc_chan_create(struct m0_rpc_chan **chan,
 
 	ch->rc_rpc_machine = machine;
 	ch->rc_destep = dest_ep;
+	if (machine->rm_shard_nr > 0)
+		ch->rc_shard = &machine->rm_shard[machine->rm_shard_next++ %
+						  machine->rm_shard_nr];
 	m0_ref_init(&ch->rc_ref, 1, rpc_chan_ref_release);
 	m0_net_end_point_get(dest_ep);
 
@@ -816,18 +881,24 @@ static void packet_received(struct m0_rpc_packet    *p,
 
 	M0_ENTRY("p %p", p);
 
+	/*
+	 * Take the machine lock once for the whole packet rather than once per
+	 * item: a packet usually carries a batch of items from the same peer and
+	 * re-acquiring the lock for each of them lets the other network and
+	 * locality threads contend for it in between.
+	 */
+	m0_rpc_machine_lock(machine);
 	machine->rm_stats.rs_nr_rcvd_packets++;
 	machine->rm_stats.rs_nr_rcvd_bytes += p->rp_size;
 	/* packet p can also be empty */
 	for_each_item_in_packet(item, p) {
 		item->ri_rmachine = machine;
 		m0_rpc_item_get(item);
-		m0_rpc_machine_lock(machine);
 		m0_rpc_packet_remove_item(p, item);
 		item_received(item, from_ep);
 		m0_rpc_item_put(item);
-		m0_rpc_machine_unlock(machine);
 	} end_for_each_item_in_packet;
+	m0_rpc_machine_unlock(machine);
 
 	M0_LEAVE();
 }
@@ -44,6 +44,7 @@ struct m0_rpc_conn;
 struct m0_rpc_session;
 struct m0_reqh;
 struct m0_dtm;
+struct m0_addb2_mach;
 
 enum {
 	/** Default Maximum RPC message size is taken as 128k */
@@ -74,6 +75,29 @@ struct m0_rpc_stats {
 	uint64_t rs_nr_rcvd_bytes;
 };
 
+/**
+ * Send shard of an rpc machine.
+ *
+ * Each rpc chan (m0_rpc_chan) is bound to a shard when it is created. Packets
+ * formed for the chan are handed over to the shard thread, which allocates
+ * and registers the network buffer, encodes the packet and submits the buffer
+ * to the transfer machine. Only the encoding is done under the rpc machine
+ * lock, so that buffer set-up and submission of different chans do not
+ * serialise on rm_sm_grp. See packet_ready() in rpc/frmops.c.
+ */
+struct m0_rpc_shard {
+	struct m0_rpc_machine            *rs_machine;
+	/** The group lock protects rs_queue and rs_stopping. */
+	struct m0_sm_group                rs_grp;
+	/**
+	 * Buffers waiting to be sent, in formation order.
+	 * tlist descr: rpcbuf
+	 */
+	struct m0_tl                      rs_queue;
+	struct m0_thread                  rs_thread;
+	bool                              rs_stopping;
+};
+
 /**
    RPC machine is an instance of RPC item (FOP/ADDB) processing context.
    Several such contexts might be existing simultaneously.
@@ -134,7 +158,16 @@ struct m0_rpc_machine {
 	 */
 	bool                              rm_stopping;
 	/**
-	 * Active (i.e., queued) network buffers.
+	 * Send shards, m0_rpc_shard_nr_set() of them. NULL if packets are sent
+	 * synchronously by the thread that formed them.
+	 */
+	struct m0_rpc_shard              *rm_shard;
+	uint32_t                          rm_shard_nr;
+	/** Index of the shard the next rpc chan is bound to. */
+	uint32_t                          rm_shard_next;
+	/**
+	 * Active (i.e., queued in a shard or in the transfer machine) network
+	 * buffers.
 	 */
 	uint64_t                          rm_active_nb;
 	/** Signalled when rm_active_nb drops to 0. */
@@ -147,7 +180,17 @@ struct m0_rpc_machine {
 	 */
 	uint32_t                          rm_min_recv_size;
 
+	/**
+	 * Wait and hold time histograms of rm_sm_grp lock, reported as
+	 * M0_AVI_RPC_LOCK_WAIT and M0_AVI_RPC_LOCK_HOLD. Attached to the lock
+	 * between m0_rpc_machine_init() and m0_rpc_machine_fini().
+	 */
 	struct m0_mutex_addb2             rm_lock_stats;
+	/**
+	 * addb2 machine the rm_lock_stats histograms are registered with. NULL
+	 * if addb2 is not configured.
+	 */
+	struct m0_addb2_mach             *rm_addb2_mach;
 
 	/**
 	 * RPC bulk cut-off value. If AT buffer size equals or bigger than
@@ -34,6 +34,7 @@ struct m0_net_end_point;
 struct m0_rpc_machine;
 struct m0_rpc_machine_watch;
 struct m0_rpc_conn;
+struct m0_rpc_shard;
 
 
 /**
@@ -68,6 +69,8 @@ struct m0_rpc_chan {
 	struct m0_net_end_point		 *rc_destep;
 	/** The rpc_machine, this chan structure is associated with.*/
 	struct m0_rpc_machine		 *rc_rpc_machine;
+	/** Send shard of the chan, NULL if the machine has no shards. */
+	struct m0_rpc_shard		 *rc_shard;
 	/** M0_RPC_CHAN_MAGIC */
 	uint64_t			  rc_magic;
 };
@@ -79,6 +82,25 @@ M0_INTERNAL struct m0_rpc_conn *
 m0_rpc_machine_find_conn(const struct m0_rpc_machine *machine,
 			 const struct m0_rpc_item    *item);
 
+/**
+ * Sets the number of send shards (m0_rpc_shard) of rpc machines initialised
+ * afterwards. 0 makes the thread that forms a packet send it.
+ *
+ * In user space the default can be overridden by M0_RPC_SHARDS environment
+ * variable.
+ */
+M0_INTERNAL void m0_rpc_shard_nr_set(uint32_t nr);
+M0_INTERNAL uint32_t m0_rpc_shard_nr_get(void);
+
+/** Starts send shards of the machine. Implemented in rpc/frmops.c. */
+M0_INTERNAL int m0_rpc_shards_start(struct m0_rpc_machine *machine);
+/**
+ * Stops send shards of the machine.
+ *
+ * @pre machine->rm_active_nb == 0
+ */
+M0_INTERNAL void m0_rpc_shards_stop(struct m0_rpc_machine *machine);
+
 M0_TL_DESCR_DECLARE(rpc_conn, M0_EXTERN);
 M0_TL_DECLARE(rpc_conn, M0_INTERNAL, struct m0_rpc_conn);
 
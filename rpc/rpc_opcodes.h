@@ -358,6 +358,8 @@ enum M0_RPC_OPCODES {
 	M0_ISCSERVICE_EXEC_OPCODE           = 1072,
 	M0_DTM0_RLINK_OPCODE                = 1073,
 	M0_FDMI_SOURCE_DOCK_TIMER_OPCODE    = 1074,
+	M0_UT_FOM_CLASS_FG_OPCODE           = 1075,
+	M0_UT_FOM_CLASS_BG_OPCODE           = 1076,
 
 	M0_OPCODES_NR                       = 2048
 } M0_XCA_ENUM;
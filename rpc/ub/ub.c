@@ -27,6 +27,7 @@
 #include "lib/misc.h"       /* M0_IN, M0_BITS */
 #include "lib/string.h"     /* strlen, m0_strdup */
 #include "lib/memory.h"     /* m0_free */
+#include "lib/arith.h"      /* m0_rnd64 */
 #include "fop/fop.h"        /* m0_fop_alloc */
 #include "net/bulk_mem.h"   /* m0_net_bulk_mem_xprt */
 #include "net/lnet/lnet.h"  /* m0_net_lnet_xprt */
@@ -289,7 +290,8 @@ static void ub_item_replied(struct m0_rpc_item *item)
 	M0_UB_ASSERT(m0_buf_eq(&resp->ur_data, &req->uq_data));
 }
 
-static void fop_send(struct m0_rpc_session *session, size_t msg_id)
+static void fop_send(struct m0_rpc_session *session, size_t msg_id,
+		     m0_time_t deadline, enum m0_rpc_item_priority prio)
 {
 	struct m0_fop      *fop;
 	struct ub_req      *req;
@@ -313,8 +315,8 @@ static void fop_send(struct m0_rpc_session *session, size_t msg_id)
 	item->ri_nr_sent_max = MAX_RETRIES;
 	item->ri_ops         = &ub_item_ops;
 	item->ri_session     = session;
-	item->ri_deadline    = m0_time_from_now(1, 0);
-	item->ri_prio        = M0_RPC_ITEM_PRIO_MID; /* XXX CONFIGUREME */
+	item->ri_deadline    = deadline;
+	item->ri_prio        = prio;
 
 	rc = m0_rpc_post(item);
 	M0_UB_ASSERT(rc == 0);
@@ -331,11 +333,24 @@ static struct m0_rpc_session *_session(unsigned int i)
 	return &g_clients[i].rc_ctx.rcx_session;
 }
 
+static void sessions_wait(void)
+{
+	int k;
+	int rc;
+
+	for (k = 0; k < g_args.a_nr_conns; ++k) {
+		rc = m0_rpc_session_timedwait(_session(k),
+					      M0_BITS(M0_RPC_SESSION_IDLE,
+						      M0_RPC_SESSION_FAILED),
+					      M0_TIME_NEVER);
+		M0_UB_ASSERT(rc == 0);
+	}
+}
+
 static void run(int iter M0_UNUSED)
 {
 	int n;
 	int k;
-	int rc;
 
 	M0_PRE(g_args.a_nr_msgs > 0 && g_args.a_nr_conns > 0);
 
@@ -345,16 +360,33 @@ static void run(int iter M0_UNUSED)
 	 */
 	for (n = 0; n < g_args.a_nr_msgs; ++n) {
 		for (k = 0; k < g_args.a_nr_conns; ++k)
-			fop_send(_session(k), n);
+			fop_send(_session(k), n, m0_time_from_now(1, 0),
+				 M0_RPC_ITEM_PRIO_MID); /* XXX CONFIGUREME */
 	}
+	sessions_wait();
+}
 
-	for (k = 0; k < g_args.a_nr_conns; ++k) {
-		rc = m0_rpc_session_timedwait(_session(k),
-					      M0_BITS(M0_RPC_SESSION_IDLE,
-						      M0_RPC_SESSION_FAILED),
-					      M0_TIME_NEVER);
-		M0_UB_ASSERT(rc == 0);
-	}
+/**
+ * Builds deep formation queues: all nr_conns * nr_msgs messages are posted
+ * to the first connection, with mixed priorities and deadlines that are not
+ * in the order of submission. Deadlines are spread over 900ms, within the
+ * deadline-bucket index of formation (FRM_BUCKET_NR), so that an insertion
+ * walks the items of one bucket only; wider spreads degrade to a linear walk.
+ */
+static void run_deep(int iter M0_UNUSED)
+{
+	uint64_t seed = 42;
+	int      nr   = g_args.a_nr_msgs * g_args.a_nr_conns;
+	int      n;
+
+	M0_PRE(g_args.a_nr_msgs > 0 && g_args.a_nr_conns > 0);
+
+	for (n = 0; n < nr; ++n)
+		fop_send(_session(0), n,
+			 m0_time_from_now(0, (100 + m0_rnd64(&seed) % 900) *
+					  M0_TIME_ONE_MSEC),
+			 n % M0_RPC_ITEM_PRIO_NR);
+	sessions_wait();
 }
 
 struct m0_ub_set m0_rpc_ub = {
@@ -365,6 +397,9 @@ struct m0_ub_set m0_rpc_ub = {
 		{ .ub_name  = "run",
 		  .ub_iter  = 1,
 		  .ub_round = run },
+		{ .ub_name  = "deep",
+		  .ub_iter  = 1,
+		  .ub_round = run_deep },
 		{ .ub_name = NULL }  /* terminator */
 	}
 };
@@ -650,6 +650,70 @@ static void frm_test8(void)
 	M0_LEAVE();
 }
 
+static void frm_test9(void)
+{
+	/*
+	 * Items with out of order deadlines spread over several turns of the
+	 * deadline-bucket wheel (m0_rpc_frm::f_bucket) are kept sorted.
+	 */
+	enum { N = 200 };
+	struct m0_rpc_packet *p;
+	struct m0_rpc_item   *items[N];
+	struct m0_rpc_item   *item;
+	struct m0_rpc_item   *prev = NULL;
+	struct m0_tl         *q = &frm->f_itemq[FRMQ_URGENT][0];
+	m0_bcount_t           saved_max_nr_bytes_acc;
+	uint64_t              seed = 7;
+	int                   saved_max_nr_packets_enqed;
+	int                   i;
+
+	M0_ENTRY();
+
+	saved_max_nr_packets_enqed = frm->f_constraints.fc_max_nr_packets_enqed;
+	frm->f_constraints.fc_max_nr_packets_enqed = 0; /* disable formation */
+
+	flags_reset();
+	for (i = 0; i < N; ++i) {
+		items[i] = new_item(TIMEDOUT, NORMAL);
+		/* In the past, hence URGENT. */
+		items[i]->ri_deadline =
+			((m0_rnd64(&seed) % (3 * FRM_BUCKET_NR)) <<
+			 FRM_BUCKET_SHIFT) + m0_rnd64(&seed) % 4;
+		m0_rpc_frm_enq_item(frm, items[i]);
+		check_frm(FRM_BUSY, i + 1, 0);
+	}
+	M0_UT_ASSERT(itemq_tlist_length(q) == N);
+	m0_tl_for(itemq, q, item) {
+		M0_UT_ASSERT(ergo(prev != NULL,
+				  prev->ri_deadline <= item->ri_deadline));
+		prev = item;
+	} m0_tl_endfor;
+
+	frm->f_constraints.fc_max_nr_packets_enqed = ~0; /* enable formation */
+	saved_max_nr_bytes_acc = frm->f_constraints.fc_max_nr_bytes_accumulated;
+	frm->f_constraints.fc_max_nr_bytes_accumulated = 0;
+	m0_rpc_frm_run_formation(frm);
+	check_frm(FRM_BUSY, 0, top);
+	while (!packet_stack_is_empty()) {
+		p = packet_stack_pop();
+		m0_rpc_frm_packet_done(p);
+		m0_rpc_packet_discard(p);
+	}
+	check_frm(FRM_IDLE, 0, 0);
+	M0_UT_ASSERT(m0_forall(j, FRMQ_NR_QUEUES * M0_RPC_ITEM_PRIO_NR *
+			       FRM_BUCKET_NR,
+			       (&frm->f_bucket[0][0][0])[j] == NULL));
+	for (i = 0; i < N; i++) {
+		m0_rpc_item_fini(items[i]);
+		m0_free(items[i]);
+	}
+
+	frm->f_constraints.fc_max_nr_packets_enqed = saved_max_nr_packets_enqed;
+	frm->f_constraints.fc_max_nr_bytes_accumulated = saved_max_nr_bytes_acc;
+
+	M0_LEAVE();
+}
+
 static void frm_fini_test(void)
 {
 	m0_rpc_frm_fini(frm);
@@ -669,6 +733,7 @@ struct m0_ut_suite frm_ut = {
 		{ "frm-test6",    frm_test6    },
 		{ "frm-test7",    frm_test7    },
 		{ "frm-test8",    frm_test8    },
+		{ "frm-test9",    frm_test9    },
 		{ "frm-fini",     frm_fini_test},
 		{ NULL,           NULL         }
 	}
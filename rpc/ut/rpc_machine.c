@@ -86,6 +86,32 @@ static void rpc_mc_init_fini_test(void)
 	m0_rpc_machine_fini(&machine);
 }
 
+static void rpc_mc_lock_stats_test(void)
+{
+	struct m0_mutex_addb2 *ma = &machine.rm_lock_stats;
+	struct m0_mutex       *mut;
+	uint64_t               nr;
+	int                    rc;
+
+	rc = m0_rpc_machine_init(&machine, &client_net_dom, ep_addr,
+				 &reqh, &buf_pool, M0_BUFFER_ANY_COLOUR,
+				 max_rpc_msg_size, tm_recv_queue_min_len);
+	M0_UT_ASSERT(rc == 0);
+	mut = &machine.rm_sm_grp.s_lock;
+	if (machine.rm_addb2_mach != NULL) {
+		/* The histograms are attached and count lock acquisitions. */
+		M0_UT_ASSERT(mut->m_addb2 == ma);
+		nr = ma->ma_hold.lh_counter.co_val.cod_nr;
+		m0_rpc_machine_lock(&machine);
+		m0_rpc_machine_unlock(&machine);
+		M0_UT_ASSERT(ma->ma_hold.lh_counter.co_val.cod_nr > nr);
+	} else
+		M0_UT_ASSERT(mut->m_addb2 == NULL);
+	m0_rpc_machine_fini(&machine);
+	M0_UT_ASSERT(machine.rm_addb2_mach == NULL);
+	M0_UT_ASSERT(mut->m_addb2 == NULL);
+}
+
 static void rpc_mc_fini_race_test(void)
 {
 	struct m0_rpc_conn    conn;
@@ -119,6 +145,45 @@ static void rpc_mc_fini_race_test(void)
 	m0_fi_disable("buf_send_cb", "delay_callback");
 }
 
+static void rpc_mc_shards_test(void)
+{
+	struct m0_rpc_conn    conn;
+	struct m0_rpc_session session;
+	struct m0_rpc_shard  *shard;
+	uint32_t              saved = m0_rpc_shard_nr_get();
+	uint32_t              nr;
+	int                   rc;
+
+	for (nr = 0; nr <= 3; nr += 3) {
+		m0_rpc_shard_nr_set(nr);
+		rc = m0_rpc_machine_init(&machine, &client_net_dom, ep_addr,
+					 &reqh, &buf_pool, M0_BUFFER_ANY_COLOUR,
+					 max_rpc_msg_size,
+					 tm_recv_queue_min_len);
+		M0_UT_ASSERT(rc == 0);
+		M0_UT_ASSERT(machine.rm_shard_nr == nr);
+		M0_UT_ASSERT((machine.rm_shard == NULL) == (nr == 0));
+		/* Connection and session set-up is sent through the shard. */
+		rc = m0_rpc_client_connect(&conn, &session, &machine,
+					   machine.rm_tm.ntm_ep->nep_addr,
+					   NULL, MAX_RPCS_IN_FLIGHT,
+					   M0_TIME_NEVER);
+		M0_UT_ASSERT(rc == 0);
+		shard = conn.c_rpcchan->rc_shard;
+		M0_UT_ASSERT(ergo(nr == 0, shard == NULL));
+		M0_UT_ASSERT(ergo(nr > 0, shard >= machine.rm_shard &&
+				  shard < machine.rm_shard + nr));
+		rc = m0_rpc_session_destroy(&session, M0_TIME_NEVER);
+		M0_UT_ASSERT(rc == 0);
+		rc = m0_rpc_conn_destroy(&conn, M0_TIME_NEVER);
+		M0_UT_ASSERT(rc == 0);
+		m0_rpc_machine_fini(&machine);
+		M0_UT_ASSERT(machine.rm_shard == NULL);
+		M0_UT_ASSERT(machine.rm_shard_nr == 0);
+	}
+	m0_rpc_shard_nr_set(saved);
+}
+
 static void rpc_mc_init_fail_test(void)
 {
 	int rc;
@@ -225,7 +290,9 @@ struct m0_ut_suite rpc_mc_ut = {
 	.ts_fini = rpc_mc_ut_fini,
 	.ts_tests = {
 		{ "rpc_mc_init_fini", rpc_mc_init_fini_test },
+		{ "rpc_mc_lock_stats", rpc_mc_lock_stats_test },
 		{ "rpc_mc_fini_race", rpc_mc_fini_race_test },
+		{ "rpc_mc_shards",    rpc_mc_shards_test },
 		{ "rpc_mc_init_fail", rpc_mc_init_fail_test },
 #ifndef __KERNEL__
 		{ "rpc_mc_watch",     rpc_machine_watch_test},
@@ -172,10 +172,10 @@ M0_INTERNAL void m0_sm_asts_run(struct m0_sm_group *grp)
 		if (grp->s_addb2 == NULL) {
 			ast->sa_cb(grp, ast);
 		} else {
-			M0_ADDB2_HIST(grp->s_addb2->ga_forq,
-				      &grp->s_addb2->ga_forq_hist,
-				      m0_ptr_wrap(ast->sa_cb),
-				      ast->sa_cb(grp, ast));
+			M0_ADDB2_LOGHIST(grp->s_addb2->ga_forq,
+					 &grp->s_addb2->ga_forq_hist,
+					 m0_ptr_wrap(ast->sa_cb),
+					 ast->sa_cb(grp, ast));
 		}
 	}
 }
@@ -335,6 +335,21 @@ M0_INTERNAL void m0_sm_fini(struct m0_sm *mach)
 	m0_chan_fini(&mach->sm_chan);
 }
 
+M0_INTERNAL void m0_sm_regroup(struct m0_sm *mach, struct m0_sm_group *grp)
+{
+	const struct m0_sm_conf *conf = mach->sm_conf;
+
+	M0_PRE(m0_sm_group_is_locked(grp));
+	M0_PRE(!m0_chan_has_waiters(&mach->sm_chan));
+
+	mach->sm_grp = grp;
+	mach->sm_chan.ch_guard = &grp->s_lock;
+	/* Per-locality statistics follow the machine to its new locality. */
+	if (conf->scf_addb2_key > 0 && mach->sm_addb2_stats != NULL)
+		mach->sm_addb2_stats = m0_locality_data(conf->scf_addb2_key - 1);
+	M0_POST(sm_invariant0(mach));
+}
+
 M0_INTERNAL void (*m0_sm__conf_init)(const struct m0_sm_conf *conf) = NULL;
 
 M0_INTERNAL void m0_sm_conf_init(struct m0_sm_conf *conf)
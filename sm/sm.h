@@ -533,6 +533,17 @@ M0_INTERNAL void m0_sm_init(struct m0_sm *mach, const struct m0_sm_conf *conf,
  */
 M0_INTERNAL void m0_sm_fini(struct m0_sm *mach);
 
+/**
+   Re-binds a state machine to a different state machine group.
+
+   The caller guarantees that the machine is not accessed concurrently (in
+   particular, no asts are posted against it and nobody waits on its channel)
+   and that the machine is not referenced from the old group.
+
+   @pre m0_sm_group_is_locked(grp)
+ */
+M0_INTERNAL void m0_sm_regroup(struct m0_sm *mach, struct m0_sm_group *grp);
+
 M0_INTERNAL void m0_sm_group_init(struct m0_sm_group *grp);
 M0_INTERNAL void m0_sm_group_fini(struct m0_sm_group *grp);
 
@@ -800,8 +811,8 @@ struct m0_sm_addb2_stats {
 };
 
 struct m0_sm_group_addb2 {
-	uint64_t             ga_forq;
-	struct m0_addb2_hist ga_forq_hist;
+	uint64_t                ga_forq;
+	struct m0_addb2_loghist ga_forq_hist;
 };
 
 M0_INTERNAL int m0_sm_addb2_init(struct m0_sm_conf *conf,
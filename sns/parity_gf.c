@@ -0,0 +1,263 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2012-2021 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include "lib/assert.h"
+#include "lib/misc.h"                  /* ARRAY_SIZE */
+
+#include "sns/parity_gf.h"
+#include "sns/parity_xor.h"
+
+#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_SNS
+#include "lib/trace.h"
+
+#if defined(__x86_64__) && !defined(__KERNEL__) && defined(__GNUC__)
+#  define PARITY_GF_SIMD (1)
+#  include <immintrin.h>
+#else
+#  define PARITY_GF_SIMD (0)
+#endif
+
+/**
+ * @addtogroup parity_gf
+ *
+ * As in parity_xor.c, a kernel processes the block from the given offset as
+ * far as its chunk size allows and returns the offset it stopped at. The
+ * tail is finished by the table kernel.
+ *
+ * @{
+ */
+
+typedef size_t (*gf_kernel_t)(const struct m0_parity_gf_tbl *tbl, uint8_t *y,
+			      const uint8_t *x, size_t off, size_t len);
+
+static size_t gf_scalar(const struct m0_parity_gf_tbl *tbl, uint8_t *y,
+			const uint8_t *x, size_t off, size_t len)
+{
+	size_t i;
+
+	for (i = off; i < len; ++i)
+		y[i] = m0_parity_add(y[i], m0_parity_mul(x[i], tbl->gt_alpha));
+	return len;
+}
+
+static size_t gf_table(const struct m0_parity_gf_tbl *tbl, uint8_t *y,
+		       const uint8_t *x, size_t off, size_t len)
+{
+	size_t i;
+
+	for (i = off; i < len; ++i)
+		y[i] ^= tbl->gt_lo[x[i] & 0xf] ^ tbl->gt_hi[x[i] >> 4];
+	return len;
+}
+
+#if PARITY_GF_SIMD
+/**
+ * Defines a split-table kernel over vectors of type "vec", 2 vectors per
+ * iteration. "bcast" replicates a 16-byte table into every 128-bit lane: the
+ * shuffle instructions look up within a lane.
+ */
+#define GF_SIMD_KERNEL(name, isa, vec, load, store, bcast, set1, and,	\
+		       srli, shuffle, xor)				\
+__attribute__((target(isa)))						\
+static size_t name(const struct m0_parity_gf_tbl *tbl, uint8_t *y,	\
+		   const uint8_t *x, size_t off, size_t len)		\
+{									\
+	enum { V = sizeof(vec) };					\
+	const vec mask = set1(0x0f);					\
+	const vec lo   = bcast(_mm_loadu_si128((const void *)tbl->gt_lo)); \
+	const vec hi   = bcast(_mm_loadu_si128((const void *)tbl->gt_hi)); \
+	size_t    i;							\
+	vec       x0;							\
+	vec       x1;							\
+									\
+	for (i = off; i + 2 * V <= len; i += 2 * V) {			\
+		x0 = load((const void *)(x + i));			\
+		x1 = load((const void *)(x + i + V));			\
+		x0 = xor(shuffle(lo, and(x0, mask)),			\
+			 shuffle(hi, and(srli(x0, 4), mask)));		\
+		x1 = xor(shuffle(lo, and(x1, mask)),			\
+			 shuffle(hi, and(srli(x1, 4), mask)));		\
+		store((void *)(y + i),					\
+		      xor(load((const void *)(y + i)), x0));		\
+		store((void *)(y + i + V),				\
+		      xor(load((const void *)(y + i + V)), x1));	\
+	}								\
+	return i;							\
+}
+
+static inline __m128i gf_bcast128(__m128i t)
+{
+	return t;
+}
+
+#define gf_bcast256(t) _mm256_broadcastsi128_si256(t)
+#define gf_bcast512(t) _mm512_broadcast_i32x4(t)
+
+GF_SIMD_KERNEL(gf_ssse3, "ssse3", __m128i,
+	       _mm_loadu_si128, _mm_storeu_si128, gf_bcast128,
+	       _mm_set1_epi8, _mm_and_si128, _mm_srli_epi64,
+	       _mm_shuffle_epi8, _mm_xor_si128)
+GF_SIMD_KERNEL(gf_avx2, "avx2", __m256i,
+	       _mm256_loadu_si256, _mm256_storeu_si256, gf_bcast256,
+	       _mm256_set1_epi8, _mm256_and_si256, _mm256_srli_epi64,
+	       _mm256_shuffle_epi8, _mm256_xor_si256)
+GF_SIMD_KERNEL(gf_avx512, "avx512f,avx512bw", __m512i,
+	       _mm512_loadu_si512, _mm512_storeu_si512, gf_bcast512,
+	       _mm512_set1_epi8, _mm512_and_si512, _mm512_srli_epi64,
+	       _mm512_shuffle_epi8, _mm512_xor_si512)
+
+#undef gf_bcast512
+#undef gf_bcast256
+#undef GF_SIMD_KERNEL
+#endif /* PARITY_GF_SIMD */
+
+static const struct {
+	const char  *gk_name;
+	gf_kernel_t  gk_func;
+} gf_kernels[M0_PARITY_GF_NR] = {
+	[M0_PARITY_GF_SCALAR] = { "scalar", &gf_scalar },
+	[M0_PARITY_GF_TABLE]  = { "table",  &gf_table },
+#if PARITY_GF_SIMD
+	[M0_PARITY_GF_SSSE3]  = { "ssse3",  &gf_ssse3 },
+	[M0_PARITY_GF_AVX2]   = { "avx2",   &gf_avx2 },
+	[M0_PARITY_GF_AVX512] = { "avx512", &gf_avx512 },
+#else
+	[M0_PARITY_GF_SSSE3]  = { "ssse3",  NULL },
+	[M0_PARITY_GF_AVX2]   = { "avx2",   NULL },
+	[M0_PARITY_GF_AVX512] = { "avx512", NULL },
+#endif
+};
+
+/** See xor_current in parity_xor.c. */
+static enum m0_parity_gf_kernel gf_current = M0_PARITY_GF_NR;
+
+M0_INTERNAL void m0_parity_gf_tbl_init(struct m0_parity_gf_tbl *tbl,
+				       m0_parity_elem_t alpha)
+{
+	int i;
+
+	M0_PRE(alpha >= 0 && alpha < 1 << M0_PARITY_GALOIS_W);
+	tbl->gt_alpha = alpha;
+	for (i = 0; i < ARRAY_SIZE(tbl->gt_lo); ++i) {
+		tbl->gt_lo[i] = m0_parity_mul(i, alpha);
+		tbl->gt_hi[i] = m0_parity_mul(i << 4, alpha);
+	}
+}
+
+M0_INTERNAL bool m0_parity_gf_is_supported(enum m0_parity_gf_kernel kernel)
+{
+	M0_PRE(kernel < M0_PARITY_GF_NR);
+	if (gf_kernels[kernel].gk_func == NULL)
+		return false;
+#if PARITY_GF_SIMD
+	switch (kernel) {
+	case M0_PARITY_GF_SSSE3:
+		return __builtin_cpu_supports("ssse3");
+	case M0_PARITY_GF_AVX2:
+		return __builtin_cpu_supports("avx2");
+	case M0_PARITY_GF_AVX512:
+		return __builtin_cpu_supports("avx512bw");
+	default:
+		break;
+	}
+#endif
+	return true;
+}
+
+static enum m0_parity_gf_kernel gf_best(void)
+{
+	enum m0_parity_gf_kernel k;
+
+	for (k = M0_PARITY_GF_NR - 1; k > M0_PARITY_GF_TABLE; --k) {
+		if (m0_parity_gf_is_supported(k))
+			return k;
+	}
+	return M0_PARITY_GF_TABLE;
+}
+
+M0_INTERNAL enum m0_parity_gf_kernel m0_parity_gf_kernel(void)
+{
+	if (gf_current == M0_PARITY_GF_NR) {
+		gf_current = gf_best();
+		M0_LOG(M0_DEBUG, "gf kernel: %s",
+		       gf_kernels[gf_current].gk_name);
+	}
+	return gf_current;
+}
+
+M0_INTERNAL void m0_parity_gf_kernel_set(enum m0_parity_gf_kernel kernel)
+{
+	M0_PRE(kernel == M0_PARITY_GF_NR || m0_parity_gf_is_supported(kernel));
+	gf_current = kernel == M0_PARITY_GF_NR ? gf_best() : kernel;
+}
+
+M0_INTERNAL const char *m0_parity_gf_name(enum m0_parity_gf_kernel kernel)
+{
+	M0_PRE(kernel < M0_PARITY_GF_NR);
+	return gf_kernels[kernel].gk_name;
+}
+
+M0_INTERNAL void m0_parity_gf_axpy_with(enum m0_parity_gf_kernel kernel,
+					const struct m0_parity_gf_tbl *tbl,
+					uint8_t *y, const uint8_t *x,
+					size_t len)
+{
+	size_t off;
+
+	M0_PRE(m0_parity_gf_is_supported(kernel));
+	M0_PRE(tbl != NULL && y != NULL && x != NULL);
+
+	off = gf_kernels[kernel].gk_func(tbl, y, x, 0, len);
+	if (off < len)
+		gf_table(tbl, y, x, off, len);
+}
+
+M0_INTERNAL void m0_parity_gf_axpy(const struct m0_parity_gf_tbl *tbl,
+				   uint8_t *y, const uint8_t *x, size_t len)
+{
+	const uint8_t *src[] = { y, x };
+
+	switch (tbl->gt_alpha) {
+	case 0:
+		break;
+	case 1:
+		m0_parity_xor(y, src, ARRAY_SIZE(src), len);
+		break;
+	default:
+		m0_parity_gf_axpy_with(m0_parity_gf_kernel(), tbl, y, x, len);
+		break;
+	}
+}
+
+/** @} end of parity_gf group */
+#undef M0_TRACE_SUBSYSTEM
+
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
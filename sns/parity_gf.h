@@ -0,0 +1,117 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2012-2021 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#pragma once
+
+#ifndef __MOTR_SNS_PARITY_GF_H__
+#define __MOTR_SNS_PARITY_GF_H__
+
+#include "lib/types.h"
+#include "sns/parity_ops.h"            /* m0_parity_elem_t */
+
+/**
+ * @defgroup parity_gf GF(2^8) multiply-accumulate kernels
+ *
+ * Kernels computing
+ *
+ * @code
+ * y[i] = y[i] + alpha * x[i], 0 <= i < len
+ * @endcode
+ *
+ * in GF(2^8), as used by incremental recovery (m0_sns_ir_recover()).
+ *
+ * Vector kernels use split multiplication tables: alpha * x is looked up as
+ * alpha * (x & 0xf) + alpha * (x & 0xf0), and both 16-entry tables fit in a
+ * vector register, so that 16, 32 or 64 bytes are multiplied by a pair of
+ * byte shuffles (PSHUFB). The best kernel supported by the processor is
+ * selected at run-time. Vector kernels are only available in user space on
+ * x86_64.
+ *
+ * @{
+ */
+
+enum m0_parity_gf_kernel {
+	/** m0_parity_mul() per byte. Reference implementation. */
+	M0_PARITY_GF_SCALAR,
+	/** Split tables, a byte at a time. */
+	M0_PARITY_GF_TABLE,
+	M0_PARITY_GF_SSSE3,
+	M0_PARITY_GF_AVX2,
+	M0_PARITY_GF_AVX512,
+	M0_PARITY_GF_NR
+};
+
+/** Split multiplication tables for a constant. */
+struct m0_parity_gf_tbl {
+	/** gt_lo[i] == alpha * i */
+	uint8_t          gt_lo[16];
+	/** gt_hi[i] == alpha * (i << 4) */
+	uint8_t          gt_hi[16];
+	m0_parity_elem_t gt_alpha;
+};
+
+M0_INTERNAL void m0_parity_gf_tbl_init(struct m0_parity_gf_tbl *tbl,
+				       m0_parity_elem_t alpha);
+
+/**
+ * y += alpha * x over "len" bytes. Multiplication by 0 and 1 is
+ * short-circuited to a no-op and m0_parity_xor() respectively.
+ */
+M0_INTERNAL void m0_parity_gf_axpy(const struct m0_parity_gf_tbl *tbl,
+				   uint8_t *y, const uint8_t *x, size_t len);
+
+/** Same as m0_parity_gf_axpy(), with the given kernel and no short-cuts. */
+M0_INTERNAL void m0_parity_gf_axpy_with(enum m0_parity_gf_kernel kernel,
+					const struct m0_parity_gf_tbl *tbl,
+					uint8_t *y, const uint8_t *x,
+					size_t len);
+
+/** Returns true iff the kernel can be used on this processor. */
+M0_INTERNAL bool m0_parity_gf_is_supported(enum m0_parity_gf_kernel kernel);
+
+/** Returns the kernel used by m0_parity_gf_axpy(). */
+M0_INTERNAL enum m0_parity_gf_kernel m0_parity_gf_kernel(void);
+
+/**
+ * Forces m0_parity_gf_axpy() to use the given kernel. M0_PARITY_GF_NR
+ * restores the automatic selection.
+ *
+ * @pre kernel == M0_PARITY_GF_NR || m0_parity_gf_is_supported(kernel)
+ */
+M0_INTERNAL void m0_parity_gf_kernel_set(enum m0_parity_gf_kernel kernel);
+
+/** Returns a human readable kernel name. */
+M0_INTERNAL const char *m0_parity_gf_name(enum m0_parity_gf_kernel kernel);
+
+/** @} end of parity_gf group */
+#endif /* __MOTR_SNS_PARITY_GF_H__ */
+
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
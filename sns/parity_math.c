@@ -28,6 +28,8 @@
 
 #include "sns/parity_ops.h"
 #include "sns/parity_math.h"
+#include "sns/parity_gf.h"
+#include "sns/parity_xor.h"
 
 #define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_SNS
 #include "lib/trace.h"
@@ -315,7 +317,6 @@ static void (*fidx_recover[M0_PARITY_CAL_ALGO_NR])(struct m0_parity_math *math,
 
 enum {
 	SNS_PARITY_MATH_DATA_BLOCKS_MAX = 1 << (M0_PARITY_GALOIS_W - 1),
-	BAD_FAIL_INDEX = -1,
 	IR_INVALID_COL = UINT8_MAX,
 	MIN_TABLE_LEN = 32,
 };
@@ -415,11 +416,9 @@ M0_INTERNAL void m0_parity_math_refine(struct m0_parity_math *math,
 M0_INTERNAL void m0_parity_math_buffer_xor(struct m0_buf *dest,
 					   const struct m0_buf *src)
 {
-        uint32_t ei; /* block element index. */
+	const uint8_t *blocks[] = { dest[0].b_addr, src[0].b_addr };
 
-        for (ei = 0; ei < src[0].b_nob; ++ei)
-		((uint8_t*)dest[0].b_addr)[ei] ^=
-			(m0_parity_elem_t)((uint8_t*)src[0].b_addr)[ei];
+	m0_parity_xor(dest[0].b_addr, blocks, ARRAY_SIZE(blocks), src[0].b_nob);
 }
 
 M0_INTERNAL int m0_sns_ir_init(const struct m0_parity_math *math,
@@ -594,27 +593,60 @@ static bool parity_math_invariant(const struct m0_parity_math *math)
 		_0C(math->pmi_data_count <= SNS_PARITY_MATH_DATA_BLOCKS_MAX);
 }
 
+/**
+ * Accumulates source blocks and XORs them into the destination in batches of
+ * XOR_BATCH, so that the number of passes over the destination does not grow
+ * with every source block and the kernel argument vector stays bounded. After
+ * the first batch the destination itself becomes the first source of the next.
+ */
+enum { XOR_BATCH = 16 };
+
+struct xor_acc {
+	uint8_t       *xa_dst;
+	size_t         xa_len;
+	uint32_t       xa_nr;
+	const uint8_t *xa_src[XOR_BATCH];
+};
+
+static void xor_acc_init(struct xor_acc *acc, void *dst, size_t len)
+{
+	acc->xa_dst = dst;
+	acc->xa_len = len;
+	acc->xa_nr  = 0;
+}
+
+static void xor_acc_flush(struct xor_acc *acc)
+{
+	M0_PRE(acc->xa_nr > 0);
+	m0_parity_xor(acc->xa_dst, acc->xa_src, acc->xa_nr, acc->xa_len);
+	acc->xa_src[0] = acc->xa_dst;
+	acc->xa_nr     = 1;
+}
+
+static void xor_acc_add(struct xor_acc *acc, const void *src)
+{
+	if (acc->xa_nr == ARRAY_SIZE(acc->xa_src))
+		xor_acc_flush(acc);
+	acc->xa_src[acc->xa_nr++] = src;
+}
+
 static void xor_calculate(struct m0_parity_math *math,
 			  const struct m0_buf *data,
 			  struct m0_buf *parity)
 {
-	uint32_t          ei; /* block element index. */
-	uint32_t          ui; /* unit index. */
-	uint32_t          block_size = data[0].b_nob;
-	m0_parity_elem_t  pe;
+	uint32_t       ui; /* unit index. */
+	uint32_t       block_size = data[0].b_nob;
+	struct xor_acc acc;
 
 	M0_ENTRY();
 	M0_PRE(block_size == parity[0].b_nob);
 	for (ui = 1; ui < math->pmi_data_count; ++ui)
 		M0_PRE(block_size == data[ui].b_nob);
 
-	for (ei = 0; ei < block_size; ++ei) {
-		pe = 0;
-		for (ui = 0; ui < math->pmi_data_count; ++ui)
-			pe ^= (m0_parity_elem_t)((uint8_t*)data[ui].b_addr)[ei];
-
-		((uint8_t*)parity[0].b_addr)[ei] = pe;
-	}
+	xor_acc_init(&acc, parity[0].b_addr, block_size);
+	for (ui = 0; ui < math->pmi_data_count; ++ui)
+		xor_acc_add(&acc, data[ui].b_addr);
+	xor_acc_flush(&acc);
 	M0_LEAVE();
 }
 
@@ -624,7 +656,7 @@ static int xor_diff(struct m0_parity_math *math,
 		    struct m0_buf         *parity,
 		    uint32_t               index)
 {
-	uint32_t ei;
+	const uint8_t *blocks[3];
 
 	M0_PRE(math   != NULL);
 	M0_PRE(old    != NULL);
@@ -634,29 +666,52 @@ static int xor_diff(struct m0_parity_math *math,
 	M0_PRE(old[index].b_nob == new[index].b_nob);
 	M0_PRE(new[index].b_nob == parity[0].b_nob);
 
-	for (ei = 0; ei < new[index].b_nob; ++ei) {
-		((uint8_t*)parity[0].b_addr)[ei] ^=
-			((uint8_t *)old[index].b_addr)[ei] ^
-			((uint8_t *)new[index].b_addr)[ei];
-	}
+	blocks[0] = parity[0].b_addr;
+	blocks[1] = old[index].b_addr;
+	blocks[2] = new[index].b_addr;
+	m0_parity_xor(parity[0].b_addr, blocks, ARRAY_SIZE(blocks),
+		      new[index].b_nob);
 
 	return M0_RC(0);
 }
 
+/**
+ * Recovers the block "failure_index" (data_count stands for the parity
+ * block) as XOR of all the other blocks.
+ */
+static void xor_recover_one(struct m0_parity_math *math,
+			    struct m0_buf *data,
+			    struct m0_buf *parity,
+			    uint32_t failure_index)
+{
+	uint32_t       ui; /* unit index. */
+	struct xor_acc acc;
+
+	if (failure_index == math->pmi_data_count) {
+		/* Parity was lost, so recover it. */
+		xor_calculate(math, data, parity);
+		return;
+	}
+	xor_acc_init(&acc, data[failure_index].b_addr, parity[0].b_nob);
+	for (ui = 0; ui < math->pmi_data_count; ++ui) {
+		if (ui != failure_index)
+			xor_acc_add(&acc, data[ui].b_addr);
+	}
+	xor_acc_add(&acc, parity[0].b_addr);
+	xor_acc_flush(&acc);
+}
+
 static int xor_recover(struct m0_parity_math *math,
 		       struct m0_buf *data,
 		       struct m0_buf *parity,
 		       struct m0_buf *fails,
 		       enum m0_parity_linsys_algo algo)
 {
-	uint32_t          ei; /* block element index. */
 	uint32_t          ui; /* unit index. */
 	uint8_t          *fail;
 	uint32_t          fail_count;
 	uint32_t          unit_count;
 	uint32_t          block_size = data[0].b_nob;
-	m0_parity_elem_t  pe;
-	int               fail_index = BAD_FAIL_INDEX;
 
 	unit_count = math->pmi_data_count + math->pmi_parity_count;
 	fail = (uint8_t*) fails->b_addr;
@@ -669,23 +724,11 @@ static int xor_recover(struct m0_parity_math *math,
 	for (ui = 1; ui < math->pmi_data_count; ++ui)
 		M0_PRE(block_size == data[ui].b_nob);
 
-	for (ei = 0; ei < block_size; ++ei) {
-		pe = 0;
-		for (ui = 0; ui < math->pmi_data_count; ++ui) {
-			if (fail[ui] != 1)
-				pe ^= (m0_parity_elem_t)((uint8_t*)
-				       data[ui].b_addr)[ei];
-			else
-				fail_index = ui;
-		}
-		/* Now ui points to parity block, test if it was failed. */
-		if (fail[ui] != 1) {
-			M0_ASSERT(fail_index != BAD_FAIL_INDEX);
-			((uint8_t*)data[fail_index].b_addr)[ei] = pe ^
-				((uint8_t*)parity[0].b_addr)[ei];
-		} else /* Parity was lost, so recover it. */
-			((uint8_t*)parity[0].b_addr)[ei] = pe;
-	}
+	for (ui = 0; ui < math->pmi_data_count && fail[ui] != 1; ++ui)
+		;
+	/* ui == pmi_data_count here means the parity block was lost. */
+	M0_ASSERT(ui < math->pmi_data_count || fail[ui] == 1);
+	xor_recover_one(math, data, parity, ui);
 	return M0_RC(0);
 }
 
@@ -694,11 +737,9 @@ static void fail_idx_xor_recover(struct m0_parity_math *math,
 				 struct m0_buf *parity,
 				 const uint32_t failure_index)
 {
-	uint32_t          ei; /* block element index. */
 	uint32_t          ui; /* unit index. */
 	uint32_t          unit_count;
 	uint32_t          block_size = data[0].b_nob;
-	m0_parity_elem_t  pe;
 
 	M0_PRE(block_size == parity[0].b_nob);
 
@@ -708,19 +749,7 @@ static void fail_idx_xor_recover(struct m0_parity_math *math,
 	for (ui = 1; ui < math->pmi_data_count; ++ui)
 		M0_ASSERT(block_size == data[ui].b_nob);
 
-	for (ei = 0; ei < block_size; ++ei) {
-		pe = 0;
-		for (ui = 0; ui < math->pmi_data_count; ++ui)
-			if (ui != failure_index)
-				pe ^= (m0_parity_elem_t)((uint8_t*)
-				       data[ui].b_addr)[ei];
-
-		if (ui != failure_index)
-			((uint8_t*)data[failure_index].b_addr)[ei] = pe ^
-				((uint8_t*)parity[0].b_addr)[ei];
-		else /* Parity was lost, so recover it. */
-			((uint8_t*)parity[0].b_addr)[ei] = pe;
-	}
+	xor_recover_one(math, data, parity, failure_index);
 }
 
 /** @todo Iterative reed-solomon decode to be implemented. */
@@ -765,13 +794,13 @@ static inline uint32_t ir_blocks_count(const struct m0_sns_ir *ir)
 static void gfaxpy(struct m0_bufvec *y, struct m0_bufvec *x,
 		   m0_parity_elem_t alpha)
 {
-	uint32_t                i;
 	uint32_t                seg_size;
 	uint8_t                *y_addr;
 	uint8_t                *x_addr;
 	m0_bcount_t             step;
 	struct m0_bufvec_cursor x_cursor;
 	struct m0_bufvec_cursor y_cursor;
+	struct m0_parity_gf_tbl tbl;
 
 	M0_ENTRY("y=%p, x=%p, alpha=%u", y, x, (uint32_t)alpha);
 
@@ -783,26 +812,15 @@ static void gfaxpy(struct m0_bufvec *y, struct m0_bufvec *x,
 	seg_size = y->ov_vec.v_count[0];
 	M0_PRE(m0_forall(i, y->ov_vec.v_nr, y->ov_vec.v_count[i] == seg_size));
 
+	/* Tables are built once per call, not per segment. */
+	m0_parity_gf_tbl_init(&tbl, alpha);
 	m0_bufvec_cursor_init(&y_cursor, y);
 	m0_bufvec_cursor_init(&x_cursor, x);
 	do {
 		x_addr  = m0_bufvec_cursor_addr(&x_cursor);
 		y_addr  = m0_bufvec_cursor_addr(&y_cursor);
-
-		switch (alpha) {
-		/* This is a special case of the 'default' case that follows.
-		 * Here we avoid unnecessary call to gmul.*/
-		case 1:
-			for (i = 0; i <seg_size; ++i)
-				y_addr[i] = gadd(y_addr[i], x_addr[i]);
-			break;
-		default:
-			for (i = 0; i < seg_size; ++i)
-				y_addr[i] = gadd(y_addr[i], gmul(x_addr[i],
-							         alpha));
-			break;
-		}
-		step = m0_bufvec_cursor_step(&y_cursor);
+		step    = m0_bufvec_cursor_step(&y_cursor);
+		m0_parity_gf_axpy(&tbl, y_addr, x_addr, step);
 	} while (!m0_bufvec_cursor_move(&x_cursor, step) &&
 		 !m0_bufvec_cursor_move(&y_cursor, step));
 
@@ -0,0 +1,281 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2012-2021 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#include "lib/assert.h"
+#include "lib/misc.h"                  /* memcpy, ARRAY_SIZE */
+
+#include "sns/parity_xor.h"
+
+#define M0_TRACE_SUBSYSTEM M0_TRACE_SUBSYS_SNS
+#include "lib/trace.h"
+
+#if defined(__x86_64__) && !defined(__KERNEL__) && defined(__GNUC__)
+#  define PARITY_XOR_SIMD (1)
+#  include <immintrin.h>
+#else
+#  define PARITY_XOR_SIMD (0)
+#endif
+
+/**
+ * @addtogroup parity_xor
+ *
+ * Each kernel walks the blocks in chunks. For every chunk all sources are
+ * loaded and XOR-ed in registers before the result is stored, which makes
+ * dst == src[i] safe. A kernel handles as much of the block as its chunk size
+ * allows, starting at the given offset, and returns the offset it stopped at.
+ * The tail is finished by narrower kernels.
+ *
+ * @{
+ */
+
+typedef size_t (*xor_kernel_t)(uint8_t *dst, const uint8_t *const *src,
+			       uint32_t nr, size_t off, size_t len);
+
+static size_t xor_byte(uint8_t *dst, const uint8_t *const *src,
+		       uint32_t nr, size_t off, size_t len)
+{
+	size_t   i;
+	uint32_t j;
+	uint8_t  x;
+
+	for (i = off; i < len; ++i) {
+		x = src[0][i];
+		for (j = 1; j < nr; ++j)
+			x ^= src[j][i];
+		dst[i] = x;
+	}
+	return len;
+}
+
+static inline uint64_t word_load(const uint8_t *addr)
+{
+	uint64_t w;
+
+	memcpy(&w, addr, sizeof w);
+	return w;
+}
+
+static inline void word_store(uint8_t *addr, uint64_t w)
+{
+	memcpy(addr, &w, sizeof w);
+}
+
+enum { WORD = sizeof(uint64_t) };
+
+static size_t xor_word(uint8_t *dst, const uint8_t *const *src,
+		       uint32_t nr, size_t off, size_t len)
+{
+	size_t   i;
+	uint32_t j;
+	uint64_t x0;
+	uint64_t x1;
+	uint64_t x2;
+	uint64_t x3;
+
+	for (i = off; i + 4 * WORD <= len; i += 4 * WORD) {
+		x0 = word_load(src[0] + i);
+		x1 = word_load(src[0] + i + WORD);
+		x2 = word_load(src[0] + i + 2 * WORD);
+		x3 = word_load(src[0] + i + 3 * WORD);
+		for (j = 1; j < nr; ++j) {
+			x0 ^= word_load(src[j] + i);
+			x1 ^= word_load(src[j] + i + WORD);
+			x2 ^= word_load(src[j] + i + 2 * WORD);
+			x3 ^= word_load(src[j] + i + 3 * WORD);
+		}
+		word_store(dst + i,            x0);
+		word_store(dst + i + WORD,     x1);
+		word_store(dst + i + 2 * WORD, x2);
+		word_store(dst + i + 3 * WORD, x3);
+	}
+	for (; i + WORD <= len; i += WORD) {
+		x0 = word_load(src[0] + i);
+		for (j = 1; j < nr; ++j)
+			x0 ^= word_load(src[j] + i);
+		word_store(dst + i, x0);
+	}
+	return i;
+}
+
+#if PARITY_XOR_SIMD
+/**
+ * Defines a vector kernel processing 4 vectors of type "vec" per chunk.
+ * Unaligned loads and stores are used throughout: on the processors having
+ * these instruction sets they are as fast as aligned ones on aligned data.
+ */
+#define XOR_SIMD_KERNEL(name, isa, vec, load, store, xor)		\
+__attribute__((target(isa)))						\
+static size_t name(uint8_t *dst, const uint8_t *const *src,		\
+		   uint32_t nr, size_t off, size_t len)			\
+{									\
+	enum { V = sizeof(vec) };					\
+	size_t   i;							\
+	uint32_t j;							\
+	vec      x0;							\
+	vec      x1;							\
+	vec      x2;							\
+	vec      x3;							\
+									\
+	for (i = off; i + 4 * V <= len; i += 4 * V) {			\
+		x0 = load((const void *)(src[0] + i));			\
+		x1 = load((const void *)(src[0] + i + V));		\
+		x2 = load((const void *)(src[0] + i + 2 * V));		\
+		x3 = load((const void *)(src[0] + i + 3 * V));		\
+		for (j = 1; j < nr; ++j) {				\
+			x0 = xor(x0, load((const void *)(src[j] + i)));	\
+			x1 = xor(x1, load((const void *)(src[j] + i +	\
+							 V)));		\
+			x2 = xor(x2, load((const void *)(src[j] + i +	\
+							 2 * V)));	\
+			x3 = xor(x3, load((const void *)(src[j] + i +	\
+							 3 * V)));	\
+		}							\
+		store((void *)(dst + i),         x0);			\
+		store((void *)(dst + i + V),     x1);			\
+		store((void *)(dst + i + 2 * V), x2);			\
+		store((void *)(dst + i + 3 * V), x3);			\
+	}								\
+	return i;							\
+}
+
+XOR_SIMD_KERNEL(xor_sse2, "sse2", __m128i,
+		_mm_loadu_si128, _mm_storeu_si128, _mm_xor_si128)
+XOR_SIMD_KERNEL(xor_avx2, "avx2", __m256i,
+		_mm256_loadu_si256, _mm256_storeu_si256, _mm256_xor_si256)
+XOR_SIMD_KERNEL(xor_avx512, "avx512f", __m512i,
+		_mm512_loadu_si512, _mm512_storeu_si512, _mm512_xor_si512)
+
+#undef XOR_SIMD_KERNEL
+#endif /* PARITY_XOR_SIMD */
+
+static const struct {
+	const char   *xk_name;
+	xor_kernel_t  xk_func;
+} xor_kernels[M0_PARITY_XOR_NR] = {
+	[M0_PARITY_XOR_BYTE]   = { "byte",   &xor_byte },
+	[M0_PARITY_XOR_WORD]   = { "word",   &xor_word },
+#if PARITY_XOR_SIMD
+	[M0_PARITY_XOR_SSE2]   = { "sse2",   &xor_sse2 },
+	[M0_PARITY_XOR_AVX2]   = { "avx2",   &xor_avx2 },
+	[M0_PARITY_XOR_AVX512] = { "avx512", &xor_avx512 },
+#else
+	[M0_PARITY_XOR_SSE2]   = { "sse2",   NULL },
+	[M0_PARITY_XOR_AVX2]   = { "avx2",   NULL },
+	[M0_PARITY_XOR_AVX512] = { "avx512", NULL },
+#endif
+};
+
+/**
+ * Kernel used by m0_parity_xor(). M0_PARITY_XOR_NR until the first call
+ * selects the best one. Races on initialisation are benign: all threads
+ * select the same kernel.
+ */
+static enum m0_parity_xor_kernel xor_current = M0_PARITY_XOR_NR;
+
+M0_INTERNAL bool m0_parity_xor_is_supported(enum m0_parity_xor_kernel kernel)
+{
+	M0_PRE(kernel < M0_PARITY_XOR_NR);
+	if (xor_kernels[kernel].xk_func == NULL)
+		return false;
+#if PARITY_XOR_SIMD
+	switch (kernel) {
+	case M0_PARITY_XOR_SSE2:
+		return __builtin_cpu_supports("sse2");
+	case M0_PARITY_XOR_AVX2:
+		return __builtin_cpu_supports("avx2");
+	case M0_PARITY_XOR_AVX512:
+		return __builtin_cpu_supports("avx512f");
+	default:
+		break;
+	}
+#endif
+	return true;
+}
+
+static enum m0_parity_xor_kernel xor_best(void)
+{
+	enum m0_parity_xor_kernel k;
+
+	for (k = M0_PARITY_XOR_NR - 1; k > M0_PARITY_XOR_WORD; --k) {
+		if (m0_parity_xor_is_supported(k))
+			return k;
+	}
+	return M0_PARITY_XOR_WORD;
+}
+
+M0_INTERNAL enum m0_parity_xor_kernel m0_parity_xor_kernel(void)
+{
+	if (xor_current == M0_PARITY_XOR_NR) {
+		xor_current = xor_best();
+		M0_LOG(M0_DEBUG, "xor kernel: %s",
+		       xor_kernels[xor_current].xk_name);
+	}
+	return xor_current;
+}
+
+M0_INTERNAL void m0_parity_xor_kernel_set(enum m0_parity_xor_kernel kernel)
+{
+	M0_PRE(kernel == M0_PARITY_XOR_NR || m0_parity_xor_is_supported(kernel));
+	xor_current = kernel == M0_PARITY_XOR_NR ? xor_best() : kernel;
+}
+
+M0_INTERNAL const char *m0_parity_xor_name(enum m0_parity_xor_kernel kernel)
+{
+	M0_PRE(kernel < M0_PARITY_XOR_NR);
+	return xor_kernels[kernel].xk_name;
+}
+
+M0_INTERNAL void m0_parity_xor_with(enum m0_parity_xor_kernel kernel,
+				    uint8_t *dst, const uint8_t *const *src,
+				    uint32_t nr, size_t len)
+{
+	size_t off;
+
+	M0_PRE(m0_parity_xor_is_supported(kernel));
+	M0_PRE(dst != NULL && src != NULL && nr > 0);
+
+	off = xor_kernels[kernel].xk_func(dst, src, nr, 0, len);
+	if (off < len)
+		off = xor_word(dst, src, nr, off, len);
+	if (off < len)
+		xor_byte(dst, src, nr, off, len);
+}
+
+M0_INTERNAL void m0_parity_xor(uint8_t *dst, const uint8_t *const *src,
+			       uint32_t nr, size_t len)
+{
+	m0_parity_xor_with(m0_parity_xor_kernel(), dst, src, nr, len);
+}
+
+/** @} end of parity_xor group */
+#undef M0_TRACE_SUBSYSTEM
+
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
@@ -0,0 +1,98 @@
+/* -*- C -*- */
+/*
+ * Copyright (c) 2012-2021 Seagate Technology LLC and/or its Affiliates
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * For any questions about this software or licensing,
+ * please email opensource@seagate.com or cortx-questions@seagate.com.
+ *
+ */
+
+
+#pragma once
+
+#ifndef __MOTR_SNS_PARITY_XOR_H__
+#define __MOTR_SNS_PARITY_XOR_H__
+
+#include "lib/types.h"
+
+/**
+ * @defgroup parity_xor XOR parity kernels
+ *
+ * Kernels computing XOR of several source blocks into a destination block:
+ *
+ * @code
+ * dst[i] = src[0][i] ^ src[1][i] ^ ... ^ src[nr - 1][i], 0 <= i < len
+ * @endcode
+ *
+ * All sources are processed in a single pass over memory, a chunk at a
+ * time. The destination can coincide with one of the sources (e.g., to
+ * update parity in place), but must not partially overlap with any source.
+ * Neither addresses nor length have to be aligned.
+ *
+ * Vector kernels are only available in user space on x86_64. The best
+ * kernel supported by the processor is selected at run-time.
+ *
+ * @{
+ */
+
+enum m0_parity_xor_kernel {
+	/** Byte at a time. Reference implementation. */
+	M0_PARITY_XOR_BYTE,
+	/** 64-bit word at a time. */
+	M0_PARITY_XOR_WORD,
+	M0_PARITY_XOR_SSE2,
+	M0_PARITY_XOR_AVX2,
+	M0_PARITY_XOR_AVX512,
+	M0_PARITY_XOR_NR
+};
+
+/** XORs "nr" blocks "src" of "len" bytes to "dst", see above. */
+M0_INTERNAL void m0_parity_xor(uint8_t *dst, const uint8_t *const *src,
+			       uint32_t nr, size_t len);
+
+/** Same as m0_parity_xor(), but with the given kernel. */
+M0_INTERNAL void m0_parity_xor_with(enum m0_parity_xor_kernel kernel,
+				    uint8_t *dst, const uint8_t *const *src,
+				    uint32_t nr, size_t len);
+
+/** Returns true iff the kernel can be used on this processor. */
+M0_INTERNAL bool m0_parity_xor_is_supported(enum m0_parity_xor_kernel kernel);
+
+/** Returns the kernel used by m0_parity_xor(). */
+M0_INTERNAL enum m0_parity_xor_kernel m0_parity_xor_kernel(void);
+
+/**
+ * Forces m0_parity_xor() to use the given kernel. M0_PARITY_XOR_NR restores
+ * the automatic selection. Used by tests and benchmarks.
+ *
+ * @pre kernel == M0_PARITY_XOR_NR || m0_parity_xor_is_supported(kernel)
+ */
+M0_INTERNAL void m0_parity_xor_kernel_set(enum m0_parity_xor_kernel kernel);
+
+/** Returns a human readable kernel name. */
+M0_INTERNAL const char *m0_parity_xor_name(enum m0_parity_xor_kernel kernel);
+
+/** @} end of parity_xor group */
+#endif /* __MOTR_SNS_PARITY_XOR_H__ */
+
+/*
+ *  Local variables:
+ *  c-indentation-style: "K&R"
+ *  c-basic-offset: 8
+ *  tab-width: 8
+ *  fill-column: 80
+ *  scroll-step: 1
+ *  End:
+ */
@@ -36,6 +36,7 @@
 #include "sns/matvec.h"
 #include "sns/ls_solve.h"
 #include "sns/parity_math.h"
+#include "sns/parity_xor.h"
 
 #define MAX_NUM_THREADS 30
 #define KB(x)		((x) * 1024)
@@ -296,6 +297,42 @@ static void ub_small_4_2_1M(int iter) {
 	ub_mt_test(4, 2, MB(1));
 }
 
+/**
+ * Single parity unit selects XOR parity. Runs calculation and recovery with
+ * the given XOR kernel forced.
+ */
+static void ub_xor(enum m0_parity_xor_kernel kernel)
+{
+	if (!m0_parity_xor_is_supported(kernel)) {
+		printf("\n%s: not supported by the processor, skipped.\n",
+		       m0_parity_xor_name(kernel));
+		return;
+	}
+	m0_parity_xor_kernel_set(kernel);
+	ub_mt_test(10, 1, MB(1));
+	m0_parity_xor_kernel_set(M0_PARITY_XOR_NR);
+}
+
+static void ub_xor_byte(int iter) {
+	ub_xor(M0_PARITY_XOR_BYTE);
+}
+
+static void ub_xor_word(int iter) {
+	ub_xor(M0_PARITY_XOR_WORD);
+}
+
+static void ub_xor_sse2(int iter) {
+	ub_xor(M0_PARITY_XOR_SSE2);
+}
+
+static void ub_xor_avx2(int iter) {
+	ub_xor(M0_PARITY_XOR_AVX2);
+}
+
+static void ub_xor_avx512(int iter) {
+	ub_xor(M0_PARITY_XOR_AVX512);
+}
+
 enum { UB_ITER = 1 };
 
 struct m0_ub_set m0_parity_math_mt_ub = {
@@ -376,6 +413,36 @@ struct m0_ub_set m0_parity_math_mt_ub = {
 		  .ub_block_size = 1048576,
 		  .ub_blocks_per_op = 6 * MAX_NUM_THREADS },
 
+		{ .ub_name  = "xor byte  10/01/1M",
+		  .ub_iter  = UB_ITER,
+		  .ub_round = ub_xor_byte,
+		  .ub_block_size = MB(1),
+		  .ub_blocks_per_op = 11 * MAX_NUM_THREADS },
+
+		{ .ub_name  = "xor word  10/01/1M",
+		  .ub_iter  = UB_ITER,
+		  .ub_round = ub_xor_word,
+		  .ub_block_size = MB(1),
+		  .ub_blocks_per_op = 11 * MAX_NUM_THREADS },
+
+		{ .ub_name  = "xor sse2  10/01/1M",
+		  .ub_iter  = UB_ITER,
+		  .ub_round = ub_xor_sse2,
+		  .ub_block_size = MB(1),
+		  .ub_blocks_per_op = 11 * MAX_NUM_THREADS },
+
+		{ .ub_name  = "xor avx2  10/01/1M",
+		  .ub_iter  = UB_ITER,
+		  .ub_round = ub_xor_avx2,
+		  .ub_block_size = MB(1),
+		  .ub_blocks_per_op = 11 * MAX_NUM_THREADS },
+
+		{ .ub_name  = "xor avx512 10/01/1M",
+		  .ub_iter  = UB_ITER,
+		  .ub_round = ub_xor_avx512,
+		  .ub_block_size = MB(1),
+		  .ub_blocks_per_op = 11 * MAX_NUM_THREADS },
+
 		{ .ub_name = NULL}
 	}
 };
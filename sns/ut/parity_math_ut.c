@@ -19,6 +19,8 @@
  */
 
 
+#include <stdio.h>           /* printf */
+
 #include "lib/types.h"
 #include "lib/assert.h"
 #include "lib/memory.h"
@@ -28,6 +30,8 @@
 #include "lib/ub.h"
 #include "ut/ut.h"
 #include "sns/parity_math.h"
+#include "sns/parity_gf.h"
+#include "sns/parity_xor.h"
 
 #define KB(x)	((x) * 1024)
 #define MB(x)	(KB(x) * 1024)
@@ -467,6 +471,116 @@ static void test_buffer_xor(void)
 		       "Recovered data is unexpected");
 }
 
+/**
+ * Checks that every supported XOR kernel produces the same result as the
+ * reference byte kernel, for misaligned blocks of odd sizes, and when the
+ * destination is the first source.
+ */
+static void test_xor_kernels(void)
+{
+	static const uint32_t     nrs[]  = { 1, 2, 3, 5, 17,
+					     DATA_UNIT_COUNT_MAX };
+	static const uint32_t     lens[] = { 0, 1, 7, 63, 64, 255, 4097,
+					     KB(64) + 3 };
+	static const uint32_t     offs[] = { 0, 1, 13 };
+	const uint8_t            *src[DATA_UNIT_COUNT_MAX];
+	enum m0_parity_xor_kernel k;
+	uint32_t                  ni;
+	uint32_t                  li;
+	uint32_t                  oi;
+	uint32_t                  nr;
+	uint32_t                  len;
+	uint32_t                  off;
+	uint32_t                  i;
+	uint32_t                  j;
+
+	test_init();
+	for (i = 0; i < DATA_UNIT_COUNT_MAX; ++i) {
+		for (j = 0; j < KB(64) + 64; ++j)
+			data[i][j] = (uint8_t) m0_rnd64(&seed);
+	}
+	for (ni = 0; ni < ARRAY_SIZE(nrs); ++ni)
+	for (li = 0; li < ARRAY_SIZE(lens); ++li)
+	for (oi = 0; oi < ARRAY_SIZE(offs); ++oi) {
+		nr  = nrs[ni];
+		len = lens[li];
+		off = offs[oi];
+		/* Sources with different alignments. */
+		for (i = 0; i < nr; ++i)
+			src[i] = data[i] + (off + i) % 32;
+		m0_parity_xor_with(M0_PARITY_XOR_BYTE, expected[0] + off,
+				   src, nr, len);
+		for (k = 0; k < M0_PARITY_XOR_NR; ++k) {
+			if (!m0_parity_xor_is_supported(k))
+				continue;
+			memset(parity[0], 0xa5, len + off + 1);
+			m0_parity_xor_with(k, parity[0] + off, src, nr, len);
+			M0_UT_ASSERT(memcmp(parity[0] + off,
+					    expected[0] + off, len) == 0);
+			M0_UT_ASSERT(parity[0][off + len] == 0xa5);
+			/* In place: dst is src[0]. */
+			memcpy(parity[1] + off, src[0], len);
+			src[0] = parity[1] + off;
+			m0_parity_xor_with(k, parity[1] + off, src, nr, len);
+			M0_UT_ASSERT(memcmp(parity[1] + off,
+					    expected[0] + off, len) == 0);
+			src[0] = data[0] + off % 32;
+		}
+	}
+	M0_UT_ASSERT(m0_parity_xor_is_supported(m0_parity_xor_kernel()));
+}
+
+/**
+ * Checks every supported GF multiply-accumulate kernel against the scalar one
+ * for all multipliers, over misaligned blocks of odd sizes.
+ */
+static void test_gf_kernels(void)
+{
+	static const uint32_t    lens[] = { 0, 1, 15, 16, 33, 127, 4097 };
+	static const uint32_t    offs[] = { 0, 1, 13 };
+	struct m0_parity_gf_tbl  tbl;
+	enum m0_parity_gf_kernel k;
+	uint32_t                 alpha;
+	uint32_t                 li;
+	uint32_t                 oi;
+	uint32_t                 len;
+	uint32_t                 off;
+	uint32_t                 j;
+
+	test_init();
+	for (j = 0; j < KB(8); ++j) {
+		data[0][j] = (uint8_t) m0_rnd64(&seed);
+		data[1][j] = (uint8_t) m0_rnd64(&seed);
+	}
+	for (alpha = 0; alpha < 1 << M0_PARITY_GALOIS_W; ++alpha) {
+		m0_parity_gf_tbl_init(&tbl, alpha);
+		for (li = 0; li < ARRAY_SIZE(lens); ++li)
+		for (oi = 0; oi < ARRAY_SIZE(offs); ++oi) {
+			len = lens[li];
+			off = offs[oi];
+			memcpy(expected[0], data[1], len + off + 1);
+			m0_parity_gf_axpy_with(M0_PARITY_GF_SCALAR, &tbl,
+					       expected[0] + off,
+					       data[0] + off + 3, len);
+			for (k = 0; k < M0_PARITY_GF_NR; ++k) {
+				if (!m0_parity_gf_is_supported(k))
+					continue;
+				memcpy(parity[0], data[1], len + off + 1);
+				m0_parity_gf_axpy_with(k, &tbl, parity[0] + off,
+						       data[0] + off + 3, len);
+				M0_UT_ASSERT(memcmp(parity[0], expected[0],
+						    len + off + 1) == 0);
+			}
+			/* Automatic selection, including short-cuts. */
+			memcpy(parity[0], data[1], len + off + 1);
+			m0_parity_gf_axpy(&tbl, parity[0] + off,
+					  data[0] + off + 3, len);
+			M0_UT_ASSERT(memcmp(parity[0], expected[0],
+					    len + off + 1) == 0);
+		}
+	}
+}
+
 static void test_parity_math_diff(uint32_t parity_cnt)
 {
 	uint32_t              i;
@@ -1431,6 +1545,8 @@ static void test_init(void)
 	{ "xor_recover_with_fail_vec", test_xor_fv_recover },			\
 	{ "xor_recover_with_fail_index", test_xor_fail_idx_recover },		\
 	{ "buffer_xor", test_buffer_xor },					\
+	{ "xor_kernels", test_xor_kernels },					\
+	{ "gf_kernels", test_gf_kernels },					\
 	{ "parity_math_diff_xor", test_parity_math_diff_xor },			\
 	{ "parity_math_diff_rs", test_parity_math_diff_rs },			\
 	{ "incr_recov_rs", test_incr_recov_rs },				\
@@ -1609,6 +1725,61 @@ static void ub_small_4_2_1M(int iter)
 	parity_math_tb();
 }
 
+/**
+ * y += alpha * x over a 1MB block: incremental recovery inner loop. Compares
+ * GF kernels with each other and with ISA-L ec_encode_data_update(), which
+ * m0_sns_ir_recover() uses for local blocks.
+ */
+enum { UB_GF_ALPHA = 0x57 };
+
+static void ub_gf(enum m0_parity_gf_kernel kernel)
+{
+	struct m0_parity_gf_tbl tbl;
+
+	if (!m0_parity_gf_is_supported(kernel)) {
+		printf("\n%s: not supported by the processor, skipped.\n",
+		       m0_parity_gf_name(kernel));
+		return;
+	}
+	m0_parity_gf_tbl_init(&tbl, UB_GF_ALPHA);
+	m0_parity_gf_axpy_with(kernel, &tbl, parity[0], data[0], MB(1));
+}
+
+static void ub_gf_scalar(int iter)
+{
+	ub_gf(M0_PARITY_GF_SCALAR);
+}
+
+static void ub_gf_table(int iter)
+{
+	ub_gf(M0_PARITY_GF_TABLE);
+}
+
+static void ub_gf_ssse3(int iter)
+{
+	ub_gf(M0_PARITY_GF_SSSE3);
+}
+
+static void ub_gf_avx2(int iter)
+{
+	ub_gf(M0_PARITY_GF_AVX2);
+}
+
+static void ub_gf_avx512(int iter)
+{
+	ub_gf(M0_PARITY_GF_AVX512);
+}
+
+static void ub_gf_isal(int iter)
+{
+	unsigned char  alpha = UB_GF_ALPHA;
+	unsigned char  g_tbls[32];
+	unsigned char *dest = parity[0];
+
+	ec_init_tables(1, 1, &alpha, g_tbls);
+	ec_encode_data_update(MB(1), 1, 1, 0, g_tbls, data[0], &dest);
+}
+
 enum { UB_ITER = 100 };
 
 struct m0_ub_set m0_parity_math_ub = {
@@ -1688,6 +1859,42 @@ struct m0_ub_set m0_parity_math_ub = {
 		  .ub_block_size = MB(1),
 		  .ub_blocks_per_op = 6 },
 
+		{ .ub_name  = "gf scalar  1M",
+		  .ub_iter  = UB_ITER,
+		  .ub_round = ub_gf_scalar,
+		  .ub_block_size = MB(1),
+		  .ub_blocks_per_op = 1 },
+
+		{ .ub_name  = "gf table   1M",
+		  .ub_iter  = UB_ITER,
+		  .ub_round = ub_gf_table,
+		  .ub_block_size = MB(1),
+		  .ub_blocks_per_op = 1 },
+
+		{ .ub_name  = "gf ssse3   1M",
+		  .ub_iter  = UB_ITER,
+		  .ub_round = ub_gf_ssse3,
+		  .ub_block_size = MB(1),
+		  .ub_blocks_per_op = 1 },
+
+		{ .ub_name  = "gf avx2    1M",
+		  .ub_iter  = UB_ITER,
+		  .ub_round = ub_gf_avx2,
+		  .ub_block_size = MB(1),
+		  .ub_blocks_per_op = 1 },
+
+		{ .ub_name  = "gf avx512  1M",
+		  .ub_iter  = UB_ITER,
+		  .ub_round = ub_gf_avx512,
+		  .ub_block_size = MB(1),
+		  .ub_blocks_per_op = 1 },
+
+		{ .ub_name  = "gf isa-l   1M",
+		  .ub_iter  = UB_ITER,
+		  .ub_round = ub_gf_isal,
+		  .ub_block_size = MB(1),
+		  .ub_blocks_per_op = 1 },
+
 		{ .ub_name = NULL}
 	}
 };
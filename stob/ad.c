@@ -709,6 +709,14 @@ static int stob_ad_init(struct m0_stob *stob,
 
 static void stob_ad_fini(struct m0_stob *stob)
 {
+	struct m0_stob_ad_domain *adom;
+	struct m0_ad_balloc      *ballroom;
+
+	adom     = stob_ad_domain2ad(m0_stob_dom_get(stob));
+	ballroom = adom->sad_ballroom;
+	if (ballroom->ab_ops->bo_prealloc_release != NULL)
+		ballroom->ab_ops->bo_prealloc_release(ballroom,
+						      m0_stob_fid_get(stob));
 }
 
 static void stob_ad_create_credit(struct m0_stob_domain *dom,
@@ -1059,11 +1067,11 @@ static void *stob_ad_addr_open(const void *buf, uint32_t shift)
 
 /**
    Helper function to allocate a given number of blocks in the underlying
-   storage object.
+   storage object for the given ad object.
  */
 static int stob_ad_balloc(struct m0_stob_ad_domain *adom, struct m0_dtx *tx,
 			  m0_bcount_t count, struct m0_ext *out,
-			  uint64_t alloc_type)
+			  uint64_t alloc_type, struct m0_stob *obj)
 {
 	struct m0_ad_balloc *ballroom = adom->sad_ballroom;
 	int                  rc;
@@ -1071,7 +1079,8 @@ static int stob_ad_balloc(struct m0_stob_ad_domain *adom, struct m0_dtx *tx,
 	count >>= adom->sad_babshift;
 	M0_LOG(M0_DEBUG, "count=%lu", (unsigned long)count);
 	M0_ASSERT(count > 0);
-	rc = ballroom->ab_ops->bo_alloc(ballroom, tx, count, out, alloc_type);
+	rc = ballroom->ab_ops->bo_alloc(ballroom, tx, count, out, alloc_type,
+					m0_stob_fid_get(obj));
 	out->e_start <<= adom->sad_babshift;
 	out->e_end   <<= adom->sad_babshift;
 	m0_ext_init(out);
@@ -1933,7 +1942,7 @@ static int stob_ad_write_prepare(struct m0_stob_io        *io,
 			     M0_AVI_AD_BALLOC_START);
 		/* Get the balloc extent (returned in wext->we_ext) */
 		rc = stob_ad_balloc(adom, io->si_tx, todo, &wext->we_ext,
-				    aio->ai_balloc_flags);
+				    aio->ai_balloc_flags, io->si_obj);
 		M0_ADDB2_ADD(M0_AVI_STOB_IO_REQ, io->si_id,
 			     M0_AVI_AD_BALLOC_END);
 		if (rc != 0)
@@ -81,10 +81,14 @@ struct m0_ad_balloc_ops {
 	/** Finalises and destroys struct m0_balloc instance. */
 	void (*bo_fini)(struct m0_ad_balloc *ballroom);
 	/** Allocates count of blocks. On success, allocated extent, also
-	    measured in blocks, is returned in out parameter. */
+	    measured in blocks, is returned in out parameter.
+
+	    If owner is not NULL, the allocator may reserve extra space
+	    following the returned extent for the next allocations of the
+	    same owner. */
 	int  (*bo_alloc)(struct m0_ad_balloc *ballroom, struct m0_dtx *dtx,
 			 m0_bcount_t count, struct m0_ext *out,
-			 uint64_t alloc_zone);
+			 uint64_t alloc_zone, const struct m0_fid *owner);
 	/** Free space (possibly a sub-extent of an extent allocated
 	    earlier). */
 	int  (*bo_free)(struct m0_ad_balloc *ballroom, struct m0_dtx *dtx,
@@ -104,6 +108,12 @@ struct m0_ad_balloc_ops {
 	int  (*bo_reserve_extent)(struct m0_ad_balloc *ballroom,
 				 struct m0_be_tx *tx, struct m0_ext *ext,
 				 uint64_t alloc_zone);
+	/**
+	 * Tells the allocator that space reserved for the owner by
+	 * bo_alloc() won't be used by the owner. Optional.
+	 */
+	void (*bo_prealloc_release)(struct m0_ad_balloc *ballroom,
+				    const struct m0_fid *owner);
 };
 
 enum { AD_PATHLEN = 4096 };
@@ -48,6 +48,8 @@ enum m0_avi_stob_io_labels {
         M0_AVI_STOB_IO_ATTR_UVEC_NR,
         M0_AVI_STOB_IO_ATTR_UVEC_COUNT,
         M0_AVI_STOB_IO_ATTR_UVEC_BYTES,
+        M0_AVI_STOB_CACHE,
+	M0_AVI_STOB_IOQ_LATENCY,
 } M0_XCA_ENUM;
 
 enum m0_addb2_stio_req_labels {
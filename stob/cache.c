@@ -24,9 +24,12 @@
 
 #include "stob/cache.h"
 
+#include "lib/errno.h"	/* ENOMEM */
 #include "motr/magic.h"
+#include "addb2/addb2.h"	/* M0_ADDB2_ADD */
 
 #include "stob/stob.h"	/* m0_stob */
+#include "stob/addb2.h"	/* M0_AVI_STOB_CACHE */
 
 /**
  * @addtogroup stobcache
@@ -39,10 +42,30 @@ M0_TL_DESCR_DEFINE(stob_cache, "cached stobs", static, struct m0_stob,
 		   M0_STOB_CACHE_MAGIC, M0_STOB_CACHE_HEAD_MAGIC);
 M0_TL_DEFINE(stob_cache, static, struct m0_stob);
 
+static uint64_t stob_cache_hash_func(const struct m0_htable *htable,
+				     const struct m0_fid *stob_fid)
+{
+	return m0_fid_hash(stob_fid) % htable->h_bucket_nr;
+}
+
+static bool stob_cache_hash_key_eq(const struct m0_fid *fid1,
+				   const struct m0_fid *fid2)
+{
+	return m0_fid_eq(fid1, fid2);
+}
+
+M0_HT_DESCR_DEFINE(stob_cache_hash, "stob cache hash", static, struct m0_stob,
+		   so_cache_hlink, so_cache_hmagic,
+		   M0_STOB_CACHE_HASH_MAGIC, M0_STOB_CACHE_HASH_HEAD_MAGIC,
+		   so_id.si_fid, stob_cache_hash_func, stob_cache_hash_key_eq);
+M0_HT_DEFINE(stob_cache_hash, static, struct m0_stob, struct m0_fid);
+
 M0_INTERNAL int m0_stob_cache_init(struct m0_stob_cache *cache,
 				   uint64_t idle_size,
 				   m0_stob_cache_eviction_cb_t eviction_cb)
 {
+	int rc;
+
 	*cache = (struct m0_stob_cache){
 		.sc_idle_size	= idle_size,
 		.sc_idle_used	= 0,
@@ -52,6 +75,10 @@ M0_INTERNAL int m0_stob_cache_init(struct m0_stob_cache *cache,
 		.sc_misses	= 0,
 		.sc_evictions	= 0,
 	};
+	rc = stob_cache_hash_htable_init_resizable(&cache->sc_hash,
+						   M0_STOB_CACHE_BUCKET_NR);
+	if (rc != 0)
+		return M0_ERR(rc);
 	m0_mutex_init(&cache->sc_lock);
 	stob_cache_tlist_init(&cache->sc_busy);
 	stob_cache_tlist_init(&cache->sc_idle);
@@ -74,6 +101,7 @@ M0_INTERNAL void m0_stob_cache_fini(struct m0_stob_cache *cache)
 	} m0_tl_endfor;
 	stob_cache_tlist_fini(&cache->sc_idle);
 	stob_cache_tlist_fini(&cache->sc_busy);
+	stob_cache_hash_htable_fini(&cache->sc_hash);
 	m0_mutex_fini(&cache->sc_lock);
 }
 
@@ -83,10 +111,20 @@ M0_INTERNAL bool m0_stob_cache__invariant(const struct m0_stob_cache *cache)
 	return _0C(m0_stob_cache_is_locked(cache)) &&
 	       _0C(cache->sc_idle_size >= cache->sc_idle_used) &&
 	       M0_CHECK_EX(_0C(stob_cache_tlist_length(&cache->sc_idle) ==
+			       cache->sc_idle_used)) &&
+	       M0_CHECK_EX(_0C(stob_cache_hash_htable_size(&cache->sc_hash) ==
+			       stob_cache_tlist_length(&cache->sc_busy) +
 			       cache->sc_idle_used));
 
 }
 
+static void stob_cache_addb2(const struct m0_stob_cache *cache)
+{
+	M0_ADDB2_ADD(M0_AVI_STOB_CACHE, (uint64_t)cache,
+		     cache->sc_busy_hits, cache->sc_idle_hits,
+		     cache->sc_misses, cache->sc_evictions);
+}
+
 static void stob_cache_evict(struct m0_stob_cache *cache,
 			     struct m0_stob *stob)
 {
@@ -99,22 +137,33 @@ static void stob_cache_idle_del(struct m0_stob_cache *cache,
 {
 	M0_ENTRY("stob %p, stob_fid "FID_F, stob,
 	       FID_P(m0_stob_fid_get(stob)));
+	M0_PRE(stob->so_cache_idle);
 	stob_cache_tlink_del_fini(stob);
+	stob->so_cache_idle = false;
 	--cache->sc_idle_used;
 }
 
+/** Evicts the least recently used idle stob. */
+static void stob_cache_idle_evict(struct m0_stob_cache *cache)
+{
+	struct m0_stob *evicted = stob_cache_tlist_tail(&cache->sc_idle);
+
+	stob_cache_idle_del(cache, evicted);
+	stob_cache_hash_htable_del(&cache->sc_hash, evicted);
+	m0_tlink_fini(&stob_cache_hash_tl, evicted);
+	stob_cache_evict(cache, evicted);
+}
+
 static void stob_cache_idle_moveto(struct m0_stob_cache *cache,
 				   struct m0_stob *stob)
 {
-	struct m0_stob *evicted;
+	M0_PRE(!stob->so_cache_idle);
 
 	stob_cache_tlist_move(&cache->sc_idle, stob);
+	stob->so_cache_idle = true;
 	++cache->sc_idle_used;
-	if (cache->sc_idle_used > cache->sc_idle_size) {
-		evicted = stob_cache_tlist_tail(&cache->sc_idle);
-		stob_cache_idle_del(cache, evicted);
-		stob_cache_evict(cache, evicted);
-	}
+	if (cache->sc_idle_used > cache->sc_idle_size)
+		stob_cache_idle_evict(cache);
 }
 
 M0_INTERNAL void m0_stob_cache_add(struct m0_stob_cache *cache,
@@ -124,6 +173,9 @@ M0_INTERNAL void m0_stob_cache_add(struct m0_stob_cache *cache,
 	M0_PRE_EX(m0_stob_cache_lookup(cache, m0_stob_fid_get(stob)) == NULL);
 
 	stob_cache_tlink_init_at(stob, &cache->sc_busy);
+	stob->so_cache_idle = false;
+	m0_tlink_init(&stob_cache_hash_tl, stob);
+	stob_cache_hash_htable_add(&cache->sc_hash, stob);
 }
 
 M0_INTERNAL void m0_stob_cache_idle(struct m0_stob_cache *cache,
@@ -141,24 +193,20 @@ M0_INTERNAL struct m0_stob *m0_stob_cache_lookup(struct m0_stob_cache *cache,
 
 	M0_PRE(m0_stob_cache__invariant(cache));
 
-	m0_tl_for(stob_cache, &cache->sc_busy, stob) {
-		if (m0_fid_cmp(stob_fid, m0_stob_fid_get(stob)) == 0) {
-			++cache->sc_busy_hits;
-			return stob;
-		}
-	} m0_tl_endfor;
-
-	m0_tl_for(stob_cache, &cache->sc_idle, stob) {
-		if (m0_fid_cmp(stob_fid, m0_stob_fid_get(stob)) == 0) {
-			++cache->sc_idle_hits;
-			stob_cache_idle_del(cache, stob);
-			stob_cache_tlink_init_at(stob, &cache->sc_busy);
-			return stob;
-		}
-	} m0_tl_endfor;
-
-	++cache->sc_misses;
-	return NULL;
+	stob = stob_cache_hash_htable_lookup(&cache->sc_hash, stob_fid);
+	if (stob == NULL) {
+		++cache->sc_misses;
+	} else if (stob->so_cache_idle) {
+		++cache->sc_idle_hits;
+		stob_cache_idle_del(cache, stob);
+		stob_cache_tlink_init_at(stob, &cache->sc_busy);
+	} else {
+		++cache->sc_busy_hits;
+	}
+	if ((cache->sc_busy_hits + cache->sc_idle_hits +
+	     cache->sc_misses) % M0_STOB_CACHE_ADDB2_PERIOD == 0)
+		stob_cache_addb2(cache);
+	return stob;
 }
 
 
@@ -173,10 +221,24 @@ M0_INTERNAL void m0_stob_cache_purge(struct m0_stob_cache *cache, int nr)
 	stob = stob_cache_tlist_tail(&cache->sc_idle);
 	for (; stob != NULL && nr > 0; --nr) {
 		prev = stob_cache_tlist_prev(&cache->sc_idle, stob);
-		stob_cache_idle_del(cache, stob);
-		stob_cache_evict(cache, stob);
+		stob_cache_idle_evict(cache);
 		stob = prev;
 	}
+	stob_cache_addb2(cache);
+
+	M0_POST(m0_stob_cache__invariant(cache));
+	m0_stob_cache_unlock(cache);
+}
+
+M0_INTERNAL void m0_stob_cache_idle_size_set(struct m0_stob_cache *cache,
+					     uint64_t idle_size)
+{
+	m0_stob_cache_lock(cache);
+	M0_PRE(m0_stob_cache__invariant(cache));
+
+	cache->sc_idle_size = idle_size;
+	while (cache->sc_idle_used > cache->sc_idle_size)
+		stob_cache_idle_evict(cache);
 
 	M0_POST(m0_stob_cache__invariant(cache));
 	m0_stob_cache_unlock(cache);
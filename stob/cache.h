@@ -27,29 +27,54 @@
 
 #include "lib/mutex.h"	/* m0_mutex */
 #include "lib/tlist.h"	/* m0_tl */
+#include "lib/hash.h"	/* m0_htable */
 #include "lib/types.h"	/* uint64_t */
 #include "fid/fid.h"    /* m0_fid */
 
 /**
  * @defgroup stob Storage object
  *
- * @todo more scalable object index instead of a list.
+ * All cached stobs are indexed by stob fid in m0_stob_cache::sc_hash, so
+ * lookup doesn't depend on the number of cached stobs. Idle stobs are kept
+ * in LRU order in m0_stob_cache::sc_idle: the least recently used idle stob
+ * is evicted when the number of idle stobs exceeds the idle capacity.
+ *
+ * Hit, miss and eviction counters are exported through addb2 as
+ * M0_AVI_STOB_CACHE records.
  *
  * @{
  */
 
+enum {
+	/**
+	 * Initial number of buckets in m0_stob_cache::sc_hash. The table
+	 * grows with the number of cached stobs.
+	 */
+	M0_STOB_CACHE_BUCKET_NR    = 0x1000,
+	/**
+	 * Counters are exported through addb2 once per this number of
+	 * lookups.
+	 */
+	M0_STOB_CACHE_ADDB2_PERIOD = 0x1000,
+};
+
 struct m0_stob;
 struct m0_stob_cache;
 
 typedef void (*m0_stob_cache_eviction_cb_t)(struct m0_stob_cache *cache,
 					    struct m0_stob *stob);
 /**
- * @todo document
+ * Cache of stobs of a stob domain.
  */
 struct m0_stob_cache {
 	struct m0_mutex             sc_lock;
+	/** Stobs which are in use. */
 	struct m0_tl		    sc_busy;
+	/** Idle stobs, the most recently used one is at the head. */
 	struct m0_tl		    sc_idle;
+	/** All cached stobs (both busy and idle), keyed by stob fid. */
+	struct m0_htable            sc_hash;
+	/** Idle capacity: maximum number of idle stobs. */
 	uint64_t		    sc_idle_size;
 	uint64_t		    sc_idle_used;
 	m0_stob_cache_eviction_cb_t sc_eviction_cb;
@@ -116,6 +141,16 @@ M0_INTERNAL struct m0_stob *m0_stob_cache_lookup(struct m0_stob_cache *cache,
  */
 M0_INTERNAL void m0_stob_cache_purge(struct m0_stob_cache *cache, int nr);
 
+/**
+ * Sets idle capacity of the stob cache. If there are more idle stobs than the
+ * new capacity allows, least recently used ones are evicted.
+ *
+ * @pre m0_stob_cache_is_not_locked(cache)
+ * @post m0_stob_cache_is_not_locked(cache)
+ */
+M0_INTERNAL void m0_stob_cache_idle_size_set(struct m0_stob_cache *cache,
+					     uint64_t idle_size);
+
 M0_INTERNAL void m0_stob_cache_lock(struct m0_stob_cache *cache);
 M0_INTERNAL void m0_stob_cache_unlock(struct m0_stob_cache *cache);
 M0_INTERNAL bool m0_stob_cache_is_locked(const struct m0_stob_cache *cache);
@@ -45,8 +45,8 @@ enum {
 	 * Maximum number of cached stobs that ain't held by any user and
 	 * ain't finalised yet.
 	 *
-	 * @note 0x10 may be too small value.
-	 * @todo make a parameter for stob domain.
+	 * @note 0x10 may be too small value. It can be changed at run time
+	 * with m0_stob_cache_idle_size_set(m0_stob_domain__cache(dom), size).
 	 */
 	M0_STOB_CACHE_MAX_SIZE = 0x10,
 };
@@ -180,8 +180,15 @@ static int stob_domain_init_create(const char *location,
 		dom->sd_location      = m0_strdup(location);
 		dom->sd_location_data = location_data;
 		dom->sd_type	      = type;
-		m0_stob_cache_init(&dom->sd_cache, M0_STOB_CACHE_MAX_SIZE,
-				   &stob_domain_cache_evict_cb);
+		rc = m0_stob_cache_init(&dom->sd_cache, M0_STOB_CACHE_MAX_SIZE,
+					&stob_domain_cache_evict_cb);
+		if (rc != 0) {
+			m0_free(dom->sd_location);
+			dom->sd_ops->sdo_fini(dom);
+			*out = NULL;
+		}
+	}
+	if (rc == 0) {
 		M0_ASSERT_EX(m0_stob_domain_find(m0_stob_domain_id_get(dom)) ==
 			     NULL);
 		m0_stob_type__dom_add(type, dom);
@@ -119,6 +119,8 @@ struct ioq_qev {
 	    (linux_domain::ioq_queue). */
 	struct m0_queue_link  iq_linkage;
 	struct m0_stob_io    *iq_io;
+	/** Time the fragment was submitted to the ring buffer. */
+	m0_time_t             iq_submitted;
 };
 
 /**
@@ -412,6 +414,8 @@ static void ioq_queue_submit(struct m0_stob_ioq *ioq)
 		ioq_queue_unlock(ioq);
 
 		if (got > 0) {
+			for (i = 0; i < got; ++i)
+				qev[i]->iq_submitted = m0_time_now();
 			put = io_submit(ioq->ioq_ctx, got, evin);
 			if (put < 0)
 				M0_LOG(M0_ERROR, "got=%d put=%d", got, put);
@@ -639,18 +643,20 @@ static void stob_ioq_thread(struct m0_stob_ioq *ioq)
 	int got;
 	int avail;
 	int i;
-	struct io_event      evout[M0_STOB_IOQ_BATCH_OUT_SIZE];
-	struct timespec      timeout;
-	struct m0_addb2_hist inflight = {};
-	struct m0_addb2_hist queued   = {};
-	struct m0_addb2_hist gotten   = {};
-	int                  thread_index;
+	struct io_event         evout[M0_STOB_IOQ_BATCH_OUT_SIZE];
+	struct timespec         timeout;
+	struct m0_addb2_hist    inflight = {};
+	struct m0_addb2_hist    queued   = {};
+	struct m0_addb2_hist    gotten   = {};
+	struct m0_addb2_loghist latency  = {};
+	int                     thread_index;
 
 	thread_index = m0_thread_self() - ioq->ioq_thread;
 	M0_ADDB2_PUSH(M0_AVI_STOB_IOQ, thread_index);
 	m0_addb2_hist_add_auto(&inflight, 1000, M0_AVI_STOB_IOQ_INFLIGHT, -1);
 	m0_addb2_hist_add_auto(&queued,   1000, M0_AVI_STOB_IOQ_QUEUED, -1);
 	m0_addb2_hist_add_auto(&gotten,   1000, M0_AVI_STOB_IOQ_GOT, -1);
+	m0_addb2_loghist_add(&latency, M0_AVI_STOB_IOQ_LATENCY, -1);
 	while (!m0_semaphore_trydown(&ioq->ioq_stop_sem[thread_index])) {
 		timeout = ioq_timeout_default;
 		got = io_getevents(ioq->ioq_ctx, 1, ARRAY_SIZE(evout),
@@ -666,6 +672,8 @@ static void stob_ioq_thread(struct m0_stob_ioq *ioq)
 			iev = &evout[i];
 			qev = container_of(iev->obj, struct ioq_qev, iq_iocb);
 			M0_ASSERT(!m0_queue_link_is_in(&qev->iq_linkage));
+			m0_addb2_loghist_mod(&latency, m0_time_sub(m0_time_now(),
+							qev->iq_submitted));
 			ioq_complete(ioq, qev, iev->res, iev->res2);
 		}
 		ioq_queue_submit(ioq);
@@ -172,6 +172,11 @@ struct m0_stob {
 	struct m0_mutex           so_ref_mutex;
 	struct m0_tlink		  so_cache_linkage;
 	uint64_t		  so_cache_magic;
+	/** Linkage into m0_stob_cache::sc_hash. */
+	struct m0_hlink		  so_cache_hlink;
+	uint64_t		  so_cache_hmagic;
+	/** Stob is in m0_stob_cache::sc_idle. */
+	bool			  so_cache_idle;
 	void			 *so_private;
 };
 
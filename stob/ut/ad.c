@@ -131,7 +131,7 @@ static void mock_balloc_fini(struct m0_ad_balloc *ballroom)
 
 static int mock_balloc_alloc(struct m0_ad_balloc *ballroom, struct m0_dtx *dtx,
 			     m0_bcount_t count, struct m0_ext *out,
-			     uint64_t alloc_type)
+			     uint64_t alloc_type, const struct m0_fid *owner)
 {
 	struct mock_balloc *mb = b2mock(ballroom);
 	m0_bcount_t giveout;
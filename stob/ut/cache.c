@@ -23,8 +23,10 @@
 #include "stob/cache.h"		/* m0_stob_cache */
 
 #include "lib/memory.h"		/* M0_ALLOC_PTR */
+#include "lib/errno.h"		/* ENOMEM */
 #include "lib/thread.h"		/* M0_THREAD_INIT */
 #include "lib/arith.h"		/* m0_rnd64 */
+#include "lib/ub.h"		/* m0_ub_set */
 
 #include "ut/ut.h"		/* M0_UT_ASSERT */
 #include "ut/threads.h"		/* M0_UT_THREADS_DEFINE */
@@ -153,6 +155,185 @@ void m0_stob_ut_cache_idle_size0(void)
 	stob_ut_cache_test(STOB_UT_CACHE_THREAD_NR, STOB_UT_CACHE_ITER_NR, 0);
 }
 
+static bool stob_ut_cache_evicted[STOB_UT_CACHE_STOB_NR];
+
+static void stob_ut_cache_lru_evict_cb(struct m0_stob_cache *cache,
+				       struct m0_stob *stob)
+{
+	stob_ut_cache_evicted[stob - stob_ut_cache_stobs] = true;
+}
+
+static struct m0_stob *stob_ut_cache_lru_lookup(int i)
+{
+	return m0_stob_cache_lookup(&stob_ut_cache,
+			m0_stob_fid_get(&stob_ut_cache_stobs[i]));
+}
+
+void m0_stob_ut_cache_lru(void)
+{
+	struct m0_stob_cache *cache = &stob_ut_cache;
+	struct m0_stob	     *stob;
+	int		      rc;
+	int		      i;
+
+	M0_SET0(cache);
+	M0_SET_ARR0(stob_ut_cache_stobs);
+	M0_SET_ARR0(stob_ut_cache_evicted);
+	for (i = 0; i < 8; ++i)
+		stob_ut_cache_stobs[i].so_id.si_fid.f_key = i + 1;
+
+	rc = m0_stob_cache_init(cache, 4, &stob_ut_cache_lru_evict_cb);
+	M0_UT_ASSERT(rc == 0);
+	m0_stob_cache_lock(cache);
+	for (i = 0; i < 8; ++i) {
+		M0_UT_ASSERT(stob_ut_cache_lru_lookup(i) == NULL);
+		m0_stob_cache_add(cache, &stob_ut_cache_stobs[i]);
+	}
+	for (i = 0; i < 8; ++i)
+		m0_stob_cache_idle(cache, &stob_ut_cache_stobs[i]);
+	/* 0..3 are the least recently used ones */
+	for (i = 0; i < 8; ++i)
+		M0_UT_ASSERT(stob_ut_cache_evicted[i] == (i < 4));
+	M0_UT_ASSERT(cache->sc_evictions == 4);
+
+	/* make 4 the most recently used idle stob */
+	stob = stob_ut_cache_lru_lookup(4);
+	M0_UT_ASSERT(stob == &stob_ut_cache_stobs[4]);
+	M0_UT_ASSERT(cache->sc_idle_hits == 1);
+	m0_stob_cache_idle(cache, stob);
+	m0_stob_cache_unlock(cache);
+
+	m0_stob_cache_idle_size_set(cache, 2);
+
+	m0_stob_cache_lock(cache);
+	M0_UT_ASSERT(cache->sc_idle_used == 2);
+	for (i = 4; i < 8; ++i)
+		M0_UT_ASSERT(stob_ut_cache_evicted[i] == M0_IN(i, (5, 6)));
+	M0_UT_ASSERT(stob_ut_cache_lru_lookup(0) == NULL);
+	M0_UT_ASSERT(stob_ut_cache_lru_lookup(5) == NULL);
+	M0_UT_ASSERT(stob_ut_cache_lru_lookup(7) == &stob_ut_cache_stobs[7]);
+	m0_stob_cache_idle(cache, &stob_ut_cache_stobs[7]);
+	m0_stob_cache_unlock(cache);
+
+	m0_stob_cache_fini(cache);
+	for (i = 0; i < 8; ++i)
+		M0_UT_ASSERT(stob_ut_cache_evicted[i]);
+}
+
+enum {
+	STOB_UB_CACHE_SMALL_NR = 1000,
+	STOB_UB_CACHE_LARGE_NR = 1000000,
+	STOB_UB_CACHE_ITER     = 100000,
+};
+
+static struct m0_stob_cache  stob_ub_cache_small;
+static struct m0_stob_cache  stob_ub_cache_large;
+static struct m0_stob       *stob_ub_stobs;
+static uint64_t              stob_ub_seed;
+
+static int stob_ub_cache_fill(struct m0_stob_cache *cache,
+			      struct m0_stob *stobs, int nr)
+{
+	int rc;
+	int i;
+
+	rc = m0_stob_cache_init(cache, 0, &stob_ut_cache_evict_cb);
+	if (rc != 0)
+		return rc;
+	m0_stob_cache_lock(cache);
+	for (i = 0; i < nr; ++i) {
+		stobs[i].so_id.si_fid = M0_FID_INIT(0, i + 1);
+		m0_stob_cache_add(cache, &stobs[i]);
+	}
+	m0_stob_cache_unlock(cache);
+	return 0;
+}
+
+static void stob_ub_cache_drain(struct m0_stob_cache *cache,
+				struct m0_stob *stobs, int nr)
+{
+	int i;
+
+	/* idle_size is 0, so every stob is evicted at once */
+	m0_stob_cache_lock(cache);
+	for (i = 0; i < nr; ++i)
+		m0_stob_cache_idle(cache, &stobs[i]);
+	m0_stob_cache_unlock(cache);
+	m0_stob_cache_fini(cache);
+}
+
+static int stob_ub_cache_init(const char *opts M0_UNUSED)
+{
+	int rc;
+
+	M0_ALLOC_ARR(stob_ub_stobs,
+		     STOB_UB_CACHE_SMALL_NR + STOB_UB_CACHE_LARGE_NR);
+	if (stob_ub_stobs == NULL)
+		return -ENOMEM;
+	rc = stob_ub_cache_fill(&stob_ub_cache_small, stob_ub_stobs,
+				STOB_UB_CACHE_SMALL_NR);
+	if (rc == 0) {
+		rc = stob_ub_cache_fill(&stob_ub_cache_large,
+					stob_ub_stobs + STOB_UB_CACHE_SMALL_NR,
+					STOB_UB_CACHE_LARGE_NR);
+		if (rc != 0)
+			stob_ub_cache_drain(&stob_ub_cache_small, stob_ub_stobs,
+					    STOB_UB_CACHE_SMALL_NR);
+	}
+	if (rc != 0)
+		m0_free0(&stob_ub_stobs);
+	return rc;
+}
+
+static void stob_ub_cache_fini(void)
+{
+	stob_ub_cache_drain(&stob_ub_cache_large,
+			    stob_ub_stobs + STOB_UB_CACHE_SMALL_NR,
+			    STOB_UB_CACHE_LARGE_NR);
+	stob_ub_cache_drain(&stob_ub_cache_small, stob_ub_stobs,
+			    STOB_UB_CACHE_SMALL_NR);
+	m0_free0(&stob_ub_stobs);
+}
+
+static void stob_ub_cache_lookup(struct m0_stob_cache *cache, int nr)
+{
+	struct m0_fid   fid;
+	struct m0_stob *stob;
+
+	fid = M0_FID_INIT(0, m0_rnd64(&stob_ub_seed) % nr + 1);
+	m0_stob_cache_lock(cache);
+	stob = m0_stob_cache_lookup(cache, &fid);
+	m0_stob_cache_unlock(cache);
+	M0_ASSERT(stob != NULL);
+}
+
+static void stob_ub_cache_lookup_small(int i)
+{
+	stob_ub_cache_lookup(&stob_ub_cache_small, STOB_UB_CACHE_SMALL_NR);
+}
+
+static void stob_ub_cache_lookup_large(int i)
+{
+	stob_ub_cache_lookup(&stob_ub_cache_large, STOB_UB_CACHE_LARGE_NR);
+}
+
+struct m0_ub_set m0_stob_cache_ub = {
+	.us_name = "stob-cache-ub",
+	.us_init = stob_ub_cache_init,
+	.us_fini = stob_ub_cache_fini,
+	.us_run  = {
+		{ .ub_name  = "lookup-1e3",
+		  .ub_iter  = STOB_UB_CACHE_ITER,
+		  .ub_round = stob_ub_cache_lookup_small },
+
+		{ .ub_name  = "lookup-1e6",
+		  .ub_iter  = STOB_UB_CACHE_ITER,
+		  .ub_round = stob_ub_cache_lookup_large },
+
+		{ .ub_name = NULL }
+	}
+};
+
 /*
  *  Local variables:
  *  c-indentation-style: "K&R"
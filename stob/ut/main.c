@@ -28,6 +28,7 @@
 
 extern void m0_stob_ut_cache(void);
 extern void m0_stob_ut_cache_idle_size0(void);
+extern void m0_stob_ut_cache_lru(void);
 extern void m0_stob_ut_stob_domain_null(void);
 extern void m0_stob_ut_stob_null(void);
 extern void m0_stob_ut_stob_domain_linux(void);
@@ -51,6 +52,7 @@ struct m0_ut_suite stob_ut = {
 	.ts_tests = {
 		{ "cache",		m0_stob_ut_cache		},
 		{ "cache-idle-size0",	m0_stob_ut_cache_idle_size0	},
+		{ "cache-lru",		m0_stob_ut_cache_lru		},
 #ifndef __KERNEL__
 		{ "null-stob-domain",	m0_stob_ut_stob_domain_null	},
 		{ "null-stob",		m0_stob_ut_stob_null		},
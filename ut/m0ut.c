@@ -115,6 +115,7 @@ extern struct m0_ut_suite fdmi_filterc_ut;
 extern struct m0_ut_suite fdmi_filter_eval_ut;
 extern struct m0_ut_suite fit_ut;
 extern struct m0_ut_suite fol_ut;
+extern struct m0_ut_suite fom_class_ut;
 extern struct m0_ut_suite fom_timedwait_ut;
 extern struct m0_ut_suite frm_ut;
 extern struct m0_ut_suite ha_ut;
@@ -134,6 +135,7 @@ extern struct m0_ut_suite m0_net_bulk_mem_ut;
 extern struct m0_ut_suite m0_net_lnet_ut;
 extern struct m0_ut_suite m0_net_misc_ut;
 extern struct m0_ut_suite m0_net_module_ut;
+extern struct m0_ut_suite m0_net_sock_ut;
 extern struct m0_ut_suite m0_net_test_ut;
 extern struct m0_ut_suite m0_net_tm_prov_ut;
 extern struct m0_ut_suite m0d_ut;
@@ -261,6 +263,7 @@ static void tests_add(struct m0_ut_module *m)
 	m0_ut_add(m, &fdmi_filter_eval_ut, true);
 	m0_ut_add(m, &fit_ut, true);
 	m0_ut_add(m, &fol_ut, true);
+	m0_ut_add(m, &fom_class_ut, true);
 	m0_ut_add(m, &fom_timedwait_ut, true);
 	m0_ut_add(m, &frm_ut, true);
 	m0_ut_add(m, &ha_ut, true);
@@ -280,6 +283,7 @@ static void tests_add(struct m0_ut_module *m)
 	m0_ut_add(m, &m0_net_lnet_ut, LNET_ENABLED);
 	m0_ut_add(m, &m0_net_misc_ut, true);
 	m0_ut_add(m, &m0_net_module_ut, true);
+	m0_ut_add(m, &m0_net_sock_ut, true);
 	m0_ut_add(m, &m0_net_test_ut, true);
 	m0_ut_add(m, &m0_net_tm_prov_ut, true);
 	m0_ut_add(m, &m0d_ut, true);